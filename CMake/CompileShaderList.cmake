@@ -1,6 +1,18 @@
 # CompileShaderList.cmake
 #
-# Compile a list of shaders using glslc.
+# Compile a list of shaders using glslc, batched per target through Scripts/compile-shaders.py.
+#
+# All of the shaders in ${_input_list} are compiled by a single command, which runs glslc in
+# parallel and skips any shader whose source, includes and flags hash the same as the last
+# time it was compiled. Files named *.inc.glsl are only used as includes.
+#
+# If NOON_SHADER_OPTIMIZE is enabled, the SPIR-V is optimized for performance (or size for
+# MinSizeRel), and debug info is stripped for Release and MinSizeRel. Optimization is done
+# with spirv-opt if it was found, otherwise with glslc alone.
+#
+# The compiled shaders are stored in their relative location under the binary directory,
+# with .glsl replaced by .spv. Their filenames, along with a stamp file, are stored in
+# ${_output_list}.
 #
 
 # Allow Ninja to transform DEPFILEs
@@ -8,46 +20,80 @@ IF(POLICY CMP0116)
     CMAKE_POLICY(SET CMP0116 NEW)
 ENDIF()
 
-MACRO(COMPILE_SHADER_LIST _input_list _output_list)
+MACRO(COMPILE_SHADER_LIST _name _input_list _output_list)
+    SET(_shader_outputs "")
+
     FOREACH(_input ${_input_list})
-        GET_FILENAME_COMPONENT(_input_path ${_input} DIRECTORY)
         GET_FILENAME_COMPONENT(_input_name ${_input} NAME_WLE)
         GET_FILENAME_COMPONENT(_input_type ${_input_name} LAST_EXT)
-        STRING(SUBSTRING ${_input_type} 1 -1 _input_type) # Strip leading .
 
-        IF(_input_type STREQUAL "inc")
+        IF(_input_type STREQUAL ".inc")
             CONTINUE()
         ENDIF()
-        
+
         # Replace leading source dir in path with binary dir
-        STRING(REPLACE 
+        STRING(REPLACE
             ${CMAKE_CURRENT_SOURCE_DIR}
             ${CMAKE_CURRENT_BINARY_DIR}
-            _output_path
-            ${_input_path}
+            _output
+            ${_input}
         )
 
-        FILE(MAKE_DIRECTORY ${_output_path})
+        # Replace .glsl with .spv
+        STRING(REGEX REPLACE "\\.glsl$" ".spv" _output ${_output})
+
+        LIST(APPEND _shader_outputs ${_output})
+    ENDFOREACH()
+
+    IF(_shader_outputs)
+        SET(_stamp "${CMAKE_CURRENT_BINARY_DIR}/${_name}.shaders.stamp")
+        SET(_depfile "${CMAKE_CURRENT_BINARY_DIR}/${_name}.shaders.d")
+        SET(_cache "${CMAKE_CURRENT_BINARY_DIR}/${_name}.shaders.cache")
 
-        SET(_output "${_output_path}/${_input_name}.spv")
-        SET(_depfile "${_output_path}/${_input_name}.d")
+        SET(_flags "")
 
-        SET(_flags -fshader-stage=${_input_type})
-        
         FOREACH(_asset_path ${ASSET_PATH})
-            SET(_flags ${_flags} -I${_asset_path}/Shader)
+            SET(_flags ${_flags} -I ${_asset_path}/Shader)
         ENDFOREACH()
 
+        # Debug info is needed by RenderDoc and friends, but costs size and load time
+        SET(_flags ${_flags} $<$<CONFIG:Debug,RelWithDebInfo>:--glslc-flag=-g>)
+
+        IF(NOON_SHADER_OPTIMIZE AND SPIRV_OPT_EXECUTABLE)
+            SET(_flags ${_flags}
+                --spirv-opt ${SPIRV_OPT_EXECUTABLE}
+                $<$<NOT:$<CONFIG:Debug>>:--spirv-opt-flag=$<IF:$<CONFIG:MinSizeRel>,-Os,-O>>
+                $<$<NOT:$<CONFIG:Debug,RelWithDebInfo>>:--spirv-opt-flag=--strip-debug>
+            )
+        ELSEIF(NOON_SHADER_OPTIMIZE)
+            SET(_flags ${_flags}
+                $<$<NOT:$<CONFIG:Debug>>:--glslc-flag=$<IF:$<CONFIG:MinSizeRel>,-Os,-O>>
+            )
+        ENDIF()
+
+        # The shaders are byproducts so that Ninja will restat them, and only rebuild what
+        # depends on the shaders that actually changed
         ADD_CUSTOM_COMMAND(
-            OUTPUT ${_output}
+            OUTPUT ${_stamp}
+            BYPRODUCTS ${_shader_outputs}
             DEPFILE ${_depfile}
-            COMMAND ${Vulkan_GLSLC_EXECUTABLE}
+            COMMAND ${Python3_EXECUTABLE}
+                ${CMAKE_SOURCE_DIR}/Scripts/compile-shaders.py
+                --glslc ${Vulkan_GLSLC_EXECUTABLE}
+                --source-dir ${CMAKE_CURRENT_SOURCE_DIR}
+                --binary-dir ${CMAKE_CURRENT_BINARY_DIR}
+                --cache ${_cache}
+                --stamp ${_stamp}
+                --depfile ${_depfile}
                 ${_flags}
-                -MD -MF ${_depfile}
-                -o ${_output}
-                ${_input}
+                ${_input_list}
+            DEPENDS
+                ${_input_list}
+                ${CMAKE_SOURCE_DIR}/Scripts/compile-shaders.py
+            COMMENT "Compiling shaders for ${_name}"
+            COMMAND_EXPAND_LISTS
         )
 
-        LIST(APPEND ${_output_list} ${_output})
-    ENDFOREACH()
-ENDMACRO()
\ No newline at end of file
+        LIST(APPEND ${_output_list} ${_shader_outputs} ${_stamp})
+    ENDIF()
+ENDMACRO()
@@ -0,0 +1,50 @@
+# CookAssetList.cmake
+#
+# Cook a list of source assets into a single asset pack using the NoonCooker tool.
+#
+# The pack is stored as ${CMAKE_CURRENT_BINARY_DIR}/Asset/${_name}.pack, and each asset is
+# named by its path relative to ${_base_dir}. Models are split into one asset per mesh
+# primitive, material and image, named after the model, e.g. "Model/Mesh0.0". PNG images
+# are block-compressed into textures with mipmaps, and textures lose their .png or .ktx2
+# extension. Compiled shaders lose their .spv extension, as in PACK_SHADER_LIST, so the
+# output of COMPILE_SHADER_LIST can be passed along with ${CMAKE_CURRENT_BINARY_DIR} as the
+# base directory. The filename of the pack is stored in ${_output}.
+#
+# Inputs whose files and settings hash the same as the last time they were cooked are copied
+# from the previous pack, using a cache stored next to it. Files referenced by models are
+# reported through a DEPFILE, so editing a .bin or an image cooks the pack again.
+#
+
+# Allow Ninja to transform DEPFILEs
+IF(POLICY CMP0116)
+    CMAKE_POLICY(SET CMP0116 NEW)
+ENDIF()
+
+MACRO(COOK_ASSET_LIST _name _base_dir _input_list _output)
+    SET(_pack_dir "${CMAKE_CURRENT_BINARY_DIR}/Asset")
+    SET(_pack "${_pack_dir}/${_name}.pack")
+    SET(_depfile "${_pack_dir}/${_name}.pack.d")
+    SET(_cache "${_pack_dir}/${_name}.pack.cache")
+
+    SET(_pack_inputs ${_input_list})
+    LIST(FILTER _pack_inputs EXCLUDE REGEX "\\.stamp$")
+
+    FILE(MAKE_DIRECTORY ${_pack_dir})
+
+    ADD_CUSTOM_COMMAND(
+        OUTPUT ${_pack}
+        DEPFILE ${_depfile}
+        COMMAND NoonCooker
+            --output ${_pack}
+            --base-dir ${_base_dir}
+            --cache ${_cache}
+            --depfile ${_depfile}
+            ${_pack_inputs}
+        DEPENDS
+            ${_input_list}
+            NoonCooker
+        COMMENT "Cooking assets for ${_name}"
+    )
+
+    SET(${_output} ${_pack})
+ENDMACRO()
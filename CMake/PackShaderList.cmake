@@ -0,0 +1,40 @@
+# PackShaderList.cmake
+#
+# Pack a list of compiled shaders into a single bundle using Scripts/pack-shaders.py.
+#
+# The bundle is stored as ${CMAKE_CURRENT_BINARY_DIR}/Asset/Shader/${_name}.bundle, and each
+# shader is indexed by its path relative to that directory, without the .spv extension.
+# For example:
+#   ${CMAKE_CURRENT_BINARY_DIR}/Asset/Shader/Default.vert.spv
+# will be stored as "Default.vert". The filename of the bundle is stored in ${_output}.
+#
+# Only .spv files in ${_input_list} are packed. The bundle depends on the rest of the list, which
+# is expected to contain the stamp written by COMPILE_SHADER_LIST once every shader is up to date.
+#
+
+MACRO(PACK_SHADER_LIST _name _input_list _output)
+    SET(_bundle_dir "${CMAKE_CURRENT_BINARY_DIR}/Asset/Shader")
+    SET(_bundle "${_bundle_dir}/${_name}.bundle")
+
+    SET(_bundle_inputs ${_input_list})
+    LIST(FILTER _bundle_inputs INCLUDE REGEX "\\.spv$")
+
+    SET(_bundle_depends ${_input_list})
+    LIST(FILTER _bundle_depends EXCLUDE REGEX "\\.spv$")
+
+    FILE(MAKE_DIRECTORY ${_bundle_dir})
+
+    ADD_CUSTOM_COMMAND(
+        OUTPUT ${_bundle}
+        COMMAND ${Python3_EXECUTABLE}
+            ${CMAKE_SOURCE_DIR}/Scripts/pack-shaders.py
+            --output ${_bundle}
+            --base-dir ${_bundle_dir}
+            ${_bundle_inputs}
+        DEPENDS
+            ${_bundle_depends}
+            ${CMAKE_SOURCE_DIR}/Scripts/pack-shaders.py
+    )
+
+    SET(${_output} ${_bundle})
+ENDMACRO()
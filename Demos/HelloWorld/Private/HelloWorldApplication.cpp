@@ -1,5 +1,57 @@
 #include "HelloWorldApplication.hpp"
 
+#include <Noon/KTX2.hpp>
+#include <Noon/Log.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// Written on startup, so the demo has a texture to stream without shipping one
+static const char * StreamedTextureFilename = "HelloWorldStreamed.ktx2";
+
+static const uint32_t StreamedTextureSize = 2048;
+
+// A checkerboard with a different tint on every level, so the level being sampled is obvious
+static bool WriteStreamedTexture(const Path& path)
+{
+    List<List<uint8_t>> levelList;
+
+    for (uint32_t size = StreamedTextureSize; size > 0; size /= 2) {
+        uint32_t level = static_cast<uint32_t>(levelList.size());
+        uint32_t tileSize = std::max(64u >> level, 1u);
+
+        auto& pixels = levelList.emplace_back(size * size * 4);
+        for (uint32_t y = 0; y < size; ++y) {
+            for (uint32_t x = 0; x < size; ++x) {
+                bool isLight = ((x / tileSize + y / tileSize) % 2 == 0);
+
+                uint8_t * pixel = &pixels[(y * size + x) * 4];
+                pixel[0] = static_cast<uint8_t>(isLight ? 255 : 32 * (level % 8));
+                pixel[1] = static_cast<uint8_t>(isLight ? 255 : 255 - 24 * level);
+                pixel[2] = static_cast<uint8_t>(isLight ? 255 : 64);
+                pixel[3] = 255;
+            }
+        }
+    }
+
+    List<Span<const uint8_t>> spanList;
+    for (const auto& pixels : levelList) {
+        spanList.push_back(pixels);
+    }
+
+    List<uint8_t> data = KTX2File::Write(VK_FORMAT_R8G8B8A8_UNORM, StreamedTextureSize, StreamedTextureSize, spanList);
+
+    FILE * file = fopen(path.ToCString(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    bool written = (fwrite(data.data(), 1, data.size(), file) == data.size());
+    fclose(file);
+    return written;
+}
+
 Version HelloWorldApplication::GetVersion()
 {
     return Version(1, 0, 0);
@@ -15,4 +67,48 @@ void HelloWorldApplication::Init()
     Application::Init();
 
     GetGraphicsDriver()->SetWindowSize({ 1024, 768 });
+
+    Path path = GetCurrentPath() / StreamedTextureFilename;
+    if (!IsFile(path) && !WriteStreamedTexture(path)) {
+        Log(NOON_ANCHOR, "Unable to write '{}'", path);
+        return;
+    }
+
+    _streamedTextureID = GetTextureStreamer()->Add(path);
+}
+
+void HelloWorldApplication::Term()
+{
+    if (_streamedTextureID != InvalidStreamedTextureID) {
+        GetTextureStreamer()->Remove(_streamedTextureID);
+        _streamedTextureID = InvalidStreamedTextureID;
+    }
+
+    Application::Term();
+}
+
+void HelloWorldApplication::Update()
+{
+    if (_streamedTextureID == InvalidStreamedTextureID) {
+        return;
+    }
+
+    auto textureStreamer = GetTextureStreamer();
+
+    // From a few pixels to the full size and back, about every ten seconds at 60 FPS
+    float zoom = 0.5f - 0.5f * std::cos(static_cast<float>(_frameIndex) * 0.01f);
+    float screenSize = StreamedTextureSize * std::exp2(-8.0f * (1.0f - zoom));
+    ++_frameIndex;
+
+    textureStreamer->RequestScreenSize(_streamedTextureID, screenSize);
+
+    uint32_t residentLevel = textureStreamer->GetResidentLevel(_streamedTextureID);
+    if (residentLevel != _residentLevel) {
+        _residentLevel = residentLevel;
+
+        TextureStreamingStats stats = textureStreamer->GetStats();
+
+        Log(NOON_ANCHOR, "Streamed texture resident from level {}, {} KiB, {} levels loaded, {} evicted",
+            residentLevel, stats.ResidentBytes / 1024, stats.LevelsLoaded, stats.LevelsEvicted);
+    }
 }
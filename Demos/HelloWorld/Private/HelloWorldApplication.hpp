@@ -20,6 +20,21 @@ public:
 
     void Init() override;
 
+    void Term() override;
+
+protected:
+
+    // Zooms a streamed texture in and out, so its finer levels are read in and evicted
+    void Update() override;
+
+private:
+
+    StreamedTextureID _streamedTextureID = InvalidStreamedTextureID;
+
+    uint32_t _residentLevel = UINT32_MAX;
+
+    uint64_t _frameIndex = 0;
+
 };
 
 #endif // HELLO_WORLD_APPLICATION_HPP
\ No newline at end of file
@@ -0,0 +1,168 @@
+#version 450 core
+
+#include <Scene.inc.glsl>
+
+layout(local_size_x = 64) in;
+
+struct DrawIndexedIndirectCommand
+{
+    uint IndexCount;
+    uint InstanceCount;
+    uint FirstIndex;
+    int VertexOffset;
+    uint FirstInstance;
+
+};
+
+layout(set = SCENE_SET, binding = 2, std430) writeonly buffer NoonSceneDraws
+{
+    DrawIndexedIndirectCommand s_SceneDraws[];
+
+};
+
+// Cleared to zero before the dispatch
+layout(set = SCENE_SET, binding = 3, std430) buffer NoonSceneDrawCount
+{
+    uint s_SceneDrawCount;
+    uint s_SceneIndexCount;
+
+};
+
+struct SceneLOD
+{
+    uint FirstIndex;
+    uint IndexCount;
+    float Error;
+    uint Padding;
+
+};
+
+// SCENE_MAX_MESH_LOD_COUNT per mesh
+layout(set = SCENE_SET, binding = 4, std430) readonly buffer NoonSceneLODs
+{
+    SceneLOD s_SceneLODs[];
+
+};
+
+// The level each object was last drawn with, kept across frames
+layout(set = SCENE_SET, binding = 5, std430) buffer NoonSceneObjectLODs
+{
+    uint s_SceneObjectLODs[];
+
+};
+
+layout(push_constant) uniform NoonCull
+{
+    // Normalized, pointing inwards
+    vec4 u_FrustumPlanes[6];
+    // xyz is the camera position, w is the LOD scale over the threshold, or 0 when disabled
+    vec4 u_LODCamera;
+    uint u_ObjectCount;
+    uint u_FrustumCulling;
+    uint u_Compact;
+    float u_LODHysteresis;
+
+};
+
+bool IsSphereInFrustum(vec3 center, float radius)
+{
+    for (int i = 0; i < 6; ++i) {
+        if (dot(u_FrustumPlanes[i].xyz, center) + u_FrustumPlanes[i].w < -radius) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Matches SelectLOD(), with the threshold already folded into u_LODCamera.w
+uint SelectLOD(uint meshIndex, uint lodCount, vec3 center, float radius, uint currentLOD)
+{
+    if (lodCount <= 1 || u_LODCamera.w <= 0.0) {
+        return 0;
+    }
+
+    currentLOD = min(currentLOD, lodCount - 1);
+
+    float distance = length(center - u_LODCamera.xyz) - radius;
+    if (distance <= 0.0) {
+        return 0;
+    }
+
+    float errorScale = radius * u_LODCamera.w;
+    float coarserLimit = distance * (1.0 - u_LODHysteresis);
+
+    for (uint lod = lodCount - 1; lod > 0; --lod) {
+        float error = s_SceneLODs[meshIndex * SCENE_MAX_MESH_LOD_COUNT + lod].Error;
+        if (error * errorScale <= (lod > currentLOD ? coarserLimit : distance)) {
+            return lod;
+        }
+    }
+
+    return 0;
+}
+
+void main() {
+    uint objectIndex = gl_GlobalInvocationID.x;
+    if (objectIndex >= u_ObjectCount) {
+        return;
+    }
+
+    SceneObject object = s_SceneObjects[objectIndex];
+    SceneMesh mesh = s_SceneMeshes[object.MeshIndex];
+
+    bool visible = ((object.Flags & SCENE_OBJECT_ACTIVE) != 0);
+    bool selectLOD = (mesh.LODCount > 1 && u_LODCamera.w > 0.0);
+
+    uint lod = 0;
+
+    if (visible && (u_FrustumCulling != 0 || selectLOD)) {
+        mat4 model = GetSceneObjectModel(objectIndex);
+
+        // Scale the radius by the largest axis, so non-uniform scales stay conservative
+        float scale = max(
+            max(length(model[0].xyz), length(model[1].xyz)),
+            length(model[2].xyz));
+
+        vec3 center = (model * vec4(mesh.BoundingSphere.xyz, 1.0)).xyz;
+        float radius = mesh.BoundingSphere.w * scale;
+
+        if (u_FrustumCulling != 0) {
+            visible = IsSphereInFrustum(center, radius);
+        }
+
+        // Only visible objects update their level, like the CPU path
+        if (visible && selectLOD) {
+            lod = SelectLOD(object.MeshIndex, mesh.LODCount, center, radius, s_SceneObjectLODs[objectIndex]);
+            s_SceneObjectLODs[objectIndex] = lod;
+        }
+    }
+
+    SceneLOD range = s_SceneLODs[object.MeshIndex * SCENE_MAX_MESH_LOD_COUNT + lod];
+
+    DrawIndexedIndirectCommand draw;
+    draw.IndexCount = range.IndexCount;
+    draw.InstanceCount = 1;
+    draw.FirstIndex = range.FirstIndex;
+    draw.VertexOffset = mesh.VertexOffset;
+    draw.FirstInstance = objectIndex;
+
+    if (u_Compact != 0) {
+        if (visible) {
+            s_SceneDraws[atomicAdd(s_SceneDrawCount, 1)] = draw;
+        }
+    }
+    else {
+        // Every object keeps its slot, and invisible ones draw no instances
+        draw.InstanceCount = (visible ? 1 : 0);
+        s_SceneDraws[objectIndex] = draw;
+
+        if (visible) {
+            atomicAdd(s_SceneDrawCount, 1);
+        }
+    }
+
+    if (visible) {
+        atomicAdd(s_SceneIndexCount, draw.IndexCount);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef DUSK_INSTANCE_INC_GLSL
+#define DUSK_INSTANCE_INC_GLSL
+
+struct Instance
+{
+    // The first three rows of the model matrix
+    vec4 Model[3];
+
+};
+
+layout(binding = 2, std430) readonly buffer NoonInstances
+{
+    Instance s_Instances[];
+
+};
+
+mat4 GetInstanceModel()
+{
+    Instance instance = s_Instances[gl_InstanceIndex];
+    return transpose(mat4(
+        instance.Model[0],
+        instance.Model[1],
+        instance.Model[2],
+        vec4(0.0, 0.0, 0.0, 1.0)
+    ));
+}
+
+#endif // DUSK_INSTANCE_INC_GLSL
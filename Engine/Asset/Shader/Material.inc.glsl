@@ -1,7 +1,7 @@
 #ifndef DUSK_TRANSFORM_INC_GLSL
 #define DUSK_TRANSFORM_INC_GLSL
 
-layout(binding = 2, std140) uniform DuskMaterial
+layout(set = 1, binding = 0, std140) uniform DuskMaterial
 {
     vec4 u_BaseColorFactor;
     vec3 u_EmissiveFactor;
@@ -11,10 +11,10 @@ layout(binding = 2, std140) uniform DuskMaterial
     float u_NormalScale;
 };
 
-layout(binding = 0) uniform sampler2D u_BaseColorMap;
-layout(binding = 1) uniform sampler2D u_NormalMap;
-layout(binding = 2) uniform sampler2D u_MetallicRoughnessMap;
-layout(binding = 3) uniform sampler2D u_EmissiveMap;
-layout(binding = 4) uniform sampler2D u_OcclusionMap;
+layout(set = 1, binding = 1) uniform sampler2D u_BaseColorMap;
+layout(set = 1, binding = 2) uniform sampler2D u_NormalMap;
+layout(set = 1, binding = 3) uniform sampler2D u_MetallicRoughnessMap;
+layout(set = 1, binding = 4) uniform sampler2D u_EmissiveMap;
+layout(set = 1, binding = 5) uniform sampler2D u_OcclusionMap;
 
 #endif // DUSK_TRANSFORM_INC_GLSL
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef DUSK_SCENE_INC_GLSL
+#define DUSK_SCENE_INC_GLSL
+
+// The culling pass binds the scene as set 0, and the render pass as set 1
+#ifndef SCENE_SET
+#define SCENE_SET 0
+#endif
+
+const uint SCENE_OBJECT_ACTIVE = 1;
+
+// Matches MaxMeshLODCount
+const uint SCENE_MAX_MESH_LOD_COUNT = 8;
+
+struct SceneObject
+{
+    // The first three rows of the model matrix
+    vec4 Model[3];
+    uint MeshIndex;
+    uint Flags;
+    uint Padding[2];
+
+};
+
+struct SceneMesh
+{
+    // Center and radius in object space
+    vec4 BoundingSphere;
+    vec4 PositionScale;
+    vec4 PositionOffset;
+    uint IndexCount;
+    uint FirstIndex;
+    int VertexOffset;
+    uint LODCount;
+
+};
+
+layout(set = SCENE_SET, binding = 0, std430) readonly buffer NoonSceneObjects
+{
+    SceneObject s_SceneObjects[];
+
+};
+
+layout(set = SCENE_SET, binding = 1, std430) readonly buffer NoonSceneMeshes
+{
+    SceneMesh s_SceneMeshes[];
+
+};
+
+mat4 GetSceneObjectModel(uint objectIndex)
+{
+    SceneObject object = s_SceneObjects[objectIndex];
+    return transpose(mat4(
+        object.Model[0],
+        object.Model[1],
+        object.Model[2],
+        vec4(0.0, 0.0, 0.0, 1.0)
+    ));
+}
+
+#endif // DUSK_SCENE_INC_GLSL
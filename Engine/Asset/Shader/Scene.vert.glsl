@@ -0,0 +1,19 @@
+#version 450 core
+
+#define SCENE_SET 1
+
+#include <View.inc.glsl>
+#include <Scene.inc.glsl>
+#include <VertexAttributes.inc.glsl>
+
+layout(location = 0) out vec4 v_Color;
+
+// Every draw written by Cull.comp has a single instance, whose index is the object's
+void main() {
+    uint objectIndex = gl_InstanceIndex;
+    SceneMesh mesh = s_SceneMeshes[s_SceneObjects[objectIndex].MeshIndex];
+
+    mat4 model = GetSceneObjectModel(objectIndex);
+    gl_Position = u_ViewProj * model * DecodeVertexPosition(mesh.PositionScale, mesh.PositionOffset);
+    v_Color = model * GetVertexNormal();
+}
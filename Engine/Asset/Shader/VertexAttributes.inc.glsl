@@ -1,6 +1,8 @@
 #ifndef VERTEX_ATTRIBUTES_INC_GLSL
 #define VERTEX_ATTRIBUTES_INC_GLSL
 
+// Attributes may be quantized, see VertexFormat. Normalized formats are expanded by the
+// vertex fetch, the rest is decoded by the GetVertex* functions below.
 layout(location = 0) in vec4 a_Position;
 layout(location = 1) in vec4 a_Normal;
 layout(location = 2) in vec4 a_Tangent;
@@ -10,4 +12,54 @@ layout(location = 5) in vec2 a_TexCoord2;
 layout(location = 6) in uvec4 a_Joint;
 layout(location = 7) in vec4 a_Weight;
 
+// Normals and tangents are stored in a_Normal.xy and a_Tangent.xy, and the sign of the
+// bitangent is stored in a_Position.w
+layout(constant_id = 0) const bool c_OctahedralNormal = false;
+layout(constant_id = 1) const bool c_OctahedralTangent = false;
+
+layout(push_constant) uniform NoonMesh
+{
+    vec4 u_PositionScale;
+    vec4 u_PositionOffset;
+
+};
+
+vec3 OctahedralDecode(vec2 e)
+{
+    vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += (n.x >= 0.0 ? -t : t);
+    n.y += (n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+// For when the scale and offset come from somewhere other than the push constants
+vec4 DecodeVertexPosition(vec4 scale, vec4 offset)
+{
+    return vec4(a_Position.xyz * scale.xyz + offset.xyz, 1.0);
+}
+
+vec4 GetVertexPosition()
+{
+    return DecodeVertexPosition(u_PositionScale, u_PositionOffset);
+}
+
+vec4 GetVertexNormal()
+{
+    if (c_OctahedralNormal) {
+        return vec4(OctahedralDecode(a_Normal.xy), 0.0);
+    }
+
+    return vec4(normalize(a_Normal.xyz), 0.0);
+}
+
+vec4 GetVertexTangent()
+{
+    if (c_OctahedralTangent) {
+        return vec4(OctahedralDecode(a_Tangent.xy), (a_Position.w < 0.0 ? -1.0 : 1.0));
+    }
+
+    return a_Tangent;
+}
+
 #endif // VERTEX_ATTRIBUTES_INC_GLSL
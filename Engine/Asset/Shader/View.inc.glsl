@@ -0,0 +1,13 @@
+#ifndef DUSK_VIEW_INC_GLSL
+#define DUSK_VIEW_INC_GLSL
+
+layout(binding = 1, std140) uniform NoonView
+{
+    mat4 u_View;
+    mat4 u_Proj;
+    mat4 u_ViewProj;
+    vec4 u_CameraPosition;
+
+};
+
+#endif // DUSK_VIEW_INC_GLSL
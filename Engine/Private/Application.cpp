@@ -8,6 +8,14 @@ namespace noon {
 
 Application * Application::_Instance = nullptr;
 
+// Weight of the latest frame in FrameStats
+static const float FrameStatsSmoothing = 0.05f;
+
+static float ElapsedMS(std::chrono::high_resolution_clock::time_point start, std::chrono::high_resolution_clock::time_point end)
+{
+    return std::chrono::duration<float, std::milli>(end - start).count();
+}
+
 NOON_API
 Application::Application()
 {
@@ -23,13 +31,33 @@ Application::~Application()
 NOON_API
 void Application::Init()
 {
+    _jobSystem = new JobSystem;
+    _asyncIO = new AsyncIO;
+
+    _fileSystem = new FileSystem;
+
+    // Earlier asset paths are searched first, as with FindAssetFile()
+    auto assetPathList = GetAssetPathList();
+    for (size_t i = 0; i < assetPathList.size(); ++i) {
+        _fileSystem->MountDirectory(assetPathList[i], {}, -static_cast<int>(i));
+    }
+
     _graphicsDriver = new GraphicsDriver;
+    _textureStreamer = new TextureStreamer;
+    _assetManager = new AssetManager;
+    _world = new World;
 }
 
 NOON_API
 void Application::Term()
 {
+    delete _world;
+    delete _assetManager;
+    delete _textureStreamer;
     delete _graphicsDriver;
+    delete _fileSystem;
+    delete _asyncIO;
+    delete _jobSystem;
 }
 
 NOON_API
@@ -53,32 +81,96 @@ void Application::Run()
 
     auto startTime = high_resolution_clock::now();
     auto previousTime = startTime;
-    
-    _running = true;
-    while (_running) {
-        high_resolution_clock::time_point currentTime = high_resolution_clock::now();
-        auto totalDuration = duration_cast<milliseconds>(currentTime - startTime);
-        auto previousFrameDuration = duration_cast<microseconds>(currentTime - previousTime);
-        previousTime = currentTime;
 
-        // ctx->SetTotalDuration(totalDuration);
-        // ctx->SetPreviousFrameDuration(previousFrameDuration);
-        auto expectedFrameDuration = microseconds((int64_t)(1000000.0f / _targetFPS));
-        auto frameEndTime = currentTime + expectedFrameDuration;
+    try {
+        _running = true;
+        while (_running) {
+            high_resolution_clock::time_point currentTime = high_resolution_clock::now();
+            auto totalDuration = duration_cast<milliseconds>(currentTime - startTime);
+            auto previousFrameDuration = duration_cast<microseconds>(currentTime - previousTime);
+            if (currentTime != startTime) {
+                UpdateFrameStats(_frameStats.FrameMS, ElapsedMS(previousTime, currentTime));
+            }
+            previousTime = currentTime;
+
+            // ctx->SetTotalDuration(totalDuration);
+            // ctx->SetPreviousFrameDuration(previousFrameDuration);
+            auto expectedFrameDuration = microseconds((int64_t)(1000000.0f / _targetFPS));
+            auto frameEndTime = currentTime + expectedFrameDuration;
+
+
+            _graphicsDriver->ProcessEvents();
+
+            _jobSystem->ProcessMainThreadJobs();
+
+            _world->RunSystems();
+
+            Update();
+
+            auto simulationEndTime = high_resolution_clock::now();
+
+            // The previous frame is still rendering from what PreRender() touches
+            WaitForRender();
+
+            auto preRenderStartTime = high_resolution_clock::now();
+
+            // Replaces images, so PreRender() sees the textures this frame will sample
+            _textureStreamer->Update();
+
+            // Uploads what finished loading, so handles resolve this frame
+            _assetManager->Update();
 
+            PreRender();
 
-        _graphicsDriver->ProcessEvents();
+            _graphicsDriver->SwapRenderSnapshot();
 
-        _graphicsDriver->Render();
+            auto renderStartTime = high_resolution_clock::now();
 
+            UpdateFrameStats(_frameStats.SimulationMS,
+                ElapsedMS(currentTime, simulationEndTime) + ElapsedMS(preRenderStartTime, renderStartTime));
 
-        currentTime = high_resolution_clock::now();
-        auto timeToSleep = duration_cast<milliseconds>(frameEndTime - currentTime);
-        if (timeToSleep > 1ms) { // TODO: Find "minimum" sleep time
-            std::this_thread::sleep_for(timeToSleep);
+            if (_pipelined) {
+                if (!_renderThreadRunning) {
+                    _renderThreadRunning = true;
+                    _renderThread = std::thread(&Application::RenderThreadMain, this);
+                }
+
+                std::lock_guard lock(_renderMutex);
+                _renderFrameStartTime = currentTime;
+                _renderRequested = true;
+                _renderInFlight = true;
+                _renderCondition.notify_one();
+            }
+            else {
+                StopRenderThread();
+
+                _graphicsDriver->Render();
+
+                auto renderEndTime = high_resolution_clock::now();
+                UpdateFrameStats(_frameStats.RenderMS, ElapsedMS(renderStartTime, renderEndTime));
+                UpdateFrameStats(_frameStats.LatencyMS, ElapsedMS(currentTime, renderEndTime));
+            }
+
+
+            currentTime = high_resolution_clock::now();
+            auto timeToSleep = duration_cast<milliseconds>(frameEndTime - currentTime);
+            if (timeToSleep > 1ms) { // TODO: Find "minimum" sleep time
+                std::this_thread::sleep_for(timeToSleep);
+            }
         }
+
+        WaitForRender();
+    }
+    catch (...) {
+        StopRenderThread();
+        throw;
     }
 
+    StopRenderThread();
+
+    Log(NOON_ANCHOR, "Frame {:.2f}ms, simulation {:.2f}ms, render {:.2f}ms, latency {:.2f}ms",
+        _frameStats.FrameMS, _frameStats.SimulationMS, _frameStats.RenderMS, _frameStats.LatencyMS);
+
     Term();
 }
 
@@ -87,4 +179,107 @@ void Application::Stop()
     _running = false;
 }
 
+void Application::Update()
+{
+}
+
+void Application::PreRender()
+{
+}
+
+void Application::RenderThreadMain()
+{
+    using namespace std::chrono;
+
+    while (true) {
+        high_resolution_clock::time_point frameStartTime;
+        {
+            std::unique_lock lock(_renderMutex);
+            _renderCondition.wait(lock, [this]() {
+                return (_renderRequested || !_renderThreadRunning);
+            });
+
+            if (!_renderRequested) {
+                break;
+            }
+
+            frameStartTime = _renderFrameStartTime;
+        }
+
+        auto renderStartTime = high_resolution_clock::now();
+
+        std::exception_ptr exception;
+        try {
+            _graphicsDriver->Render();
+        }
+        catch (...) {
+            exception = std::current_exception();
+        }
+
+        auto renderEndTime = high_resolution_clock::now();
+
+        std::lock_guard lock(_renderMutex);
+        _lastRenderMS = ElapsedMS(renderStartTime, renderEndTime);
+        _lastLatencyMS = ElapsedMS(frameStartTime, renderEndTime);
+        _renderException = exception;
+        _renderRequested = false;
+        _renderCondition.notify_all();
+    }
+}
+
+void Application::WaitForRender()
+{
+    if (!_renderInFlight) {
+        return;
+    }
+
+    _renderInFlight = false;
+
+    std::exception_ptr exception;
+    {
+        std::unique_lock lock(_renderMutex);
+        _renderCondition.wait(lock, [this]() {
+            return !_renderRequested;
+        });
+
+        UpdateFrameStats(_frameStats.RenderMS, _lastRenderMS);
+        UpdateFrameStats(_frameStats.LatencyMS, _lastLatencyMS);
+
+        exception = _renderException;
+        _renderException = nullptr;
+    }
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+void Application::StopRenderThread()
+{
+    if (!_renderThreadRunning) {
+        return;
+    }
+
+    _renderInFlight = false;
+
+    {
+        std::lock_guard lock(_renderMutex);
+        _renderThreadRunning = false;
+        _renderCondition.notify_all();
+    }
+
+    // Finishes the frame it was asked to render first
+    _renderThread.join();
+}
+
+void Application::UpdateFrameStats(float& average, float ms)
+{
+    if (average == 0.0f) {
+        average = ms;
+    }
+    else {
+        average += (ms - average) * FrameStatsSmoothing;
+    }
+}
+
 } // namespace noon
\ No newline at end of file
@@ -0,0 +1,475 @@
+#include <Noon/AssetManager.hpp>
+#include <Noon/Application.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/KTX2.hpp>
+#include <Noon/Log.hpp>
+
+#include <cstring>
+
+namespace noon {
+
+AssetManager * AssetManager::_Instance = nullptr;
+
+static uint32_t GetIndex(AssetID id)
+{
+    return static_cast<uint32_t>(id);
+}
+
+static uint32_t GetGeneration(AssetID id)
+{
+    return static_cast<uint32_t>(id >> 32);
+}
+
+static AssetID MakeAssetID(uint32_t index, uint32_t generation)
+{
+    return (AssetID(generation) << 32) | index;
+}
+
+static StringView GetMapName(const char (&name)[PackedMaterial::MaxNameLength + 1])
+{
+    return StringView(name, strnlen(name, sizeof(name)));
+}
+
+NOON_API
+String AssetStateToString(AssetState state)
+{
+    switch (state) {
+    case AssetState::Unloaded:
+        return "Unloaded";
+    case AssetState::Loading:
+        return "Loading";
+    case AssetState::Resident:
+        return "Resident";
+    case AssetState::Evicting:
+        return "Evicting";
+    case AssetState::Failed:
+        return "Failed";
+    }
+
+    return "Unknown";
+}
+
+NOON_API
+AssetManager::AssetManager()
+{
+    if (_Instance) {
+        throw Exception("Only one AssetManager can exist at a time");
+    }
+
+    if (!JobSystem::GetInstance()) {
+        throw Exception("AssetManager requires a JobSystem");
+    }
+
+    if (!FileSystem::GetInstance()) {
+        throw Exception("AssetManager requires a FileSystem");
+    }
+
+    static const uint8_t WhitePixel[] = { 0xFF, 0xFF, 0xFF, 0xFF };
+    Span<const uint8_t> whiteLevel(WhitePixel);
+
+    SetFallback(std::make_shared<Texture>(VK_FORMAT_R8G8B8A8_UNORM, 1, 1, Span<const Span<const uint8_t>>(&whiteLevel, 1), false));
+    SetFallback(std::make_shared<Material>());
+
+    _Instance = this;
+}
+
+NOON_API
+AssetManager::~AssetManager()
+{
+    JobSystem::GetInstance()->Wait(_jobCounter);
+
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+    vkDeviceWaitIdle(gfx->GetDevice());
+
+    // Materials release their textures as they are destroyed, which needs _Instance and the
+    // lock, so objects are taken out first and destroyed after
+    List<std::shared_ptr<void>> destroyList;
+    {
+        std::unique_lock lock(_mutex);
+
+        uint32_t slotCount = _slotCount.load(std::memory_order_relaxed);
+        for (uint32_t index = 0; index < slotCount; ++index) {
+            Slot& slot = GetSlot(index);
+            slot.Pointer.store(nullptr, std::memory_order_relaxed);
+            destroyList.push_back(std::move(slot.Object));
+            slot.File = {};
+        }
+    }
+
+    destroyList.clear();
+
+    for (auto& fallback : _fallbackList) {
+        fallback.reset();
+    }
+
+    _Instance = nullptr;
+}
+
+NOON_API
+AssetID AssetManager::Acquire(StringView name, AssetType type)
+{
+    std::unique_lock lock(_mutex);
+
+    auto it = _nameMap.find(String(name));
+    if (it != _nameMap.end()) {
+        Slot& slot = GetSlot(GetIndex(it->second));
+        if (slot.Type != type) {
+            Log(NOON_ANCHOR, "Asset '{}' was requested as a {}, but is a {}",
+                name, AssetTypeToString(type), AssetTypeToString(slot.Type));
+            return InvalidAssetID;
+        }
+
+        slot.ReferenceCount.fetch_add(1, std::memory_order_relaxed);
+
+        // Still around, so it can be used again without reloading. Failed assets are evicted
+        // too, and have no object to revive, so they go back to being Failed until freed.
+        if (slot.State.load(std::memory_order_relaxed) == AssetState::Evicting) {
+            if (slot.Object) {
+                slot.Pointer.store(slot.Object.get(), std::memory_order_release);
+                slot.State.store(AssetState::Resident, std::memory_order_release);
+            }
+            else {
+                slot.State.store(AssetState::Failed, std::memory_order_release);
+            }
+        }
+
+        return it->second;
+    }
+
+    uint32_t index;
+    if (!_freeList.empty()) {
+        index = _freeList.back();
+        _freeList.pop_back();
+    }
+    else {
+        index = _slotCount.load(std::memory_order_relaxed);
+        if (index == MaxAssetCount) {
+            Log(NOON_ANCHOR, "Failed to load asset '{}', the limit of {} assets was reached", name, MaxAssetCount);
+            return InvalidAssetID;
+        }
+
+        auto& page = _pageList[index / SlotsPerPage];
+        if (!page) {
+            page.reset(new Slot[SlotsPerPage]);
+        }
+
+        _slotCount.store(index + 1, std::memory_order_release);
+    }
+
+    Slot& slot = GetSlot(index);
+    slot.Type = type;
+    slot.Name = name;
+    slot.LoadFailed = false;
+    slot.ReferenceCount.store(1, std::memory_order_relaxed);
+    slot.State.store(AssetState::Loading, std::memory_order_release);
+
+    AssetID id = MakeAssetID(index, slot.Generation.load(std::memory_order_relaxed));
+    _nameMap.emplace(slot.Name, id);
+
+    JobSystem::GetInstance()->Schedule(
+        [this, index]() {
+            LoadSlot(index);
+        },
+        &_jobCounter);
+
+    return id;
+}
+
+NOON_API
+AssetManager::Slot * AssetManager::GetSlot(AssetID id) const
+{
+    uint32_t index = GetIndex(id);
+    if (id == InvalidAssetID || index >= _slotCount.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    Slot& slot = GetSlot(index);
+    if (slot.Generation.load(std::memory_order_acquire) != GetGeneration(id)) {
+        return nullptr;
+    }
+
+    return &slot;
+}
+
+NOON_API
+void AssetManager::LoadSlot(uint32_t index)
+{
+    Slot& slot = GetSlot(index);
+
+    // Meshes and textures are uploaded from the main thread, so their data is read into memory
+    // here instead of being paged in from a mapping there
+    bool isUploaded = (slot.Type == AssetType::Mesh || slot.Type == AssetType::Texture);
+    FileReadMode mode = (isUploaded ? FileReadMode::Buffer : FileReadMode::PreferMapped);
+
+    bool isValid = false;
+
+    // Jobs can't throw, a failed load leaves the asset Failed
+    try {
+        FileData file = FileSystem::GetInstance()->Read(slot.Name, mode);
+        auto data = file.GetData();
+
+        if (!file.IsValid()) {
+            Log(NOON_ANCHOR, "Asset '{}' was not found", slot.Name);
+        }
+        else if (!AssetPack::ValidateAsset(slot.Type, data)) {
+            Log(NOON_ANCHOR, "Asset '{}' is not a valid {}", slot.Name, AssetTypeToString(slot.Type));
+        }
+        else if (slot.Type == AssetType::Shader) {
+            slot.Object = std::make_shared<Shader>(Span<const uint32_t>(
+                reinterpret_cast<const uint32_t *>(data.data()),
+                data.size() / sizeof(uint32_t)));
+            isValid = true;
+        }
+        else if (slot.Type == AssetType::Material) {
+            const auto * packedMaterial = reinterpret_cast<const PackedMaterial *>(data.data());
+
+            auto material = std::make_shared<Material>();
+            material->Parameters = packedMaterial->Parameters;
+            material->DoubleSided = (packedMaterial->DoubleSided != 0);
+
+            auto loadMap = [this](const auto& name) {
+                StringView mapName = GetMapName(name);
+                return (mapName.empty() ? AssetHandle<Texture>() : Load<Texture>(mapName));
+            };
+
+            material->BaseColorMap = loadMap(packedMaterial->BaseColorMap);
+            material->NormalMap = loadMap(packedMaterial->NormalMap);
+            material->MetallicRoughnessMap = loadMap(packedMaterial->MetallicRoughnessMap);
+            material->EmissiveMap = loadMap(packedMaterial->EmissiveMap);
+            material->OcclusionMap = loadMap(packedMaterial->OcclusionMap);
+
+            slot.Object = std::move(material);
+            isValid = true;
+        }
+        else if (isUploaded) {
+            slot.File = std::move(file);
+            isValid = true;
+        }
+        else {
+            Log(NOON_ANCHOR, "Asset '{}' is a {}, which can't be loaded", slot.Name, AssetTypeToString(slot.Type));
+        }
+    }
+    catch (std::exception& e) {
+        Log(NOON_ANCHOR, "Failed to load asset '{}', {}", slot.Name, e.what());
+        slot.Object.reset();
+        slot.File = {};
+    }
+
+    std::unique_lock lock(_mutex);
+    slot.LoadFailed = !isValid;
+    _loadedQueue.push_back(index);
+}
+
+NOON_API
+bool AssetManager::UploadSlot(Slot& slot)
+{
+    try {
+        if (slot.Type == AssetType::Mesh) {
+            slot.Object = AssetPack::UploadMesh(slot.File.GetData());
+        }
+        else {
+            KTX2File file;
+            if (!file.Parse(slot.File.GetData())) {
+                throw Exception("Invalid KTX2 data");
+            }
+
+            slot.Object = std::make_shared<Texture>(file);
+        }
+    }
+    catch (std::exception& e) {
+        Log(NOON_ANCHOR, "Failed to upload asset '{}', {}", slot.Name, e.what());
+        slot.Object.reset();
+    }
+
+    slot.File = {};
+    return (slot.Object != nullptr);
+}
+
+NOON_API
+void AssetManager::FreeSlot(uint32_t index, List<std::shared_ptr<void>>& destroyList)
+{
+    Slot& slot = GetSlot(index);
+
+    _nameMap.erase(slot.Name);
+
+    slot.Pointer.store(nullptr, std::memory_order_relaxed);
+    destroyList.push_back(std::move(slot.Object));
+    slot.File = {};
+    slot.Name.clear();
+    slot.State.store(AssetState::Unloaded, std::memory_order_relaxed);
+
+    // Stale IDs stop matching, skipping 0 so no ID is ever InvalidAssetID
+    uint32_t generation = slot.Generation.load(std::memory_order_relaxed) + 1;
+    slot.Generation.store((generation == 0 ? 1 : generation), std::memory_order_release);
+
+    _freeList.push_back(index);
+}
+
+NOON_API
+void AssetManager::Update()
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    ++_frameIndex;
+
+    // Upload what finished loading, in the order it finished, until the budget is spent. The
+    // rest is left queued for the next frames.
+    uint64_t uploadBytes = 0;
+    List<uint32_t> finishedList;
+
+    while (true) {
+        uint32_t index;
+        {
+            std::unique_lock lock(_mutex);
+            if (_loadedQueue.empty()) {
+                break;
+            }
+
+            index = _loadedQueue.front();
+
+            Slot& slot = GetSlot(index);
+            uint64_t size = slot.File.GetSize();
+            if (uploadBytes > 0 && uploadBytes + size > _maxUploadBytes) {
+                break;
+            }
+
+            uploadBytes += size;
+            _loadedQueue.pop_front();
+        }
+
+        Slot& slot = GetSlot(index);
+
+        bool isValid = !slot.LoadFailed;
+        if (isValid && !slot.Object) {
+            isValid = UploadSlot(slot);
+        }
+
+        {
+            std::unique_lock lock(_mutex);
+            slot.Pointer.store(slot.Object.get(), std::memory_order_release);
+            slot.State.store((isValid ? AssetState::Resident : AssetState::Failed), std::memory_order_release);
+        }
+
+        finishedList.push_back(index);
+    }
+
+    List<std::shared_ptr<void>> destroyList;
+    {
+        std::unique_lock lock(_mutex);
+
+        // Slots released while loading are only evicted once they finish
+        auto evict = [&](uint32_t index) {
+            Slot& slot = GetSlot(index);
+            AssetState state = slot.State.load(std::memory_order_relaxed);
+            if (slot.ReferenceCount.load(std::memory_order_acquire) > 0 || (state != AssetState::Resident && state != AssetState::Failed)) {
+                return;
+            }
+
+            slot.Pointer.store(nullptr, std::memory_order_relaxed);
+            slot.State.store(AssetState::Evicting, std::memory_order_release);
+            slot.EvictFrameIndex = _frameIndex;
+            _evictingList.push_back(index);
+        };
+
+        for (uint32_t index : _releasedList) {
+            evict(index);
+        }
+
+        for (uint32_t index : finishedList) {
+            evict(index);
+        }
+
+        _releasedList.clear();
+
+        // Resident or Failed again if requested in the meantime, otherwise freed once no frame
+        // in flight can still be using it
+        uint64_t backbufferCount = gfx->GetBackbufferCount();
+        std::erase_if(_evictingList,
+            [&](uint32_t index) {
+                Slot& slot = GetSlot(index);
+                if (slot.State.load(std::memory_order_relaxed) != AssetState::Evicting) {
+                    return true;
+                }
+
+                if (_frameIndex - slot.EvictFrameIndex < backbufferCount) {
+                    return false;
+                }
+
+                FreeSlot(index, destroyList);
+                return true;
+            }
+        );
+    }
+
+    // Outside the lock, as materials release their textures
+    destroyList.clear();
+}
+
+NOON_API
+AssetState AssetManager::GetState(AssetID id) const
+{
+    const Slot * slot = GetSlot(id);
+    return (slot ? slot->State.load(std::memory_order_acquire) : AssetState::Unloaded);
+}
+
+NOON_API
+void * AssetManager::GetObject(AssetID id) const
+{
+    const Slot * slot = GetSlot(id);
+    return (slot ? slot->Pointer.load(std::memory_order_acquire) : nullptr);
+}
+
+NOON_API
+void AssetManager::AddReference(AssetID id)
+{
+    Slot * slot = GetSlot(id);
+    if (slot) {
+        slot->ReferenceCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+NOON_API
+void AssetManager::RemoveReference(AssetID id)
+{
+    Slot * slot = GetSlot(id);
+    if (slot && slot->ReferenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::unique_lock lock(_mutex);
+        _releasedList.push_back(GetIndex(id));
+    }
+}
+
+NOON_API
+AssetStats AssetManager::GetStats() const
+{
+    AssetStats stats = {};
+
+    std::unique_lock lock(_mutex);
+
+    uint32_t slotCount = _slotCount.load(std::memory_order_relaxed);
+    for (uint32_t index = 0; index < slotCount; ++index) {
+        switch (GetSlot(index).State.load(std::memory_order_relaxed)) {
+        case AssetState::Unloaded:
+            continue;
+        case AssetState::Loading:
+            ++stats.LoadingCount;
+            break;
+        case AssetState::Resident:
+            ++stats.ResidentCount;
+            break;
+        case AssetState::Evicting:
+            ++stats.EvictingCount;
+            break;
+        case AssetState::Failed:
+            ++stats.FailedCount;
+            break;
+        }
+
+        ++stats.AssetCount;
+    }
+
+    stats.PendingUploadCount = static_cast<uint32_t>(_loadedQueue.size());
+
+    return stats;
+}
+
+} // namespace noon
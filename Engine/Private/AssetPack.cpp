@@ -0,0 +1,383 @@
+#include <Noon/AssetPack.hpp>
+#include <Noon/Hash.hpp>
+#include <Noon/KTX2.hpp>
+#include <Noon/Log.hpp>
+#include <Noon/ShaderBundle.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace noon {
+
+// Offsets and sizes come straight from the file, so this is written so no sum can wrap around
+static inline bool IsRangeInSize(uint64_t offset, uint64_t length, uint64_t size)
+{
+    return (offset <= size && length <= size - offset);
+}
+
+// Out of range indices would have the GPU fetch vertices past the end of the buffer
+template <typename T>
+static bool AreIndicesInRange(const uint8_t * data, size_t count, uint32_t vertexCount)
+{
+    for (size_t i = 0; i < count; ++i) {
+        T index;
+        memcpy(&index, data + i * sizeof(T), sizeof(T));
+        if (index >= vertexCount) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+NOON_API
+String AssetTypeToString(AssetType type)
+{
+    switch (type) {
+    case AssetType::Raw:
+        return "Raw";
+    case AssetType::Shader:
+        return "Shader";
+    case AssetType::Mesh:
+        return "Mesh";
+    case AssetType::Material:
+        return "Material";
+    case AssetType::Texture:
+        return "Texture";
+    }
+
+    return "Unknown";
+}
+
+NOON_API
+bool AssetPack::Open(const Path& path)
+{
+    Close();
+
+    if (!_file.Open(path)) {
+        return false;
+    }
+
+    const uint8_t * data = _file.GetData();
+    size_t size = _file.GetSize();
+
+    if (size < sizeof(Header)) {
+        Log(NOON_ANCHOR, "Asset pack '{}' is truncated", path);
+        Close();
+        return false;
+    }
+
+    const auto * header = reinterpret_cast<const Header *>(data);
+
+    if (header->Magic != Magic || header->Version != FormatVersion) {
+        Log(NOON_ANCHOR, "Asset pack '{}' has an unsupported format", path);
+        Close();
+        return false;
+    }
+
+    if (header->EntryCount > (size - sizeof(Header)) / sizeof(Entry)) {
+        Log(NOON_ANCHOR, "Asset pack '{}' is truncated", path);
+        Close();
+        return false;
+    }
+
+    _entryList = reinterpret_cast<const Entry *>(data + sizeof(Header));
+
+    for (size_t i = 0; i < header->EntryCount; ++i) {
+        if (!ValidateEntry(_entryList[i])) {
+            Log(NOON_ANCHOR, "Asset pack '{}' has an invalid entry #{}", path, i);
+            Close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+NOON_API
+void AssetPack::Close()
+{
+    _entryList = nullptr;
+    _file.Close();
+}
+
+NOON_API
+size_t AssetPack::GetAssetCount() const
+{
+    if (!IsOpen()) {
+        return 0;
+    }
+
+    return reinterpret_cast<const Header *>(_file.GetData())->EntryCount;
+}
+
+NOON_API
+Span<const uint8_t> AssetPack::Find(StringView name, AssetType type) const
+{
+    const Entry * entry = FindEntry(name);
+    if (!entry || entry->Type != type) {
+        return {};
+    }
+
+    return Span<const uint8_t>(_file.GetData() + entry->DataOffset, entry->DataSize);
+}
+
+NOON_API
+bool AssetPack::Find(StringView name, Span<const uint8_t>& data, AssetType * type) const
+{
+    const Entry * entry = FindEntry(name);
+    if (!entry) {
+        return false;
+    }
+
+    data = Span<const uint8_t>(_file.GetData() + entry->DataOffset, entry->DataSize);
+
+    if (type) {
+        *type = entry->Type;
+    }
+
+    return true;
+}
+
+NOON_API
+Span<const uint32_t> AssetPack::FindShader(StringView name) const
+{
+    auto data = Find(name, AssetType::Shader);
+    return Span<const uint32_t>(
+        reinterpret_cast<const uint32_t *>(data.data()),
+        data.size() / sizeof(uint32_t));
+}
+
+NOON_API
+const PackedMesh * AssetPack::FindMesh(StringView name) const
+{
+    auto data = Find(name, AssetType::Mesh);
+    return (data.empty() ? nullptr : reinterpret_cast<const PackedMesh *>(data.data()));
+}
+
+NOON_API
+const PackedMaterial * AssetPack::FindMaterial(StringView name) const
+{
+    auto data = Find(name, AssetType::Material);
+    return (data.empty() ? nullptr : reinterpret_cast<const PackedMaterial *>(data.data()));
+}
+
+NOON_API
+std::unique_ptr<Mesh> AssetPack::CreateMesh(StringView name) const
+{
+    auto data = Find(name, AssetType::Mesh);
+    if (data.empty()) {
+        return nullptr;
+    }
+
+    return UploadMesh(data);
+}
+
+NOON_API
+std::unique_ptr<Mesh> AssetPack::UploadMesh(Span<const uint8_t> data)
+{
+    const auto * packedMesh = reinterpret_cast<const PackedMesh *>(data.data());
+
+    VertexFormat vertexFormat;
+    for (size_t i = 0; i < VertexAttributeCount; ++i) {
+        vertexFormat.SetEncoding(
+            static_cast<VertexAttribute>(i),
+            static_cast<VertexEncoding>(packedMesh->EncodingList[i]));
+    }
+
+    const uint8_t * base = reinterpret_cast<const uint8_t *>(packedMesh);
+
+    // The table directly follows the PackedMesh, which keeps it 4-byte aligned
+    const auto * lodList = reinterpret_cast<const MeshLOD *>(base + sizeof(PackedMesh));
+
+    return std::make_unique<Mesh>(
+        vertexFormat,
+        packedMesh->Shader,
+        packedMesh->VertexCount,
+        Span<const uint8_t>(base + packedMesh->VertexOffset, size_t(packedMesh->VertexCount) * vertexFormat.GetStride()),
+        (packedMesh->IndexSize == sizeof(uint32_t) ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16),
+        packedMesh->IndexCount,
+        Span<const uint8_t>(base + packedMesh->IndexOffset, size_t(packedMesh->IndexCount) * packedMesh->IndexSize),
+        Span<const MeshLOD>(lodList, packedMesh->LODCount));
+}
+
+NOON_API
+std::unique_ptr<Texture> AssetPack::CreateTexture(StringView name, MemoryPool memoryPool) const
+{
+    auto data = Find(name, AssetType::Texture);
+    if (data.empty()) {
+        return nullptr;
+    }
+
+    // Already validated when the pack was opened
+    KTX2File file;
+    file.Parse(data);
+
+    return std::make_unique<Texture>(file, memoryPool);
+}
+
+const AssetPack::Entry * AssetPack::FindEntry(StringView name) const
+{
+    if (!IsOpen()) {
+        return nullptr;
+    }
+
+    const uint8_t * data = _file.GetData();
+    const Entry * begin = _entryList;
+    const Entry * end = _entryList + GetAssetCount();
+
+    uint64_t hash = HashFNV1a(name);
+
+    auto it = std::lower_bound(begin, end, hash,
+        [](const Entry& entry, uint64_t hash) {
+            return entry.NameHash < hash;
+        }
+    );
+
+    for (; it != end && it->NameHash == hash; ++it) {
+        StringView entryName(
+            reinterpret_cast<const char *>(data + it->NameOffset),
+            it->NameLength);
+
+        if (entryName == name) {
+            return it;
+        }
+    }
+
+    return nullptr;
+}
+
+bool AssetPack::ValidateEntry(const Entry& entry) const
+{
+    size_t size = _file.GetSize();
+
+    bool isValid = (
+        IsRangeInSize(entry.NameOffset, entry.NameLength, size) &&
+        IsRangeInSize(entry.DataOffset, entry.DataSize, size) &&
+        (entry.DataOffset % DataAlignment) == 0
+    );
+
+    if (!isValid) {
+        return false;
+    }
+
+    return ValidateAsset(entry.Type, Span<const uint8_t>(_file.GetData() + entry.DataOffset, entry.DataSize));
+}
+
+NOON_API
+bool AssetPack::ValidateAsset(AssetType type, Span<const uint8_t> asset)
+{
+    const uint8_t * data = asset.data();
+    size_t size = asset.size();
+
+    switch (type) {
+    case AssetType::Raw:
+        return true;
+    case AssetType::Shader: {
+        if (size < sizeof(uint32_t) || (size % sizeof(uint32_t)) != 0) {
+            return false;
+        }
+
+        uint32_t magic;
+        memcpy(&magic, data, sizeof(magic));
+        return (magic == ShaderBundle::SPIRVMagic);
+    }
+    case AssetType::Mesh: {
+        if (size < sizeof(PackedMesh)) {
+            return false;
+        }
+
+        const auto * mesh = reinterpret_cast<const PackedMesh *>(data);
+
+        // The stride isn't known without building the format, but every encoding takes at
+        // least a byte per vertex, so this bounds the count before it is multiplied
+        if (mesh->VertexCount == 0 || !IsRangeInSize(mesh->VertexOffset, mesh->VertexCount, size)) {
+            return false;
+        }
+
+        for (uint8_t encoding : mesh->EncodingList) {
+            if (encoding > static_cast<uint8_t>(VertexEncoding::Octahedral8)) {
+                return false;
+            }
+        }
+
+        VertexFormat vertexFormat;
+        try {
+            for (size_t i = 0; i < VertexAttributeCount; ++i) {
+                vertexFormat.SetEncoding(
+                    static_cast<VertexAttribute>(i),
+                    static_cast<VertexEncoding>(mesh->EncodingList[i]));
+            }
+        }
+        catch (...) {
+            return false;
+        }
+
+        if (mesh->LODCount > MaxMeshLODCount || sizeof(PackedMesh) + (mesh->LODCount * sizeof(MeshLOD)) > size) {
+            return false;
+        }
+
+        // The levels of detail cover the same indices, so they are checked along with the rest
+        if (mesh->LODCount == 0 && mesh->IndexCount % 3 != 0) {
+            return false;
+        }
+
+        const auto * lodList = reinterpret_cast<const MeshLOD *>(data + sizeof(PackedMesh));
+        for (uint32_t i = 0; i < mesh->LODCount; ++i) {
+            if (lodList[i].IndexCount % 3 != 0 || uint64_t(lodList[i].FirstIndex) + lodList[i].IndexCount > mesh->IndexCount) {
+                return false;
+            }
+        }
+
+        size_t vertexSize = size_t(mesh->VertexCount) * vertexFormat.GetStride();
+        size_t indexSize = size_t(mesh->IndexCount) * mesh->IndexSize;
+
+        bool isValid = (
+            (mesh->IndexSize == 0 || mesh->IndexSize == sizeof(uint16_t) || mesh->IndexSize == sizeof(uint32_t)) &&
+            (mesh->IndexCount == 0 || mesh->IndexSize != 0) &&
+            IsRangeInSize(mesh->VertexOffset, vertexSize, size) &&
+            IsRangeInSize(mesh->IndexOffset, indexSize, size)
+        );
+
+        if (!isValid || mesh->IndexCount == 0) {
+            return isValid;
+        }
+
+        const uint8_t * indices = data + mesh->IndexOffset;
+        if (mesh->IndexSize == sizeof(uint16_t)) {
+            return AreIndicesInRange<uint16_t>(indices, mesh->IndexCount, mesh->VertexCount);
+        }
+
+        return AreIndicesInRange<uint32_t>(indices, mesh->IndexCount, mesh->VertexCount);
+    }
+    case AssetType::Material: {
+        if (size < sizeof(PackedMaterial)) {
+            return false;
+        }
+
+        // Texture names must be terminated within their arrays
+        const auto * material = reinterpret_cast<const PackedMaterial *>(data);
+        for (const char * name : {
+            material->BaseColorMap,
+            material->NormalMap,
+            material->MetallicRoughnessMap,
+            material->EmissiveMap,
+            material->OcclusionMap,
+        }) {
+            if (!memchr(name, '\0', PackedMaterial::MaxNameLength + 1)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+    case AssetType::Texture: {
+        KTX2File file;
+        return file.Parse(asset);
+    }
+    }
+
+    return false;
+}
+
+} // namespace noon
@@ -0,0 +1,254 @@
+#include <Noon/AssetPackWriter.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/Hash.hpp>
+#include <Noon/Log.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    #include <Windows.h>
+
+#endif
+
+namespace noon {
+
+static uint64_t AlignOffset(uint64_t offset, uint64_t alignment)
+{
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+NOON_API
+void AssetPackWriter::Add(StringView name, AssetType type, List<uint8_t> data)
+{
+    if (!_nameSet.emplace(name).second) {
+        throw Exception("Asset '{}' was added twice", name);
+    }
+
+    _assetList.push_back(Asset{
+        .Name = String(name),
+        .Type = type,
+        .Data = std::move(data),
+    });
+}
+
+NOON_API
+void AssetPackWriter::AddMesh(StringView name, const VertexData& vertexData, Span<const uint32_t> indexList, Span<const MeshLOD> lodList)
+{
+    if (vertexData.Positions.empty()) {
+        throw Exception("Mesh '{}' has no vertices", name);
+    }
+
+    if (lodList.size() > MaxMeshLODCount) {
+        throw Exception("Mesh '{}' has {} levels of detail, more than the limit of {}", name, lodList.size(), MaxMeshLODCount);
+    }
+
+    for (const auto& lod : lodList) {
+        if (lod.IndexCount % 3 != 0 || size_t(lod.FirstIndex) + lod.IndexCount > indexList.size()) {
+            throw Exception("Mesh '{}' has a level of detail out of range for {} indices", name, indexList.size());
+        }
+    }
+
+    VertexFormat vertexFormat = VertexFormat::Choose(vertexData);
+
+    PackedMesh packedMesh = {};
+
+    auto vertexList = vertexFormat.Pack(vertexData, &packedMesh.Shader);
+
+    for (size_t i = 0; i < VertexAttributeCount; ++i) {
+        packedMesh.EncodingList[i] = static_cast<uint8_t>(vertexFormat.GetEncoding(static_cast<VertexAttribute>(i)));
+    }
+
+    packedMesh.Bounds = AABB::FromPoints(vertexData.Positions);
+    packedMesh.VertexCount = static_cast<uint32_t>(vertexData.GetVertexCount());
+    packedMesh.IndexCount = static_cast<uint32_t>(indexList.size());
+    packedMesh.LODCount = static_cast<uint32_t>(lodList.size());
+
+    // Same rule as Mesh, primitive restart is never enabled so all 65536 values are usable
+    if (!indexList.empty()) {
+        packedMesh.IndexSize = (packedMesh.VertexCount <= 0x10000 ? sizeof(uint16_t) : sizeof(uint32_t));
+    }
+
+    // Each stream is 16-byte aligned within the asset, which is itself aligned in the pack
+    size_t lodSize = lodList.size() * sizeof(MeshLOD);
+    packedMesh.VertexOffset = AlignOffset(sizeof(PackedMesh) + lodSize, 16);
+    packedMesh.IndexOffset = AlignOffset(packedMesh.VertexOffset + vertexList.size(), 16);
+
+    size_t indexSize = size_t(packedMesh.IndexCount) * packedMesh.IndexSize;
+
+    List<uint8_t> data(packedMesh.IndexOffset + indexSize, 0);
+    memcpy(data.data(), &packedMesh, sizeof(packedMesh));
+    if (!lodList.empty()) {
+        memcpy(data.data() + sizeof(packedMesh), lodList.data(), lodSize);
+    }
+    memcpy(data.data() + packedMesh.VertexOffset, vertexList.data(), vertexList.size());
+
+    uint8_t * indexData = data.data() + packedMesh.IndexOffset;
+    for (size_t i = 0; i < indexList.size(); ++i) {
+        if (indexList[i] >= packedMesh.VertexCount) {
+            throw Exception("Mesh '{}' has index {} out of range for {} vertices", name, indexList[i], packedMesh.VertexCount);
+        }
+
+        if (packedMesh.IndexSize == sizeof(uint16_t)) {
+            uint16_t index = static_cast<uint16_t>(indexList[i]);
+            memcpy(indexData + (i * sizeof(index)), &index, sizeof(index));
+        }
+        else {
+            memcpy(indexData + (i * sizeof(uint32_t)), &indexList[i], sizeof(uint32_t));
+        }
+    }
+
+    Add(name, AssetType::Mesh, std::move(data));
+}
+
+NOON_API
+void AssetPackWriter::AddMaterial(StringView name, const PackedMaterial& material)
+{
+    List<uint8_t> data(sizeof(PackedMaterial));
+    memcpy(data.data(), &material, sizeof(material));
+
+    Add(name, AssetType::Material, std::move(data));
+}
+
+NOON_API
+void AssetPackWriter::Append(AssetPackWriter&& other)
+{
+    for (auto& asset : other._assetList) {
+        Add(asset.Name, asset.Type, std::move(asset.Data));
+    }
+
+    other._assetList.clear();
+    other._nameSet.clear();
+}
+
+NOON_API
+List<String> AssetPackWriter::GetNameList() const
+{
+    List<String> nameList;
+    nameList.reserve(_assetList.size());
+    for (const auto& asset : _assetList) {
+        nameList.push_back(asset.Name);
+    }
+
+    return nameList;
+}
+
+NOON_API
+bool AssetPackWriter::Write(const Path& path) const
+{
+    // The table of contents is sorted by hash for AssetPack's binary search
+    List<const Asset *> sortedList;
+    sortedList.reserve(_assetList.size());
+    for (const auto& asset : _assetList) {
+        sortedList.push_back(&asset);
+    }
+
+    std::sort(sortedList.begin(), sortedList.end(),
+        [](const Asset * a, const Asset * b) {
+            uint64_t hashA = HashFNV1a(a->Name);
+            uint64_t hashB = HashFNV1a(b->Name);
+            return (hashA != hashB ? hashA < hashB : a->Name < b->Name);
+        }
+    );
+
+    AssetPack::Header header = {
+        .Magic = AssetPack::Magic,
+        .Version = AssetPack::FormatVersion,
+        .EntryCount = static_cast<uint32_t>(sortedList.size()),
+        .Reserved = 0,
+    };
+
+    List<AssetPack::Entry> entryList;
+    entryList.reserve(sortedList.size());
+
+    uint64_t offset = sizeof(header) + (sizeof(AssetPack::Entry) * sortedList.size());
+
+    for (const Asset * asset : sortedList) {
+        entryList.push_back(AssetPack::Entry{
+            .NameHash = HashFNV1a(asset->Name),
+            .NameOffset = static_cast<uint32_t>(offset),
+            .NameLength = static_cast<uint32_t>(asset->Name.size()),
+            .Type = asset->Type,
+            .Reserved = 0,
+            .DataOffset = 0,
+            .DataSize = asset->Data.size(),
+        });
+
+        offset += asset->Name.size();
+    }
+
+    for (auto& entry : entryList) {
+        offset = AlignOffset(offset, AssetPack::DataAlignment);
+        entry.DataOffset = offset;
+        offset += entry.DataSize;
+    }
+
+    String tempPath = path.ToString() + ".tmp";
+
+    FILE * file = fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        Log(NOON_ANCHOR, "Failed to open '{}' for writing", tempPath);
+        return false;
+    }
+
+    bool isValid = true;
+    uint64_t written = 0;
+
+    auto write = [&](const void * data, size_t size) {
+        if (size > 0 && fwrite(data, 1, size, file) != size) {
+            isValid = false;
+        }
+        written += size;
+    };
+
+    static const uint8_t Padding[AssetPack::DataAlignment] = {};
+
+    write(&header, sizeof(header));
+    write(entryList.data(), sizeof(AssetPack::Entry) * entryList.size());
+
+    for (const Asset * asset : sortedList) {
+        write(asset->Name.data(), asset->Name.size());
+    }
+
+    for (size_t i = 0; i < sortedList.size(); ++i) {
+        write(Padding, entryList[i].DataOffset - written);
+        write(sortedList[i]->Data.data(), sortedList[i]->Data.size());
+    }
+
+    if (fclose(file) != 0) {
+        isValid = false;
+    }
+
+    if (!isValid) {
+        Log(NOON_ANCHOR, "Failed to write '{}'", tempPath);
+        remove(tempPath.c_str());
+        return false;
+    }
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    bool renamed = MoveFileExW(
+        ConvertUTF8ToWideString(tempPath).c_str(),
+        ConvertUTF8ToWideString(path.ToString()).c_str(),
+        MOVEFILE_REPLACE_EXISTING);
+
+#else
+
+    bool renamed = (rename(tempPath.c_str(), path.ToCString()) == 0);
+
+#endif
+
+    if (!renamed) {
+        Log(NOON_ANCHOR, "Failed to replace '{}'", path);
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    Log(NOON_ANCHOR, "Wrote {} assets to '{}', {} KiB", sortedList.size(), path, written / 1024);
+
+    return true;
+}
+
+} // namespace noon
@@ -0,0 +1,689 @@
+#include <Noon/AsyncIO.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/Log.hpp>
+
+#include <algorithm>
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    #include <Windows.h>
+
+#else
+
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+#endif
+
+#if defined(NOON_PLATFORM_LINUX)
+
+    #include <linux/io_uring.h>
+    #include <poll.h>
+    #include <sys/eventfd.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+
+#endif
+
+namespace noon {
+
+AsyncIO * AsyncIO::_Instance = nullptr;
+
+// The most bytes to read with one call, as the underlying APIs take 32-bit lengths
+static const uint64_t MaxReadSize = 1ull << 30;
+
+NOON_API
+IOFile::~IOFile()
+{
+    Close();
+}
+
+NOON_API
+bool IOFile::Open(const Path& path)
+{
+    Close();
+
+    _path = path;
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    HANDLE handle = CreateFileW(
+        ConvertUTF8ToWideString(path.ToString()).c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize)) {
+        CloseHandle(handle);
+        return false;
+    }
+
+    _handle = handle;
+    _size = static_cast<uint64_t>(fileSize.QuadPart);
+
+#else
+
+    int fd = open(path.ToCString(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) < 0) {
+        close(fd);
+        return false;
+    }
+
+    _fd = fd;
+    _size = static_cast<uint64_t>(fileStat.st_size);
+
+#endif
+
+    return true;
+}
+
+NOON_API
+void IOFile::Close()
+{
+    if (!IsOpen()) {
+        return;
+    }
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    CloseHandle(_handle);
+    _handle = nullptr;
+
+#else
+
+    close(_fd);
+    _fd = -1;
+
+#endif
+
+    _size = 0;
+}
+
+#if defined(NOON_PLATFORM_LINUX)
+
+// The shared memory of an io_uring instance, set up with raw system calls so there is no
+// dependency on liburing
+struct AsyncIO::Ring
+{
+    // The user data of the wake poll's completion, request IDs start at 1
+    static constexpr uint64_t WakeUserData = 0;
+
+    int FD = -1;
+
+    // Written when reads are queued, and polled by the ring so waiting in the kernel for reads
+    // to finish also wakes up for new ones
+    int WakeFD = -1;
+
+    bool IsWakeArmed = false;
+
+    void * SubmitMemory = MAP_FAILED;
+
+    size_t SubmitMemorySize = 0;
+
+    void * CompleteMemory = MAP_FAILED;
+
+    size_t CompleteMemorySize = 0;
+
+    io_uring_sqe * SubmitEntryList = static_cast<io_uring_sqe *>(MAP_FAILED);
+
+    size_t SubmitEntryListSize = 0;
+
+    uint32_t * SubmitTail = nullptr;
+
+    uint32_t SubmitMask = 0;
+
+    uint32_t * SubmitArray = nullptr;
+
+    uint32_t * CompleteHead = nullptr;
+
+    uint32_t * CompleteTail = nullptr;
+
+    uint32_t CompleteMask = 0;
+
+    io_uring_cqe * CompleteEntryList = nullptr;
+
+    // Entries written to the submission queue that the kernel hasn't been told about
+    uint32_t Unsubmitted = 0;
+
+    // Reads the kernel has, by ID
+    Map<IORequestID, Request> InFlightMap;
+
+    static std::unique_ptr<Ring> Create(uint32_t entries)
+    {
+        auto ring = std::make_unique<Ring>();
+
+        ring->WakeFD = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (ring->WakeFD < 0) {
+            Log(NOON_ANCHOR, "eventfd failed, errno {}", errno);
+            return nullptr;
+        }
+
+        io_uring_params params = {};
+        ring->FD = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ring->FD < 0) {
+            Log(NOON_ANCHOR, "io_uring is unavailable, errno {}", errno);
+            return nullptr;
+        }
+
+        // IORING_OP_READ arrived in the same kernel as this feature
+        if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+            Log(NOON_ANCHOR, "io_uring is too old to read without a vector");
+            return nullptr;
+        }
+
+        ring->SubmitMemorySize = params.sq_off.array + (params.sq_entries * sizeof(uint32_t));
+        ring->CompleteMemorySize = params.cq_off.cqes + (params.cq_entries * sizeof(io_uring_cqe));
+
+        bool isSingleMapping = (params.features & IORING_FEAT_SINGLE_MMAP);
+        if (isSingleMapping) {
+            ring->SubmitMemorySize = std::max(ring->SubmitMemorySize, ring->CompleteMemorySize);
+        }
+
+        ring->SubmitMemory = mmap(nullptr, ring->SubmitMemorySize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, ring->FD, IORING_OFF_SQ_RING);
+        if (ring->SubmitMemory == MAP_FAILED) {
+            return nullptr;
+        }
+
+        if (isSingleMapping) {
+            ring->CompleteMemory = ring->SubmitMemory;
+            ring->CompleteMemorySize = 0;
+        }
+        else {
+            ring->CompleteMemory = mmap(nullptr, ring->CompleteMemorySize, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, ring->FD, IORING_OFF_CQ_RING);
+            if (ring->CompleteMemory == MAP_FAILED) {
+                return nullptr;
+            }
+        }
+
+        ring->SubmitEntryListSize = params.sq_entries * sizeof(io_uring_sqe);
+        ring->SubmitEntryList = static_cast<io_uring_sqe *>(mmap(nullptr, ring->SubmitEntryListSize,
+            PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->FD, IORING_OFF_SQES));
+        if (ring->SubmitEntryList == MAP_FAILED) {
+            return nullptr;
+        }
+
+        uint8_t * submit = static_cast<uint8_t *>(ring->SubmitMemory);
+        ring->SubmitTail = reinterpret_cast<uint32_t *>(submit + params.sq_off.tail);
+        ring->SubmitMask = *reinterpret_cast<uint32_t *>(submit + params.sq_off.ring_mask);
+        ring->SubmitArray = reinterpret_cast<uint32_t *>(submit + params.sq_off.array);
+
+        uint8_t * complete = static_cast<uint8_t *>(ring->CompleteMemory);
+        ring->CompleteHead = reinterpret_cast<uint32_t *>(complete + params.cq_off.head);
+        ring->CompleteTail = reinterpret_cast<uint32_t *>(complete + params.cq_off.tail);
+        ring->CompleteMask = *reinterpret_cast<uint32_t *>(complete + params.cq_off.ring_mask);
+        ring->CompleteEntryList = reinterpret_cast<io_uring_cqe *>(complete + params.cq_off.cqes);
+
+        return ring;
+    }
+
+    ~Ring()
+    {
+        if (SubmitEntryList != MAP_FAILED) {
+            munmap(SubmitEntryList, SubmitEntryListSize);
+        }
+
+        if (CompleteMemory != MAP_FAILED && CompleteMemory != SubmitMemory) {
+            munmap(CompleteMemory, CompleteMemorySize);
+        }
+
+        if (SubmitMemory != MAP_FAILED) {
+            munmap(SubmitMemory, SubmitMemorySize);
+        }
+
+        if (FD >= 0) {
+            close(FD);
+        }
+
+        if (WakeFD >= 0) {
+            close(WakeFD);
+        }
+    }
+
+    // Wakes up Enter(), safe to call from any thread
+    void Wake()
+    {
+        uint64_t value = 1;
+        [[maybe_unused]] ssize_t result = write(WakeFD, &value, sizeof(value));
+    }
+
+    // Called when the wake poll completes, so it can be armed again
+    void ResetWake()
+    {
+        uint64_t value;
+        [[maybe_unused]] ssize_t result = read(WakeFD, &value, sizeof(value));
+        IsWakeArmed = false;
+    }
+
+    inline bool HasCompletions() const
+    {
+        return (*CompleteHead != std::atomic_ref<uint32_t>(*CompleteTail).load(std::memory_order_acquire));
+    }
+
+    // Queues the rest of the read, the kernel is only told with the next Enter()
+    void Push(const Request& request)
+    {
+        io_uring_sqe& entry = PushEntry();
+        entry.opcode = IORING_OP_READ;
+        entry.fd = request.Read.File->_fd;
+        entry.off = request.Read.Offset + request.Done;
+        entry.addr = reinterpret_cast<uint64_t>(static_cast<uint8_t *>(request.Read.Destination) + request.Done);
+        entry.len = static_cast<uint32_t>(std::min(request.Read.Size - request.Done, MaxReadSize));
+        entry.user_data = request.ID;
+    }
+
+    // Queues a one-shot poll of WakeFD, unless one is already waiting
+    void ArmWake()
+    {
+        if (IsWakeArmed) {
+            return;
+        }
+
+        io_uring_sqe& entry = PushEntry();
+        entry.opcode = IORING_OP_POLL_ADD;
+        entry.fd = WakeFD;
+        entry.poll_events = POLLIN;
+        entry.user_data = WakeUserData;
+
+        IsWakeArmed = true;
+    }
+
+    io_uring_sqe& PushEntry()
+    {
+        uint32_t tail = *SubmitTail;
+        uint32_t index = tail & SubmitMask;
+
+        io_uring_sqe& entry = SubmitEntryList[index];
+        entry = {};
+
+        SubmitArray[index] = index;
+
+        // The entry must be visible before the kernel can see the new tail
+        std::atomic_ref<uint32_t>(*SubmitTail).store(tail + 1, std::memory_order_release);
+
+        ++Unsubmitted;
+
+        return entry;
+    }
+
+    // Submits every queued entry, and waits for at least one read to finish or for Wake()
+    void Enter()
+    {
+        uint32_t submitCount = Unsubmitted;
+
+        while (true) {
+            int result = static_cast<int>(syscall(__NR_io_uring_enter, FD, submitCount, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (result >= 0) {
+                Unsubmitted -= static_cast<uint32_t>(result);
+                return;
+            }
+
+            // Out of resources until some reads finish. Reap the completions there are, or wait
+            // for one without submitting, rather than retrying straight away.
+            if (errno == EAGAIN || errno == EBUSY) {
+                if (submitCount == 0 || HasCompletions()) {
+                    return;
+                }
+
+                submitCount = 0;
+                continue;
+            }
+
+            if (errno != EINTR) {
+                throw Exception("io_uring_enter failed, errno {}", errno);
+            }
+        }
+    }
+
+}; // struct AsyncIO::Ring
+
+#else
+
+struct AsyncIO::Ring { };
+
+#endif
+
+NOON_API
+AsyncIO::AsyncIO(bool forceFallback)
+{
+    if (_Instance) {
+        throw Exception("Only one AsyncIO can exist at a time");
+    }
+
+    if (!JobSystem::GetInstance()) {
+        throw Exception("AsyncIO requires a JobSystem");
+    }
+
+#if defined(NOON_PLATFORM_LINUX)
+
+    if (!forceFallback) {
+        // One more entry for the wake poll
+        _ring = Ring::Create(QueueDepth + 1);
+    }
+
+#endif
+
+    if (_ring) {
+        _threadList.emplace_back(&AsyncIO::RingMain, this);
+        Log(NOON_ANCHOR, "Using io_uring with a queue depth of {}", QueueDepth);
+    }
+    else {
+        for (size_t i = 0; i < FallbackThreadCount; ++i) {
+            _threadList.emplace_back(&AsyncIO::WorkerMain, this);
+        }
+        Log(NOON_ANCHOR, "Using {} I/O threads", FallbackThreadCount);
+    }
+
+    _Instance = this;
+}
+
+NOON_API
+AsyncIO::~AsyncIO()
+{
+    List<Request> cancelledList;
+
+    {
+        std::lock_guard lock(_mutex);
+        _running = false;
+
+        for (auto& queue : _queueList) {
+            cancelledList.insert(cancelledList.end(), queue.begin(), queue.end());
+            queue.clear();
+        }
+
+        _condition.notify_all();
+    }
+
+    for (const auto& request : cancelledList) {
+        Complete(request, IOStatus::Cancelled);
+    }
+
+    for (auto& thread : _threadList) {
+        thread.join();
+    }
+
+    _ring.reset();
+
+    _Instance = nullptr;
+}
+
+NOON_API
+IORequestID AsyncIO::Read(const IORead& read)
+{
+    return Read(Span<const IORead>(&read, 1));
+}
+
+NOON_API
+IORequestID AsyncIO::Read(Span<const IORead> readList)
+{
+    JobSystem * jobSystem = JobSystem::GetInstance();
+
+    for (const auto& read : readList) {
+        if (!read.File || !read.File->IsOpen() || (!read.Destination && read.Size > 0)) {
+            throw Exception("Invalid read of {} bytes", read.Size);
+        }
+    }
+
+    std::lock_guard lock(_mutex);
+
+    IORequestID firstID = _nextRequestID;
+
+    for (const auto& read : readList) {
+        if (read.Counter) {
+            jobSystem->Increment(*read.Counter);
+        }
+
+        if (read.Status) {
+            read.Status->store(IOStatus::Pending, std::memory_order_relaxed);
+        }
+
+        _queueList[static_cast<size_t>(read.Priority)].push_back(Request{
+            .ID = _nextRequestID++,
+            .Read = read,
+            .Done = 0,
+        });
+    }
+
+    if (readList.size() == 1) {
+        _condition.notify_one();
+    }
+    else {
+        _condition.notify_all();
+    }
+
+#if defined(NOON_PLATFORM_LINUX)
+
+    // The ring thread may be waiting in the kernel for reads already in flight
+    if (_ring) {
+        _ring->Wake();
+    }
+
+#endif
+
+    return firstID;
+}
+
+NOON_API
+bool AsyncIO::Cancel(IORequestID id)
+{
+    Request request;
+
+    {
+        std::lock_guard lock(_mutex);
+
+        // IDs only ever increase, so each queue is sorted by them
+        auto it = _queueList.end();
+        Queue<Request>::iterator requestIt;
+
+        for (auto queueIt = _queueList.begin(); queueIt != _queueList.end(); ++queueIt) {
+            requestIt = std::lower_bound(queueIt->begin(), queueIt->end(), id,
+                [](const Request& request, IORequestID id) {
+                    return request.ID < id;
+                }
+            );
+
+            if (requestIt != queueIt->end() && requestIt->ID == id) {
+                it = queueIt;
+                break;
+            }
+        }
+
+        if (it == _queueList.end()) {
+            return false;
+        }
+
+        request = *requestIt;
+        it->erase(requestIt);
+    }
+
+    Complete(request, IOStatus::Cancelled);
+
+    return true;
+}
+
+bool AsyncIO::PopRequest(std::unique_lock<std::mutex>& lock, Request& request, bool wait)
+{
+    auto hasRequest = [this]() {
+        return std::any_of(_queueList.begin(), _queueList.end(),
+            [](const Queue<Request>& queue) {
+                return !queue.empty();
+            }
+        );
+    };
+
+    if (wait) {
+        _condition.wait(lock,
+            [&]() {
+                return (!_running || hasRequest());
+            }
+        );
+    }
+
+    for (auto it = _queueList.rbegin(); it != _queueList.rend(); ++it) {
+        if (!it->empty()) {
+            request = it->front();
+            it->pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void AsyncIO::Complete(const Request& request, IOStatus status)
+{
+    if (request.Read.Status) {
+        request.Read.Status->store(status, std::memory_order_release);
+    }
+
+    if (request.Read.Counter) {
+        JobSystem::GetInstance()->Signal(*request.Read.Counter);
+    }
+}
+
+void AsyncIO::WorkerMain()
+{
+    std::unique_lock lock(_mutex);
+
+    Request request;
+    while (PopRequest(lock, request, true)) {
+        lock.unlock();
+
+        IOStatus status = IOStatus::Complete;
+
+        const IORead& read = request.Read;
+        uint8_t * destination = static_cast<uint8_t *>(read.Destination);
+
+        while (request.Done < read.Size) {
+            uint64_t size = std::min(read.Size - request.Done, MaxReadSize);
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+            // Synchronous handles still take the offset from an OVERLAPPED
+            uint64_t offset = read.Offset + request.Done;
+
+            OVERLAPPED overlapped = {};
+            overlapped.Offset = static_cast<DWORD>(offset);
+            overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+            DWORD bytesRead = 0;
+            if (!ReadFile(read.File->_handle, destination + request.Done, static_cast<DWORD>(size), &bytesRead, &overlapped) || bytesRead == 0) {
+                status = IOStatus::Failed;
+                break;
+            }
+
+            request.Done += bytesRead;
+
+#else
+
+            ssize_t bytesRead = pread(read.File->_fd, destination + request.Done, size, read.Offset + request.Done);
+            if (bytesRead < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (bytesRead <= 0) {
+                status = IOStatus::Failed;
+                break;
+            }
+
+            request.Done += static_cast<uint64_t>(bytesRead);
+
+#endif
+        }
+
+        Complete(request, status);
+
+        lock.lock();
+    }
+}
+
+void AsyncIO::RingMain()
+{
+#if defined(NOON_PLATFORM_LINUX)
+
+    Ring& ring = *_ring;
+
+    while (true) {
+        {
+            std::unique_lock lock(_mutex);
+
+            // Only block on the queue with nothing in flight, otherwise block in the kernel, where
+            // the wake poll interrupts the wait once more reads are queued
+            Request request;
+            if (ring.InFlightMap.empty()) {
+                if (!PopRequest(lock, request, true)) {
+                    break;
+                }
+
+                ring.InFlightMap.emplace(request.ID, request);
+                ring.Push(request);
+            }
+
+            while (ring.InFlightMap.size() < QueueDepth && PopRequest(lock, request, false)) {
+                ring.InFlightMap.emplace(request.ID, request);
+                ring.Push(request);
+            }
+        }
+
+        ring.ArmWake();
+        ring.Enter();
+
+        uint32_t head = *ring.CompleteHead;
+        uint32_t tail = std::atomic_ref<uint32_t>(*ring.CompleteTail).load(std::memory_order_acquire);
+
+        for (; head != tail; ++head) {
+            const io_uring_cqe& entry = ring.CompleteEntryList[head & ring.CompleteMask];
+
+            if (entry.user_data == Ring::WakeUserData) {
+                ring.ResetWake();
+                continue;
+            }
+
+            auto it = ring.InFlightMap.find(entry.user_data);
+            if (it == ring.InFlightMap.end()) {
+                continue;
+            }
+
+            Request& request = it->second;
+
+            // Zero bytes means the read ran past the end of the file
+            if (entry.res <= 0) {
+                Complete(request, IOStatus::Failed);
+                ring.InFlightMap.erase(it);
+                continue;
+            }
+
+            request.Done += static_cast<uint64_t>(entry.res);
+
+            if (request.Done < request.Read.Size) {
+                ring.Push(request);
+                continue;
+            }
+
+            Complete(request, IOStatus::Complete);
+            ring.InFlightMap.erase(it);
+        }
+
+        std::atomic_ref<uint32_t>(*ring.CompleteHead).store(head, std::memory_order_release);
+    }
+
+#endif
+}
+
+} // namespace noon
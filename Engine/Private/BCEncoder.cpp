@@ -0,0 +1,1705 @@
+#include <Noon/BCEncoder.hpp>
+#include <Noon/CPU.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/GraphicsDriver.hpp>
+#include <Noon/JobSystem.hpp>
+#include <Noon/Log.hpp>
+#include <Noon/TextureFormat.hpp>
+
+#if defined(NOON_ARCH_X64)
+
+    #include <immintrin.h>
+
+#elif defined(NOON_ARCH_ARM64)
+
+    #include <arm_neon.h>
+
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace noon {
+
+String BCQualityToString(BCQuality quality)
+{
+    switch (quality) {
+        case BCQuality::Fast:
+            return "Fast";
+        case BCQuality::Normal:
+            return "Normal";
+        case BCQuality::High:
+            return "High";
+        default:
+            return fmt::format("Unknown ({})", static_cast<int>(quality));
+    }
+}
+
+static BCEncoderBackend FindBCEncoderBackend()
+{
+#if defined(NOON_ARCH_X64)
+
+    return (HasAVX2() ? BCEncoderBackend::AVX2 : BCEncoderBackend::SSE);
+
+#elif defined(NOON_ARCH_ARM64)
+
+    return BCEncoderBackend::NEON;
+
+#else
+
+    return BCEncoderBackend::Scalar;
+
+#endif
+}
+
+static std::atomic<BCEncoderBackend> _bcEncoderBackend = FindBCEncoderBackend();
+
+String BCEncoderBackendToString(BCEncoderBackend backend)
+{
+    switch (backend) {
+        case BCEncoderBackend::Scalar:
+            return "Scalar";
+        case BCEncoderBackend::SSE:
+            return "SSE";
+        case BCEncoderBackend::AVX2:
+            return "AVX2";
+        case BCEncoderBackend::NEON:
+            return "NEON";
+        default:
+            return fmt::format("Unknown ({})", static_cast<int>(backend));
+    }
+}
+
+bool IsBCEncoderBackendSupported(BCEncoderBackend backend)
+{
+    switch (backend) {
+        case BCEncoderBackend::Scalar:
+            return true;
+#if defined(NOON_ARCH_X64)
+        case BCEncoderBackend::SSE:
+            return true;
+        case BCEncoderBackend::AVX2:
+            return HasAVX2();
+#elif defined(NOON_ARCH_ARM64)
+        case BCEncoderBackend::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+BCEncoderBackend GetBCEncoderBackend()
+{
+    return _bcEncoderBackend;
+}
+
+void SetBCEncoderBackend(BCEncoderBackend backend)
+{
+    if (!IsBCEncoderBackendSupported(backend)) {
+        throw Exception("BC encoder backend {} is not supported", BCEncoderBackendToString(backend));
+    }
+
+    _bcEncoderBackend = backend;
+
+    Log(NOON_ANCHOR, "BC encoder backend set to {}", BCEncoderBackendToString(backend));
+}
+
+bool IsBCEncoderFormat(VkFormat format)
+{
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The pixels of a 4x4 block, one array per channel so the kernels can load the same channel
+// of several pixels at once
+struct BlockPixels
+{
+    alignas(32) float Channel[4][16];
+
+}; // struct BlockPixels
+
+// The colors an index can choose between
+struct BlockPalette
+{
+    float Color[16][4];
+
+    uint32_t Count;
+
+}; // struct BlockPalette
+
+// Finds the closest palette color to each pixel, by squared error with each channel scaled by
+// weights. Ties go to the lowest index, so every backend picks the same ones.
+using FindIndicesFunction = void (*)(
+    const BlockPixels& block,
+    const BlockPalette& palette,
+    const float * weights,
+    uint8_t * indices,
+    float * errors);
+
+struct EncodeContext
+{
+    FindIndicesFunction FindIndices;
+
+    BCQuality Quality;
+
+}; // struct EncodeContext
+
+static const float RGBWeights[4] = { 1.0f, 1.0f, 1.0f, 0.0f };
+
+static const float RGBAWeights[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+static const float RWeights[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+
+static void FindIndicesScalar(const BlockPixels& block, const BlockPalette& palette, const float * weights, uint8_t * indices, float * errors)
+{
+    for (uint32_t i = 0; i < 16; ++i) {
+        float bestError = std::numeric_limits<float>::max();
+        uint8_t bestIndex = 0;
+
+        for (uint32_t j = 0; j < palette.Count; ++j) {
+            float error = 0.0f;
+            for (uint32_t c = 0; c < 4; ++c) {
+                float difference = block.Channel[c][i] - palette.Color[j][c];
+                error += weights[c] * difference * difference;
+            }
+
+            if (error < bestError) {
+                bestError = error;
+                bestIndex = static_cast<uint8_t>(j);
+            }
+        }
+
+        indices[i] = bestIndex;
+        errors[i] = bestError;
+    }
+}
+
+#if defined(NOON_ARCH_X64)
+
+static void FindIndicesSSE(const BlockPixels& block, const BlockPalette& palette, const float * weights, uint8_t * indices, float * errors)
+{
+    __m128 weight[4];
+    for (uint32_t c = 0; c < 4; ++c) {
+        weight[c] = _mm_set1_ps(weights[c]);
+    }
+
+    for (uint32_t i = 0; i < 16; i += 4) {
+        __m128 channel[4];
+        for (uint32_t c = 0; c < 4; ++c) {
+            channel[c] = _mm_load_ps(&block.Channel[c][i]);
+        }
+
+        __m128 bestError = _mm_set1_ps(std::numeric_limits<float>::max());
+        __m128i bestIndex = _mm_setzero_si128();
+
+        for (uint32_t j = 0; j < palette.Count; ++j) {
+            __m128 error = _mm_setzero_ps();
+            for (uint32_t c = 0; c < 4; ++c) {
+                __m128 difference = _mm_sub_ps(channel[c], _mm_set1_ps(palette.Color[j][c]));
+                error = _mm_add_ps(error, _mm_mul_ps(weight[c], _mm_mul_ps(difference, difference)));
+            }
+
+            __m128i better = _mm_castps_si128(_mm_cmplt_ps(error, bestError));
+            bestError = _mm_min_ps(error, bestError);
+            bestIndex = _mm_or_si128(
+                _mm_and_si128(better, _mm_set1_epi32(static_cast<int>(j))),
+                _mm_andnot_si128(better, bestIndex));
+        }
+
+        alignas(16) int32_t index[4];
+        _mm_store_si128(reinterpret_cast<__m128i *>(index), bestIndex);
+        _mm_storeu_ps(errors + i, bestError);
+
+        for (uint32_t k = 0; k < 4; ++k) {
+            indices[i + k] = static_cast<uint8_t>(index[k]);
+        }
+    }
+}
+
+NOON_TARGET_AVX2
+static void FindIndicesAVX2(const BlockPixels& block, const BlockPalette& palette, const float * weights, uint8_t * indices, float * errors)
+{
+    __m256 weight[4];
+    for (uint32_t c = 0; c < 4; ++c) {
+        weight[c] = _mm256_set1_ps(weights[c]);
+    }
+
+    for (uint32_t i = 0; i < 16; i += 8) {
+        __m256 channel[4];
+        for (uint32_t c = 0; c < 4; ++c) {
+            channel[c] = _mm256_load_ps(&block.Channel[c][i]);
+        }
+
+        __m256 bestError = _mm256_set1_ps(std::numeric_limits<float>::max());
+        __m256i bestIndex = _mm256_setzero_si256();
+
+        for (uint32_t j = 0; j < palette.Count; ++j) {
+            __m256 error = _mm256_setzero_ps();
+            for (uint32_t c = 0; c < 4; ++c) {
+                __m256 difference = _mm256_sub_ps(channel[c], _mm256_set1_ps(palette.Color[j][c]));
+                error = _mm256_fmadd_ps(_mm256_mul_ps(weight[c], difference), difference, error);
+            }
+
+            __m256i better = _mm256_castps_si256(_mm256_cmp_ps(error, bestError, _CMP_LT_OQ));
+            bestError = _mm256_min_ps(error, bestError);
+            bestIndex = _mm256_blendv_epi8(bestIndex, _mm256_set1_epi32(static_cast<int>(j)), better);
+        }
+
+        alignas(32) int32_t index[8];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(index), bestIndex);
+        _mm256_storeu_ps(errors + i, bestError);
+
+        for (uint32_t k = 0; k < 8; ++k) {
+            indices[i + k] = static_cast<uint8_t>(index[k]);
+        }
+    }
+}
+
+#endif // defined(NOON_ARCH_X64)
+
+#if defined(NOON_ARCH_ARM64)
+
+static void FindIndicesNEON(const BlockPixels& block, const BlockPalette& palette, const float * weights, uint8_t * indices, float * errors)
+{
+    float32x4_t weight[4];
+    for (uint32_t c = 0; c < 4; ++c) {
+        weight[c] = vdupq_n_f32(weights[c]);
+    }
+
+    for (uint32_t i = 0; i < 16; i += 4) {
+        float32x4_t channel[4];
+        for (uint32_t c = 0; c < 4; ++c) {
+            channel[c] = vld1q_f32(&block.Channel[c][i]);
+        }
+
+        float32x4_t bestError = vdupq_n_f32(std::numeric_limits<float>::max());
+        uint32x4_t bestIndex = vdupq_n_u32(0);
+
+        for (uint32_t j = 0; j < palette.Count; ++j) {
+            float32x4_t error = vdupq_n_f32(0.0f);
+            for (uint32_t c = 0; c < 4; ++c) {
+                float32x4_t difference = vsubq_f32(channel[c], vdupq_n_f32(palette.Color[j][c]));
+                error = vfmaq_f32(error, vmulq_f32(weight[c], difference), difference);
+            }
+
+            uint32x4_t better = vcltq_f32(error, bestError);
+            bestError = vminq_f32(error, bestError);
+            bestIndex = vbslq_u32(better, vdupq_n_u32(j), bestIndex);
+        }
+
+        uint32_t index[4];
+        vst1q_u32(index, bestIndex);
+        vst1q_f32(errors + i, bestError);
+
+        for (uint32_t k = 0; k < 4; ++k) {
+            indices[i + k] = static_cast<uint8_t>(index[k]);
+        }
+    }
+}
+
+#endif // defined(NOON_ARCH_ARM64)
+
+static FindIndicesFunction GetFindIndicesFunction()
+{
+    switch (GetBCEncoderBackend()) {
+#if defined(NOON_ARCH_X64)
+        case BCEncoderBackend::SSE:
+            return FindIndicesSSE;
+        case BCEncoderBackend::AVX2:
+            return FindIndicesAVX2;
+#elif defined(NOON_ARCH_ARM64)
+        case BCEncoderBackend::NEON:
+            return FindIndicesNEON;
+#endif
+        default:
+            return FindIndicesScalar;
+    }
+}
+
+static float SumErrors(const float * errors, uint32_t mask)
+{
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < 16; ++i) {
+        if (mask & (1u << i)) {
+            sum += errors[i];
+        }
+    }
+    return sum;
+}
+
+// Blocks past the edge of the image repeat its last row and column
+static void LoadBlock(const uint8_t * pixels, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, BlockPixels& block)
+{
+    for (uint32_t y = 0; y < 4; ++y) {
+        uint32_t pixelY = std::min(blockY * 4 + y, height - 1);
+
+        for (uint32_t x = 0; x < 4; ++x) {
+            uint32_t pixelX = std::min(blockX * 4 + x, width - 1);
+            const uint8_t * pixel = pixels + ((size_t(pixelY) * width + pixelX) * 4);
+
+            for (uint32_t c = 0; c < 4; ++c) {
+                block.Channel[c][(y * 4) + x] = pixel[c];
+            }
+        }
+    }
+}
+
+// Moves one channel into the first, with the rest cleared, so single channel formats can use
+// the same functions
+static void ExtractChannel(const BlockPixels& block, uint32_t channel, BlockPixels& single)
+{
+    memcpy(single.Channel[0], block.Channel[channel], sizeof(single.Channel[0]));
+    memset(single.Channel[1], 0, sizeof(single.Channel[0]) * 3);
+}
+
+// The mean of the pixels in mask, and the direction they vary the most along, over the first
+// channelCount channels
+static void FitLine(const BlockPixels& block, uint32_t mask, uint32_t channelCount, float * mean, float * axis)
+{
+    float count = 0.0f;
+    for (uint32_t c = 0; c < 4; ++c) {
+        mean[c] = 0.0f;
+        axis[c] = 0.0f;
+    }
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        if (mask & (1u << i)) {
+            for (uint32_t c = 0; c < channelCount; ++c) {
+                mean[c] += block.Channel[c][i];
+            }
+            count += 1.0f;
+        }
+    }
+
+    if (count == 0.0f) {
+        return;
+    }
+
+    for (uint32_t c = 0; c < channelCount; ++c) {
+        mean[c] /= count;
+    }
+
+    float covariance[4][4] = {};
+    for (uint32_t i = 0; i < 16; ++i) {
+        if (mask & (1u << i)) {
+            float difference[4];
+            for (uint32_t c = 0; c < channelCount; ++c) {
+                difference[c] = block.Channel[c][i] - mean[c];
+            }
+
+            for (uint32_t a = 0; a < channelCount; ++a) {
+                for (uint32_t b = a; b < channelCount; ++b) {
+                    covariance[a][b] += difference[a] * difference[b];
+                }
+            }
+        }
+    }
+
+    uint32_t start = 0;
+    for (uint32_t a = 0; a < channelCount; ++a) {
+        if (covariance[a][a] > covariance[start][start]) {
+            start = a;
+        }
+
+        for (uint32_t b = 0; b < a; ++b) {
+            covariance[a][b] = covariance[b][a];
+        }
+    }
+
+    // Power iteration, starting from the channel that varies the most, converges in a few steps
+    float vector[4] = {};
+    for (uint32_t c = 0; c < channelCount; ++c) {
+        vector[c] = covariance[c][start];
+    }
+
+    for (uint32_t iteration = 0; iteration < 8; ++iteration) {
+        float length = 0.0f;
+        for (uint32_t c = 0; c < channelCount; ++c) {
+            length += vector[c] * vector[c];
+        }
+
+        length = std::sqrt(length);
+        if (length < 1e-6f) {
+            break;
+        }
+
+        for (uint32_t c = 0; c < channelCount; ++c) {
+            axis[c] = vector[c] / length;
+        }
+
+        for (uint32_t a = 0; a < channelCount; ++a) {
+            vector[a] = 0.0f;
+            for (uint32_t b = 0; b < channelCount; ++b) {
+                vector[a] += covariance[a][b] * axis[b];
+            }
+        }
+    }
+}
+
+// Endpoints at either end of the pixels in mask along the line through them, channels past
+// channelCount are left opaque white
+static void FitEndpoints(const BlockPixels& block, uint32_t mask, uint32_t channelCount, float * endpoint0, float * endpoint1)
+{
+    float mean[4];
+    float axis[4];
+    FitLine(block, mask, channelCount, mean, axis);
+
+    float minimum = 0.0f;
+    float maximum = 0.0f;
+    bool first = true;
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        if (mask & (1u << i)) {
+            float t = 0.0f;
+            for (uint32_t c = 0; c < channelCount; ++c) {
+                t += (block.Channel[c][i] - mean[c]) * axis[c];
+            }
+
+            minimum = (first ? t : std::min(minimum, t));
+            maximum = (first ? t : std::max(maximum, t));
+            first = false;
+        }
+    }
+
+    for (uint32_t c = 0; c < 4; ++c) {
+        if (c < channelCount) {
+            endpoint0[c] = std::clamp(mean[c] + (axis[c] * minimum), 0.0f, 255.0f);
+            endpoint1[c] = std::clamp(mean[c] + (axis[c] * maximum), 0.0f, 255.0f);
+        }
+        else {
+            endpoint0[c] = 255.0f;
+            endpoint1[c] = 255.0f;
+        }
+    }
+}
+
+// The endpoints that best reproduce the pixels in mask with the indices chosen, by least
+// squares, where weightList[index] is how far along from endpoint0 to endpoint1 it is. Returns
+// false if every index has the same weight.
+static bool RefineEndpoints(const BlockPixels& block, uint32_t mask, uint32_t channelCount, const uint8_t * indices, const float * weightList, float * endpoint0, float * endpoint1)
+{
+    float aa = 0.0f;
+    float ab = 0.0f;
+    float bb = 0.0f;
+    float ax[4] = {};
+    float bx[4] = {};
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        if (mask & (1u << i)) {
+            float t = weightList[indices[i]];
+            float s = 1.0f - t;
+
+            aa += s * s;
+            ab += s * t;
+            bb += t * t;
+
+            for (uint32_t c = 0; c < channelCount; ++c) {
+                ax[c] += s * block.Channel[c][i];
+                bx[c] += t * block.Channel[c][i];
+            }
+        }
+    }
+
+    float determinant = (aa * bb) - (ab * ab);
+    if (std::abs(determinant) < 1e-6f) {
+        return false;
+    }
+
+    for (uint32_t c = 0; c < channelCount; ++c) {
+        endpoint0[c] = std::clamp(((bb * ax[c]) - (ab * bx[c])) / determinant, 0.0f, 255.0f);
+        endpoint1[c] = std::clamp(((aa * bx[c]) - (ab * ax[c])) / determinant, 0.0f, 255.0f);
+    }
+
+    return true;
+}
+
+static uint32_t RefineCount(BCQuality quality)
+{
+    switch (quality) {
+        case BCQuality::Fast:
+            return 1;
+        case BCQuality::Normal:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+//
+// BC1
+//
+
+static const float BC1FourColorWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+static const float BC1ThreeColorWeights[3] = { 0.0f, 1.0f, 0.5f };
+
+static uint16_t QuantizeRGB565(const float * color)
+{
+    uint32_t r = static_cast<uint32_t>(std::lround(color[0] * (31.0f / 255.0f)));
+    uint32_t g = static_cast<uint32_t>(std::lround(color[1] * (63.0f / 255.0f)));
+    uint32_t b = static_cast<uint32_t>(std::lround(color[2] * (31.0f / 255.0f)));
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static void ExpandRGB565(uint16_t value, float * color)
+{
+    uint32_t r = (value >> 11) & 0x1F;
+    uint32_t g = (value >> 5) & 0x3F;
+    uint32_t b = value & 0x1F;
+
+    color[0] = static_cast<float>((r << 3) | (r >> 2));
+    color[1] = static_cast<float>((g << 2) | (g >> 4));
+    color[2] = static_cast<float>((b << 3) | (b >> 2));
+    color[3] = 255.0f;
+}
+
+static float EvaluateBC1(const EncodeContext& context, const BlockPixels& block, uint32_t mask, uint16_t color0, uint16_t color1, bool threeColor, uint8_t * indices)
+{
+    BlockPalette palette;
+    ExpandRGB565(color0, palette.Color[0]);
+    ExpandRGB565(color1, palette.Color[1]);
+
+    if (threeColor) {
+        for (uint32_t c = 0; c < 4; ++c) {
+            palette.Color[2][c] = (palette.Color[0][c] + palette.Color[1][c]) / 2.0f;
+        }
+        palette.Count = 3;
+    }
+    else {
+        for (uint32_t c = 0; c < 4; ++c) {
+            palette.Color[2][c] = ((2.0f * palette.Color[0][c]) + palette.Color[1][c]) / 3.0f;
+            palette.Color[3][c] = (palette.Color[0][c] + (2.0f * palette.Color[1][c])) / 3.0f;
+        }
+        palette.Count = 4;
+    }
+
+    float errors[16];
+    context.FindIndices(block, palette, RGBWeights, indices, errors);
+    return SumErrors(errors, mask);
+}
+
+// Pixels with alpha below 128 are encoded as transparent black if allowTransparent, which
+// needs the three color mode
+static void EncodeBC1Block(const EncodeContext& context, const BlockPixels& block, bool allowTransparent, uint8_t * output)
+{
+    uint32_t mask = 0xFFFF;
+    if (allowTransparent) {
+        for (uint32_t i = 0; i < 16; ++i) {
+            if (block.Channel[3][i] < 128.0f) {
+                mask &= ~(1u << i);
+            }
+        }
+    }
+
+    bool threeColor = (mask != 0xFFFF);
+    const float * weightList = (threeColor ? BC1ThreeColorWeights : BC1FourColorWeights);
+
+    uint16_t color0 = 0;
+    uint16_t color1 = 0;
+    uint8_t indices[16] = {};
+
+    if (mask != 0) {
+        float endpoint0[4];
+        float endpoint1[4];
+        FitEndpoints(block, mask, 3, endpoint0, endpoint1);
+
+        color0 = QuantizeRGB565(endpoint0);
+        color1 = QuantizeRGB565(endpoint1);
+        float bestError = EvaluateBC1(context, block, mask, color0, color1, threeColor, indices);
+
+        uint32_t refineCount = RefineCount(context.Quality) - 1;
+        for (uint32_t i = 0; i < refineCount && bestError > 0.0f; ++i) {
+            if (!RefineEndpoints(block, mask, 3, indices, weightList, endpoint0, endpoint1)) {
+                break;
+            }
+
+            uint16_t refined0 = QuantizeRGB565(endpoint0);
+            uint16_t refined1 = QuantizeRGB565(endpoint1);
+
+            uint8_t refinedIndices[16];
+            float error = EvaluateBC1(context, block, mask, refined0, refined1, threeColor, refinedIndices);
+            if (error >= bestError) {
+                break;
+            }
+
+            bestError = error;
+            color0 = refined0;
+            color1 = refined1;
+            memcpy(indices, refinedIndices, sizeof(indices));
+        }
+
+        if (context.Quality == BCQuality::High) {
+            // Nudge each channel of each endpoint by one step, keeping whatever helps
+            static const uint32_t ShiftList[3] = { 11, 5, 0 };
+            static const uint32_t MaxList[3] = { 31, 63, 31 };
+
+            for (uint32_t e = 0; e < 2 && bestError > 0.0f; ++e) {
+                for (uint32_t c = 0; c < 3; ++c) {
+                    for (int delta : { -1, 1 }) {
+                        uint16_t color = (e == 0 ? color0 : color1);
+                        int value = static_cast<int>((color >> ShiftList[c]) & MaxList[c]) + delta;
+                        if (value < 0 || value > static_cast<int>(MaxList[c])) {
+                            continue;
+                        }
+
+                        color = static_cast<uint16_t>((color & ~(MaxList[c] << ShiftList[c])) | (uint32_t(value) << ShiftList[c]));
+
+                        uint8_t candidateIndices[16];
+                        float error = EvaluateBC1(context, block, mask,
+                            (e == 0 ? color : color0), (e == 1 ? color : color1),
+                            threeColor, candidateIndices);
+
+                        if (error < bestError) {
+                            bestError = error;
+                            (e == 0 ? color0 : color1) = color;
+                            memcpy(indices, candidateIndices, sizeof(indices));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // The mode is chosen by the order of the endpoints, four colors if color0 > color1, and
+    // swapping them swaps the first two indices
+    if (threeColor ? (color0 > color1) : (color0 < color1)) {
+        std::swap(color0, color1);
+        for (uint32_t i = 0; i < 16; ++i) {
+            if (indices[i] < 2) {
+                indices[i] ^= 1;
+            }
+        }
+    }
+
+    // Equal endpoints always decode in three color mode, where index 3 is transparent
+    if (!threeColor && color0 == color1) {
+        memset(indices, 0, sizeof(indices));
+    }
+
+    uint32_t indexBits = 0;
+    for (uint32_t i = 0; i < 16; ++i) {
+        uint32_t index = ((mask & (1u << i)) ? indices[i] : 3);
+        indexBits |= index << (i * 2);
+    }
+
+    output[0] = static_cast<uint8_t>(color0);
+    output[1] = static_cast<uint8_t>(color0 >> 8);
+    output[2] = static_cast<uint8_t>(color1);
+    output[3] = static_cast<uint8_t>(color1 >> 8);
+    memcpy(output + 4, &indexBits, sizeof(indexBits));
+}
+
+//
+// BC4
+//
+
+// Eight interpolated values if endpoint0 > endpoint1, otherwise six with 0 and 255
+static void BuildBC4Palette(uint8_t endpoint0, uint8_t endpoint1, float * values)
+{
+    values[0] = endpoint0;
+    values[1] = endpoint1;
+
+    if (endpoint0 > endpoint1) {
+        for (uint32_t i = 1; i < 7; ++i) {
+            values[i + 1] = std::round(((float(7 - i) * endpoint0) + (float(i) * endpoint1)) / 7.0f);
+        }
+    }
+    else {
+        for (uint32_t i = 1; i < 5; ++i) {
+            values[i + 1] = std::round(((float(5 - i) * endpoint0) + (float(i) * endpoint1)) / 5.0f);
+        }
+        values[6] = 0.0f;
+        values[7] = 255.0f;
+    }
+}
+
+// Only the first channel of block is encoded
+static float EvaluateBC4(const EncodeContext& context, const BlockPixels& block, uint8_t endpoint0, uint8_t endpoint1, uint8_t * indices)
+{
+    float values[8];
+    BuildBC4Palette(endpoint0, endpoint1, values);
+
+    BlockPalette palette = {};
+    for (uint32_t i = 0; i < 8; ++i) {
+        palette.Color[i][0] = values[i];
+    }
+    palette.Count = 8;
+
+    float errors[16];
+    context.FindIndices(block, palette, RWeights, indices, errors);
+    return SumErrors(errors, 0xFFFF);
+}
+
+static void EncodeBC4Block(const EncodeContext& context, const BlockPixels& block, uint8_t * output)
+{
+    static const float BC4Weights[8] = {
+        0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f,
+    };
+
+    const float * values = block.Channel[0];
+    auto [minimum, maximum] = std::minmax_element(values, values + 16);
+
+    uint8_t endpoint0 = static_cast<uint8_t>(*maximum);
+    uint8_t endpoint1 = static_cast<uint8_t>(*minimum);
+    uint8_t indices[16] = {};
+
+    if (endpoint0 != endpoint1) {
+        float bestError = EvaluateBC4(context, block, endpoint0, endpoint1, indices);
+
+        auto tryEndpoints = [&](int value0, int value1) {
+            if (value0 < 0 || value0 > 255 || value1 < 0 || value1 > 255) {
+                return;
+            }
+
+            uint8_t candidateIndices[16];
+            float error = EvaluateBC4(context, block, uint8_t(value0), uint8_t(value1), candidateIndices);
+            if (error < bestError) {
+                bestError = error;
+                endpoint0 = uint8_t(value0);
+                endpoint1 = uint8_t(value1);
+                memcpy(indices, candidateIndices, sizeof(indices));
+            }
+        };
+
+        if (context.Quality != BCQuality::Fast) {
+            float refined0[4];
+            float refined1[4];
+            if (RefineEndpoints(block, 0xFFFF, 1, indices, BC4Weights, refined0, refined1)) {
+                int value0 = static_cast<int>(std::lround(refined0[0]));
+                int value1 = static_cast<int>(std::lround(refined1[0]));
+                if (value0 > value1) {
+                    tryEndpoints(value0, value1);
+                }
+            }
+
+            // Six values between the others, with 0 and 255 exact, suit blocks with a few
+            // values at the extremes
+            float inner0 = 255.0f;
+            float inner1 = 0.0f;
+            for (uint32_t i = 0; i < 16; ++i) {
+                if (values[i] > 0.0f && values[i] < 255.0f) {
+                    inner0 = std::min(inner0, values[i]);
+                    inner1 = std::max(inner1, values[i]);
+                }
+            }
+
+            if (inner0 <= inner1 && (*minimum == 0.0f || *maximum == 255.0f)) {
+                tryEndpoints(int(inner0), int(inner1));
+            }
+        }
+
+        if (context.Quality == BCQuality::High) {
+            int center0 = endpoint0;
+            int center1 = endpoint1;
+            bool eightValues = (center0 > center1);
+
+            for (int delta0 = -2; delta0 <= 2; ++delta0) {
+                for (int delta1 = -2; delta1 <= 2; ++delta1) {
+                    int value0 = center0 + delta0;
+                    int value1 = center1 + delta1;
+                    if ((value0 > value1) == eightValues) {
+                        tryEndpoints(value0, value1);
+                    }
+                }
+            }
+        }
+    }
+
+    uint64_t indexBits = 0;
+    for (uint32_t i = 0; i < 16; ++i) {
+        indexBits |= uint64_t(indices[i]) << (i * 3);
+    }
+
+    output[0] = endpoint0;
+    output[1] = endpoint1;
+    for (uint32_t i = 0; i < 6; ++i) {
+        output[2 + i] = static_cast<uint8_t>(indexBits >> (i * 8));
+    }
+}
+
+//
+// BC7
+//
+
+// Pixels in the second subset for each two subset partition, bit i is pixel i
+static const uint16_t BC7PartitionTable[64] = {
+    0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+    0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+    0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+    0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+    0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+    0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+    0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+    0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+};
+
+// The pixel of the second subset whose index has an implicit high bit of 0
+static const uint8_t BC7AnchorTable[64] = {
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 2, 8, 2, 2, 8, 8, 15,
+    2, 8, 2, 2, 8, 8, 2, 2,
+    15, 15, 6, 8, 2, 8, 15, 15,
+    2, 8, 2, 2, 2, 15, 15, 6,
+    6, 2, 6, 8, 15, 15, 2, 2,
+    15, 15, 15, 15, 15, 2, 2, 15,
+};
+
+static const uint8_t BC7Weights2[4] = { 0, 21, 43, 64 };
+
+static const uint8_t BC7Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+
+static const uint8_t BC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+static const uint8_t * GetBC7Weights(uint32_t indexBits)
+{
+    return (indexBits == 2 ? BC7Weights2 : (indexBits == 3 ? BC7Weights3 : BC7Weights4));
+}
+
+struct BC7ModeInfo
+{
+    uint32_t SubsetCount;
+
+    uint32_t PartitionBits;
+
+    uint32_t RotationBits;
+
+    uint32_t IndexSelectionBits;
+
+    uint32_t ColorBits;
+
+    uint32_t AlphaBits;
+
+    // A p-bit per endpoint
+    uint32_t EndpointPBits;
+
+    // A p-bit per subset, shared by both endpoints
+    uint32_t SharedPBits;
+
+    uint32_t IndexBits;
+
+    // Separate indices for alpha, or for color with the index selection bit
+    uint32_t SecondaryIndexBits;
+
+}; // struct BC7ModeInfo
+
+static const BC7ModeInfo BC7ModeList[8] = {
+    { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+    { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+    { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+    { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+    { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+    { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+    { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+    { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+};
+
+// Blocks are little-endian, with each field starting from its lowest bit
+class BitWriter
+{
+public:
+
+    explicit BitWriter(uint8_t * data)
+        : _data(data)
+    {
+        memset(_data, 0, 16);
+    }
+
+    void Write(uint32_t value, uint32_t bitCount) {
+        for (uint32_t i = 0; i < bitCount; ++i, ++_position) {
+            if (value & (1u << i)) {
+                _data[_position / 8] |= static_cast<uint8_t>(1u << (_position % 8));
+            }
+        }
+    }
+
+private:
+
+    uint8_t * _data;
+
+    uint32_t _position = 0;
+
+}; // class BitWriter
+
+class BitReader
+{
+public:
+
+    explicit BitReader(const uint8_t * data)
+        : _data(data)
+    { }
+
+    uint32_t Read(uint32_t bitCount) {
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < bitCount && _position < 128; ++i, ++_position) {
+            value |= uint32_t((_data[_position / 8] >> (_position % 8)) & 1) << i;
+        }
+        return value;
+    }
+
+private:
+
+    const uint8_t * _data;
+
+    uint32_t _position = 0;
+
+}; // class BitReader
+
+// Expands an endpoint channel to 8 bits by repeating its highest bits
+static uint8_t ExpandBC7(uint32_t value, uint32_t bitCount)
+{
+    value <<= (8 - bitCount);
+    return static_cast<uint8_t>(value | (value >> bitCount));
+}
+
+// The endpoints of one subset as stored, and as the decoder expands them
+struct BC7Subset
+{
+    uint32_t Value[2][4];
+
+    uint32_t PBit[2];
+
+    uint8_t Color[2][4];
+
+}; // struct BC7Subset
+
+// pBit is appended as the lowest bit, or -1 for none
+static uint32_t QuantizeBC7(float value, uint32_t bitCount, int pBit)
+{
+    uint32_t maxValue = (1u << bitCount) - 1;
+
+    if (pBit < 0) {
+        return std::min(static_cast<uint32_t>(std::lround(value * float(maxValue) / 255.0f)), maxValue);
+    }
+
+    float scaled = value * float((maxValue << 1) | 1) / 255.0f;
+    long quantized = std::lround((scaled - float(pBit)) / 2.0f);
+    return static_cast<uint32_t>(std::clamp(quantized, 0L, long(maxValue)));
+}
+
+static uint8_t DequantizeBC7(uint32_t value, uint32_t bitCount, int pBit)
+{
+    if (pBit < 0) {
+        return ExpandBC7(value, bitCount);
+    }
+
+    return ExpandBC7((value << 1) | uint32_t(pBit), bitCount + 1);
+}
+
+// Quantizes the first channelCount channels with the mode's color and alpha bits, the rest
+// are opaque white. P-bits are chosen to keep the endpoints closest to what was asked for.
+static void QuantizeBC7Endpoints(const BC7ModeInfo& mode, uint32_t channelCount, const float * endpoint0, const float * endpoint1, BC7Subset& subset)
+{
+    auto quantize = [&](uint32_t e, const float * endpoint, int pBit) {
+        float error = 0.0f;
+
+        for (uint32_t c = 0; c < 4; ++c) {
+            if (c < channelCount) {
+                uint32_t bitCount = (c < 3 ? mode.ColorBits : mode.AlphaBits);
+                subset.Value[e][c] = QuantizeBC7(endpoint[c], bitCount, pBit);
+                subset.Color[e][c] = DequantizeBC7(subset.Value[e][c], bitCount, pBit);
+
+                float difference = float(subset.Color[e][c]) - endpoint[c];
+                error += difference * difference;
+            }
+            else {
+                subset.Value[e][c] = 0;
+                subset.Color[e][c] = 255;
+            }
+        }
+
+        subset.PBit[e] = uint32_t(std::max(pBit, 0));
+        return error;
+    };
+
+    if (mode.EndpointPBits) {
+        for (uint32_t e = 0; e < 2; ++e) {
+            const float * endpoint = (e == 0 ? endpoint0 : endpoint1);
+            float error0 = quantize(e, endpoint, 0);
+            float error1 = quantize(e, endpoint, 1);
+            if (error0 <= error1) {
+                quantize(e, endpoint, 0);
+            }
+        }
+    }
+    else if (mode.SharedPBits) {
+        float error0 = quantize(0, endpoint0, 0) + quantize(1, endpoint1, 0);
+        float error1 = quantize(0, endpoint0, 1) + quantize(1, endpoint1, 1);
+        if (error0 <= error1) {
+            quantize(0, endpoint0, 0);
+            quantize(1, endpoint1, 0);
+        }
+    }
+    else {
+        quantize(0, endpoint0, -1);
+        quantize(1, endpoint1, -1);
+    }
+}
+
+static float EvaluateBC7Subset(const EncodeContext& context, const BlockPixels& block, uint32_t mask, const float * weights, const BC7Subset& subset, uint32_t indexBits, uint8_t * indices)
+{
+    const uint8_t * weightList = GetBC7Weights(indexBits);
+
+    BlockPalette palette;
+    palette.Count = (1u << indexBits);
+
+    for (uint32_t i = 0; i < palette.Count; ++i) {
+        for (uint32_t c = 0; c < 4; ++c) {
+            uint32_t value = ((64 - weightList[i]) * subset.Color[0][c]) + (weightList[i] * subset.Color[1][c]) + 32;
+            palette.Color[i][c] = float(value >> 6);
+        }
+    }
+
+    float errors[16];
+    context.FindIndices(block, palette, weights, indices, errors);
+    return SumErrors(errors, mask);
+}
+
+// Fits, quantizes and refines the endpoints of the pixels in mask, returning their error.
+// Only the indices of those pixels are meaningful.
+static float EncodeBC7Subset(const EncodeContext& context, const BlockPixels& block, uint32_t mask, const BC7ModeInfo& mode, uint32_t channelCount, const float * weights, BC7Subset& subset, uint8_t * indices)
+{
+    float endpoint0[4];
+    float endpoint1[4];
+    FitEndpoints(block, mask, channelCount, endpoint0, endpoint1);
+
+    QuantizeBC7Endpoints(mode, channelCount, endpoint0, endpoint1, subset);
+    float bestError = EvaluateBC7Subset(context, block, mask, weights, subset, mode.IndexBits, indices);
+
+    float weightList[16];
+    const uint8_t * modeWeights = GetBC7Weights(mode.IndexBits);
+    for (uint32_t i = 0; i < (1u << mode.IndexBits); ++i) {
+        weightList[i] = float(modeWeights[i]) / 64.0f;
+    }
+
+    uint32_t refineCount = RefineCount(context.Quality);
+    for (uint32_t i = 0; i < refineCount && bestError > 0.0f; ++i) {
+        if (!RefineEndpoints(block, mask, channelCount, indices, weightList, endpoint0, endpoint1)) {
+            break;
+        }
+
+        BC7Subset refined;
+        uint8_t refinedIndices[16];
+        QuantizeBC7Endpoints(mode, channelCount, endpoint0, endpoint1, refined);
+
+        float error = EvaluateBC7Subset(context, block, mask, weights, refined, mode.IndexBits, refinedIndices);
+        if (error >= bestError) {
+            break;
+        }
+
+        bestError = error;
+        subset = refined;
+        memcpy(indices, refinedIndices, 16);
+    }
+
+    return bestError;
+}
+
+// The first pixel of each subset has its index's high bit left out, so it must be 0, which
+// swapping the endpoints and inverting the indices of the subset ensures
+static void FixBC7Anchor(BC7Subset& subset, uint8_t * indices, uint32_t mask, uint32_t anchor, uint32_t indexBits)
+{
+    uint32_t maxIndex = (1u << indexBits) - 1;
+    if (indices[anchor] <= (maxIndex >> 1)) {
+        return;
+    }
+
+    for (uint32_t c = 0; c < 4; ++c) {
+        std::swap(subset.Value[0][c], subset.Value[1][c]);
+        std::swap(subset.Color[0][c], subset.Color[1][c]);
+    }
+    std::swap(subset.PBit[0], subset.PBit[1]);
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        if (mask & (1u << i)) {
+            indices[i] = static_cast<uint8_t>(maxIndex - indices[i]);
+        }
+    }
+}
+
+// For modes with one set of indices, and no rotation
+static void PackBC7(uint32_t modeIndex, uint32_t partition, const BC7Subset * subsetList, const uint8_t * indices, uint8_t * output)
+{
+    const auto& mode = BC7ModeList[modeIndex];
+    BitWriter writer(output);
+
+    writer.Write(1u << modeIndex, modeIndex + 1);
+    writer.Write(partition, mode.PartitionBits);
+
+    for (uint32_t c = 0; c < 3; ++c) {
+        for (uint32_t s = 0; s < mode.SubsetCount; ++s) {
+            writer.Write(subsetList[s].Value[0][c], mode.ColorBits);
+            writer.Write(subsetList[s].Value[1][c], mode.ColorBits);
+        }
+    }
+
+    if (mode.AlphaBits) {
+        for (uint32_t s = 0; s < mode.SubsetCount; ++s) {
+            writer.Write(subsetList[s].Value[0][3], mode.AlphaBits);
+            writer.Write(subsetList[s].Value[1][3], mode.AlphaBits);
+        }
+    }
+
+    for (uint32_t s = 0; s < mode.SubsetCount; ++s) {
+        if (mode.EndpointPBits) {
+            writer.Write(subsetList[s].PBit[0], 1);
+            writer.Write(subsetList[s].PBit[1], 1);
+        }
+        else if (mode.SharedPBits) {
+            writer.Write(subsetList[s].PBit[0], 1);
+        }
+    }
+
+    uint32_t anchor = (mode.SubsetCount == 2 ? BC7AnchorTable[partition] : 0);
+    for (uint32_t i = 0; i < 16; ++i) {
+        bool isAnchor = (i == 0 || i == anchor);
+        writer.Write(indices[i], mode.IndexBits - (isAnchor ? 1 : 0));
+    }
+}
+
+// Color and alpha fitted separately, with 2 bit indices each and no rotation
+static float EncodeBC7Mode5(const EncodeContext& context, const BlockPixels& block, uint8_t * output)
+{
+    const auto& mode = BC7ModeList[5];
+
+    BC7Subset color;
+    uint8_t colorIndices[16];
+    float error = EncodeBC7Subset(context, block, 0xFFFF, mode, 3, RGBWeights, color, colorIndices);
+    FixBC7Anchor(color, colorIndices, 0xFFFF, 0, mode.IndexBits);
+
+    // Alpha is encoded as the first channel of a single channel block, with 8 bit endpoints
+    static const BC7ModeInfo AlphaMode = { 1, 0, 0, 0, 8, 0, 0, 0, 2, 0 };
+
+    BlockPixels alphaBlock;
+    ExtractChannel(block, 3, alphaBlock);
+
+    BC7Subset alpha;
+    uint8_t alphaIndices[16];
+    error += EncodeBC7Subset(context, alphaBlock, 0xFFFF, AlphaMode, 1, RWeights, alpha, alphaIndices);
+    FixBC7Anchor(alpha, alphaIndices, 0xFFFF, 0, AlphaMode.IndexBits);
+
+    uint8_t candidate[16];
+    BitWriter writer(candidate);
+
+    writer.Write(1u << 5, 6);
+    writer.Write(0, mode.RotationBits);
+
+    for (uint32_t c = 0; c < 3; ++c) {
+        writer.Write(color.Value[0][c], mode.ColorBits);
+        writer.Write(color.Value[1][c], mode.ColorBits);
+    }
+
+    writer.Write(alpha.Value[0][0], mode.AlphaBits);
+    writer.Write(alpha.Value[1][0], mode.AlphaBits);
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        writer.Write(colorIndices[i], mode.IndexBits - (i == 0 ? 1 : 0));
+    }
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        writer.Write(alphaIndices[i], mode.SecondaryIndexBits - (i == 0 ? 1 : 0));
+    }
+
+    memcpy(output, candidate, sizeof(candidate));
+    return error;
+}
+
+// The squared distance of a subset's RGB pixels from the line through them, from the sums of
+// their channels and of each product of two channels. Branchless, so it vectorizes across
+// partitions.
+static inline float ComputeLineResidual(const float * moments, float count)
+{
+    float inverseCount = (count > 0.0f ? 1.0f / count : 0.0f);
+
+    float m00 = moments[3] - (moments[0] * moments[0] * inverseCount);
+    float m01 = moments[4] - (moments[0] * moments[1] * inverseCount);
+    float m02 = moments[5] - (moments[0] * moments[2] * inverseCount);
+    float m11 = moments[6] - (moments[1] * moments[1] * inverseCount);
+    float m12 = moments[7] - (moments[1] * moments[2] * inverseCount);
+    float m22 = moments[8] - (moments[2] * moments[2] * inverseCount);
+
+    // The largest eigenvalue is the spread along the line, two steps of power iteration from
+    // the widest channel are plenty for ranking
+    bool widest0 = (m00 >= m11 && m00 >= m22);
+    bool widest1 = (!widest0 && m11 >= m22);
+
+    float x0 = (widest0 ? m00 : (widest1 ? m01 : m02));
+    float y0 = (widest0 ? m01 : (widest1 ? m11 : m12));
+    float z0 = (widest0 ? m02 : (widest1 ? m12 : m22));
+
+    float x1 = (m00 * x0) + (m01 * y0) + (m02 * z0);
+    float y1 = (m01 * x0) + (m11 * y0) + (m12 * z0);
+    float z1 = (m02 * x0) + (m12 * y0) + (m22 * z0);
+
+    float x2 = (m00 * x1) + (m01 * y1) + (m02 * z1);
+    float y2 = (m01 * x1) + (m11 * y1) + (m12 * z1);
+    float z2 = (m02 * x1) + (m12 * y1) + (m22 * z1);
+
+    float numerator = (x2 * x1) + (y2 * y1) + (z2 * z1);
+    float denominator = (x1 * x1) + (y1 * y1) + (z1 * z1);
+    float eigenvalue = (denominator > 1e-6f ? numerator / denominator : 0.0f);
+
+    return std::max((m00 + m11 + m22) - eigenvalue, 0.0f);
+}
+
+// Estimates the error of each two subset partition by how far each subset's pixels are from a
+// line through them, which is cheap and predicts the encoded error well
+static void RankBC7Partitions(const BlockPixels& block, float * estimateList)
+{
+    // The partition table as 0 or 1 per pixel, with partitions innermost so the sums over the
+    // second subset of every partition vectorize
+    static const auto maskTable = []() {
+        Array<Array<float, 64>, 16> table;
+        for (uint32_t i = 0; i < 16; ++i) {
+            for (uint32_t p = 0; p < 64; ++p) {
+                table[i][p] = float((BC7PartitionTable[p] >> i) & 1);
+            }
+        }
+        return table;
+    }();
+
+    // R, G, B, RR, RG, RB, GG, GB, BB
+    float total[9] = {};
+    alignas(32) float sumList[9][64] = {};
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        float r = block.Channel[0][i];
+        float g = block.Channel[1][i];
+        float b = block.Channel[2][i];
+
+        const float moments[9] = { r, g, b, r * r, r * g, r * b, g * g, g * b, b * b };
+        const float * mask = maskTable[i].data();
+
+        for (uint32_t m = 0; m < 9; ++m) {
+            total[m] += moments[m];
+
+            for (uint32_t p = 0; p < 64; ++p) {
+                sumList[m][p] += moments[m] * mask[p];
+            }
+        }
+    }
+
+    for (uint32_t p = 0; p < 64; ++p) {
+        float subset[9];
+        float rest[9];
+        for (uint32_t m = 0; m < 9; ++m) {
+            subset[m] = sumList[m][p];
+            rest[m] = total[m] - sumList[m][p];
+        }
+
+        float count = float(std::popcount(BC7PartitionTable[p]));
+        estimateList[p] = ComputeLineResidual(subset, count) + ComputeLineResidual(rest, 16.0f - count);
+    }
+}
+
+// Returns the error of the best partition tried, only writing output if it beats bestError
+static float EncodeBC7TwoSubsets(const EncodeContext& context, const BlockPixels& block, uint32_t modeIndex, const uint8_t * partitionList, uint32_t partitionCount, float bestError, uint8_t * output)
+{
+    const auto& mode = BC7ModeList[modeIndex];
+
+    for (uint32_t p = 0; p < partitionCount; ++p) {
+        uint32_t partition = partitionList[p];
+        uint32_t maskList[2] = {
+            (~uint32_t(BC7PartitionTable[partition])) & 0xFFFF,
+            BC7PartitionTable[partition],
+        };
+
+        BC7Subset subsetList[2];
+        uint8_t indices[16];
+        float error = 0.0f;
+
+        for (uint32_t s = 0; s < 2 && error < bestError; ++s) {
+            uint8_t subsetIndices[16];
+            error += EncodeBC7Subset(context, block, maskList[s], mode, 3, RGBWeights, subsetList[s], subsetIndices);
+
+            for (uint32_t i = 0; i < 16; ++i) {
+                if (maskList[s] & (1u << i)) {
+                    indices[i] = subsetIndices[i];
+                }
+            }
+        }
+
+        if (error < bestError) {
+            FixBC7Anchor(subsetList[0], indices, maskList[0], 0, mode.IndexBits);
+            FixBC7Anchor(subsetList[1], indices, maskList[1], BC7AnchorTable[partition], mode.IndexBits);
+            PackBC7(modeIndex, partition, subsetList, indices, output);
+            bestError = error;
+        }
+    }
+
+    return bestError;
+}
+
+static void EncodeBC7Block(const EncodeContext& context, const BlockPixels& block, uint8_t * output)
+{
+    bool opaque = std::all_of(block.Channel[3], block.Channel[3] + 16, [](float alpha) {
+        return (alpha == 255.0f);
+    });
+
+    // Mode 6 fits RGBA in one subset with the most index precision, and handles anything
+    BC7Subset subset;
+    uint8_t indices[16];
+    float bestError = EncodeBC7Subset(context, block, 0xFFFF, BC7ModeList[6], 4, RGBAWeights, subset, indices);
+    FixBC7Anchor(subset, indices, 0xFFFF, 0, BC7ModeList[6].IndexBits);
+    PackBC7(6, 0, &subset, indices, output);
+
+    if (bestError == 0.0f) {
+        return;
+    }
+
+    if (opaque && context.Quality != BCQuality::Fast) {
+        float estimateList[64];
+        RankBC7Partitions(block, estimateList);
+
+        uint8_t partitionList[64];
+        for (uint32_t p = 0; p < 64; ++p) {
+            partitionList[p] = static_cast<uint8_t>(p);
+        }
+
+        uint32_t partitionCount = (context.Quality == BCQuality::Normal ? 2 : 8);
+        std::partial_sort(partitionList, partitionList + partitionCount, partitionList + 64, [&](uint8_t a, uint8_t b) {
+            return (estimateList[a] < estimateList[b]);
+        });
+
+        bestError = EncodeBC7TwoSubsets(context, block, 1, partitionList, partitionCount, bestError, output);
+
+        if (context.Quality == BCQuality::High) {
+            EncodeBC7TwoSubsets(context, block, 3, partitionList, partitionCount, bestError, output);
+        }
+    }
+    else if (!opaque) {
+        // Mode 5 fits alpha separately, for blocks where it doesn't follow the color, such
+        // as cutout edges
+        uint8_t candidate[16];
+        if (EncodeBC7Mode5(context, block, candidate) < bestError) {
+            memcpy(output, candidate, sizeof(candidate));
+        }
+    }
+}
+
+List<uint8_t> EncodeBC(VkFormat format, const uint8_t * pixels, uint32_t width, uint32_t height, BCQuality quality)
+{
+    if (!IsBCEncoderFormat(format)) {
+        throw Exception("Unable to encode texture format {}", VkFormatToString(format));
+    }
+
+    uint32_t blockSize = GetTextureFormatBlockSize(format);
+    uint32_t blockCountX = (width + 3) / 4;
+    uint32_t blockCountY = (height + 3) / 4;
+
+    List<uint8_t> data(size_t(blockCountX) * blockCountY * blockSize);
+
+    EncodeContext context = {
+        .FindIndices = GetFindIndicesFunction(),
+        .Quality = quality,
+    };
+
+    // A block takes a few microseconds, even at Fast
+    ParallelFor(size_t(blockCountX) * blockCountY, 64, [&](size_t first, size_t last) {
+        BlockPixels block;
+        BlockPixels single;
+
+        for (size_t b = first; b < last; ++b) {
+            uint32_t blockX = static_cast<uint32_t>(b % blockCountX);
+            uint32_t blockY = static_cast<uint32_t>(b / blockCountX);
+            uint8_t * output = data.data() + (b * blockSize);
+
+            LoadBlock(pixels, width, height, blockX, blockY, block);
+
+            switch (format) {
+                case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                    EncodeBC1Block(context, block, false, output);
+                    break;
+                case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                    EncodeBC1Block(context, block, true, output);
+                    break;
+                case VK_FORMAT_BC3_UNORM_BLOCK:
+                case VK_FORMAT_BC3_SRGB_BLOCK:
+                    ExtractChannel(block, 3, single);
+                    EncodeBC4Block(context, single, output);
+                    EncodeBC1Block(context, block, false, output + 8);
+                    break;
+                case VK_FORMAT_BC4_UNORM_BLOCK:
+                    EncodeBC4Block(context, block, output);
+                    break;
+                case VK_FORMAT_BC5_UNORM_BLOCK:
+                    EncodeBC4Block(context, block, output);
+                    ExtractChannel(block, 1, single);
+                    EncodeBC4Block(context, single, output + 8);
+                    break;
+                default:
+                    EncodeBC7Block(context, block, output);
+                    break;
+            }
+        }
+    });
+
+    return data;
+}
+
+//
+// Decoding
+//
+
+static void DecodeBC1Block(const uint8_t * input, bool fourColorOnly, uint8_t (*pixels)[4])
+{
+    uint16_t color0 = uint16_t(input[0] | (input[1] << 8));
+    uint16_t color1 = uint16_t(input[2] | (input[3] << 8));
+
+    float expanded[2][4];
+    ExpandRGB565(color0, expanded[0]);
+    ExpandRGB565(color1, expanded[1]);
+
+    uint8_t palette[4][4];
+    for (uint32_t c = 0; c < 4; ++c) {
+        float value0 = expanded[0][c];
+        float value1 = expanded[1][c];
+
+        palette[0][c] = uint8_t(value0);
+        palette[1][c] = uint8_t(value1);
+
+        if (color0 > color1 || fourColorOnly) {
+            palette[2][c] = uint8_t(std::lround(((2.0f * value0) + value1) / 3.0f));
+            palette[3][c] = uint8_t(std::lround((value0 + (2.0f * value1)) / 3.0f));
+        }
+        else {
+            palette[2][c] = uint8_t(std::lround((value0 + value1) / 2.0f));
+            palette[3][c] = 0;
+        }
+    }
+
+    uint32_t indexBits;
+    memcpy(&indexBits, input + 4, sizeof(indexBits));
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        memcpy(pixels[i], palette[(indexBits >> (i * 2)) & 3], 4);
+    }
+}
+
+static void DecodeBC4Block(const uint8_t * input, uint32_t channel, uint8_t (*pixels)[4])
+{
+    float values[8];
+    BuildBC4Palette(input[0], input[1], values);
+
+    uint64_t indexBits = 0;
+    for (uint32_t i = 0; i < 6; ++i) {
+        indexBits |= uint64_t(input[2 + i]) << (i * 8);
+    }
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        pixels[i][channel] = uint8_t(values[(indexBits >> (i * 3)) & 7]);
+    }
+}
+
+static void DecodeBC7Block(const uint8_t * input, uint8_t (*pixels)[4])
+{
+    BitReader reader(input);
+
+    uint32_t modeIndex = 0;
+    while (modeIndex < 8 && reader.Read(1) == 0) {
+        ++modeIndex;
+    }
+
+    if (modeIndex == 8 || BC7ModeList[modeIndex].SubsetCount == 3) {
+        memset(pixels, 0, 16 * 4);
+        return;
+    }
+
+    const auto& mode = BC7ModeList[modeIndex];
+
+    uint32_t partition = reader.Read(mode.PartitionBits);
+    uint32_t rotation = reader.Read(mode.RotationBits);
+    uint32_t indexSelection = reader.Read(mode.IndexSelectionBits);
+
+    // Ordered subset 0 endpoint 0, subset 0 endpoint 1, subset 1 endpoint 0, ...
+    uint32_t endpointCount = mode.SubsetCount * 2;
+    uint32_t value[4][4] = {};
+    uint32_t pBit[4] = {};
+
+    for (uint32_t c = 0; c < 3; ++c) {
+        for (uint32_t e = 0; e < endpointCount; ++e) {
+            value[e][c] = reader.Read(mode.ColorBits);
+        }
+    }
+
+    if (mode.AlphaBits) {
+        for (uint32_t e = 0; e < endpointCount; ++e) {
+            value[e][3] = reader.Read(mode.AlphaBits);
+        }
+    }
+
+    if (mode.EndpointPBits) {
+        for (uint32_t e = 0; e < endpointCount; ++e) {
+            pBit[e] = reader.Read(1);
+        }
+    }
+    else if (mode.SharedPBits) {
+        for (uint32_t s = 0; s < mode.SubsetCount; ++s) {
+            pBit[(s * 2) + 1] = pBit[s * 2] = reader.Read(1);
+        }
+    }
+
+    bool hasPBits = (mode.EndpointPBits || mode.SharedPBits);
+
+    uint8_t endpoint[4][4];
+    for (uint32_t e = 0; e < endpointCount; ++e) {
+        for (uint32_t c = 0; c < 4; ++c) {
+            uint32_t bitCount = (c < 3 ? mode.ColorBits : mode.AlphaBits);
+            if (bitCount == 0) {
+                endpoint[e][c] = 255;
+            }
+            else {
+                endpoint[e][c] = DequantizeBC7(value[e][c], bitCount, (hasPBits ? int(pBit[e]) : -1));
+            }
+        }
+    }
+
+    uint32_t anchor = (mode.SubsetCount == 2 ? BC7AnchorTable[partition] : 0);
+
+    uint8_t indices[16];
+    for (uint32_t i = 0; i < 16; ++i) {
+        bool isAnchor = (i == 0 || i == anchor);
+        indices[i] = uint8_t(reader.Read(mode.IndexBits - (isAnchor ? 1 : 0)));
+    }
+
+    uint8_t secondaryIndices[16] = {};
+    if (mode.SecondaryIndexBits) {
+        for (uint32_t i = 0; i < 16; ++i) {
+            secondaryIndices[i] = uint8_t(reader.Read(mode.SecondaryIndexBits - (i == 0 ? 1 : 0)));
+        }
+    }
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        uint32_t subset = (mode.SubsetCount == 2 ? ((BC7PartitionTable[partition] >> i) & 1) : 0);
+        const uint8_t * endpoint0 = endpoint[subset * 2];
+        const uint8_t * endpoint1 = endpoint[(subset * 2) + 1];
+
+        uint32_t colorWeight = GetBC7Weights(mode.IndexBits)[indices[i]];
+        uint32_t alphaWeight = colorWeight;
+
+        if (mode.SecondaryIndexBits) {
+            uint32_t secondaryWeight = GetBC7Weights(mode.SecondaryIndexBits)[secondaryIndices[i]];
+            if (indexSelection) {
+                alphaWeight = colorWeight;
+                colorWeight = secondaryWeight;
+            }
+            else {
+                alphaWeight = secondaryWeight;
+            }
+        }
+
+        for (uint32_t c = 0; c < 4; ++c) {
+            uint32_t weight = (c < 3 ? colorWeight : alphaWeight);
+            pixels[i][c] = uint8_t((((64 - weight) * endpoint0[c]) + (weight * endpoint1[c]) + 32) >> 6);
+        }
+
+        if (rotation) {
+            std::swap(pixels[i][3], pixels[i][rotation - 1]);
+        }
+    }
+}
+
+List<uint8_t> DecodeBC(VkFormat format, const uint8_t * data, uint32_t width, uint32_t height)
+{
+    if (!IsBCEncoderFormat(format)) {
+        throw Exception("Unable to decode texture format {}", VkFormatToString(format));
+    }
+
+    uint32_t blockSize = GetTextureFormatBlockSize(format);
+    uint32_t blockCountX = (width + 3) / 4;
+    uint32_t blockCountY = (height + 3) / 4;
+
+    List<uint8_t> pixels(size_t(width) * height * 4);
+
+    for (uint32_t blockY = 0; blockY < blockCountY; ++blockY) {
+        for (uint32_t blockX = 0; blockX < blockCountX; ++blockX) {
+            const uint8_t * input = data + ((size_t(blockY) * blockCountX + blockX) * blockSize);
+
+            uint8_t block[16][4];
+            for (uint32_t i = 0; i < 16; ++i) {
+                block[i][0] = 0;
+                block[i][1] = 0;
+                block[i][2] = 0;
+                block[i][3] = 255;
+            }
+
+            switch (format) {
+                case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                    DecodeBC1Block(input, false, block);
+                    break;
+                case VK_FORMAT_BC3_UNORM_BLOCK:
+                case VK_FORMAT_BC3_SRGB_BLOCK:
+                    DecodeBC1Block(input + 8, true, block);
+                    DecodeBC4Block(input, 3, block);
+                    break;
+                case VK_FORMAT_BC4_UNORM_BLOCK:
+                    DecodeBC4Block(input, 0, block);
+                    break;
+                case VK_FORMAT_BC5_UNORM_BLOCK:
+                    DecodeBC4Block(input, 0, block);
+                    DecodeBC4Block(input + 8, 1, block);
+                    break;
+                default:
+                    DecodeBC7Block(input, block);
+                    break;
+            }
+
+            for (uint32_t y = 0; y < 4 && (blockY * 4) + y < height; ++y) {
+                for (uint32_t x = 0; x < 4 && (blockX * 4) + x < width; ++x) {
+                    size_t offset = ((size_t((blockY * 4) + y) * width) + (blockX * 4) + x) * 4;
+                    memcpy(pixels.data() + offset, block[(y * 4) + x], 4);
+                }
+            }
+        }
+    }
+
+    return pixels;
+}
+
+double ComputePSNR(const uint8_t * a, const uint8_t * b, uint32_t width, uint32_t height, uint32_t channelMask)
+{
+    double sum = 0.0;
+    size_t count = 0;
+
+    for (size_t i = 0; i < size_t(width) * height; ++i) {
+        for (uint32_t c = 0; c < 4; ++c) {
+            if (channelMask & (1u << c)) {
+                double difference = double(a[(i * 4) + c]) - double(b[(i * 4) + c]);
+                sum += difference * difference;
+                ++count;
+            }
+        }
+    }
+
+    if (sum == 0.0 || count == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    double meanSquaredError = sum / double(count);
+    return 10.0 * std::log10((255.0 * 255.0) / meanSquaredError);
+}
+
+} // namespace noon
@@ -0,0 +1,166 @@
+#include <Noon/Bounds.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace noon {
+
+BoundingSphere BoundingSphere::FromPoints(Span<const Vec3> pointList)
+{
+    if (pointList.empty()) {
+        return { };
+    }
+
+    AABB aabb = AABB::FromPoints(pointList);
+
+    BoundingSphere sphere;
+    sphere.Center = aabb.GetCenter();
+
+    for (const auto& point : pointList) {
+        sphere.Radius = std::max(sphere.Radius, glm::length(point - sphere.Center));
+    }
+
+    return sphere;
+}
+
+BoundingSphere BoundingSphere::Transform(const Mat4& model) const
+{
+    float scale = std::max({
+        glm::length(Vec3(model[0])),
+        glm::length(Vec3(model[1])),
+        glm::length(Vec3(model[2])),
+    });
+
+    return {
+        Vec3(model * Vec4(Center, 1.0f)),
+        Radius * scale,
+    };
+}
+
+BoundingSphere BoundingSphere::Merge(const BoundingSphere& other) const
+{
+    Vec3 offset = other.Center - Center;
+    float distance = glm::length(offset);
+
+    // One contains the other
+    if (distance + other.Radius <= Radius) {
+        return *this;
+    }
+
+    if (distance + Radius <= other.Radius) {
+        return other;
+    }
+
+    float radius = (distance + Radius + other.Radius) * 0.5f;
+
+    return {
+        Center + offset * ((radius - Radius) / distance),
+        radius,
+    };
+}
+
+String BoundingSphere::ToString() const
+{
+    return fmt::format("({}, {}, {}) r={}", Center.x, Center.y, Center.z, Radius);
+}
+
+AABB AABB::FromPoints(Span<const Vec3> pointList)
+{
+    if (pointList.empty()) {
+        return { };
+    }
+
+    AABB aabb = { pointList[0], pointList[0] };
+
+    for (const auto& point : pointList) {
+        aabb.Min = glm::min(aabb.Min, point);
+        aabb.Max = glm::max(aabb.Max, point);
+    }
+
+    return aabb;
+}
+
+AABB AABB::Transform(const Mat4& model) const
+{
+    // "Transforming Axis-Aligned Bounding Boxes", Graphics Gems, James Arvo
+    AABB aabb = { Vec3(model[3]), Vec3(model[3]) };
+
+    for (int column = 0; column < 3; ++column) {
+        for (int row = 0; row < 3; ++row) {
+            float a = model[column][row] * Min[column];
+            float b = model[column][row] * Max[column];
+
+            aabb.Min[row] += std::min(a, b);
+            aabb.Max[row] += std::max(a, b);
+        }
+    }
+
+    return aabb;
+}
+
+AABB AABB::Merge(const AABB& other) const
+{
+    return {
+        glm::min(Min, other.Min),
+        glm::max(Max, other.Max),
+    };
+}
+
+String AABB::ToString() const
+{
+    return fmt::format("({}, {}, {}) - ({}, {}, {})", Min.x, Min.y, Min.z, Max.x, Max.y, Max.z);
+}
+
+Frustum Frustum::FromMatrix(const Mat4& viewProjection)
+{
+    auto row = [&](int i) {
+        return Vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    };
+
+    Frustum frustum;
+    frustum.Planes[Left] = row(3) + row(0);
+    frustum.Planes[Right] = row(3) - row(0);
+    frustum.Planes[Bottom] = row(3) + row(1);
+    frustum.Planes[Top] = row(3) - row(1);
+    frustum.Planes[Near] = row(3) + row(2);
+    frustum.Planes[Far] = row(3) - row(2);
+
+    for (auto& plane : frustum.Planes) {
+        plane /= glm::length(Vec3(plane));
+    }
+
+    return frustum;
+}
+
+bool Frustum::Intersects(const BoundingSphere& sphere) const
+{
+    for (const auto& plane : Planes) {
+        if (glm::dot(Vec3(plane), sphere.Center) + plane.w < -sphere.Radius) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Frustum::Intersects(const AABB& aabb) const
+{
+    Vec3 center = aabb.GetCenter();
+    Vec3 extents = aabb.GetExtents();
+
+    // Project the extents onto the normal, giving the radius of the box along it
+    for (const auto& plane : Planes) {
+        float distance = glm::dot(Vec3(plane), center) + plane.w;
+        float radius = glm::dot(glm::abs(Vec3(plane)), extents);
+
+        if (distance < -radius) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace noon
@@ -1,4 +1,5 @@
 #include <Noon/Buffer.hpp>
+#include <Noon/Defragmenter.hpp>
 #include <Noon/Exception.hpp>
 #include <Noon/Application.hpp>
 
@@ -7,11 +8,23 @@
 
 namespace noon {
 
-Buffer::Buffer(VkDeviceSize size, uint8_t * data, VkBufferUsageFlags bufferUsageFlags, VmaMemoryUsage memoryUsage)
+Buffer::Buffer(VkDeviceSize size, uint8_t * data, VkBufferUsageFlags bufferUsageFlags, VmaMemoryUsage memoryUsage, MemoryPool memoryPool)
     : _size(size)
     , _vkBufferUsageFlags(bufferUsageFlags)
     , _vmaMemoryUsage(memoryUsage)
+    , _memoryPool(memoryPool)
 {
+    // Buffers rewritten by the CPU are assumed to be short-lived, like per-frame uniforms
+    if (_memoryPool == MemoryPool::Staging) {
+        _memoryCategory = MemoryCategory::Staging;
+    }
+    else if (_memoryPool == MemoryPool::Transient || _vmaMemoryUsage == VMA_MEMORY_USAGE_CPU_TO_GPU) {
+        _memoryCategory = MemoryCategory::Transient;
+    }
+    else {
+        _memoryCategory = MemoryCategory::Buffer;
+    }
+
     VkResult vkResult;
 
     auto gfx = Application::GetInstance()->GetGraphicsDriver();
@@ -36,15 +49,17 @@ Buffer::Buffer(VkDeviceSize size, uint8_t * data, VkBufferUsageFlags bufferUsage
                 .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
             };
 
+            // Staging buffers are freed right after the copy, so they never wrap the ring
             VmaAllocationCreateInfo stagingAllocationCreateInfo = {
                 .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
                 .usage = VMA_MEMORY_USAGE_CPU_ONLY,
+                .pool = gfx->GetMemoryPool(MemoryPool::Staging),
             };
             
             VmaAllocationInfo stagingAllocationInfo;
 
-            vkResult = vmaCreateBuffer(
-                gfx->GetAllocator(),
+            vkResult = gfx->CreateBuffer(
+                MemoryCategory::Staging,
                 &stagingBufferCreateInfo,
                 &stagingAllocationCreateInfo,
                 &stagingBuffer,
@@ -55,25 +70,37 @@ Buffer::Buffer(VkDeviceSize size, uint8_t * data, VkBufferUsageFlags bufferUsage
                 throw Exception("vmaCreateBuffer() failed, unable to create staging buffer");
             }
 
+            memcpy(stagingAllocationInfo.pMappedData, data, _size);
+
             _vkBufferUsageFlags |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
         }
-        
+
+        // The Defragmenter copies from the old buffer to the new one on the transfer queue
+        _vkBufferUsageFlags |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+        const auto& queueFamilyIndexList = gfx->GetSharedQueueFamilyIndexList();
+
         VkBufferCreateInfo bufferCreateInfo = {
             .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
             .pNext = nullptr,
             .flags = 0,
             .size = _size,
             .usage = _vkBufferUsageFlags,
-            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .sharingMode = (queueFamilyIndexList.size() > 1
+                ? VK_SHARING_MODE_CONCURRENT
+                : VK_SHARING_MODE_EXCLUSIVE),
+            .queueFamilyIndexCount = static_cast<uint32_t>(queueFamilyIndexList.size()),
+            .pQueueFamilyIndices = queueFamilyIndexList.data(),
         };
 
         VmaAllocationCreateInfo allocationCreateInfo = {
             .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
             .usage = _vmaMemoryUsage,
+            .pool = gfx->GetMemoryPool(_memoryPool),
         };
         
-        vkResult = vmaCreateBuffer(
-            gfx->GetAllocator(),
+        vkResult = gfx->CreateBuffer(
+            _memoryCategory,
             &bufferCreateInfo,
             &allocationCreateInfo,
             &_vkBuffer,
@@ -87,8 +114,11 @@ Buffer::Buffer(VkDeviceSize size, uint8_t * data, VkBufferUsageFlags bufferUsage
         if (data) {
             gfx->CopyBuffer(stagingBuffer, _vkBuffer, _size);
 
-            vkDestroyBuffer(gfx->GetDevice(), stagingBuffer, nullptr);
-            vmaFreeMemory(gfx->GetAllocator(), stagingAllocation);
+            gfx->DestroyBuffer(MemoryCategory::Staging, stagingBuffer, stagingAllocation);
+        }
+
+        if (IsMovable()) {
+            gfx->GetDefragmenter()->RegisterBuffer(this);
         }
     }
     else {
@@ -104,12 +134,13 @@ Buffer::Buffer(VkDeviceSize size, uint8_t * data, VkBufferUsageFlags bufferUsage
         VmaAllocationCreateInfo allocationCreateInfo = {
             .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
             .usage = _vmaMemoryUsage,
+            .pool = gfx->GetMemoryPool(_memoryPool),
         };
 
         VmaAllocationInfo allocationInfo;
 
-        vkResult = vmaCreateBuffer(
-            gfx->GetAllocator(),
+        vkResult = gfx->CreateBuffer(
+            _memoryCategory,
             &bufferCreateInfo,
             &allocationCreateInfo,
             &_vkBuffer,
@@ -137,15 +168,19 @@ Buffer::~Buffer()
 {
     auto gfx = Application::GetInstance()->GetGraphicsDriver();
 
-    if (_mappedBufferMemory) {
-        vmaUnmapMemory(gfx->GetAllocator(), _vmaAllocation);
-        _mappedBufferMemory = nullptr;
+    // Persistently mapped memory is unmapped by VMA when the allocation is freed
+    _mappedBufferMemory = nullptr;
+
+    bool canDestroy = true;
+    if (IsMovable()) {
+        canDestroy = gfx->GetDefragmenter()->UnregisterBuffer(this);
     }
 
-    vkDestroyBuffer(gfx->GetDevice(), _vkBuffer, nullptr);
-    _vkBuffer = VK_NULL_HANDLE;
+    if (canDestroy) {
+        gfx->DestroyBuffer(_memoryCategory, _vkBuffer, _vmaAllocation);
+    }
 
-    vmaFreeMemory(gfx->GetAllocator(), _vmaAllocation);
+    _vkBuffer = VK_NULL_HANDLE;
     _vmaAllocation = VK_NULL_HANDLE;
 }
 
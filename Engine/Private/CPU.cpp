@@ -0,0 +1,49 @@
+#include <Noon/CPU.hpp>
+
+#if defined(NOON_ARCH_X64) && defined(NOON_COMPILER_MSVC)
+
+    #include <intrin.h>
+
+#endif
+
+namespace noon {
+
+NOON_API
+bool HasAVX2()
+{
+#if defined(NOON_ARCH_X64)
+
+    #if defined(NOON_COMPILER_MSVC)
+
+        int info[4];
+
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+
+        // FMA, OSXSAVE and AVX, and the OS saves the YMM registers
+        __cpuid(info, 1);
+        const int features = (1 << 12) | (1 << 27) | (1 << 28);
+        if ((info[2] & features) != features || (_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5));
+
+    #else
+
+        __builtin_cpu_init();
+        return (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"));
+
+    #endif
+
+#else
+
+    return false;
+
+#endif
+}
+
+} // namespace noon
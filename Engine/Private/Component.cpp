@@ -0,0 +1,42 @@
+#include <Noon/Component.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/Exception.hpp>
+
+#include <mutex>
+
+namespace noon {
+
+// Fixed-size, so references returned by GetComponentTypeInfo() stay valid while other types
+// are registered
+static Array<ComponentTypeInfo, MaxComponentTypeCount> _componentTypeList;
+
+static size_t _componentTypeCount = 0;
+
+static std::mutex _componentTypeMutex;
+
+NOON_API
+ComponentTypeID RegisterComponentType(const ComponentTypeInfo& info)
+{
+    std::lock_guard lock(_componentTypeMutex);
+
+    for (size_t i = 0; i < _componentTypeCount; ++i) {
+        if (_componentTypeList[i].Name == info.Name) {
+            return static_cast<ComponentTypeID>(i);
+        }
+    }
+
+    if (_componentTypeCount == MaxComponentTypeCount) {
+        throw Exception("Unable to register component type '{}', the limit is {}", info.Name, MaxComponentTypeCount);
+    }
+
+    _componentTypeList[_componentTypeCount] = info;
+    return static_cast<ComponentTypeID>(_componentTypeCount++);
+}
+
+NOON_API
+const ComponentTypeInfo& GetComponentTypeInfo(ComponentTypeID id)
+{
+    return _componentTypeList[id];
+}
+
+} // namespace noon
@@ -0,0 +1,651 @@
+#include <Noon/Culling.hpp>
+#include <Noon/CPU.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/JobSystem.hpp>
+#include <Noon/Log.hpp>
+
+#if defined(NOON_ARCH_X64)
+
+    #include <immintrin.h>
+
+#elif defined(NOON_ARCH_ARM64)
+
+    #include <arm_neon.h>
+
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+namespace noon {
+
+static CullingBackend FindCullingBackend()
+{
+#if defined(NOON_ARCH_X64)
+
+    return (HasAVX2() ? CullingBackend::AVX2 : CullingBackend::SSE);
+
+#elif defined(NOON_ARCH_ARM64)
+
+    return CullingBackend::NEON;
+
+#else
+
+    return CullingBackend::Scalar;
+
+#endif
+}
+
+static std::atomic<CullingBackend> _cullingBackend = FindCullingBackend();
+
+NOON_API
+String CullingBackendToString(CullingBackend backend)
+{
+    switch (backend) {
+        case CullingBackend::Scalar:
+            return "Scalar";
+        case CullingBackend::SSE:
+            return "SSE";
+        case CullingBackend::AVX2:
+            return "AVX2";
+        case CullingBackend::NEON:
+            return "NEON";
+        default:
+            return fmt::format("Unknown ({})", static_cast<int>(backend));
+    }
+}
+
+NOON_API
+bool IsCullingBackendSupported(CullingBackend backend)
+{
+    switch (backend) {
+        case CullingBackend::Scalar:
+            return true;
+#if defined(NOON_ARCH_X64)
+        case CullingBackend::SSE:
+            return true;
+        case CullingBackend::AVX2:
+            return HasAVX2();
+#elif defined(NOON_ARCH_ARM64)
+        case CullingBackend::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+NOON_API
+CullingBackend GetCullingBackend()
+{
+    return _cullingBackend;
+}
+
+NOON_API
+void SetCullingBackend(CullingBackend backend)
+{
+    if (!IsCullingBackendSupported(backend)) {
+        throw Exception("Culling backend {} is not supported", CullingBackendToString(backend));
+    }
+
+    _cullingBackend = backend;
+
+    Log(NOON_ANCHOR, "Culling backend set to {}", CullingBackendToString(backend));
+}
+
+NOON_API
+void BoundingSphereList::Resize(size_t count)
+{
+    CenterX.resize(count);
+    CenterY.resize(count);
+    CenterZ.resize(count);
+    Radius.resize(count);
+}
+
+NOON_API
+void BoundingSphereList::Clear()
+{
+    Resize(0);
+}
+
+NOON_API
+uint32_t BoundingSphereList::Add(const BoundingSphere& sphere)
+{
+    size_t index = GetCount();
+    Resize(index + 1);
+    Set(index, sphere);
+    return static_cast<uint32_t>(index);
+}
+
+NOON_API
+void BoundingSphereList::Set(size_t index, const BoundingSphere& sphere)
+{
+    CenterX[index] = sphere.Center.x;
+    CenterY[index] = sphere.Center.y;
+    CenterZ[index] = sphere.Center.z;
+    Radius[index] = sphere.Radius;
+}
+
+NOON_API
+BoundingSphere BoundingSphereList::Get(size_t index) const
+{
+    return {
+        Vec3(CenterX[index], CenterY[index], CenterZ[index]),
+        Radius[index],
+    };
+}
+
+NOON_API
+void AABBList::Resize(size_t count)
+{
+    CenterX.resize(count);
+    CenterY.resize(count);
+    CenterZ.resize(count);
+    ExtentX.resize(count);
+    ExtentY.resize(count);
+    ExtentZ.resize(count);
+}
+
+NOON_API
+void AABBList::Clear()
+{
+    Resize(0);
+}
+
+NOON_API
+uint32_t AABBList::Add(const AABB& aabb)
+{
+    size_t index = GetCount();
+    Resize(index + 1);
+    Set(index, aabb);
+    return static_cast<uint32_t>(index);
+}
+
+NOON_API
+void AABBList::Set(size_t index, const AABB& aabb)
+{
+    Vec3 center = aabb.GetCenter();
+    Vec3 extents = aabb.GetExtents();
+
+    CenterX[index] = center.x;
+    CenterY[index] = center.y;
+    CenterZ[index] = center.z;
+    ExtentX[index] = extents.x;
+    ExtentY[index] = extents.y;
+    ExtentZ[index] = extents.z;
+}
+
+NOON_API
+AABB AABBList::Get(size_t index) const
+{
+    Vec3 center(CenterX[index], CenterY[index], CenterZ[index]);
+    Vec3 extents(ExtentX[index], ExtentY[index], ExtentZ[index]);
+    return { center - extents, center + extents };
+}
+
+// Append the indices of the set bits of mask, without branching on each one. The index is
+// always written, but only kept if the object is visible.
+static inline void WriteVisibleIndices(int mask, size_t first, size_t laneCount, uint32_t * visibleIndexList, size_t& visibleCount)
+{
+    for (size_t lane = 0; lane < laneCount; ++lane) {
+        visibleIndexList[visibleCount] = static_cast<uint32_t>(first + lane);
+        visibleCount += (mask >> lane) & 1;
+    }
+}
+
+static size_t CullSpheresScalar(const Frustum& frustum, const BoundingSphereList& sphereList, size_t first, size_t count, uint32_t * visibleIndexList)
+{
+    size_t visibleCount = 0;
+
+    for (size_t i = first; i < first + count; ++i) {
+        if (frustum.Intersects(sphereList.Get(i))) {
+            visibleIndexList[visibleCount++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    return visibleCount;
+}
+
+static size_t CullAABBsScalar(const Frustum& frustum, const AABBList& aabbList, size_t first, size_t count, uint32_t * visibleIndexList)
+{
+    size_t visibleCount = 0;
+
+    for (size_t i = first; i < first + count; ++i) {
+        if (frustum.Intersects(aabbList.Get(i))) {
+            visibleIndexList[visibleCount++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    return visibleCount;
+}
+
+#if defined(NOON_ARCH_X64)
+
+static size_t CullSpheresSSE(const Frustum& frustum, const BoundingSphereList& sphereList, size_t first, size_t count, uint32_t * visibleIndexList)
+{
+    __m128 planeX[Frustum::PlaneCount];
+    __m128 planeY[Frustum::PlaneCount];
+    __m128 planeZ[Frustum::PlaneCount];
+    __m128 planeW[Frustum::PlaneCount];
+
+    for (size_t p = 0; p < Frustum::PlaneCount; ++p) {
+        planeX[p] = _mm_set1_ps(frustum.Planes[p].x);
+        planeY[p] = _mm_set1_ps(frustum.Planes[p].y);
+        planeZ[p] = _mm_set1_ps(frustum.Planes[p].z);
+        planeW[p] = _mm_set1_ps(frustum.Planes[p].w);
+    }
+
+    size_t visibleCount = 0;
+    size_t end = first + count;
+    size_t i = first;
+
+    for (; i + 4 <= end; i += 4) {
+        __m128 centerX = _mm_loadu_ps(&sphereList.CenterX[i]);
+        __m128 centerY = _mm_loadu_ps(&sphereList.CenterY[i]);
+        __m128 centerZ = _mm_loadu_ps(&sphereList.CenterZ[i]);
+        __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&sphereList.Radius[i]));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for (size_t p = 0; p < Frustum::PlaneCount; ++p) {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(planeX[p], centerX), _mm_mul_ps(planeY[p], centerY)),
+                _mm_add_ps(_mm_mul_ps(planeZ[p], centerZ), planeW[p]));
+
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+
+        WriteVisibleIndices(_mm_movemask_ps(inside), i, 4, visibleIndexList, visibleCount);
+    }
+
+    visibleCount += CullSpheresScalar(frustum, sphereList, i, end - i, visibleIndexList + visibleCount);
+    return visibleCount;
+}
+
+static size_t CullAABBsSSE(const Frustum& frustum, const AABBList& aabbList, size_t first, size_t count, uint32_t * visibleIndexList)
+{
+    __m128 planeX[Frustum::PlaneCount];
+    __m128 planeY[Frustum::PlaneCount];
+    __m128 planeZ[Frustum::PlaneCount];
+    __m128 planeW[Frustum::PlaneCount];
+
+    // The absolute values of the normals, which project the extents onto them
+    __m128 absPlaneX[Frustum::PlaneCount];
+    __m128 absPlaneY[Frustum::PlaneCount];
+    __m128 absPlaneZ[Frustum::PlaneCount];
+
+    for (size_t p = 0; p < Frustum::PlaneCount; ++p) {
+        planeX[p] = _mm_set1_ps(frustum.Planes[p].x);
+        planeY[p] = _mm_set1_ps(frustum.Planes[p].y);
+        planeZ[p] = _mm_set1_ps(frustum.Planes[p].z);
+        planeW[p] = _mm_set1_ps(frustum.Planes[p].w);
+        absPlaneX[p] = _mm_set1_ps(std::abs(frustum.Planes[p].x));
+        absPlaneY[p] = _mm_set1_ps(std::abs(frustum.Planes[p].y));
+        absPlaneZ[p] = _mm_set1_ps(std::abs(frustum.Planes[p].z));
+    }
+
+    size_t visibleCount = 0;
+    size_t end = first + count;
+    size_t i = first;
+
+    for (; i + 4 <= end; i += 4) {
+        __m128 centerX = _mm_loadu_ps(&aabbList.CenterX[i]);
+        __m128 centerY = _mm_loadu_ps(&aabbList.CenterY[i]);
+        __m128 centerZ = _mm_loadu_ps(&aabbList.CenterZ[i]);
+        __m128 extentX = _mm_loadu_ps(&aabbList.ExtentX[i]);
+        __m128 extentY = _mm_loadu_ps(&aabbList.ExtentY[i]);
+        __m128 extentZ = _mm_loadu_ps(&aabbList.ExtentZ[i]);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for (size_t p = 0; p < Frustum::PlaneCount; ++p) {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(planeX[p], centerX), _mm_mul_ps(planeY[p], centerY)),
+                _mm_add_ps(_mm_mul_ps(planeZ[p], centerZ), planeW[p]));
+
+            __m128 radius = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(absPlaneX[p], extentX), _mm_mul_ps(absPlaneY[p], extentY)),
+                _mm_mul_ps(absPlaneZ[p], extentZ));
+
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+
+        WriteVisibleIndices(_mm_movemask_ps(inside), i, 4, visibleIndexList, visibleCount);
+    }
+
+    visibleCount += CullAABBsScalar(frustum, aabbList, i, end - i, visibleIndexList + visibleCount);
+    return visibleCount;
+}
+
+NOON_TARGET_AVX2
+static size_t CullSpheresAVX2(const Frustum& frustum, const BoundingSphereList& sphereList, size_t first, size_t count, uint32_t * visibleIndexList)
+{
+    __m256 planeX[Frustum::PlaneCount];
+    __m256 planeY[Frustum::PlaneCount];
+    __m256 planeZ[Frustum::PlaneCount];
+    __m256 planeW[Frustum::PlaneCount];
+
+    for (size_t p = 0; p < Frustum::PlaneCount; ++p) {
+        planeX[p] = _mm256_set1_ps(frustum.Planes[p].x);
+        planeY[p] = _mm256_set1_ps(frustum.Planes[p].y);
+        planeZ[p] = _mm256_set1_ps(frustum.Planes[p].z);
+        planeW[p] = _mm256_set1_ps(frustum.Planes[p].w);
+    }
+
+    size_t visibleCount = 0;
+    size_t end = first + count;
+    size_t i = first;
+
+    for (; i + 8 <= end; i += 8) {
+        __m256 centerX = _mm256_loadu_ps(&sphereList.CenterX[i]);
+        __m256 centerY = _mm256_loadu_ps(&sphereList.CenterY[i]);
+        __m256 centerZ = _mm256_loadu_ps(&sphereList.CenterZ[i]);
+        __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&sphereList.Radius[i]));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for (size_t p = 0; p < Frustum::PlaneCount; ++p) {
+            __m256 distance = _mm256_fmadd_ps(planeX[p], centerX,
+                _mm256_fmadd_ps(planeY[p], centerY,
+                    _mm256_fmadd_ps(planeZ[p], centerZ, planeW[p])));
+
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+        }
+
+        WriteVisibleIndices(_mm256_movemask_ps(inside), i, 8, visibleIndexList, visibleCount);
+    }
+
+    visibleCount += CullSpheresSSE(frustum, sphereList, i, end - i, visibleIndexList + visibleCount);
+    return visibleCount;
+}
+
+NOON_TARGET_AVX2
+static size_t CullAABBsAVX2(const Frustum& frustum, const AABBList& aabbList, size_t first, size_t count, uint32_t * visibleIndexList)
+{
+    __m256 planeX[Frustum::PlaneCount];
+    __m256 planeY[Frustum::PlaneCount];
+    __m256 planeZ[Frustum::PlaneCount];
+    __m256 planeW[Frustum::PlaneCount];
+
+    __m256 absPlaneX[Frustum::PlaneCount];
+    __m256 absPlaneY[Frustum::PlaneCount];
+    __m256 absPlaneZ[Frustum::PlaneCount];
+
+    for (size_t p = 0; p < Frustum::PlaneCount; ++p) {
+        planeX[p] = _mm256_set1_ps(frustum.Planes[p].x);
+        planeY[p] = _mm256_set1_ps(frustum.Planes[p].y);
+        planeZ[p] = _mm256_set1_ps(frustum.Planes[p].z);
+        planeW[p] = _mm256_set1_ps(frustum.Planes[p].w);
+        absPlaneX[p] = _mm256_set1_ps(std::abs(frustum.Planes[p].x));
+        absPlaneY[p] = _mm256_set1_ps(std::abs(frustum.Planes[p].y));
+        absPlaneZ[p] = _mm256_set1_ps(std::abs(frustum.Planes[p].z));
+    }
+
+    size_t visibleCount = 0;
+    size_t end = first + count;
+    size_t i = first;
+
+    for (; i + 8 <= end; i += 8) {
+        __m256 centerX = _mm256_loadu_ps(&aabbList.CenterX[i]);
+        __m256 centerY = _mm256_loadu_ps(&aabbList.CenterY[i]);
+        __m256 centerZ = _mm256_loadu_ps(&aabbList.CenterZ[i]);
+        __m256 extentX = _mm256_loadu_ps(&aabbList.ExtentX[i]);
+        __m256 extentY = _mm256_loadu_ps(&aabbList.ExtentY[i]);
+        __m256 extentZ = _mm256_loadu_ps(&aabbList.ExtentZ[i]);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for (size_t p = 0; p < Frustum::PlaneCount; ++p) {
+            // distance + radius, in one chain of multiply-adds
+            __m256 sum = _mm256_fmadd_ps(planeX[p], centerX,
+                _mm256_fmadd_ps(planeY[p], centerY,
+                    _mm256_fmadd_ps(planeZ[p], centerZ, planeW[p])));
+
+            sum = _mm256_fmadd_ps(absPlaneX[p], extentX,
+                _mm256_fmadd_ps(absPlaneY[p], extentY,
+                    _mm256_fmadd_ps(absPlaneZ[p], extentZ, sum)));
+
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(sum, _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        WriteVisibleIndices(_mm256_movemask_ps(inside), i, 8, visibleIndexList, visibleCount);
+    }
+
+    visibleCount += CullAABBsSSE(frustum, aabbList, i, end - i, visibleIndexList + visibleCount);
+    return visibleCount;
+}
+
+#endif // defined(NOON_ARCH_X64)
+
+#if defined(NOON_ARCH_ARM64)
+
+static inline int MoveMaskNEON(uint32x4_t mask)
+{
+    return (
+        (vgetq_lane_u32(mask, 0) & 1) |
+        (vgetq_lane_u32(mask, 1) & 2) |
+        (vgetq_lane_u32(mask, 2) & 4) |
+        (vgetq_lane_u32(mask, 3) & 8)
+    );
+}
+
+static size_t CullSpheresNEON(const Frustum& frustum, const BoundingSphereList& sphereList, size_t first, size_t count, uint32_t * visibleIndexList)
+{
+    float32x4_t planeX[Frustum::PlaneCount];
+    float32x4_t planeY[Frustum::PlaneCount];
+    float32x4_t planeZ[Frustum::PlaneCount];
+    float32x4_t planeW[Frustum::PlaneCount];
+
+    for (size_t p = 0; p < Frustum::PlaneCount; ++p) {
+        planeX[p] = vdupq_n_f32(frustum.Planes[p].x);
+        planeY[p] = vdupq_n_f32(frustum.Planes[p].y);
+        planeZ[p] = vdupq_n_f32(frustum.Planes[p].z);
+        planeW[p] = vdupq_n_f32(frustum.Planes[p].w);
+    }
+
+    size_t visibleCount = 0;
+    size_t end = first + count;
+    size_t i = first;
+
+    for (; i + 4 <= end; i += 4) {
+        float32x4_t centerX = vld1q_f32(&sphereList.CenterX[i]);
+        float32x4_t centerY = vld1q_f32(&sphereList.CenterY[i]);
+        float32x4_t centerZ = vld1q_f32(&sphereList.CenterZ[i]);
+        float32x4_t negativeRadius = vnegq_f32(vld1q_f32(&sphereList.Radius[i]));
+
+        uint32x4_t inside = vdupq_n_u32(0xFFFFFFFF);
+
+        for (size_t p = 0; p < Frustum::PlaneCount; ++p) {
+            float32x4_t distance = vfmaq_f32(planeW[p], planeX[p], centerX);
+            distance = vfmaq_f32(distance, planeY[p], centerY);
+            distance = vfmaq_f32(distance, planeZ[p], centerZ);
+
+            inside = vandq_u32(inside, vcgeq_f32(distance, negativeRadius));
+        }
+
+        WriteVisibleIndices(MoveMaskNEON(inside), i, 4, visibleIndexList, visibleCount);
+    }
+
+    visibleCount += CullSpheresScalar(frustum, sphereList, i, end - i, visibleIndexList + visibleCount);
+    return visibleCount;
+}
+
+static size_t CullAABBsNEON(const Frustum& frustum, const AABBList& aabbList, size_t first, size_t count, uint32_t * visibleIndexList)
+{
+    float32x4_t planeX[Frustum::PlaneCount];
+    float32x4_t planeY[Frustum::PlaneCount];
+    float32x4_t planeZ[Frustum::PlaneCount];
+    float32x4_t planeW[Frustum::PlaneCount];
+
+    float32x4_t absPlaneX[Frustum::PlaneCount];
+    float32x4_t absPlaneY[Frustum::PlaneCount];
+    float32x4_t absPlaneZ[Frustum::PlaneCount];
+
+    for (size_t p = 0; p < Frustum::PlaneCount; ++p) {
+        planeX[p] = vdupq_n_f32(frustum.Planes[p].x);
+        planeY[p] = vdupq_n_f32(frustum.Planes[p].y);
+        planeZ[p] = vdupq_n_f32(frustum.Planes[p].z);
+        planeW[p] = vdupq_n_f32(frustum.Planes[p].w);
+        absPlaneX[p] = vdupq_n_f32(std::abs(frustum.Planes[p].x));
+        absPlaneY[p] = vdupq_n_f32(std::abs(frustum.Planes[p].y));
+        absPlaneZ[p] = vdupq_n_f32(std::abs(frustum.Planes[p].z));
+    }
+
+    size_t visibleCount = 0;
+    size_t end = first + count;
+    size_t i = first;
+
+    for (; i + 4 <= end; i += 4) {
+        float32x4_t centerX = vld1q_f32(&aabbList.CenterX[i]);
+        float32x4_t centerY = vld1q_f32(&aabbList.CenterY[i]);
+        float32x4_t centerZ = vld1q_f32(&aabbList.CenterZ[i]);
+        float32x4_t extentX = vld1q_f32(&aabbList.ExtentX[i]);
+        float32x4_t extentY = vld1q_f32(&aabbList.ExtentY[i]);
+        float32x4_t extentZ = vld1q_f32(&aabbList.ExtentZ[i]);
+
+        uint32x4_t inside = vdupq_n_u32(0xFFFFFFFF);
+
+        for (size_t p = 0; p < Frustum::PlaneCount; ++p) {
+            float32x4_t sum = vfmaq_f32(planeW[p], planeX[p], centerX);
+            sum = vfmaq_f32(sum, planeY[p], centerY);
+            sum = vfmaq_f32(sum, planeZ[p], centerZ);
+            sum = vfmaq_f32(sum, absPlaneX[p], extentX);
+            sum = vfmaq_f32(sum, absPlaneY[p], extentY);
+            sum = vfmaq_f32(sum, absPlaneZ[p], extentZ);
+
+            inside = vandq_u32(inside, vcgeq_f32(sum, vdupq_n_f32(0.0f)));
+        }
+
+        WriteVisibleIndices(MoveMaskNEON(inside), i, 4, visibleIndexList, visibleCount);
+    }
+
+    visibleCount += CullAABBsScalar(frustum, aabbList, i, end - i, visibleIndexList + visibleCount);
+    return visibleCount;
+}
+
+#endif // defined(NOON_ARCH_ARM64)
+
+NOON_API
+size_t CullSpheres(
+    const Frustum& frustum,
+    const BoundingSphereList& sphereList,
+    size_t first,
+    size_t count,
+    uint32_t * visibleIndexList)
+{
+    switch (GetCullingBackend()) {
+#if defined(NOON_ARCH_X64)
+        case CullingBackend::SSE:
+            return CullSpheresSSE(frustum, sphereList, first, count, visibleIndexList);
+        case CullingBackend::AVX2:
+            return CullSpheresAVX2(frustum, sphereList, first, count, visibleIndexList);
+#elif defined(NOON_ARCH_ARM64)
+        case CullingBackend::NEON:
+            return CullSpheresNEON(frustum, sphereList, first, count, visibleIndexList);
+#endif
+        default:
+            return CullSpheresScalar(frustum, sphereList, first, count, visibleIndexList);
+    }
+}
+
+NOON_API
+size_t CullAABBs(
+    const Frustum& frustum,
+    const AABBList& aabbList,
+    size_t first,
+    size_t count,
+    uint32_t * visibleIndexList)
+{
+    switch (GetCullingBackend()) {
+#if defined(NOON_ARCH_X64)
+        case CullingBackend::SSE:
+            return CullAABBsSSE(frustum, aabbList, first, count, visibleIndexList);
+        case CullingBackend::AVX2:
+            return CullAABBsAVX2(frustum, aabbList, first, count, visibleIndexList);
+#elif defined(NOON_ARCH_ARM64)
+        case CullingBackend::NEON:
+            return CullAABBsNEON(frustum, aabbList, first, count, visibleIndexList);
+#endif
+        default:
+            return CullAABBsScalar(frustum, aabbList, first, count, visibleIndexList);
+    }
+}
+
+// Each batch culls a contiguous range, writing to the same range of visibleIndexList, and
+// the results are then moved down to follow each other
+template <class CullFunction>
+static void ParallelCull(size_t count, List<uint32_t>& visibleIndexList, CullFunction cull)
+{
+    // Below this, scheduling a batch costs more than it saves
+    static const size_t MinObjectsPerBatch = 16 * 1024;
+
+    visibleIndexList.resize(count);
+
+    struct Range
+    {
+        size_t First;
+
+        size_t VisibleCount;
+
+    }; // struct Range
+
+    std::mutex mutex;
+    List<Range> rangeList;
+
+    // Keep the ranges a multiple of the widest kernel, so only the last one has a scalar tail
+    ParallelFor(count, MinObjectsPerBatch,
+        [&](size_t first, size_t last) {
+            size_t visibleCount = cull(first, last - first, visibleIndexList.data() + first);
+
+            std::lock_guard lock(mutex);
+            rangeList.push_back(Range{ first, visibleCount });
+        },
+        8);
+
+    std::sort(rangeList.begin(), rangeList.end(),
+        [](const Range& a, const Range& b) {
+            return (a.First < b.First);
+        });
+
+    size_t visibleCount = 0;
+    for (const auto& range : rangeList) {
+        if (range.First != visibleCount) {
+            memmove(
+                visibleIndexList.data() + visibleCount,
+                visibleIndexList.data() + range.First,
+                range.VisibleCount * sizeof(uint32_t));
+        }
+
+        visibleCount += range.VisibleCount;
+    }
+
+    visibleIndexList.resize(visibleCount);
+}
+
+NOON_API
+void ParallelCullSpheres(
+    const Frustum& frustum,
+    const BoundingSphereList& sphereList,
+    List<uint32_t>& visibleIndexList)
+{
+    ParallelCull(sphereList.GetCount(), visibleIndexList,
+        [&](size_t first, size_t count, uint32_t * output) {
+            return CullSpheres(frustum, sphereList, first, count, output);
+        });
+}
+
+NOON_API
+void ParallelCullAABBs(
+    const Frustum& frustum,
+    const AABBList& aabbList,
+    List<uint32_t>& visibleIndexList)
+{
+    ParallelCull(aabbList.GetCount(), visibleIndexList,
+        [&](size_t first, size_t count, uint32_t * output) {
+            return CullAABBs(frustum, aabbList, first, count, output);
+        });
+}
+
+} // namespace noon
@@ -0,0 +1,556 @@
+#include <Noon/Defragmenter.hpp>
+#include <Noon/Buffer.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/GraphicsDriver.hpp>
+#include <Noon/Log.hpp>
+
+#include <algorithm>
+
+namespace noon {
+
+using namespace std::chrono;
+
+NOON_API
+Defragmenter::Defragmenter(GraphicsDriver * gfx)
+    : _gfx(gfx)
+{
+    VkResult vkResult;
+
+    VkCommandPoolCreateInfo commandPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .queueFamilyIndex = _gfx->GetTransferQueueFamilyIndex(),
+    };
+
+    vkResult = vkCreateCommandPool(
+        _gfx->GetDevice(),
+        &commandPoolCreateInfo,
+        nullptr,
+        &_vkCommandPool);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkCreateCommandPool() failed");
+    }
+
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .commandPool = _vkCommandPool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+    };
+
+    vkResult = vkAllocateCommandBuffers(
+        _gfx->GetDevice(),
+        &commandBufferAllocateInfo,
+        &_vkCommandBuffer);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkAllocateCommandBuffers() failed");
+    }
+
+    VkFenceCreateInfo fenceCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+    };
+
+    vkResult = vkCreateFence(
+        _gfx->GetDevice(),
+        &fenceCreateInfo,
+        nullptr,
+        &_vkFence);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkCreateFence() failed");
+    }
+}
+
+NOON_API
+Defragmenter::~Defragmenter()
+{
+    Flush();
+
+    if (_vkFence) {
+        vkDestroyFence(_gfx->GetDevice(), _vkFence, nullptr);
+        _vkFence = VK_NULL_HANDLE;
+    }
+
+    if (_vkCommandPool) {
+        vkDestroyCommandPool(_gfx->GetDevice(), _vkCommandPool, nullptr);
+        _vkCommandPool = VK_NULL_HANDLE;
+        _vkCommandBuffer = VK_NULL_HANDLE;
+    }
+}
+
+NOON_API
+unsigned Defragmenter::AddBufferRelocationCallback(BufferRelocationCallback callback)
+{
+    std::lock_guard lock(_mutex);
+
+    unsigned id = _nextBufferRelocationCallbackId++;
+    _bufferRelocationCallbackList.emplace_back(id, std::move(callback));
+    return id;
+}
+
+NOON_API
+void Defragmenter::RemoveBufferRelocationCallback(unsigned id)
+{
+    std::lock_guard lock(_mutex);
+
+    std::erase_if(_bufferRelocationCallbackList,
+        [id](const auto& pair) {
+            return pair.first == id;
+        }
+    );
+}
+
+NOON_API
+void Defragmenter::Update()
+{
+    std::lock_guard lock(_mutex);
+
+    auto startTime = high_resolution_clock::now();
+
+    ++_frameIndex;
+
+    // Keep advancing until either the cycle has to wait on the GPU, or the budget is spent
+    bool progress = true;
+    while (progress) {
+        progress = false;
+
+        auto elapsed = duration_cast<microseconds>(high_resolution_clock::now() - startTime);
+        if (elapsed >= _frameBudget) {
+            break;
+        }
+
+        switch (_state) {
+            case State::Idle:
+                if (_enabled && ShouldBegin()) {
+                    progress = BeginCycle();
+                }
+                break;
+
+            case State::Active: {
+                double remaining = static_cast<double>((_frameBudget - elapsed).count());
+                uint32_t maxMoves = static_cast<uint32_t>(remaining / _microsecondsPerMove);
+                maxMoves = std::clamp<uint32_t>(maxMoves, 1, _maxMovesPerFrame);
+
+                // Once the copies are submitted, there is nothing left to do until they finish
+                BeginPass(maxMoves);
+                break;
+            }
+
+            case State::Copying:
+                if (vkGetFenceStatus(_gfx->GetDevice(), _vkFence) == VK_SUCCESS) {
+                    SwapBuffers();
+                    progress = true;
+                }
+                break;
+
+            case State::Retiring:
+                if (_frameIndex - _stateFrameIndex >= _gfx->GetBackbufferCount()) {
+                    EndPass();
+                    progress = true;
+                }
+                break;
+        }
+    }
+}
+
+NOON_API
+void Defragmenter::Flush()
+{
+    std::lock_guard lock(_mutex);
+
+    while (_state != State::Idle) {
+        switch (_state) {
+            case State::Idle:
+                break;
+
+            case State::Active:
+                BeginPass(_maxMovesPerFrame);
+                break;
+
+            case State::Copying:
+                vkWaitForFences(_gfx->GetDevice(), 1, &_vkFence, VK_TRUE, UINT64_MAX);
+                SwapBuffers();
+                break;
+
+            case State::Retiring:
+                vkDeviceWaitIdle(_gfx->GetDevice());
+                EndPass();
+                break;
+        }
+    }
+}
+
+NOON_API
+void Defragmenter::RegisterBuffer(Buffer * buffer)
+{
+    std::lock_guard lock(_mutex);
+
+    _bufferMap[buffer->_vmaAllocation] = buffer;
+}
+
+NOON_API
+bool Defragmenter::UnregisterBuffer(Buffer * buffer)
+{
+    std::lock_guard lock(_mutex);
+
+    _bufferMap.erase(buffer->_vmaAllocation);
+
+    if (!_cycleAllocationSet.contains(buffer->_vmaAllocation)) {
+        return true;
+    }
+
+    for (auto& move : _moveList) {
+        if (move.Owner == buffer) {
+            move.Owner = nullptr;
+        }
+    }
+
+    _orphanList.push_back({
+        .Category = buffer->_memoryCategory,
+        .Buffer = buffer->_vkBuffer,
+        .Allocation = buffer->_vmaAllocation,
+    });
+
+    return false;
+}
+
+bool Defragmenter::ShouldBegin()
+{
+    if (_requested.exchange(false)) {
+        return !_bufferMap.empty();
+    }
+
+    if (_frameIndex - _stateFrameIndex < _cooldownFrameCount) {
+        return false;
+    }
+
+    _stateFrameIndex = _frameIndex;
+
+    if (_bufferMap.empty()) {
+        return false;
+    }
+
+    VmaStats stats;
+    vmaCalculateStats(_gfx->GetAllocator(), &stats);
+
+    const VkPhysicalDeviceMemoryProperties * memoryProperties = nullptr;
+    vmaGetMemoryProperties(_gfx->GetAllocator(), &memoryProperties);
+
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; ++i) {
+        if ((memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) == 0) {
+            continue;
+        }
+
+        const auto& heap = stats.memoryHeap[i];
+
+        // Compacting a single block can't free anything
+        if (heap.blockCount < 2) {
+            continue;
+        }
+
+        VkDeviceSize totalBytes = heap.usedBytes + heap.unusedBytes;
+        if (heap.unusedBytes > totalBytes * _fragmentationThreshold) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Defragmenter::BeginCycle()
+{
+    VkResult vkResult;
+
+    List<VmaAllocation> allocationList;
+    allocationList.reserve(_bufferMap.size());
+
+    for (const auto& [allocation, buffer] : _bufferMap) {
+        allocationList.push_back(allocation);
+    }
+
+    // Only GPU moves are allowed, as device-local memory generally can't be mapped
+    VmaDefragmentationInfo2 defragmentationInfo = {
+        .flags = VMA_DEFRAGMENTATION_FLAG_INCREMENTAL,
+        .allocationCount = static_cast<uint32_t>(allocationList.size()),
+        .pAllocations = allocationList.data(),
+        .pAllocationsChanged = nullptr,
+        .poolCount = 0,
+        .pPools = nullptr,
+        .maxCpuBytesToMove = 0,
+        .maxCpuAllocationsToMove = 0,
+        .maxGpuBytesToMove = _maxBytesPerCycle,
+        .maxGpuAllocationsToMove = UINT32_MAX,
+        .commandBuffer = VK_NULL_HANDLE,
+    };
+
+    // VMA keeps a pointer to the stats, and fills them in as the cycle progresses
+    _vmaDefragmentationStats = { };
+
+    vkResult = vmaDefragmentationBegin(
+        _gfx->GetAllocator(),
+        &defragmentationInfo,
+        &_vmaDefragmentationStats,
+        &_vmaDefragmentationContext);
+
+    if (vkResult < VK_SUCCESS) {
+        Log(NOON_ANCHOR, "vmaDefragmentationBegin() failed, {}", VkResultToString(vkResult));
+        _vmaDefragmentationContext = VK_NULL_HANDLE;
+        return false;
+    }
+
+    if (!_vmaDefragmentationContext) {
+        return false;
+    }
+
+    _cycleAllocationSet.insert(allocationList.begin(), allocationList.end());
+    _state = State::Active;
+    return true;
+}
+
+void Defragmenter::EndCycle()
+{
+    vmaDefragmentationEnd(_gfx->GetAllocator(), _vmaDefragmentationContext);
+    _vmaDefragmentationContext = VK_NULL_HANDLE;
+
+    _lastStats = {
+        .BytesMoved = _vmaDefragmentationStats.bytesMoved,
+        .BytesFreed = _vmaDefragmentationStats.bytesFreed,
+        .AllocationsMoved = _vmaDefragmentationStats.allocationsMoved,
+        .BlocksFreed = _vmaDefragmentationStats.deviceMemoryBlocksFreed,
+    };
+
+    _totalStats.BytesMoved += _lastStats.BytesMoved;
+    _totalStats.BytesFreed += _lastStats.BytesFreed;
+    _totalStats.AllocationsMoved += _lastStats.AllocationsMoved;
+    _totalStats.BlocksFreed += _lastStats.BlocksFreed;
+
+    constexpr double MB = 1024.0 * 1024.0;
+
+    Log(NOON_ANCHOR, "Defragmentation moved {:.1f} MB in {} allocations, and freed {:.1f} MB in {} blocks",
+        _lastStats.BytesMoved / MB,
+        _lastStats.AllocationsMoved,
+        _lastStats.BytesFreed / MB,
+        _lastStats.BlocksFreed);
+
+    // Buffers destroyed during the cycle can be freed now
+    for (const auto& orphan : _orphanList) {
+        _gfx->DestroyBuffer(orphan.Category, orphan.Buffer, orphan.Allocation);
+    }
+
+    _orphanList.clear();
+    _cycleAllocationSet.clear();
+
+    _state = State::Idle;
+    _stateFrameIndex = _frameIndex;
+}
+
+void Defragmenter::BeginPass(uint32_t maxMoves)
+{
+    VkResult vkResult;
+
+    auto startTime = high_resolution_clock::now();
+
+    List<VmaDefragmentationPassMoveInfo> vmaMoveList(maxMoves);
+
+    VmaDefragmentationPassInfo passInfo = {
+        .moveCount = maxMoves,
+        .pMoves = vmaMoveList.data(),
+    };
+
+    vkResult = vmaBeginDefragmentationPass(
+        _gfx->GetAllocator(),
+        _vmaDefragmentationContext,
+        &passInfo);
+
+    if (vkResult < VK_SUCCESS) {
+        throw Exception("vmaBeginDefragmentationPass() failed");
+    }
+
+    if (passInfo.moveCount == 0) {
+        // Either every move has been made, or VMA was unable to plan the rest
+        if (!EndPass()) {
+            Log(NOON_ANCHOR, "Defragmentation stopped with moves remaining");
+            EndCycle();
+        }
+
+        return;
+    }
+
+    vkResult = vkResetCommandBuffer(_vkCommandBuffer, 0);
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkResetCommandBuffer() failed");
+    }
+
+    VkCommandBufferBeginInfo commandBufferBeginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = nullptr,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+
+    vkResult = vkBeginCommandBuffer(_vkCommandBuffer, &commandBufferBeginInfo);
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkBeginCommandBuffer() failed");
+    }
+
+    const auto& queueFamilyIndexList = _gfx->GetSharedQueueFamilyIndexList();
+
+    for (uint32_t i = 0; i < passInfo.moveCount; ++i) {
+        const auto& vmaMove = vmaMoveList[i];
+
+        // Buffers destroyed during the cycle have nothing worth copying
+        auto it = _bufferMap.find(vmaMove.allocation);
+        if (it == _bufferMap.end()) {
+            continue;
+        }
+
+        Buffer * buffer = it->second;
+
+        VkBufferCreateInfo bufferCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .size = buffer->_size,
+            .usage = buffer->_vkBufferUsageFlags,
+            .sharingMode = (queueFamilyIndexList.size() > 1
+                ? VK_SHARING_MODE_CONCURRENT
+                : VK_SHARING_MODE_EXCLUSIVE),
+            .queueFamilyIndexCount = static_cast<uint32_t>(queueFamilyIndexList.size()),
+            .pQueueFamilyIndices = queueFamilyIndexList.data(),
+        };
+
+        VkBuffer newBuffer = VK_NULL_HANDLE;
+
+        vkResult = vkCreateBuffer(
+            _gfx->GetDevice(),
+            &bufferCreateInfo,
+            nullptr,
+            &newBuffer);
+
+        if (vkResult != VK_SUCCESS) {
+            throw Exception("vkCreateBuffer() failed");
+        }
+
+        vkResult = vkBindBufferMemory(
+            _gfx->GetDevice(),
+            newBuffer,
+            vmaMove.memory,
+            vmaMove.offset);
+
+        if (vkResult != VK_SUCCESS) {
+            throw Exception("vkBindBufferMemory() failed");
+        }
+
+        VkBufferCopy bufferCopyRegion = {
+            .srcOffset = 0,
+            .dstOffset = 0,
+            .size = buffer->_size,
+        };
+
+        vkCmdCopyBuffer(
+            _vkCommandBuffer,
+            buffer->_vkBuffer,
+            newBuffer,
+            1,
+            &bufferCopyRegion);
+
+        _moveList.push_back({
+            .Owner = buffer,
+            .OldBuffer = buffer->_vkBuffer,
+            .NewBuffer = newBuffer,
+        });
+    }
+
+    // Make the copies available to the graphics queue, which starts using them after the
+    // fence has been observed
+    VkMemoryBarrier memoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT,
+    };
+
+    vkCmdPipelineBarrier(
+        _vkCommandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0,
+        1, &memoryBarrier,
+        0, nullptr,
+        0, nullptr);
+
+    vkResult = vkEndCommandBuffer(_vkCommandBuffer);
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkEndCommandBuffer() failed");
+    }
+
+    VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &_vkCommandBuffer,
+    };
+
+    vkResetFences(_gfx->GetDevice(), 1, &_vkFence);
+
+    // Render() no longer holds the queue for the whole frame, and uploads can be submitting
+    // from other threads
+    _gfx->SubmitTransfer(submitInfo, _vkFence);
+
+    auto elapsed = duration_cast<microseconds>(high_resolution_clock::now() - startTime);
+    double microsecondsPerMove = static_cast<double>(elapsed.count()) / passInfo.moveCount;
+    _microsecondsPerMove = (_microsecondsPerMove * 0.9) + (microsecondsPerMove * 0.1);
+
+    _state = State::Copying;
+}
+
+bool Defragmenter::EndPass()
+{
+    VkResult vkResult;
+
+    vkResult = vmaEndDefragmentationPass(
+        _gfx->GetAllocator(),
+        _vmaDefragmentationContext);
+
+    for (const auto& move : _moveList) {
+        vkDestroyBuffer(_gfx->GetDevice(), move.OldBuffer, nullptr);
+    }
+
+    _moveList.clear();
+
+    if (vkResult == VK_SUCCESS) {
+        EndCycle();
+        return true;
+    }
+
+    _state = State::Active;
+    return false;
+}
+
+void Defragmenter::SwapBuffers()
+{
+    for (auto& move : _moveList) {
+        if (move.Owner) {
+            move.Owner->_vkBuffer = move.NewBuffer;
+
+            for (const auto& [id, callback] : _bufferRelocationCallbackList) {
+                callback(move.Owner, move.OldBuffer);
+            }
+        }
+        else {
+            // The buffer was destroyed during the copy, and its orphan still holds the old
+            // VkBuffer, so the new one is retired instead
+            std::swap(move.OldBuffer, move.NewBuffer);
+        }
+    }
+
+    _state = State::Retiring;
+    _stateFrameIndex = _frameIndex;
+}
+
+} // namespace noon
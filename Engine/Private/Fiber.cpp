@@ -0,0 +1,285 @@
+#include <Noon/Fiber.hpp>
+#include <Noon/Exception.hpp>
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    #include <Windows.h>
+
+#else
+
+    #include <sys/mman.h>
+    #include <unistd.h>
+
+    #include <cerrno>
+    #include <cstdint>
+    #include <cstring>
+
+#endif
+
+#if defined(NOON_PLATFORM_LINUX)
+
+// Saves the callee-saved registers on the current stack, stores the stack pointer in *from,
+// then loads to as the stack pointer and restores the registers saved there. The first switch
+// to a new fiber "returns" into NoonFiberEntry, with the function and data in callee-saved
+// registers.
+extern "C" void NoonSwitchFiber(void ** from, void * to);
+
+extern "C" void NoonFiberEntry();
+
+#if defined(NOON_ARCH_X64)
+
+// System V ABI: rbx, rbp and r12-r15, as well as the MXCSR and x87 control words
+__asm__(
+    ".text\n"
+    ".globl NoonSwitchFiber\n"
+    ".hidden NoonSwitchFiber\n"
+    ".type NoonSwitchFiber, @function\n"
+    "NoonSwitchFiber:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size NoonSwitchFiber, .-NoonSwitchFiber\n"
+    "\n"
+    ".globl NoonFiberEntry\n"
+    ".hidden NoonFiberEntry\n"
+    ".type NoonFiberEntry, @function\n"
+    "NoonFiberEntry:\n"
+    "    movq %r13, %rdi\n"
+    "    callq *%r12\n"
+    "    ud2\n"
+    ".size NoonFiberEntry, .-NoonFiberEntry\n"
+);
+
+// The layout NoonSwitchFiber expects to find on a stack it switches to
+struct FiberFrame
+{
+    uint32_t MXCSR;
+
+    uint16_t FPUControl;
+
+    uint16_t Padding;
+
+    uint64_t R15;
+
+    uint64_t R14;
+
+    // Data
+    uint64_t R13;
+
+    // Function
+    uint64_t R12;
+
+    uint64_t RBX;
+
+    uint64_t RBP;
+
+    uint64_t ReturnAddress;
+
+    // Keeps the stack 16-byte aligned at the call in NoonFiberEntry
+    uint64_t Alignment[2];
+
+}; // struct FiberFrame
+
+static_assert(sizeof(FiberFrame) == 80);
+
+static void InitFiberFrame(FiberFrame * frame, void (*function)(void *), void * data)
+{
+    *frame = FiberFrame{
+        // Defaults, all exceptions masked and round to nearest
+        .MXCSR = 0x1F80,
+        .FPUControl = 0x037F,
+        .R13 = reinterpret_cast<uint64_t>(data),
+        .R12 = reinterpret_cast<uint64_t>(function),
+        .ReturnAddress = reinterpret_cast<uint64_t>(&NoonFiberEntry),
+    };
+}
+
+#elif defined(NOON_ARCH_ARM64)
+
+// AAPCS64: x19-x28, the frame pointer and link register, and the low halves of v8-v15
+__asm__(
+    ".text\n"
+    ".globl NoonSwitchFiber\n"
+    ".hidden NoonSwitchFiber\n"
+    ".type NoonSwitchFiber, %function\n"
+    "NoonSwitchFiber:\n"
+    "    sub sp, sp, #160\n"
+    "    stp x19, x20, [sp, #0]\n"
+    "    stp x21, x22, [sp, #16]\n"
+    "    stp x23, x24, [sp, #32]\n"
+    "    stp x25, x26, [sp, #48]\n"
+    "    stp x27, x28, [sp, #64]\n"
+    "    stp x29, x30, [sp, #80]\n"
+    "    stp d8, d9, [sp, #96]\n"
+    "    stp d10, d11, [sp, #112]\n"
+    "    stp d12, d13, [sp, #128]\n"
+    "    stp d14, d15, [sp, #144]\n"
+    "    mov x9, sp\n"
+    "    str x9, [x0]\n"
+    "    mov sp, x1\n"
+    "    ldp x19, x20, [sp, #0]\n"
+    "    ldp x21, x22, [sp, #16]\n"
+    "    ldp x23, x24, [sp, #32]\n"
+    "    ldp x25, x26, [sp, #48]\n"
+    "    ldp x27, x28, [sp, #64]\n"
+    "    ldp x29, x30, [sp, #80]\n"
+    "    ldp d8, d9, [sp, #96]\n"
+    "    ldp d10, d11, [sp, #112]\n"
+    "    ldp d12, d13, [sp, #128]\n"
+    "    ldp d14, d15, [sp, #144]\n"
+    "    add sp, sp, #160\n"
+    "    ret\n"
+    ".size NoonSwitchFiber, .-NoonSwitchFiber\n"
+    "\n"
+    ".globl NoonFiberEntry\n"
+    ".hidden NoonFiberEntry\n"
+    ".type NoonFiberEntry, %function\n"
+    "NoonFiberEntry:\n"
+    "    mov x0, x20\n"
+    "    blr x19\n"
+    "    brk #0\n"
+    ".size NoonFiberEntry, .-NoonFiberEntry\n"
+);
+
+// The layout NoonSwitchFiber expects to find on a stack it switches to
+struct FiberFrame
+{
+    // Function
+    uint64_t X19;
+
+    // Data
+    uint64_t X20;
+
+    uint64_t X21ToX28[8];
+
+    uint64_t X29;
+
+    uint64_t X30;
+
+    uint64_t D8ToD15[8];
+
+}; // struct FiberFrame
+
+static_assert(sizeof(FiberFrame) == 160);
+
+static void InitFiberFrame(FiberFrame * frame, void (*function)(void *), void * data)
+{
+    *frame = FiberFrame{
+        .X19 = reinterpret_cast<uint64_t>(function),
+        .X20 = reinterpret_cast<uint64_t>(data),
+        .X30 = reinterpret_cast<uint64_t>(&NoonFiberEntry),
+    };
+}
+
+#else
+
+    #error Fibers are not implemented for this architecture
+
+#endif
+
+#endif // defined(NOON_PLATFORM_LINUX)
+
+namespace noon {
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+Fiber::Fiber()
+    : _isThread(true)
+{
+    _handle = ConvertThreadToFiber(nullptr);
+    if (!_handle) {
+        throw Exception("ConvertThreadToFiber() failed, {}", GetLastError());
+    }
+}
+
+Fiber::Fiber(Function function, void * data, size_t stackSize)
+    : _function(function)
+    , _data(data)
+{
+    _handle = CreateFiber(stackSize, &Fiber::Entry, this);
+    if (!_handle) {
+        throw Exception("CreateFiber() failed, {}", GetLastError());
+    }
+}
+
+Fiber::~Fiber()
+{
+    if (_isThread) {
+        ConvertFiberToThread();
+    }
+    else {
+        DeleteFiber(_handle);
+    }
+}
+
+void Fiber::SwitchTo(Fiber& target)
+{
+    SwitchToFiber(target._handle);
+}
+
+void __stdcall Fiber::Entry(void * data)
+{
+    Fiber * fiber = static_cast<Fiber *>(data);
+    fiber->_function(fiber->_data);
+}
+
+#else
+
+Fiber::Fiber()
+{
+}
+
+Fiber::Fiber(Function function, void * data, size_t stackSize)
+{
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    _stackSize = ((stackSize + pageSize - 1) & ~(pageSize - 1)) + pageSize;
+    _stack = mmap(nullptr, _stackSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (_stack == MAP_FAILED) {
+        _stack = nullptr;
+        throw Exception("Failed to allocate a fiber stack of {} bytes, {}", _stackSize, strerror(errno));
+    }
+
+    // The stack grows down, towards the guard page
+    mprotect(_stack, pageSize, PROT_NONE);
+
+    uintptr_t top = (reinterpret_cast<uintptr_t>(_stack) + _stackSize) & ~uintptr_t(15);
+    FiberFrame * frame = reinterpret_cast<FiberFrame *>(top - sizeof(FiberFrame));
+    InitFiberFrame(frame, function, data);
+
+    _stackPointer = frame;
+}
+
+Fiber::~Fiber()
+{
+    if (_stack) {
+        munmap(_stack, _stackSize);
+    }
+}
+
+void Fiber::SwitchTo(Fiber& target)
+{
+    NoonSwitchFiber(&_stackPointer, target._stackPointer);
+}
+
+#endif
+
+} // namespace noon
@@ -0,0 +1,375 @@
+#include <Noon/FileSystem.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/Hash.hpp>
+#include <Noon/Log.hpp>
+#include <Noon/MappedFile.hpp>
+
+#include <cstdio>
+#include <mutex>
+
+namespace noon {
+
+FileSystem * FileSystem::_Instance = nullptr;
+
+static FileData ReadFileToBuffer(const Path& path)
+{
+    FILE * file = fopen(path.ToCString(), "rb");
+    if (!file) {
+        return {};
+    }
+
+    List<uint8_t> buffer;
+
+    bool isValid = (fseek(file, 0, SEEK_END) == 0);
+    if (isValid) {
+        long size = ftell(file);
+        isValid = (size >= 0 && fseek(file, 0, SEEK_SET) == 0);
+
+        if (isValid) {
+            buffer.resize(static_cast<size_t>(size));
+            isValid = (buffer.empty() || fread(buffer.data(), 1, buffer.size(), file) == buffer.size());
+        }
+    }
+
+    fclose(file);
+
+    if (!isValid) {
+        Log(NOON_ANCHOR, "Failed to read '{}'", path);
+        return {};
+    }
+
+    return FileData::FromBuffer(std::move(buffer));
+}
+
+NOON_API
+FileData FileData::FromBuffer(List<uint8_t> buffer)
+{
+    auto owner = std::make_shared<const List<uint8_t>>(std::move(buffer));
+
+    FileData fileData;
+    fileData._data = Span<const uint8_t>(owner->data(), owner->size());
+    fileData._owner = std::move(owner);
+    return fileData;
+}
+
+NOON_API
+FileData FileData::FromView(Span<const uint8_t> data, std::shared_ptr<const void> owner, bool isMapped)
+{
+    FileData fileData;
+    fileData._data = data;
+    fileData._owner = std::move(owner);
+    fileData._isMapped = isMapped;
+    return fileData;
+}
+
+NOON_API
+DirectoryFileSource::DirectoryFileSource(const Path& directory)
+    : _directory(directory)
+{ }
+
+NOON_API
+bool DirectoryFileSource::Exists(StringView path) const
+{
+    return IsFile(_directory / Path(String(path)));
+}
+
+NOON_API
+FileData DirectoryFileSource::Read(StringView path, FileReadMode mode) const
+{
+    Path fullPath = _directory / Path(String(path));
+
+    if (mode == FileReadMode::PreferMapped) {
+        auto file = std::make_shared<MappedFile>();
+
+        // Empty files can't be mapped, and are read like any other file that fails to map
+        if (file->Open(fullPath)) {
+            Span<const uint8_t> data(file->GetData(), file->GetSize());
+            return FileData::FromView(data, std::move(file), true);
+        }
+    }
+
+    return ReadFileToBuffer(fullPath);
+}
+
+NOON_API
+PackFileSource::PackFileSource(const Path& path)
+    : _pack(std::make_shared<AssetPack>())
+{
+    if (!_pack->Open(path)) {
+        throw Exception("Failed to open asset pack '{}'", path);
+    }
+}
+
+NOON_API
+bool PackFileSource::Exists(StringView path) const
+{
+    Span<const uint8_t> data;
+    return _pack->Find(path, data);
+}
+
+NOON_API
+FileData PackFileSource::Read(StringView path, FileReadMode mode) const
+{
+    Span<const uint8_t> data;
+    if (!_pack->Find(path, data)) {
+        return {};
+    }
+
+    if (mode == FileReadMode::Buffer) {
+        return FileData::FromBuffer(List<uint8_t>(data.begin(), data.end()));
+    }
+
+    // Views keep the whole pack mapped, even once it is unmounted
+    return FileData::FromView(data, _pack, true);
+}
+
+NOON_API
+void MemoryFileSource::Add(StringView path, List<uint8_t> data)
+{
+    String normalizedPath = FileSystem::NormalizePath(path);
+    if (normalizedPath.empty()) {
+        throw Exception("Invalid path '{}'", path);
+    }
+
+    _fileMap[normalizedPath] = std::make_shared<const List<uint8_t>>(std::move(data));
+}
+
+NOON_API
+bool MemoryFileSource::Exists(StringView path) const
+{
+    return _fileMap.contains(String(path));
+}
+
+NOON_API
+FileData MemoryFileSource::Read(StringView path, FileReadMode mode) const
+{
+    auto it = _fileMap.find(String(path));
+    if (it == _fileMap.end()) {
+        return {};
+    }
+
+    const auto& buffer = it->second;
+    return FileData::FromView(Span<const uint8_t>(buffer->data(), buffer->size()), buffer, false);
+}
+
+NOON_API
+FileSystem::FileSystem()
+{
+    if (_Instance) {
+        throw Exception("Only one FileSystem can exist at a time");
+    }
+
+    _Instance = this;
+}
+
+NOON_API
+FileSystem::~FileSystem()
+{
+    _Instance = nullptr;
+}
+
+NOON_API
+MountID FileSystem::Mount(std::unique_ptr<FileSource> source, StringView mountPoint, int priority)
+{
+    String normalizedMountPoint = NormalizePath(mountPoint);
+    if (normalizedMountPoint.empty() && !mountPoint.empty() && mountPoint != "/") {
+        throw Exception("Invalid mount point '{}'", mountPoint);
+    }
+
+    if (!normalizedMountPoint.empty()) {
+        normalizedMountPoint += '/';
+    }
+
+    std::unique_lock lock(_mutex);
+
+    MountID id = _nextMountID++;
+
+    // Before every mount of the same or lower priority, so the newest wins a tie
+    auto it = _mountList.begin();
+    while (it != _mountList.end() && it->Priority > priority) {
+        ++it;
+    }
+
+    _mountList.insert(it, MountEntry{
+        .ID = id,
+        .MountPoint = std::move(normalizedMountPoint),
+        .Priority = priority,
+        .Source = std::move(source),
+    });
+
+    InvalidateCache();
+
+    return id;
+}
+
+NOON_API
+MountID FileSystem::MountDirectory(const Path& directory, StringView mountPoint, int priority)
+{
+    Log(NOON_ANCHOR, "Mounting '{}' at '/{}'", directory, mountPoint);
+
+    return Mount(std::make_unique<DirectoryFileSource>(directory), mountPoint, priority);
+}
+
+NOON_API
+MountID FileSystem::MountPack(const Path& path, StringView mountPoint, int priority)
+{
+    Log(NOON_ANCHOR, "Mounting '{}' at '/{}'", path, mountPoint);
+
+    return Mount(std::make_unique<PackFileSource>(path), mountPoint, priority);
+}
+
+NOON_API
+void FileSystem::Unmount(MountID id)
+{
+    std::unique_lock lock(_mutex);
+
+    std::erase_if(_mountList,
+        [id](const MountEntry& entry) {
+            return (entry.ID == id);
+        }
+    );
+
+    InvalidateCache();
+}
+
+NOON_API
+bool FileSystem::Exists(StringView path) const
+{
+    String normalizedPath = NormalizePath(path);
+    if (normalizedPath.empty()) {
+        return false;
+    }
+
+    std::shared_lock lock(_mutex);
+
+    return (Find(normalizedPath) != NotFound);
+}
+
+NOON_API
+FileData FileSystem::Read(StringView path, FileReadMode mode) const
+{
+    String normalizedPath = NormalizePath(path);
+    if (normalizedPath.empty()) {
+        return {};
+    }
+
+    std::shared_ptr<FileSource> source;
+    StringView sourcePath;
+
+    {
+        std::shared_lock lock(_mutex);
+
+        size_t index = Find(normalizedPath);
+        if (index == NotFound) {
+            return {};
+        }
+
+        const auto& entry = _mountList[index];
+        source = entry.Source;
+        sourcePath = StringView(normalizedPath).substr(entry.MountPoint.size());
+    }
+
+    // Read outside the lock, so a slow read doesn't hold up mounting
+    return source->Read(sourcePath, mode);
+}
+
+NOON_API
+void FileSystem::ReadAsync(StringView path, FileData& result, JobCounter& counter, FileReadMode mode) const
+{
+    JobSystem * jobSystem = JobSystem::GetInstance();
+    if (!jobSystem) {
+        result = Read(path, mode);
+        return;
+    }
+
+    jobSystem->Schedule(
+        [this, path = String(path), &result, mode]() {
+            // Jobs can't throw, a failed read is an invalid result like any other
+            try {
+                result = Read(path, mode);
+            }
+            catch (std::exception& e) {
+                Log(NOON_ANCHOR, "Failed to read '{}', {}", path, e.what());
+                result = {};
+            }
+        },
+        &counter);
+}
+
+NOON_API
+void FileSystem::InvalidateCache()
+{
+    std::unique_lock lock(_cacheMutex);
+    _lookupCache.clear();
+}
+
+NOON_API
+String FileSystem::NormalizePath(StringView path)
+{
+    List<StringView> elementList;
+
+    while (!path.empty()) {
+        size_t pivot = path.find_first_of("/\\");
+        StringView element = path.substr(0, pivot);
+
+        if (element == "..") {
+            if (elementList.empty()) {
+                return String();
+            }
+
+            elementList.pop_back();
+        }
+        else if (!element.empty() && element != ".") {
+            elementList.push_back(element);
+        }
+
+        if (pivot == StringView::npos) {
+            break;
+        }
+
+        path.remove_prefix(pivot + 1);
+    }
+
+    String normalizedPath;
+    for (const auto& element : elementList) {
+        if (!normalizedPath.empty()) {
+            normalizedPath += '/';
+        }
+        normalizedPath += element;
+    }
+
+    return normalizedPath;
+}
+
+size_t FileSystem::Find(StringView path) const
+{
+    // Paths are keyed by hash alone, a collision between two 64-bit hashes of paths within
+    // one game isn't a practical concern
+    uint64_t hash = HashFNV1a(path);
+
+    {
+        std::shared_lock lock(_cacheMutex);
+
+        auto it = _lookupCache.find(hash);
+        if (it != _lookupCache.end()) {
+            return it->second;
+        }
+    }
+
+    size_t index = NotFound;
+
+    for (size_t i = 0; i < _mountList.size(); ++i) {
+        const auto& entry = _mountList[i];
+        if (path.starts_with(entry.MountPoint) && entry.Source->Exists(path.substr(entry.MountPoint.size()))) {
+            index = i;
+            break;
+        }
+    }
+
+    std::unique_lock lock(_cacheMutex);
+    _lookupCache[hash] = index;
+
+    return index;
+}
+
+} // namespace noon
@@ -0,0 +1,993 @@
+#include <Noon/GLTFModel.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/JobSystem.hpp>
+#include <Noon/Log.hpp>
+#include <Noon/MeshOptimizer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <limits>
+
+namespace noon {
+
+static const uint32_t GLBMagic = 0x46546C67; // "glTF"
+
+static const uint32_t GLBChunkJSON = 0x4E4F534A; // "JSON"
+
+static const uint32_t GLBChunkBinary = 0x004E4942; // "BIN\0"
+
+// Values of accessor.componentType
+static const uint32_t ComponentByte = 5120;
+static const uint32_t ComponentUnsignedByte = 5121;
+static const uint32_t ComponentShort = 5122;
+static const uint32_t ComponentUnsignedShort = 5123;
+static const uint32_t ComponentUnsignedInt = 5125;
+static const uint32_t ComponentFloat = 5126;
+
+// Values of primitive.mode
+static const int64_t ModeTriangles = 4;
+static const int64_t ModeTriangleStrip = 5;
+static const int64_t ModeTriangleFan = 6;
+
+static size_t GetComponentSize(uint32_t componentType)
+{
+    switch (componentType) {
+    case ComponentByte:
+    case ComponentUnsignedByte:
+        return 1;
+    case ComponentShort:
+    case ComponentUnsignedShort:
+        return 2;
+    case ComponentUnsignedInt:
+    case ComponentFloat:
+        return 4;
+    }
+
+    throw Exception("Invalid accessor component type {}", componentType);
+}
+
+static uint32_t GetComponentCount(StringView type)
+{
+    if (type == "SCALAR") {
+        return 1;
+    }
+    else if (type == "VEC2") {
+        return 2;
+    }
+    else if (type == "VEC3") {
+        return 3;
+    }
+    else if (type == "VEC4" || type == "MAT2") {
+        return 4;
+    }
+    else if (type == "MAT3") {
+        return 9;
+    }
+    else if (type == "MAT4") {
+        return 16;
+    }
+
+    throw Exception("Invalid accessor type '{}'", type);
+}
+
+// Normalized integers as defined by the glTF specification, signed values are clamped so both
+// -128 and -127 map to -1
+template <class T>
+static inline float NormalizeComponent(T value)
+{
+    float normalized = static_cast<float>(value) / static_cast<float>(std::numeric_limits<T>::max());
+    return (std::is_signed_v<T> ? std::max(normalized, -1.0f) : normalized);
+}
+
+template <class T>
+static void ConvertToFloat(const uint8_t * src, size_t stride, size_t count, size_t components, bool normalized, float * out, size_t outComponents)
+{
+    // Tightly packed floats are the common case, and need no conversion at all
+    if constexpr (std::is_same_v<T, float>) {
+        if (stride == sizeof(float) * components && components == outComponents) {
+            memcpy(out, src, count * stride);
+            return;
+        }
+    }
+
+    size_t copyComponents = std::min(components, outComponents);
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t * element = src + (i * stride);
+        float * dst = out + (i * outComponents);
+
+        for (size_t c = 0; c < copyComponents; ++c) {
+            T value;
+            memcpy(&value, element + (c * sizeof(T)), sizeof(T));
+
+            if constexpr (std::is_integral_v<T>) {
+                dst[c] = (normalized ? NormalizeComponent(value) : static_cast<float>(value));
+            }
+            else {
+                dst[c] = value;
+            }
+        }
+    }
+}
+
+template <class T>
+static void ConvertToUint(const uint8_t * src, size_t stride, size_t count, size_t components, uint32_t * out, size_t outComponents)
+{
+    if constexpr (std::is_same_v<T, uint32_t>) {
+        if (stride == sizeof(uint32_t) * components && components == outComponents) {
+            memcpy(out, src, count * stride);
+            return;
+        }
+    }
+
+    size_t copyComponents = std::min(components, outComponents);
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t * element = src + (i * stride);
+        uint32_t * dst = out + (i * outComponents);
+
+        for (size_t c = 0; c < copyComponents; ++c) {
+            T value;
+            memcpy(&value, element + (c * sizeof(T)), sizeof(T));
+            dst[c] = static_cast<uint32_t>(value);
+        }
+    }
+}
+
+static int DecodeBase64Character(char c)
+{
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    else if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 26;
+    }
+    else if (c >= '0' && c <= '9') {
+        return c - '0' + 52;
+    }
+    else if (c == '+') {
+        return 62;
+    }
+    else if (c == '/') {
+        return 63;
+    }
+
+    return -1;
+}
+
+// Anything that isn't part of the alphabet is skipped, such as padding, or the backslash of a
+// '\/' escape left in the raw JSON string
+static size_t GetBase64DecodedSize(StringView base64)
+{
+    size_t count = std::count_if(base64.begin(), base64.end(), [](char c) {
+        return (DecodeBase64Character(c) >= 0);
+    });
+
+    return (count * 3) / 4;
+}
+
+static void DecodeBase64(StringView base64, uint8_t * out, size_t size)
+{
+    uint32_t bits = 0;
+    int bitCount = 0;
+    size_t written = 0;
+
+    for (char c : base64) {
+        int value = DecodeBase64Character(c);
+        if (value < 0) {
+            continue;
+        }
+
+        bits = (bits << 6) | static_cast<uint32_t>(value);
+        bitCount += 6;
+
+        if (bitCount >= 8) {
+            bitCount -= 8;
+            if (written < size) {
+                out[written++] = static_cast<uint8_t>(bits >> bitCount);
+            }
+        }
+    }
+}
+
+static String DecodePercentEncoding(StringView uri)
+{
+    String decoded;
+    decoded.reserve(uri.size());
+
+    for (size_t i = 0; i < uri.size(); ++i) {
+        if (uri[i] == '%' && i + 2 < uri.size()) {
+            char hex[3] = { uri[i + 1], uri[i + 2], '\0' };
+            decoded += static_cast<char>(strtol(hex, nullptr, 16));
+            i += 2;
+        }
+        else {
+            decoded += uri[i];
+        }
+    }
+
+    return decoded;
+}
+
+static String GetMimeTypeFromURI(StringView uri)
+{
+    Path extension = Path(String(uri)).GetExtension();
+
+    if (StringEqualCaseInsensitive(extension.ToString(), "png")) {
+        return "image/png";
+    }
+    else if (StringEqualCaseInsensitive(extension.ToString(), "jpg") || StringEqualCaseInsensitive(extension.ToString(), "jpeg")) {
+        return "image/jpeg";
+    }
+    else if (StringEqualCaseInsensitive(extension.ToString(), "ktx2")) {
+        return "image/ktx2";
+    }
+
+    return String();
+}
+
+static int GetIndex(const JsonValue& value)
+{
+    return static_cast<int>(value.GetInt(-1));
+}
+
+NOON_API
+bool GLTFModel::Load(const Path& path, bool optimizeMeshes)
+{
+    using namespace std::chrono;
+
+    Close();
+
+    _path = path;
+
+    auto startTime = high_resolution_clock::now();
+
+    if (!_file.Open(path)) {
+        Log(NOON_ANCHOR, "Failed to open glTF model '{}'", path);
+        return false;
+    }
+
+    try {
+        const uint8_t * data = _file.GetData();
+        size_t size = _file.GetSize();
+
+        StringView jsonText;
+        Span<const uint8_t> binaryChunk;
+
+        uint32_t magic = 0;
+        if (size >= sizeof(magic)) {
+            memcpy(&magic, data, sizeof(magic));
+        }
+
+        if (magic == GLBMagic) {
+            // The header is followed by the JSON chunk, and optionally the binary chunk
+            uint32_t header[3];
+            if (size < sizeof(header)) {
+                throw Exception("Truncated GLB header");
+            }
+            memcpy(header, data, sizeof(header));
+
+            if (header[1] != 2) {
+                throw Exception("Unsupported GLB version {}", header[1]);
+            }
+
+            size = std::min<size_t>(size, header[2]);
+
+            size_t offset = sizeof(header);
+            while (offset + 8 <= size) {
+                uint32_t chunk[2];
+                memcpy(chunk, data + offset, sizeof(chunk));
+                offset += sizeof(chunk);
+
+                if (offset + chunk[0] > size) {
+                    throw Exception("Truncated GLB chunk");
+                }
+
+                if (chunk[1] == GLBChunkJSON && jsonText.empty()) {
+                    jsonText = StringView(reinterpret_cast<const char *>(data + offset), chunk[0]);
+                }
+                else if (chunk[1] == GLBChunkBinary && binaryChunk.empty()) {
+                    binaryChunk = Span<const uint8_t>(data + offset, chunk[0]);
+                }
+
+                // Chunks are 4-byte aligned
+                offset += (chunk[0] + 3) & ~size_t(3);
+            }
+
+            if (jsonText.empty()) {
+                throw Exception("GLB has no JSON chunk");
+            }
+        }
+        else {
+            jsonText = StringView(reinterpret_cast<const char *>(data), size);
+        }
+
+        _json.Parse(jsonText);
+
+        JsonValue root = _json.GetRoot();
+
+        String version = root["asset"]["version"].GetString();
+        if (!version.starts_with("2.")) {
+            throw Exception("Unsupported glTF version '{}'", version);
+        }
+
+        for (const auto& extension : root["extensionsRequired"]) {
+            StringView name = extension.GetRawString();
+            if (name != "KHR_mesh_quantization" && name != "KHR_texture_basisu" && name != "KHR_materials_emissive_strength") {
+                throw Exception("Unsupported required extension '{}'", name);
+            }
+        }
+
+        LoadBuffers(root, binaryChunk);
+        LoadImages(root);
+
+        // Buffers and images that were data URIs are decoded together
+        ParallelFor(_embeddedDataList.size(), 1, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                auto& embedded = _embeddedDataList[i];
+                DecodeBase64(embedded.Base64, embedded.Data.data(), embedded.Data.size());
+            }
+        });
+
+        LoadAccessors(root);
+        LoadMaterials(root);
+        LoadMeshes(root, optimizeMeshes);
+        LoadNodes(root);
+    }
+    catch (const std::exception& e) {
+        Log(NOON_ANCHOR, "Failed to load glTF model '{}', {}", path, e.what());
+        Close();
+        return false;
+    }
+
+    size_t primitiveCount = 0;
+    for (const auto& mesh : _meshList) {
+        primitiveCount += mesh.Primitives.size();
+    }
+
+    Log(NOON_ANCHOR, "Loaded '{}' in {:.2f}ms, {} meshes, {} primitives, {} materials, {} images, {} nodes",
+        path,
+        duration<float, std::milli>(high_resolution_clock::now() - startTime).count(),
+        _meshList.size(),
+        primitiveCount,
+        _materialList.size(),
+        _imageList.size(),
+        _nodeList.size());
+
+    return true;
+}
+
+NOON_API
+void GLTFModel::Close()
+{
+    _nodeList.clear();
+    _meshList.clear();
+    _imageList.clear();
+    _materialList.clear();
+    _accessorList.clear();
+    _bufferViewList.clear();
+    _bufferList.clear();
+    _embeddedDataList.clear();
+    _externalFileList.clear();
+    _file.Close();
+}
+
+NOON_API
+List<Path> GLTFModel::GetExternalPathList() const
+{
+    List<Path> pathList;
+    for (const auto& file : _externalFileList) {
+        pathList.push_back(file->GetPath());
+    }
+
+    return pathList;
+}
+
+NOON_API
+List<std::unique_ptr<Mesh>> GLTFModel::CreateMeshes(size_t meshIndex) const
+{
+    List<std::unique_ptr<Mesh>> meshList;
+
+    for (const auto& primitive : _meshList.at(meshIndex).Primitives) {
+        meshList.push_back(std::make_unique<Mesh>(primitive.Vertices, primitive.Indices));
+    }
+
+    return meshList;
+}
+
+void GLTFModel::LoadBuffers(const JsonValue& root, Span<const uint8_t> binaryChunk)
+{
+    for (const auto& buffer : root["buffers"]) {
+        size_t byteLength = static_cast<size_t>(buffer["byteLength"].GetInt());
+
+        Span<const uint8_t> data;
+        if (buffer.Has("uri")) {
+            data = LoadURI(buffer["uri"].GetRawString());
+        }
+        else if (_bufferList.empty()) {
+            // Only the first buffer of a GLB can refer to the binary chunk
+            data = binaryChunk;
+        }
+
+        if (data.size() < byteLength) {
+            throw Exception("Buffer #{} has {} bytes, expected {}", _bufferList.size(), data.size(), byteLength);
+        }
+
+        _bufferList.push_back(data.first(byteLength));
+    }
+
+    for (const auto& bufferView : root["bufferViews"]) {
+        int buffer = GetIndex(bufferView["buffer"]);
+        size_t byteOffset = static_cast<size_t>(bufferView["byteOffset"].GetInt());
+        size_t byteLength = static_cast<size_t>(bufferView["byteLength"].GetInt());
+
+        if (buffer < 0 || static_cast<size_t>(buffer) >= _bufferList.size()) {
+            throw Exception("Buffer view #{} has an invalid buffer", _bufferViewList.size());
+        }
+
+        if (byteOffset + byteLength > _bufferList[buffer].size()) {
+            throw Exception("Buffer view #{} is out of bounds", _bufferViewList.size());
+        }
+
+        _bufferViewList.push_back(BufferView{
+            .Data = _bufferList[buffer].data() + byteOffset,
+            .Size = byteLength,
+            .Stride = static_cast<size_t>(bufferView["byteStride"].GetInt()),
+        });
+    }
+}
+
+void GLTFModel::LoadAccessors(const JsonValue& root)
+{
+    for (const auto& accessor : root["accessors"]) {
+        size_t index = _accessorList.size();
+
+        int bufferView = GetIndex(accessor["bufferView"]);
+        if (bufferView >= static_cast<int>(_bufferViewList.size())) {
+            throw Exception("Accessor #{} has an invalid buffer view", index);
+        }
+
+        if (accessor.Has("sparse")) {
+            throw Exception("Accessor #{} is sparse, which is not supported", index);
+        }
+
+        Accessor result = {
+            .BufferView = bufferView,
+            .Offset = static_cast<size_t>(accessor["byteOffset"].GetInt()),
+            .Count = static_cast<size_t>(accessor["count"].GetInt()),
+            .ComponentType = static_cast<uint32_t>(accessor["componentType"].GetInt()),
+            .ComponentCount = GetComponentCount(accessor["type"].GetRawString()),
+            .Normalized = accessor["normalized"].GetBool(),
+        };
+
+        // Check the whole range once, so reads don't need to
+        if (bufferView >= 0 && result.Count > 0) {
+            const auto& view = _bufferViewList[bufferView];
+            size_t elementSize = GetComponentSize(result.ComponentType) * result.ComponentCount;
+            size_t stride = (view.Stride ? view.Stride : elementSize);
+
+            if (result.Offset + (stride * (result.Count - 1)) + elementSize > view.Size) {
+                throw Exception("Accessor #{} is out of bounds", index);
+            }
+        }
+
+        _accessorList.push_back(result);
+    }
+}
+
+void GLTFModel::LoadMaterials(const JsonValue& root)
+{
+    JsonValue textureList = root["textures"];
+
+    auto readSlot = [&](const JsonValue& textureInfo) {
+        GLTFTextureSlot slot;
+
+        int texture = GetIndex(textureInfo["index"]);
+        if (texture < 0) {
+            return slot;
+        }
+
+        JsonValue json = textureList[static_cast<size_t>(texture)];
+
+        // Prefer the KTX2 version when there is one
+        slot.Image = GetIndex(json["extensions"]["KHR_texture_basisu"]["source"]);
+        if (slot.Image < 0) {
+            slot.Image = GetIndex(json["source"]);
+        }
+
+        if (slot.Image >= static_cast<int>(_imageList.size())) {
+            throw Exception("Texture #{} has an invalid image", texture);
+        }
+
+        slot.TexCoord = static_cast<int>(textureInfo["texCoord"].GetInt());
+        return slot;
+    };
+
+    for (const auto& material : root["materials"]) {
+        GLTFMaterial result;
+        result.Name = material["name"].GetString();
+        result.DoubleSided = material["doubleSided"].GetBool();
+
+        auto& parameters = result.Parameters;
+
+        JsonValue pbr = material["pbrMetallicRoughness"];
+
+        JsonValue baseColorFactor = pbr["baseColorFactor"];
+        for (size_t i = 0; i < 4 && i < baseColorFactor.GetSize(); ++i) {
+            parameters.BaseColorFactor[i] = baseColorFactor[i].GetFloat();
+        }
+
+        parameters.MetallicFactor = pbr["metallicFactor"].GetFloat(1.0f);
+        parameters.RoughnessFactor = pbr["roughnessFactor"].GetFloat(1.0f);
+        result.BaseColorMap = readSlot(pbr["baseColorTexture"]);
+        result.MetallicRoughnessMap = readSlot(pbr["metallicRoughnessTexture"]);
+
+        JsonValue normalTexture = material["normalTexture"];
+        parameters.NormalScale = normalTexture["scale"].GetFloat(1.0f);
+        result.NormalMap = readSlot(normalTexture);
+
+        JsonValue occlusionTexture = material["occlusionTexture"];
+        parameters.OcclusionStrength = occlusionTexture["strength"].GetFloat(1.0f);
+        result.OcclusionMap = readSlot(occlusionTexture);
+
+        JsonValue emissiveFactor = material["emissiveFactor"];
+        for (size_t i = 0; i < 3 && i < emissiveFactor.GetSize(); ++i) {
+            parameters.EmissiveFactor[i] = emissiveFactor[i].GetFloat();
+        }
+
+        parameters.EmissiveFactor *= material["extensions"]["KHR_materials_emissive_strength"]["emissiveStrength"].GetFloat(1.0f);
+        result.EmissiveMap = readSlot(material["emissiveTexture"]);
+
+        _materialList.push_back(std::move(result));
+    }
+}
+
+void GLTFModel::LoadImages(const JsonValue& root)
+{
+    for (const auto& image : root["images"]) {
+        GLTFImage result;
+        result.Name = image["name"].GetString();
+        result.MimeType = image["mimeType"].GetString();
+
+        if (image.Has("uri")) {
+            StringView uri = image["uri"].GetRawString();
+            result.Data = LoadURI(uri);
+
+            if (result.MimeType.empty()) {
+                if (uri.starts_with("data:")) {
+                    result.MimeType = uri.substr(5, uri.find(';') - 5);
+                }
+                else {
+                    result.MimeType = GetMimeTypeFromURI(uri);
+                }
+            }
+        }
+        else {
+            // Buffer views have already been loaded, but accessors haven't
+            int bufferView = GetIndex(image["bufferView"]);
+            if (bufferView < 0 || static_cast<size_t>(bufferView) >= _bufferViewList.size()) {
+                throw Exception("Image #{} has neither a URI nor a valid buffer view", _imageList.size());
+            }
+
+            const auto& view = _bufferViewList[bufferView];
+            result.Data = Span<const uint8_t>(view.Data, view.Size);
+        }
+
+        _imageList.push_back(std::move(result));
+    }
+}
+
+void GLTFModel::LoadMeshes(const JsonValue& root, bool optimizeMeshes)
+{
+    struct Task
+    {
+        JsonValue Json;
+
+        GLTFPrimitive * Primitive;
+
+        std::exception_ptr Exception;
+
+    }; // struct Task
+
+    List<Task> taskList;
+
+    JsonValue meshList = root["meshes"];
+    _meshList.resize(meshList.GetSize());
+
+    size_t meshIndex = 0;
+    for (const auto& mesh : meshList) {
+        auto& result = _meshList[meshIndex++];
+        result.Name = mesh["name"].GetString();
+
+        JsonValue primitiveList = mesh["primitives"];
+        result.Primitives.resize(primitiveList.GetSize());
+
+        size_t primitiveIndex = 0;
+        for (const auto& primitive : primitiveList) {
+            taskList.push_back(Task{
+                .Json = primitive,
+                .Primitive = &result.Primitives[primitiveIndex++],
+                .Exception = nullptr,
+            });
+        }
+    }
+
+    // Primitives vary a lot in size, so each is its own batch
+    ParallelFor(taskList.size(), 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            try {
+                DecodePrimitive(taskList[i].Json, *taskList[i].Primitive, optimizeMeshes);
+            }
+            catch (...) {
+                taskList[i].Exception = std::current_exception();
+            }
+        }
+    });
+
+    for (const auto& task : taskList) {
+        if (task.Exception) {
+            std::rethrow_exception(task.Exception);
+        }
+    }
+}
+
+void GLTFModel::LoadNodes(const JsonValue& root)
+{
+    JsonValue nodeList = root["nodes"];
+    size_t nodeCount = nodeList.GetSize();
+
+    List<GLTFNode> unsortedList(nodeCount);
+    List<List<int>> childrenList(nodeCount);
+
+    size_t index = 0;
+    for (const auto& node : nodeList) {
+        auto& result = unsortedList[index];
+        result.Name = node["name"].GetString();
+        result.Mesh = GetIndex(node["mesh"]);
+
+        if (result.Mesh >= static_cast<int>(_meshList.size())) {
+            throw Exception("Node #{} has an invalid mesh", index);
+        }
+
+        JsonValue matrix = node["matrix"];
+        if (matrix.GetSize() == 16) {
+            Mat4 transform;
+            size_t element = 0;
+            for (const auto& value : matrix) {
+                transform[element / 4][element % 4] = value.GetFloat();
+                ++element;
+            }
+
+            // Matrices are never sheared or animated, so they can be split back into TRS
+            result.Translation = Vec3(transform[3]);
+            result.Scale = Vec3(
+                glm::length(Vec3(transform[0])),
+                glm::length(Vec3(transform[1])),
+                glm::length(Vec3(transform[2])));
+
+            Mat3 rotation(
+                Vec3(transform[0]) / result.Scale.x,
+                Vec3(transform[1]) / result.Scale.y,
+                Vec3(transform[2]) / result.Scale.z);
+            result.Rotation = glm::normalize(glm::quat_cast(rotation));
+        }
+        else {
+            JsonValue translation = node["translation"];
+            for (size_t i = 0; i < 3 && i < translation.GetSize(); ++i) {
+                result.Translation[i] = translation[i].GetFloat();
+            }
+
+            // glTF stores quaternions as xyzw, glm's constructor takes wxyz
+            JsonValue rotation = node["rotation"];
+            if (rotation.GetSize() == 4) {
+                result.Rotation = Quat(
+                    rotation[3].GetFloat(),
+                    rotation[0].GetFloat(),
+                    rotation[1].GetFloat(),
+                    rotation[2].GetFloat());
+            }
+
+            JsonValue scale = node["scale"];
+            for (size_t i = 0; i < 3 && i < scale.GetSize(); ++i) {
+                result.Scale[i] = scale[i].GetFloat();
+            }
+        }
+
+        for (const auto& child : node["children"]) {
+            int childIndex = GetIndex(child);
+            if (childIndex < 0 || static_cast<size_t>(childIndex) >= nodeCount) {
+                throw Exception("Node #{} has an invalid child", index);
+            }
+
+            if (unsortedList[childIndex].Parent >= 0) {
+                throw Exception("Node #{} has more than one parent", childIndex);
+            }
+
+            unsortedList[childIndex].Parent = static_cast<int>(index);
+            childrenList[index].push_back(childIndex);
+        }
+
+        ++index;
+    }
+
+    // glTF allows children before their parents, sort them breadth first from the roots
+    List<int> orderList;
+    orderList.reserve(nodeCount);
+
+    for (size_t i = 0; i < nodeCount; ++i) {
+        if (unsortedList[i].Parent < 0) {
+            orderList.push_back(static_cast<int>(i));
+        }
+    }
+
+    for (size_t i = 0; i < orderList.size(); ++i) {
+        const auto& children = childrenList[orderList[i]];
+        orderList.insert(orderList.end(), children.begin(), children.end());
+    }
+
+    if (orderList.size() != nodeCount) {
+        throw Exception("The node hierarchy has a cycle");
+    }
+
+    List<int> remapList(nodeCount);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        remapList[orderList[i]] = static_cast<int>(i);
+    }
+
+    _nodeList.clear();
+    _nodeList.reserve(nodeCount);
+
+    for (int original : orderList) {
+        GLTFNode& node = unsortedList[original];
+        if (node.Parent >= 0) {
+            node.Parent = remapList[node.Parent];
+        }
+
+        _nodeList.push_back(std::move(node));
+    }
+}
+
+Span<const uint8_t> GLTFModel::LoadURI(StringView uri)
+{
+    if (uri.starts_with("data:")) {
+        size_t comma = uri.find(',');
+        if (comma == StringView::npos || uri.substr(0, comma).find(";base64") == StringView::npos) {
+            throw Exception("Only base64 data URIs are supported");
+        }
+
+        // Decoded later, in parallel with the other data URIs
+        StringView base64 = uri.substr(comma + 1);
+
+        auto& embedded = _embeddedDataList.emplace_back();
+        embedded.Base64 = base64;
+        embedded.Data.resize(GetBase64DecodedSize(base64));
+        return Span<const uint8_t>(embedded.Data.data(), embedded.Data.size());
+    }
+
+    // GetParentPath() returns the path itself when it is only a filename
+    Path directory = _path.GetParentPath();
+    Path path = DecodePercentEncoding(uri);
+    if (directory != _path) {
+        path = directory / path;
+    }
+
+    auto file = std::make_unique<MappedFile>();
+    if (!file->Open(path)) {
+        throw Exception("Failed to open '{}'", path);
+    }
+
+    Span<const uint8_t> data(file->GetData(), file->GetSize());
+    _externalFileList.push_back(std::move(file));
+    return data;
+}
+
+void GLTFModel::DecodePrimitive(const JsonValue& json, GLTFPrimitive& primitive, bool optimizeMeshes) const
+{
+    int64_t mode = json["mode"].GetInt(ModeTriangles);
+    if (mode != ModeTriangles && mode != ModeTriangleStrip && mode != ModeTriangleFan) {
+        throw Exception("Unsupported primitive mode {}, only triangles are supported", mode);
+    }
+
+    primitive.Material = GetIndex(json["material"]);
+    if (primitive.Material >= static_cast<int>(_materialList.size())) {
+        throw Exception("Primitive has an invalid material");
+    }
+
+    JsonValue attributes = json["attributes"];
+
+    int position = GetIndex(attributes["POSITION"]);
+    if (position < 0) {
+        throw Exception("Primitive has no positions");
+    }
+
+    size_t vertexCount = GetAccessor(position).Count;
+
+    // Every attribute must have one element per vertex
+    auto getAttribute = [&](StringView name) {
+        int accessor = GetIndex(attributes[name]);
+        if (accessor >= 0 && GetAccessor(accessor).Count != vertexCount) {
+            throw Exception("Attribute {} has {} elements, expected {}", name, GetAccessor(accessor).Count, vertexCount);
+        }
+        return accessor;
+    };
+
+    auto& vertices = primitive.Vertices;
+
+    vertices.Positions.resize(vertexCount);
+    ReadFloats(position, &vertices.Positions[0].x, 3);
+
+    if (int normal = getAttribute("NORMAL"); normal >= 0) {
+        vertices.Normals.resize(vertexCount);
+        ReadFloats(normal, &vertices.Normals[0].x, 3);
+    }
+
+    if (int tangent = getAttribute("TANGENT"); tangent >= 0) {
+        vertices.Tangents.resize(vertexCount);
+        ReadFloats(tangent, &vertices.Tangents[0].x, 4);
+    }
+
+    if (int color = getAttribute("COLOR_0"); color >= 0) {
+        // RGB colors keep the default alpha
+        vertices.Colors.resize(vertexCount, Vec4(1.0f));
+        ReadFloats(color, &vertices.Colors[0].x, 4);
+    }
+
+    if (int texCoord = getAttribute("TEXCOORD_0"); texCoord >= 0) {
+        vertices.TexCoords1.resize(vertexCount);
+        ReadFloats(texCoord, &vertices.TexCoords1[0].x, 2);
+    }
+
+    if (int texCoord = getAttribute("TEXCOORD_1"); texCoord >= 0) {
+        vertices.TexCoords2.resize(vertexCount);
+        ReadFloats(texCoord, &vertices.TexCoords2[0].x, 2);
+    }
+
+    if (int joints = getAttribute("JOINTS_0"); joints >= 0) {
+        vertices.Joints.resize(vertexCount);
+        ReadUints(joints, &vertices.Joints[0].x, 4);
+    }
+
+    if (int weights = getAttribute("WEIGHTS_0"); weights >= 0) {
+        vertices.Weights.resize(vertexCount);
+        ReadFloats(weights, &vertices.Weights[0].x, 4);
+    }
+
+    List<uint32_t> indexList;
+
+    int indices = GetIndex(json["indices"]);
+    if (indices >= 0) {
+        indexList.resize(GetAccessor(indices).Count);
+        if (!indexList.empty()) {
+            ReadUints(indices, indexList.data(), 1);
+        }
+
+        for (uint32_t index : indexList) {
+            if (index >= vertexCount) {
+                throw Exception("Index {} is out of range for {} vertices", index, vertexCount);
+            }
+        }
+    }
+    else {
+        indexList.resize(vertexCount);
+        for (size_t i = 0; i < vertexCount; ++i) {
+            indexList[i] = static_cast<uint32_t>(i);
+        }
+    }
+
+    // Strips and fans are unrolled into lists, which is what every other primitive draws with
+    auto& triangleList = primitive.Indices;
+
+    if (mode == ModeTriangles) {
+        triangleList = std::move(indexList);
+        triangleList.resize(triangleList.size() - (triangleList.size() % 3));
+    }
+    else if (indexList.size() >= 3) {
+        triangleList.reserve((indexList.size() - 2) * 3);
+
+        for (size_t i = 2; i < indexList.size(); ++i) {
+            if (mode == ModeTriangleFan) {
+                triangleList.insert(triangleList.end(), { indexList[0], indexList[i - 1], indexList[i] });
+            }
+            else if (i % 2 == 0) {
+                triangleList.insert(triangleList.end(), { indexList[i - 2], indexList[i - 1], indexList[i] });
+            }
+            else {
+                // Every other triangle of a strip is flipped to keep the winding
+                triangleList.insert(triangleList.end(), { indexList[i - 1], indexList[i - 2], indexList[i] });
+            }
+        }
+    }
+
+    if (optimizeMeshes && !triangleList.empty()) {
+        OptimizeMesh(vertices, triangleList);
+    }
+
+    primitive.Bounds = AABB::FromPoints(vertices.Positions);
+}
+
+const GLTFModel::Accessor& GLTFModel::GetAccessor(int accessor) const
+{
+    if (accessor < 0 || static_cast<size_t>(accessor) >= _accessorList.size()) {
+        throw Exception("Invalid accessor #{}", accessor);
+    }
+
+    return _accessorList[accessor];
+}
+
+void GLTFModel::ReadFloats(int accessorIndex, float * out, size_t outComponents) const
+{
+    const Accessor& accessor = GetAccessor(accessorIndex);
+
+    // Without a buffer view every element is zero
+    if (accessor.BufferView < 0) {
+        for (size_t i = 0; i < accessor.Count; ++i) {
+            std::fill_n(out + (i * outComponents), std::min<size_t>(accessor.ComponentCount, outComponents), 0.0f);
+        }
+        return;
+    }
+
+    const auto& view = _bufferViewList[accessor.BufferView];
+    const uint8_t * src = view.Data + accessor.Offset;
+
+    size_t components = accessor.ComponentCount;
+    size_t stride = (view.Stride ? view.Stride : GetComponentSize(accessor.ComponentType) * components);
+
+    switch (accessor.ComponentType) {
+    case ComponentByte:
+        ConvertToFloat<int8_t>(src, stride, accessor.Count, components, accessor.Normalized, out, outComponents);
+        break;
+    case ComponentUnsignedByte:
+        ConvertToFloat<uint8_t>(src, stride, accessor.Count, components, accessor.Normalized, out, outComponents);
+        break;
+    case ComponentShort:
+        ConvertToFloat<int16_t>(src, stride, accessor.Count, components, accessor.Normalized, out, outComponents);
+        break;
+    case ComponentUnsignedShort:
+        ConvertToFloat<uint16_t>(src, stride, accessor.Count, components, accessor.Normalized, out, outComponents);
+        break;
+    case ComponentUnsignedInt:
+        ConvertToFloat<uint32_t>(src, stride, accessor.Count, components, accessor.Normalized, out, outComponents);
+        break;
+    case ComponentFloat:
+        ConvertToFloat<float>(src, stride, accessor.Count, components, false, out, outComponents);
+        break;
+    default:
+        throw Exception("Invalid accessor component type {}", accessor.ComponentType);
+    }
+}
+
+void GLTFModel::ReadUints(int accessorIndex, uint32_t * out, size_t outComponents) const
+{
+    const Accessor& accessor = GetAccessor(accessorIndex);
+
+    if (accessor.BufferView < 0) {
+        for (size_t i = 0; i < accessor.Count; ++i) {
+            std::fill_n(out + (i * outComponents), std::min<size_t>(accessor.ComponentCount, outComponents), 0u);
+        }
+        return;
+    }
+
+    const auto& view = _bufferViewList[accessor.BufferView];
+    const uint8_t * src = view.Data + accessor.Offset;
+
+    size_t components = accessor.ComponentCount;
+    size_t stride = (view.Stride ? view.Stride : GetComponentSize(accessor.ComponentType) * components);
+
+    switch (accessor.ComponentType) {
+    case ComponentUnsignedByte:
+        ConvertToUint<uint8_t>(src, stride, accessor.Count, components, out, outComponents);
+        break;
+    case ComponentUnsignedShort:
+        ConvertToUint<uint16_t>(src, stride, accessor.Count, components, out, outComponents);
+        break;
+    case ComponentUnsignedInt:
+        ConvertToUint<uint32_t>(src, stride, accessor.Count, components, out, outComponents);
+        break;
+    default:
+        throw Exception("Accessor #{} must be unsigned integers", accessorIndex);
+    }
+}
+
+} // namespace noon
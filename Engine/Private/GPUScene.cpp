@@ -0,0 +1,1071 @@
+#include <Noon/GPUScene.hpp>
+#include <Noon/Application.hpp>
+#include <Noon/Bounds.hpp>
+#include <Noon/Buffer.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/Log.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace noon {
+
+// Matches local_size_x in Cull.comp.glsl
+static const uint32_t CullWorkgroupSize = 64;
+
+GPUScene::GPUScene(
+    const VertexFormat& vertexFormat,
+    uint32_t maxObjectCount,
+    uint32_t maxMeshCount,
+    uint32_t maxVertexCount,
+    uint32_t maxIndexCount)
+    : _vertexFormat(vertexFormat)
+    , _maxObjectCount(maxObjectCount)
+    , _maxMeshCount(maxMeshCount)
+    , _maxVertexCount(maxVertexCount)
+    , _maxIndexCount(maxIndexCount)
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    // Each draw passes the index of its object as firstInstance
+    if (!gfx->HasDrawIndirectFirstInstance()) {
+        throw Exception("GPUScene requires the drawIndirectFirstInstance feature");
+    }
+
+    InitBuffers();
+    InitDescriptorSets();
+    InitPipelines();
+    InitFrames();
+
+    gfx->AddGPUScene(this);
+
+    Log(NOON_ANCHOR, "Created GPU scene for {} objects, {} meshes, {} vertices and {} indices, drawing with {}",
+        _maxObjectCount,
+        _maxMeshCount,
+        _maxVertexCount,
+        _maxIndexCount,
+        (gfx->HasDrawIndirectCount()
+            ? "vkCmdDrawIndexedIndirectCount"
+            : "vkCmdDrawIndexedIndirect"));
+}
+
+GPUScene::~GPUScene()
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    gfx->RemoveGPUScene(this);
+
+    vkDeviceWaitIdle(gfx->GetDevice());
+
+    TermFrames();
+    TermPipelines();
+    TermDescriptorSets();
+    TermBuffers();
+}
+
+uint32_t GPUScene::AddMesh(const VertexData& vertexData, Span<const uint32_t> indexList, Span<const MeshLOD> lodList)
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    uint32_t vertexCount = static_cast<uint32_t>(vertexData.GetVertexCount());
+    if (vertexCount == 0) {
+        throw Exception("Unable to add a mesh without any vertices");
+    }
+
+    // Without indices the vertices are drawn as a triangle list, like Mesh
+    List<uint32_t> sequentialIndexList;
+    if (indexList.empty()) {
+        sequentialIndexList.resize(vertexCount);
+        std::iota(sequentialIndexList.begin(), sequentialIndexList.end(), 0);
+        indexList = sequentialIndexList;
+    }
+
+    uint32_t indexCount = static_cast<uint32_t>(indexList.size());
+
+    if (indexCount % 3 != 0) {
+        throw Exception("Index count {} is not a multiple of 3", indexCount);
+    }
+
+    for (uint32_t index : indexList) {
+        if (index >= vertexCount) {
+            throw Exception("Index {} is out of range for {} vertices", index, vertexCount);
+        }
+    }
+
+    if (lodList.size() > MaxMeshLODCount) {
+        throw Exception("{} levels of detail is more than the limit of {}", lodList.size(), MaxMeshLODCount);
+    }
+
+    if (!lodList.empty() && !sequentialIndexList.empty()) {
+        throw Exception("Unable to add levels of detail without indices");
+    }
+
+    for (const auto& lod : lodList) {
+        if (lod.IndexCount % 3 != 0 || uint64_t(lod.FirstIndex) + lod.IndexCount > indexCount) {
+            throw Exception("Level of detail with indices [{}, {}) is out of range for {} indices",
+                lod.FirstIndex, uint64_t(lod.FirstIndex) + lod.IndexCount, indexCount);
+        }
+    }
+
+    if (_meshList.size() >= _maxMeshCount) {
+        throw Exception("GPUScene is full, unable to add more than {} meshes", _maxMeshCount);
+    }
+
+    if (_vertexCount + vertexCount > _maxVertexCount) {
+        throw Exception("GPUScene is full, unable to add {} vertices", vertexCount);
+    }
+
+    if (_indexCount + indexCount > _maxIndexCount) {
+        throw Exception("GPUScene is full, unable to add {} indices", indexCount);
+    }
+
+    ShaderMesh shaderMesh;
+    auto data = _vertexFormat.Pack(vertexData, &shaderMesh);
+
+    VkDeviceSize stride = _vertexFormat.GetStride();
+
+    UploadToDeviceBuffer(_vkVertexBuffer, _vertexCount * stride, data.size(), data.data());
+    UploadToDeviceBuffer(_vkIndexBuffer, _indexCount * sizeof(uint32_t), indexCount * sizeof(uint32_t), indexList.data());
+
+    auto boundingSphere = BoundingSphere::FromPoints(vertexData.Positions);
+
+    // Without levels, the whole index list is the only one
+    Array<ShaderSceneLOD, MaxMeshLODCount> shaderLODList = { };
+    shaderLODList[0] = {
+        .FirstIndex = _indexCount,
+        .IndexCount = indexCount,
+        .Error = 0.0f,
+        .Padding = 0,
+    };
+
+    for (size_t i = 0; i < lodList.size(); ++i) {
+        shaderLODList[i] = {
+            .FirstIndex = _indexCount + lodList[i].FirstIndex,
+            .IndexCount = lodList[i].IndexCount,
+            .Error = lodList[i].Error,
+            .Padding = 0,
+        };
+    }
+
+    ShaderSceneMesh mesh = {
+        .BoundingSphere = Vec4(boundingSphere.Center, boundingSphere.Radius),
+        .PositionScale = shaderMesh.PositionScale,
+        .PositionOffset = shaderMesh.PositionOffset,
+        .IndexCount = shaderLODList[0].IndexCount,
+        .FirstIndex = shaderLODList[0].FirstIndex,
+        .VertexOffset = static_cast<int32_t>(_vertexCount),
+        .LODCount = std::max<uint32_t>(static_cast<uint32_t>(lodList.size()), 1),
+    };
+
+    uint32_t meshIndex = static_cast<uint32_t>(_meshList.size());
+    _meshList.push_back(mesh);
+
+    memcpy(_meshBuffer.Data + meshIndex * sizeof(ShaderSceneMesh), &mesh, sizeof(mesh));
+
+    vmaFlushAllocation(
+        gfx->GetAllocator(),
+        _meshBuffer.Allocation,
+        meshIndex * sizeof(ShaderSceneMesh),
+        sizeof(ShaderSceneMesh));
+
+    VkDeviceSize lodOffset = VkDeviceSize(meshIndex) * MaxMeshLODCount * sizeof(ShaderSceneLOD);
+
+    memcpy(_lodBuffer.Data + lodOffset, shaderLODList.data(), sizeof(shaderLODList));
+
+    vmaFlushAllocation(
+        gfx->GetAllocator(),
+        _lodBuffer.Allocation,
+        lodOffset,
+        sizeof(shaderLODList));
+
+    _vertexCount += vertexCount;
+    _indexCount += indexCount;
+
+    return meshIndex;
+}
+
+uint32_t GPUScene::AddObject(uint32_t meshIndex, const Mat4& model)
+{
+    if (meshIndex >= _meshList.size()) {
+        throw Exception("Mesh index {} is out of range for {} meshes", meshIndex, _meshList.size());
+    }
+
+    uint32_t objectIndex;
+
+    if (!_freeObjectList.empty()) {
+        objectIndex = _freeObjectList.back();
+        _freeObjectList.pop_back();
+    }
+    else {
+        if (_objectList.size() >= _maxObjectCount) {
+            throw Exception("GPUScene is full, unable to add more than {} objects", _maxObjectCount);
+        }
+
+        objectIndex = static_cast<uint32_t>(_objectList.size());
+        _objectList.emplace_back();
+        _objectDirtyMaskList.push_back(0);
+    }
+
+    auto& object = _objectList[objectIndex];
+
+    for (int row = 0; row < 3; ++row) {
+        object.Model[row] = Vec4(model[0][row], model[1][row], model[2][row], model[3][row]);
+    }
+
+    object.MeshIndex = meshIndex;
+    object.Flags = SceneObjectActive;
+    object.Padding[0] = 0;
+    object.Padding[1] = 0;
+
+    MarkObjectDirty(objectIndex);
+
+    return objectIndex;
+}
+
+void GPUScene::SetObjectTransform(uint32_t objectIndex, const Mat4& model)
+{
+    if (objectIndex >= _objectList.size() || !(_objectList[objectIndex].Flags & SceneObjectActive)) {
+        throw Exception("Object index {} does not exist", objectIndex);
+    }
+
+    auto& object = _objectList[objectIndex];
+
+    for (int row = 0; row < 3; ++row) {
+        object.Model[row] = Vec4(model[0][row], model[1][row], model[2][row], model[3][row]);
+    }
+
+    MarkObjectDirty(objectIndex);
+}
+
+void GPUScene::RemoveObject(uint32_t objectIndex)
+{
+    if (objectIndex >= _objectList.size() || !(_objectList[objectIndex].Flags & SceneObjectActive)) {
+        throw Exception("Object index {} does not exist", objectIndex);
+    }
+
+    // The mesh index is kept, so the culling pass can still read the slot safely
+    _objectList[objectIndex].Flags = 0;
+    _freeObjectList.push_back(objectIndex);
+
+    MarkObjectDirty(objectIndex);
+}
+
+void GPUScene::RecordCulling(VkCommandBuffer commandBuffer)
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    if (_frameList.size() != gfx->GetBackbufferCount()) {
+        vkDeviceWaitIdle(gfx->GetDevice());
+        InitFrames();
+    }
+
+    unsigned frameIndex = gfx->GetBackbufferIndex();
+    auto& frame = _frameList[frameIndex];
+
+    // The frame's fence has been waited on, so the results of its last use are available
+    if (frame.HasRecorded) {
+        vmaInvalidateAllocation(gfx->GetAllocator(), frame.ReadbackBuffer.Allocation, 0, VK_WHOLE_SIZE);
+
+        Array<uint32_t, 2> countList;
+        memcpy(countList.data(), frame.ReadbackBuffer.Data, sizeof(countList));
+
+        _visibleObjectCount = countList[0];
+        _visibleTriangleCount = countList[1] / 3;
+    }
+
+    UploadDirtyObjects(frame, frameIndex);
+
+    uint32_t objectCount = static_cast<uint32_t>(_objectList.size());
+
+    const auto& shaderView = gfx->GetShaderView();
+
+    Frustum frustum = Frustum::FromMatrix(shaderView.ViewProjection);
+
+    ShaderCull shaderCull = { };
+    std::copy(frustum.Planes.begin(), frustum.Planes.end(), shaderCull.FrustumPlanes);
+    shaderCull.ObjectCount = objectCount;
+    shaderCull.FrustumCulling = _frustumCullingEnabled;
+    shaderCull.Compact = gfx->HasDrawIndirectCount();
+
+    // The threshold is folded into the scale, so the shader only has to multiply
+    float lodScale = GetLODScale(shaderView.Projection, static_cast<float>(gfx->GetWindowSize().y));
+    if (_lodEnabled && _lodSettings.Threshold > 0.0f) {
+        shaderCull.LODCamera = Vec4(Vec3(shaderView.CameraPosition), lodScale / _lodSettings.Threshold);
+        shaderCull.LODHysteresis = _lodSettings.Hysteresis;
+    }
+
+    vkCmdFillBuffer(commandBuffer, frame.DrawCountBuffer, 0, VK_WHOLE_SIZE, 0);
+
+    Array<VkBufferMemoryBarrier, 2> fillBarrierList = {
+        VkBufferMemoryBarrier {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = frame.DrawCountBuffer,
+            .offset = 0,
+            .size = VK_WHOLE_SIZE,
+        },
+        // The levels written by the previous frame's culling pass
+        VkBufferMemoryBarrier {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = _vkObjectLODBuffer,
+            .offset = 0,
+            .size = VK_WHOLE_SIZE,
+        },
+    };
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        0, nullptr,
+        static_cast<uint32_t>(fillBarrierList.size()), fillBarrierList.data(),
+        0, nullptr);
+
+    if (objectCount > 0) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _vkCullPipeline);
+
+        vkCmdBindDescriptorSets(
+            commandBuffer,
+            VK_PIPELINE_BIND_POINT_COMPUTE,
+            _vkCullPipelineLayout,
+            0,
+            1,
+            &frame.DescriptorSet,
+            0,
+            nullptr);
+
+        vkCmdPushConstants(
+            commandBuffer,
+            _vkCullPipelineLayout,
+            VK_SHADER_STAGE_COMPUTE_BIT,
+            0,
+            sizeof(shaderCull),
+            &shaderCull);
+
+        vkCmdDispatch(commandBuffer, (objectCount + CullWorkgroupSize - 1) / CullWorkgroupSize, 1, 1);
+    }
+
+    Array<VkBufferMemoryBarrier, 2> cullBarrierList = {
+        VkBufferMemoryBarrier {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = frame.DrawBuffer,
+            .offset = 0,
+            .size = VK_WHOLE_SIZE,
+        },
+        VkBufferMemoryBarrier {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = frame.DrawCountBuffer,
+            .offset = 0,
+            .size = VK_WHOLE_SIZE,
+        },
+    };
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0,
+        0, nullptr,
+        static_cast<uint32_t>(cullBarrierList.size()), cullBarrierList.data(),
+        0, nullptr);
+
+    VkBufferCopy bufferCopyRegion = {
+        .srcOffset = 0,
+        .dstOffset = 0,
+        .size = 2 * sizeof(uint32_t),
+    };
+
+    vkCmdCopyBuffer(
+        commandBuffer,
+        frame.DrawCountBuffer,
+        frame.ReadbackBuffer.Buffer,
+        1,
+        &bufferCopyRegion);
+
+    VkBufferMemoryBarrier readbackBarrier = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = frame.ReadbackBuffer.Buffer,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE,
+    };
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_HOST_BIT,
+        0,
+        0, nullptr,
+        1, &readbackBarrier,
+        0, nullptr);
+
+    frame.HasRecorded = true;
+}
+
+void GPUScene::RecordDraw(VkCommandBuffer commandBuffer)
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    uint32_t objectCount = static_cast<uint32_t>(_objectList.size());
+    if (objectCount == 0) {
+        return;
+    }
+
+    auto& frame = _frameList[gfx->GetBackbufferIndex()];
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _vkDrawPipeline);
+
+    // Set 0 is compatible with the driver's pipeline layout, so its descriptor set stays bound
+    vkCmdBindDescriptorSets(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        _vkDrawPipelineLayout,
+        1,
+        1,
+        &frame.DescriptorSet,
+        0,
+        nullptr);
+
+    Array<VkBuffer, 2> vertexBufferList = {
+        _vkVertexBuffer,
+        gfx->GetDefaultVertexBuffer()->GetBuffer(),
+    };
+
+    Array<VkDeviceSize, 2> offsetList = { 0, 0 };
+
+    vkCmdBindVertexBuffers(
+        commandBuffer,
+        VertexFormat::VertexBinding,
+        static_cast<uint32_t>(vertexBufferList.size()),
+        vertexBufferList.data(),
+        offsetList.data());
+
+    vkCmdBindIndexBuffer(commandBuffer, _vkIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+    if (gfx->HasDrawIndirectCount()) {
+        vkCmdDrawIndexedIndirectCount(
+            commandBuffer,
+            frame.DrawBuffer,
+            0,
+            frame.DrawCountBuffer,
+            0,
+            objectCount,
+            sizeof(ShaderSceneDraw));
+    }
+    else if (gfx->HasMultiDrawIndirect()) {
+        vkCmdDrawIndexedIndirect(
+            commandBuffer,
+            frame.DrawBuffer,
+            0,
+            objectCount,
+            sizeof(ShaderSceneDraw));
+    }
+    else {
+        // Without multiDrawIndirect the draw count must be 1, so CPU cost is per object again
+        for (uint32_t i = 0; i < objectCount; ++i) {
+            vkCmdDrawIndexedIndirect(
+                commandBuffer,
+                frame.DrawBuffer,
+                i * sizeof(ShaderSceneDraw),
+                1,
+                sizeof(ShaderSceneDraw));
+        }
+    }
+}
+
+void GPUScene::MarkObjectDirty(uint32_t objectIndex)
+{
+    auto& mask = _objectDirtyMaskList[objectIndex];
+
+    for (unsigned i = 0; i < _frameList.size(); ++i) {
+        if (!(mask & (1u << i))) {
+            mask |= (1u << i);
+            _frameList[i].DirtyObjectList.push_back(objectIndex);
+        }
+    }
+}
+
+void GPUScene::UploadDirtyObjects(Frame& frame, unsigned frameIndex)
+{
+    if (frame.DirtyObjectList.empty()) {
+        return;
+    }
+
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    for (uint32_t objectIndex : frame.DirtyObjectList) {
+        memcpy(
+            frame.ObjectBuffer.Data + objectIndex * sizeof(ShaderSceneObject),
+            &_objectList[objectIndex],
+            sizeof(ShaderSceneObject));
+
+        _objectDirtyMaskList[objectIndex] &= ~(1u << frameIndex);
+    }
+
+    frame.DirtyObjectList.clear();
+
+    vmaFlushAllocation(gfx->GetAllocator(), frame.ObjectBuffer.Allocation, 0, VK_WHOLE_SIZE);
+}
+
+void GPUScene::CreateDeviceBuffer(VkDeviceSize size, VkBufferUsageFlags bufferUsageFlags, VkBuffer * buffer, VmaAllocation * allocation)
+{
+    VkResult vkResult;
+
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    VkBufferCreateInfo bufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .size = size,
+        .usage = bufferUsageFlags,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    // Not a Buffer, as the Defragmenter would move it out from under the descriptor sets
+    VmaAllocationCreateInfo allocationCreateInfo = {
+        .usage = VMA_MEMORY_USAGE_GPU_ONLY,
+    };
+
+    vkResult = gfx->CreateBuffer(
+        MemoryCategory::Buffer,
+        &bufferCreateInfo,
+        &allocationCreateInfo,
+        buffer,
+        allocation,
+        nullptr);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vmaCreateBuffer() failed");
+    }
+}
+
+void GPUScene::UploadToDeviceBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, const void * data)
+{
+    VkResult vkResult;
+
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    VkBufferCreateInfo stagingBufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .size = size,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    VmaAllocationCreateInfo stagingAllocationCreateInfo = {
+        .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .usage = VMA_MEMORY_USAGE_CPU_ONLY,
+        .pool = gfx->GetMemoryPool(MemoryPool::Staging),
+    };
+
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VmaAllocation stagingAllocation = VK_NULL_HANDLE;
+    VmaAllocationInfo stagingAllocationInfo;
+
+    vkResult = gfx->CreateBuffer(
+        MemoryCategory::Staging,
+        &stagingBufferCreateInfo,
+        &stagingAllocationCreateInfo,
+        &stagingBuffer,
+        &stagingAllocation,
+        &stagingAllocationInfo);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vmaCreateBuffer() failed, unable to create staging buffer");
+    }
+
+    memcpy(stagingAllocationInfo.pMappedData, data, size);
+
+    // Only ranges the GPU hasn't been told about yet are written, so frames in flight are unaffected
+    gfx->CopyBuffer(stagingBuffer, buffer, size, offset);
+
+    gfx->DestroyBuffer(MemoryCategory::Staging, stagingBuffer, stagingAllocation);
+}
+
+void GPUScene::InitBuffers()
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    TermBuffers();
+
+    CreateDeviceBuffer(
+        static_cast<VkDeviceSize>(_maxVertexCount) * _vertexFormat.GetStride(),
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        &_vkVertexBuffer,
+        &_vmaVertexAllocation);
+
+    CreateDeviceBuffer(
+        static_cast<VkDeviceSize>(_maxIndexCount) * sizeof(uint32_t),
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        &_vkIndexBuffer,
+        &_vmaIndexAllocation);
+
+    _meshBuffer = gfx->CreateMappedBuffer(
+        _maxMeshCount * sizeof(ShaderSceneMesh),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VMA_MEMORY_USAGE_CPU_TO_GPU,
+        MemoryCategory::Buffer);
+
+    _lodBuffer = gfx->CreateMappedBuffer(
+        _maxMeshCount * MaxMeshLODCount * sizeof(ShaderSceneLOD),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VMA_MEMORY_USAGE_CPU_TO_GPU,
+        MemoryCategory::Buffer);
+
+    CreateDeviceBuffer(
+        static_cast<VkDeviceSize>(_maxObjectCount) * sizeof(uint32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        &_vkObjectLODBuffer,
+        &_vmaObjectLODAllocation);
+
+    // Every object starts out at full detail
+    List<uint32_t> objectLODList(_maxObjectCount, 0);
+    UploadToDeviceBuffer(_vkObjectLODBuffer, 0, objectLODList.size() * sizeof(uint32_t), objectLODList.data());
+}
+
+void GPUScene::TermBuffers()
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    if (_vkVertexBuffer) {
+        gfx->DestroyBuffer(MemoryCategory::Buffer, _vkVertexBuffer, _vmaVertexAllocation);
+        _vkVertexBuffer = VK_NULL_HANDLE;
+        _vmaVertexAllocation = VK_NULL_HANDLE;
+    }
+
+    if (_vkIndexBuffer) {
+        gfx->DestroyBuffer(MemoryCategory::Buffer, _vkIndexBuffer, _vmaIndexAllocation);
+        _vkIndexBuffer = VK_NULL_HANDLE;
+        _vmaIndexAllocation = VK_NULL_HANDLE;
+    }
+
+    if (_vkObjectLODBuffer) {
+        gfx->DestroyBuffer(MemoryCategory::Buffer, _vkObjectLODBuffer, _vmaObjectLODAllocation);
+        _vkObjectLODBuffer = VK_NULL_HANDLE;
+        _vmaObjectLODAllocation = VK_NULL_HANDLE;
+    }
+
+    gfx->DestroyMappedBuffer(_meshBuffer);
+    gfx->DestroyMappedBuffer(_lodBuffer);
+}
+
+void GPUScene::InitDescriptorSets()
+{
+    VkResult vkResult;
+
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    TermDescriptorSets();
+
+    Array<VkDescriptorSetLayoutBinding, 6> descriptorSetLayoutBindingList = {
+        VkDescriptorSetLayoutBinding {
+            .binding = ShaderSceneObject::Binding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
+            .pImmutableSamplers = nullptr,
+        },
+        VkDescriptorSetLayoutBinding {
+            .binding = ShaderSceneMesh::Binding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
+            .pImmutableSamplers = nullptr,
+        },
+        VkDescriptorSetLayoutBinding {
+            .binding = ShaderSceneDraw::Binding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .pImmutableSamplers = nullptr,
+        },
+        VkDescriptorSetLayoutBinding {
+            .binding = ShaderSceneDrawCountBinding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .pImmutableSamplers = nullptr,
+        },
+        VkDescriptorSetLayoutBinding {
+            .binding = ShaderSceneLOD::Binding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .pImmutableSamplers = nullptr,
+        },
+        VkDescriptorSetLayoutBinding {
+            .binding = ShaderSceneObjectLODBinding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .pImmutableSamplers = nullptr,
+        },
+    };
+
+    VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .bindingCount = static_cast<uint32_t>(descriptorSetLayoutBindingList.size()),
+        .pBindings = descriptorSetLayoutBindingList.data(),
+    };
+
+    vkResult = vkCreateDescriptorSetLayout(
+        gfx->GetDevice(),
+        &descriptorSetLayoutCreateInfo,
+        nullptr,
+        &_vkDescriptorSetLayout);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkCreateDescriptorSetLayout() failed");
+    }
+}
+
+void GPUScene::TermDescriptorSets()
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    if (_vkDescriptorSetLayout) {
+        vkDestroyDescriptorSetLayout(gfx->GetDevice(), _vkDescriptorSetLayout, nullptr);
+        _vkDescriptorSetLayout = VK_NULL_HANDLE;
+    }
+}
+
+void GPUScene::InitPipelines()
+{
+    VkResult vkResult;
+
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    TermPipelines();
+
+    VkPushConstantRange cullPushConstantRange = {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = sizeof(ShaderCull),
+    };
+
+    VkPipelineLayoutCreateInfo cullPipelineLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .setLayoutCount = 1,
+        .pSetLayouts = &_vkDescriptorSetLayout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &cullPushConstantRange,
+    };
+
+    vkResult = vkCreatePipelineLayout(
+        gfx->GetDevice(),
+        &cullPipelineLayoutCreateInfo,
+        nullptr,
+        &_vkCullPipelineLayout);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkCreatePipelineLayout() failed");
+    }
+
+    VkShaderModule cullShaderModule = gfx->CreateShaderModule("Cull.comp");
+
+    VkComputePipelineCreateInfo computePipelineCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = cullShaderModule,
+            .pName = "main",
+            .pSpecializationInfo = nullptr,
+        },
+        .layout = _vkCullPipelineLayout,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = -1,
+    };
+
+    vkResult = vkCreateComputePipelines(
+        gfx->GetDevice(),
+        VK_NULL_HANDLE,
+        1,
+        &computePipelineCreateInfo,
+        nullptr,
+        &_vkCullPipeline);
+
+    vkDestroyShaderModule(gfx->GetDevice(), cullShaderModule, nullptr);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkCreateComputePipelines() failed");
+    }
+
+    // The driver's set layout is recreated along with the swap chain, but set layouts with
+    // identical definitions are compatible, so this layout stays valid
+    Array<VkDescriptorSetLayout, 2> drawDescriptorSetLayoutList = {
+        gfx->GetDescriptorSetLayout(),
+        _vkDescriptorSetLayout,
+    };
+
+    VkPushConstantRange drawPushConstantRange = {
+        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        .offset = 0,
+        .size = sizeof(ShaderMesh),
+    };
+
+    VkPipelineLayoutCreateInfo drawPipelineLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .setLayoutCount = static_cast<uint32_t>(drawDescriptorSetLayoutList.size()),
+        .pSetLayouts = drawDescriptorSetLayoutList.data(),
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &drawPushConstantRange,
+    };
+
+    vkResult = vkCreatePipelineLayout(
+        gfx->GetDevice(),
+        &drawPipelineLayoutCreateInfo,
+        nullptr,
+        &_vkDrawPipelineLayout);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkCreatePipelineLayout() failed");
+    }
+
+    // Likewise, the pipeline stays compatible with the render pass as long as the swap chain
+    // keeps its formats
+    _vkDrawPipeline = gfx->CreateMeshPipeline(_vertexFormat, "Scene.vert", _vkDrawPipelineLayout);
+}
+
+void GPUScene::TermPipelines()
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    if (_vkDrawPipeline) {
+        vkDestroyPipeline(gfx->GetDevice(), _vkDrawPipeline, nullptr);
+        _vkDrawPipeline = VK_NULL_HANDLE;
+    }
+
+    if (_vkDrawPipelineLayout) {
+        vkDestroyPipelineLayout(gfx->GetDevice(), _vkDrawPipelineLayout, nullptr);
+        _vkDrawPipelineLayout = VK_NULL_HANDLE;
+    }
+
+    if (_vkCullPipeline) {
+        vkDestroyPipeline(gfx->GetDevice(), _vkCullPipeline, nullptr);
+        _vkCullPipeline = VK_NULL_HANDLE;
+    }
+
+    if (_vkCullPipelineLayout) {
+        vkDestroyPipelineLayout(gfx->GetDevice(), _vkCullPipelineLayout, nullptr);
+        _vkCullPipelineLayout = VK_NULL_HANDLE;
+    }
+}
+
+void GPUScene::InitFrames()
+{
+    VkResult vkResult;
+
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    TermFrames();
+
+    unsigned frameCount = gfx->GetBackbufferCount();
+
+    Array<VkDescriptorPoolSize, 1> descriptorPoolSizeList = {
+        VkDescriptorPoolSize {
+            .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 6 * frameCount,
+        },
+    };
+
+    VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .maxSets = frameCount,
+        .poolSizeCount = static_cast<uint32_t>(descriptorPoolSizeList.size()),
+        .pPoolSizes = descriptorPoolSizeList.data(),
+    };
+
+    vkResult = vkCreateDescriptorPool(
+        gfx->GetDevice(),
+        &descriptorPoolCreateInfo,
+        nullptr,
+        &_vkDescriptorPool);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkCreateDescriptorPool() failed");
+    }
+
+    _frameList.resize(frameCount);
+
+    for (auto& frame : _frameList) {
+        frame.ObjectBuffer = gfx->CreateMappedBuffer(
+            _maxObjectCount * sizeof(ShaderSceneObject),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            MemoryCategory::Buffer);
+
+        CreateDeviceBuffer(
+            _maxObjectCount * sizeof(ShaderSceneDraw),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            &frame.DrawBuffer,
+            &frame.DrawAllocation);
+
+        CreateDeviceBuffer(
+            2 * sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            &frame.DrawCountBuffer,
+            &frame.DrawCountAllocation);
+
+        frame.ReadbackBuffer = gfx->CreateMappedBuffer(
+            2 * sizeof(uint32_t),
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VMA_MEMORY_USAGE_GPU_TO_CPU,
+            MemoryCategory::Buffer);
+
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .descriptorPool = _vkDescriptorPool,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &_vkDescriptorSetLayout,
+        };
+
+        vkResult = vkAllocateDescriptorSets(
+            gfx->GetDevice(),
+            &descriptorSetAllocateInfo,
+            &frame.DescriptorSet);
+
+        if (vkResult != VK_SUCCESS) {
+            throw Exception("vkAllocateDescriptorSets() failed");
+        }
+
+        Array<VkDescriptorBufferInfo, 6> bufferInfoList = {
+            VkDescriptorBufferInfo {
+                .buffer = frame.ObjectBuffer.Buffer,
+                .offset = 0,
+                .range = VK_WHOLE_SIZE,
+            },
+            VkDescriptorBufferInfo {
+                .buffer = _meshBuffer.Buffer,
+                .offset = 0,
+                .range = VK_WHOLE_SIZE,
+            },
+            VkDescriptorBufferInfo {
+                .buffer = frame.DrawBuffer,
+                .offset = 0,
+                .range = VK_WHOLE_SIZE,
+            },
+            VkDescriptorBufferInfo {
+                .buffer = frame.DrawCountBuffer,
+                .offset = 0,
+                .range = VK_WHOLE_SIZE,
+            },
+            VkDescriptorBufferInfo {
+                .buffer = _lodBuffer.Buffer,
+                .offset = 0,
+                .range = VK_WHOLE_SIZE,
+            },
+            VkDescriptorBufferInfo {
+                .buffer = _vkObjectLODBuffer,
+                .offset = 0,
+                .range = VK_WHOLE_SIZE,
+            },
+        };
+
+        Array<uint32_t, 6> bindingList = {
+            ShaderSceneObject::Binding,
+            ShaderSceneMesh::Binding,
+            ShaderSceneDraw::Binding,
+            ShaderSceneDrawCountBinding,
+            ShaderSceneLOD::Binding,
+            ShaderSceneObjectLODBinding,
+        };
+
+        Array<VkWriteDescriptorSet, 6> writeDescriptorSetList;
+        for (size_t i = 0; i < writeDescriptorSetList.size(); ++i) {
+            writeDescriptorSetList[i] = {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .pNext = nullptr,
+                .dstSet = frame.DescriptorSet,
+                .dstBinding = bindingList[i],
+                .dstArrayElement = 0,
+                .descriptorCount = 1,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo = &bufferInfoList[i],
+            };
+        }
+
+        vkUpdateDescriptorSets(
+            gfx->GetDevice(),
+            static_cast<uint32_t>(writeDescriptorSetList.size()),
+            writeDescriptorSetList.data(),
+            0,
+            nullptr);
+    }
+
+    // The new object buffers start out empty
+    for (uint32_t i = 0; i < _objectList.size(); ++i) {
+        _objectDirtyMaskList[i] = 0;
+        MarkObjectDirty(i);
+    }
+}
+
+void GPUScene::TermFrames()
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    for (auto& frame : _frameList) {
+        gfx->DestroyMappedBuffer(frame.ObjectBuffer);
+        gfx->DestroyMappedBuffer(frame.ReadbackBuffer);
+
+        if (frame.DrawBuffer) {
+            gfx->DestroyBuffer(MemoryCategory::Buffer, frame.DrawBuffer, frame.DrawAllocation);
+        }
+
+        if (frame.DrawCountBuffer) {
+            gfx->DestroyBuffer(MemoryCategory::Buffer, frame.DrawCountBuffer, frame.DrawCountAllocation);
+        }
+    }
+
+    _frameList.clear();
+
+    // The descriptor sets are freed along with the pool
+    if (_vkDescriptorPool) {
+        vkDestroyDescriptorPool(gfx->GetDevice(), _vkDescriptorPool, nullptr);
+        _vkDescriptorPool = VK_NULL_HANDLE;
+    }
+}
+
+} // namespace noon
@@ -1,8 +1,12 @@
 #include <Noon/GraphicsDriver.hpp>
 #include <Noon/Application.hpp>
+#include <Noon/Buffer.hpp>
+#include <Noon/Defragmenter.hpp>
 #include <Noon/Exception.hpp>
+#include <Noon/GPUScene.hpp>
 #include <Noon/Noon.hpp>
 #include <Noon/Log.hpp>
+#include <Noon/MappedFile.hpp>
 
 #include <SDL_vulkan.h>
 
@@ -13,6 +17,9 @@ NOON_DISABLE_WARNINGS()
 
 NOON_ENABLE_WARNINGS()
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <set>
 
 namespace noon {
@@ -22,11 +29,20 @@ using std::set;
 NOON_API
 GraphicsDriver::GraphicsDriver()
 {
+    _renderQueue = std::make_unique<RenderQueue>();
+    _pendingRenderQueue = std::make_unique<RenderQueue>();
+
+    SetView(Mat4(1.0f), Mat4(1.0f));
+    _shaderView = _pendingShaderView;
+
     InitWindow();
     InitInstance();
     InitSurface();
     InitDevice();
     InitAllocator();
+    InitMemoryPools();
+    InitDefragmenter();
+    InitShaderBundles();
     InitSwapChain();
     InitSyncObjects();
 }
@@ -36,8 +52,14 @@ GraphicsDriver::~GraphicsDriver()
 {
     vkDeviceWaitIdle(_vkDevice);
 
+    _defaultVertexBuffer.reset();
+
+    TermSamplers();
     TermSyncObjects();
     TermSwapChain();
+    TermShaderBundles();
+    TermDefragmenter();
+    TermMemoryPools();
     TermAllocator();
     TermDevice();
     TermSurface();
@@ -56,24 +78,670 @@ void GraphicsDriver::SetWindowTitle(const String& title)
 
 void GraphicsDriver::SetWindowSize(const Vec2i& size)
 {
-    _windowSize = size;
-
     if (_sdlWindow) {
         SDL_SetWindowSize(_sdlWindow, size.x, size.y);
 
-        // TODO: Investigate
-        ResetSwapChain();
+        std::lock_guard lock(_resizeMutex);
+        _pendingWindowSize = size;
+        _swapChainOutOfDate = true;
+    }
+    else {
+        _windowSize = size;
     }
 }
 
 void GraphicsDriver::SetBackbufferCount(unsigned backbufferCount)
 {
+    std::lock_guard lock(_queueMutex);
+
     _backbufferCount = backbufferCount;
-    
+
     // TODO: Investigate
     ResetSwapChain();
 }
 
+bool GraphicsDriver::LoadShaderBundle(const Path& filename)
+{
+    Path path = FindAssetFile(filename);
+    if (path.IsEmpty()) {
+        return false;
+    }
+
+    auto bundle = std::make_unique<ShaderBundle>();
+    if (!bundle->Open(path)) {
+        return false;
+    }
+
+    Log(NOON_ANCHOR, "Loaded {} shaders from '{}'", bundle->GetShaderCount(), path);
+
+    _shaderBundleList.push_back(std::move(bundle));
+    return true;
+}
+
+Span<const uint32_t> GraphicsDriver::FindShader(StringView name) const
+{
+    for (const auto& bundle : _shaderBundleList) {
+        auto code = bundle->FindShader(name);
+        if (!code.empty()) {
+            return code;
+        }
+    }
+
+    return {};
+}
+
+VkShaderModule GraphicsDriver::CreateShaderModule(StringView name)
+{
+    VkResult vkResult;
+
+    auto code = FindShader(name);
+
+    // Without NOON_SHADER_BUNDLE, or for shaders no bundle has, load the compiled .spv file.
+    // The mapping is page-aligned, so it can be passed to Vulkan as it is.
+    MappedFile looseFile;
+    if (code.empty()) {
+        Path path = FindAssetFile(fmt::format("Shader/{}.spv", name));
+        if (path.IsEmpty() || !looseFile.Open(path)) {
+            throw Exception("Unable to find shader '{}'", name);
+        }
+
+        if (looseFile.GetSize() == 0 || (looseFile.GetSize() % sizeof(uint32_t)) != 0) {
+            throw Exception("Shader '{}' is not valid SPIR-V", path);
+        }
+
+        code = Span<const uint32_t>(
+            reinterpret_cast<const uint32_t *>(looseFile.GetData()),
+            looseFile.GetSize() / sizeof(uint32_t));
+    }
+
+    // The code is read straight out of the bundle's or the file's mapping
+    VkShaderModuleCreateInfo shaderModuleCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .codeSize = code.size_bytes(),
+        .pCode = code.data(),
+    };
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+
+    vkResult = vkCreateShaderModule(
+        _vkDevice,
+        &shaderModuleCreateInfo,
+        nullptr,
+        &shaderModule);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkCreateShaderModule() failed for shader '{}'", name);
+    }
+
+    return shaderModule;
+}
+
+VkPipeline GraphicsDriver::GetMeshPipeline(const VertexFormat& vertexFormat)
+{
+    uint64_t hash = vertexFormat.GetHash();
+
+    auto it = _vkMeshPipelineMap.find(hash);
+    if (it != _vkMeshPipelineMap.end()) {
+        return it->second;
+    }
+
+    VkPipeline pipeline = CreateMeshPipeline(vertexFormat, "Default.vert", _vkPipelineLayout);
+
+    _vkMeshPipelineMap.emplace(hash, pipeline);
+    return pipeline;
+}
+
+VkPipeline GraphicsDriver::CreateMeshPipeline(
+    const VertexFormat& vertexFormat,
+    StringView vertexShaderName,
+    VkPipelineLayout pipelineLayout)
+{
+    VkResult vkResult;
+
+    VkShaderModule vertexShaderModule = CreateShaderModule(vertexShaderName);
+    VkShaderModule fragmentShaderModule = CreateShaderModule("Default.frag");
+
+    // Selects how the normals and tangents are decoded, see VertexAttributes.inc.glsl
+    VertexSpecialization specialization = vertexFormat.GetSpecialization();
+
+    Array<VkSpecializationMapEntry, 2> specializationMapEntryList = {
+        VkSpecializationMapEntry {
+            .constantID = 0,
+            .offset = offsetof(VertexSpecialization, OctahedralNormal),
+            .size = sizeof(VkBool32),
+        },
+        VkSpecializationMapEntry {
+            .constantID = 1,
+            .offset = offsetof(VertexSpecialization, OctahedralTangent),
+            .size = sizeof(VkBool32),
+        },
+    };
+
+    VkSpecializationInfo specializationInfo = {
+        .mapEntryCount = static_cast<uint32_t>(specializationMapEntryList.size()),
+        .pMapEntries = specializationMapEntryList.data(),
+        .dataSize = sizeof(specialization),
+        .pData = &specialization,
+    };
+
+    Array<VkPipelineShaderStageCreateInfo, 2> shaderStageCreateInfoList = {
+        VkPipelineShaderStageCreateInfo {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .stage = VK_SHADER_STAGE_VERTEX_BIT,
+            .module = vertexShaderModule,
+            .pName = "main",
+            .pSpecializationInfo = &specializationInfo,
+        },
+        VkPipelineShaderStageCreateInfo {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .module = fragmentShaderModule,
+            .pName = "main",
+            .pSpecializationInfo = nullptr,
+        },
+    };
+
+    auto bindingDescriptionList = vertexFormat.GetBindingDescriptionList();
+    auto attributeDescriptionList = vertexFormat.GetAttributeDescriptionList();
+
+    VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptionList.size()),
+        .pVertexBindingDescriptions = bindingDescriptionList.data(),
+        .vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptionList.size()),
+        .pVertexAttributeDescriptions = attributeDescriptionList.data(),
+    };
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+        .primitiveRestartEnable = VK_FALSE,
+    };
+
+    // Set with vkCmdSetViewport/vkCmdSetScissor
+    VkPipelineViewportStateCreateInfo viewportStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .viewportCount = 1,
+        .pViewports = nullptr,
+        .scissorCount = 1,
+        .pScissors = nullptr,
+    };
+
+    VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .depthClampEnable = VK_FALSE,
+        .rasterizerDiscardEnable = VK_FALSE,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = VK_CULL_MODE_BACK_BIT,
+        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+        .depthBiasEnable = VK_FALSE,
+        .lineWidth = 1.0f,
+    };
+
+    VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+        .sampleShadingEnable = VK_FALSE,
+    };
+
+    VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .depthTestEnable = VK_TRUE,
+        .depthWriteEnable = VK_TRUE,
+        .depthCompareOp = VK_COMPARE_OP_LESS,
+        .depthBoundsTestEnable = VK_FALSE,
+        .stencilTestEnable = VK_FALSE,
+    };
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachmentState = {
+        .blendEnable = VK_FALSE,
+        .colorWriteMask = (
+            VK_COLOR_COMPONENT_R_BIT |
+            VK_COLOR_COMPONENT_G_BIT |
+            VK_COLOR_COMPONENT_B_BIT |
+            VK_COLOR_COMPONENT_A_BIT
+        ),
+    };
+
+    VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .logicOpEnable = VK_FALSE,
+        .attachmentCount = 1,
+        .pAttachments = &colorBlendAttachmentState,
+    };
+
+    Array<VkDynamicState, 2> dynamicStateList = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR,
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .dynamicStateCount = static_cast<uint32_t>(dynamicStateList.size()),
+        .pDynamicStates = dynamicStateList.data(),
+    };
+
+    VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .stageCount = static_cast<uint32_t>(shaderStageCreateInfoList.size()),
+        .pStages = shaderStageCreateInfoList.data(),
+        .pVertexInputState = &vertexInputStateCreateInfo,
+        .pInputAssemblyState = &inputAssemblyStateCreateInfo,
+        .pTessellationState = nullptr,
+        .pViewportState = &viewportStateCreateInfo,
+        .pRasterizationState = &rasterizationStateCreateInfo,
+        .pMultisampleState = &multisampleStateCreateInfo,
+        .pDepthStencilState = &depthStencilStateCreateInfo,
+        .pColorBlendState = &colorBlendStateCreateInfo,
+        .pDynamicState = &dynamicStateCreateInfo,
+        .layout = pipelineLayout,
+        .renderPass = _vkRenderPass,
+        .subpass = 0,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = -1,
+    };
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+
+    vkResult = vkCreateGraphicsPipelines(
+        _vkDevice,
+        VK_NULL_HANDLE,
+        1,
+        &graphicsPipelineCreateInfo,
+        nullptr,
+        &pipeline);
+
+    vkDestroyShaderModule(_vkDevice, vertexShaderModule, nullptr);
+    vkDestroyShaderModule(_vkDevice, fragmentShaderModule, nullptr);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkCreateGraphicsPipelines() failed for vertex format {}", vertexFormat.ToString());
+    }
+
+    Log(NOON_ANCHOR, "Created mesh pipeline for '{}' and vertex format {}", vertexShaderName, vertexFormat.ToString());
+
+    return pipeline;
+}
+
+Buffer * GraphicsDriver::GetDefaultVertexBuffer()
+{
+    // Buffers need the driver to exist, so this can't be created during construction
+    if (!_defaultVertexBuffer) {
+        auto defaultVertex = VertexFormat::GetDefaultVertex();
+
+        _defaultVertexBuffer = std::make_unique<Buffer>(
+            defaultVertex.size(),
+            defaultVertex.data(),
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY);
+    }
+
+    return _defaultVertexBuffer.get();
+}
+
+MemoryStats GraphicsDriver::GetMemoryStats() const
+{
+    MemoryStats stats;
+
+    {
+        std::lock_guard lock(_memoryMutex);
+        stats.HeapList = _memoryHeapBudgetList;
+    }
+
+    for (size_t i = 0; i < MemoryCategoryCount; ++i) {
+        stats.CategoryList[i] = {
+            .Bytes = _memoryCategoryBytes[i].load(),
+            .AllocationCount = _memoryCategoryCount[i].load(),
+        };
+    }
+
+    for (size_t i = 0; i < MemoryPoolCount; ++i) {
+        stats.PoolList[i] = { };
+
+        if (_vmaPoolList[i]) {
+            VmaPoolStats poolStats;
+            vmaGetPoolStats(_vmaAllocator, _vmaPoolList[i], &poolStats);
+
+            stats.PoolList[i] = {
+                .Bytes = poolStats.size,
+                .UnusedBytes = poolStats.unusedSize,
+                .LargestFreeBytes = poolStats.unusedRangeSizeMax,
+                .AllocationCount = static_cast<uint32_t>(poolStats.allocationCount),
+                .BlockCount = static_cast<uint32_t>(poolStats.blockCount),
+            };
+        }
+    }
+
+    return stats;
+}
+
+void GraphicsDriver::LogMemoryStats() const
+{
+    constexpr double MB = 1024.0 * 1024.0;
+
+    const auto& stats = GetMemoryStats();
+
+    Log(NOON_ANCHOR, "Memory Heaps:");
+    for (size_t i = 0; i < stats.HeapList.size(); ++i) {
+        const auto& heap = stats.HeapList[i];
+        Log(NOON_ANCHOR, "\t#{}: {:.1f}/{:.1f} MB used, {:.1f} MB in blocks, {:.1f} MB allocated{}{}",
+            i,
+            heap.Usage / MB,
+            heap.Budget / MB,
+            heap.BlockBytes / MB,
+            heap.AllocationBytes / MB,
+            (heap.IsDeviceLocal ? " DeviceLocal" : ""),
+            (heap.IsOverBudget ? " OverBudget" : ""));
+    }
+
+    Log(NOON_ANCHOR, "Memory Categories:");
+    for (size_t i = 0; i < MemoryCategoryCount; ++i) {
+        const auto& category = stats.CategoryList[i];
+        Log(NOON_ANCHOR, "\t{}: {:.1f} MB in {} allocations",
+            MemoryCategoryToString(static_cast<MemoryCategory>(i)),
+            category.Bytes / MB,
+            category.AllocationCount);
+    }
+
+    Log(NOON_ANCHOR, "Memory Pools:");
+    for (size_t i = 0; i < MemoryPoolCount; ++i) {
+        if (!_vmaPoolList[i]) {
+            continue;
+        }
+
+        const auto& pool = stats.PoolList[i];
+        Log(NOON_ANCHOR, "\t{}: {:.1f}/{:.1f} MB used in {} blocks, {:.1f} MB largest free range, {} allocations",
+            MemoryPoolToString(static_cast<MemoryPool>(i)),
+            (pool.Bytes - pool.UnusedBytes) / MB,
+            pool.Bytes / MB,
+            pool.BlockCount,
+            pool.LargestFreeBytes / MB,
+            pool.AllocationCount);
+    }
+}
+
+unsigned GraphicsDriver::AddMemoryEvictionCallback(MemoryEvictionCallback callback)
+{
+    std::lock_guard lock(_memoryMutex);
+
+    unsigned id = _nextMemoryEvictionCallbackId++;
+    _memoryEvictionCallbackList.emplace_back(id, std::move(callback));
+    return id;
+}
+
+void GraphicsDriver::RemoveMemoryEvictionCallback(unsigned id)
+{
+    std::lock_guard lock(_memoryMutex);
+
+    std::erase_if(_memoryEvictionCallbackList,
+        [id](const auto& pair) {
+            return pair.first == id;
+        }
+    );
+}
+
+VkDeviceSize GraphicsDriver::EvictMemory(uint32_t heapIndex, VkDeviceSize bytesRequested)
+{
+    std::lock_guard lock(_memoryMutex);
+
+    VkDeviceSize bytesReleased = 0;
+
+    // Callbacks are asked in the order they were added, until enough memory is released
+    for (const auto& [id, callback] : _memoryEvictionCallbackList) {
+        if (bytesReleased >= bytesRequested) {
+            break;
+        }
+
+        bytesReleased += callback(heapIndex, bytesRequested - bytesReleased);
+    }
+
+    return bytesReleased;
+}
+
+uint32_t GraphicsDriver::GetMemoryHeapIndex(uint32_t memoryTypeIndex) const
+{
+    const VkPhysicalDeviceMemoryProperties * memoryProperties = nullptr;
+    vmaGetMemoryProperties(_vmaAllocator, &memoryProperties);
+
+    return memoryProperties->memoryTypes[memoryTypeIndex].heapIndex;
+}
+
+VkResult GraphicsDriver::CreateBuffer(
+    MemoryCategory category,
+    const VkBufferCreateInfo * bufferCreateInfo,
+    const VmaAllocationCreateInfo * allocationCreateInfo,
+    VkBuffer * buffer,
+    VmaAllocation * allocation,
+    VmaAllocationInfo * allocationInfo)
+{
+    VkResult vkResult;
+
+    VmaAllocationCreateInfo poolAllocationCreateInfo = *allocationCreateInfo;
+
+    MemoryPool pool = FindMemoryPool(poolAllocationCreateInfo.pool);
+    if (pool != MemoryPool::Default) {
+        // The pool's memory type was chosen for a superset of these usages, which the spec
+        // guarantees is compatible with any subset of them
+        VkBufferUsageFlags supportedUsage = _memoryPoolBufferUsageList[static_cast<size_t>(pool)];
+
+        if ((bufferCreateInfo->usage & ~supportedUsage) != 0) {
+            poolAllocationCreateInfo.pool = VK_NULL_HANDLE;
+            pool = MemoryPool::Default;
+        }
+    }
+
+    if (pool == MemoryPool::Streaming) {
+        poolAllocationCreateInfo.flags |= VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+    }
+
+    vkResult = vmaCreateBuffer(
+        _vmaAllocator,
+        bufferCreateInfo,
+        &poolAllocationCreateInfo,
+        buffer,
+        allocation,
+        allocationInfo);
+
+    if (vkResult == VK_ERROR_OUT_OF_DEVICE_MEMORY && IsRingMemoryPool(pool)) {
+        // The ring is full, most likely because something is being held for too many frames
+        poolAllocationCreateInfo.pool = VK_NULL_HANDLE;
+
+        vkResult = vmaCreateBuffer(
+            _vmaAllocator,
+            bufferCreateInfo,
+            &poolAllocationCreateInfo,
+            buffer,
+            allocation,
+            allocationInfo);
+    }
+
+    if (vkResult == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
+        uint32_t memoryTypeIndex = 0;
+        vkResult = vmaFindMemoryTypeIndexForBufferInfo(
+            _vmaAllocator,
+            bufferCreateInfo,
+            &poolAllocationCreateInfo,
+            &memoryTypeIndex);
+
+        if (vkResult != VK_SUCCESS) {
+            return vkResult;
+        }
+
+        uint32_t heapIndex = GetMemoryHeapIndex(memoryTypeIndex);
+        if (EvictMemory(heapIndex, bufferCreateInfo->size) == 0) {
+            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+
+        vkResult = vmaCreateBuffer(
+            _vmaAllocator,
+            bufferCreateInfo,
+            &poolAllocationCreateInfo,
+            buffer,
+            allocation,
+            allocationInfo);
+    }
+
+    if (vkResult == VK_SUCCESS) {
+        TrackAllocation(category, *allocation);
+    }
+
+    return vkResult;
+}
+
+void GraphicsDriver::DestroyBuffer(MemoryCategory category, VkBuffer buffer, VmaAllocation allocation)
+{
+    if (allocation) {
+        UntrackAllocation(category, allocation);
+    }
+
+    vmaDestroyBuffer(_vmaAllocator, buffer, allocation);
+}
+
+VkResult GraphicsDriver::CreateImage(
+    MemoryCategory category,
+    const VkImageCreateInfo * imageCreateInfo,
+    const VmaAllocationCreateInfo * allocationCreateInfo,
+    VkImage * image,
+    VmaAllocation * allocation,
+    VmaAllocationInfo * allocationInfo)
+{
+    VkResult vkResult;
+
+    VmaAllocationCreateInfo poolAllocationCreateInfo = *allocationCreateInfo;
+
+    // The size and memory types of an image aren't known until it has been created, so they
+    // are only queried when needed
+    VkMemoryRequirements memoryRequirements = { };
+
+    MemoryPool pool = FindMemoryPool(poolAllocationCreateInfo.pool);
+    if (pool != MemoryPool::Default) {
+        vkResult = GetImageMemoryRequirements(imageCreateInfo, &memoryRequirements);
+        if (vkResult != VK_SUCCESS) {
+            return vkResult;
+        }
+
+        uint32_t memoryTypeIndex = _memoryPoolTypeIndexList[static_cast<size_t>(pool)];
+        if ((memoryRequirements.memoryTypeBits & (1u << memoryTypeIndex)) == 0) {
+            poolAllocationCreateInfo.pool = VK_NULL_HANDLE;
+            pool = MemoryPool::Default;
+        }
+    }
+
+    if (pool == MemoryPool::Streaming) {
+        poolAllocationCreateInfo.flags |= VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+    }
+
+    vkResult = vmaCreateImage(
+        _vmaAllocator,
+        imageCreateInfo,
+        &poolAllocationCreateInfo,
+        image,
+        allocation,
+        allocationInfo);
+
+    if (vkResult == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
+        if (memoryRequirements.size == 0) {
+            vkResult = GetImageMemoryRequirements(imageCreateInfo, &memoryRequirements);
+            if (vkResult != VK_SUCCESS) {
+                return vkResult;
+            }
+        }
+
+        uint32_t memoryTypeIndex = 0;
+        vkResult = vmaFindMemoryTypeIndex(
+            _vmaAllocator,
+            memoryRequirements.memoryTypeBits,
+            &poolAllocationCreateInfo,
+            &memoryTypeIndex);
+
+        if (vkResult != VK_SUCCESS) {
+            return vkResult;
+        }
+
+        uint32_t heapIndex = GetMemoryHeapIndex(memoryTypeIndex);
+        if (EvictMemory(heapIndex, memoryRequirements.size) == 0) {
+            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+
+        vkResult = vmaCreateImage(
+            _vmaAllocator,
+            imageCreateInfo,
+            &poolAllocationCreateInfo,
+            image,
+            allocation,
+            allocationInfo);
+    }
+
+    if (vkResult == VK_SUCCESS) {
+        TrackAllocation(category, *allocation);
+    }
+
+    return vkResult;
+}
+
+void GraphicsDriver::DestroyImage(MemoryCategory category, VkImage image, VmaAllocation allocation)
+{
+    if (allocation) {
+        UntrackAllocation(category, allocation);
+    }
+
+    vmaDestroyImage(_vmaAllocator, image, allocation);
+}
+
+void GraphicsDriver::SetView(const Mat4& view, const Mat4& projection)
+{
+    _pendingShaderView.View = view;
+    _pendingShaderView.Projection = projection;
+    _pendingShaderView.ViewProjection = projection * view;
+    _pendingShaderView.CameraPosition = glm::inverse(view)[3];
+}
+
+void GraphicsDriver::SwapRenderSnapshot()
+{
+    std::swap(_renderQueue, _pendingRenderQueue);
+    _pendingRenderQueue->Clear();
+
+    _shaderView = _pendingShaderView;
+}
+
+void GraphicsDriver::AddGPUScene(GPUScene * scene)
+{
+    if (std::find(_gpuSceneList.begin(), _gpuSceneList.end(), scene) == _gpuSceneList.end()) {
+        _gpuSceneList.push_back(scene);
+    }
+}
+
+void GraphicsDriver::RemoveGPUScene(GPUScene * scene)
+{
+    _gpuSceneList.erase(
+        std::remove(_gpuSceneList.begin(), _gpuSceneList.end(), scene),
+        _gpuSceneList.end());
+}
+
 void GraphicsDriver::ProcessEvents()
 {
     SDL_Event event;
@@ -84,12 +752,12 @@ void GraphicsDriver::ProcessEvents()
 
         if (event.type == SDL_WINDOWEVENT) {
             switch (event.window.event) {
-                case SDL_WINDOWEVENT_RESIZED:
-                    _windowSize.x = event.window.data1;
-                    _windowSize.y = event.window.data2;
-
-                    ResetSwapChain();
+                case SDL_WINDOWEVENT_RESIZED: {
+                    std::lock_guard lock(_resizeMutex);
+                    _pendingWindowSize = { event.window.data1, event.window.data2 };
+                    _swapChainOutOfDate = true;
                     break;
+                }
             }
         }
     }
@@ -99,10 +767,27 @@ void GraphicsDriver::Render()
 {
     VkResult vkResult;
 
-    UpdateShaderGlobals();
+    // Only the queues and the command pool are shared with uploads on other threads, so
+    // _queueMutex is held around their use rather than for the whole frame
+
+    bool swapChainOutOfDate = false;
+    {
+        std::lock_guard lock(_resizeMutex);
+        if (_swapChainOutOfDate) {
+            _windowSize = _pendingWindowSize;
+            _swapChainOutOfDate = false;
+            swapChainOutOfDate = true;
+        }
+    }
+
+    if (swapChainOutOfDate) {
+        ResetSwapChain();
+    }
 
     vmaSetCurrentFrameIndex(_vmaAllocator, _backbufferIndex);
 
+    UpdateMemoryBudget();
+
     vkWaitForFences(
         _vkDevice,
         1,
@@ -110,6 +795,8 @@ void GraphicsDriver::Render()
         VK_TRUE,
         UINT64_MAX);
 
+    _defragmenter->Update();
+
     uint32_t imageIndex = 0;
 
     vkResult = vkAcquireNextImageKHR(
@@ -138,6 +825,18 @@ void GraphicsDriver::Render()
 
     _vkImageInFlightList[imageIndex] = _vkInFlightFenceList[_backbufferIndex];
 
+    // Both the frame's buffers and the image's command buffer are no longer in use
+    UpdateShaderGlobals();
+    UpdateShaderView();
+    UpdateInstanceBuffer();
+
+    {
+        std::lock_guard queueLock(_queueMutex);
+        RecordCommandBuffer(imageIndex);
+    }
+
+    _renderQueue->Clear();
+
     // "Present Complete"
     Array<VkSemaphore, 1> waitSemaphoreList = {
         _vkImageAvailableSemaphoreList[_backbufferIndex],
@@ -166,6 +865,8 @@ void GraphicsDriver::Render()
 
     vkResetFences(_vkDevice, 1, &_vkInFlightFenceList[_backbufferIndex]);
 
+    std::unique_lock queueLock(_queueMutex);
+
     vkResult = vkQueueSubmit(
         _vkGraphicsQueue,
         1,
@@ -187,6 +888,9 @@ void GraphicsDriver::Render()
     };
 
     vkResult = vkQueuePresentKHR(_vkPresentQueue, &presentInfo);
+
+    queueLock.unlock();
+
     if (vkResult == VK_ERROR_OUT_OF_DATE_KHR || vkResult == VK_SUBOPTIMAL_KHR) {
         ResetSwapChain();
     }
@@ -195,12 +899,27 @@ void GraphicsDriver::Render()
     }
 
     _backbufferIndex = (_backbufferIndex + 1) % _backbufferCount;
+    ++_frameCount;
 }
 
-void GraphicsDriver::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+void GraphicsDriver::SubmitTransfer(const VkSubmitInfo& submitInfo, VkFence fence)
 {
     VkResult vkResult;
 
+    std::lock_guard queueLock(_queueMutex);
+
+    vkResult = vkQueueSubmit(_vkTransferQueue, 1, &submitInfo, fence);
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkQueueSubmit() failed");
+    }
+}
+
+void GraphicsDriver::RunOneTimeCommands(const std::function<void(VkCommandBuffer)>& record)
+{
+    VkResult vkResult;
+
+    std::lock_guard queueLock(_queueMutex);
+
     VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
         .pNext = nullptr,
@@ -231,18 +950,7 @@ void GraphicsDriver::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDevice
         throw Exception("vkBeginCommandBuffer() failed");
     }
 
-    VkBufferCopy bufferCopyRegion = {
-        .srcOffset = 0,
-        .dstOffset = 0,
-        .size = size,
-    };
-
-    vkCmdCopyBuffer(
-        commandBuffer,
-        srcBuffer,
-        dstBuffer,
-        1,
-        &bufferCopyRegion);
+    record(commandBuffer);
 
     vkResult = vkEndCommandBuffer(commandBuffer);
     if (vkResult != VK_SUCCESS) {
@@ -262,22 +970,335 @@ void GraphicsDriver::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDevice
         &submitInfo,
         nullptr);
 
-    if (vkResult != VK_SUCCESS) {
-        throw Exception("vkQueueSubmit() failed");
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkQueueSubmit() failed");
+    }
+
+    vkQueueWaitIdle(_vkGraphicsQueue);
+
+    vkFreeCommandBuffers(
+        _vkDevice,
+        _vkCommandPool,
+        1,
+        &commandBuffer);
+}
+
+void GraphicsDriver::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize dstOffset)
+{
+    RunOneTimeCommands(
+        [&](VkCommandBuffer commandBuffer) {
+            VkBufferCopy bufferCopyRegion = {
+                .srcOffset = 0,
+                .dstOffset = dstOffset,
+                .size = size,
+            };
+
+            vkCmdCopyBuffer(
+                commandBuffer,
+                srcBuffer,
+                dstBuffer,
+                1,
+                &bufferCopyRegion);
+        }
+    );
+}
+
+VkSampler GraphicsDriver::GetSampler(const SamplerDesc& desc)
+{
+    VkResult vkResult;
+
+    std::lock_guard lock(_samplerMutex);
+
+    uint64_t key = desc.GetKey();
+
+    auto it = _vkSamplerMap.find(key);
+    if (it != _vkSamplerMap.end()) {
+        return it->second;
+    }
+
+    float maxAnisotropy = std::min(
+        static_cast<float>(desc.MaxAnisotropy),
+        _vkPhysicalDeviceProperties.limits.maxSamplerAnisotropy);
+
+    bool anisotropyEnable = (_vkPhysicalDeviceFeatures.samplerAnisotropy && maxAnisotropy > 1.0f);
+
+    VkSamplerCreateInfo samplerCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .magFilter = desc.MagFilter,
+        .minFilter = desc.MinFilter,
+        .mipmapMode = desc.MipmapMode,
+        .addressModeU = desc.AddressModeU,
+        .addressModeV = desc.AddressModeV,
+        .addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        .mipLodBias = 0.0f,
+        .anisotropyEnable = anisotropyEnable,
+        .maxAnisotropy = (anisotropyEnable ? maxAnisotropy : 1.0f),
+        .compareEnable = VK_FALSE,
+        .compareOp = VK_COMPARE_OP_ALWAYS,
+        .minLod = 0.0f,
+        .maxLod = VK_LOD_CLAMP_NONE,
+        .borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
+        .unnormalizedCoordinates = VK_FALSE,
+    };
+
+    VkSampler sampler = VK_NULL_HANDLE;
+
+    vkResult = vkCreateSampler(_vkDevice, &samplerCreateInfo, nullptr, &sampler);
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkCreateSampler() failed");
+    }
+
+    _vkSamplerMap.emplace(key, sampler);
+
+    return sampler;
+}
+
+GraphicsDriver::MappedBuffer GraphicsDriver::CreateMappedBuffer(
+    VkDeviceSize size,
+    VkBufferUsageFlags bufferUsageFlags,
+    VmaMemoryUsage memoryUsage,
+    MemoryCategory category)
+{
+    VkResult vkResult;
+
+    VkBufferCreateInfo bufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .size = size,
+        .usage = bufferUsageFlags,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    VmaAllocationCreateInfo allocationCreateInfo = {
+        .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .usage = memoryUsage,
+    };
+
+    VmaAllocationInfo allocationInfo;
+
+    MappedBuffer buffer;
+    buffer.Category = category;
+
+    vkResult = CreateBuffer(
+        category,
+        &bufferCreateInfo,
+        &allocationCreateInfo,
+        &buffer.Buffer,
+        &buffer.Allocation,
+        &allocationInfo);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vmaCreateBuffer() failed, unable to create mapped buffer");
+    }
+
+    buffer.Data = static_cast<uint8_t *>(allocationInfo.pMappedData);
+    buffer.Size = size;
+
+    memset(buffer.Data, 0, size);
+
+    return buffer;
+}
+
+void GraphicsDriver::DestroyMappedBuffer(MappedBuffer& buffer)
+{
+    if (buffer.Buffer) {
+        DestroyBuffer(buffer.Category, buffer.Buffer, buffer.Allocation);
+    }
+
+    buffer = MappedBuffer();
+}
+
+void GraphicsDriver::UpdateShaderGlobals()
+{
+    auto& buffer = _globalsBufferList[_backbufferIndex];
+
+    auto globals = reinterpret_cast<ShaderGlobals *>(buffer.Data);
+    globals->Resolution = Vec2(_vkSwapChainExtent.width, _vkSwapChainExtent.height);
+    globals->FrameCount = _frameCount;
+
+    vmaFlushAllocation(_vmaAllocator, buffer.Allocation, 0, VK_WHOLE_SIZE);
+}
+
+void GraphicsDriver::UpdateShaderView()
+{
+    auto& buffer = _viewBufferList[_backbufferIndex];
+
+    memcpy(buffer.Data, &_shaderView, sizeof(_shaderView));
+
+    vmaFlushAllocation(_vmaAllocator, buffer.Allocation, 0, VK_WHOLE_SIZE);
+}
+
+void GraphicsDriver::UpdateInstanceBuffer()
+{
+    _renderQueue->Build();
+
+    auto& buffer = _instanceBufferList[_backbufferIndex];
+
+    VkDeviceSize size = _renderQueue->GetInstanceCount() * sizeof(ShaderInstance);
+    if (size > buffer.Size) {
+        VkDeviceSize newSize = std::max(size, buffer.Size * 2);
+
+        DestroyMappedBuffer(buffer);
+        buffer = CreateMappedBuffer(newSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+        UpdateDescriptorSet(_backbufferIndex);
+    }
+
+    _renderQueue->WriteInstances(reinterpret_cast<ShaderInstance *>(buffer.Data));
+
+    vmaFlushAllocation(_vmaAllocator, buffer.Allocation, 0, size);
+}
+
+void GraphicsDriver::UpdateDescriptorSet(unsigned frameIndex)
+{
+    VkDescriptorBufferInfo globalsBufferInfo = {
+        .buffer = _globalsBufferList[frameIndex].Buffer,
+        .offset = 0,
+        .range = sizeof(ShaderGlobals),
+    };
+
+    VkDescriptorBufferInfo viewBufferInfo = {
+        .buffer = _viewBufferList[frameIndex].Buffer,
+        .offset = 0,
+        .range = sizeof(ShaderView),
+    };
+
+    VkDescriptorBufferInfo instanceBufferInfo = {
+        .buffer = _instanceBufferList[frameIndex].Buffer,
+        .offset = 0,
+        .range = VK_WHOLE_SIZE,
+    };
+
+    Array<VkWriteDescriptorSet, 3> writeDescriptorSetList = {
+        VkWriteDescriptorSet {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet = _vkDescriptorSetList[frameIndex],
+            .dstBinding = ShaderGlobals::Binding,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .pBufferInfo = &globalsBufferInfo,
+        },
+        VkWriteDescriptorSet {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet = _vkDescriptorSetList[frameIndex],
+            .dstBinding = ShaderView::Binding,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .pBufferInfo = &viewBufferInfo,
+        },
+        VkWriteDescriptorSet {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet = _vkDescriptorSetList[frameIndex],
+            .dstBinding = ShaderInstance::Binding,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo = &instanceBufferInfo,
+        },
+    };
+
+    vkUpdateDescriptorSets(
+        _vkDevice,
+        static_cast<uint32_t>(writeDescriptorSetList.size()),
+        writeDescriptorSetList.data(),
+        0,
+        nullptr);
+}
+
+void GraphicsDriver::UpdateMemoryBudget()
+{
+    Array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgetList;
+    vmaGetBudget(_vmaAllocator, budgetList.data());
+
+    std::lock_guard lock(_memoryMutex);
+
+    for (uint32_t i = 0; i < _memoryHeapBudgetList.size(); ++i) {
+        auto& heap = _memoryHeapBudgetList[i];
+        const auto& budget = budgetList[i];
+
+        heap.BlockBytes = budget.blockBytes;
+        heap.AllocationBytes = budget.allocationBytes;
+        heap.Usage = budget.usage;
+        heap.Budget = budget.budget;
+
+        VkDeviceSize limit = static_cast<VkDeviceSize>(heap.Budget * _memoryBudgetThreshold);
+
+        bool wasOverBudget = heap.IsOverBudget;
+        heap.IsOverBudget = (heap.Usage > limit);
+
+        if (heap.IsOverBudget) {
+            // Evict before the driver starts paging, or failing allocations
+            VkDeviceSize bytesReleased = EvictMemory(i, heap.Usage - limit);
+
+            if (!wasOverBudget) {
+                Log(NOON_ANCHOR, "Memory heap #{} is over budget, evicted {} of {} bytes",
+                    i,
+                    bytesReleased,
+                    heap.Usage - limit);
+
+                LogMemoryStats();
+            }
+        }
     }
+}
 
-    vkQueueWaitIdle(_vkGraphicsQueue);
+void GraphicsDriver::TrackAllocation(MemoryCategory category, VmaAllocation allocation)
+{
+    VmaAllocationInfo allocationInfo;
+    vmaGetAllocationInfo(_vmaAllocator, allocation, &allocationInfo);
 
-    vkFreeCommandBuffers(
-        _vkDevice,
-        _vkCommandPool,
-        1,
-        &commandBuffer);
+    size_t index = static_cast<size_t>(category);
+    _memoryCategoryBytes[index] += allocationInfo.size;
+    _memoryCategoryCount[index] += 1;
 }
 
-void GraphicsDriver::UpdateShaderGlobals()
+void GraphicsDriver::UntrackAllocation(MemoryCategory category, VmaAllocation allocation)
+{
+    VmaAllocationInfo allocationInfo;
+    vmaGetAllocationInfo(_vmaAllocator, allocation, &allocationInfo);
+
+    size_t index = static_cast<size_t>(category);
+    _memoryCategoryBytes[index] -= allocationInfo.size;
+    _memoryCategoryCount[index] -= 1;
+}
+
+MemoryPool GraphicsDriver::FindMemoryPool(VmaPool vmaPool) const
+{
+    if (vmaPool) {
+        for (size_t i = 0; i < MemoryPoolCount; ++i) {
+            if (_vmaPoolList[i] == vmaPool) {
+                return static_cast<MemoryPool>(i);
+            }
+        }
+    }
+
+    return MemoryPool::Default;
+}
+
+VkResult GraphicsDriver::GetImageMemoryRequirements(
+    const VkImageCreateInfo * imageCreateInfo,
+    VkMemoryRequirements * memoryRequirements)
 {
+    VkResult vkResult;
+
+    VkImage image = VK_NULL_HANDLE;
+    vkResult = vkCreateImage(_vkDevice, imageCreateInfo, nullptr, &image);
+    if (vkResult != VK_SUCCESS) {
+        return vkResult;
+    }
+
+    vkGetImageMemoryRequirements(_vkDevice, image, memoryRequirements);
+    vkDestroyImage(_vkDevice, image, nullptr);
 
+    return VK_SUCCESS;
 }
 
 bool GraphicsDriver::HasLayerAvailable(const char * layer)
@@ -552,7 +1573,8 @@ void GraphicsDriver::InitInstance()
             engineVersion.Minor,
             engineVersion.Patch
         ),
-        .apiVersion = VK_API_VERSION_1_1,
+        // Features from newer versions are only used if the device supports them
+        .apiVersion = VK_API_VERSION_1_2,
     };
 
     VkInstanceCreateInfo instanceCreateInfo = {
@@ -685,23 +1707,37 @@ void GraphicsDriver::FindPhysicalDevice()
         throw Exception("vkEnumeratePhysicalDevices() failed");
     }
 
+    // Prefer discrete GPUs, but accept anything down to a software implementation
+    auto getDeviceTypeScore = [](VkPhysicalDeviceType type) {
+        switch (type) {
+            case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+                return 4;
+            case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+                return 3;
+            case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+                return 2;
+            case VK_PHYSICAL_DEVICE_TYPE_CPU:
+                return 1;
+            default:
+                return 0;
+        }
+    };
+
+    int bestScore = -1;
+
     for (const auto& device : deviceList) {
-        vkGetPhysicalDeviceProperties(device, &_vkPhysicalDeviceProperties);
-        vkGetPhysicalDeviceFeatures(device, &_vkPhysicalDeviceFeatures);
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(device, &properties);
 
         // TODO:
         // * Queue Families
         // * Device Extensions
         // * Swap Chain Support
 
-        bool isSuitable = (
-            _vkPhysicalDeviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU &&
-            _vkPhysicalDeviceFeatures.geometryShader
-        );
-
-        if (isSuitable) {
+        int score = getDeviceTypeScore(properties.deviceType);
+        if (score > bestScore) {
+            bestScore = score;
             _vkPhysicalDevice = device;
-            break;
         }
     }
 
@@ -709,6 +1745,9 @@ void GraphicsDriver::FindPhysicalDevice()
         throw Exception("No suitable vulkan physical device found");
     }
 
+    vkGetPhysicalDeviceProperties(_vkPhysicalDevice, &_vkPhysicalDeviceProperties);
+    vkGetPhysicalDeviceFeatures(_vkPhysicalDevice, &_vkPhysicalDeviceFeatures);
+
     Log(NOON_ANCHOR, "Physical Device Name: {}", _vkPhysicalDeviceProperties.deviceName);
 
     // Reload glad and lookup physical device extension function addresses
@@ -742,6 +1781,7 @@ void GraphicsDriver::InitDevice()
 
     _vkGraphicsQueueFamilyIndex = UINT32_MAX;
     _vkPresentQueueFamilyIndex = UINT32_MAX;
+    _vkTransferQueueFamilyIndex = UINT32_MAX;
 
     Log(NOON_ANCHOR, "Available Vulkan Queue Families:");
     uint32_t index = 0;
@@ -763,6 +1803,14 @@ void GraphicsDriver::InitDevice()
 
         if ((queue.queueFlags & VK_QUEUE_TRANSFER_BIT) > 0) {
             types += "Transfer ";
+
+            // Prefer a dedicated transfer queue, which is usually backed by a DMA engine
+            bool isDedicated = ((queue.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0);
+
+            if (isDedicated && _vkTransferQueueFamilyIndex == UINT32_MAX) {
+                _vkTransferQueueFamilyIndex = index;
+                types.insert(types.end() - 1, '*');
+            }
         }
 
         if ((queue.queueFlags & VK_QUEUE_SPARSE_BINDING_BIT) > 0) {
@@ -797,12 +1845,25 @@ void GraphicsDriver::InitDevice()
         throw Exception("No suitable present queue found");
     }
 
+    // Graphics queues always support transfers, even if they don't advertise it
+    if (_vkTransferQueueFamilyIndex == UINT32_MAX) {
+        _vkTransferQueueFamilyIndex = _vkGraphicsQueueFamilyIndex;
+    }
+
+    // Buffers that are accessed from both queues are shared concurrently, rather than
+    // transferring ownership back and forth
+    _vkSharedQueueFamilyIndexList = { _vkGraphicsQueueFamilyIndex };
+    if (_vkTransferQueueFamilyIndex != _vkGraphicsQueueFamilyIndex) {
+        _vkSharedQueueFamilyIndexList.push_back(_vkTransferQueueFamilyIndex);
+    }
+
     const float queuePriorities = 1.0f;
 
     List<VkDeviceQueueCreateInfo> queueCreateInfoList;
     set<uint32_t> queueFamilyIndexSet = {
         _vkGraphicsQueueFamilyIndex,
-        _vkPresentQueueFamilyIndex
+        _vkPresentQueueFamilyIndex,
+        _vkTransferQueueFamilyIndex,
     };
 
     for (auto index : queueFamilyIndexSet) {
@@ -818,10 +1879,43 @@ void GraphicsDriver::InitDevice()
         );
     }
 
+    // Used by GPUScene for GPU-driven rendering, and by Texture, which fall back to what is
+    // available
     VkPhysicalDeviceFeatures requiredDeviceFeatures = {
-        // TODO
+        .multiDrawIndirect = _vkPhysicalDeviceFeatures.multiDrawIndirect,
+        .drawIndirectFirstInstance = _vkPhysicalDeviceFeatures.drawIndirectFirstInstance,
+        .samplerAnisotropy = _vkPhysicalDeviceFeatures.samplerAnisotropy,
+        .textureCompressionBC = _vkPhysicalDeviceFeatures.textureCompressionBC,
+    };
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .pNext = nullptr,
+    };
+
+    if (_vkPhysicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2) {
+        VkPhysicalDeviceFeatures2 features2 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &vulkan12Features,
+        };
+
+        vkGetPhysicalDeviceFeatures2(_vkPhysicalDevice, &features2);
+    }
+
+    _hasDrawIndirectCount = vulkan12Features.drawIndirectCount;
+
+    // Only enable what is needed
+    VkPhysicalDeviceVulkan12Features requiredVulkan12Features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .pNext = nullptr,
+        .drawIndirectCount = vulkan12Features.drawIndirectCount,
     };
 
+    Log(NOON_ANCHOR, "Draw Indirect Count: {}, Multi Draw Indirect: {}, Draw Indirect First Instance: {}",
+        _hasDrawIndirectCount,
+        static_cast<bool>(_vkPhysicalDeviceFeatures.multiDrawIndirect),
+        static_cast<bool>(_vkPhysicalDeviceFeatures.drawIndirectFirstInstance));
+
     const auto& requiredLayerList = GetRequiredLayerList();
 
     uint32_t availableExtensionCount = 0;
@@ -861,7 +1955,9 @@ void GraphicsDriver::InitDevice()
 
     VkDeviceCreateInfo deviceCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-        .pNext = nullptr,
+        .pNext = (_vkPhysicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2
+            ? &requiredVulkan12Features
+            : nullptr),
         .flags = 0,
         .queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfoList.size()),
         .pQueueCreateInfos = queueCreateInfoList.data(),
@@ -885,6 +1981,7 @@ void GraphicsDriver::InitDevice()
     
     vkGetDeviceQueue(_vkDevice, _vkGraphicsQueueFamilyIndex, 0, &_vkGraphicsQueue);
     vkGetDeviceQueue(_vkDevice, _vkPresentQueueFamilyIndex, 0, &_vkPresentQueue);
+    vkGetDeviceQueue(_vkDevice, _vkTransferQueueFamilyIndex, 0, &_vkTransferQueue);
 }
 
 void GraphicsDriver::TermDevice()
@@ -901,9 +1998,16 @@ void GraphicsDriver::InitAllocator()
 
     VmaAllocatorCreateFlags allocatorCreateFlags = 0;
 
-    if (HasDeviceExtensionAvailable(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+    // Enabled in GetRequiredDeviceExtensionList() when available
+    _hasMemoryBudgetExtension = HasDeviceExtensionAvailable(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+    if (_hasMemoryBudgetExtension) {
         allocatorCreateFlags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
     }
+    else {
+        Log(NOON_ANCHOR, "{} not available, memory budgets will be estimated",
+            VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
     
     VmaAllocatorCreateInfo allocatorCreateInfo = {
         .flags = allocatorCreateFlags,
@@ -913,23 +2017,245 @@ void GraphicsDriver::InitAllocator()
         .pAllocationCallbacks = nullptr,
         .pDeviceMemoryCallbacks = nullptr,
         .instance = _vkInstance,
-        .vulkanApiVersion = VK_API_VERSION_1_2,
+        // Must match the version the instance was created with, but not exceed the device's
+        .vulkanApiVersion = std::min<uint32_t>(VK_API_VERSION_1_2, _vkPhysicalDeviceProperties.apiVersion),
     };
 
     vkResult = vmaCreateAllocator(&allocatorCreateInfo, &_vmaAllocator);
     if (vkResult != VK_SUCCESS) {
         throw Exception("vmaCreateAllocator() failed");
     }
+
+    const VkPhysicalDeviceMemoryProperties * memoryProperties = nullptr;
+    vmaGetMemoryProperties(_vmaAllocator, &memoryProperties);
+
+    _memoryHeapBudgetList.resize(memoryProperties->memoryHeapCount);
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; ++i) {
+        _memoryHeapBudgetList[i] = {
+            .IsDeviceLocal = ((memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) > 0),
+        };
+    }
+
+    UpdateMemoryBudget();
 }
 
 void GraphicsDriver::TermAllocator()
 {
+    for (size_t i = 0; i < MemoryCategoryCount; ++i) {
+        if (_memoryCategoryCount[i] > 0) {
+            Log(NOON_ANCHOR, "Leaked {} {} allocations",
+                _memoryCategoryCount[i].load(),
+                MemoryCategoryToString(static_cast<MemoryCategory>(i)));
+        }
+    }
+
     if (_vmaAllocator) {
         vmaDestroyAllocator(_vmaAllocator);
         _vmaAllocator = nullptr;
     }
 }
 
+void GraphicsDriver::InitMemoryPools()
+{
+    VkResult vkResult;
+
+    struct MemoryPoolDefinition
+    {
+        MemoryPool Pool;
+
+        VmaPoolCreateFlags Flags;
+
+        VmaMemoryUsage MemoryUsage;
+
+        // Usages the pool's buffers may have, or 0 for an image pool
+        VkBufferUsageFlags BufferUsage;
+
+        VkDeviceSize BlockSize;
+
+        // A ring has exactly one block
+        size_t MaxBlockCount;
+
+    }; // struct MemoryPoolDefinition
+
+    const Array<MemoryPoolDefinition, MemoryPoolCount - 1> definitionList = {
+        MemoryPoolDefinition {
+            .Pool = MemoryPool::Transient,
+            .Flags = VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT,
+            .MemoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU,
+            .BufferUsage = (
+                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+            ),
+            .BlockSize = 16 * 1024 * 1024,
+            .MaxBlockCount = 1,
+        },
+        MemoryPoolDefinition {
+            .Pool = MemoryPool::Staging,
+            .Flags = VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT,
+            .MemoryUsage = VMA_MEMORY_USAGE_CPU_ONLY,
+            .BufferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            .BlockSize = 32 * 1024 * 1024,
+            .MaxBlockCount = 1,
+        },
+        MemoryPoolDefinition {
+            .Pool = MemoryPool::RenderTarget,
+            .Flags = VMA_POOL_CREATE_BUDDY_ALGORITHM_BIT,
+            .MemoryUsage = VMA_MEMORY_USAGE_GPU_ONLY,
+            .BufferUsage = 0,
+            // Buddy allocators only use the largest power of two that fits in a block
+            .BlockSize = 64 * 1024 * 1024,
+            .MaxBlockCount = 0,
+        },
+        MemoryPoolDefinition {
+            .Pool = MemoryPool::Streaming,
+            .Flags = 0,
+            .MemoryUsage = VMA_MEMORY_USAGE_GPU_ONLY,
+            .BufferUsage = (
+                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT
+            ),
+            .BlockSize = 0,
+            .MaxBlockCount = 0,
+        },
+    };
+
+    for (const auto& definition : definitionList) {
+        size_t index = static_cast<size_t>(definition.Pool);
+
+        VmaAllocationCreateInfo allocationCreateInfo = {
+            .usage = definition.MemoryUsage,
+        };
+
+        uint32_t memoryTypeIndex = 0;
+
+        if (definition.BufferUsage) {
+            VkBufferCreateInfo bufferCreateInfo = {
+                .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .size = 1024,
+                .usage = definition.BufferUsage,
+                .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            };
+
+            vkResult = vmaFindMemoryTypeIndexForBufferInfo(
+                _vmaAllocator,
+                &bufferCreateInfo,
+                &allocationCreateInfo,
+                &memoryTypeIndex);
+        }
+        else {
+            VkImageCreateInfo imageCreateInfo = {
+                .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .imageType = VK_IMAGE_TYPE_2D,
+                .format = VK_FORMAT_R8G8B8A8_UNORM,
+                .extent = { 1024, 1024, 1 },
+                .mipLevels = 1,
+                .arrayLayers = 1,
+                .samples = VK_SAMPLE_COUNT_1_BIT,
+                .tiling = VK_IMAGE_TILING_OPTIMAL,
+                .usage = (
+                    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                    VK_IMAGE_USAGE_SAMPLED_BIT |
+                    VK_IMAGE_USAGE_TRANSFER_SRC_BIT
+                ),
+                .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            };
+
+            vkResult = vmaFindMemoryTypeIndexForImageInfo(
+                _vmaAllocator,
+                &imageCreateInfo,
+                &allocationCreateInfo,
+                &memoryTypeIndex);
+        }
+
+        if (vkResult != VK_SUCCESS) {
+            Log(NOON_ANCHOR, "Unable to find a memory type for the {} memory pool, using the default pools",
+                MemoryPoolToString(definition.Pool));
+            continue;
+        }
+
+        VmaPoolCreateInfo poolCreateInfo = {
+            .memoryTypeIndex = memoryTypeIndex,
+            .flags = definition.Flags,
+            .blockSize = definition.BlockSize,
+            // Rings are allocated up front, so allocating from them never touches the driver
+            .minBlockCount = definition.MaxBlockCount,
+            .maxBlockCount = definition.MaxBlockCount,
+        };
+
+        vkResult = vmaCreatePool(_vmaAllocator, &poolCreateInfo, &_vmaPoolList[index]);
+        if (vkResult != VK_SUCCESS) {
+            Log(NOON_ANCHOR, "vmaCreatePool() failed for the {} memory pool, using the default pools",
+                MemoryPoolToString(definition.Pool));
+            _vmaPoolList[index] = VK_NULL_HANDLE;
+            continue;
+        }
+
+        _memoryPoolTypeIndexList[index] = memoryTypeIndex;
+        _memoryPoolBufferUsageList[index] = definition.BufferUsage;
+    }
+}
+
+void GraphicsDriver::TermMemoryPools()
+{
+    for (auto& pool : _vmaPoolList) {
+        if (pool) {
+            vmaDestroyPool(_vmaAllocator, pool);
+            pool = VK_NULL_HANDLE;
+        }
+    }
+}
+
+void GraphicsDriver::InitShaderBundles()
+{
+    // Application shaders take priority over the engine's
+    const auto& appName = Application::GetInstance()->GetName();
+
+    LoadShaderBundle(fmt::format("Shader/{}.bundle", appName));
+
+    // Shaders are then loaded from loose .spv files, as built with NOON_SHADER_BUNDLE off
+    if (!LoadShaderBundle("Shader/Noon.bundle")) {
+        Log(NOON_ANCHOR, "Unable to find shader bundle 'Shader/Noon.bundle', using loose shaders");
+    }
+}
+
+void GraphicsDriver::TermShaderBundles()
+{
+    _shaderBundleList.clear();
+}
+
+void GraphicsDriver::InitDefragmenter()
+{
+    _defragmenter.reset(new Defragmenter(this));
+}
+
+void GraphicsDriver::TermDefragmenter()
+{
+    _defragmenter.reset();
+}
+
+void GraphicsDriver::TermSamplers()
+{
+    for (const auto& [key, sampler] : _vkSamplerMap) {
+        vkDestroySampler(_vkDevice, sampler, nullptr);
+    }
+
+    _vkSamplerMap.clear();
+}
+
 void GraphicsDriver::InitSyncObjects()
 {
     VkResult vkResult;
@@ -1224,6 +2550,7 @@ void GraphicsDriver::InitSwapChain()
     InitDepthBuffer();
     InitRenderPass();
     InitDescriptorPool();
+    InitDescriptorSets();
     InitPipelineLayout();
     InitFramebuffers();
     InitCommandBuffers();
@@ -1234,6 +2561,7 @@ void GraphicsDriver::TermSwapChain()
     TermCommandBuffers();
     TermFramebuffers();
     TermPipelineLayout();
+    TermDescriptorSets();
     TermDescriptorPool();
     TermRenderPass();
     TermDepthBuffer();
@@ -1253,6 +2581,10 @@ void GraphicsDriver::TermSwapChain()
 
 void GraphicsDriver::ResetSwapChain()
 {
+    // Waiting for the device idle needs every queue to itself, and the command buffers are
+    // reallocated from the shared pool
+    std::lock_guard queueLock(_queueMutex);
+
     if (_vkSwapChain) {
         vkDeviceWaitIdle(_vkDevice);
 
@@ -1320,10 +2652,11 @@ void GraphicsDriver::InitDepthBuffer()
     VmaAllocationCreateInfo allocationCreateInfo = {
         .flags = 0,
         .usage = VMA_MEMORY_USAGE_GPU_ONLY,
+        .pool = GetMemoryPool(MemoryPool::RenderTarget),
     };
 
-    vkResult = vmaCreateImage(
-        _vmaAllocator,
+    vkResult = CreateImage(
+        MemoryCategory::Image,
         &imageCreateInfo,
         &allocationCreateInfo,
         &_vkDepthImage,
@@ -1363,20 +2696,16 @@ void GraphicsDriver::InitDepthBuffer()
 
 void GraphicsDriver::TermDepthBuffer()
 {
-    if (_vkDepthImage) {
-        vkDestroyImage(_vkDevice, _vkDepthImage, nullptr);
-        _vkDepthImage = VK_NULL_HANDLE;
-    }
-
-    if (_vmaDepthImageAllocation) {
-        vmaFreeMemory(_vmaAllocator, _vmaDepthImageAllocation);
-        _vmaDepthImageAllocation = VK_NULL_HANDLE;
-    }
-
     if (_vkDepthImageView) {
         vkDestroyImageView(_vkDevice, _vkDepthImageView, nullptr);
         _vkDepthImageView = VK_NULL_HANDLE;
     }
+
+    if (_vkDepthImage) {
+        DestroyImage(MemoryCategory::Image, _vkDepthImage, _vmaDepthImageAllocation);
+        _vkDepthImage = VK_NULL_HANDLE;
+        _vmaDepthImageAllocation = VK_NULL_HANDLE;
+    }
 }
 
 void GraphicsDriver::InitRenderPass()
@@ -1482,10 +2811,14 @@ void GraphicsDriver::InitDescriptorPool()
 
     TermDescriptorPool();
 
-    Array<VkDescriptorPoolSize, 1> descriptorPoolSizeList = {
+    Array<VkDescriptorPoolSize, 2> descriptorPoolSizeList = {
         VkDescriptorPoolSize {
             .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .descriptorCount = static_cast<uint32_t>(1), // materialList.size() + meshList.size(), can never be 0
+            .descriptorCount = 2 * _backbufferCount,
+        },
+        VkDescriptorPoolSize {
+            .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = _backbufferCount,
         },
     };
 
@@ -1508,7 +2841,7 @@ void GraphicsDriver::InitDescriptorPool()
         throw Exception("vkCreateDescriptorPool() failed");
     }
 
-    Array<VkDescriptorSetLayoutBinding, 2> descriptorSetLayoutBindingList = {
+    Array<VkDescriptorSetLayoutBinding, 3> descriptorSetLayoutBindingList = {
         VkDescriptorSetLayoutBinding {
             .binding = ShaderGlobals::Binding,
             .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
@@ -1517,9 +2850,16 @@ void GraphicsDriver::InitDescriptorPool()
             .pImmutableSamplers = nullptr,
         },
         VkDescriptorSetLayoutBinding {
-            .binding = ShaderTransform::Binding,
+            .binding = ShaderView::Binding,
             .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
             .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS,
+            .pImmutableSamplers = nullptr,
+        },
+        VkDescriptorSetLayoutBinding {
+            .binding = ShaderInstance::Binding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
             .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
             .pImmutableSamplers = nullptr,
         },
@@ -1562,21 +2902,93 @@ void GraphicsDriver::TermDescriptorPool()
     }
 }
 
+void GraphicsDriver::InitDescriptorSets()
+{
+    VkResult vkResult;
+
+    TermDescriptorSets();
+
+    _globalsBufferList.resize(_backbufferCount);
+    _viewBufferList.resize(_backbufferCount);
+    _instanceBufferList.resize(_backbufferCount);
+
+    // The instance buffers grow as needed in UpdateInstanceBuffer()
+    for (unsigned i = 0; i < _backbufferCount; ++i) {
+        _globalsBufferList[i] = CreateMappedBuffer(sizeof(ShaderGlobals), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+        _viewBufferList[i] = CreateMappedBuffer(sizeof(ShaderView), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+        _instanceBufferList[i] = CreateMappedBuffer(1024 * sizeof(ShaderInstance), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    }
+
+    List<VkDescriptorSetLayout> descriptorSetLayoutList(_backbufferCount, _vkDescriptorSetLayoutList[0]);
+
+    VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .descriptorPool = _vkDescriptorPool,
+        .descriptorSetCount = static_cast<uint32_t>(descriptorSetLayoutList.size()),
+        .pSetLayouts = descriptorSetLayoutList.data(),
+    };
+
+    _vkDescriptorSetList.resize(_backbufferCount, VK_NULL_HANDLE);
+
+    vkResult = vkAllocateDescriptorSets(
+        _vkDevice,
+        &descriptorSetAllocateInfo,
+        _vkDescriptorSetList.data());
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkAllocateDescriptorSets() failed");
+    }
+
+    for (unsigned i = 0; i < _backbufferCount; ++i) {
+        UpdateDescriptorSet(i);
+    }
+}
+
+void GraphicsDriver::TermDescriptorSets()
+{
+    // The sets themselves are freed along with the descriptor pool
+    _vkDescriptorSetList.clear();
+
+    for (auto& buffer : _globalsBufferList) {
+        DestroyMappedBuffer(buffer);
+    }
+
+    for (auto& buffer : _viewBufferList) {
+        DestroyMappedBuffer(buffer);
+    }
+
+    for (auto& buffer : _instanceBufferList) {
+        DestroyMappedBuffer(buffer);
+    }
+
+    _globalsBufferList.clear();
+    _viewBufferList.clear();
+    _instanceBufferList.clear();
+}
+
 void GraphicsDriver::InitPipelineLayout()
 {
     VkResult vkResult;
 
     TermPipelineLayout();
 
+    Array<VkPushConstantRange, 1> pushConstantRangeList = {
+        VkPushConstantRange {
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+            .offset = 0,
+            .size = sizeof(ShaderMesh),
+        },
+    };
+
     VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0,
         .setLayoutCount = static_cast<uint32_t>(_vkDescriptorSetLayoutList.size()),
         .pSetLayouts = _vkDescriptorSetLayoutList.data(),
-        // TODO: Investigate
-        .pushConstantRangeCount = 0,
-        .pPushConstantRanges = nullptr,
+        .pushConstantRangeCount = static_cast<uint32_t>(pushConstantRangeList.size()),
+        .pPushConstantRanges = pushConstantRangeList.data(),
     };
 
     vkResult = vkCreatePipelineLayout(
@@ -1592,12 +3004,23 @@ void GraphicsDriver::InitPipelineLayout()
 
 void GraphicsDriver::TermPipelineLayout()
 {
+    TermMeshPipelines();
+
     if (_vkPipelineLayout) {
         vkDestroyPipelineLayout(_vkDevice, _vkPipelineLayout, nullptr);
         _vkPipelineLayout = VK_NULL_HANDLE;
     }
 }
 
+void GraphicsDriver::TermMeshPipelines()
+{
+    for (auto& [hash, pipeline] : _vkMeshPipelineMap) {
+        vkDestroyPipeline(_vkDevice, pipeline, nullptr);
+    }
+
+    _vkMeshPipelineMap.clear();
+}
+
 void GraphicsDriver::InitFramebuffers()
 {
     VkResult vkResult;
@@ -1651,10 +3074,11 @@ void GraphicsDriver::InitCommandBuffers()
 
     TermCommandBuffers();
 
+    // Command buffers are re-recorded every frame
     VkCommandPoolCreateInfo commandPoolCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
         .pNext = nullptr,
-        .flags = 0,
+        .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
         .queueFamilyIndex = _vkGraphicsQueueFamilyIndex,
     };
 
@@ -1686,8 +3110,6 @@ void GraphicsDriver::InitCommandBuffers()
     if (vkResult != VK_SUCCESS) {
         throw Exception("vkAllocateCommandBuffers() failed");
     }
-
-    FillCommandBuffers();
 }
 
 void GraphicsDriver::TermCommandBuffers()
@@ -1710,10 +3132,12 @@ void GraphicsDriver::TermCommandBuffers()
     }
 }
 
-void GraphicsDriver::FillCommandBuffers()
+void GraphicsDriver::RecordCommandBuffer(uint32_t imageIndex)
 {
     VkResult vkResult;
 
+    VkCommandBuffer commandBuffer = _vkCommandBufferList[imageIndex];
+
     const Vec4& color = { 0.0f, 0.0f, 0.0f, 1.0f };
     std::array<VkClearValue, 2> clearValues = {
         VkClearValue {
@@ -1729,43 +3153,112 @@ void GraphicsDriver::FillCommandBuffers()
         },
     };
 
-    for (unsigned i = 0; i < _backbufferCount; ++i) {
-        VkCommandBufferBeginInfo commandBufferBeginInfo = {
-            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-            .pNext = nullptr,
-            .flags = 0,
-        };
+    VkCommandBufferBeginInfo commandBufferBeginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = nullptr,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
 
-        vkResult = vkBeginCommandBuffer(_vkCommandBufferList[i], &commandBufferBeginInfo);
-        if (vkResult != VK_SUCCESS) {
-            throw Exception("vkBeginCommandBuffer() failed");
-        }
+    vkResult = vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkBeginCommandBuffer() failed");
+    }
 
-        VkRenderPassBeginInfo renderPassBeginInfo = {
-            .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-            .renderPass = _vkRenderPass,
-            .framebuffer = _vkFramebufferList[i],
-            .renderArea = {
-                .offset = { 0, 0 },
-                .extent = _vkSwapChainExtent,
-            },
-            .clearValueCount = static_cast<uint32_t>(clearValues.size()),
-            .pClearValues = clearValues.data(),
-        };
+    // Compute work can't be recorded inside a render pass
+    for (auto scene : _gpuSceneList) {
+        scene->RecordCulling(commandBuffer);
+    }
 
-        vkCmdBeginRenderPass(
-            _vkCommandBufferList[i],
-            &renderPassBeginInfo,
-            VK_SUBPASS_CONTENTS_INLINE);
+    VkRenderPassBeginInfo renderPassBeginInfo = {
+        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+        .renderPass = _vkRenderPass,
+        .framebuffer = _vkFramebufferList[imageIndex],
+        .renderArea = {
+            .offset = { 0, 0 },
+            .extent = _vkSwapChainExtent,
+        },
+        .clearValueCount = static_cast<uint32_t>(clearValues.size()),
+        .pClearValues = clearValues.data(),
+    };
 
-        
+    vkCmdBeginRenderPass(
+        commandBuffer,
+        &renderPassBeginInfo,
+        VK_SUBPASS_CONTENTS_INLINE);
+
+    VkViewport viewport = {
+        .x = 0.0f,
+        .y = 0.0f,
+        .width = static_cast<float>(_vkSwapChainExtent.width),
+        .height = static_cast<float>(_vkSwapChainExtent.height),
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f,
+    };
 
-        vkCmdEndRenderPass(_vkCommandBufferList[i]);
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
-        vkResult = vkEndCommandBuffer(_vkCommandBufferList[i]);
-        if (vkResult != VK_SUCCESS) {
-            throw Exception("vkEndCommandBuffer() failed");
-        }
+    VkRect2D scissor = {
+        .offset = { 0, 0 },
+        .extent = _vkSwapChainExtent,
+    };
+
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    vkCmdBindDescriptorSets(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        _vkPipelineLayout,
+        0,
+        1,
+        &_vkDescriptorSetList[_backbufferIndex],
+        0,
+        nullptr);
+
+    _renderQueue->Record(commandBuffer);
+
+    for (auto scene : _gpuSceneList) {
+        scene->RecordDraw(commandBuffer);
+    }
+
+    vkCmdEndRenderPass(commandBuffer);
+
+    vkResult = vkEndCommandBuffer(commandBuffer);
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkEndCommandBuffer() failed");
+    }
+}
+
+String MemoryCategoryToString(MemoryCategory category)
+{
+    switch (category) {
+        case MemoryCategory::Buffer:
+            return "Buffer";
+        case MemoryCategory::Image:
+            return "Image";
+        case MemoryCategory::Staging:
+            return "Staging";
+        case MemoryCategory::Transient:
+            return "Transient";
+        default:
+            return fmt::format("Unknown ({})", static_cast<int>(category));
+    }
+}
+
+String MemoryPoolToString(MemoryPool pool)
+{
+    switch (pool) {
+        case MemoryPool::Default:
+            return "Default";
+        case MemoryPool::Transient:
+            return "Transient";
+        case MemoryPool::Staging:
+            return "Staging";
+        case MemoryPool::RenderTarget:
+            return "RenderTarget";
+        case MemoryPool::Streaming:
+            return "Streaming";
+        default:
+            return fmt::format("Unknown ({})", static_cast<int>(pool));
     }
 }
 
@@ -0,0 +1,470 @@
+#include <Noon/JobSystem.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/Log.hpp>
+
+#include <limits>
+
+// noinline alone isn't enough, as interprocedural analysis can still find a function pure
+// and merge calls to it. noipa stops GCC from doing so, Clang has no such analysis across
+// noinline, and the barrier in GetThreadState() covers both.
+#if defined(NOON_COMPILER_MSVC)
+    #include <intrin.h>
+    #define NOON_NOIPA __declspec(noinline)
+    #define NOON_COMPILER_BARRIER() _ReadWriteBarrier()
+#elif defined(NOON_COMPILER_GCC)
+    #define NOON_NOIPA __attribute__((noipa))
+    #define NOON_COMPILER_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+    #define NOON_NOIPA __attribute__((noinline))
+    #define NOON_COMPILER_BARRIER() __asm__ __volatile__("" ::: "memory")
+#endif
+
+namespace noon {
+
+JobSystem * JobSystem::_Instance = nullptr;
+
+// A fiber owned by the job system, which runs one job at a time
+struct JobFiber
+{
+    std::unique_ptr<Fiber> Context;
+
+    JobSystem * Owner;
+
+    Job Assigned;
+
+}; // struct JobFiber
+
+static const size_t InvalidThreadIndex = std::numeric_limits<size_t>::max();
+
+struct ThreadState
+{
+    // The index of the deque owned by this thread, threads not created by the job system
+    // don't own one
+    size_t Index = InvalidThreadIndex;
+
+    // The fiber of the worker thread itself, which picks the jobs to run
+    Fiber * SchedulerFiber = nullptr;
+
+    // The fiber running a job on this thread, if any
+    JobFiber * CurrentFiber = nullptr;
+
+    // Set by a job fiber right before it switches back to the scheduler, and handled by the
+    // scheduler once the fiber's stack is no longer in use
+    JobFiber * FinishedFiber = nullptr;
+
+    JobFiber * WaitingFiber = nullptr;
+
+    JobCounter * WaitingCounter = nullptr;
+
+}; // struct ThreadState
+
+static thread_local ThreadState _ThreadState;
+
+// A fiber can resume on another thread, so the address of the thread_local must be looked up
+// again after every switch. The switch is opaque to the compiler, which would otherwise treat
+// the address as constant for the whole function, and keep using the ThreadState of the worker
+// the fiber started on after it migrates. The volatile barrier gives this function a side
+// effect, so calls to it are never merged or hoisted, even when the compiler can see into it.
+static NOON_NOIPA ThreadState& GetThreadState()
+{
+    NOON_COMPILER_BARRIER();
+    return _ThreadState;
+}
+
+// Number of attempts to find a job before an idle worker goes to sleep
+static const int IdleSpinCount = 64;
+
+// Jobs run entirely on these stacks, including anything they call while decoding or loading
+static const size_t JobFiberStackSize = 256 * 1024;
+
+JobSystem::JobSystem(size_t workerCount)
+{
+    if (_Instance) {
+        throw Exception("Only one JobSystem can exist at a time");
+    }
+
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    }
+
+    _mainThreadID = std::this_thread::get_id();
+    GetThreadState().Index = 0;
+
+    for (size_t i = 0; i <= workerCount; ++i) {
+        _workerList.push_back(std::make_unique<Worker>());
+    }
+
+    // Every deque exists before the first worker starts stealing from them
+    for (size_t i = 1; i <= workerCount; ++i) {
+        _workerList[i]->Thread = std::thread(&JobSystem::WorkerMain, this, i);
+    }
+
+    _Instance = this;
+
+    Log(NOON_ANCHOR, "Started {} job threads", GetThreadCount());
+}
+
+JobSystem::~JobSystem()
+{
+    _running = false;
+
+    {
+        std::lock_guard lock(_idleMutex);
+        _idleCondition.notify_all();
+    }
+
+    for (size_t i = 1; i < _workerList.size(); ++i) {
+        _workerList[i]->Thread.join();
+    }
+
+    GetThreadState().Index = InvalidThreadIndex;
+
+    _Instance = nullptr;
+}
+
+bool JobSystem::IsMainThread() const
+{
+    return (std::this_thread::get_id() == _mainThreadID);
+}
+
+void JobSystem::Schedule(Job job, JobCounter * dependency)
+{
+    if (job.Counter) {
+        Increment(*job.Counter);
+    }
+
+    if (dependency) {
+        std::lock_guard lock(dependency->_mutex);
+        if (dependency->_value.load(std::memory_order_acquire) > 0) {
+            dependency->_waitingList.push_back(job);
+            return;
+        }
+    }
+
+    Push(job);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    ThreadState& state = GetThreadState();
+
+    if (state.CurrentFiber && !counter.IsDone()) {
+        // The scheduler adds the fiber to the counter once it has switched away from it, as
+        // another worker could resume it as soon as it is added
+        JobFiber * fiber = state.CurrentFiber;
+        state.WaitingFiber = fiber;
+        state.WaitingCounter = &counter;
+        fiber->Context->SwitchTo(*state.SchedulerFiber);
+    }
+    else {
+        while (!counter.IsDone()) {
+            if (!TryRunJob(GetThreadState().Index)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // The last job releases the lock after it decrements the counter, wait for that before
+    // the counter can be destroyed
+    std::lock_guard lock(counter._mutex);
+}
+
+void JobSystem::Increment(JobCounter& counter, uint32_t count)
+{
+    std::lock_guard lock(counter._mutex);
+    counter._value.fetch_add(count, std::memory_order_relaxed);
+}
+
+void JobSystem::Signal(JobCounter& counter)
+{
+    List<Job> readyList;
+    List<JobFiber *> readyFiberList;
+    {
+        std::lock_guard lock(counter._mutex);
+        if (counter._value.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            readyList.swap(counter._waitingList);
+            readyFiberList.swap(counter._waitingFiberList);
+        }
+    }
+
+    // The counter can be destroyed from here on
+
+    for (const auto& ready : readyList) {
+        Push(ready);
+    }
+
+    if (!readyFiberList.empty()) {
+        {
+            std::lock_guard lock(_readyFiberMutex);
+            _readyFiberQueue.insert(_readyFiberQueue.end(), readyFiberList.begin(), readyFiberList.end());
+        }
+
+        _queuedJobCount += readyFiberList.size();
+
+        if (_sleepingCount > 0) {
+            std::lock_guard lock(_idleMutex);
+            _idleCondition.notify_all();
+        }
+    }
+}
+
+void JobSystem::ProcessMainThreadJobs()
+{
+    while (true) {
+        Job job;
+        {
+            std::lock_guard lock(_mainThreadMutex);
+            if (_mainThreadQueue.empty()) {
+                break;
+            }
+
+            job = _mainThreadQueue.front();
+            _mainThreadQueue.pop_front();
+        }
+
+        Run(job);
+    }
+}
+
+void JobSystem::WorkerMain(size_t index)
+{
+    Fiber schedulerFiber;
+
+    ThreadState& state = GetThreadState();
+    state.Index = index;
+    state.SchedulerFiber = &schedulerFiber;
+
+    while (_running) {
+        bool found = false;
+        for (int spin = 0; spin < IdleSpinCount && !found; ++spin) {
+            found = TryRunJob(index);
+            if (!found) {
+                std::this_thread::yield();
+            }
+        }
+
+        if (found) {
+            continue;
+        }
+
+        // Push() only notifies when someone is sleeping, so the count is raised before the
+        // queue is checked one last time
+        std::unique_lock lock(_idleMutex);
+        ++_sleepingCount;
+        _idleCondition.wait(lock, [this]() {
+            return (_queuedJobCount > 0 || !_running);
+        });
+        --_sleepingCount;
+    }
+}
+
+void JobSystem::Push(const Job& job)
+{
+    if (job.MainThread) {
+        std::lock_guard lock(_mainThreadMutex);
+        _mainThreadQueue.push_back(job);
+        return;
+    }
+
+    // Threads that don't own a deque spread their jobs over all of them
+    size_t index = GetThreadState().Index;
+    if (index >= _workerList.size()) {
+        index = _nextDeque.fetch_add(1, std::memory_order_relaxed) % _workerList.size();
+    }
+
+    {
+        std::lock_guard lock(_workerList[index]->Mutex);
+        _workerList[index]->JobQueue.push_back(job);
+    }
+
+    ++_queuedJobCount;
+
+    if (_sleepingCount > 0) {
+        std::lock_guard lock(_idleMutex);
+        _idleCondition.notify_one();
+    }
+}
+
+bool JobSystem::TryPop(size_t index, Job& job)
+{
+    Worker * worker = _workerList[index].get();
+
+    std::lock_guard lock(worker->Mutex);
+    if (worker->JobQueue.empty()) {
+        return false;
+    }
+
+    // Newest first, its data is the most likely to still be in cache
+    job = worker->JobQueue.back();
+    worker->JobQueue.pop_back();
+    --_queuedJobCount;
+    return true;
+}
+
+bool JobSystem::TrySteal(size_t index, Job& job)
+{
+    size_t count = _workerList.size();
+    size_t start = (index < count ? index + 1 : 0);
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t victim = (start + i) % count;
+        if (victim == index) {
+            continue;
+        }
+
+        Worker * worker = _workerList[victim].get();
+
+        std::lock_guard lock(worker->Mutex);
+        if (worker->JobQueue.empty()) {
+            continue;
+        }
+
+        // Oldest first, which for recursively split work is the largest piece
+        job = worker->JobQueue.front();
+        worker->JobQueue.pop_front();
+        --_queuedJobCount;
+        return true;
+    }
+
+    return false;
+}
+
+bool JobSystem::TryRunJob(size_t index)
+{
+    Job job;
+
+    if (index == 0) {
+        std::unique_lock lock(_mainThreadMutex);
+        if (!_mainThreadQueue.empty()) {
+            job = _mainThreadQueue.front();
+            _mainThreadQueue.pop_front();
+            lock.unlock();
+
+            Run(job);
+            return true;
+        }
+    }
+
+    if (_queuedJobCount == 0) {
+        return false;
+    }
+
+    // Only workers switch fibers, everyone else runs jobs on their own stack
+    ThreadState& state = GetThreadState();
+    bool isScheduler = (state.SchedulerFiber && !state.CurrentFiber);
+
+    if (isScheduler) {
+        // Finish what was started before starting anything new
+        JobFiber * fiber;
+        if (TryPopReadyFiber(fiber)) {
+            SwitchToFiber(fiber);
+            return true;
+        }
+    }
+
+    if ((index < _workerList.size() && TryPop(index, job)) || TrySteal(index, job)) {
+        if (isScheduler) {
+            JobFiber * fiber = AcquireFiber();
+            fiber->Assigned = job;
+            SwitchToFiber(fiber);
+        }
+        else {
+            Run(job);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void JobSystem::Run(const Job& job)
+{
+    job.Function(job.Data, job.First, job.Last);
+
+    if (job.Counter) {
+        Signal(*job.Counter);
+    }
+}
+
+void JobSystem::FiberMain(void * data)
+{
+    JobFiber * fiber = static_cast<JobFiber *>(data);
+
+    while (true) {
+        fiber->Owner->Run(fiber->Assigned);
+
+        ThreadState& state = GetThreadState();
+        state.FinishedFiber = fiber;
+        fiber->Context->SwitchTo(*state.SchedulerFiber);
+    }
+}
+
+JobFiber * JobSystem::AcquireFiber()
+{
+    std::lock_guard lock(_fiberMutex);
+
+    if (!_freeFiberList.empty()) {
+        JobFiber * fiber = _freeFiberList.back();
+        _freeFiberList.pop_back();
+        return fiber;
+    }
+
+    auto fiber = std::make_unique<JobFiber>();
+    fiber->Owner = this;
+    fiber->Context = std::make_unique<Fiber>(&JobSystem::FiberMain, fiber.get(), JobFiberStackSize);
+
+    _fiberList.push_back(std::move(fiber));
+    return _fiberList.back().get();
+}
+
+bool JobSystem::TryPopReadyFiber(JobFiber *& fiber)
+{
+    std::lock_guard lock(_readyFiberMutex);
+    if (_readyFiberQueue.empty()) {
+        return false;
+    }
+
+    fiber = _readyFiberQueue.front();
+    _readyFiberQueue.pop_front();
+    --_queuedJobCount;
+    return true;
+}
+
+void JobSystem::SwitchToFiber(JobFiber * fiber)
+{
+    ThreadState& state = GetThreadState();
+    state.CurrentFiber = fiber;
+    state.SchedulerFiber->SwitchTo(*fiber->Context);
+    state.CurrentFiber = nullptr;
+
+    if (state.FinishedFiber) {
+        std::lock_guard lock(_fiberMutex);
+        _freeFiberList.push_back(state.FinishedFiber);
+        state.FinishedFiber = nullptr;
+    }
+
+    if (state.WaitingFiber) {
+        JobFiber * waitingFiber = state.WaitingFiber;
+        JobCounter * counter = state.WaitingCounter;
+        state.WaitingFiber = nullptr;
+        state.WaitingCounter = nullptr;
+
+        bool isDone;
+        {
+            std::lock_guard lock(counter->_mutex);
+            isDone = counter->IsDone();
+            if (!isDone) {
+                counter->_waitingFiberList.push_back(waitingFiber);
+            }
+        }
+
+        // It finished while the fiber was switching out
+        if (isDone) {
+            std::lock_guard lock(_readyFiberMutex);
+            _readyFiberQueue.push_back(waitingFiber);
+            ++_queuedJobCount;
+        }
+    }
+}
+
+} // namespace noon
@@ -0,0 +1,490 @@
+#include <Noon/Json.hpp>
+#include <Noon/Exception.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+
+namespace noon {
+
+// Deeper documents are rejected rather than risk overflowing the stack, which can be a small
+// fiber stack when parsing from a job
+static const size_t MaxJsonDepth = 256;
+
+JsonValue::Iterator& JsonValue::Iterator::operator++()
+{
+    const auto& nodeList = _document->_nodeList;
+    _index = nodeList[(_isObject ? _index + 1 : _index)].End;
+    return *this;
+}
+
+JsonType JsonValue::GetType() const
+{
+    return (_document ? _document->_nodeList[_index].Type : JsonType::Null);
+}
+
+bool JsonValue::GetBool(bool defaultValue) const
+{
+    if (GetType() != JsonType::Bool) {
+        return defaultValue;
+    }
+
+    return (_document->_nodeList[_index].Size != 0);
+}
+
+double JsonValue::GetNumber(double defaultValue) const
+{
+    if (GetType() != JsonType::Number) {
+        return defaultValue;
+    }
+
+    return _document->_nodeList[_index].Number;
+}
+
+StringView JsonValue::GetRawString() const
+{
+    if (GetType() != JsonType::String) {
+        return {};
+    }
+
+    const auto& node = _document->_nodeList[_index];
+    return _document->_text.substr(node.Text.Offset, node.Text.Length);
+}
+
+static uint32_t ParseHex4(const char * hex)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c = hex[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= static_cast<uint32_t>(c - '0');
+        }
+        else if (c >= 'a' && c <= 'f') {
+            value |= static_cast<uint32_t>(c - 'a' + 10);
+        }
+        else if (c >= 'A' && c <= 'F') {
+            value |= static_cast<uint32_t>(c - 'A' + 10);
+        }
+    }
+    return value;
+}
+
+static void AppendUTF8(String& str, uint32_t codepoint)
+{
+    if (codepoint < 0x80) {
+        str += static_cast<char>(codepoint);
+    }
+    else if (codepoint < 0x800) {
+        str += static_cast<char>(0xC0 | (codepoint >> 6));
+        str += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+    else if (codepoint < 0x10000) {
+        str += static_cast<char>(0xE0 | (codepoint >> 12));
+        str += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        str += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+    else {
+        str += static_cast<char>(0xF0 | (codepoint >> 18));
+        str += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        str += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        str += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+}
+
+String JsonValue::GetString(StringView defaultValue) const
+{
+    if (GetType() != JsonType::String) {
+        return String(defaultValue);
+    }
+
+    StringView raw = GetRawString();
+    if (!_document->_nodeList[_index].HasEscapes) {
+        return String(raw);
+    }
+
+    // The escapes were validated by the parser
+    String str;
+    str.reserve(raw.size());
+
+    for (size_t i = 0; i < raw.size(); ++i) {
+        if (raw[i] != '\\') {
+            str += raw[i];
+            continue;
+        }
+
+        char c = raw[++i];
+        switch (c) {
+        case 'b':
+            str += '\b';
+            break;
+        case 'f':
+            str += '\f';
+            break;
+        case 'n':
+            str += '\n';
+            break;
+        case 'r':
+            str += '\r';
+            break;
+        case 't':
+            str += '\t';
+            break;
+        case 'u': {
+            uint32_t codepoint = ParseHex4(raw.data() + i + 1);
+            i += 4;
+
+            // A surrogate pair encodes a codepoint outside of the BMP as two escapes
+            bool isHighSurrogate = (codepoint >= 0xD800 && codepoint <= 0xDBFF);
+            if (isHighSurrogate && i + 6 < raw.size() && raw[i + 1] == '\\' && raw[i + 2] == 'u') {
+                uint32_t low = ParseHex4(raw.data() + i + 3);
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                }
+            }
+
+            AppendUTF8(str, codepoint);
+            break;
+        }
+        default:
+            // '"', '\\' and '/'
+            str += c;
+            break;
+        }
+    }
+
+    return str;
+}
+
+size_t JsonValue::GetSize() const
+{
+    JsonType type = GetType();
+    if (type != JsonType::Array && type != JsonType::Object) {
+        return 0;
+    }
+
+    return _document->_nodeList[_index].Size;
+}
+
+JsonValue JsonValue::operator[](size_t index) const
+{
+    if (GetType() != JsonType::Array || index >= GetSize()) {
+        return JsonValue();
+    }
+
+    const auto& nodeList = _document->_nodeList;
+
+    uint32_t element = _index + 1;
+    for (size_t i = 0; i < index; ++i) {
+        element = nodeList[element].End;
+    }
+
+    return JsonValue(_document, element);
+}
+
+JsonValue JsonValue::operator[](StringView key) const
+{
+    if (GetType() != JsonType::Object) {
+        return JsonValue();
+    }
+
+    const auto& nodeList = _document->_nodeList;
+
+    uint32_t end = nodeList[_index].End;
+    for (uint32_t member = _index + 1; member < end; member = nodeList[member + 1].End) {
+        if (JsonValue(_document, member).GetRawString() == key) {
+            return JsonValue(_document, member + 1);
+        }
+    }
+
+    return JsonValue();
+}
+
+JsonValue::Iterator JsonValue::begin() const
+{
+    JsonType type = GetType();
+    if (type != JsonType::Array && type != JsonType::Object) {
+        return Iterator(_document, 0, false);
+    }
+
+    return Iterator(_document, _index + 1, (type == JsonType::Object));
+}
+
+JsonValue::Iterator JsonValue::end() const
+{
+    JsonType type = GetType();
+    if (type != JsonType::Array && type != JsonType::Object) {
+        return Iterator(_document, 0, false);
+    }
+
+    return Iterator(_document, _document->_nodeList[_index].End, (type == JsonType::Object));
+}
+
+void JsonDocument::Parse(StringView text)
+{
+    if (text.size() >= UINT32_MAX) {
+        throw Exception("Unable to parse {} bytes of JSON, the limit is 4GiB", text.size());
+    }
+
+    _text = text;
+    _position = 0;
+    _nodeList.clear();
+
+    // Roughly one value for every 12 bytes of typical glTF, so most documents never reallocate
+    _nodeList.reserve(text.size() / 12 + 16);
+
+    // Skip the UTF-8 byte order mark
+    if (_text.starts_with("\xEF\xBB\xBF")) {
+        _position = 3;
+    }
+
+    SkipWhitespace();
+    ParseValue(0);
+    SkipWhitespace();
+
+    if (_position != _text.size()) {
+        ThrowError("Unexpected data after the root value");
+    }
+}
+
+uint32_t JsonDocument::ParseValue(size_t depth)
+{
+    if (depth > MaxJsonDepth) {
+        ThrowError("Too deeply nested");
+    }
+
+    if (_position >= _text.size()) {
+        ThrowError("Unexpected end of data");
+    }
+
+    uint32_t index = static_cast<uint32_t>(_nodeList.size());
+    _nodeList.push_back(Node{
+        .Type = JsonType::Null,
+        .HasEscapes = false,
+        .Size = 0,
+        .End = index + 1,
+        .Number = 0.0,
+    });
+
+    char c = _text[_position];
+    switch (c) {
+    case '{': {
+        ++_position;
+        SkipWhitespace();
+
+        uint32_t size = 0;
+        if (_position < _text.size() && _text[_position] == '}') {
+            ++_position;
+        }
+        else {
+            while (true) {
+                if (_position >= _text.size() || _text[_position] != '"') {
+                    ThrowError("Expected a member name");
+                }
+
+                uint32_t key = static_cast<uint32_t>(_nodeList.size());
+                _nodeList.push_back(Node{ .Type = JsonType::String, .HasEscapes = false, .Size = 0, .End = key + 1, .Number = 0.0 });
+                ParseString(_nodeList[key]);
+
+                SkipWhitespace();
+                Expect(':');
+                SkipWhitespace();
+                ParseValue(depth + 1);
+                SkipWhitespace();
+                ++size;
+
+                if (_position < _text.size() && _text[_position] == ',') {
+                    ++_position;
+                    SkipWhitespace();
+                    continue;
+                }
+
+                Expect('}');
+                break;
+            }
+        }
+
+        Node& node = _nodeList[index];
+        node.Type = JsonType::Object;
+        node.Size = size;
+        node.End = static_cast<uint32_t>(_nodeList.size());
+        break;
+    }
+    case '[': {
+        ++_position;
+        SkipWhitespace();
+
+        uint32_t size = 0;
+        if (_position < _text.size() && _text[_position] == ']') {
+            ++_position;
+        }
+        else {
+            while (true) {
+                ParseValue(depth + 1);
+                SkipWhitespace();
+                ++size;
+
+                if (_position < _text.size() && _text[_position] == ',') {
+                    ++_position;
+                    SkipWhitespace();
+                    continue;
+                }
+
+                Expect(']');
+                break;
+            }
+        }
+
+        Node& node = _nodeList[index];
+        node.Type = JsonType::Array;
+        node.Size = size;
+        node.End = static_cast<uint32_t>(_nodeList.size());
+        break;
+    }
+    case '"':
+        _nodeList[index].Type = JsonType::String;
+        ParseString(_nodeList[index]);
+        break;
+    case 't':
+        if (_text.substr(_position, 4) != "true") {
+            ThrowError("Invalid literal");
+        }
+        _position += 4;
+        _nodeList[index].Type = JsonType::Bool;
+        _nodeList[index].Size = 1;
+        break;
+    case 'f':
+        if (_text.substr(_position, 5) != "false") {
+            ThrowError("Invalid literal");
+        }
+        _position += 5;
+        _nodeList[index].Type = JsonType::Bool;
+        break;
+    case 'n':
+        if (_text.substr(_position, 4) != "null") {
+            ThrowError("Invalid literal");
+        }
+        _position += 4;
+        break;
+    default:
+        _nodeList[index].Type = JsonType::Number;
+        ParseNumber(_nodeList[index]);
+        break;
+    }
+
+    return index;
+}
+
+void JsonDocument::ParseString(Node& node)
+{
+    // Skip the opening quote
+    ++_position;
+
+    size_t start = _position;
+    const char * data = _text.data();
+    size_t size = _text.size();
+
+    while (true) {
+        // Nothing but the quote and backslash needs a closer look
+        while (_position < size && data[_position] != '"' && data[_position] != '\\') {
+            if (static_cast<unsigned char>(data[_position]) < 0x20) {
+                ThrowError("Control character in string");
+            }
+            ++_position;
+        }
+
+        if (_position >= size) {
+            ThrowError("Unterminated string");
+        }
+
+        if (data[_position] == '"') {
+            break;
+        }
+
+        node.HasEscapes = true;
+
+        ++_position;
+        if (_position >= size) {
+            ThrowError("Unterminated string");
+        }
+
+        char c = data[_position];
+        if (c == 'u') {
+            if (_position + 4 >= size) {
+                ThrowError("Unterminated string");
+            }
+
+            for (size_t i = 1; i <= 4; ++i) {
+                if (!std::isxdigit(static_cast<unsigned char>(data[_position + i]))) {
+                    ThrowError("Invalid unicode escape");
+                }
+            }
+            _position += 5;
+        }
+        else if (strchr("\"\\/bfnrt", c) && c != '\0') {
+            ++_position;
+        }
+        else {
+            ThrowError("Invalid escape");
+        }
+    }
+
+    node.Text.Offset = static_cast<uint32_t>(start);
+    node.Text.Length = static_cast<uint32_t>(_position - start);
+
+    // Skip the closing quote
+    ++_position;
+}
+
+void JsonDocument::ParseNumber(Node& node)
+{
+    const char * first = _text.data() + _position;
+    const char * last = _text.data() + _text.size();
+
+    // from_chars would also accept "inf", "nan" and a leading '.'
+    if (*first != '-' && !std::isdigit(static_cast<unsigned char>(*first))) {
+        ThrowError("Unexpected character");
+    }
+
+    auto result = std::from_chars(first, last, node.Number);
+    if (result.ec != std::errc()) {
+        ThrowError("Invalid number");
+    }
+
+    _position += static_cast<size_t>(result.ptr - first);
+}
+
+void JsonDocument::SkipWhitespace()
+{
+    while (_position < _text.size()) {
+        char c = _text[_position];
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+            break;
+        }
+        ++_position;
+    }
+}
+
+void JsonDocument::Expect(char c)
+{
+    if (_position >= _text.size() || _text[_position] != c) {
+        throw Exception("Invalid JSON at line {}, expected '{}'", GetLine(), c);
+    }
+
+    ++_position;
+}
+
+void JsonDocument::ThrowError(const char * message) const
+{
+    throw Exception("Invalid JSON at line {}, {}", GetLine(), message);
+}
+
+size_t JsonDocument::GetLine() const
+{
+    auto end = _text.begin() + std::min(_position, _text.size());
+    return static_cast<size_t>(std::count(_text.begin(), end, '\n')) + 1;
+}
+
+} // namespace noon
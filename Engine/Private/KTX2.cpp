@@ -0,0 +1,283 @@
+#include <Noon/KTX2.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/Log.hpp>
+#include <Noon/TextureFormat.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace noon {
+
+NOON_API
+bool KTX2File::Parse(Span<const uint8_t> data)
+{
+    if (!ParseIndex(data, data.size())) {
+        return false;
+    }
+
+    for (const auto& levelIndex : _levelIndexList) {
+        _levelList.push_back(data.subspan(levelIndex.ByteOffset, levelIndex.ByteLength));
+    }
+
+    return true;
+}
+
+NOON_API
+bool KTX2File::ParseIndex(Span<const uint8_t> data, uint64_t fileSize)
+{
+    _format = VK_FORMAT_UNDEFINED;
+    _width = 0;
+    _height = 0;
+    _needsMipmaps = false;
+    _levelIndexList.clear();
+    _levelList.clear();
+
+    if (data.size() < sizeof(Header)) {
+        Log(NOON_ANCHOR, "KTX2 file is truncated");
+        return false;
+    }
+
+    Header header;
+    memcpy(&header, data.data(), sizeof(header));
+
+    if (memcmp(header.Identifier, Identifier, sizeof(Identifier)) != 0) {
+        Log(NOON_ANCHOR, "KTX2 file has an invalid identifier");
+        return false;
+    }
+
+    if (header.SupercompressionScheme != 0) {
+        Log(NOON_ANCHOR, "KTX2 supercompression scheme {} is not supported", header.SupercompressionScheme);
+        return false;
+    }
+
+    if (header.PixelWidth == 0 || header.PixelHeight == 0 || header.PixelDepth != 0 ||
+        header.LayerCount > 1 || header.FaceCount != 1) {
+        Log(NOON_ANCHOR, "KTX2 file is not a 2D texture");
+        return false;
+    }
+
+    VkFormat format = static_cast<VkFormat>(header.VkFormat);
+    if (GetTextureFormatBlockSize(format) == 0) {
+        Log(NOON_ANCHOR, "KTX2 format {} is not supported", header.VkFormat);
+        return false;
+    }
+
+    uint32_t maxLevelCount = GetMipLevelCount(header.PixelWidth, header.PixelHeight);
+    uint32_t levelCount = std::max(header.LevelCount, 1u);
+
+    if (levelCount > maxLevelCount) {
+        Log(NOON_ANCHOR, "KTX2 file has {} levels, at most {} are possible", levelCount, maxLevelCount);
+        return false;
+    }
+
+    if (data.size() < GetIndexSize(levelCount)) {
+        Log(NOON_ANCHOR, "KTX2 file is truncated");
+        return false;
+    }
+
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        LevelIndex levelIndex;
+        memcpy(&levelIndex, data.data() + GetIndexSize(i), sizeof(levelIndex));
+
+        uint32_t width = std::max(header.PixelWidth >> i, 1u);
+        uint32_t height = std::max(header.PixelHeight >> i, 1u);
+
+        if (levelIndex.ByteLength != GetTextureLevelSize(format, width, height) ||
+            levelIndex.ByteOffset > fileSize ||
+            levelIndex.ByteLength > fileSize - levelIndex.ByteOffset) {
+            _levelIndexList.clear();
+            Log(NOON_ANCHOR, "KTX2 file has an invalid level {}", i);
+            return false;
+        }
+
+        _levelIndexList.push_back(levelIndex);
+    }
+
+    _format = format;
+    _width = header.PixelWidth;
+    _height = header.PixelHeight;
+    _needsMipmaps = (header.LevelCount == 0);
+
+    return true;
+}
+
+struct DFDSample
+{
+    uint32_t BitOffset;
+
+    uint32_t BitLength;
+
+    // The channel ID, with the qualifier flags in the high 4 bits
+    uint32_t ChannelType;
+
+    uint32_t Upper;
+
+}; // struct DFDSample
+
+// A basic data format descriptor block, preceded by the total size
+// https://registry.khronos.org/DataFormat/specs/1.3/dataformat.1.3.html
+static List<uint32_t> BuildDFD(VkFormat format)
+{
+    // KHR_DF_MODEL_RGBSDA, and the block-compressed models
+    const uint32_t ModelRGBSDA = 1;
+    const uint32_t ModelBC1A = 128;
+    const uint32_t ModelBC3 = 130;
+    const uint32_t ModelBC4 = 131;
+    const uint32_t ModelBC5 = 132;
+    const uint32_t ModelBC7 = 134;
+
+    const uint32_t ChannelAlpha = 15;
+    const uint32_t QualifierLinear = 0x10;
+
+    uint32_t model = 0;
+    bool srgb = false;
+    List<DFDSample> sampleList;
+
+    switch (format) {
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        srgb = true;
+        [[fallthrough]];
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        model = ModelBC1A;
+        sampleList = { { 0, 64, 0, UINT32_MAX } };
+        break;
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        srgb = true;
+        [[fallthrough]];
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        // Channel 1 is "alpha present" for BC1
+        model = ModelBC1A;
+        sampleList = { { 0, 64, 1, UINT32_MAX } };
+        break;
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+        srgb = true;
+        [[fallthrough]];
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+        model = ModelBC3;
+        sampleList = { { 0, 64, ChannelAlpha | (srgb ? QualifierLinear : 0), UINT32_MAX }, { 64, 64, 0, UINT32_MAX } };
+        break;
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+        model = ModelBC4;
+        sampleList = { { 0, 64, 0, UINT32_MAX } };
+        break;
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+        model = ModelBC5;
+        sampleList = { { 0, 64, 0, UINT32_MAX }, { 64, 64, 1, UINT32_MAX } };
+        break;
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        srgb = true;
+        [[fallthrough]];
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+        model = ModelBC7;
+        sampleList = { { 0, 128, 0, UINT32_MAX } };
+        break;
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        srgb = true;
+        [[fallthrough]];
+    case VK_FORMAT_R8G8B8A8_UNORM:
+        model = ModelRGBSDA;
+        sampleList = {
+            { 0, 8, 0, 255 },
+            { 8, 8, 1, 255 },
+            { 16, 8, 2, 255 },
+            { 24, 8, ChannelAlpha | (srgb ? QualifierLinear : 0), 255 },
+        };
+        break;
+    default:
+        throw Exception("KTX2 format {} is not supported", static_cast<int>(format));
+    }
+
+    bool isBlockCompressed = IsBlockCompressedFormat(format);
+    uint32_t blockSize = sizeof(uint32_t) * (6 + (4 * static_cast<uint32_t>(sampleList.size())));
+
+    // Primaries are BT.709, transfer is sRGB or linear, and dimensions are stored minus one
+    List<uint32_t> dfd = {
+        blockSize + static_cast<uint32_t>(sizeof(uint32_t)),
+        0,
+        2 | (blockSize << 16),
+        model | (1 << 8) | ((srgb ? 2u : 1u) << 16),
+        (isBlockCompressed ? 0x00000303u : 0u),
+        GetTextureFormatBlockSize(format),
+        0,
+    };
+
+    for (const auto& sample : sampleList) {
+        dfd.push_back(sample.BitOffset | ((sample.BitLength - 1) << 16) | (sample.ChannelType << 24));
+        dfd.push_back(0);
+        dfd.push_back(0);
+        dfd.push_back(sample.Upper);
+    }
+
+    return dfd;
+}
+
+NOON_API
+List<uint8_t> KTX2File::Write(
+    VkFormat format,
+    uint32_t width,
+    uint32_t height,
+    Span<const Span<const uint8_t>> levelList)
+{
+    List<uint32_t> dfd = BuildDFD(format);
+
+    uint32_t levelCount = static_cast<uint32_t>(levelList.size());
+    if (levelCount == 0 || levelCount > GetMipLevelCount(width, height)) {
+        throw Exception("KTX2 file can't have {} levels", levelCount);
+    }
+
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        uint32_t levelWidth = std::max(width >> i, 1u);
+        uint32_t levelHeight = std::max(height >> i, 1u);
+
+        if (levelList[i].size() != GetTextureLevelSize(format, levelWidth, levelHeight)) {
+            throw Exception("KTX2 level {} has {} bytes, expected {}", i, levelList[i].size(),
+                GetTextureLevelSize(format, levelWidth, levelHeight));
+        }
+    }
+
+    // Levels start on a multiple of both the block size and 4
+    uint64_t alignment = std::lcm<uint64_t>(GetTextureFormatBlockSize(format), 4);
+
+    size_t dfdOffset = GetIndexSize(levelCount);
+    size_t dfdSize = dfd.size() * sizeof(uint32_t);
+
+    Header header = {};
+    memcpy(header.Identifier, Identifier, sizeof(Identifier));
+    header.VkFormat = static_cast<uint32_t>(format);
+    header.TypeSize = 1;
+    header.PixelWidth = width;
+    header.PixelHeight = height;
+    header.FaceCount = 1;
+    header.LevelCount = levelCount;
+    header.DFDByteOffset = static_cast<uint32_t>(dfdOffset);
+    header.DFDByteLength = static_cast<uint32_t>(dfdSize);
+
+    List<LevelIndex> levelIndexList(levelCount);
+
+    uint64_t offset = dfdOffset + dfdSize;
+    for (uint32_t i = levelCount; i-- > 0;) {
+        offset = ((offset + alignment - 1) / alignment) * alignment;
+
+        levelIndexList[i] = {
+            .ByteOffset = offset,
+            .ByteLength = levelList[i].size(),
+            .UncompressedByteLength = levelList[i].size(),
+        };
+
+        offset += levelList[i].size();
+    }
+
+    List<uint8_t> data(offset, 0);
+    memcpy(data.data(), &header, sizeof(header));
+    memcpy(data.data() + sizeof(header), levelIndexList.data(), sizeof(LevelIndex) * levelCount);
+    memcpy(data.data() + dfdOffset, dfd.data(), dfdSize);
+
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        memcpy(data.data() + levelIndexList[i].ByteOffset, levelList[i].data(), levelList[i].size());
+    }
+
+    return data;
+}
+
+} // namespace noon
@@ -0,0 +1,127 @@
+#include <Noon/MappedFile.hpp>
+#include <Noon/Log.hpp>
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    #include <Windows.h>
+
+#else
+
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+#endif
+
+namespace noon {
+
+NOON_API
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+NOON_API
+bool MappedFile::Open(const Path& path)
+{
+    Close();
+
+    _path = path;
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    HANDLE file = CreateFileW(
+        ConvertUTF8ToWideString(path.ToString()).c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void * data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    _fileHandle = file;
+    _mappingHandle = mapping;
+    _data = static_cast<const uint8_t *>(data);
+    _size = static_cast<size_t>(fileSize.QuadPart);
+
+#else
+
+    int fd = open(path.ToCString(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) < 0 || fileStat.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void * data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping holds its own reference to the file
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    _data = static_cast<const uint8_t *>(data);
+    _size = static_cast<size_t>(fileStat.st_size);
+
+#endif
+
+    return true;
+}
+
+NOON_API
+void MappedFile::Close()
+{
+    if (!_data) {
+        return;
+    }
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    UnmapViewOfFile(_data);
+    CloseHandle(_mappingHandle);
+    CloseHandle(_fileHandle);
+
+    _mappingHandle = nullptr;
+    _fileHandle = nullptr;
+
+#else
+
+    munmap(const_cast<uint8_t *>(_data), _size);
+
+#endif
+
+    _data = nullptr;
+    _size = 0;
+}
+
+} // namespace noon
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include <Noon/Mesh.hpp>
+#include <Noon/Application.hpp>
+#include <Noon/Exception.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace noon {
+
+// Returns the first index that is out of range, or vertexCount if there are none
+template <typename T>
+static uint32_t FindIndexOutOfRange(Span<const uint8_t> indexData, uint32_t vertexCount)
+{
+    for (size_t offset = 0; offset < indexData.size(); offset += sizeof(T)) {
+        T index;
+        memcpy(&index, indexData.data() + offset, sizeof(T));
+        if (index >= vertexCount) {
+            return static_cast<uint32_t>(index);
+        }
+    }
+
+    return vertexCount;
+}
+
+Mesh::Mesh(const VertexData& vertexData, Span<const uint32_t> indexList, Span<const MeshLOD> lodList)
+    : _vertexFormat(VertexFormat::Choose(vertexData))
+{
+    Init(vertexData, indexList);
+    InitLODList(lodList);
+}
+
+Mesh::Mesh(const VertexData& vertexData, const VertexFormat& vertexFormat, Span<const uint32_t> indexList, Span<const MeshLOD> lodList)
+    : _vertexFormat(vertexFormat)
+{
+    Init(vertexData, indexList);
+    InitLODList(lodList);
+}
+
+Mesh::Mesh(const VertexFormat& vertexFormat, const ShaderMesh& shaderMesh, uint32_t vertexCount, Span<const uint8_t> vertexData, VkIndexType indexType, uint32_t indexCount, Span<const uint8_t> indexData, Span<const MeshLOD> lodList)
+    : _vertexFormat(vertexFormat)
+    , _vertexCount(vertexCount)
+    , _shaderMesh(shaderMesh)
+    , _indexCount(indexCount)
+    , _vkIndexType(indexType)
+{
+    if (vertexCount == 0 || vertexData.size() != size_t(vertexCount) * _vertexFormat.GetStride()) {
+        throw Exception("Expected {} bytes of vertex data for {} vertices, got {}",
+            size_t(vertexCount) * _vertexFormat.GetStride(), vertexCount, vertexData.size());
+    }
+
+    size_t indexSize = (indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t));
+    if (indexData.size() != indexCount * indexSize) {
+        throw Exception("Expected {} bytes of index data for {} indices, got {}",
+            indexCount * indexSize, indexCount, indexData.size());
+    }
+
+    if (indexCount % 3 != 0) {
+        throw Exception("Index count {} is not a multiple of 3", indexCount);
+    }
+
+    uint32_t index = (indexType == VK_INDEX_TYPE_UINT16
+        ? FindIndexOutOfRange<uint16_t>(indexData, vertexCount)
+        : FindIndexOutOfRange<uint32_t>(indexData, vertexCount));
+
+    if (index != vertexCount) {
+        throw Exception("Index {} is out of range for {} vertices", index, vertexCount);
+    }
+
+    // The data is only read, to fill the staging buffer
+    _vertexBuffer = std::make_unique<Buffer>(
+        vertexData.size(),
+        const_cast<uint8_t *>(vertexData.data()),
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY);
+
+    if (indexCount > 0) {
+        _indexBuffer = std::make_unique<Buffer>(
+            indexData.size(),
+            const_cast<uint8_t *>(indexData.data()),
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY);
+    }
+
+    InitLODList(lodList);
+}
+
+void Mesh::Draw(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance, uint32_t lod)
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    vkCmdBindPipeline(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        gfx->GetMeshPipeline(_vertexFormat));
+
+    vkCmdPushConstants(
+        commandBuffer,
+        gfx->GetPipelineLayout(),
+        VK_SHADER_STAGE_VERTEX_BIT,
+        0,
+        sizeof(_shaderMesh),
+        &_shaderMesh);
+
+    // Buffers can be moved by the Defragmenter, so their handles are fetched every time
+    Array<VkBuffer, 2> vertexBufferList = {
+        _vertexBuffer->GetBuffer(),
+        gfx->GetDefaultVertexBuffer()->GetBuffer(),
+    };
+
+    Array<VkDeviceSize, 2> offsetList = { 0, 0 };
+
+    vkCmdBindVertexBuffers(
+        commandBuffer,
+        VertexFormat::VertexBinding,
+        static_cast<uint32_t>(vertexBufferList.size()),
+        vertexBufferList.data(),
+        offsetList.data());
+
+    if (_indexBuffer) {
+        vkCmdBindIndexBuffer(
+            commandBuffer,
+            _indexBuffer->GetBuffer(),
+            0,
+            _vkIndexType);
+
+        const auto& range = _lodList[std::min(lod, GetLODCount() - 1)];
+        vkCmdDrawIndexed(commandBuffer, range.IndexCount, instanceCount, range.FirstIndex, 0, firstInstance);
+    }
+    else {
+        vkCmdDraw(commandBuffer, _vertexCount, instanceCount, 0, firstInstance);
+    }
+}
+
+void Mesh::Init(const VertexData& vertexData, Span<const uint32_t> indexList)
+{
+    if (vertexData.Positions.empty()) {
+        throw Exception("Unable to create a mesh without any vertices");
+    }
+
+    _vertexCount = static_cast<uint32_t>(vertexData.GetVertexCount());
+
+    auto data = _vertexFormat.Pack(vertexData, &_shaderMesh);
+
+    _vertexBuffer = std::make_unique<Buffer>(
+        data.size(),
+        data.data(),
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY);
+
+    if (!indexList.empty()) {
+        InitIndexBuffer(indexList);
+    }
+}
+
+void Mesh::InitIndexBuffer(Span<const uint32_t> indexList)
+{
+    if (indexList.size() % 3 != 0) {
+        throw Exception("Index count {} is not a multiple of 3", indexList.size());
+    }
+
+    for (uint32_t index : indexList) {
+        if (index >= _vertexCount) {
+            throw Exception("Index {} is out of range for {} vertices", index, _vertexCount);
+        }
+    }
+
+    _indexCount = static_cast<uint32_t>(indexList.size());
+
+    // Primitive restart is never enabled, so all 65536 values are usable
+    if (_vertexCount <= 0x10000) {
+        _vkIndexType = VK_INDEX_TYPE_UINT16;
+
+        List<uint16_t> shortIndexList(indexList.begin(), indexList.end());
+
+        _indexBuffer = std::make_unique<Buffer>(
+            shortIndexList.size() * sizeof(uint16_t),
+            reinterpret_cast<uint8_t *>(shortIndexList.data()),
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY);
+    }
+    else {
+        _vkIndexType = VK_INDEX_TYPE_UINT32;
+
+        List<uint32_t> longIndexList(indexList.begin(), indexList.end());
+
+        _indexBuffer = std::make_unique<Buffer>(
+            longIndexList.size() * sizeof(uint32_t),
+            reinterpret_cast<uint8_t *>(longIndexList.data()),
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY);
+    }
+}
+
+void Mesh::InitLODList(Span<const MeshLOD> lodList)
+{
+    if (lodList.empty()) {
+        _lodList = { MeshLOD{ .FirstIndex = 0, .IndexCount = (_indexBuffer ? _indexCount : _vertexCount), .Error = 0.0f } };
+        return;
+    }
+
+    if (!_indexBuffer) {
+        throw Exception("Unable to draw levels of detail without indices");
+    }
+
+    if (lodList.size() > MaxMeshLODCount) {
+        throw Exception("{} levels of detail is more than the limit of {}", lodList.size(), MaxMeshLODCount);
+    }
+
+    for (const auto& lod : lodList) {
+        if (lod.IndexCount % 3 != 0 || uint64_t(lod.FirstIndex) + lod.IndexCount > _indexCount) {
+            throw Exception("Level of detail with indices [{}, {}) is out of range for {} indices",
+                lod.FirstIndex, uint64_t(lod.FirstIndex) + lod.IndexCount, _indexCount);
+        }
+    }
+
+    _lodList.assign(lodList.begin(), lodList.end());
+}
+
+} // namespace noon
@@ -0,0 +1,45 @@
+#include <Noon/MeshLOD.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace noon {
+
+NOON_API
+float GetLODScale(const Mat4& projection, float viewportHeight)
+{
+    // projection[1][1] is 1 / tan(fovY / 2), and negative when Y is flipped for Vulkan
+    return 0.5f * viewportHeight * std::abs(projection[1][1]);
+}
+
+NOON_API
+uint32_t SelectLOD(const LODSettings& settings, Span<const MeshLOD> lodList, const BoundingSphere& bounds, uint32_t currentLOD)
+{
+    uint32_t lodCount = static_cast<uint32_t>(lodList.size());
+    if (lodCount <= 1 || settings.Scale <= 0.0f) {
+        return 0;
+    }
+
+    currentLOD = std::min(currentLOD, lodCount - 1);
+
+    float distance = glm::length(bounds.Center - settings.CameraPosition) - bounds.Radius;
+    if (distance <= 0.0f) {
+        return 0;
+    }
+
+    // Error * Radius * Scale / distance <= Threshold, without the division
+    float errorScale = bounds.Radius * settings.Scale;
+    float limit = settings.Threshold * distance;
+    float coarserLimit = limit * (1.0f - settings.Hysteresis);
+
+    // Errors only grow with each level, so the first one within its limit is the coarsest
+    for (uint32_t lod = lodCount - 1; lod > 0; --lod) {
+        if (lodList[lod].Error * errorScale <= (lod > currentLOD ? coarserLimit : limit)) {
+            return lod;
+        }
+    }
+
+    return 0;
+}
+
+} // namespace noon
@@ -0,0 +1,1088 @@
+#include <Noon/MeshOptimizer.hpp>
+#include <Noon/Bounds.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/Log.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+namespace noon {
+
+static const uint32_t UnusedVertex = UINT32_MAX;
+
+// Simulates a FIFO post-transform cache, a vertex is cached if fewer than cacheSize other
+// vertices have been transformed since it was
+class VertexCacheSimulation
+{
+public:
+
+    VertexCacheSimulation(size_t vertexCount, uint32_t cacheSize)
+        : _cacheSize(cacheSize)
+        , _timestampList(vertexCount, 0)
+    {
+        Reset();
+    }
+
+    inline void Reset() {
+        _time += _cacheSize + 1;
+    }
+
+    // Returns the number of vertices that had to be transformed
+    inline unsigned Triangle(uint32_t a, uint32_t b, uint32_t c) {
+        return Vertex(a) + Vertex(b) + Vertex(c);
+    }
+
+private:
+
+    inline unsigned Vertex(uint32_t v) {
+        if (_time - _timestampList[v] > _cacheSize) {
+            _timestampList[v] = _time++;
+            return 1;
+        }
+        return 0;
+    }
+
+    uint32_t _cacheSize;
+
+    uint32_t _time = 0;
+
+    List<uint32_t> _timestampList;
+
+}; // class VertexCacheSimulation
+
+static void CheckIndexList(Span<const uint32_t> indexList, size_t vertexCount)
+{
+    if (indexList.size() % 3 != 0) {
+        throw Exception("Index count {} is not a multiple of 3", indexList.size());
+    }
+
+    for (uint32_t index : indexList) {
+        if (index >= vertexCount) {
+            throw Exception("Index {} is out of range for {} vertices", index, vertexCount);
+        }
+    }
+}
+
+VertexCacheStats AnalyzeVertexCache(Span<const uint32_t> indexList, size_t vertexCount, uint32_t cacheSize)
+{
+    CheckIndexList(indexList, vertexCount);
+
+    VertexCacheSimulation cache(vertexCount, cacheSize);
+
+    size_t misses = 0;
+    for (size_t i = 0; i < indexList.size(); i += 3) {
+        misses += cache.Triangle(indexList[i], indexList[i + 1], indexList[i + 2]);
+    }
+
+    size_t triangleCount = indexList.size() / 3;
+
+    return VertexCacheStats{
+        .ACMR = (triangleCount > 0 ? static_cast<float>(misses) / static_cast<float>(triangleCount) : 0.0f),
+        .ATVR = (vertexCount > 0 ? static_cast<float>(misses) / static_cast<float>(vertexCount) : 0.0f),
+    };
+}
+
+// The cache size the scores are tuned for, larger than any real cache so that the order
+// degrades gracefully on all of them
+static const int ForsythCacheSize = 32;
+
+static float ForsythVertexScore(int cachePosition, uint32_t remainingTriangles)
+{
+    // Vertices with no triangles left should never attract more triangles
+    if (remainingTriangles == 0) {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        // The last triangle's vertices get a fixed score, otherwise the next triangle would
+        // always be the one sharing an edge with it, which makes long thin strips
+        if (cachePosition < 3) {
+            score = 0.75f;
+        }
+        else {
+            float scale = 1.0f / static_cast<float>(ForsythCacheSize - 3);
+            score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, 1.5f);
+        }
+    }
+
+    // Favor vertices with few triangles left, so they are finished and leave the cache
+    score += 2.0f * std::pow(static_cast<float>(remainingTriangles), -0.5f);
+
+    return score;
+}
+
+void OptimizeVertexCache(Span<uint32_t> indexList, size_t vertexCount)
+{
+    CheckIndexList(indexList, vertexCount);
+
+    size_t triangleCount = indexList.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // Triangles using each vertex, the first remainingList[v] of them are not yet emitted
+    List<uint32_t> remainingList(vertexCount, 0);
+    for (uint32_t index : indexList) {
+        ++remainingList[index];
+    }
+
+    List<uint32_t> offsetList(vertexCount + 1, 0);
+    std::partial_sum(remainingList.begin(), remainingList.end(), offsetList.begin() + 1);
+
+    List<uint32_t> adjacencyList(indexList.size());
+    {
+        List<uint32_t> cursorList(offsetList.begin(), offsetList.end() - 1);
+        for (size_t i = 0; i < indexList.size(); ++i) {
+            adjacencyList[cursorList[indexList[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    List<int> cachePositionList(vertexCount, -1);
+
+    List<float> vertexScoreList(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        vertexScoreList[v] = ForsythVertexScore(-1, remainingList[v]);
+    }
+
+    List<float> triangleScoreList(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        triangleScoreList[t] = (
+            vertexScoreList[indexList[t * 3]] +
+            vertexScoreList[indexList[t * 3 + 1]] +
+            vertexScoreList[indexList[t * 3 + 2]]
+        );
+    }
+
+    List<uint8_t> emittedList(triangleCount, 0);
+
+    List<uint32_t> outputList;
+    outputList.reserve(indexList.size());
+
+    // The three extra entries hold vertices pushed out by the last triangle, so their
+    // scores can be updated
+    Array<uint32_t, ForsythCacheSize + 3> cache;
+    size_t cacheCount = 0;
+
+    size_t bestTriangle = std::distance(triangleScoreList.begin(),
+        std::max_element(triangleScoreList.begin(), triangleScoreList.end()));
+
+    size_t nextTriangle = 0;
+
+    while (outputList.size() < indexList.size()) {
+        // Nothing in the cache is connected to a remaining triangle, so start somewhere new
+        if (bestTriangle == SIZE_MAX) {
+            while (emittedList[nextTriangle]) {
+                ++nextTriangle;
+            }
+            bestTriangle = nextTriangle;
+        }
+
+        const uint32_t * triangle = &indexList[bestTriangle * 3];
+        emittedList[bestTriangle] = 1;
+
+        for (int k = 0; k < 3; ++k) {
+            uint32_t v = triangle[k];
+            outputList.push_back(v);
+
+            // Move the triangle past the end of the vertex's remaining triangles
+            uint32_t * begin = &adjacencyList[offsetList[v]];
+            uint32_t * end = begin + remainingList[v];
+            std::iter_swap(std::find(begin, end, static_cast<uint32_t>(bestTriangle)), end - 1);
+            --remainingList[v];
+        }
+
+        Array<uint32_t, ForsythCacheSize + 3> newCache;
+        size_t newCacheCount = 0;
+
+        for (int k = 0; k < 3; ++k) {
+            newCache[newCacheCount++] = triangle[k];
+        }
+
+        for (size_t i = 0; i < cacheCount; ++i) {
+            uint32_t v = cache[i];
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                newCache[newCacheCount++] = v;
+            }
+        }
+
+        for (size_t i = 0; i < newCacheCount; ++i) {
+            uint32_t v = newCache[i];
+            cachePositionList[v] = (i < ForsythCacheSize ? static_cast<int>(i) : -1);
+            vertexScoreList[v] = ForsythVertexScore(cachePositionList[v], remainingList[v]);
+        }
+
+        // Only triangles touching the cache changed score, and one of them is almost
+        // always the best
+        bestTriangle = SIZE_MAX;
+        float bestScore = -1.0f;
+
+        for (size_t i = 0; i < newCacheCount; ++i) {
+            uint32_t v = newCache[i];
+            for (uint32_t j = 0; j < remainingList[v]; ++j) {
+                uint32_t t = adjacencyList[offsetList[v] + j];
+                triangleScoreList[t] = (
+                    vertexScoreList[indexList[t * 3]] +
+                    vertexScoreList[indexList[t * 3 + 1]] +
+                    vertexScoreList[indexList[t * 3 + 2]]
+                );
+
+                if (triangleScoreList[t] > bestScore) {
+                    bestScore = triangleScoreList[t];
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        cacheCount = std::min<size_t>(newCacheCount, ForsythCacheSize);
+        std::copy(newCache.begin(), newCache.begin() + cacheCount, cache.begin());
+    }
+
+    std::copy(outputList.begin(), outputList.end(), indexList.begin());
+}
+
+// Based on "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" by Sander,
+// Nehab and Barczak, with clusters sorted by how much they face away from the mesh's center
+void OptimizeOverdraw(Span<uint32_t> indexList, const List<Vec3>& positionList, float threshold)
+{
+    size_t vertexCount = positionList.size();
+    CheckIndexList(indexList, vertexCount);
+
+    size_t triangleCount = indexList.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    float meshACMR = AnalyzeVertexCache(indexList, vertexCount).ACMR;
+
+    VertexCacheSimulation cache(vertexCount, 16);
+
+    // Triangles that miss on every vertex are where the cache optimizer started over, so
+    // clusters can be split there for free
+    List<size_t> hardBoundaryList;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        unsigned misses = cache.Triangle(indexList[t * 3], indexList[t * 3 + 1], indexList[t * 3 + 2]);
+        if (t == 0 || misses == 3) {
+            hardBoundaryList.push_back(t);
+        }
+    }
+
+    hardBoundaryList.push_back(triangleCount);
+
+    // Split further once a cluster is about as cache efficient as the whole mesh
+    List<size_t> clusterList;
+    for (size_t h = 0; h + 1 < hardBoundaryList.size(); ++h) {
+        size_t end = hardBoundaryList[h + 1];
+        size_t start = hardBoundaryList[h];
+
+        clusterList.push_back(start);
+
+        cache.Reset();
+        size_t misses = 0;
+
+        for (size_t t = start; t < end; ++t) {
+            misses += cache.Triangle(indexList[t * 3], indexList[t * 3 + 1], indexList[t * 3 + 2]);
+
+            float clusterACMR = static_cast<float>(misses) / static_cast<float>(t - start + 1);
+            if (t + 1 < end && clusterACMR <= meshACMR * threshold) {
+                start = t + 1;
+                clusterList.push_back(start);
+
+                cache.Reset();
+                misses = 0;
+            }
+        }
+    }
+
+    clusterList.push_back(triangleCount);
+
+    Vec3 meshCentroid(0.0f);
+    for (const auto& position : positionList) {
+        meshCentroid += position;
+    }
+
+    meshCentroid /= static_cast<float>(std::max<size_t>(vertexCount, 1));
+
+    size_t clusterCount = clusterList.size() - 1;
+
+    List<float> sortKeyList(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        Vec3 centroid(0.0f);
+        Vec3 normal(0.0f);
+        float area = 0.0f;
+
+        for (size_t t = clusterList[c]; t < clusterList[c + 1]; ++t) {
+            const Vec3& p0 = positionList[indexList[t * 3]];
+            const Vec3& p1 = positionList[indexList[t * 3 + 1]];
+            const Vec3& p2 = positionList[indexList[t * 3 + 2]];
+
+            Vec3 n = glm::cross(p1 - p0, p2 - p0);
+            float a = glm::length(n);
+
+            centroid += (p0 + p1 + p2) * (a / 3.0f);
+            normal += n;
+            area += a;
+        }
+
+        if (area > 0.0f) {
+            centroid /= area;
+        }
+
+        float length = glm::length(normal);
+        if (length > 0.0f) {
+            normal /= length;
+        }
+
+        // Clusters on the outside facing out are likely to occlude the rest of the mesh
+        sortKeyList[c] = glm::dot(centroid - meshCentroid, normal);
+    }
+
+    List<size_t> orderList(clusterCount);
+    std::iota(orderList.begin(), orderList.end(), 0);
+
+    std::stable_sort(orderList.begin(), orderList.end(),
+        [&](size_t a, size_t b) {
+            return sortKeyList[a] > sortKeyList[b];
+        });
+
+    List<uint32_t> outputList;
+    outputList.reserve(indexList.size());
+
+    for (size_t c : orderList) {
+        outputList.insert(outputList.end(),
+            indexList.begin() + clusterList[c] * 3,
+            indexList.begin() + clusterList[c + 1] * 3);
+    }
+
+    std::copy(outputList.begin(), outputList.end(), indexList.begin());
+}
+
+template <typename T>
+static void RemapVertices(List<T>& list, const List<uint32_t>& remapList, uint32_t newVertexCount)
+{
+    if (list.empty()) {
+        return;
+    }
+
+    List<T> result(newVertexCount);
+    for (size_t v = 0; v < list.size(); ++v) {
+        if (remapList[v] != UnusedVertex) {
+            result[remapList[v]] = list[v];
+        }
+    }
+
+    list = std::move(result);
+}
+
+void OptimizeVertexFetch(Span<uint32_t> indexList, VertexData& vertexData)
+{
+    size_t vertexCount = vertexData.GetVertexCount();
+    CheckIndexList(indexList, vertexCount);
+
+    List<uint32_t> remapList(vertexCount, UnusedVertex);
+    uint32_t newVertexCount = 0;
+
+    for (uint32_t& index : indexList) {
+        if (remapList[index] == UnusedVertex) {
+            remapList[index] = newVertexCount++;
+        }
+        index = remapList[index];
+    }
+
+    RemapVertices(vertexData.Positions, remapList, newVertexCount);
+    RemapVertices(vertexData.Normals, remapList, newVertexCount);
+    RemapVertices(vertexData.Tangents, remapList, newVertexCount);
+    RemapVertices(vertexData.Colors, remapList, newVertexCount);
+    RemapVertices(vertexData.TexCoords1, remapList, newVertexCount);
+    RemapVertices(vertexData.TexCoords2, remapList, newVertexCount);
+    RemapVertices(vertexData.Joints, remapList, newVertexCount);
+    RemapVertices(vertexData.Weights, remapList, newVertexCount);
+}
+
+void OptimizeMesh(VertexData& vertexData, Span<uint32_t> indexList)
+{
+    size_t vertexCount = vertexData.GetVertexCount();
+
+    auto before = AnalyzeVertexCache(indexList, vertexCount);
+
+    OptimizeVertexCache(indexList, vertexCount);
+    OptimizeOverdraw(indexList, vertexData.Positions);
+    OptimizeVertexFetch(indexList, vertexData);
+
+    auto after = AnalyzeVertexCache(indexList, vertexData.GetVertexCount());
+
+    Log(NOON_ANCHOR, "Optimized {} triangles, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, {} unused vertices removed",
+        indexList.size() / 3,
+        before.ACMR, after.ACMR,
+        before.ATVR, after.ATVR,
+        vertexCount - vertexData.GetVertexCount());
+}
+
+// How each vertex may be collapsed, shared by every vertex at the same position
+enum class VertexKind : uint8_t
+{
+    // Every edge has a triangle on both sides, and all triangles share its attributes
+    Manifold,
+
+    // On a single open edge loop of the mesh
+    Border,
+
+    // Two vertices at the same position with different attributes, on either side of a UV or
+    // normal seam, whose open edges pair up with each other
+    Seam,
+
+    // Anything else, such as corners, seams meeting and non-manifold fans
+    Locked,
+
+}; // enum class VertexKind
+
+static const size_t VertexKindCount = 4;
+
+// Whether a vertex of the first kind can be collapsed onto one of the second
+static const bool CanCollapse[VertexKindCount][VertexKindCount] = {
+    { true, true, true, true },
+    { false, true, false, true },
+    { false, false, true, true },
+    { false, false, false, false },
+};
+
+// Whether an edge between the two kinds is also found going the other way, considering
+// positions only, so it is only picked once
+static const bool HasOpposite[VertexKindCount][VertexKindCount] = {
+    { true, true, true, true },
+    { true, false, true, false },
+    { true, true, true, true },
+    { true, false, true, false },
+};
+
+// Border and seam edges weigh more than surfaces, so they only move when nothing else can
+static const double BoundaryEdgeWeight = 10.0;
+
+// The sum of the squared distances to a set of weighted planes
+struct Quadric
+{
+    double A00 = 0.0, A11 = 0.0, A22 = 0.0;
+
+    double A10 = 0.0, A20 = 0.0, A21 = 0.0;
+
+    double B0 = 0.0, B1 = 0.0, B2 = 0.0;
+
+    double C = 0.0;
+
+    double Weight = 0.0;
+
+    static Quadric FromPlane(const glm::dvec3& normal, double distance, double weight) {
+        return Quadric{
+            .A00 = normal.x * normal.x * weight,
+            .A11 = normal.y * normal.y * weight,
+            .A22 = normal.z * normal.z * weight,
+            .A10 = normal.y * normal.x * weight,
+            .A20 = normal.z * normal.x * weight,
+            .A21 = normal.z * normal.y * weight,
+            .B0 = normal.x * distance * weight,
+            .B1 = normal.y * distance * weight,
+            .B2 = normal.z * distance * weight,
+            .C = distance * distance * weight,
+            .Weight = weight,
+        };
+    }
+
+    // The plane of the triangle, weighted by its area
+    static Quadric FromTriangle(const glm::dvec3& p0, const glm::dvec3& p1, const glm::dvec3& p2) {
+        glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+        double area = glm::length(normal);
+        if (area > 0.0) {
+            normal /= area;
+        }
+
+        return FromPlane(normal, -glm::dot(normal, p0), area);
+    }
+
+    // The plane through the edge from p0 to p1 perpendicular to the triangle, which keeps the
+    // edge from moving sideways, weighted by its squared length
+    static Quadric FromTriangleEdge(const glm::dvec3& p0, const glm::dvec3& p1, const glm::dvec3& p2, double weight) {
+        glm::dvec3 edge = p1 - p0;
+        double length = glm::length(edge);
+        if (length > 0.0) {
+            edge /= length;
+        }
+
+        glm::dvec3 normal = p2 - p0;
+        normal -= edge * glm::dot(normal, edge);
+
+        double normalLength = glm::length(normal);
+        if (normalLength > 0.0) {
+            normal /= normalLength;
+        }
+
+        return FromPlane(normal, -glm::dot(normal, p0), length * length * weight);
+    }
+
+    inline void Add(const Quadric& other) {
+        A00 += other.A00;
+        A11 += other.A11;
+        A22 += other.A22;
+        A10 += other.A10;
+        A20 += other.A20;
+        A21 += other.A21;
+        B0 += other.B0;
+        B1 += other.B1;
+        B2 += other.B2;
+        C += other.C;
+        Weight += other.Weight;
+    }
+
+    // The mean squared distance of point to the planes
+    inline double GetError(const Vec3& point) const {
+        double x = point.x;
+        double y = point.y;
+        double z = point.z;
+
+        double error =
+            A00 * x * x + A11 * y * y + A22 * z * z +
+            2.0 * (A10 * x * y + A20 * x * z + A21 * y * z) +
+            2.0 * (B0 * x + B1 * y + B2 * z) +
+            C;
+
+        return (Weight > 0.0 ? std::abs(error) / Weight : 0.0);
+    }
+
+}; // struct Quadric
+
+// For each vertex, the next and previous vertex of every triangle around it
+class TriangleAdjacency
+{
+public:
+
+    struct Corner
+    {
+        uint32_t Next;
+
+        uint32_t Prev;
+
+    }; // struct Corner
+
+    // When remapList is set, vertices are replaced with their remapped index
+    void Build(Span<const uint32_t> indexList, size_t vertexCount, const uint32_t * remapList) {
+        auto map = [&](uint32_t index) {
+            return (remapList ? remapList[index] : index);
+        };
+
+        _offsetList.assign(vertexCount + 1, 0);
+        for (uint32_t index : indexList) {
+            ++_offsetList[map(index) + 1];
+        }
+
+        std::partial_sum(_offsetList.begin(), _offsetList.end(), _offsetList.begin());
+
+        _cornerList.resize(indexList.size());
+
+        List<uint32_t> fillList(_offsetList.begin(), _offsetList.end() - 1);
+        for (size_t i = 0; i < indexList.size(); i += 3) {
+            uint32_t a = map(indexList[i]);
+            uint32_t b = map(indexList[i + 1]);
+            uint32_t c = map(indexList[i + 2]);
+
+            _cornerList[fillList[a]++] = { b, c };
+            _cornerList[fillList[b]++] = { c, a };
+            _cornerList[fillList[c]++] = { a, b };
+        }
+    }
+
+    inline Span<const Corner> Get(uint32_t vertex) const {
+        return Span<const Corner>(_cornerList.data() + _offsetList[vertex], _offsetList[vertex + 1] - _offsetList[vertex]);
+    }
+
+    inline bool HasEdge(uint32_t from, uint32_t to) const {
+        for (const auto& corner : Get(from)) {
+            if (corner.Next == to) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+
+    List<uint32_t> _offsetList;
+
+    List<Corner> _cornerList;
+
+}; // class TriangleAdjacency
+
+// remapList maps each vertex to the first one at the same position, and wedgeList links the
+// vertices at each position into a cycle
+static void BuildPositionRemap(const List<Vec3>& positionList, List<uint32_t>& remapList, List<uint32_t>& wedgeList)
+{
+    size_t vertexCount = positionList.size();
+
+    List<uint32_t> orderList(vertexCount);
+    std::iota(orderList.begin(), orderList.end(), 0);
+
+    auto less = [&](uint32_t a, uint32_t b) {
+        const Vec3& pa = positionList[a];
+        const Vec3& pb = positionList[b];
+        if (pa.x != pb.x) {
+            return pa.x < pb.x;
+        }
+        if (pa.y != pb.y) {
+            return pa.y < pb.y;
+        }
+        if (pa.z != pb.z) {
+            return pa.z < pb.z;
+        }
+        return a < b;
+    };
+
+    std::sort(orderList.begin(), orderList.end(), less);
+
+    remapList.resize(vertexCount);
+    wedgeList.resize(vertexCount);
+
+    for (size_t first = 0; first < vertexCount; ) {
+        size_t last = first + 1;
+        while (last < vertexCount && positionList[orderList[last]] == positionList[orderList[first]]) {
+            ++last;
+        }
+
+        for (size_t i = first; i < last; ++i) {
+            remapList[orderList[i]] = orderList[first];
+            wedgeList[orderList[i]] = orderList[(i + 1 < last ? i + 1 : first)];
+        }
+
+        first = last;
+    }
+}
+
+// loopList and loopBackList are set to the next and previous vertex along the open edge of
+// Border and Seam vertices
+static void ClassifyVertices(
+    const TriangleAdjacency& adjacency,
+    const List<uint32_t>& remapList,
+    const List<uint32_t>& wedgeList,
+    List<VertexKind>& kindList,
+    List<uint32_t>& loopList,
+    List<uint32_t>& loopBackList)
+{
+    size_t vertexCount = remapList.size();
+
+    // UnusedVertex when there are no open edges, and the vertex itself when there are several
+    loopList.assign(vertexCount, UnusedVertex);
+    loopBackList.assign(vertexCount, UnusedVertex);
+
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex) {
+        for (const auto& corner : adjacency.Get(vertex)) {
+            uint32_t target = corner.Next;
+            if (!adjacency.HasEdge(target, vertex)) {
+                loopBackList[target] = (loopBackList[target] == UnusedVertex ? vertex : target);
+                loopList[vertex] = (loopList[vertex] == UnusedVertex ? target : vertex);
+            }
+        }
+    }
+
+    auto hasSingleLoop = [&](uint32_t vertex) {
+        return (
+            loopList[vertex] != UnusedVertex && loopList[vertex] != vertex &&
+            loopBackList[vertex] != UnusedVertex && loopBackList[vertex] != vertex
+        );
+    };
+
+    kindList.resize(vertexCount);
+
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex) {
+        if (remapList[vertex] != vertex) {
+            continue;
+        }
+
+        VertexKind kind = VertexKind::Locked;
+
+        if (wedgeList[vertex] == vertex) {
+            if (loopList[vertex] == UnusedVertex && loopBackList[vertex] == UnusedVertex) {
+                kind = VertexKind::Manifold;
+            }
+            else if (hasSingleLoop(vertex)) {
+                kind = VertexKind::Border;
+            }
+        }
+        else if (wedgeList[wedgeList[vertex]] == vertex) {
+            // The open edges of each side must lead to the same positions as the other side's,
+            // going the other way
+            uint32_t other = wedgeList[vertex];
+            if (hasSingleLoop(vertex) && hasSingleLoop(other) &&
+                remapList[loopBackList[vertex]] == remapList[loopList[other]] &&
+                remapList[loopList[vertex]] == remapList[loopBackList[other]]) {
+                kind = VertexKind::Seam;
+            }
+        }
+
+        kindList[vertex] = kind;
+    }
+
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex) {
+        kindList[vertex] = kindList[remapList[vertex]];
+    }
+}
+
+static bool IsBoundary(VertexKind kind)
+{
+    return (kind == VertexKind::Border || kind == VertexKind::Seam);
+}
+
+// Whether moving any triangle around from onto to, other than those collapsing with the
+// edge, would flip it
+static bool HasTriangleFlips(
+    const TriangleAdjacency& positionAdjacency,
+    const List<Vec3>& positionList,
+    const List<uint32_t>& remapList,
+    const List<uint32_t>& collapseRemapList,
+    uint32_t from,
+    uint32_t to)
+{
+    Vec3 p0 = positionList[from];
+    Vec3 p1 = positionList[to];
+
+    for (const auto& corner : positionAdjacency.Get(from)) {
+        // Neighbors may have been moved earlier in the pass
+        uint32_t a = remapList[collapseRemapList[corner.Next]];
+        uint32_t b = remapList[collapseRemapList[corner.Prev]];
+
+        if (a == to || b == to || a == b) {
+            continue;
+        }
+
+        Vec3 edge = positionList[b] - positionList[a];
+        Vec3 before = glm::cross(edge, p0 - positionList[a]);
+        Vec3 after = glm::cross(edge, p1 - positionList[a]);
+
+        if (glm::dot(before, after) <= 0.0f) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+struct EdgeCollapse
+{
+    uint32_t From;
+
+    uint32_t To;
+
+    // Either way round, the cheaper one is picked once the errors are known
+    bool Bidirectional;
+
+    double Error;
+
+}; // struct EdgeCollapse
+
+List<uint32_t> SimplifyMesh(
+    Span<const uint32_t> indexList,
+    const List<Vec3>& positionList,
+    size_t targetIndexCount,
+    float maxError,
+    float * resultError)
+{
+    size_t vertexCount = positionList.size();
+    CheckIndexList(indexList, vertexCount);
+
+    List<uint32_t> resultList(indexList.begin(), indexList.end());
+
+    if (resultError) {
+        *resultError = 0.0f;
+    }
+
+    double radius = BoundingSphere::FromPoints(positionList).Radius;
+    if (resultList.size() <= targetIndexCount || radius <= 0.0) {
+        return resultList;
+    }
+
+    List<uint32_t> remapList;
+    List<uint32_t> wedgeList;
+    BuildPositionRemap(positionList, remapList, wedgeList);
+
+    TriangleAdjacency adjacency;
+    adjacency.Build(resultList, vertexCount, nullptr);
+
+    List<VertexKind> kindList;
+    List<uint32_t> loopList;
+    List<uint32_t> loopBackList;
+    ClassifyVertices(adjacency, remapList, wedgeList, kindList, loopList, loopBackList);
+
+    auto getPosition = [&](uint32_t index) {
+        return glm::dvec3(positionList[index]);
+    };
+
+    // Quadrics are kept per position, so both sides of a seam share theirs
+    List<Quadric> quadricList(vertexCount);
+
+    for (size_t i = 0; i < resultList.size(); i += 3) {
+        Quadric quadric = Quadric::FromTriangle(
+            getPosition(resultList[i]),
+            getPosition(resultList[i + 1]),
+            getPosition(resultList[i + 2]));
+
+        for (size_t j = 0; j < 3; ++j) {
+            quadricList[remapList[resultList[i + j]]].Add(quadric);
+        }
+    }
+
+    for (size_t i = 0; i < resultList.size(); i += 3) {
+        for (size_t e = 0; e < 3; ++e) {
+            uint32_t i0 = resultList[i + e];
+            uint32_t i1 = resultList[i + (e + 1) % 3];
+            uint32_t i2 = resultList[i + (e + 2) % 3];
+
+            VertexKind k0 = kindList[i0];
+            VertexKind k1 = kindList[i1];
+
+            // Edges from a boundary to a locked corner count as well, or the boundary edges
+            // next to corners would be free to move
+            if (!IsBoundary(k0) && !IsBoundary(k1)) {
+                continue;
+            }
+
+            if ((IsBoundary(k0) && loopList[i0] != i1) || (IsBoundary(k1) && loopBackList[i1] != i0)) {
+                continue;
+            }
+
+            // Seam edges are found from both sides
+            if (HasOpposite[size_t(k0)][size_t(k1)] && remapList[i1] > remapList[i0]) {
+                continue;
+            }
+
+            Quadric quadric = Quadric::FromTriangleEdge(getPosition(i0), getPosition(i1), getPosition(i2), BoundaryEdgeWeight);
+            quadricList[remapList[i0]].Add(quadric);
+            quadricList[remapList[i1]].Add(quadric);
+        }
+    }
+
+    double errorLimit = double(maxError) * radius;
+    errorLimit *= errorLimit;
+
+    double largestError = 0.0;
+
+    List<EdgeCollapse> collapseList;
+    List<uint32_t> orderList;
+    List<uint32_t> collapseRemapList(vertexCount);
+    List<uint8_t> lockedList(vertexCount);
+
+    while (resultList.size() > targetIndexCount) {
+        adjacency.Build(resultList, vertexCount, remapList.data());
+
+        collapseList.clear();
+
+        for (size_t i = 0; i < resultList.size(); i += 3) {
+            for (size_t e = 0; e < 3; ++e) {
+                uint32_t i0 = resultList[i + e];
+                uint32_t i1 = resultList[i + (e + 1) % 3];
+
+                if (remapList[i0] == remapList[i1]) {
+                    continue;
+                }
+
+                size_t k0 = size_t(kindList[i0]);
+                size_t k1 = size_t(kindList[i1]);
+
+                if (!CanCollapse[k0][k1] && !CanCollapse[k1][k0]) {
+                    continue;
+                }
+
+                if (HasOpposite[k0][k1] && remapList[i1] > remapList[i0]) {
+                    continue;
+                }
+
+                // Both on a boundary, but not along the same one
+                if (k0 == k1 && IsBoundary(kindList[i0]) && loopList[i0] != i1) {
+                    continue;
+                }
+
+                if (CanCollapse[k0][k1] && CanCollapse[k1][k0]) {
+                    collapseList.push_back({ i0, i1, true, 0.0 });
+                }
+                else if (CanCollapse[k0][k1]) {
+                    collapseList.push_back({ i0, i1, false, 0.0 });
+                }
+                else {
+                    collapseList.push_back({ i1, i0, false, 0.0 });
+                }
+            }
+        }
+
+        if (collapseList.empty()) {
+            break;
+        }
+
+        for (auto& collapse : collapseList) {
+            double error = quadricList[remapList[collapse.From]].GetError(positionList[collapse.To]);
+
+            if (collapse.Bidirectional) {
+                double reverseError = quadricList[remapList[collapse.To]].GetError(positionList[collapse.From]);
+                if (reverseError < error) {
+                    std::swap(collapse.From, collapse.To);
+                    error = reverseError;
+                }
+            }
+
+            collapse.Error = error;
+        }
+
+        orderList.resize(collapseList.size());
+        std::iota(orderList.begin(), orderList.end(), 0);
+
+        std::sort(orderList.begin(), orderList.end(),
+            [&](uint32_t a, uint32_t b) {
+                return collapseList[a].Error < collapseList[b].Error;
+            });
+
+        std::iota(collapseRemapList.begin(), collapseRemapList.end(), 0);
+        std::fill(lockedList.begin(), lockedList.end(), 0);
+
+        // Most collapses remove two triangles, so about this many are needed
+        size_t triangleGoal = (resultList.size() - targetIndexCount + 2) / 3;
+        size_t edgeGoal = triangleGoal / 2;
+
+        size_t triangleCollapseCount = 0;
+        size_t edgeCollapseCount = 0;
+
+        for (uint32_t c : orderList) {
+            const auto& collapse = collapseList[c];
+
+            if (collapse.Error > errorLimit || triangleCollapseCount >= triangleGoal) {
+                break;
+            }
+
+            // Collapses aren't re-ranked within a pass, and many are skipped for sharing a
+            // vertex with one already made, so the pass stops once errors grow well past
+            // those it was expected to need
+            double errorGoal = (edgeGoal < orderList.size() ? 1.5 * collapseList[orderList[edgeGoal]].Error : DBL_MAX);
+            if (collapse.Error > errorGoal && triangleCollapseCount > triangleGoal / 6) {
+                break;
+            }
+
+            uint32_t r0 = remapList[collapse.From];
+            uint32_t r1 = remapList[collapse.To];
+
+            // Vertices only move once per pass, and nothing moves onto a vertex that moved
+            if (lockedList[r0] || lockedList[r1]) {
+                continue;
+            }
+
+            if (HasTriangleFlips(adjacency, positionList, remapList, collapseRemapList, r0, r1)) {
+                ++edgeGoal;
+                continue;
+            }
+
+            VertexKind kind = kindList[collapse.From];
+
+            collapseRemapList[collapse.From] = collapse.To;
+
+            // The other side of the seam moves along with it, onto the other side of the target
+            if (kind == VertexKind::Seam) {
+                uint32_t s0 = wedgeList[collapse.From];
+                uint32_t s1 = (loopList[collapse.From] == collapse.To ? loopBackList[s0] : loopList[s0]);
+                collapseRemapList[s0] = s1;
+            }
+
+            lockedList[r0] = 1;
+            lockedList[r1] = 1;
+
+            // Border edges only have a triangle on one side
+            triangleCollapseCount += (kind == VertexKind::Border ? 1 : 2);
+            ++edgeCollapseCount;
+
+            largestError = std::max(largestError, collapse.Error);
+        }
+
+        if (edgeCollapseCount == 0) {
+            break;
+        }
+
+        for (uint32_t vertex = 0; vertex < vertexCount; ++vertex) {
+            if (remapList[vertex] == vertex && collapseRemapList[vertex] != vertex) {
+                quadricList[remapList[collapseRemapList[vertex]]].Add(quadricList[vertex]);
+            }
+        }
+
+        auto remapLoop = [&](List<uint32_t>& list) {
+            for (uint32_t vertex = 0; vertex < vertexCount; ++vertex) {
+                uint32_t next = list[vertex];
+                if (next != UnusedVertex) {
+                    // A seam edge collapsed against the direction of the loop skips past it
+                    uint32_t remapped = collapseRemapList[next];
+                    list[vertex] = (remapped == vertex ? list[next] : remapped);
+                }
+            }
+        };
+
+        remapLoop(loopList);
+        remapLoop(loopBackList);
+
+        size_t writeIndex = 0;
+        for (size_t i = 0; i < resultList.size(); i += 3) {
+            uint32_t a = collapseRemapList[resultList[i]];
+            uint32_t b = collapseRemapList[resultList[i + 1]];
+            uint32_t c = collapseRemapList[resultList[i + 2]];
+
+            if (remapList[a] != remapList[b] && remapList[a] != remapList[c] && remapList[b] != remapList[c]) {
+                resultList[writeIndex++] = a;
+                resultList[writeIndex++] = b;
+                resultList[writeIndex++] = c;
+            }
+        }
+
+        resultList.resize(writeIndex);
+    }
+
+    if (resultError) {
+        *resultError = static_cast<float>(std::sqrt(largestError) / radius);
+    }
+
+    return resultList;
+}
+
+List<MeshLOD> GenerateMeshLODs(List<uint32_t>& indexList, const List<Vec3>& positionList, uint32_t maxLODCount)
+{
+    CheckIndexList(indexList, positionList.size());
+
+    List<MeshLOD> lodList;
+    lodList.push_back(MeshLOD{
+        .FirstIndex = 0,
+        .IndexCount = static_cast<uint32_t>(indexList.size()),
+        .Error = 0.0f,
+    });
+
+    List<uint32_t> previousList(indexList.begin(), indexList.end());
+    float error = 0.0f;
+
+    while (lodList.size() < maxLODCount) {
+        size_t targetIndexCount = (previousList.size() / 6) * 3;
+
+        float lodError = 0.0f;
+        auto lodIndexList = SimplifyMesh(previousList, positionList, targetIndexCount, FLT_MAX, &lodError);
+
+        // Once mostly locked vertices are left, another level would draw nearly as much
+        if (lodIndexList.empty() || lodIndexList.size() > previousList.size() * 3 / 4) {
+            break;
+        }
+
+        OptimizeVertexCache(lodIndexList, positionList.size());
+
+        // Each level is simplified from the previous one, so its error is on top of theirs
+        error += lodError;
+
+        lodList.push_back(MeshLOD{
+            .FirstIndex = static_cast<uint32_t>(indexList.size()),
+            .IndexCount = static_cast<uint32_t>(lodIndexList.size()),
+            .Error = error,
+        });
+
+        indexList.insert(indexList.end(), lodIndexList.begin(), lodIndexList.end());
+        previousList = std::move(lodIndexList);
+    }
+
+    return lodList;
+}
+
+} // namespace noon
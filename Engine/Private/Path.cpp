@@ -3,14 +3,17 @@
 #include <algorithm>
 #include <cstdio>
 #include <climits>
+#include <cstdlib>
 #include <sstream>
 
 #if defined(NOON_PLATFORM_WINDOWS)
 
+    #include <Windows.h>
     #include <direct.h>
 
 #else
 
+    #include <sys/stat.h>
     #include <unistd.h>
 
 #endif
@@ -176,4 +179,66 @@ Path GetCurrentPath()
     return Path();
 }
 
+NOON_API
+bool IsFile(const Path& path)
+{
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    DWORD attributes = GetFileAttributesW(ConvertUTF8ToWideString(path).c_str());
+    return (attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY));
+
+#else
+
+    struct stat pathStat;
+    return (stat(path.ToCString(), &pathStat) == 0 && S_ISREG(pathStat.st_mode));
+
+#endif
+}
+
+NOON_API
+List<Path> GetAssetPathList()
+{
+    List<Path> assetPathList;
+
+    const char * assetPath = std::getenv("ASSET_PATH");
+    if (!assetPath) {
+        return assetPathList;
+    }
+
+    StringView view(assetPath);
+    while (!view.empty()) {
+        size_t pivot = view.find(Path::Separator);
+        StringView element = view.substr(0, pivot);
+
+        if (!element.empty()) {
+            assetPathList.push_back(Path(String(element)));
+        }
+
+        if (pivot == StringView::npos) {
+            break;
+        }
+
+        view.remove_prefix(pivot + 1);
+    }
+
+    return assetPathList;
+}
+
+NOON_API
+Path FindAssetFile(const Path& filename)
+{
+    if (filename.IsAbsolute()) {
+        return (IsFile(filename) ? filename : Path());
+    }
+
+    for (const auto& assetPath : GetAssetPathList()) {
+        Path path = assetPath / filename;
+        if (IsFile(path)) {
+            return path;
+        }
+    }
+
+    return Path();
+}
+
 } // namespace noon
\ No newline at end of file
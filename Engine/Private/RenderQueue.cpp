@@ -0,0 +1,86 @@
+#include <Noon/RenderQueue.hpp>
+#include <Noon/AssetManager.hpp>
+#include <Noon/JobSystem.hpp>
+#include <Noon/Mesh.hpp>
+
+#include <algorithm>
+
+namespace noon {
+
+void RenderQueue::Submit(Mesh * mesh, const Mat4& model, uint32_t lod)
+{
+    // Clamped here so levels the mesh doesn't have don't split batches
+    _instanceList.push_back(Instance{
+        .Owner = mesh,
+        .LOD = std::min(lod, mesh->GetLODCount() - 1),
+        .Data = ShaderInstance::FromMatrix(model),
+    });
+}
+
+void RenderQueue::Submit(const AssetHandle<Mesh>& mesh, const Mat4& model, uint32_t lod)
+{
+    Mesh * object = mesh.GetOrFallback();
+    if (object) {
+        Submit(object, model, lod);
+    }
+}
+
+void RenderQueue::Build()
+{
+    _batchList.clear();
+
+    // Meshes sharing a vertex format share a pipeline, so group those together as well
+    std::stable_sort(_instanceList.begin(), _instanceList.end(),
+        [](const Instance& a, const Instance& b) {
+            uint64_t aHash = a.Owner->GetVertexFormat().GetHash();
+            uint64_t bHash = b.Owner->GetVertexFormat().GetHash();
+            if (aHash != bHash) {
+                return (aHash < bHash);
+            }
+            if (a.Owner != b.Owner) {
+                return (a.Owner < b.Owner);
+            }
+            return (a.LOD < b.LOD);
+        });
+
+    for (size_t i = 0; i < _instanceList.size(); ++i) {
+        Mesh * mesh = _instanceList[i].Owner;
+        uint32_t lod = _instanceList[i].LOD;
+
+        if (_batchList.empty() || _batchList.back().Owner != mesh || _batchList.back().LOD != lod) {
+            _batchList.push_back(Batch{
+                .Owner = mesh,
+                .LOD = lod,
+                .FirstInstance = static_cast<uint32_t>(i),
+                .InstanceCount = 0,
+            });
+        }
+
+        ++_batchList.back().InstanceCount;
+    }
+}
+
+void RenderQueue::WriteInstances(ShaderInstance * instanceList) const
+{
+    // Writes straight into mapped memory, which is slow enough to be worth splitting up
+    ParallelFor(_instanceList.size(), 8 * 1024, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            instanceList[i] = _instanceList[i].Data;
+        }
+    });
+}
+
+void RenderQueue::Record(VkCommandBuffer commandBuffer)
+{
+    for (const auto& batch : _batchList) {
+        batch.Owner->Draw(commandBuffer, batch.InstanceCount, batch.FirstInstance, batch.LOD);
+    }
+}
+
+void RenderQueue::Clear()
+{
+    _instanceList.clear();
+    _batchList.clear();
+}
+
+} // namespace noon
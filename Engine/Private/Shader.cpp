@@ -0,0 +1,39 @@
+#include <Noon/Shader.hpp>
+#include <Noon/Application.hpp>
+#include <Noon/Exception.hpp>
+
+namespace noon {
+
+NOON_API
+Shader::Shader(Span<const uint32_t> code)
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    VkShaderModuleCreateInfo shaderModuleCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .codeSize = code.size_bytes(),
+        .pCode = code.data(),
+    };
+
+    VkResult vkResult = vkCreateShaderModule(
+        gfx->GetDevice(),
+        &shaderModuleCreateInfo,
+        nullptr,
+        &_vkShaderModule);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkCreateShaderModule() failed");
+    }
+}
+
+NOON_API
+Shader::~Shader()
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    vkDestroyShaderModule(gfx->GetDevice(), _vkShaderModule, nullptr);
+}
+
+} // namespace noon
@@ -0,0 +1,128 @@
+#include <Noon/ShaderBundle.hpp>
+#include <Noon/Hash.hpp>
+#include <Noon/Log.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace noon {
+
+NOON_API
+bool ShaderBundle::Open(const Path& path)
+{
+    Close();
+
+    if (!_file.Open(path)) {
+        return false;
+    }
+
+    const uint8_t * data = _file.GetData();
+    size_t size = _file.GetSize();
+
+    if (size < sizeof(Header)) {
+        Log(NOON_ANCHOR, "Shader bundle '{}' is truncated", path);
+        Close();
+        return false;
+    }
+
+    const auto * header = reinterpret_cast<const Header *>(data);
+
+    if (header->Magic != Magic || header->Version != FormatVersion) {
+        Log(NOON_ANCHOR, "Shader bundle '{}' has an unsupported format", path);
+        Close();
+        return false;
+    }
+
+    if (header->EntryCount > (size - sizeof(Header)) / sizeof(Entry)) {
+        Log(NOON_ANCHOR, "Shader bundle '{}' is truncated", path);
+        Close();
+        return false;
+    }
+
+    _entryList = reinterpret_cast<const Entry *>(data + sizeof(Header));
+
+    // Written so that no sum can wrap around, as the offsets come straight from the file
+    auto isInFile = [size](uint64_t offset, uint64_t length) {
+        return (offset <= size && length <= size - offset);
+    };
+
+    for (size_t i = 0; i < header->EntryCount; ++i) {
+        const auto& entry = _entryList[i];
+
+        bool isValid = (
+            isInFile(entry.NameOffset, entry.NameLength) &&
+            isInFile(entry.DataOffset, entry.DataSize) &&
+            (entry.DataOffset % sizeof(uint32_t)) == 0 &&
+            (entry.DataSize % sizeof(uint32_t)) == 0 &&
+            entry.DataSize >= sizeof(uint32_t)
+        );
+
+        // Aligned and in range, so the first word can be read
+        if (isValid) {
+            uint32_t magic;
+            memcpy(&magic, data + entry.DataOffset, sizeof(magic));
+            isValid = (magic == SPIRVMagic);
+        }
+
+        if (!isValid) {
+            Log(NOON_ANCHOR, "Shader bundle '{}' has an invalid entry #{}", path, i);
+            Close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+NOON_API
+void ShaderBundle::Close()
+{
+    _entryList = nullptr;
+    _file.Close();
+}
+
+NOON_API
+size_t ShaderBundle::GetShaderCount() const
+{
+    if (!IsOpen()) {
+        return 0;
+    }
+
+    return reinterpret_cast<const Header *>(_file.GetData())->EntryCount;
+}
+
+NOON_API
+Span<const uint32_t> ShaderBundle::FindShader(StringView name) const
+{
+    if (!IsOpen()) {
+        return {};
+    }
+
+    const uint8_t * data = _file.GetData();
+    const Entry * begin = _entryList;
+    const Entry * end = _entryList + GetShaderCount();
+
+    uint64_t hash = HashFNV1a(name);
+
+    auto it = std::lower_bound(begin, end, hash,
+        [](const Entry& entry, uint64_t hash) {
+            return entry.NameHash < hash;
+        }
+    );
+
+    for (; it != end && it->NameHash == hash; ++it) {
+        StringView entryName(
+            reinterpret_cast<const char *>(data + it->NameOffset),
+            it->NameLength);
+
+        if (entryName == name) {
+            return Span<const uint32_t>(
+                reinterpret_cast<const uint32_t *>(data + it->DataOffset),
+                it->DataSize / sizeof(uint32_t));
+        }
+    }
+
+    return {};
+}
+
+} // namespace noon
\ No newline at end of file
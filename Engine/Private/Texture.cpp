@@ -0,0 +1,451 @@
+#include <Noon/Texture.hpp>
+#include <Noon/Application.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/Log.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace noon {
+
+static void TransitionLevels(
+    VkCommandBuffer commandBuffer,
+    VkImage image,
+    uint32_t baseLevel,
+    uint32_t levelCount,
+    VkImageLayout oldLayout,
+    VkImageLayout newLayout,
+    VkAccessFlags srcAccessMask,
+    VkAccessFlags dstAccessMask,
+    VkPipelineStageFlags srcStageMask,
+    VkPipelineStageFlags dstStageMask)
+{
+    VkImageMemoryBarrier imageMemoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = srcAccessMask,
+        .dstAccessMask = dstAccessMask,
+        .oldLayout = oldLayout,
+        .newLayout = newLayout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = baseLevel,
+            .levelCount = levelCount,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        },
+    };
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        srcStageMask,
+        dstStageMask,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &imageMemoryBarrier);
+}
+
+NOON_API
+Texture::Texture(
+    VkFormat format,
+    uint32_t width,
+    uint32_t height,
+    Span<const Span<const uint8_t>> levelList,
+    bool generateMipmaps,
+    MemoryPool memoryPool)
+    : _vkFormat(format)
+    , _width(width)
+    , _height(height)
+    , _memoryPool(memoryPool)
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    if (GetTextureFormatBlockSize(_vkFormat) == 0) {
+        throw Exception("Unsupported texture format {}", VkFormatToString(_vkFormat));
+    }
+
+    if (IsBlockCompressedFormat(_vkFormat) && !gfx->HasTextureCompressionBC()) {
+        throw Exception("Texture format {} requires textureCompressionBC", VkFormatToString(_vkFormat));
+    }
+
+    uint32_t maxLevelCount = GetMipLevelCount(_width, _height);
+
+    if (levelList.empty() || levelList.size() > maxLevelCount) {
+        throw Exception("Texture has {} levels, expected 1 to {}", levelList.size(), maxLevelCount);
+    }
+
+    for (uint32_t i = 0; i < levelList.size(); ++i) {
+        uint64_t expectedSize = GetTextureLevelSize(_vkFormat, std::max(_width >> i, 1u), std::max(_height >> i, 1u));
+        if (levelList[i].size() != expectedSize) {
+            throw Exception("Texture level {} is {} bytes, expected {}", i, levelList[i].size(), expectedSize);
+        }
+    }
+
+    generateMipmaps = (generateMipmaps && levelList.size() == 1 && maxLevelCount > 1);
+
+    if (generateMipmaps && !CanGenerateMipmaps()) {
+        Log(NOON_ANCHOR, "Unable to generate mipmaps for texture format {}", VkFormatToString(_vkFormat));
+        generateMipmaps = false;
+    }
+
+    _levelCount = (generateMipmaps ? maxLevelCount : static_cast<uint32_t>(levelList.size()));
+
+    VkImageUsageFlags imageUsageFlags = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if (generateMipmaps) {
+        imageUsageFlags |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+
+    CreateImage(imageUsageFlags, false);
+
+    try {
+        Upload(levelList, generateMipmaps);
+    }
+    catch (...) {
+        vkDestroyImageView(gfx->GetDevice(), _vkImageView, nullptr);
+        gfx->DestroyImage(MemoryCategory::Image, _vkImage, _vmaAllocation);
+        throw;
+    }
+}
+
+NOON_API
+Texture::Texture(const KTX2File& file, MemoryPool memoryPool)
+    : Texture(
+        file.GetFormat(),
+        file.GetWidth(),
+        file.GetHeight(),
+        file.GetLevelList(),
+        file.NeedsMipmaps(),
+        memoryPool)
+{ }
+
+NOON_API
+Texture::Texture(
+    VkFormat format,
+    uint32_t width,
+    uint32_t height,
+    uint32_t levelCount,
+    VkImageLayout layout,
+    MemoryPool memoryPool)
+    : _vkFormat(format)
+    , _width(width)
+    , _height(height)
+    , _levelCount(levelCount)
+    , _memoryPool(memoryPool)
+    , _vkImageLayout(layout)
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    if (GetTextureFormatBlockSize(_vkFormat) == 0) {
+        throw Exception("Unsupported texture format {}", VkFormatToString(_vkFormat));
+    }
+
+    if (IsBlockCompressedFormat(_vkFormat) && !gfx->HasTextureCompressionBC()) {
+        throw Exception("Texture format {} requires textureCompressionBC", VkFormatToString(_vkFormat));
+    }
+
+    uint32_t maxLevelCount = GetMipLevelCount(_width, _height);
+
+    if (_levelCount == 0 || _levelCount > maxLevelCount) {
+        throw Exception("Texture has {} levels, expected 1 to {}", _levelCount, maxLevelCount);
+    }
+
+    CreateImage(
+        VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        true);
+}
+
+NOON_API
+Texture::~Texture()
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    vkDestroyImageView(gfx->GetDevice(), _vkImageView, nullptr);
+    gfx->DestroyImage(MemoryCategory::Image, _vkImage, _vmaAllocation);
+
+    _vkImageView = VK_NULL_HANDLE;
+    _vkImage = VK_NULL_HANDLE;
+    _vmaAllocation = VK_NULL_HANDLE;
+}
+
+void Texture::CreateImage(VkImageUsageFlags imageUsageFlags, bool shared)
+{
+    VkResult vkResult;
+
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    VkImageCreateInfo imageCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = _vkFormat,
+        .extent = {
+            .width = _width,
+            .height = _height,
+            .depth = 1,
+        },
+        .mipLevels = _levelCount,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = imageUsageFlags,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 0,
+        .pQueueFamilyIndices = nullptr,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+
+    // Other queues can use the image without transferring ownership
+    const auto& queueFamilyIndexList = gfx->GetSharedQueueFamilyIndexList();
+    if (shared && queueFamilyIndexList.size() > 1) {
+        imageCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        imageCreateInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilyIndexList.size());
+        imageCreateInfo.pQueueFamilyIndices = queueFamilyIndexList.data();
+    }
+
+    VmaAllocationCreateInfo allocationCreateInfo = {
+        .flags = 0,
+        .usage = VMA_MEMORY_USAGE_GPU_ONLY,
+        .pool = gfx->GetMemoryPool(_memoryPool),
+    };
+
+    VmaAllocationInfo allocationInfo;
+
+    vkResult = gfx->CreateImage(
+        MemoryCategory::Image,
+        &imageCreateInfo,
+        &allocationCreateInfo,
+        &_vkImage,
+        &_vmaAllocation,
+        &allocationInfo);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vmaCreateImage() failed, unable to create texture image");
+    }
+
+    _memorySize = allocationInfo.size;
+
+    VkImageViewCreateInfo imageViewCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .image = _vkImage,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = _vkFormat,
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = _levelCount,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        },
+    };
+
+    vkResult = vkCreateImageView(gfx->GetDevice(), &imageViewCreateInfo, nullptr, &_vkImageView);
+    if (vkResult != VK_SUCCESS) {
+        gfx->DestroyImage(MemoryCategory::Image, _vkImage, _vmaAllocation);
+        throw Exception("vkCreateImageView() failed, unable to create texture image view");
+    }
+
+}
+
+bool Texture::CanGenerateMipmaps() const
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(gfx->GetPhysicalDevice(), _vkFormat, &formatProperties);
+
+    VkFormatFeatureFlags requiredFeatures = (
+        VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+        VK_FORMAT_FEATURE_BLIT_DST_BIT |
+        VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT
+    );
+
+    return ((formatProperties.optimalTilingFeatures & requiredFeatures) == requiredFeatures);
+}
+
+void Texture::Upload(Span<const Span<const uint8_t>> levelList, bool generateMipmaps)
+{
+    VkResult vkResult;
+
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    // Copies must start on a multiple of the block size, which is at most 16
+    List<VkBufferImageCopy> copyRegionList;
+    VkDeviceSize stagingSize = 0;
+
+    for (uint32_t i = 0; i < levelList.size(); ++i) {
+        stagingSize = (stagingSize + 15) & ~VkDeviceSize(15);
+
+        copyRegionList.push_back(VkBufferImageCopy{
+            .bufferOffset = stagingSize,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = i,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+            .imageOffset = { 0, 0, 0 },
+            .imageExtent = {
+                .width = std::max(_width >> i, 1u),
+                .height = std::max(_height >> i, 1u),
+                .depth = 1,
+            },
+        });
+
+        stagingSize += levelList[i].size();
+    }
+
+    VkBufferCreateInfo stagingBufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .size = stagingSize,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    // Staging buffers are freed right after the copy, so they never wrap the ring
+    VmaAllocationCreateInfo stagingAllocationCreateInfo = {
+        .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .usage = VMA_MEMORY_USAGE_CPU_ONLY,
+        .pool = gfx->GetMemoryPool(MemoryPool::Staging),
+    };
+
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VmaAllocation stagingAllocation = VK_NULL_HANDLE;
+    VmaAllocationInfo stagingAllocationInfo;
+
+    vkResult = gfx->CreateBuffer(
+        MemoryCategory::Staging,
+        &stagingBufferCreateInfo,
+        &stagingAllocationCreateInfo,
+        &stagingBuffer,
+        &stagingAllocation,
+        &stagingAllocationInfo);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vmaCreateBuffer() failed, unable to create staging buffer");
+    }
+
+    uint8_t * stagingData = static_cast<uint8_t *>(stagingAllocationInfo.pMappedData);
+    for (size_t i = 0; i < levelList.size(); ++i) {
+        memcpy(stagingData + copyRegionList[i].bufferOffset, levelList[i].data(), levelList[i].size());
+    }
+
+    auto record = [&](VkCommandBuffer commandBuffer) {
+        TransitionLevels(commandBuffer, _vkImage, 0, _levelCount,
+            VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            0,
+            VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        vkCmdCopyBufferToImage(
+            commandBuffer,
+            stagingBuffer,
+            _vkImage,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(copyRegionList.size()),
+            copyRegionList.data());
+
+        if (!generateMipmaps) {
+            TransitionLevels(commandBuffer, _vkImage, 0, _levelCount,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_ACCESS_TRANSFER_WRITE_BIT,
+                VK_ACCESS_SHADER_READ_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+            return;
+        }
+
+        // Each level is downsampled from the one before it, which is then done with
+        for (uint32_t i = 1; i < _levelCount; ++i) {
+            TransitionLevels(commandBuffer, _vkImage, i - 1, 1,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                VK_ACCESS_TRANSFER_WRITE_BIT,
+                VK_ACCESS_TRANSFER_READ_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+            VkImageBlit imageBlit = {
+                .srcSubresource = {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel = i - 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+                .srcOffsets = {
+                    { 0, 0, 0 },
+                    {
+                        static_cast<int32_t>(std::max(_width >> (i - 1), 1u)),
+                        static_cast<int32_t>(std::max(_height >> (i - 1), 1u)),
+                        1,
+                    },
+                },
+                .dstSubresource = {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel = i,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+                .dstOffsets = {
+                    { 0, 0, 0 },
+                    {
+                        static_cast<int32_t>(std::max(_width >> i, 1u)),
+                        static_cast<int32_t>(std::max(_height >> i, 1u)),
+                        1,
+                    },
+                },
+            };
+
+            vkCmdBlitImage(
+                commandBuffer,
+                _vkImage,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                _vkImage,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                1,
+                &imageBlit,
+                VK_FILTER_LINEAR);
+
+            TransitionLevels(commandBuffer, _vkImage, i - 1, 1,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_ACCESS_TRANSFER_READ_BIT,
+                VK_ACCESS_SHADER_READ_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        }
+
+        TransitionLevels(commandBuffer, _vkImage, _levelCount - 1, 1,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_ACCESS_SHADER_READ_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    };
+
+    try {
+        gfx->RunOneTimeCommands(record);
+    }
+    catch (...) {
+        gfx->DestroyBuffer(MemoryCategory::Staging, stagingBuffer, stagingAllocation);
+        throw;
+    }
+
+    gfx->DestroyBuffer(MemoryCategory::Staging, stagingBuffer, stagingAllocation);
+}
+
+} // namespace noon
@@ -0,0 +1,67 @@
+#include <Noon/TextureFormat.hpp>
+
+#include <algorithm>
+#include <bit>
+
+namespace noon {
+
+NOON_API
+bool IsBlockCompressedFormat(VkFormat format)
+{
+    return (format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK);
+}
+
+NOON_API
+uint32_t GetTextureFormatBlockSize(VkFormat format)
+{
+    switch (format) {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+    case VK_FORMAT_BC4_SNORM_BLOCK:
+        return 8;
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+    case VK_FORMAT_BC5_SNORM_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        return 16;
+    case VK_FORMAT_R8_UNORM:
+        return 1;
+    case VK_FORMAT_R8G8_UNORM:
+        return 2;
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+        return 4;
+    case VK_FORMAT_R16G16B16A16_SFLOAT:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+NOON_API
+uint64_t GetTextureLevelSize(VkFormat format, uint32_t width, uint32_t height)
+{
+    uint64_t blockSize = GetTextureFormatBlockSize(format);
+
+    if (IsBlockCompressedFormat(format)) {
+        width = (width + 3) / 4;
+        height = (height + 3) / 4;
+    }
+
+    return blockSize * width * height;
+}
+
+NOON_API
+uint32_t GetMipLevelCount(uint32_t width, uint32_t height)
+{
+    return std::bit_width(std::max({ width, height, 1u }));
+}
+
+} // namespace noon
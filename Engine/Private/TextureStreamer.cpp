@@ -0,0 +1,894 @@
+#include <Noon/TextureStreamer.hpp>
+#include <Noon/Application.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/Log.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace noon {
+
+TextureStreamer * TextureStreamer::_Instance = nullptr;
+
+static void RequestMinLevel(std::atomic<uint32_t>& requestedLevel, uint32_t level)
+{
+    uint32_t current = requestedLevel.load(std::memory_order_relaxed);
+    while (level < current && !requestedLevel.compare_exchange_weak(current, level, std::memory_order_relaxed)) { }
+}
+
+static VkExtent3D GetLevelExtent(uint32_t width, uint32_t height, uint32_t level)
+{
+    return VkExtent3D{
+        .width = std::max(width >> level, 1u),
+        .height = std::max(height >> level, 1u),
+        .depth = 1,
+    };
+}
+
+NOON_API
+TextureStreamer::TextureStreamer()
+{
+    VkResult vkResult;
+
+    if (_Instance) {
+        throw Exception("Only one TextureStreamer can exist at a time");
+    }
+
+    if (!AsyncIO::GetInstance()) {
+        throw Exception("TextureStreamer requires an AsyncIO");
+    }
+
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    VkCommandPoolCreateInfo commandPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .queueFamilyIndex = gfx->GetTransferQueueFamilyIndex(),
+    };
+
+    vkResult = vkCreateCommandPool(
+        gfx->GetDevice(),
+        &commandPoolCreateInfo,
+        nullptr,
+        &_vkCommandPool);
+
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkCreateCommandPool() failed");
+    }
+
+    for (auto& batch : _batchList) {
+        VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .commandPool = _vkCommandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+
+        vkResult = vkAllocateCommandBuffers(
+            gfx->GetDevice(),
+            &commandBufferAllocateInfo,
+            &batch.CommandBuffer);
+
+        if (vkResult != VK_SUCCESS) {
+            throw Exception("vkAllocateCommandBuffers() failed");
+        }
+
+        VkFenceCreateInfo fenceCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+        };
+
+        vkResult = vkCreateFence(
+            gfx->GetDevice(),
+            &fenceCreateInfo,
+            nullptr,
+            &batch.Fence);
+
+        if (vkResult != VK_SUCCESS) {
+            throw Exception("vkCreateFence() failed");
+        }
+    }
+
+    // Images can't be freed while frames in flight may be sampling them, so nothing is released
+    // right away, and the next Update() evicts what was asked for
+    _memoryEvictionCallbackId = gfx->AddMemoryEvictionCallback(
+        [this](uint32_t, VkDeviceSize bytesRequested) -> VkDeviceSize {
+            _evictionRequestBytes += bytesRequested;
+            return 0;
+        }
+    );
+
+    _Instance = this;
+}
+
+NOON_API
+TextureStreamer::~TextureStreamer()
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+    auto asyncIO = AsyncIO::GetInstance();
+
+    gfx->RemoveMemoryEvictionCallback(_memoryEvictionCallbackId);
+
+    // Reads write into the entries and their staging buffers, so they have to finish first
+    for (auto& [id, entry] : _entryMap) {
+        if (entry->State == EntryState::Opening || entry->State == EntryState::Reading) {
+            asyncIO->Cancel(entry->ReadID);
+        }
+    }
+
+    for (auto& [id, entry] : _entryMap) {
+        while (entry->ReadStatus.load(std::memory_order_acquire) == IOStatus::Pending) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Frames in flight may still be sampling the textures
+    vkDeviceWaitIdle(gfx->GetDevice());
+
+    for (auto& [id, entry] : _entryMap) {
+        DestroyStaging(entry.get());
+    }
+
+    _entryMap.clear();
+    _retiredList.clear();
+
+    for (auto& batch : _batchList) {
+        vkDestroyFence(gfx->GetDevice(), batch.Fence, nullptr);
+        batch.Fence = VK_NULL_HANDLE;
+    }
+
+    if (_vkCommandPool) {
+        vkDestroyCommandPool(gfx->GetDevice(), _vkCommandPool, nullptr);
+        _vkCommandPool = VK_NULL_HANDLE;
+    }
+
+    _Instance = nullptr;
+}
+
+NOON_API
+StreamedTextureID TextureStreamer::Add(const Path& filename)
+{
+    Path path = FindAssetFile(filename);
+    if (path.IsEmpty()) {
+        Log(NOON_ANCHOR, "Unable to find texture '{}'", filename);
+        return InvalidStreamedTextureID;
+    }
+
+    auto entry = std::make_unique<Entry>();
+
+    if (!entry->File.Open(path)) {
+        Log(NOON_ANCHOR, "Unable to open texture '{}'", path);
+        return InvalidStreamedTextureID;
+    }
+
+    // The level count isn't known yet, so read enough for the most levels there can be
+    entry->IndexData.resize(std::min<uint64_t>(entry->File.GetSize(), KTX2File::GetIndexSize()));
+
+    std::unique_lock lock(_mutex);
+
+    entry->ID = _nextID++;
+
+    entry->ReadID = AsyncIO::GetInstance()->Read(IORead{
+        .File = &entry->File,
+        .Offset = 0,
+        .Size = entry->IndexData.size(),
+        .Destination = entry->IndexData.data(),
+        .Priority = IOPriority::High,
+        .Counter = nullptr,
+        .Status = &entry->ReadStatus,
+    });
+
+    StreamedTextureID id = entry->ID;
+    _entryMap.emplace(id, std::move(entry));
+    return id;
+}
+
+NOON_API
+void TextureStreamer::Remove(StreamedTextureID id)
+{
+    std::unique_lock lock(_mutex);
+
+    // Freed by Update() once nothing is reading or copying into it
+    auto it = _entryMap.find(id);
+    if (it != _entryMap.end()) {
+        it->second->Removed = true;
+    }
+}
+
+NOON_API
+void TextureStreamer::RequestLevel(StreamedTextureID id, uint32_t level)
+{
+    std::shared_lock lock(_mutex);
+
+    auto it = _entryMap.find(id);
+    if (it != _entryMap.end()) {
+        RequestMinLevel(it->second->RequestedLevel, level);
+    }
+}
+
+NOON_API
+void TextureStreamer::RequestScreenSize(StreamedTextureID id, float screenSize)
+{
+    std::shared_lock lock(_mutex);
+
+    auto it = _entryMap.find(id);
+    if (it == _entryMap.end()) {
+        return;
+    }
+
+    Entry * entry = it->second.get();
+
+    // The size isn't known until the index has been read, until then this has no effect
+    uint32_t size = std::max(entry->Width, entry->Height);
+    if (size == 0) {
+        return;
+    }
+
+    float texelsPerPixel = static_cast<float>(size) / std::max(screenSize, 1.0f);
+
+    uint32_t level = 0;
+    if (texelsPerPixel > 1.0f) {
+        level = static_cast<uint32_t>(std::floor(std::log2(texelsPerPixel)));
+    }
+
+    RequestMinLevel(entry->RequestedLevel, level);
+}
+
+NOON_API
+void TextureStreamer::Update()
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+    auto asyncIO = AsyncIO::GetInstance();
+
+    std::unique_lock lock(_mutex);
+
+    ++_frameIndex;
+
+    // Every frame that started before these were replaced has finished
+    std::erase_if(_retiredList,
+        [&](const auto& pair) {
+            return (_frameIndex - pair.first >= gfx->GetBackbufferCount());
+        }
+    );
+
+    for (auto& batch : _batchList) {
+        if (!batch.EntryList.empty() && vkGetFenceStatus(gfx->GetDevice(), batch.Fence) == VK_SUCCESS) {
+            FinishBatch(batch);
+        }
+    }
+
+    // What every texture will use once its pending change finishes, which is what the budget
+    // is compared against, as replaced images are only held for a few frames
+    VkDeviceSize committedBytes = 0;
+    VkDeviceSize stagingBytes = 0;
+    uint32_t pendingCount = 0;
+
+    List<Entry *> readyList;
+
+    for (auto it = _entryMap.begin(); it != _entryMap.end();) {
+        Entry * entry = it->second.get();
+
+        IOStatus status = entry->ReadStatus.load(std::memory_order_acquire);
+
+        bool reading = (entry->State == EntryState::Opening || entry->State == EntryState::Reading);
+
+        if (entry->Removed) {
+            if (reading && status == IOStatus::Pending) {
+                asyncIO->Cancel(entry->ReadID);
+                ++it;
+                continue;
+            }
+
+            if (entry->State == EntryState::Copying) {
+                ++it;
+                continue;
+            }
+
+            if (entry->ResidentTexture) {
+                _retiredList.emplace_back(_frameIndex, std::move(entry->ResidentTexture));
+            }
+
+            DestroyStaging(entry);
+            it = _entryMap.erase(it);
+            continue;
+        }
+
+        if (entry->State == EntryState::Opening && status != IOStatus::Pending) {
+            if (status == IOStatus::Complete) {
+                FinishOpening(entry);
+            }
+            else {
+                Log(NOON_ANCHOR, "Unable to read texture '{}'", entry->File.GetPath());
+                entry->State = EntryState::Failed;
+            }
+        }
+        else if (entry->State == EntryState::Reading && status != IOStatus::Pending) {
+            if (status == IOStatus::Complete) {
+                readyList.push_back(entry);
+            }
+            else {
+                Log(NOON_ANCHOR, "Unable to read levels {} to {} of texture '{}'",
+                    entry->PendingLevel, entry->ResidentLevel - 1, entry->File.GetPath());
+
+                DestroyStaging(entry);
+                entry->PendingTexture.reset();
+                entry->State = EntryState::Failed;
+            }
+        }
+
+        if (entry->State == EntryState::Idle) {
+            UpdateTargetLevel(entry);
+        }
+
+        if (entry->PendingTexture) {
+            committedBytes += entry->PendingTexture->GetMemorySize();
+            stagingBytes += entry->StagingSize;
+            ++pendingCount;
+        }
+        else if (entry->ResidentTexture) {
+            committedBytes += entry->ResidentTexture->GetMemorySize();
+        }
+
+        ++it;
+    }
+
+    // The eviction callback asks for memory on behalf of other allocations, which is made
+    // room for by lowering the budget for a frame
+    VkDeviceSize evictionRequestBytes = _evictionRequestBytes.exchange(0);
+    VkDeviceSize budget = _memoryBudget - std::min(evictionRequestBytes, _memoryBudget);
+
+    // Drop what isn't wanted anymore, and the finest levels of the largest textures until
+    // under budget
+    List<Entry *> candidateList;
+    for (auto& [id, entry] : _entryMap) {
+        if (entry->State == EntryState::Idle && entry->ResidentTexture && entry->ResidentLevel < entry->TailLevel) {
+            candidateList.push_back(entry.get());
+        }
+    }
+
+    std::sort(candidateList.begin(), candidateList.end(),
+        [](const Entry * a, const Entry * b) {
+            bool aUnwanted = (a->ResidentLevel < a->TargetLevel);
+            bool bUnwanted = (b->ResidentLevel < b->TargetLevel);
+            if (aUnwanted != bUnwanted) {
+                return aUnwanted;
+            }
+
+            return (a->ResidentTexture->GetMemorySize() > b->ResidentTexture->GetMemorySize());
+        }
+    );
+
+    for (Entry * entry : candidateList) {
+        if (pendingCount >= _maxPendingCount) {
+            break;
+        }
+
+        bool unwanted = (entry->ResidentLevel < entry->TargetLevel);
+        if (!unwanted && committedBytes <= budget) {
+            break;
+        }
+
+        VkDeviceSize oldSize = entry->ResidentTexture->GetMemorySize();
+
+        uint32_t level = (unwanted ? entry->TargetLevel : entry->ResidentLevel + 1);
+        if (!BeginChange(entry, level, readyList)) {
+            break;
+        }
+
+        committedBytes = committedBytes - oldSize + entry->PendingTexture->GetMemorySize();
+        ++pendingCount;
+    }
+
+    // Stream in textures with nothing resident first, then the blurriest
+    candidateList.clear();
+    for (auto& [id, entry] : _entryMap) {
+        if (entry->State == EntryState::Idle && entry->TargetLevel < entry->ResidentLevel) {
+            candidateList.push_back(entry.get());
+        }
+    }
+
+    std::sort(candidateList.begin(), candidateList.end(),
+        [](const Entry * a, const Entry * b) {
+            bool aEmpty = !a->ResidentTexture;
+            bool bEmpty = !b->ResidentTexture;
+            if (aEmpty != bEmpty) {
+                return aEmpty;
+            }
+
+            uint32_t aMissing = a->ResidentLevel - a->TargetLevel;
+            uint32_t bMissing = b->ResidentLevel - b->TargetLevel;
+            if (aMissing != bMissing) {
+                return (aMissing > bMissing);
+            }
+
+            return (GetLevelRangeSize(a, a->TargetLevel) < GetLevelRangeSize(b, b->TargetLevel));
+        }
+    );
+
+    for (Entry * entry : candidateList) {
+        if (pendingCount >= _maxPendingCount) {
+            break;
+        }
+
+        uint32_t level = entry->TailLevel;
+
+        // The smallest levels are loaded regardless of the budget, otherwise take the finest
+        // level wanted that fits
+        if (entry->ResidentTexture) {
+            VkDeviceSize otherBytes = committedBytes - entry->ResidentTexture->GetMemorySize();
+
+            level = entry->TargetLevel;
+            while (level < entry->ResidentLevel && otherBytes + GetLevelRangeSize(entry, level) > budget) {
+                ++level;
+            }
+
+            if (level == entry->ResidentLevel) {
+                continue;
+            }
+        }
+
+        uint32_t readEndLevel = (entry->ResidentTexture ? entry->ResidentLevel : entry->LevelCount);
+        VkDeviceSize readSize = GetLevelRangeSize(entry, level) - GetLevelRangeSize(entry, readEndLevel);
+
+        // Always allow one read, however large
+        if (stagingBytes > 0 && stagingBytes + readSize > _maxStagingBytes) {
+            continue;
+        }
+
+        VkDeviceSize oldSize = (entry->ResidentTexture ? entry->ResidentTexture->GetMemorySize() : 0);
+
+        if (!BeginChange(entry, level, readyList)) {
+            break;
+        }
+
+        committedBytes = committedBytes - oldSize + entry->PendingTexture->GetMemorySize();
+        stagingBytes += entry->StagingSize;
+        ++pendingCount;
+    }
+
+    SubmitCopies(readyList);
+}
+
+NOON_API
+const Texture * TextureStreamer::GetTexture(StreamedTextureID id) const
+{
+    std::shared_lock lock(_mutex);
+
+    auto it = _entryMap.find(id);
+    if (it == _entryMap.end()) {
+        return nullptr;
+    }
+
+    return it->second->ResidentTexture.get();
+}
+
+NOON_API
+uint32_t TextureStreamer::GetResidentLevel(StreamedTextureID id) const
+{
+    std::shared_lock lock(_mutex);
+
+    auto it = _entryMap.find(id);
+    if (it == _entryMap.end()) {
+        return 0;
+    }
+
+    const Entry * entry = it->second.get();
+    return (entry->ResidentTexture ? entry->ResidentLevel : entry->LevelCount);
+}
+
+NOON_API
+TextureStreamingStats TextureStreamer::GetStats() const
+{
+    std::shared_lock lock(_mutex);
+
+    TextureStreamingStats stats = {
+        .ResidentBytes = 0,
+        .StagingBytes = 0,
+        .TextureCount = static_cast<uint32_t>(_entryMap.size()),
+        .PendingCount = 0,
+        .LevelsLoaded = _levelsLoaded,
+        .LevelsEvicted = _levelsEvicted,
+    };
+
+    for (const auto& [id, entry] : _entryMap) {
+        if (entry->ResidentTexture) {
+            stats.ResidentBytes += entry->ResidentTexture->GetMemorySize();
+        }
+
+        if (entry->PendingTexture) {
+            stats.ResidentBytes += entry->PendingTexture->GetMemorySize();
+            ++stats.PendingCount;
+        }
+
+        stats.StagingBytes += entry->StagingSize;
+    }
+
+    for (const auto& [frameIndex, texture] : _retiredList) {
+        stats.ResidentBytes += texture->GetMemorySize();
+    }
+
+    return stats;
+}
+
+VkDeviceSize TextureStreamer::GetLevelRangeSize(const Entry * entry, uint32_t level)
+{
+    VkDeviceSize size = 0;
+    for (uint32_t i = level; i < entry->LevelCount; ++i) {
+        size += entry->LevelIndexList[i].ByteLength;
+    }
+    return size;
+}
+
+void TextureStreamer::FinishOpening(Entry * entry)
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    KTX2File file;
+    if (!file.ParseIndex(entry->IndexData, entry->File.GetSize())) {
+        Log(NOON_ANCHOR, "Unable to stream texture '{}'", entry->File.GetPath());
+        entry->State = EntryState::Failed;
+        return;
+    }
+
+    if (IsBlockCompressedFormat(file.GetFormat()) && !gfx->HasTextureCompressionBC()) {
+        Log(NOON_ANCHOR, "Texture format {} requires textureCompressionBC, unable to stream texture '{}'",
+            VkFormatToString(file.GetFormat()), entry->File.GetPath());
+        entry->State = EntryState::Failed;
+        return;
+    }
+
+    entry->Format = file.GetFormat();
+    entry->Width = file.GetWidth();
+    entry->Height = file.GetHeight();
+    entry->LevelCount = file.GetLevelCount();
+    entry->LevelIndexList = file.GetLevelIndexList();
+
+    entry->TailLevel = 0;
+    while (entry->TailLevel + 1 < entry->LevelCount) {
+        VkExtent3D extent = GetLevelExtent(entry->Width, entry->Height, entry->TailLevel);
+        if (std::max(extent.width, extent.height) <= _minResidentSize) {
+            break;
+        }
+
+        ++entry->TailLevel;
+    }
+
+    entry->ResidentLevel = entry->LevelCount;
+    entry->TargetLevel = entry->TailLevel;
+    entry->TargetFrameIndex = _frameIndex;
+
+    entry->IndexData = {};
+    entry->State = EntryState::Idle;
+}
+
+void TextureStreamer::UpdateTargetLevel(Entry * entry)
+{
+    uint32_t requestedLevel = entry->RequestedLevel.exchange(UINT32_MAX, std::memory_order_relaxed);
+    requestedLevel = std::min(requestedLevel, entry->TailLevel);
+
+    // Finer levels are wanted right away, coarser ones only once they have been for a while
+    bool finer = (requestedLevel <= entry->TargetLevel);
+    if (finer || _frameIndex - entry->TargetFrameIndex >= _hysteresisFrameCount) {
+        entry->TargetLevel = requestedLevel;
+        entry->TargetFrameIndex = _frameIndex;
+    }
+}
+
+bool TextureStreamer::BeginChange(Entry * entry, uint32_t level, List<Entry *>& readyList)
+{
+    VkResult vkResult;
+
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    VkExtent3D extent = GetLevelExtent(entry->Width, entry->Height, level);
+
+    // Streaming allocations fail rather than exceed the heap's budget, which is tried again
+    // next frame
+    try {
+        entry->PendingTexture = std::make_unique<Texture>(
+            entry->Format,
+            extent.width,
+            extent.height,
+            entry->LevelCount - level,
+            VK_IMAGE_LAYOUT_GENERAL,
+            MemoryPool::Streaming);
+    }
+    catch (const Exception&) {
+        return false;
+    }
+
+    entry->PendingLevel = level;
+
+    uint32_t readEndLevel = (entry->ResidentTexture ? entry->ResidentLevel : entry->LevelCount);
+
+    if (level >= readEndLevel) {
+        // Everything is already resident, only the copies are left
+        entry->ReadStatus.store(IOStatus::Complete, std::memory_order_relaxed);
+        entry->State = EntryState::Reading;
+        readyList.push_back(entry);
+        return true;
+    }
+
+    // Levels are stored smallest first, so they can be read together
+    uint64_t begin = UINT64_MAX;
+    uint64_t end = 0;
+    for (uint32_t i = level; i < readEndLevel; ++i) {
+        const auto& levelIndex = entry->LevelIndexList[i];
+        begin = std::min(begin, levelIndex.ByteOffset);
+        end = std::max(end, levelIndex.ByteOffset + levelIndex.ByteLength);
+    }
+
+    VkBufferCreateInfo stagingBufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .size = end - begin,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    // Reads finish out of order, so these can't come from the Staging ring
+    VmaAllocationCreateInfo stagingAllocationCreateInfo = {
+        .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .usage = VMA_MEMORY_USAGE_CPU_ONLY,
+    };
+
+    VmaAllocationInfo stagingAllocationInfo;
+
+    vkResult = gfx->CreateBuffer(
+        MemoryCategory::Staging,
+        &stagingBufferCreateInfo,
+        &stagingAllocationCreateInfo,
+        &entry->StagingBuffer,
+        &entry->StagingAllocation,
+        &stagingAllocationInfo);
+
+    if (vkResult != VK_SUCCESS) {
+        entry->StagingBuffer = VK_NULL_HANDLE;
+        entry->StagingAllocation = VK_NULL_HANDLE;
+        entry->PendingTexture.reset();
+        return false;
+    }
+
+    entry->StagingSize = end - begin;
+    entry->StagingFileOffset = begin;
+
+    // The more levels are missing, the blurrier the texture is on screen
+    bool blurry = (!entry->ResidentTexture || entry->ResidentLevel - entry->TargetLevel > 1);
+
+    entry->ReadStatus.store(IOStatus::Pending, std::memory_order_relaxed);
+    entry->State = EntryState::Reading;
+
+    entry->ReadID = AsyncIO::GetInstance()->Read(IORead{
+        .File = &entry->File,
+        .Offset = begin,
+        .Size = end - begin,
+        .Destination = stagingAllocationInfo.pMappedData,
+        .Priority = (blurry ? IOPriority::High : IOPriority::Normal),
+        .Counter = nullptr,
+        .Status = &entry->ReadStatus,
+    });
+
+    return true;
+}
+
+void TextureStreamer::SubmitCopies(List<Entry *>& readyList)
+{
+    VkResult vkResult;
+
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    if (readyList.empty()) {
+        return;
+    }
+
+    // Entries stay ready, and are submitted once a batch is free
+    auto it = std::find_if(_batchList.begin(), _batchList.end(),
+        [](const Batch& batch) {
+            return batch.EntryList.empty();
+        }
+    );
+
+    if (it == _batchList.end()) {
+        return;
+    }
+
+    Batch& batch = *it;
+
+    vkResetCommandBuffer(batch.CommandBuffer, 0);
+
+    VkCommandBufferBeginInfo commandBufferBeginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = nullptr,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = nullptr,
+    };
+
+    vkResult = vkBeginCommandBuffer(batch.CommandBuffer, &commandBufferBeginInfo);
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkBeginCommandBuffer() failed");
+    }
+
+    for (Entry * entry : readyList) {
+        RecordCopies(batch.CommandBuffer, entry);
+        entry->State = EntryState::Copying;
+        batch.EntryList.push_back(entry);
+    }
+
+    // Make the copies available, the fence is waited on before any frame samples the images
+    VkMemoryBarrier memoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = 0,
+    };
+
+    vkCmdPipelineBarrier(
+        batch.CommandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0,
+        1, &memoryBarrier,
+        0, nullptr,
+        0, nullptr);
+
+    vkResult = vkEndCommandBuffer(batch.CommandBuffer);
+    if (vkResult != VK_SUCCESS) {
+        throw Exception("vkEndCommandBuffer() failed");
+    }
+
+    VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &batch.CommandBuffer,
+    };
+
+    vkResetFences(gfx->GetDevice(), 1, &batch.Fence);
+
+    gfx->SubmitTransfer(submitInfo, batch.Fence);
+}
+
+void TextureStreamer::RecordCopies(VkCommandBuffer commandBuffer, Entry * entry)
+{
+    Texture * texture = entry->PendingTexture.get();
+    Texture * oldTexture = entry->ResidentTexture.get();
+
+    VkImageMemoryBarrier imageMemoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = 0,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_GENERAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = texture->GetImage(),
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = texture->GetLevelCount(),
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        },
+    };
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &imageMemoryBarrier);
+
+    // Levels from the file, relative to where the read started
+    uint32_t readEndLevel = (oldTexture ? entry->ResidentLevel : entry->LevelCount);
+
+    List<VkBufferImageCopy> bufferCopyList;
+    for (uint32_t i = entry->PendingLevel; i < readEndLevel; ++i) {
+        bufferCopyList.push_back(VkBufferImageCopy{
+            .bufferOffset = entry->LevelIndexList[i].ByteOffset - entry->StagingFileOffset,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = i - entry->PendingLevel,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+            .imageOffset = { 0, 0, 0 },
+            .imageExtent = GetLevelExtent(entry->Width, entry->Height, i),
+        });
+    }
+
+    if (!bufferCopyList.empty()) {
+        vkCmdCopyBufferToImage(
+            commandBuffer,
+            entry->StagingBuffer,
+            texture->GetImage(),
+            VK_IMAGE_LAYOUT_GENERAL,
+            static_cast<uint32_t>(bufferCopyList.size()),
+            bufferCopyList.data());
+    }
+
+    if (!oldTexture) {
+        return;
+    }
+
+    // Levels both images have, the old one is only read, so frames can keep sampling it
+    List<VkImageCopy> imageCopyList;
+    for (uint32_t i = std::max(entry->PendingLevel, entry->ResidentLevel); i < entry->LevelCount; ++i) {
+        imageCopyList.push_back(VkImageCopy{
+            .srcSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = i - entry->ResidentLevel,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+            .srcOffset = { 0, 0, 0 },
+            .dstSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = i - entry->PendingLevel,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+            .dstOffset = { 0, 0, 0 },
+            .extent = GetLevelExtent(entry->Width, entry->Height, i),
+        });
+    }
+
+    vkCmdCopyImage(
+        commandBuffer,
+        oldTexture->GetImage(),
+        VK_IMAGE_LAYOUT_GENERAL,
+        texture->GetImage(),
+        VK_IMAGE_LAYOUT_GENERAL,
+        static_cast<uint32_t>(imageCopyList.size()),
+        imageCopyList.data());
+}
+
+void TextureStreamer::FinishBatch(Batch& batch)
+{
+    for (Entry * entry : batch.EntryList) {
+        uint32_t oldLevel = (entry->ResidentTexture ? entry->ResidentLevel : entry->LevelCount);
+        if (entry->PendingLevel < oldLevel) {
+            _levelsLoaded += oldLevel - entry->PendingLevel;
+        }
+        else {
+            _levelsEvicted += entry->PendingLevel - oldLevel;
+        }
+
+        if (entry->ResidentTexture) {
+            _retiredList.emplace_back(_frameIndex, std::move(entry->ResidentTexture));
+        }
+
+        entry->ResidentTexture = std::move(entry->PendingTexture);
+        entry->ResidentLevel = entry->PendingLevel;
+
+        DestroyStaging(entry);
+        entry->State = EntryState::Idle;
+    }
+
+    batch.EntryList.clear();
+}
+
+void TextureStreamer::DestroyStaging(Entry * entry)
+{
+    auto gfx = Application::GetInstance()->GetGraphicsDriver();
+
+    if (entry->StagingBuffer) {
+        gfx->DestroyBuffer(MemoryCategory::Staging, entry->StagingBuffer, entry->StagingAllocation);
+    }
+
+    entry->StagingBuffer = VK_NULL_HANDLE;
+    entry->StagingAllocation = VK_NULL_HANDLE;
+    entry->StagingSize = 0;
+    entry->StagingFileOffset = 0;
+}
+
+} // namespace noon
@@ -0,0 +1,406 @@
+#include <Noon/TransformHierarchy.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/JobSystem.hpp>
+
+#include <algorithm>
+
+namespace noon {
+
+// Both matrices are affine, so the bottom row of local can be skipped
+static inline Mat4 MultiplyAffine(const Mat4& parent, const Mat3& basis, const Vec3& position)
+{
+    Mat4 matrix;
+    matrix[0] = parent[0] * basis[0].x + parent[1] * basis[0].y + parent[2] * basis[0].z;
+    matrix[1] = parent[0] * basis[1].x + parent[1] * basis[1].y + parent[2] * basis[1].z;
+    matrix[2] = parent[0] * basis[2].x + parent[1] * basis[2].y + parent[2] * basis[2].z;
+    matrix[3] = parent[0] * position.x + parent[1] * position.y + parent[2] * position.z + parent[3];
+    return matrix;
+}
+
+TransformHandle TransformHierarchy::Add(TransformHandle parent)
+{
+    if (parent != InvalidTransformHandle && !IsValid(parent)) {
+        throw Exception("Transform parent {} does not exist", parent);
+    }
+
+    TransformHandle handle;
+    if (!_freeHandleList.empty()) {
+        handle = _freeHandleList.back();
+        _freeHandleList.pop_back();
+    }
+    else {
+        handle = static_cast<TransformHandle>(_nodeIndexList.size());
+        _nodeIndexList.push_back(InvalidIndex);
+        _parentHandleList.push_back(InvalidTransformHandle);
+    }
+
+    // Appended out of order, and moved into place by the next Sort()
+    uint32_t index = static_cast<uint32_t>(_handleList.size());
+
+    _nodeIndexList[handle] = index;
+    _parentHandleList[handle] = parent;
+
+    _handleList.push_back(handle);
+    _parentIndexList.push_back(InvalidIndex);
+    _firstChildList.push_back(0);
+    _childCountList.push_back(0);
+    _positionList.push_back(Vec3(0.0f));
+    _rotationList.push_back(Quat(1.0f, 0.0f, 0.0f, 0.0f));
+    _scaleList.push_back(Vec3(1.0f));
+    _worldMatrixList.push_back(Mat4(1.0f));
+    _dirtyList.push_back(0);
+    _updateStampList.push_back(0);
+
+    _needsSort = true;
+    MarkDirty(index);
+
+    return handle;
+}
+
+void TransformHierarchy::Remove(TransformHandle handle)
+{
+    if (!IsValid(handle)) {
+        throw Exception("Transform {} does not exist", handle);
+    }
+
+    // The child ranges are needed to find the descendants
+    if (_needsSort) {
+        Sort();
+    }
+
+    List<uint32_t> stack = { _nodeIndexList[handle] };
+
+    while (!stack.empty()) {
+        uint32_t index = stack.back();
+        stack.pop_back();
+
+        for (uint32_t i = 0; i < _childCountList[index]; ++i) {
+            stack.push_back(_firstChildList[index] + i);
+        }
+
+        // Left behind until the next Sort()
+        TransformHandle removed = _handleList[index];
+        _handleList[index] = InvalidTransformHandle;
+        _nodeIndexList[removed] = InvalidIndex;
+        _parentHandleList[removed] = InvalidTransformHandle;
+        _freeHandleList.push_back(removed);
+    }
+
+    _needsSort = true;
+}
+
+TransformHandle TransformHierarchy::GetParent(TransformHandle handle) const
+{
+    if (!IsValid(handle)) {
+        throw Exception("Transform {} does not exist", handle);
+    }
+
+    return _parentHandleList[handle];
+}
+
+void TransformHierarchy::SetParent(TransformHandle handle, TransformHandle parent)
+{
+    if (!IsValid(handle)) {
+        throw Exception("Transform {} does not exist", handle);
+    }
+
+    if (parent != InvalidTransformHandle && !IsValid(parent)) {
+        throw Exception("Transform parent {} does not exist", parent);
+    }
+
+    for (TransformHandle ancestor = parent; ancestor != InvalidTransformHandle; ancestor = _parentHandleList[ancestor]) {
+        if (ancestor == handle) {
+            throw Exception("Transform {} can't be parented to its descendant {}", handle, parent);
+        }
+    }
+
+    _parentHandleList[handle] = parent;
+
+    _needsSort = true;
+    MarkDirty(_nodeIndexList[handle]);
+}
+
+void TransformHierarchy::SetLocalPosition(TransformHandle handle, const Vec3& position)
+{
+    if (!IsValid(handle)) {
+        throw Exception("Transform {} does not exist", handle);
+    }
+
+    uint32_t index = _nodeIndexList[handle];
+    _positionList[index] = position;
+    MarkDirty(index);
+}
+
+void TransformHierarchy::SetLocalRotation(TransformHandle handle, const Quat& rotation)
+{
+    if (!IsValid(handle)) {
+        throw Exception("Transform {} does not exist", handle);
+    }
+
+    uint32_t index = _nodeIndexList[handle];
+    _rotationList[index] = rotation;
+    MarkDirty(index);
+}
+
+void TransformHierarchy::SetLocalScale(TransformHandle handle, const Vec3& scale)
+{
+    if (!IsValid(handle)) {
+        throw Exception("Transform {} does not exist", handle);
+    }
+
+    uint32_t index = _nodeIndexList[handle];
+    _scaleList[index] = scale;
+    MarkDirty(index);
+}
+
+void TransformHierarchy::SetLocalTransform(TransformHandle handle, const Vec3& position, const Quat& rotation, const Vec3& scale)
+{
+    if (!IsValid(handle)) {
+        throw Exception("Transform {} does not exist", handle);
+    }
+
+    uint32_t index = _nodeIndexList[handle];
+    _positionList[index] = position;
+    _rotationList[index] = rotation;
+    _scaleList[index] = scale;
+    MarkDirty(index);
+}
+
+void TransformHierarchy::Update()
+{
+    _changedList.clear();
+
+    if (_needsSort) {
+        Sort();
+    }
+
+    if (_dirtyHandleList.empty()) {
+        return;
+    }
+
+    ++_updateStamp;
+
+    // Positions are ordered by level, so sorting them groups the dirty nodes by level
+    List<uint32_t> dirtyIndexList;
+    dirtyIndexList.reserve(_dirtyHandleList.size());
+
+    for (TransformHandle handle : _dirtyHandleList) {
+        uint32_t index = _nodeIndexList[handle];
+        _dirtyList[index] = 0;
+        dirtyIndexList.push_back(index);
+    }
+
+    _dirtyHandleList.clear();
+
+    std::sort(dirtyIndexList.begin(), dirtyIndexList.end());
+
+    List<uint32_t> levelIndexList;
+    List<uint32_t> previousIndexList;
+    size_t nextDirty = 0;
+
+    size_t levelCount = _levelStartList.size() - 1;
+    for (size_t level = 0; level < levelCount; ++level) {
+        if (previousIndexList.empty() && nextDirty == dirtyIndexList.size()) {
+            break;
+        }
+
+        levelIndexList.clear();
+
+        // The children of every node updated in the previous level
+        for (uint32_t index : previousIndexList) {
+            for (uint32_t i = 0; i < _childCountList[index]; ++i) {
+                levelIndexList.push_back(_firstChildList[index] + i);
+            }
+        }
+
+        // Nodes that changed themselves, unless they were already reached through their parent
+        uint32_t levelEnd = _levelStartList[level + 1];
+        while (nextDirty < dirtyIndexList.size() && dirtyIndexList[nextDirty] < levelEnd) {
+            uint32_t index = dirtyIndexList[nextDirty++];
+            uint32_t parentIndex = _parentIndexList[index];
+
+            if (parentIndex == InvalidIndex || _updateStampList[parentIndex] != _updateStamp) {
+                levelIndexList.push_back(index);
+            }
+        }
+
+        // Nodes in the same level only read their parents, which are all finished
+        UpdateWorldMatrices(levelIndexList.data(), levelIndexList.size());
+
+        for (uint32_t index : levelIndexList) {
+            _changedList.push_back(_handleList[index]);
+        }
+
+        std::swap(levelIndexList, previousIndexList);
+    }
+}
+
+void TransformHierarchy::TransformBounds(const BoundingSphereList& localBounds, BoundingSphereList& worldBounds) const
+{
+    if (worldBounds.GetCount() < GetHandleCount()) {
+        worldBounds.Resize(GetHandleCount());
+    }
+
+    for (TransformHandle handle : _changedList) {
+        if (handle < localBounds.GetCount()) {
+            worldBounds.Set(handle, localBounds.Get(handle).Transform(GetWorldMatrix(handle)));
+        }
+    }
+}
+
+void TransformHierarchy::MarkDirty(uint32_t index)
+{
+    if (!_dirtyList[index]) {
+        _dirtyList[index] = 1;
+        _dirtyHandleList.push_back(_handleList[index]);
+    }
+}
+
+void TransformHierarchy::Sort()
+{
+    size_t handleCount = _nodeIndexList.size();
+
+    // The children of each handle, in handle order
+    List<uint32_t> childOffsetList(handleCount + 1, 0);
+    for (TransformHandle handle = 0; handle < handleCount; ++handle) {
+        TransformHandle parent = _parentHandleList[handle];
+        if (IsValid(handle) && parent != InvalidTransformHandle) {
+            ++childOffsetList[parent + 1];
+        }
+    }
+
+    for (size_t i = 0; i < handleCount; ++i) {
+        childOffsetList[i + 1] += childOffsetList[i];
+    }
+
+    List<TransformHandle> childHandleList(childOffsetList[handleCount]);
+    List<uint32_t> childFillList(childOffsetList.begin(), childOffsetList.end() - 1);
+
+    for (TransformHandle handle = 0; handle < handleCount; ++handle) {
+        TransformHandle parent = _parentHandleList[handle];
+        if (IsValid(handle) && parent != InvalidTransformHandle) {
+            childHandleList[childFillList[parent]++] = handle;
+        }
+    }
+
+    // Breadth first from the roots
+    List<TransformHandle> orderList;
+    orderList.reserve(GetCount());
+
+    for (TransformHandle handle = 0; handle < handleCount; ++handle) {
+        if (IsValid(handle) && _parentHandleList[handle] == InvalidTransformHandle) {
+            orderList.push_back(handle);
+        }
+    }
+
+    List<uint32_t> levelStartList = { 0 };
+    List<uint32_t> firstChildList(GetCount(), 0);
+    List<uint32_t> childCountList(GetCount(), 0);
+
+    size_t levelBegin = 0;
+    while (levelBegin < orderList.size()) {
+        size_t levelEnd = orderList.size();
+        levelStartList.push_back(static_cast<uint32_t>(levelEnd));
+
+        for (size_t i = levelBegin; i < levelEnd; ++i) {
+            TransformHandle handle = orderList[i];
+
+            firstChildList[i] = static_cast<uint32_t>(orderList.size());
+            childCountList[i] = childOffsetList[handle + 1] - childOffsetList[handle];
+
+            orderList.insert(
+                orderList.end(),
+                childHandleList.begin() + childOffsetList[handle],
+                childHandleList.begin() + childOffsetList[handle + 1]);
+        }
+
+        levelBegin = levelEnd;
+    }
+
+    // Gather everything into the new order
+    size_t count = orderList.size();
+
+    List<uint32_t> parentIndexList(count);
+    List<Vec3> positionList(count);
+    List<Quat> rotationList(count);
+    List<Vec3> scaleList(count);
+    List<Mat4> worldMatrixList(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t oldIndex = _nodeIndexList[orderList[i]];
+        positionList[i] = _positionList[oldIndex];
+        rotationList[i] = _rotationList[oldIndex];
+        scaleList[i] = _scaleList[oldIndex];
+        worldMatrixList[i] = _worldMatrixList[oldIndex];
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        _nodeIndexList[orderList[i]] = static_cast<uint32_t>(i);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        TransformHandle parent = _parentHandleList[orderList[i]];
+        parentIndexList[i] = (parent == InvalidTransformHandle ? InvalidIndex : _nodeIndexList[parent]);
+    }
+
+    _handleList = std::move(orderList);
+    _parentIndexList = std::move(parentIndexList);
+    _firstChildList = std::move(firstChildList);
+    _childCountList = std::move(childCountList);
+    _positionList = std::move(positionList);
+    _rotationList = std::move(rotationList);
+    _scaleList = std::move(scaleList);
+    _worldMatrixList = std::move(worldMatrixList);
+    _levelStartList = std::move(levelStartList);
+
+    _updateStampList.assign(count, 0);
+
+    // Drop removed nodes, and flag the rest at their new positions
+    _dirtyList.assign(count, 0);
+
+    List<TransformHandle> dirtyHandleList;
+    dirtyHandleList.swap(_dirtyHandleList);
+
+    for (TransformHandle handle : dirtyHandleList) {
+        if (IsValid(handle)) {
+            MarkDirty(_nodeIndexList[handle]);
+        }
+    }
+
+    _needsSort = false;
+}
+
+void TransformHierarchy::UpdateWorldMatrices(const uint32_t * indexList, size_t count)
+{
+    // Below this, scheduling a batch costs more than it saves
+    static const size_t MinNodesPerBatch = 4 * 1024;
+
+    ParallelFor(count, MinNodesPerBatch, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            uint32_t index = indexList[i];
+            uint32_t parentIndex = _parentIndexList[index];
+
+            Mat3 basis = glm::mat3_cast(_rotationList[index]);
+            basis[0] = basis[0] * _scaleList[index].x;
+            basis[1] = basis[1] * _scaleList[index].y;
+            basis[2] = basis[2] * _scaleList[index].z;
+
+            const Vec3& position = _positionList[index];
+
+            if (parentIndex == InvalidIndex) {
+                _worldMatrixList[index] = Mat4(
+                    Vec4(basis[0], 0.0f),
+                    Vec4(basis[1], 0.0f),
+                    Vec4(basis[2], 0.0f),
+                    Vec4(position, 1.0f));
+            }
+            else {
+                _worldMatrixList[index] = MultiplyAffine(_worldMatrixList[parentIndex], basis, position);
+            }
+
+            _updateStampList[index] = _updateStamp;
+        }
+    });
+}
+
+} // namespace noon
@@ -0,0 +1,633 @@
+#include <Noon/VertexFormat.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/Hash.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace noon {
+
+struct EncodedFormat
+{
+    VkFormat Format;
+
+    uint32_t Size;
+
+}; // struct EncodedFormat
+
+static EncodedFormat GetEncodedFormat(VertexAttribute attribute, VertexEncoding encoding)
+{
+    switch (attribute) {
+        case VertexAttribute::Position:
+            // Always four components, the w holds the bitangent sign for octahedral tangents
+            switch (encoding) {
+                case VertexEncoding::Float32:
+                    return { VK_FORMAT_R32G32B32A32_SFLOAT, 16 };
+                case VertexEncoding::Float16:
+                    return { VK_FORMAT_R16G16B16A16_SFLOAT, 8 };
+                case VertexEncoding::Snorm16:
+                    return { VK_FORMAT_R16G16B16A16_SNORM, 8 };
+                default:
+                    break;
+            }
+            break;
+        case VertexAttribute::Normal:
+        case VertexAttribute::Tangent:
+            switch (encoding) {
+                case VertexEncoding::Float32:
+                    return (attribute == VertexAttribute::Normal
+                        ? EncodedFormat{ VK_FORMAT_R32G32B32_SFLOAT, 12 }
+                        : EncodedFormat{ VK_FORMAT_R32G32B32A32_SFLOAT, 16 });
+                case VertexEncoding::Float16:
+                    return { VK_FORMAT_R16G16B16A16_SFLOAT, 8 };
+                case VertexEncoding::Snorm16:
+                    return { VK_FORMAT_R16G16B16A16_SNORM, 8 };
+                case VertexEncoding::Snorm8:
+                    return { VK_FORMAT_R8G8B8A8_SNORM, 4 };
+                case VertexEncoding::Octahedral16:
+                    return { VK_FORMAT_R16G16_SNORM, 4 };
+                case VertexEncoding::Octahedral8:
+                    return { VK_FORMAT_R8G8_SNORM, 2 };
+                default:
+                    break;
+            }
+            break;
+        case VertexAttribute::Color:
+        case VertexAttribute::Weights:
+            switch (encoding) {
+                case VertexEncoding::Float32:
+                    return { VK_FORMAT_R32G32B32A32_SFLOAT, 16 };
+                case VertexEncoding::Float16:
+                    return { VK_FORMAT_R16G16B16A16_SFLOAT, 8 };
+                case VertexEncoding::Unorm16:
+                    return { VK_FORMAT_R16G16B16A16_UNORM, 8 };
+                case VertexEncoding::Unorm8:
+                    return { VK_FORMAT_R8G8B8A8_UNORM, 4 };
+                default:
+                    break;
+            }
+            break;
+        case VertexAttribute::TexCoord1:
+        case VertexAttribute::TexCoord2:
+            switch (encoding) {
+                case VertexEncoding::Float32:
+                    return { VK_FORMAT_R32G32_SFLOAT, 8 };
+                case VertexEncoding::Float16:
+                    return { VK_FORMAT_R16G16_SFLOAT, 4 };
+                case VertexEncoding::Unorm16:
+                    return { VK_FORMAT_R16G16_UNORM, 4 };
+                default:
+                    break;
+            }
+            break;
+        case VertexAttribute::Joints:
+            switch (encoding) {
+                case VertexEncoding::Uint32:
+                    return { VK_FORMAT_R32G32B32A32_UINT, 16 };
+                case VertexEncoding::Uint16:
+                    return { VK_FORMAT_R16G16B16A16_UINT, 8 };
+                case VertexEncoding::Uint8:
+                    return { VK_FORMAT_R8G8B8A8_UINT, 4 };
+                default:
+                    break;
+            }
+            break;
+    }
+
+    return { VK_FORMAT_UNDEFINED, 0 };
+}
+
+static inline bool IsOctahedral(VertexEncoding encoding)
+{
+    return (encoding == VertexEncoding::Octahedral16 || encoding == VertexEncoding::Octahedral8);
+}
+
+// Folds the lower hemisphere over the upper one, so a unit vector fits in [-1, 1]^2
+// https://jcgt.org/published/0003/02/01/
+static Vec2 OctahedralEncode(const Vec3& normal)
+{
+    float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (length == 0.0f) {
+        return Vec2(0.0f, 0.0f);
+    }
+
+    Vec3 n = normal / length;
+    if (n.z >= 0.0f) {
+        return Vec2(n.x, n.y);
+    }
+
+    return Vec2(
+        (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+        (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f)
+    );
+}
+
+template <typename T>
+static inline void Write(uint8_t * dst, size_t index, T value)
+{
+    memcpy(dst + index * sizeof(T), &value, sizeof(T));
+}
+
+// Encode up to four components of an attribute that the shader reads as floats
+static void EncodeFloats(uint8_t * dst, VertexEncoding encoding, const float * values, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        switch (encoding) {
+            case VertexEncoding::Float32:
+                Write<float>(dst, i, values[i]);
+                break;
+            case VertexEncoding::Float16:
+                Write<uint16_t>(dst, i, glm::packHalf1x16(values[i]));
+                break;
+            case VertexEncoding::Snorm16:
+            case VertexEncoding::Octahedral16:
+                Write<uint16_t>(dst, i, glm::packSnorm1x16(values[i]));
+                break;
+            case VertexEncoding::Unorm16:
+                Write<uint16_t>(dst, i, glm::packUnorm1x16(values[i]));
+                break;
+            case VertexEncoding::Snorm8:
+            case VertexEncoding::Octahedral8:
+                Write<uint8_t>(dst, i, glm::packSnorm1x8(values[i]));
+                break;
+            case VertexEncoding::Unorm8:
+                Write<uint8_t>(dst, i, glm::packUnorm1x8(values[i]));
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static void EncodeJoints(uint8_t * dst, VertexEncoding encoding, const Vec4u& joints)
+{
+    for (int i = 0; i < 4; ++i) {
+        switch (encoding) {
+            case VertexEncoding::Uint32:
+                Write<uint32_t>(dst, i, joints[i]);
+                break;
+            case VertexEncoding::Uint16:
+                Write<uint16_t>(dst, i, static_cast<uint16_t>(joints[i]));
+                break;
+            case VertexEncoding::Uint8:
+                Write<uint8_t>(dst, i, static_cast<uint8_t>(joints[i]));
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Quantized weights are adjusted so they still sum to exactly one
+static void EncodeWeights(uint8_t * dst, VertexEncoding encoding, const Vec4& weights)
+{
+    if (encoding != VertexEncoding::Unorm8 && encoding != VertexEncoding::Unorm16) {
+        EncodeFloats(dst, encoding, &weights.x, 4);
+        return;
+    }
+
+    float sum = weights.x + weights.y + weights.z + weights.w;
+    if (sum <= 0.0f) {
+        EncodeFloats(dst, encoding, &weights.x, 4);
+        return;
+    }
+
+    int maximum = (encoding == VertexEncoding::Unorm8 ? 0xFF : 0xFFFF);
+
+    Array<int, 4> quantized;
+    int total = 0;
+    int largest = 0;
+    for (int i = 0; i < 4; ++i) {
+        quantized[i] = static_cast<int>(std::round(weights[i] / sum * maximum));
+        total += quantized[i];
+        if (quantized[i] > quantized[largest]) {
+            largest = i;
+        }
+    }
+
+    quantized[largest] += maximum - total;
+
+    for (int i = 0; i < 4; ++i) {
+        if (encoding == VertexEncoding::Unorm8) {
+            Write<uint8_t>(dst, i, static_cast<uint8_t>(quantized[i]));
+        }
+        else {
+            Write<uint16_t>(dst, i, static_cast<uint16_t>(quantized[i]));
+        }
+    }
+}
+
+template <typename T>
+static void CheckVertexCount(const List<T>& list, size_t vertexCount, VertexAttribute attribute)
+{
+    if (!list.empty() && list.size() != vertexCount) {
+        throw Exception("Vertex data has {} {} values, but {} positions",
+            list.size(), VertexAttributeToString(attribute), vertexCount);
+    }
+}
+
+static VertexEncoding ChooseTexCoordEncoding(const List<Vec2>& texCoordList)
+{
+    if (texCoordList.empty()) {
+        return VertexEncoding::None;
+    }
+
+    float minimum = 0.0f;
+    float maximum = 0.0f;
+    for (const auto& texCoord : texCoordList) {
+        minimum = std::min({ minimum, texCoord.x, texCoord.y });
+        maximum = std::max({ maximum, texCoord.x, texCoord.y });
+    }
+
+    if (minimum >= 0.0f && maximum <= 1.0f) {
+        return VertexEncoding::Unorm16;
+    }
+
+    // Past 2.0 half floats are coarser than a texel of a 1024 texture
+    if (minimum >= -2.0f && maximum <= 2.0f) {
+        return VertexEncoding::Float16;
+    }
+
+    return VertexEncoding::Float32;
+}
+
+VertexFormat VertexFormat::FullPrecision()
+{
+    VertexFormat format;
+    format.SetEncoding(VertexAttribute::Position, VertexEncoding::Float32);
+    format.SetEncoding(VertexAttribute::Normal, VertexEncoding::Float32);
+    format.SetEncoding(VertexAttribute::Tangent, VertexEncoding::Float32);
+    format.SetEncoding(VertexAttribute::Color, VertexEncoding::Float32);
+    format.SetEncoding(VertexAttribute::TexCoord1, VertexEncoding::Float32);
+    format.SetEncoding(VertexAttribute::TexCoord2, VertexEncoding::Float32);
+    format.SetEncoding(VertexAttribute::Joints, VertexEncoding::Uint32);
+    format.SetEncoding(VertexAttribute::Weights, VertexEncoding::Float32);
+    return format;
+}
+
+VertexFormat VertexFormat::Choose(const VertexData& vertexData)
+{
+    VertexFormat format;
+
+    // Relative to the bounds, this is 1/65536th of the mesh's size
+    format.SetEncoding(VertexAttribute::Position, VertexEncoding::Snorm16);
+
+    // Under 0.01 degrees of error
+    if (!vertexData.Normals.empty()) {
+        format.SetEncoding(VertexAttribute::Normal, VertexEncoding::Octahedral16);
+    }
+
+    if (!vertexData.Tangents.empty()) {
+        format.SetEncoding(VertexAttribute::Tangent, VertexEncoding::Octahedral16);
+    }
+
+    if (!vertexData.Colors.empty()) {
+        bool isHDR = std::any_of(vertexData.Colors.begin(), vertexData.Colors.end(),
+            [](const Vec4& color) {
+                return (
+                    color.r < 0.0f || color.g < 0.0f || color.b < 0.0f || color.a < 0.0f ||
+                    color.r > 1.0f || color.g > 1.0f || color.b > 1.0f || color.a > 1.0f
+                );
+            });
+
+        format.SetEncoding(VertexAttribute::Color,
+            (isHDR ? VertexEncoding::Float16 : VertexEncoding::Unorm8));
+    }
+
+    format.SetEncoding(VertexAttribute::TexCoord1, ChooseTexCoordEncoding(vertexData.TexCoords1));
+    format.SetEncoding(VertexAttribute::TexCoord2, ChooseTexCoordEncoding(vertexData.TexCoords2));
+
+    if (!vertexData.Joints.empty()) {
+        unsigned maximum = 0;
+        for (const auto& joints : vertexData.Joints) {
+            maximum = std::max({ maximum, joints.x, joints.y, joints.z, joints.w });
+        }
+
+        if (maximum <= 0xFF) {
+            format.SetEncoding(VertexAttribute::Joints, VertexEncoding::Uint8);
+        }
+        else if (maximum <= 0xFFFF) {
+            format.SetEncoding(VertexAttribute::Joints, VertexEncoding::Uint16);
+        }
+        else {
+            format.SetEncoding(VertexAttribute::Joints, VertexEncoding::Uint32);
+        }
+    }
+
+    if (!vertexData.Weights.empty()) {
+        format.SetEncoding(VertexAttribute::Weights, VertexEncoding::Unorm8);
+    }
+
+    return format;
+}
+
+List<uint8_t> VertexFormat::GetDefaultVertex()
+{
+    VertexData vertexData;
+    vertexData.Positions = { Vec3(0.0f, 0.0f, 0.0f) };
+    vertexData.Normals = { Vec3(0.0f, 0.0f, 1.0f) };
+    vertexData.Tangents = { Vec4(1.0f, 0.0f, 0.0f, 1.0f) };
+    vertexData.Colors = { Vec4(1.0f, 1.0f, 1.0f, 1.0f) };
+    vertexData.TexCoords1 = { Vec2(0.0f, 0.0f) };
+    vertexData.TexCoords2 = { Vec2(0.0f, 0.0f) };
+    vertexData.Joints = { Vec4u(0, 0, 0, 0) };
+    vertexData.Weights = { Vec4(1.0f, 0.0f, 0.0f, 0.0f) };
+
+    ShaderMesh shaderMesh;
+    return FullPrecision().Pack(vertexData, &shaderMesh);
+}
+
+VertexFormat::VertexFormat()
+{
+    _encodingList.fill(VertexEncoding::None);
+    _offsetList.fill(0);
+}
+
+void VertexFormat::SetEncoding(VertexAttribute attribute, VertexEncoding encoding)
+{
+    bool isValid = (
+        encoding == VertexEncoding::None
+        ? attribute != VertexAttribute::Position
+        : GetEncodedFormat(attribute, encoding).Format != VK_FORMAT_UNDEFINED
+    );
+
+    if (!isValid) {
+        throw Exception("Unable to encode vertex attribute {} as {}",
+            VertexAttributeToString(attribute), VertexEncodingToString(encoding));
+    }
+
+    _encodingList[static_cast<size_t>(attribute)] = encoding;
+
+    UpdateLayout();
+}
+
+VkFormat VertexFormat::GetAttributeFormat(VertexAttribute attribute) const
+{
+    return GetEncodedFormat(attribute, GetEncoding(attribute)).Format;
+}
+
+uint64_t VertexFormat::GetHash() const
+{
+    return HashFNV1a(reinterpret_cast<const uint8_t *>(_encodingList.data()),
+        _encodingList.size() * sizeof(VertexEncoding));
+}
+
+VertexSpecialization VertexFormat::GetSpecialization() const
+{
+    return VertexSpecialization{
+        .OctahedralNormal = IsOctahedral(GetEncoding(VertexAttribute::Normal)),
+        .OctahedralTangent = IsOctahedral(GetEncoding(VertexAttribute::Tangent)),
+    };
+}
+
+Array<VkVertexInputBindingDescription, 2> VertexFormat::GetBindingDescriptionList() const
+{
+    return {
+        VkVertexInputBindingDescription {
+            .binding = VertexBinding,
+            .stride = _stride,
+            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+        },
+        VkVertexInputBindingDescription {
+            .binding = DefaultBinding,
+            .stride = 0,
+            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+        },
+    };
+}
+
+Array<VkVertexInputAttributeDescription, VertexAttributeCount> VertexFormat::GetAttributeDescriptionList() const
+{
+    static const VertexFormat defaultFormat = FullPrecision();
+
+    Array<VkVertexInputAttributeDescription, VertexAttributeCount> attributeDescriptionList;
+
+    for (size_t i = 0; i < VertexAttributeCount; ++i) {
+        auto attribute = static_cast<VertexAttribute>(i);
+        bool isPresent = HasAttribute(attribute);
+
+        const auto& format = (isPresent ? *this : defaultFormat);
+
+        attributeDescriptionList[i] = VkVertexInputAttributeDescription{
+            .location = static_cast<uint32_t>(i),
+            .binding = (isPresent ? VertexBinding : DefaultBinding),
+            .format = format.GetAttributeFormat(attribute),
+            .offset = format.GetOffset(attribute),
+        };
+    }
+
+    return attributeDescriptionList;
+}
+
+List<uint8_t> VertexFormat::Pack(const VertexData& vertexData, ShaderMesh * shaderMesh) const
+{
+    size_t vertexCount = vertexData.GetVertexCount();
+
+    CheckVertexCount(vertexData.Normals, vertexCount, VertexAttribute::Normal);
+    CheckVertexCount(vertexData.Tangents, vertexCount, VertexAttribute::Tangent);
+    CheckVertexCount(vertexData.Colors, vertexCount, VertexAttribute::Color);
+    CheckVertexCount(vertexData.TexCoords1, vertexCount, VertexAttribute::TexCoord1);
+    CheckVertexCount(vertexData.TexCoords2, vertexCount, VertexAttribute::TexCoord2);
+    CheckVertexCount(vertexData.Joints, vertexCount, VertexAttribute::Joints);
+    CheckVertexCount(vertexData.Weights, vertexCount, VertexAttribute::Weights);
+
+    Vec3 minimum(0.0f);
+    Vec3 maximum(0.0f);
+    if (vertexCount > 0) {
+        minimum = maximum = vertexData.Positions[0];
+        for (const auto& position : vertexData.Positions) {
+            minimum = glm::min(minimum, position);
+            maximum = glm::max(maximum, position);
+        }
+    }
+
+    Vec3 center = (minimum + maximum) * 0.5f;
+    Vec3 extent = glm::max((maximum - minimum) * 0.5f, Vec3(1e-8f));
+
+    auto positionEncoding = GetEncoding(VertexAttribute::Position);
+
+    // Half floats are most precise near zero, so they are centered too
+    Vec3 scale(1.0f);
+    Vec3 offset(0.0f);
+    if (positionEncoding == VertexEncoding::Snorm16) {
+        scale = extent;
+        offset = center;
+    }
+    else if (positionEncoding == VertexEncoding::Float16) {
+        offset = center;
+    }
+
+    shaderMesh->PositionScale = Vec4(scale, 1.0f);
+    shaderMesh->PositionOffset = Vec4(offset, 0.0f);
+
+    bool octahedralTangent = IsOctahedral(GetEncoding(VertexAttribute::Tangent));
+
+    List<uint8_t> data(vertexCount * _stride, 0);
+
+    auto hasData = [&](VertexAttribute attribute, size_t size) {
+        return (HasAttribute(attribute) && size > 0);
+    };
+
+    for (size_t v = 0; v < vertexCount; ++v) {
+        uint8_t * vertex = data.data() + v * _stride;
+
+        auto dst = [&](VertexAttribute attribute) {
+            return vertex + GetOffset(attribute);
+        };
+
+        float sign = 1.0f;
+        if (octahedralTangent && !vertexData.Tangents.empty()) {
+            sign = (vertexData.Tangents[v].w < 0.0f ? -1.0f : 1.0f);
+        }
+
+        Vec4 position((vertexData.Positions[v] - offset) / scale, sign);
+        EncodeFloats(dst(VertexAttribute::Position), positionEncoding, &position.x, 4);
+
+        if (hasData(VertexAttribute::Normal, vertexData.Normals.size())) {
+            auto encoding = GetEncoding(VertexAttribute::Normal);
+            if (IsOctahedral(encoding)) {
+                Vec2 normal = OctahedralEncode(vertexData.Normals[v]);
+                EncodeFloats(dst(VertexAttribute::Normal), encoding, &normal.x, 2);
+            }
+            else {
+                Vec4 normal(vertexData.Normals[v], 0.0f);
+                size_t count = (encoding == VertexEncoding::Float32 ? 3 : 4);
+                EncodeFloats(dst(VertexAttribute::Normal), encoding, &normal.x, count);
+            }
+        }
+
+        if (hasData(VertexAttribute::Tangent, vertexData.Tangents.size())) {
+            auto encoding = GetEncoding(VertexAttribute::Tangent);
+            if (IsOctahedral(encoding)) {
+                Vec2 tangent = OctahedralEncode(Vec3(vertexData.Tangents[v]));
+                EncodeFloats(dst(VertexAttribute::Tangent), encoding, &tangent.x, 2);
+            }
+            else {
+                EncodeFloats(dst(VertexAttribute::Tangent), encoding, &vertexData.Tangents[v].x, 4);
+            }
+        }
+
+        if (hasData(VertexAttribute::Color, vertexData.Colors.size())) {
+            EncodeFloats(dst(VertexAttribute::Color), GetEncoding(VertexAttribute::Color),
+                &vertexData.Colors[v].x, 4);
+        }
+
+        if (hasData(VertexAttribute::TexCoord1, vertexData.TexCoords1.size())) {
+            EncodeFloats(dst(VertexAttribute::TexCoord1), GetEncoding(VertexAttribute::TexCoord1),
+                &vertexData.TexCoords1[v].x, 2);
+        }
+
+        if (hasData(VertexAttribute::TexCoord2, vertexData.TexCoords2.size())) {
+            EncodeFloats(dst(VertexAttribute::TexCoord2), GetEncoding(VertexAttribute::TexCoord2),
+                &vertexData.TexCoords2[v].x, 2);
+        }
+
+        if (hasData(VertexAttribute::Joints, vertexData.Joints.size())) {
+            EncodeJoints(dst(VertexAttribute::Joints), GetEncoding(VertexAttribute::Joints),
+                vertexData.Joints[v]);
+        }
+
+        if (hasData(VertexAttribute::Weights, vertexData.Weights.size())) {
+            EncodeWeights(dst(VertexAttribute::Weights), GetEncoding(VertexAttribute::Weights),
+                vertexData.Weights[v]);
+        }
+    }
+
+    return data;
+}
+
+String VertexFormat::ToString() const
+{
+    String str;
+    for (size_t i = 0; i < VertexAttributeCount; ++i) {
+        auto attribute = static_cast<VertexAttribute>(i);
+        if (HasAttribute(attribute)) {
+            str += fmt::format("{}={} ",
+                VertexAttributeToString(attribute), VertexEncodingToString(GetEncoding(attribute)));
+        }
+    }
+
+    str += fmt::format("({} B)", _stride);
+    return str;
+}
+
+void VertexFormat::UpdateLayout()
+{
+    uint32_t offset = 0;
+
+    for (size_t i = 0; i < VertexAttributeCount; ++i) {
+        auto attribute = static_cast<VertexAttribute>(i);
+        if (!HasAttribute(attribute)) {
+            _offsetList[i] = 0;
+            continue;
+        }
+
+        // Vulkan requires each attribute to be aligned to its component size, aligning all of
+        // them to 4 keeps that true for any mix of encodings
+        offset = (offset + 3) & ~3u;
+
+        _offsetList[i] = offset;
+        offset += GetEncodedFormat(attribute, GetEncoding(attribute)).Size;
+    }
+
+    _stride = (offset + 3) & ~3u;
+}
+
+String VertexAttributeToString(VertexAttribute attribute)
+{
+    switch (attribute) {
+        case VertexAttribute::Position:
+            return "Position";
+        case VertexAttribute::Normal:
+            return "Normal";
+        case VertexAttribute::Tangent:
+            return "Tangent";
+        case VertexAttribute::Color:
+            return "Color";
+        case VertexAttribute::TexCoord1:
+            return "TexCoord1";
+        case VertexAttribute::TexCoord2:
+            return "TexCoord2";
+        case VertexAttribute::Joints:
+            return "Joints";
+        case VertexAttribute::Weights:
+            return "Weights";
+        default:
+            return fmt::format("Unknown ({})", static_cast<int>(attribute));
+    }
+}
+
+String VertexEncodingToString(VertexEncoding encoding)
+{
+    switch (encoding) {
+        case VertexEncoding::None:
+            return "None";
+        case VertexEncoding::Float32:
+            return "Float32";
+        case VertexEncoding::Float16:
+            return "Float16";
+        case VertexEncoding::Snorm16:
+            return "Snorm16";
+        case VertexEncoding::Unorm16:
+            return "Unorm16";
+        case VertexEncoding::Snorm8:
+            return "Snorm8";
+        case VertexEncoding::Unorm8:
+            return "Unorm8";
+        case VertexEncoding::Uint32:
+            return "Uint32";
+        case VertexEncoding::Uint16:
+            return "Uint16";
+        case VertexEncoding::Uint8:
+            return "Uint8";
+        case VertexEncoding::Octahedral16:
+            return "Octahedral16";
+        case VertexEncoding::Octahedral8:
+            return "Octahedral8";
+        default:
+            return fmt::format("Unknown ({})", static_cast<int>(encoding));
+    }
+}
+
+} // namespace noon
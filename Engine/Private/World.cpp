@@ -0,0 +1,464 @@
+#include <Noon/World.hpp>
+#include <Noon/JobSystem.hpp>
+
+#include <algorithm>
+#include <exception>
+
+namespace noon {
+
+// Chunks are aligned to a cache line, as is every column within them
+static const size_t ChunkAlignment = 64;
+
+static inline size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+NOON_API
+World::World(std::pmr::memory_resource * resource)
+    : _resource(resource)
+    , _entityList(resource)
+    , _freeEntityList(resource)
+    , _archetypeList(resource)
+    , _archetypeMap(resource)
+    , _freeChunkList(resource)
+{
+}
+
+NOON_API
+World::~World()
+{
+    for (auto& archetype : _archetypeList) {
+        for (Chunk * chunk : archetype->ChunkList) {
+            for (size_t column = 0; column < archetype->TypeList.size(); ++column) {
+                const auto& info = GetComponentTypeInfo(archetype->TypeList[column]);
+
+                uint8_t * data = archetype->GetColumn(chunk, column);
+                for (uint32_t row = 0; row < chunk->Count; ++row) {
+                    info.Destroy(data + row * info.Size);
+                }
+            }
+
+            _resource->deallocate(chunk, ChunkSize, ChunkAlignment);
+        }
+    }
+
+    for (Chunk * chunk : _freeChunkList) {
+        _resource->deallocate(chunk, ChunkSize, ChunkAlignment);
+    }
+}
+
+NOON_API
+Entity World::Create()
+{
+    Chunk * chunk;
+    uint32_t row;
+    return CreateEntity(ComponentMask(), chunk, row);
+}
+
+NOON_API
+void World::Destroy(Entity entity)
+{
+    CheckStructuralChange();
+
+    const EntityRecord& record = GetRecord(entity);
+    Chunk * chunk = record.Storage;
+    uint32_t row = record.Row;
+
+    Archetype * archetype = chunk->Owner;
+    for (size_t column = 0; column < archetype->TypeList.size(); ++column) {
+        const auto& info = GetComponentTypeInfo(archetype->TypeList[column]);
+        info.Destroy(archetype->GetColumn(chunk, column) + row * info.Size);
+    }
+
+    ReleaseRow(chunk, row);
+
+    EntityRecord& released = _entityList[entity.Index];
+    released.Storage = nullptr;
+    ++released.Generation;
+    _freeEntityList.push_back(entity.Index);
+}
+
+NOON_API
+bool World::IsAlive(Entity entity) const
+{
+    return (entity.Index < _entityList.size()
+        && _entityList[entity.Index].Storage
+        && _entityList[entity.Index].Generation == entity.Generation);
+}
+
+NOON_API
+size_t World::GetChunkCount() const
+{
+    size_t count = 0;
+    for (const auto& archetype : _archetypeList) {
+        count += archetype->ChunkList.size();
+    }
+    return count;
+}
+
+NOON_API
+void World::AddSystem(StringView name, const Query& access, SystemFunction func)
+{
+    _systemList.push_back(System{
+        .Name = String(name),
+        .Access = access,
+        .Function = std::move(func),
+        .LastVersion = 0,
+    });
+}
+
+NOON_API
+void World::RunSystems()
+{
+    // Each system runs in the wave after the last earlier system it conflicts with, so the
+    // systems of a wave can run in parallel, and still see the changes made in the order
+    // they were added
+    List<size_t> waveList(_systemList.size(), 0);
+    size_t waveCount = 0;
+
+    for (size_t i = 0; i < _systemList.size(); ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            if (_systemList[i].Access.ConflictsWith(_systemList[j].Access)) {
+                waveList[i] = std::max(waveList[i], waveList[j] + 1);
+            }
+        }
+
+        waveCount = std::max(waveCount, waveList[i] + 1);
+    }
+
+    _runningSystems = true;
+
+    List<System *> runList;
+    for (size_t wave = 0; wave < waveCount; ++wave) {
+        runList.clear();
+        for (size_t i = 0; i < _systemList.size(); ++i) {
+            if (waveList[i] == wave) {
+                runList.push_back(&_systemList[i]);
+            }
+        }
+
+        // Everything written by this wave is newer than what the previous waves saw
+        ++_version;
+
+        // Exceptions are rethrown on this thread once the whole wave has finished
+        List<std::exception_ptr> exceptionList(runList.size());
+
+        auto run = [&](size_t index) {
+            try {
+                runList[index]->Function(*this, runList[index]->LastVersion);
+                runList[index]->LastVersion = _version;
+            }
+            catch (...) {
+                exceptionList[index] = std::current_exception();
+            }
+        };
+
+        // Runs the first system itself, and the rest as jobs when there is a job system
+        JobSystem * jobSystem = JobSystem::GetInstance();
+        if (jobSystem) {
+            JobCounter counter;
+            for (size_t i = 1; i < runList.size(); ++i) {
+                jobSystem->Schedule([&run, i]() { run(i); }, &counter);
+            }
+
+            run(0);
+            jobSystem->Wait(counter);
+        }
+        else {
+            for (size_t i = 0; i < runList.size(); ++i) {
+                run(i);
+            }
+        }
+
+        for (auto& exception : exceptionList) {
+            if (exception) {
+                _runningSystems = false;
+                std::rethrow_exception(exception);
+            }
+        }
+    }
+
+    _runningSystems = false;
+
+    // So that changes made outside of systems are newer than what the last wave saw
+    ++_version;
+
+    List<std::function<void(World&)>> deferredList;
+    {
+        std::lock_guard lock(_deferredMutex);
+        deferredList.swap(_deferredList);
+    }
+
+    for (auto& func : deferredList) {
+        func(*this);
+    }
+}
+
+NOON_API
+void World::Defer(std::function<void(World& world)> func)
+{
+    std::lock_guard lock(_deferredMutex);
+    _deferredList.push_back(std::move(func));
+}
+
+NOON_API
+Entity World::CreateEntity(const ComponentMask& mask, Chunk *& chunk, uint32_t& row)
+{
+    CheckStructuralChange();
+
+    Entity entity;
+    if (!_freeEntityList.empty()) {
+        entity.Index = _freeEntityList.back();
+        _freeEntityList.pop_back();
+    }
+    else {
+        entity.Index = static_cast<uint32_t>(_entityList.size());
+        _entityList.push_back(EntityRecord{ nullptr, 0, 0 });
+    }
+
+    AllocateRow(GetArchetype(mask), chunk, row);
+    chunk->Owner->GetEntityList(chunk)[row] = entity;
+
+    EntityRecord& record = _entityList[entity.Index];
+    record.Storage = chunk;
+    record.Row = row;
+    entity.Generation = record.Generation;
+
+    return entity;
+}
+
+NOON_API
+void * World::AddComponent(Entity entity, ComponentTypeID id)
+{
+    CheckStructuralChange();
+
+    Archetype * target = GetArchetypeWith(GetRecord(entity).Storage->Owner, id, true);
+
+    Chunk * chunk;
+    uint32_t row;
+    MoveEntity(entity, target, chunk, row);
+
+    const auto& info = GetComponentTypeInfo(id);
+    return target->GetColumn(chunk, target->ColumnList[id]) + row * info.Size;
+}
+
+NOON_API
+void World::RemoveComponent(Entity entity, ComponentTypeID id)
+{
+    CheckStructuralChange();
+
+    Archetype * archetype = GetRecord(entity).Storage->Owner;
+    if (!archetype->Mask.test(id)) {
+        return;
+    }
+
+    Chunk * chunk;
+    uint32_t row;
+    MoveEntity(entity, GetArchetypeWith(archetype, id, false), chunk, row);
+}
+
+NOON_API
+void * World::GetComponent(Entity entity, ComponentTypeID id, bool write)
+{
+    const EntityRecord& record = GetRecord(entity);
+    Archetype * archetype = record.Storage->Owner;
+
+    int column = archetype->ColumnList[id];
+    if (column < 0) {
+        return nullptr;
+    }
+
+    if (write) {
+        archetype->GetVersionList(record.Storage)[column] = _version;
+    }
+
+    return archetype->GetColumn(record.Storage, column) + record.Row * GetComponentTypeInfo(id).Size;
+}
+
+void World::CheckStructuralChange() const
+{
+    if (_runningSystems) {
+        throw Exception("Entities can't be changed structurally while systems are running, use World::Defer()");
+    }
+}
+
+const World::EntityRecord& World::GetRecord(Entity entity) const
+{
+    if (!IsAlive(entity)) {
+        throw Exception("Entity {}:{} does not exist", entity.Index, entity.Generation);
+    }
+
+    return _entityList[entity.Index];
+}
+
+Archetype * World::GetArchetype(const ComponentMask& mask)
+{
+    auto it = _archetypeMap.find(mask);
+    if (it != _archetypeMap.end()) {
+        return it->second;
+    }
+
+    auto archetype = std::make_unique<Archetype>();
+    archetype->Mask = mask;
+    archetype->ColumnList.fill(-1);
+
+    size_t componentBytes = 0;
+    for (ComponentTypeID id = 0; id < MaxComponentTypeCount; ++id) {
+        if (mask.test(id)) {
+            const auto& info = GetComponentTypeInfo(id);
+            if (info.Alignment > ChunkAlignment) {
+                throw Exception("Component '{}' requires an alignment of {}, the limit is {}", info.Name, info.Alignment, ChunkAlignment);
+            }
+
+            archetype->ColumnList[id] = static_cast<int16_t>(archetype->TypeList.size());
+            archetype->TypeList.push_back(id);
+            componentBytes += info.Size;
+        }
+    }
+
+    size_t columnCount = archetype->TypeList.size();
+    size_t headerBytes = AlignUp(sizeof(Chunk), alignof(uint32_t));
+
+    archetype->VersionOffset = static_cast<uint32_t>(headerBytes);
+
+    // Every array is aligned to ChunkAlignment, start from the upper bound of what fits and
+    // shrink until the padding fits too
+    size_t entityOffset = AlignUp(headerBytes + columnCount * sizeof(uint32_t), ChunkAlignment);
+    size_t capacity = (ChunkSize - entityOffset) / (sizeof(Entity) + componentBytes);
+
+    while (capacity > 0) {
+        size_t offset = AlignUp(entityOffset + capacity * sizeof(Entity), ChunkAlignment);
+
+        archetype->OffsetList.clear();
+        for (ComponentTypeID id : archetype->TypeList) {
+            archetype->OffsetList.push_back(static_cast<uint32_t>(offset));
+            offset = AlignUp(offset + capacity * GetComponentTypeInfo(id).Size, ChunkAlignment);
+        }
+
+        if (offset <= ChunkSize) {
+            break;
+        }
+
+        --capacity;
+    }
+
+    if (capacity == 0) {
+        throw Exception("Components of an archetype use {} bytes, which doesn't fit in a chunk", componentBytes);
+    }
+
+    archetype->EntityOffset = static_cast<uint32_t>(entityOffset);
+    archetype->Capacity = static_cast<uint32_t>(capacity);
+
+    Archetype * result = archetype.get();
+    _archetypeList.push_back(std::move(archetype));
+    _archetypeMap.emplace(mask, result);
+
+    return result;
+}
+
+Archetype * World::GetArchetypeWith(Archetype * archetype, ComponentTypeID id, bool add)
+{
+    auto& edgeMap = (add ? archetype->AddEdgeMap : archetype->RemoveEdgeMap);
+
+    auto it = edgeMap.find(id);
+    if (it != edgeMap.end()) {
+        return it->second;
+    }
+
+    ComponentMask mask = archetype->Mask;
+    mask.set(id, add);
+
+    Archetype * target = GetArchetype(mask);
+    edgeMap.emplace(id, target);
+    return target;
+}
+
+void World::AllocateRow(Archetype * archetype, Chunk *& chunk, uint32_t& row)
+{
+    if (archetype->ChunkList.empty() || archetype->ChunkList.back()->Count == archetype->Capacity) {
+        if (!_freeChunkList.empty()) {
+            chunk = _freeChunkList.back();
+            _freeChunkList.pop_back();
+        }
+        else {
+            chunk = static_cast<Chunk *>(_resource->allocate(ChunkSize, ChunkAlignment));
+        }
+
+        chunk->Owner = archetype;
+        chunk->Count = 0;
+        chunk->Index = static_cast<uint32_t>(archetype->ChunkList.size());
+        archetype->ChunkList.push_back(chunk);
+    }
+
+    chunk = archetype->ChunkList.back();
+    row = chunk->Count++;
+
+    // The new row counts as a change of every component in the chunk
+    std::fill_n(archetype->GetVersionList(chunk), archetype->TypeList.size(), _version);
+}
+
+void World::ReleaseRow(Chunk * chunk, uint32_t row)
+{
+    Archetype * archetype = chunk->Owner;
+    Chunk * lastChunk = archetype->ChunkList.back();
+    uint32_t lastRow = lastChunk->Count - 1;
+
+    if (chunk != lastChunk || row != lastRow) {
+        for (size_t column = 0; column < archetype->TypeList.size(); ++column) {
+            const auto& info = GetComponentTypeInfo(archetype->TypeList[column]);
+            info.Relocate(
+                archetype->GetColumn(chunk, column) + row * info.Size,
+                archetype->GetColumn(lastChunk, column) + lastRow * info.Size);
+        }
+
+        Entity moved = archetype->GetEntityList(lastChunk)[lastRow];
+        archetype->GetEntityList(chunk)[row] = moved;
+
+        EntityRecord& record = _entityList[moved.Index];
+        record.Storage = chunk;
+        record.Row = row;
+
+        std::fill_n(archetype->GetVersionList(chunk), archetype->TypeList.size(), _version);
+    }
+
+    if (--lastChunk->Count == 0) {
+        archetype->ChunkList.pop_back();
+        _freeChunkList.push_back(lastChunk);
+    }
+}
+
+void World::MoveEntity(Entity entity, Archetype * target, Chunk *& chunk, uint32_t& row)
+{
+    EntityRecord& record = _entityList[entity.Index];
+    Chunk * source = record.Storage;
+    uint32_t sourceRow = record.Row;
+    Archetype * archetype = source->Owner;
+
+    AllocateRow(target, chunk, row);
+
+    for (size_t column = 0; column < archetype->TypeList.size(); ++column) {
+        ComponentTypeID id = archetype->TypeList[column];
+        const auto& info = GetComponentTypeInfo(id);
+
+        uint8_t * data = archetype->GetColumn(source, column) + sourceRow * info.Size;
+
+        int targetColumn = target->ColumnList[id];
+        if (targetColumn >= 0) {
+            info.Relocate(target->GetColumn(chunk, targetColumn) + row * info.Size, data);
+        }
+        else {
+            info.Destroy(data);
+        }
+    }
+
+    target->GetEntityList(chunk)[row] = entity;
+
+    // Moves the last entity of the source archetype into the hole, which updates its record
+    ReleaseRow(source, sourceRow);
+
+    record.Storage = chunk;
+    record.Row = row;
+}
+
+} // namespace noon
@@ -2,11 +2,40 @@
 #define NOON_APPLICATION_HPP
 
 #include <Noon/Config.hpp>
+#include <Noon/AssetManager.hpp>
+#include <Noon/AsyncIO.hpp>
+#include <Noon/FileSystem.hpp>
 #include <Noon/GraphicsDriver.hpp>
+#include <Noon/JobSystem.hpp>
+#include <Noon/TextureStreamer.hpp>
 #include <Noon/Version.hpp>
+#include <Noon/World.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 namespace noon {
 
+// Exponential moving averages, in milliseconds
+struct FrameStats
+{
+    // ProcessEvents() through Update(), and PreRender()
+    float SimulationMS;
+
+    // Render(), including waiting for a backbuffer
+    float RenderMS;
+
+    // From the start of one frame to the start of the next
+    float FrameMS;
+
+    // From the start of a frame's simulation to the end of its Render()
+    float LatencyMS;
+
+}; // struct FrameStats
+
 class NOON_API Application
 {
 public:
@@ -37,24 +66,125 @@ public:
         _targetFPS = fps;
     }
 
+    JobSystem * GetJobSystem() const {
+        return _jobSystem;
+    }
+
+    AsyncIO * GetAsyncIO() const {
+        return _asyncIO;
+    }
+
+    // Has every directory in the asset path mounted at the root
+    FileSystem * GetFileSystem() const {
+        return _fileSystem;
+    }
+
     GraphicsDriver * GetGraphicsDriver() const {
         return _graphicsDriver;
     }
 
+    // Updated every frame before PreRender()
+    TextureStreamer * GetTextureStreamer() const {
+        return _textureStreamer;
+    }
+
+    // Updated every frame before PreRender(), after the TextureStreamer
+    AssetManager * GetAssetManager() const {
+        return _assetManager;
+    }
+
+    World * GetWorld() const {
+        return _world;
+    }
+
+    // When pipelined, frame N renders on its own thread while frame N+1 is simulated, which
+    // brings the frame time down to the longer of the two, at the cost of up to a frame of
+    // extra latency. Can be changed between frames.
+    bool IsPipelined() const {
+        return _pipelined;
+    }
+
+    void SetPipelined(bool pipelined) {
+        _pipelined = pipelined;
+    }
+
+    const FrameStats& GetFrameStats() const {
+        return _frameStats;
+    }
+
     void Run();
 
     void Stop();
 
+protected:
+
+    // Called every frame after the world's systems have run
+    virtual void Update();
+
+    // Called every frame once the previous frame has finished rendering, which makes it the
+    // place to touch what Render() reads, such as GPU scenes. The render queue and view filled
+    // so far are handed to Render() right after.
+    virtual void PreRender();
+
 private:
 
+    void RenderThreadMain();
+
+    // Wait for the frame on the render thread to finish, and rethrow what it threw
+    void WaitForRender();
+
+    void StopRenderThread();
+
+    void UpdateFrameStats(float& average, float ms);
+
     static Application * _Instance;
 
     float _targetFPS = 60.0f;
 
     bool _running = false;
 
+    JobSystem * _jobSystem = nullptr;
+
+    AsyncIO * _asyncIO = nullptr;
+
+    FileSystem * _fileSystem = nullptr;
+
     GraphicsDriver * _graphicsDriver = nullptr;
 
+    TextureStreamer * _textureStreamer = nullptr;
+
+    AssetManager * _assetManager = nullptr;
+
+    World * _world = nullptr;
+
+    bool _pipelined = false;
+
+    FrameStats _frameStats = {};
+
+    std::thread _renderThread;
+
+    std::mutex _renderMutex;
+
+    std::condition_variable _renderCondition;
+
+    bool _renderRequested = false;
+
+    bool _renderThreadRunning = false;
+
+    // A frame was handed to the render thread and not waited for yet, only used by the main
+    // thread
+    bool _renderInFlight = false;
+
+    // The time the frame being rendered started simulating, for its latency
+    std::chrono::high_resolution_clock::time_point _renderFrameStartTime;
+
+    // Measured by the render thread, and added to the stats by the main thread
+    float _lastRenderMS = 0.0f;
+
+    float _lastLatencyMS = 0.0f;
+
+    std::exception_ptr _renderException;
+
 }; // class Application
 
 } // namespace noon
@@ -0,0 +1,415 @@
+#ifndef NOON_ASSET_MANAGER_HPP
+#define NOON_ASSET_MANAGER_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/AssetPack.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/FileSystem.hpp>
+#include <Noon/JobSystem.hpp>
+#include <Noon/Mesh.hpp>
+#include <Noon/Shader.hpp>
+#include <Noon/ShaderMaterial.hpp>
+#include <Noon/String.hpp>
+#include <Noon/Texture.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace noon {
+
+enum class AssetState : uint8_t
+{
+    // Not requested, or freed once nothing referenced it
+    Unloaded,
+
+    // Being read and decoded on a job, then uploaded by AssetManager::Update()
+    Loading,
+
+    Resident,
+
+    // Nothing references it, and it is kept until the frames in flight are done with it. It
+    // returns to Resident (or Failed, if it never loaded) right away if requested meanwhile.
+    Evicting,
+
+    // Missing or invalid, handles keep returning the fallback
+    Failed,
+
+}; // enum class AssetState
+
+NOON_API
+String AssetStateToString(AssetState state);
+
+// The index of a slot in the low 32 bits and its generation in the high 32 bits, so the IDs of
+// an asset that was freed never match whatever reuses its slot
+using AssetID = uint64_t;
+
+constexpr AssetID InvalidAssetID = 0;
+
+struct Material;
+
+// The AssetType each handle type is loaded from
+template <class T>
+struct AssetTypeOf;
+
+template <>
+struct AssetTypeOf<Mesh>
+{
+    static constexpr AssetType Type = AssetType::Mesh;
+};
+
+template <>
+struct AssetTypeOf<Texture>
+{
+    static constexpr AssetType Type = AssetType::Texture;
+};
+
+template <>
+struct AssetTypeOf<Material>
+{
+    static constexpr AssetType Type = AssetType::Material;
+};
+
+template <>
+struct AssetTypeOf<Shader>
+{
+    static constexpr AssetType Type = AssetType::Shader;
+};
+
+// A counted reference to an asset of the AssetManager. The asset stays loaded for as long as
+// any handle to it exists, and is evicted once the last one is gone. Handles can be copied and
+// destroyed on any thread.
+template <class T>
+class AssetHandle
+{
+public:
+
+    AssetHandle() = default;
+
+    AssetHandle(const AssetHandle& other);
+
+    AssetHandle(AssetHandle&& other) noexcept
+        : _id(std::exchange(other._id, InvalidAssetID))
+    { }
+
+    ~AssetHandle();
+
+    AssetHandle& operator=(const AssetHandle& other);
+
+    AssetHandle& operator=(AssetHandle&& other) noexcept;
+
+    inline bool IsValid() const {
+        return (_id != InvalidAssetID);
+    }
+
+    inline AssetID GetID() const {
+        return _id;
+    }
+
+    AssetState GetState() const;
+
+    inline bool IsResident() const {
+        return (GetState() == AssetState::Resident);
+    }
+
+    // nullptr until resident, and only valid until the next AssetManager::Update()
+    T * Get() const;
+
+    // The fallback set with AssetManager::SetFallback() until resident, which is nullptr for
+    // types without one, such as meshes
+    T * GetOrFallback() const;
+
+    void Reset();
+
+private:
+
+    friend class AssetManager;
+
+    // Takes over a reference that was already added
+    explicit AssetHandle(AssetID id)
+        : _id(id)
+    { }
+
+    AssetID _id = InvalidAssetID;
+
+}; // class AssetHandle
+
+// The resident form of an AssetType::Material. Its textures are requested when it loads and
+// stream in on their own, so a material is resident before its textures are.
+struct Material
+{
+    ShaderMaterial Parameters;
+
+    bool DoubleSided = false;
+
+    // Empty for maps the material doesn't have
+    AssetHandle<Texture> BaseColorMap;
+
+    AssetHandle<Texture> NormalMap;
+
+    AssetHandle<Texture> MetallicRoughnessMap;
+
+    AssetHandle<Texture> EmissiveMap;
+
+    AssetHandle<Texture> OcclusionMap;
+
+}; // struct Material
+
+struct AssetStats
+{
+    // Slots holding an asset in any state
+    uint32_t AssetCount;
+
+    uint32_t LoadingCount;
+
+    uint32_t ResidentCount;
+
+    uint32_t EvictingCount;
+
+    uint32_t FailedCount;
+
+    // Loaded, and waiting for Update() to upload them
+    uint32_t PendingUploadCount;
+
+}; // struct AssetStats
+
+// Loads meshes, textures, materials and shaders by name from the FileSystem, and tracks them
+// in a generational slot map that AssetHandles index into.
+//
+// Load() returns right away, and the asset is read and decoded on a job. Shaders and materials
+// are finished there, while meshes and textures are uploaded by Update() on the main thread,
+// under a per-frame budget so a burst of loads doesn't stall a frame. Until an asset is
+// resident, its handles return the fallback for its type. Once the last handle is destroyed the
+// asset is evicted, and destroyed when no frame in flight can still be using it.
+class NOON_API AssetManager
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(AssetManager)
+
+    static AssetManager * GetInstance() {
+        return _Instance;
+    }
+
+    // The most assets that can exist at once
+    static constexpr uint32_t MaxAssetCount = 1 << 22;
+
+    // Requires a JobSystem, a FileSystem and a GraphicsDriver
+    AssetManager();
+
+    // Waits for every load in progress
+    ~AssetManager();
+
+    // Can be called from any thread. Requesting an asset that is loading or resident returns
+    // another handle to it. A name that is already loaded as another type logs and returns an
+    // empty handle.
+    template <class T>
+    AssetHandle<T> Load(StringView name) {
+        return AssetHandle<T>(Acquire(name, AssetTypeOf<T>::Type));
+    }
+
+    // Returned by handles until their asset is resident. Textures and materials have a white
+    // texture and a default material unless replaced. Must not be called while Render() runs.
+    template <class T>
+    void SetFallback(std::shared_ptr<T> fallback) {
+        _fallbackList[static_cast<size_t>(AssetTypeOf<T>::Type)] = std::move(fallback);
+    }
+
+    template <class T>
+    T * GetFallback() const {
+        return static_cast<T *>(_fallbackList[static_cast<size_t>(AssetTypeOf<T>::Type)].get());
+    }
+
+    inline uint64_t GetMaxUploadBytes() const {
+        return _maxUploadBytes;
+    }
+
+    // Meshes and textures uploaded by each Update(), at least one is always uploaded
+    inline void SetMaxUploadBytes(uint64_t bytes) {
+        _maxUploadBytes = bytes;
+    }
+
+    // Upload what finished loading, evict what is no longer referenced, and destroy what frames
+    // in flight are done with. Should be called once per frame while Render() isn't running.
+    void Update();
+
+    AssetState GetState(AssetID id) const;
+
+    // nullptr unless the asset is resident
+    void * GetObject(AssetID id) const;
+
+    void AddReference(AssetID id);
+
+    void RemoveReference(AssetID id);
+
+    AssetStats GetStats() const;
+
+private:
+
+    static AssetManager * _Instance;
+
+    static constexpr uint32_t SlotsPerPage = 1024;
+
+    static constexpr uint32_t MaxPageCount = MaxAssetCount / SlotsPerPage;
+
+    static constexpr size_t AssetTypeCount = static_cast<size_t>(AssetType::Texture) + 1;
+
+    struct Slot
+    {
+        // Bumped when the slot is freed
+        std::atomic<uint32_t> Generation = 1;
+
+        std::atomic<uint32_t> ReferenceCount = 0;
+
+        std::atomic<AssetState> State = AssetState::Unloaded;
+
+        AssetType Type = AssetType::Raw;
+
+        String Name;
+
+        // Owns the resident object, which handles read through Pointer without a lock
+        std::shared_ptr<void> Object;
+
+        std::atomic<void *> Pointer = nullptr;
+
+        // What the load job read for Update() to upload
+        FileData File;
+
+        bool LoadFailed = false;
+
+        uint64_t EvictFrameIndex = 0;
+
+    }; // struct Slot
+
+    // Adds a reference to the asset, and starts loading it if needed
+    AssetID Acquire(StringView name, AssetType type);
+
+    // Returns nullptr if the ID is stale or out of range
+    Slot * GetSlot(AssetID id) const;
+
+    inline Slot& GetSlot(uint32_t index) const {
+        return _pageList[index / SlotsPerPage][index % SlotsPerPage];
+    }
+
+    // Runs on a job
+    void LoadSlot(uint32_t index);
+
+    // Create the GPU object of a mesh or texture, returns false if it failed
+    bool UploadSlot(Slot& slot);
+
+    // Must hold _mutex
+    void FreeSlot(uint32_t index, List<std::shared_ptr<void>>& destroyList);
+
+    mutable std::mutex _mutex;
+
+    Array<std::unique_ptr<Slot[]>, MaxPageCount> _pageList;
+
+    // Slots in use or freed, new slots are only taken once the free list is empty
+    std::atomic<uint32_t> _slotCount = 0;
+
+    List<uint32_t> _freeList;
+
+    Map<String, AssetID> _nameMap;
+
+    // Slots whose load job finished, in the order they finished
+    Queue<uint32_t> _loadedQueue;
+
+    // Slots whose last reference was removed
+    List<uint32_t> _releasedList;
+
+    List<uint32_t> _evictingList;
+
+    Array<std::shared_ptr<void>, AssetTypeCount> _fallbackList;
+
+    JobCounter _jobCounter;
+
+    uint64_t _maxUploadBytes = 64 * 1024 * 1024;
+
+    uint64_t _frameIndex = 0;
+
+}; // class AssetManager
+
+template <class T>
+AssetHandle<T>::AssetHandle(const AssetHandle& other)
+    : _id(other._id)
+{
+    if (_id != InvalidAssetID) {
+        AssetManager::GetInstance()->AddReference(_id);
+    }
+}
+
+template <class T>
+AssetHandle<T>::~AssetHandle()
+{
+    Reset();
+}
+
+template <class T>
+AssetHandle<T>& AssetHandle<T>::operator=(const AssetHandle& other)
+{
+    if (this != &other) {
+        if (other._id != InvalidAssetID) {
+            AssetManager::GetInstance()->AddReference(other._id);
+        }
+
+        Reset();
+        _id = other._id;
+    }
+
+    return *this;
+}
+
+template <class T>
+AssetHandle<T>& AssetHandle<T>::operator=(AssetHandle&& other) noexcept
+{
+    if (this != &other) {
+        Reset();
+        _id = std::exchange(other._id, InvalidAssetID);
+    }
+
+    return *this;
+}
+
+template <class T>
+AssetState AssetHandle<T>::GetState() const
+{
+    AssetManager * manager = AssetManager::GetInstance();
+    return (manager ? manager->GetState(_id) : AssetState::Unloaded);
+}
+
+template <class T>
+T * AssetHandle<T>::Get() const
+{
+    AssetManager * manager = AssetManager::GetInstance();
+    return (manager ? static_cast<T *>(manager->GetObject(_id)) : nullptr);
+}
+
+template <class T>
+T * AssetHandle<T>::GetOrFallback() const
+{
+    AssetManager * manager = AssetManager::GetInstance();
+    if (!manager) {
+        return nullptr;
+    }
+
+    T * object = static_cast<T *>(manager->GetObject(_id));
+    return (object ? object : manager->GetFallback<T>());
+}
+
+template <class T>
+void AssetHandle<T>::Reset()
+{
+    // Handles that outlive the manager have nothing left to release
+    AssetManager * manager = AssetManager::GetInstance();
+    if (_id != InvalidAssetID && manager) {
+        manager->RemoveReference(_id);
+    }
+
+    _id = InvalidAssetID;
+}
+
+} // namespace noon
+
+#endif // NOON_ASSET_MANAGER_HPP
@@ -0,0 +1,200 @@
+#ifndef NOON_ASSET_PACK_HPP
+#define NOON_ASSET_PACK_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Bounds.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/MappedFile.hpp>
+#include <Noon/Mesh.hpp>
+#include <Noon/MeshLOD.hpp>
+#include <Noon/ShaderMaterial.hpp>
+#include <Noon/ShaderMesh.hpp>
+#include <Noon/String.hpp>
+#include <Noon/Texture.hpp>
+#include <Noon/VertexFormat.hpp>
+
+#include <cstdint>
+#include <memory>
+
+namespace noon {
+
+enum class AssetType : uint32_t
+{
+    // Stored as-is, e.g. an image in its source format
+    Raw,
+
+    // SPIR-V
+    Shader,
+
+    // A PackedMesh, followed by its levels of detail, vertex and index data
+    Mesh,
+
+    // A PackedMaterial
+    Material,
+
+    // A KTX2 file with its mip chain, in a format that can be uploaded as it is
+    Texture,
+
+}; // enum class AssetType
+
+NOON_API
+String AssetTypeToString(AssetType type);
+
+// The layout of AssetType::Mesh, vertices are already encoded with the format, and indices are
+// 16-bit whenever they can be. Offsets are relative to the start of the PackedMesh, which is
+// followed by LODCount MeshLODs.
+struct PackedMesh
+{
+    ShaderMesh Shader;
+
+    AABB Bounds;
+
+    // One VertexEncoding per VertexAttribute
+    uint8_t EncodingList[VertexAttributeCount];
+
+    uint32_t VertexCount;
+
+    // Of every level of detail together
+    uint32_t IndexCount;
+
+    // 2 or 4, 0 when not indexed
+    uint32_t IndexSize;
+
+    // 0 when the indices are a single level
+    uint32_t LODCount;
+
+    uint64_t VertexOffset;
+
+    uint64_t IndexOffset;
+
+}; // struct PackedMesh
+
+static_assert(sizeof(PackedMesh) == 96);
+static_assert(sizeof(MeshLOD) == 12);
+
+// The layout of AssetType::Material, textures are the names of other assets in the same pack,
+// or empty
+struct PackedMaterial
+{
+    static constexpr size_t MaxNameLength = 127;
+
+    ShaderMaterial Parameters;
+
+    uint32_t DoubleSided;
+
+    uint32_t Reserved[3];
+
+    char BaseColorMap[MaxNameLength + 1];
+
+    char NormalMap[MaxNameLength + 1];
+
+    char MetallicRoughnessMap[MaxNameLength + 1];
+
+    char EmissiveMap[MaxNameLength + 1];
+
+    char OcclusionMap[MaxNameLength + 1];
+
+}; // struct PackedMaterial
+
+static_assert(sizeof(PackedMaterial) == 704);
+
+// A memory-mapped pack of cooked assets, as written by AssetPackWriter. Assets are found with
+// a binary search of a table of contents sorted by name hash, and returned as views into the
+// mapping, aligned so they can be copied into a staging buffer or passed to Vulkan as they are.
+class NOON_API AssetPack
+{
+public:
+
+    static constexpr uint32_t Magic = 0x4B41504E; // "NPAK"
+
+    static constexpr uint32_t FormatVersion = 1;
+
+    // Every asset starts on this boundary, which is enough for any Vulkan buffer offset or
+    // compressed texture block
+    static constexpr uint64_t DataAlignment = 256;
+
+    struct Header
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t EntryCount;
+        uint32_t Reserved;
+    };
+
+    // Entries are sorted by NameHash
+    struct Entry
+    {
+        uint64_t NameHash;
+        uint32_t NameOffset;
+        uint32_t NameLength;
+        AssetType Type;
+        uint32_t Reserved;
+        uint64_t DataOffset;
+        uint64_t DataSize;
+    };
+
+    static_assert(sizeof(Header) == 16);
+    static_assert(sizeof(Entry) == 40);
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(AssetPack)
+
+    AssetPack() = default;
+
+    // Validates the table of contents, and the headers of meshes, materials and textures, so
+    // nothing needs to be checked again when they are used
+    bool Open(const Path& path);
+
+    void Close();
+
+    inline bool IsOpen() const {
+        return _file.IsOpen();
+    }
+
+    inline const Path& GetPath() const {
+        return _file.GetPath();
+    }
+
+    size_t GetAssetCount() const;
+
+    // Returns an empty span if the pack has no such asset of that type
+    Span<const uint8_t> Find(StringView name, AssetType type) const;
+
+    // Finds an asset of any type, returns false if the pack has no such asset
+    bool Find(StringView name, Span<const uint8_t>& data, AssetType * type = nullptr) const;
+
+    Span<const uint32_t> FindShader(StringView name) const;
+
+    const PackedMesh * FindMesh(StringView name) const;
+
+    const PackedMaterial * FindMaterial(StringView name) const;
+
+    // Uploads the vertices and indices straight from the mapping, returns null if the pack has
+    // no such mesh
+    std::unique_ptr<Mesh> CreateMesh(StringView name) const;
+
+    // Uploads every level straight from the mapping, returns null if the pack has no such
+    // texture
+    std::unique_ptr<Texture> CreateTexture(StringView name, MemoryPool memoryPool = MemoryPool::Default) const;
+
+    // Checks what Open() checks for each asset, for assets read from elsewhere, such as loose
+    // files or a FileSystem
+    static bool ValidateAsset(AssetType type, Span<const uint8_t> data);
+
+    // Uploads an AssetType::Mesh that passed ValidateAsset()
+    static std::unique_ptr<Mesh> UploadMesh(Span<const uint8_t> data);
+
+private:
+
+    bool ValidateEntry(const Entry& entry) const;
+
+    const Entry * FindEntry(StringView name) const;
+
+    MappedFile _file;
+
+    const Entry * _entryList = nullptr;
+
+}; // class AssetPack
+
+} // namespace noon
+
+#endif // NOON_ASSET_PACK_HPP
@@ -0,0 +1,68 @@
+#ifndef NOON_ASSET_PACK_WRITER_HPP
+#define NOON_ASSET_PACK_WRITER_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/AssetPack.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/Path.hpp>
+#include <Noon/String.hpp>
+#include <Noon/VertexFormat.hpp>
+
+#include <cstdint>
+
+namespace noon {
+
+// Builds an AssetPack in memory, used by the cooker. Meshes and materials are converted to
+// their packed layouts here, so the runtime never has to.
+class NOON_API AssetPackWriter
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(AssetPackWriter)
+
+    AssetPackWriter() = default;
+
+    // Throws if an asset with the same name was already added
+    void Add(StringView name, AssetType type, List<uint8_t> data);
+
+    // Encodes the vertices with VertexFormat::Choose(), indices should already be optimized.
+    // With lodList, indexList holds every level of detail, see GenerateMeshLODs().
+    void AddMesh(StringView name, const VertexData& vertexData, Span<const uint32_t> indexList, Span<const MeshLOD> lodList = {});
+
+    void AddMaterial(StringView name, const PackedMaterial& material);
+
+    // Moves every asset of other into this one, so assets can be cooked into writers of their
+    // own in parallel. Throws if any has the same name as an asset already added.
+    void Append(AssetPackWriter&& other);
+
+    inline size_t GetAssetCount() const {
+        return _assetList.size();
+    }
+
+    // In the order they were added
+    List<String> GetNameList() const;
+
+    // Writes to a temporary file first, so a failed write never leaves a partial pack behind
+    bool Write(const Path& path) const;
+
+private:
+
+    struct Asset
+    {
+        String Name;
+
+        AssetType Type;
+
+        List<uint8_t> Data;
+
+    }; // struct Asset
+
+    List<Asset> _assetList;
+
+    Set<String> _nameSet;
+
+}; // class AssetPackWriter
+
+} // namespace noon
+
+#endif // NOON_ASSET_PACK_WRITER_HPP
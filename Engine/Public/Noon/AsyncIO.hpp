@@ -0,0 +1,205 @@
+#ifndef NOON_ASYNC_IO_HPP
+#define NOON_ASYNC_IO_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/JobSystem.hpp>
+#include <Noon/Path.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace noon {
+
+// A file opened for positional reads by AsyncIO, without a file position so it can be read
+// from any number of threads at once
+class NOON_API IOFile
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(IOFile)
+
+    IOFile() = default;
+
+    ~IOFile();
+
+    bool Open(const Path& path);
+
+    void Close();
+
+    inline bool IsOpen() const {
+#if defined(NOON_PLATFORM_WINDOWS)
+        return (_handle != nullptr);
+#else
+        return (_fd >= 0);
+#endif
+    }
+
+    inline const Path& GetPath() const {
+        return _path;
+    }
+
+    inline uint64_t GetSize() const {
+        return _size;
+    }
+
+private:
+
+    friend class AsyncIO;
+
+    Path _path;
+
+    uint64_t _size = 0;
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    void * _handle = nullptr;
+
+#else
+
+    int _fd = -1;
+
+#endif
+
+}; // class IOFile
+
+enum class IOPriority
+{
+    // Prefetching, and anything else that can wait
+    Low,
+
+    Normal,
+
+    // Data that is needed on screen, such as the next texture mip to stream in
+    High,
+
+}; // enum class IOPriority
+
+constexpr size_t IOPriorityCount = static_cast<size_t>(IOPriority::High) + 1;
+
+enum class IOStatus
+{
+    Pending,
+
+    Complete,
+
+    // The file was too short, or the read failed
+    Failed,
+
+    Cancelled,
+
+}; // enum class IOStatus
+
+using IORequestID = uint64_t;
+
+struct IORead
+{
+    const IOFile * File;
+
+    uint64_t Offset;
+
+    uint64_t Size;
+
+    // Any memory that stays valid until the read is done, including a mapped staging buffer,
+    // so data never has to be copied out of an intermediate buffer
+    void * Destination;
+
+    IOPriority Priority;
+
+    // Incremented when the read is submitted, and signalled once it is done, if set
+    JobCounter * Counter;
+
+    // Set before Counter is signalled, if set
+    std::atomic<IOStatus> * Status;
+
+}; // struct IORead
+
+// Reads ranges of files in the background. On Linux, reads are submitted to the kernel in
+// batches through io_uring, which keeps a fast drive's queue full from a single thread.
+// Elsewhere, or if io_uring isn't available, a pool of threads make blocking positional
+// reads. Waiting reads are started highest priority first, in the order they were submitted.
+class NOON_API AsyncIO
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(AsyncIO)
+
+    static AsyncIO * GetInstance() {
+        return _Instance;
+    }
+
+    // The most reads in flight at once
+    static constexpr uint32_t QueueDepth = 128;
+
+    // Threads that block on reads when io_uring isn't used
+    static constexpr size_t FallbackThreadCount = 8;
+
+    // Requires a JobSystem to signal counters, forceFallback disables io_uring
+    AsyncIO(bool forceFallback = false);
+
+    // Cancels every read that hasn't started, and waits for the rest
+    ~AsyncIO();
+
+    inline bool IsUsingIOUring() const {
+        return (_ring != nullptr);
+    }
+
+    IORequestID Read(const IORead& read);
+
+    // Submits every read with one lock, returns the ID of the first, and the rest follow it
+    IORequestID Read(Span<const IORead> readList);
+
+    // Returns false if the read has already started or finished, as those can't be stopped
+    bool Cancel(IORequestID id);
+
+private:
+
+    static AsyncIO * _Instance;
+
+    struct Request
+    {
+        IORequestID ID;
+
+        IORead Read;
+
+        // Bytes read so far, reads can finish short and be resumed
+        uint64_t Done;
+
+    }; // struct Request
+
+    struct Ring;
+
+    // Takes the oldest read of the highest priority, returns false if there are none, or once
+    // shutting down when waiting, lock must hold _mutex
+    bool PopRequest(std::unique_lock<std::mutex>& lock, Request& request, bool wait);
+
+    void Complete(const Request& request, IOStatus status);
+
+    void WorkerMain();
+
+    void RingMain();
+
+    std::mutex _mutex;
+
+    std::condition_variable _condition;
+
+    bool _running = true;
+
+    IORequestID _nextRequestID = 1;
+
+    // One queue per IOPriority
+    Array<Queue<Request>, IOPriorityCount> _queueList;
+
+    std::unique_ptr<Ring> _ring;
+
+    List<std::thread> _threadList;
+
+}; // class AsyncIO
+
+} // namespace noon
+
+#endif // NOON_ASYNC_IO_HPP
@@ -0,0 +1,97 @@
+#ifndef NOON_BC_ENCODER_HPP
+#define NOON_BC_ENCODER_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/String.hpp>
+
+#include <glad/vulkan.h>
+
+#include <cstdint>
+
+namespace noon {
+
+enum class BCQuality
+{
+    // One endpoint fit per block, and only BC7 mode 6, or mode 5 for blocks with alpha
+    Fast,
+
+    // Refined endpoints, and BC7 mode 1 on the most promising partitions of opaque blocks
+    Normal,
+
+    // Searches around the endpoints, and adds BC7 mode 3 and more partitions
+    High,
+
+}; // enum class BCQuality
+
+NOON_API
+String BCQualityToString(BCQuality quality);
+
+enum class BCEncoderBackend
+{
+    // One pixel at a time, used as the reference for the others
+    Scalar,
+
+    // 4 pixels per instruction
+    SSE,
+
+    // 8 pixels per instruction, with FMA
+    AVX2,
+
+    // 4 pixels per instruction
+    NEON,
+
+}; // enum class BCEncoderBackend
+
+NOON_API
+String BCEncoderBackendToString(BCEncoderBackend backend);
+
+NOON_API
+bool IsBCEncoderBackendSupported(BCEncoderBackend backend);
+
+// Defaults to the widest backend supported by the CPU
+NOON_API
+BCEncoderBackend GetBCEncoderBackend();
+
+// Throws if the backend is not supported, intended for comparing backends
+NOON_API
+void SetBCEncoderBackend(BCEncoderBackend backend);
+
+// BC1, BC3, BC4, BC5 and BC7, either UNORM or SRGB. BC4 and BC5 store R and RG, and BC1
+// with alpha keeps pixels with alpha below 128 as transparent black.
+NOON_API
+bool IsBCEncoderFormat(VkFormat format);
+
+// Compresses tightly packed RGBA8 pixels, blocks past the edge of the image repeat its last
+// row and column. Blocks are encoded in parallel with ParallelFor() if a JobSystem exists.
+// Throws if the format is not supported.
+NOON_API
+List<uint8_t> EncodeBC(
+    VkFormat format,
+    const uint8_t * pixels,
+    uint32_t width,
+    uint32_t height,
+    BCQuality quality = BCQuality::Normal);
+
+// Decompresses back to RGBA8, to measure what was lost. BC7 blocks in modes 0 and 2, which
+// EncodeBC() never produces, are decoded as transparent black.
+NOON_API
+List<uint8_t> DecodeBC(
+    VkFormat format,
+    const uint8_t * data,
+    uint32_t width,
+    uint32_t height);
+
+// Peak signal-to-noise ratio in dB between two RGBA8 images, over the channels set in
+// channelMask with R as bit 0. Infinite if they are the same.
+NOON_API
+double ComputePSNR(
+    const uint8_t * a,
+    const uint8_t * b,
+    uint32_t width,
+    uint32_t height,
+    uint32_t channelMask = 0xF);
+
+} // namespace noon
+
+#endif // NOON_BC_ENCODER_HPP
@@ -0,0 +1,94 @@
+#ifndef NOON_BOUNDS_HPP
+#define NOON_BOUNDS_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/Math.hpp>
+#include <Noon/String.hpp>
+
+namespace noon {
+
+struct NOON_API BoundingSphere
+{
+    Vec3 Center = Vec3(0.0f);
+
+    float Radius = 0.0f;
+
+    // A sphere around the bounding box of the points, which is not minimal, but cheap and
+    // usually close enough for culling
+    static BoundingSphere FromPoints(Span<const Vec3> pointList);
+
+    // Scales the radius by the largest axis, so non-uniform scales stay conservative
+    BoundingSphere Transform(const Mat4& model) const;
+
+    BoundingSphere Merge(const BoundingSphere& other) const;
+
+    String ToString() const;
+
+}; // struct BoundingSphere
+
+struct NOON_API AABB
+{
+    Vec3 Min = Vec3(0.0f);
+
+    Vec3 Max = Vec3(0.0f);
+
+    static AABB FromPoints(Span<const Vec3> pointList);
+
+    inline Vec3 GetCenter() const {
+        return (Min + Max) * 0.5f;
+    }
+
+    // Half of the size on each axis
+    inline Vec3 GetExtents() const {
+        return (Max - Min) * 0.5f;
+    }
+
+    inline BoundingSphere GetBoundingSphere() const {
+        return { GetCenter(), glm::length(GetExtents()) };
+    }
+
+    // The box around the transformed box, using Arvo's method
+    AABB Transform(const Mat4& model) const;
+
+    AABB Merge(const AABB& other) const;
+
+    String ToString() const;
+
+}; // struct AABB
+
+// Six planes pointing inwards, with normalized normals in xyz and the distance from the
+// origin in w, so a point p is inside a plane when dot(plane.xyz, p) + plane.w >= 0
+struct NOON_API Frustum
+{
+    enum Plane
+    {
+        Left,
+        Right,
+        Bottom,
+        Top,
+        Near,
+        Far,
+
+    }; // enum Plane
+
+    static const size_t PlaneCount = 6;
+
+    Array<Vec4, PlaneCount> Planes;
+
+    // Gribb & Hartmann's method, the planes are the sums and differences of the rows of the
+    // matrix. The near plane is w + z, which is exact for a depth range of [-1, 1] and slightly
+    // conservative for [0, 1], so the same planes work with either projection.
+    static Frustum FromMatrix(const Mat4& viewProjection);
+
+    // Conservative, objects near the corners of the frustum may be reported as intersecting
+
+    bool Intersects(const BoundingSphere& sphere) const;
+
+    bool Intersects(const AABB& aabb) const;
+
+}; // struct Frustum
+
+} // namespace noon
+
+#endif // NOON_BOUNDS_HPP
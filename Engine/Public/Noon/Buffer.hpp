@@ -14,7 +14,10 @@ public:
 
     NOON_DISALLOW_COPY_AND_ASSIGN(Buffer)
 
-    Buffer(VkDeviceSize size, uint8_t * data, VkBufferUsageFlags bufferUsageFlags, VmaMemoryUsage memoryUsage);
+    // The memory pool must suit the memory usage, for example MemoryPool::Transient for
+    // VMA_MEMORY_USAGE_CPU_TO_GPU. Transient and Staging buffers must be destroyed in the order
+    // they were created, or the ring will fill up.
+    Buffer(VkDeviceSize size, uint8_t * data, VkBufferUsageFlags bufferUsageFlags, VmaMemoryUsage memoryUsage, MemoryPool memoryPool = MemoryPool::Default);
 
     ~Buffer();
 
@@ -22,6 +25,16 @@ public:
         return _size;
     }
 
+    // May change when the buffer is moved by the Defragmenter, so it should not be cached
+    // across frames
+    inline VkBuffer GetBuffer() const {
+        return _vkBuffer;
+    }
+
+    inline VmaAllocation GetAllocation() const {
+        return _vmaAllocation;
+    }
+
     inline VkBufferUsageFlags GetBufferUsageFlags() const {
         return _vkBufferUsageFlags;
     }
@@ -30,22 +43,50 @@ public:
         return _vmaMemoryUsage;
     }
 
+    inline MemoryPool GetMemoryPool() const {
+        return _memoryPool;
+    }
+
+    inline MemoryCategory GetMemoryCategory() const {
+        return _memoryCategory;
+    }
+
     inline bool IsMapped() const {
         return (_mappedBufferMemory != nullptr);
     }
 
+    // Null unless mapped, such as a staging buffer that AsyncIO can read straight into
+    inline uint8_t * GetMappedData() const {
+        return _mappedBufferMemory;
+    }
+
+    // Only device-local buffers are moved, as mapped pointers would be invalidated, and VMA
+    // can't defragment linear or buddy pools
+    inline bool IsMovable() const {
+        return (
+            _vmaMemoryUsage == VMA_MEMORY_USAGE_GPU_ONLY &&
+            (_memoryPool == MemoryPool::Default || _memoryPool == MemoryPool::Streaming)
+        );
+    }
+
     void ReadFrom(VkDeviceSize offset, VkDeviceSize length, uint8_t * data);
 
     void WriteTo(VkDeviceSize offset, VkDeviceSize length, const uint8_t * data);
 
 private:
 
+    friend class Defragmenter;
+
     VkDeviceSize _size;
 
     VkBufferUsageFlags _vkBufferUsageFlags;
 
     VmaMemoryUsage _vmaMemoryUsage;
 
+    MemoryPool _memoryPool;
+
+    MemoryCategory _memoryCategory;
+
     uint8_t * _mappedBufferMemory = nullptr;
 
     VkBuffer _vkBuffer = VK_NULL_HANDLE;
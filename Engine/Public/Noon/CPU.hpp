@@ -0,0 +1,22 @@
+#ifndef NOON_CPU_HPP
+#define NOON_CPU_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Platform.hpp>
+
+// MSVC allows any intrinsic without changing the target, GCC and Clang need it per function
+#if defined(NOON_COMPILER_GCC) || defined(NOON_COMPILER_CLANG)
+    #define NOON_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+    #define NOON_TARGET_AVX2
+#endif
+
+namespace noon {
+
+// AVX2 and FMA, and the OS saves the YMM registers, always false off x86-64
+NOON_API
+bool HasAVX2();
+
+} // namespace noon
+
+#endif // NOON_CPU_HPP
@@ -0,0 +1,82 @@
+#ifndef NOON_COMPONENT_HPP
+#define NOON_COMPONENT_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/String.hpp>
+
+#include <bitset>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+namespace noon {
+
+constexpr size_t MaxComponentTypeCount = 128;
+
+using ComponentTypeID = uint32_t;
+
+using ComponentMask = std::bitset<MaxComponentTypeCount>;
+
+struct ComponentTypeInfo
+{
+    // Used to find the same type registered from another module
+    String Name;
+
+    size_t Size;
+
+    size_t Alignment;
+
+    // Move-construct dst from src, then destroy src
+    void (*Relocate)(void * dst, void * src);
+
+    void (*Destroy)(void * data);
+
+}; // struct ComponentTypeInfo
+
+// Returns the existing ID if a type with the same name was already registered, throws once
+// MaxComponentTypeCount types are registered
+NOON_API
+ComponentTypeID RegisterComponentType(const ComponentTypeInfo& info);
+
+NOON_API
+const ComponentTypeInfo& GetComponentTypeInfo(ComponentTypeID id);
+
+template <class T>
+inline ComponentTypeID GetComponentTypeID()
+{
+    static const ComponentTypeID id = RegisterComponentType(ComponentTypeInfo{
+        .Name = typeid(T).name(),
+        .Size = sizeof(T),
+        .Alignment = alignof(T),
+        .Relocate = [](void * dst, void * src) {
+            new (dst) T(std::move(*static_cast<T *>(src)));
+            static_cast<T *>(src)->~T();
+        },
+        .Destroy = [](void * data) {
+            static_cast<T *>(data)->~T();
+        },
+    });
+
+    return id;
+}
+
+template <class... Ts>
+inline ComponentMask MakeComponentMask()
+{
+    ComponentMask mask;
+    (mask.set(GetComponentTypeID<Ts>()), ...);
+    return mask;
+}
+
+// True if no type appears twice in Ts, as an entity has at most one component of each type
+template <class... Ts>
+constexpr bool AreComponentTypesUnique = true;
+
+template <class T, class... Ts>
+constexpr bool AreComponentTypesUnique<T, Ts...> = ((!std::is_same_v<T, Ts> && ...) && AreComponentTypesUnique<Ts...>);
+
+} // namespace noon
+
+#endif // NOON_COMPONENT_HPP
@@ -5,7 +5,9 @@
 
 #include <array>
 #include <deque>
+#include <memory_resource>
 #include <set>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -26,6 +28,9 @@ using Map = std::pmr::unordered_map<K, V>;
 template <class T>
 using List = std::pmr::vector<T>;
 
+template <class T>
+using Span = std::span<T>;
+
 } // namespace noon
 
 #endif // NOON_CONTAINERS_HPP
\ No newline at end of file
@@ -0,0 +1,142 @@
+#ifndef NOON_CULLING_HPP
+#define NOON_CULLING_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Bounds.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/String.hpp>
+
+#include <cstdint>
+
+namespace noon {
+
+enum class CullingBackend
+{
+    // One object at a time with glm, used as the reference for the others
+    Scalar,
+
+    // 4 objects per instruction
+    SSE,
+
+    // 8 objects per instruction, with FMA
+    AVX2,
+
+    // 4 objects per instruction
+    NEON,
+
+}; // enum class CullingBackend
+
+NOON_API
+String CullingBackendToString(CullingBackend backend);
+
+NOON_API
+bool IsCullingBackendSupported(CullingBackend backend);
+
+// Defaults to the widest backend supported by the CPU
+NOON_API
+CullingBackend GetCullingBackend();
+
+// Throws if the backend is not supported, intended for comparing backends
+NOON_API
+void SetCullingBackend(CullingBackend backend);
+
+// Bounding spheres as structure-of-arrays, so the kernels can load the same component of
+// several objects with one instruction
+struct NOON_API BoundingSphereList
+{
+    List<float> CenterX;
+
+    List<float> CenterY;
+
+    List<float> CenterZ;
+
+    List<float> Radius;
+
+    inline size_t GetCount() const {
+        return Radius.size();
+    }
+
+    void Resize(size_t count);
+
+    void Clear();
+
+    // Returns the index of the sphere
+    uint32_t Add(const BoundingSphere& sphere);
+
+    void Set(size_t index, const BoundingSphere& sphere);
+
+    BoundingSphere Get(size_t index) const;
+
+}; // struct BoundingSphereList
+
+// Axis-aligned bounding boxes as structure-of-arrays, stored as center and extents, which is
+// what the plane tests need
+struct NOON_API AABBList
+{
+    List<float> CenterX;
+
+    List<float> CenterY;
+
+    List<float> CenterZ;
+
+    List<float> ExtentX;
+
+    List<float> ExtentY;
+
+    List<float> ExtentZ;
+
+    inline size_t GetCount() const {
+        return CenterX.size();
+    }
+
+    void Resize(size_t count);
+
+    void Clear();
+
+    // Returns the index of the box
+    uint32_t Add(const AABB& aabb);
+
+    void Set(size_t index, const AABB& aabb);
+
+    AABB Get(size_t index) const;
+
+}; // struct AABBList
+
+// Test the objects in [first, first + count) against the frustum, and write the indices of
+// those that intersect it to visibleIndexList, in order. visibleIndexList must have room for
+// count indices. Returns the number of visible objects.
+
+NOON_API
+size_t CullSpheres(
+    const Frustum& frustum,
+    const BoundingSphereList& sphereList,
+    size_t first,
+    size_t count,
+    uint32_t * visibleIndexList);
+
+NOON_API
+size_t CullAABBs(
+    const Frustum& frustum,
+    const AABBList& aabbList,
+    size_t first,
+    size_t count,
+    uint32_t * visibleIndexList);
+
+// Test every object, split across the threads of the JobSystem. visibleIndexList is replaced with the
+// indices of the visible objects, in order.
+
+NOON_API
+void ParallelCullSpheres(
+    const Frustum& frustum,
+    const BoundingSphereList& sphereList,
+    List<uint32_t>& visibleIndexList);
+
+NOON_API
+void ParallelCullAABBs(
+    const Frustum& frustum,
+    const AABBList& aabbList,
+    List<uint32_t>& visibleIndexList);
+
+} // namespace noon
+
+#endif // NOON_CULLING_HPP
@@ -0,0 +1,253 @@
+#ifndef NOON_DEFRAGMENTER_HPP
+#define NOON_DEFRAGMENTER_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/MemoryBudget.hpp>
+
+#include <glad/vulkan.h>
+
+NOON_DISABLE_WARNINGS()
+
+    #include <vk_mem_alloc.h>
+
+NOON_ENABLE_WARNINGS()
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+namespace noon {
+
+class Buffer;
+class GraphicsDriver;
+
+struct DefragmentationStats
+{
+    VkDeviceSize BytesMoved;
+
+    // Bytes returned to the driver by freeing empty VkDeviceMemory blocks
+    VkDeviceSize BytesFreed;
+
+    uint32_t AllocationsMoved;
+
+    uint32_t BlocksFreed;
+
+}; // struct DefragmentationStats
+
+// Called after a buffer has been moved, with the VkBuffer it had before. Anything that
+// refers to the old VkBuffer, such as descriptor sets, must be updated before the next frame.
+using BufferRelocationCallback = std::function<void(Buffer * buffer, VkBuffer oldBuffer)>;
+
+// Incrementally compacts the memory of device-local Buffers, a few moves per frame.
+//
+// Moves are copied on the transfer queue, and the Buffer's VkBuffer is replaced once the copy
+// has finished. The old memory is released once every frame that could still be using it has
+// completed, so nothing waits on the GPU except when the driver is shutting down.
+//
+// Update() runs on the render thread while Buffers are created and destroyed on any other,
+// so every method is serialized by a mutex.
+class NOON_API Defragmenter
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(Defragmenter)
+
+    Defragmenter(GraphicsDriver * gfx);
+
+    ~Defragmenter();
+
+    inline bool IsEnabled() const {
+        return _enabled;
+    }
+
+    inline void SetEnabled(bool enabled) {
+        _enabled = enabled;
+    }
+
+    inline bool IsActive() const {
+        std::lock_guard lock(_mutex);
+        return (_state != State::Idle);
+    }
+
+    inline std::chrono::microseconds GetFrameBudget() const {
+        return _frameBudget;
+    }
+
+    // The most time Update() will spend recording moves in a single frame
+    inline void SetFrameBudget(std::chrono::microseconds budget) {
+        _frameBudget = budget;
+    }
+
+    inline uint32_t GetMaxMovesPerFrame() const {
+        return _maxMovesPerFrame;
+    }
+
+    inline void SetMaxMovesPerFrame(uint32_t maxMoves) {
+        _maxMovesPerFrame = maxMoves;
+    }
+
+    inline VkDeviceSize GetMaxBytesPerCycle() const {
+        return _maxBytesPerCycle;
+    }
+
+    // Limits how much a single cycle will plan to move, which bounds how long it takes
+    inline void SetMaxBytesPerCycle(VkDeviceSize maxBytes) {
+        _maxBytesPerCycle = maxBytes;
+    }
+
+    inline float GetFragmentationThreshold() const {
+        return _fragmentationThreshold;
+    }
+
+    // A cycle starts when the unused fraction of a device-local heap's blocks exceeds this
+    inline void SetFragmentationThreshold(float threshold) {
+        _fragmentationThreshold = threshold;
+    }
+
+    inline DefragmentationStats GetLastStats() const {
+        std::lock_guard lock(_mutex);
+        return _lastStats;
+    }
+
+    inline DefragmentationStats GetTotalStats() const {
+        std::lock_guard lock(_mutex);
+        return _totalStats;
+    }
+
+    unsigned AddBufferRelocationCallback(BufferRelocationCallback callback);
+
+    void RemoveBufferRelocationCallback(unsigned id);
+
+    // Start a cycle on the next Update(), regardless of fragmentation
+    inline void Request() {
+        _requested = true;
+    }
+
+    // Advance the current cycle, should be called once per frame after waiting for the
+    // frame's fence
+    void Update();
+
+    // Complete the current cycle, waiting on the GPU as needed
+    void Flush();
+
+    void RegisterBuffer(Buffer * buffer);
+
+    // If the buffer's allocation is part of the current cycle it cannot be freed yet, so the
+    // defragmenter takes ownership of it and returns false. This holds even while the buffer is
+    // being copied, as the check and the hand-off happen under the same lock as Update().
+    bool UnregisterBuffer(Buffer * buffer);
+
+private:
+
+    enum class State
+    {
+        Idle,
+
+        // Waiting to begin the next pass
+        Active,
+
+        // Waiting for the copies of the current pass to finish
+        Copying,
+
+        // Waiting for in-flight frames to stop using the old buffers
+        Retiring,
+
+    }; // enum class State
+
+    struct Move
+    {
+        // nullptr if the buffer was destroyed during the cycle
+        Buffer * Owner;
+
+        VkBuffer OldBuffer;
+
+        VkBuffer NewBuffer;
+
+    }; // struct Move
+
+    struct Orphan
+    {
+        MemoryCategory Category;
+
+        VkBuffer Buffer;
+
+        VmaAllocation Allocation;
+
+    }; // struct Orphan
+
+    bool ShouldBegin();
+
+    bool BeginCycle();
+
+    void EndCycle();
+
+    void BeginPass(uint32_t maxMoves);
+
+    // Returns true if the cycle has ended
+    bool EndPass();
+
+    void SwapBuffers();
+
+    GraphicsDriver * _gfx;
+
+    // Recursive, as relocation callbacks run inside Update() and may create or destroy Buffers
+    mutable std::recursive_mutex _mutex;
+
+    std::atomic<bool> _enabled = true;
+
+    std::atomic<bool> _requested = false;
+
+    State _state = State::Idle;
+
+    std::chrono::microseconds _frameBudget = std::chrono::microseconds(500);
+
+    uint32_t _maxMovesPerFrame = 64;
+
+    VkDeviceSize _maxBytesPerCycle = 64 * 1024 * 1024;
+
+    float _fragmentationThreshold = 0.25f;
+
+    // Frames to wait after a cycle before checking fragmentation again
+    uint64_t _cooldownFrameCount = 300;
+
+    uint64_t _frameIndex = 0;
+
+    uint64_t _stateFrameIndex = 0;
+
+    // Running average of the CPU cost of recording one move, used to fit moves into the budget
+    double _microsecondsPerMove = 20.0;
+
+    Map<VmaAllocation, Buffer *> _bufferMap;
+
+    Set<VmaAllocation> _cycleAllocationSet;
+
+    List<Move> _moveList;
+
+    List<Orphan> _orphanList;
+
+    unsigned _nextBufferRelocationCallbackId = 0;
+
+    List<std::pair<unsigned, BufferRelocationCallback>> _bufferRelocationCallbackList;
+
+    VmaDefragmentationContext _vmaDefragmentationContext = VK_NULL_HANDLE;
+
+    VmaDefragmentationStats _vmaDefragmentationStats;
+
+    DefragmentationStats _lastStats = { };
+
+    DefragmentationStats _totalStats = { };
+
+    VkCommandPool _vkCommandPool = VK_NULL_HANDLE;
+
+    VkCommandBuffer _vkCommandBuffer = VK_NULL_HANDLE;
+
+    VkFence _vkFence = VK_NULL_HANDLE;
+
+}; // class Defragmenter
+
+} // namespace noon
+
+#endif // NOON_DEFRAGMENTER_HPP
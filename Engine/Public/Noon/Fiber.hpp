@@ -0,0 +1,66 @@
+#ifndef NOON_FIBER_HPP
+#define NOON_FIBER_HPP
+
+#include <Noon/Config.hpp>
+
+#include <cstddef>
+
+namespace noon {
+
+// A user-mode execution context with its own stack. Switching between fibers only saves and
+// restores the callee-saved registers, so it costs about as much as a function call.
+class NOON_API Fiber
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(Fiber)
+
+    // Never returns, it has to switch to another fiber once it is done
+    using Function = void (*)(void * data);
+
+    static constexpr size_t DefaultStackSize = 256 * 1024;
+
+    // Wraps the calling thread, so that other fibers can switch back to it. Must be destroyed
+    // on the same thread.
+    Fiber();
+
+    // A guard page sits below the stack, which grows down into it, so an overflow crashes
+    // rather than corrupts
+    Fiber(Function function, void * data, size_t stackSize = DefaultStackSize);
+
+    ~Fiber();
+
+    // Save the current context into this fiber, which must be the one running, and resume
+    // target. Returns once another fiber switches back to this one, which can happen on a
+    // different thread.
+    void SwitchTo(Fiber& target);
+
+private:
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    static void __stdcall Entry(void * data);
+
+    void * _handle = nullptr;
+
+    bool _isThread = false;
+
+    Function _function = nullptr;
+
+    void * _data = nullptr;
+
+#else
+
+    void * _stackPointer = nullptr;
+
+    void * _stack = nullptr;
+
+    size_t _stackSize = 0;
+
+#endif
+
+}; // class Fiber
+
+} // namespace noon
+
+#endif // NOON_FIBER_HPP
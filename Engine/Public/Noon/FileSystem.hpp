@@ -0,0 +1,218 @@
+#ifndef NOON_FILE_SYSTEM_HPP
+#define NOON_FILE_SYSTEM_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/AssetPack.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/JobSystem.hpp>
+#include <Noon/Path.hpp>
+#include <Noon/String.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+
+namespace noon {
+
+// The contents of a file, either a view into a mapping or a buffer of its own. Copies share the
+// data, which stays valid even after the file system it came from is unmounted.
+class NOON_API FileData
+{
+public:
+
+    FileData() = default;
+
+    static FileData FromBuffer(List<uint8_t> buffer);
+
+    // owner keeps the memory data points into alive
+    static FileData FromView(Span<const uint8_t> data, std::shared_ptr<const void> owner, bool isMapped);
+
+    inline bool IsValid() const {
+        return (_owner != nullptr);
+    }
+
+    // Mapped data is paged in on first access, rather than read up front
+    inline bool IsMapped() const {
+        return _isMapped;
+    }
+
+    inline Span<const uint8_t> GetData() const {
+        return _data;
+    }
+
+    inline size_t GetSize() const {
+        return _data.size();
+    }
+
+private:
+
+    Span<const uint8_t> _data;
+
+    std::shared_ptr<const void> _owner;
+
+    bool _isMapped = false;
+
+}; // class FileData
+
+enum class FileReadMode
+{
+    // Map whatever can be mapped, and read the rest into a buffer
+    PreferMapped,
+
+    // Always read into a buffer, for data that will be read in full right away
+    Buffer,
+
+}; // enum class FileReadMode
+
+// Somewhere files can be mounted from. Paths are relative to the mount point, and have already
+// been normalized. Must be safe to call from any thread.
+class NOON_API FileSource
+{
+public:
+
+    virtual ~FileSource() = default;
+
+    virtual bool Exists(StringView path) const = 0;
+
+    // Returns an invalid FileData if there is no such file
+    virtual FileData Read(StringView path, FileReadMode mode) const = 0;
+
+}; // class FileSource
+
+// Files in a directory on disk
+class NOON_API DirectoryFileSource : public FileSource
+{
+public:
+
+    DirectoryFileSource(const Path& directory);
+
+    bool Exists(StringView path) const override;
+
+    FileData Read(StringView path, FileReadMode mode) const override;
+
+private:
+
+    Path _directory;
+
+}; // class DirectoryFileSource
+
+// The assets of an AssetPack, of any type, by name
+class NOON_API PackFileSource : public FileSource
+{
+public:
+
+    // Throws if the pack can't be opened
+    PackFileSource(const Path& path);
+
+    bool Exists(StringView path) const override;
+
+    FileData Read(StringView path, FileReadMode mode) const override;
+
+private:
+
+    std::shared_ptr<AssetPack> _pack;
+
+}; // class PackFileSource
+
+// Files held in memory, e.g. generated at runtime or downloaded
+class NOON_API MemoryFileSource : public FileSource
+{
+public:
+
+    // Replaces any file with the same path, must not be called once mounted
+    void Add(StringView path, List<uint8_t> data);
+
+    bool Exists(StringView path) const override;
+
+    FileData Read(StringView path, FileReadMode mode) const override;
+
+private:
+
+    Map<String, std::shared_ptr<const List<uint8_t>>> _fileMap;
+
+}; // class MemoryFileSource
+
+using MountID = uint32_t;
+
+// A single tree of read-only files, assembled from sources mounted at points within it. Where
+// sources overlap, the one mounted with the highest priority wins, and the most recent one
+// among equals, so patches and mods can be mounted over the base game. Lookups are cached by
+// path hash until the mounts change.
+class NOON_API FileSystem
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(FileSystem)
+
+    static FileSystem * GetInstance() {
+        return _Instance;
+    }
+
+    FileSystem();
+
+    ~FileSystem();
+
+    // Mounts the source so that mountPoint/path maps to path in the source
+    MountID Mount(std::unique_ptr<FileSource> source, StringView mountPoint = {}, int priority = 0);
+
+    MountID MountDirectory(const Path& directory, StringView mountPoint = {}, int priority = 0);
+
+    MountID MountPack(const Path& path, StringView mountPoint = {}, int priority = 0);
+
+    void Unmount(MountID id);
+
+    bool Exists(StringView path) const;
+
+    // Returns an invalid FileData if no mounted source has the file
+    FileData Read(StringView path, FileReadMode mode = FileReadMode::PreferMapped) const;
+
+    // Reads on a job, result is set before counter is signalled
+    void ReadAsync(StringView path, FileData& result, JobCounter& counter, FileReadMode mode = FileReadMode::PreferMapped) const;
+
+    // Forget cached lookups, e.g. after files were added to a mounted directory
+    void InvalidateCache();
+
+    // Forward slashes, no leading slash or "." elements, returns an empty string for paths
+    // that would escape the root with ".."
+    static String NormalizePath(StringView path);
+
+private:
+
+    static FileSystem * _Instance;
+
+    struct MountEntry
+    {
+        MountID ID;
+
+        // Normalized, with a trailing slash unless it is the root
+        String MountPoint;
+
+        int Priority;
+
+        std::shared_ptr<FileSource> Source;
+
+    }; // struct MountEntry
+
+    static constexpr size_t NotFound = SIZE_MAX;
+
+    // Returns the index into _mountList of the source that has the normalized path, or
+    // NotFound, _mutex must be held
+    size_t Find(StringView path) const;
+
+    mutable std::shared_mutex _mutex;
+
+    // Highest priority first, most recent first among equals
+    List<MountEntry> _mountList;
+
+    MountID _nextMountID = 1;
+
+    mutable std::shared_mutex _cacheMutex;
+
+    // Path hash to index into _mountList, including paths that weren't found
+    mutable Map<uint64_t, size_t> _lookupCache;
+
+}; // class FileSystem
+
+} // namespace noon
+
+#endif // NOON_FILE_SYSTEM_HPP
@@ -0,0 +1,240 @@
+#ifndef NOON_GLTF_MODEL_HPP
+#define NOON_GLTF_MODEL_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Bounds.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/Json.hpp>
+#include <Noon/MappedFile.hpp>
+#include <Noon/Math.hpp>
+#include <Noon/Mesh.hpp>
+#include <Noon/ShaderMaterial.hpp>
+#include <Noon/String.hpp>
+#include <Noon/VertexFormat.hpp>
+
+#include <cstdint>
+#include <memory>
+
+namespace noon {
+
+// Indices into the lists of a GLTFModel are -1 when absent
+struct GLTFTextureSlot
+{
+    int Image = -1;
+
+    // Which of TEXCOORD_0 and TEXCOORD_1 to sample with
+    int TexCoord = 0;
+
+}; // struct GLTFTextureSlot
+
+struct GLTFMaterial
+{
+    String Name;
+
+    ShaderMaterial Parameters;
+
+    GLTFTextureSlot BaseColorMap;
+
+    GLTFTextureSlot NormalMap;
+
+    GLTFTextureSlot MetallicRoughnessMap;
+
+    GLTFTextureSlot EmissiveMap;
+
+    GLTFTextureSlot OcclusionMap;
+
+    bool DoubleSided = false;
+
+}; // struct GLTFMaterial
+
+// Still encoded, e.g. as PNG or KTX2
+struct GLTFImage
+{
+    String Name;
+
+    String MimeType;
+
+    // Points into the mapped file, or into the model when the image was a data URI
+    Span<const uint8_t> Data;
+
+}; // struct GLTFImage
+
+// One draw, as an indexed triangle list
+struct GLTFPrimitive
+{
+    VertexData Vertices;
+
+    List<uint32_t> Indices;
+
+    AABB Bounds;
+
+    int Material = -1;
+
+}; // struct GLTFPrimitive
+
+struct GLTFMesh
+{
+    String Name;
+
+    List<GLTFPrimitive> Primitives;
+
+}; // struct GLTFMesh
+
+struct GLTFNode
+{
+    String Name;
+
+    // Parents always come before their children
+    int Parent = -1;
+
+    int Mesh = -1;
+
+    Vec3 Translation = Vec3(0.0f);
+
+    Quat Rotation = Quat(1.0f, 0.0f, 0.0f, 0.0f);
+
+    Vec3 Scale = Vec3(1.0f);
+
+}; // struct GLTFNode
+
+// A glTF 2.0 model loaded from .gltf or .glb. The files are memory-mapped, and vertex and index
+// data is decoded straight from the mapping, one job per primitive. Images are left encoded,
+// and reference the mapping rather than being copied.
+class NOON_API GLTFModel
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(GLTFModel)
+
+    GLTFModel() = default;
+
+    // Logs and returns false if the file can't be read, or isn't a supported glTF 2.0 file.
+    // Optimizing takes far longer than decoding for large meshes, and can be left to a tool
+    // for data that has already been through it.
+    bool Load(const Path& path, bool optimizeMeshes = true);
+
+    void Close();
+
+    inline const Path& GetPath() const {
+        return _path;
+    }
+
+    // The files referenced by URI, such as buffers and images, which the model depends on
+    // along with its own file
+    List<Path> GetExternalPathList() const;
+
+    inline const List<GLTFMaterial>& GetMaterialList() const {
+        return _materialList;
+    }
+
+    inline const List<GLTFImage>& GetImageList() const {
+        return _imageList;
+    }
+
+    inline const List<GLTFMesh>& GetMeshList() const {
+        return _meshList;
+    }
+
+    inline const List<GLTFNode>& GetNodeList() const {
+        return _nodeList;
+    }
+
+    // Upload every primitive of a mesh, in the same order, must be called from the thread
+    // that owns the graphics queue
+    List<std::unique_ptr<Mesh>> CreateMeshes(size_t meshIndex) const;
+
+private:
+
+    struct BufferView
+    {
+        const uint8_t * Data;
+
+        size_t Size;
+
+        size_t Stride;
+
+    }; // struct BufferView
+
+    struct Accessor
+    {
+        int BufferView;
+
+        size_t Offset;
+
+        size_t Count;
+
+        uint32_t ComponentType;
+
+        uint32_t ComponentCount;
+
+        bool Normalized;
+
+    }; // struct Accessor
+
+    struct EmbeddedData
+    {
+        // Points into the JSON text
+        StringView Base64;
+
+        List<uint8_t> Data;
+
+    }; // struct EmbeddedData
+
+    void LoadBuffers(const JsonValue& root, Span<const uint8_t> binaryChunk);
+
+    void LoadAccessors(const JsonValue& root);
+
+    void LoadMaterials(const JsonValue& root);
+
+    void LoadImages(const JsonValue& root);
+
+    void LoadMeshes(const JsonValue& root, bool optimizeMeshes);
+
+    void LoadNodes(const JsonValue& root);
+
+    // Resolve a relative or data URI, keeping whatever it was loaded into alive. Data URIs are
+    // only allocated here, and decoded later.
+    Span<const uint8_t> LoadURI(StringView uri);
+
+    void DecodePrimitive(const JsonValue& json, GLTFPrimitive& primitive, bool optimizeMeshes) const;
+
+    // Convert to float, applying normalization, into outComponents wide elements. Components
+    // the accessor doesn't have are left untouched.
+    void ReadFloats(int accessor, float * out, size_t outComponents) const;
+
+    void ReadUints(int accessor, uint32_t * out, size_t outComponents) const;
+
+    const Accessor& GetAccessor(int accessor) const;
+
+    Path _path;
+
+    MappedFile _file;
+
+    JsonDocument _json;
+
+    // Files referenced by URI
+    List<std::unique_ptr<MappedFile>> _externalFileList;
+
+    // Data URIs, spans keep pointing to the data when the list grows as it is moved rather than
+    // copied
+    List<EmbeddedData> _embeddedDataList;
+
+    List<Span<const uint8_t>> _bufferList;
+
+    List<BufferView> _bufferViewList;
+
+    List<Accessor> _accessorList;
+
+    List<GLTFMaterial> _materialList;
+
+    List<GLTFImage> _imageList;
+
+    List<GLTFMesh> _meshList;
+
+    List<GLTFNode> _nodeList;
+
+}; // class GLTFModel
+
+} // namespace noon
+
+#endif // NOON_GLTF_MODEL_HPP
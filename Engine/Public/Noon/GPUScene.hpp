@@ -0,0 +1,235 @@
+#ifndef NOON_GPU_SCENE_HPP
+#define NOON_GPU_SCENE_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/GraphicsDriver.hpp>
+#include <Noon/Math.hpp>
+#include <Noon/MeshLOD.hpp>
+#include <Noon/ShaderScene.hpp>
+#include <Noon/VertexFormat.hpp>
+
+#include <glad/vulkan.h>
+
+#include <cstdint>
+
+namespace noon {
+
+// Objects whose bounds, transforms and meshes live in storage buffers, and are culled and
+// drawn entirely by the GPU. Every frame a compute pass tests each object against the view
+// frustum and writes the visible ones as indirect draws, which the render pass consumes with
+// a single vkCmdDrawIndexedIndirectCount. The CPU only records a fixed number of commands,
+// and uploads the objects that changed since the frame's buffers were last used.
+//
+// All meshes share one vertex format and one set of vertex and index buffers, so the whole
+// scene is drawn with one pipeline and no rebinding. Meshes with levels of detail have them
+// selected per object by the culling pass, by the same rule as SelectLOD().
+class NOON_API GPUScene
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(GPUScene)
+
+    // Capacities are fixed, meshes and vertices can't be removed once added. The object count
+    // must not exceed maxDrawIndirectCount, which is at least 65535 with multiDrawIndirect.
+    GPUScene(
+        const VertexFormat& vertexFormat,
+        uint32_t maxObjectCount = 32 * 1024,
+        uint32_t maxMeshCount = 1024,
+        uint32_t maxVertexCount = 1024 * 1024,
+        uint32_t maxIndexCount = 4 * 1024 * 1024);
+
+    virtual ~GPUScene();
+
+    inline const VertexFormat& GetVertexFormat() const {
+        return _vertexFormat;
+    }
+
+    // Returns the index of the mesh, attributes not in the scene's vertex format are dropped.
+    // With lodList, indexList holds every level of detail, see GenerateMeshLODs().
+    uint32_t AddMesh(const VertexData& vertexData, Span<const uint32_t> indexList, Span<const MeshLOD> lodList = {});
+
+    inline uint32_t GetMeshCount() const {
+        return static_cast<uint32_t>(_meshList.size());
+    }
+
+    // Returns the index of the object, which may reuse the index of a removed one
+    uint32_t AddObject(uint32_t meshIndex, const Mat4& model);
+
+    void SetObjectTransform(uint32_t objectIndex, const Mat4& model);
+
+    void RemoveObject(uint32_t objectIndex);
+
+    // Not including removed objects
+    inline uint32_t GetObjectCount() const {
+        return static_cast<uint32_t>(_objectList.size() - _freeObjectList.size());
+    }
+
+    // When disabled every object is drawn, for comparing against the culled result
+    inline void SetFrustumCullingEnabled(bool enabled) {
+        _frustumCullingEnabled = enabled;
+    }
+
+    inline bool IsFrustumCullingEnabled() const {
+        return _frustumCullingEnabled;
+    }
+
+    // When disabled every object is drawn at full detail
+    inline void SetLODEnabled(bool enabled) {
+        _lodEnabled = enabled;
+    }
+
+    inline bool IsLODEnabled() const {
+        return _lodEnabled;
+    }
+
+    // The camera position and scale are taken from the driver each frame, only the threshold
+    // and hysteresis are used
+    inline void SetLODSettings(const LODSettings& lodSettings) {
+        _lodSettings = lodSettings;
+    }
+
+    inline const LODSettings& GetLODSettings() const {
+        return _lodSettings;
+    }
+
+    // Objects drawn by the last frame whose results have been read back, a few frames behind
+    inline uint32_t GetVisibleObjectCount() const {
+        return _visibleObjectCount;
+    }
+
+    // Triangles drawn by the same frame as GetVisibleObjectCount()
+    inline uint32_t GetVisibleTriangleCount() const {
+        return _visibleTriangleCount;
+    }
+
+    // Called by the GraphicsDriver, before the render pass
+    void RecordCulling(VkCommandBuffer commandBuffer);
+
+    // Called by the GraphicsDriver, inside the render pass with the driver's descriptor set bound
+    void RecordDraw(VkCommandBuffer commandBuffer);
+
+private:
+
+    // One per backbuffer, as the CPU writes the objects of one frame while others are in flight
+    struct Frame
+    {
+        GraphicsDriver::MappedBuffer ObjectBuffer;
+
+        // Device-local, written by the culling pass
+        VkBuffer DrawBuffer = VK_NULL_HANDLE;
+
+        VmaAllocation DrawAllocation = VK_NULL_HANDLE;
+
+        VkBuffer DrawCountBuffer = VK_NULL_HANDLE;
+
+        VmaAllocation DrawCountAllocation = VK_NULL_HANDLE;
+
+        // The draw and index counts are copied here for GetVisibleObjectCount()
+        GraphicsDriver::MappedBuffer ReadbackBuffer;
+
+        VkDescriptorSet DescriptorSet = VK_NULL_HANDLE;
+
+        // Objects changed since this frame last uploaded them
+        List<uint32_t> DirtyObjectList;
+
+        bool HasRecorded = false;
+
+    }; // struct Frame
+
+    void MarkObjectDirty(uint32_t objectIndex);
+
+    void UploadDirtyObjects(Frame& frame, unsigned frameIndex);
+
+    void CreateDeviceBuffer(VkDeviceSize size, VkBufferUsageFlags bufferUsageFlags, VkBuffer * buffer, VmaAllocation * allocation);
+
+    void UploadToDeviceBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, const void * data);
+
+    void InitBuffers();
+
+    void TermBuffers();
+
+    void InitDescriptorSets();
+
+    void TermDescriptorSets();
+
+    void InitPipelines();
+
+    void TermPipelines();
+
+    void InitFrames();
+
+    void TermFrames();
+
+    VertexFormat _vertexFormat;
+
+    uint32_t _maxObjectCount;
+
+    uint32_t _maxMeshCount;
+
+    uint32_t _maxVertexCount;
+
+    uint32_t _maxIndexCount;
+
+    uint32_t _vertexCount = 0;
+
+    uint32_t _indexCount = 0;
+
+    List<ShaderSceneMesh> _meshList;
+
+    List<ShaderSceneObject> _objectList;
+
+    List<uint32_t> _freeObjectList;
+
+    // One bit per frame, set while the object is in that frame's DirtyObjectList
+    List<uint32_t> _objectDirtyMaskList;
+
+    bool _frustumCullingEnabled = true;
+
+    bool _lodEnabled = true;
+
+    LODSettings _lodSettings;
+
+    uint32_t _visibleObjectCount = 0;
+
+    uint32_t _visibleTriangleCount = 0;
+
+    VkBuffer _vkVertexBuffer = VK_NULL_HANDLE;
+
+    VmaAllocation _vmaVertexAllocation = VK_NULL_HANDLE;
+
+    VkBuffer _vkIndexBuffer = VK_NULL_HANDLE;
+
+    VmaAllocation _vmaIndexAllocation = VK_NULL_HANDLE;
+
+    // Meshes are only appended, so slots in use by the GPU are never rewritten
+    GraphicsDriver::MappedBuffer _meshBuffer;
+
+    // MaxMeshLODCount slots per mesh
+    GraphicsDriver::MappedBuffer _lodBuffer;
+
+    // Read and written by the culling pass of every frame, which run in submission order
+    VkBuffer _vkObjectLODBuffer = VK_NULL_HANDLE;
+
+    VmaAllocation _vmaObjectLODAllocation = VK_NULL_HANDLE;
+
+    VkDescriptorPool _vkDescriptorPool = VK_NULL_HANDLE;
+
+    VkDescriptorSetLayout _vkDescriptorSetLayout = VK_NULL_HANDLE;
+
+    VkPipelineLayout _vkCullPipelineLayout = VK_NULL_HANDLE;
+
+    VkPipeline _vkCullPipeline = VK_NULL_HANDLE;
+
+    // The driver's descriptor set layout, followed by the scene's
+    VkPipelineLayout _vkDrawPipelineLayout = VK_NULL_HANDLE;
+
+    VkPipeline _vkDrawPipeline = VK_NULL_HANDLE;
+
+    List<Frame> _frameList;
+
+}; // class GPUScene
+
+} // namespace noon
+
+#endif // NOON_GPU_SCENE_HPP
@@ -4,9 +4,16 @@
 #include <Noon/Config.hpp>
 #include <Noon/Containers.hpp>
 #include <Noon/Math.hpp>
+#include <Noon/MemoryBudget.hpp>
 #include <Noon/String.hpp>
+#include <Noon/ShaderBundle.hpp>
+#include <Noon/RenderQueue.hpp>
+#include <Noon/Sampler.hpp>
 #include <Noon/ShaderGlobals.hpp>
-#include <Noon/ShaderTransform.hpp>
+#include <Noon/ShaderInstance.hpp>
+#include <Noon/ShaderMesh.hpp>
+#include <Noon/ShaderView.hpp>
+#include <Noon/VertexFormat.hpp>
 
 #include <SDL.h>
 #include <glad/vulkan.h>
@@ -17,8 +24,18 @@ NOON_DISABLE_WARNINGS()
 
 NOON_ENABLE_WARNINGS()
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
 namespace noon {
 
+class Buffer;
+class Defragmenter;
+class GPUScene;
+
 class NOON_API GraphicsDriver
 {
 public:
@@ -47,6 +64,15 @@ public:
 
     void SetBackbufferCount(unsigned backbufferCount);
 
+    // The frame being recorded, per-frame resources are indexed by this
+    inline unsigned GetBackbufferIndex() const {
+        return _backbufferIndex;
+    }
+
+    inline VkPhysicalDevice GetPhysicalDevice() const {
+        return _vkPhysicalDevice;
+    }
+
     inline VkDevice GetDevice() const {
         return _vkDevice;
     }
@@ -55,17 +81,243 @@ public:
         return _vmaAllocator;
     }
 
+    inline uint32_t GetGraphicsQueueFamilyIndex() const {
+        return _vkGraphicsQueueFamilyIndex;
+    }
+
+    inline VkQueue GetGraphicsQueue() const {
+        return _vkGraphicsQueue;
+    }
+
+    // Either a dedicated transfer queue, or the graphics queue if there is none
+    inline uint32_t GetTransferQueueFamilyIndex() const {
+        return _vkTransferQueueFamilyIndex;
+    }
+
+    inline VkQueue GetTransferQueue() const {
+        return _vkTransferQueue;
+    }
+
+    // Queue families that long-lived buffers are shared between, if there is more than one
+    // they must be created with VK_SHARING_MODE_CONCURRENT
+    inline const List<uint32_t>& GetSharedQueueFamilyIndexList() const {
+        return _vkSharedQueueFamilyIndexList;
+    }
+
+    // Optional features used for GPU-driven rendering, see GPUScene
+
+    inline bool HasDrawIndirectCount() const {
+        return _hasDrawIndirectCount;
+    }
+
+    inline bool HasMultiDrawIndirect() const {
+        return _vkPhysicalDeviceFeatures.multiDrawIndirect;
+    }
+
+    inline bool HasDrawIndirectFirstInstance() const {
+        return _vkPhysicalDeviceFeatures.drawIndirectFirstInstance;
+    }
+
+    // BC1-7 textures, which every desktop GPU supports
+    inline bool HasTextureCompressionBC() const {
+        return _vkPhysicalDeviceFeatures.textureCompressionBC;
+    }
+
+    inline Defragmenter * GetDefragmenter() const {
+        return _defragmenter.get();
+    }
+
+    inline bool HasMemoryBudgetExtension() const {
+        return _hasMemoryBudgetExtension;
+    }
+
+    // Memory budgets are updated once per frame, category usage is always current
+    MemoryStats GetMemoryStats() const;
+
+    void LogMemoryStats() const;
+
+    inline float GetMemoryBudgetThreshold() const {
+        return _memoryBudgetThreshold;
+    }
+
+    // Eviction is requested once a heap's usage exceeds this fraction of its budget
+    inline void SetMemoryBudgetThreshold(float threshold) {
+        _memoryBudgetThreshold = threshold;
+    }
+
+    // Returns VK_NULL_HANDLE for MemoryPool::Default, or if the pool couldn't be created. The
+    // pool is chosen by setting VmaAllocationCreateInfo::pool when calling CreateBuffer/CreateImage.
+    inline VmaPool GetMemoryPool(MemoryPool pool) const {
+        return _vmaPoolList[static_cast<size_t>(pool)];
+    }
+
+    // Callbacks are called one at a time, from whichever thread ran out of memory, which may
+    // be a job or loader thread creating a resource, or the thread running Render(). Once
+    // RemoveMemoryEvictionCallback() returns, the callback is no longer running anywhere.
+    unsigned AddMemoryEvictionCallback(MemoryEvictionCallback callback);
+
+    void RemoveMemoryEvictionCallback(unsigned id);
+
+    // Ask the eviction callbacks to release memory from a heap, returns the number of bytes released
+    VkDeviceSize EvictMemory(uint32_t heapIndex, VkDeviceSize bytesRequested);
+
+    uint32_t GetMemoryHeapIndex(uint32_t memoryTypeIndex) const;
+
+    // Wrappers for vmaCreateBuffer/vmaCreateImage that track usage by category, and ask for
+    // memory to be evicted and retry once if the allocation fails for lack of device memory.
+    // Resources that are incompatible with the requested pool, or don't fit in a full ring,
+    // are allocated from the default pools instead.
+
+    VkResult CreateBuffer(
+        MemoryCategory category,
+        const VkBufferCreateInfo * bufferCreateInfo,
+        const VmaAllocationCreateInfo * allocationCreateInfo,
+        VkBuffer * buffer,
+        VmaAllocation * allocation,
+        VmaAllocationInfo * allocationInfo);
+
+    void DestroyBuffer(MemoryCategory category, VkBuffer buffer, VmaAllocation allocation);
+
+    VkResult CreateImage(
+        MemoryCategory category,
+        const VkImageCreateInfo * imageCreateInfo,
+        const VmaAllocationCreateInfo * allocationCreateInfo,
+        VkImage * image,
+        VmaAllocation * allocation,
+        VmaAllocationInfo * allocationInfo);
+
+    void DestroyImage(MemoryCategory category, VkImage image, VmaAllocation allocation);
+
+    // A persistently mapped, host-visible buffer
+    struct MappedBuffer
+    {
+        VkBuffer Buffer = VK_NULL_HANDLE;
+
+        VmaAllocation Allocation = VK_NULL_HANDLE;
+
+        uint8_t * Data = nullptr;
+
+        VkDeviceSize Size = 0;
+
+        MemoryCategory Category = MemoryCategory::Transient;
+
+    }; // struct MappedBuffer
+
+    // The memory is zeroed. Defaults to a buffer rewritten every frame, use
+    // VMA_MEMORY_USAGE_GPU_TO_CPU for reading results back.
+    MappedBuffer CreateMappedBuffer(
+        VkDeviceSize size,
+        VkBufferUsageFlags bufferUsageFlags,
+        VmaMemoryUsage memoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU,
+        MemoryCategory category = MemoryCategory::Transient);
+
+    void DestroyMappedBuffer(MappedBuffer& buffer);
+
+    // Load a shader bundle from the asset path, shaders are searched for in the order
+    // their bundles were loaded
+    bool LoadShaderBundle(const Path& filename);
+
+    Span<const uint32_t> FindShader(StringView name) const;
+
+    // Falls back to the loose file Shader/<name>.spv when no bundle has the shader
+    VkShaderModule CreateShaderModule(StringView name);
+
+    // Holds the globals, view and instance buffers, recreated along with the swap chain
+    inline VkDescriptorSetLayout GetDescriptorSetLayout() const {
+        return _vkDescriptorSetLayoutList[0];
+    }
+
+    inline VkPipelineLayout GetPipelineLayout() const {
+        return _vkPipelineLayout;
+    }
+
+    // Pipelines are cached per vertex format, and recreated along with the swap chain
+    VkPipeline GetMeshPipeline(const VertexFormat& vertexFormat);
+
+    // Create an uncached mesh pipeline for the render pass, with the fragment shader of
+    // GetMeshPipeline(). The pipeline layout must start with GetDescriptorSetLayout(), and have
+    // a vertex push constant range of sizeof(ShaderMesh).
+    VkPipeline CreateMeshPipeline(
+        const VertexFormat& vertexFormat,
+        StringView vertexShaderName,
+        VkPipelineLayout pipelineLayout);
+
+    // Samplers are shared by every texture with the same SamplerDesc, and live as long as the
+    // driver
+    VkSampler GetSampler(const SamplerDesc& desc);
+
+    // Holds VertexFormat::GetDefaultVertex(), bound to VertexFormat::DefaultBinding
+    Buffer * GetDefaultVertexBuffer();
+
+    // Objects submitted here are drawn by the first call to Render() after the next call to
+    // SwapRenderSnapshot()
+    inline RenderQueue * GetRenderQueue() const {
+        return _pendingRenderQueue.get();
+    }
+
+    // Applies to the same frame as GetRenderQueue()
+    void SetView(const Mat4& view, const Mat4& projection);
+
+    // The view of the frame being rendered
+    inline const ShaderView& GetShaderView() const {
+        return _shaderView;
+    }
+
+    // Hand the render queue and view filled since the last call to the next Render(), so the
+    // next frame can be built while this one renders on another thread. Must not be called
+    // while Render() is running.
+    void SwapRenderSnapshot();
+
+    // Scenes are culled before the render pass and drawn in it, every frame until removed
+    void AddGPUScene(GPUScene * scene);
+
+    void RemoveGPUScene(GPUScene * scene);
+
+    // Must be called from the main thread, window changes are applied by the next Render()
     void ProcessEvents();
-    
+
+    // Can run on another thread than the rest of the application, see SwapRenderSnapshot()
     void Render();
 
+    // Records commands into a one-time command buffer, and waits for them to finish on the
+    // graphics queue
+    void RunOneTimeCommands(const std::function<void(VkCommandBuffer)>& record);
+
+    // Submits to the transfer queue, which Render() and RunOneTimeCommands() may be using from
+    // other threads
+    void SubmitTransfer(const VkSubmitInfo& submitInfo, VkFence fence);
+
     // TODO: Move
-    void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+    void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize dstOffset = 0);
 
 protected:
 
     void UpdateShaderGlobals();
 
+    void UpdateShaderView();
+
+    void UpdateInstanceBuffer();
+
+    void UpdateDescriptorSet(unsigned frameIndex);
+
+    void RecordCommandBuffer(uint32_t imageIndex);
+
+    void UpdateMemoryBudget();
+
+    void TrackAllocation(MemoryCategory category, VmaAllocation allocation);
+
+    void UntrackAllocation(MemoryCategory category, VmaAllocation allocation);
+
+    MemoryPool FindMemoryPool(VmaPool vmaPool) const;
+
+    inline bool IsRingMemoryPool(MemoryPool pool) const {
+        return (pool == MemoryPool::Transient || pool == MemoryPool::Staging);
+    }
+
+    VkResult GetImageMemoryRequirements(
+        const VkImageCreateInfo * imageCreateInfo,
+        VkMemoryRequirements * memoryRequirements);
+
     bool HasLayerAvailable(const char * layer);
 
     bool HasInstanceExtensionAvailable(const char * extension);
@@ -104,6 +356,20 @@ protected:
 
     void TermAllocator();
 
+    void InitMemoryPools();
+
+    void TermMemoryPools();
+
+    void InitShaderBundles();
+
+    void TermShaderBundles();
+
+    void InitDefragmenter();
+
+    void TermDefragmenter();
+
+    void TermSamplers();
+
     void InitSyncObjects();
 
     void TermSyncObjects();
@@ -126,10 +392,16 @@ protected:
 
     void TermDescriptorPool();
 
+    void InitDescriptorSets();
+
+    void TermDescriptorSets();
+
     void InitPipelineLayout();
 
     void TermPipelineLayout();
 
+    void TermMeshPipelines();
+
     void InitFramebuffers();
 
     void TermFramebuffers();
@@ -138,8 +410,6 @@ protected:
 
     void TermCommandBuffers();
 
-    void FillCommandBuffers();
-
     static GraphicsDriver * _Instance;
 
     SDL_Window * _sdlWindow;
@@ -148,10 +418,23 @@ protected:
 
     Vec2i _windowSize = { 640, 480 };
 
+    // Resizes from the main thread, applied by the next Render() which may be on another thread
+    std::mutex _resizeMutex;
+
+    Vec2i _pendingWindowSize;
+
+    bool _swapChainOutOfDate = false;
+
+    // Serializes the use of the graphics queue and command pool between Render() and uploads,
+    // which can happen on different threads
+    std::recursive_mutex _queueMutex;
+
     unsigned _backbufferCount = 2;
 
     unsigned _backbufferIndex = 0;
 
+    unsigned _frameCount = 0;
+
     Map<String, VkLayerProperties> _vkAvailableLayerMap;
 
     Map<String, VkExtensionProperties> _vkAvailableInstanceExtensionMap;
@@ -172,18 +455,55 @@ protected:
 
     VkPhysicalDevice _vkPhysicalDevice = VK_NULL_HANDLE;
 
+    bool _hasDrawIndirectCount = false;
+
     VkDevice _vkDevice = VK_NULL_HANDLE;
 
     uint32_t _vkGraphicsQueueFamilyIndex;
 
     uint32_t _vkPresentQueueFamilyIndex;
 
+    uint32_t _vkTransferQueueFamilyIndex;
+
+    List<uint32_t> _vkSharedQueueFamilyIndexList;
+
     VkQueue _vkGraphicsQueue = VK_NULL_HANDLE;
     
     VkQueue _vkPresentQueue = VK_NULL_HANDLE;
 
+    VkQueue _vkTransferQueue = VK_NULL_HANDLE;
+
     VmaAllocator _vmaAllocator = VK_NULL_HANDLE;
 
+    bool _hasMemoryBudgetExtension = false;
+
+    float _memoryBudgetThreshold = 0.9f;
+
+    // Guards the heap budgets, which Render() updates, and the eviction callbacks, which are
+    // held for as long as they run. Recursive, as freeing memory from a callback may create
+    // or destroy resources.
+    mutable std::recursive_mutex _memoryMutex;
+
+    List<MemoryHeapBudget> _memoryHeapBudgetList;
+
+    Array<std::atomic<VkDeviceSize>, MemoryCategoryCount> _memoryCategoryBytes = { };
+
+    Array<std::atomic<uint32_t>, MemoryCategoryCount> _memoryCategoryCount = { };
+
+    unsigned _nextMemoryEvictionCallbackId = 0;
+
+    List<std::pair<unsigned, MemoryEvictionCallback>> _memoryEvictionCallbackList;
+
+    Array<VmaPool, MemoryPoolCount> _vmaPoolList = { };
+
+    Array<uint32_t, MemoryPoolCount> _memoryPoolTypeIndexList = { };
+
+    Array<VkBufferUsageFlags, MemoryPoolCount> _memoryPoolBufferUsageList = { };
+
+    std::unique_ptr<Defragmenter> _defragmenter;
+
+    List<std::unique_ptr<ShaderBundle>> _shaderBundleList;
+
     VkFormat _vkSwapChainImageFormat;
 
     VkExtent2D _vkSwapChainExtent;
@@ -208,8 +528,39 @@ protected:
 
     List<VkDescriptorSetLayout> _vkDescriptorSetLayoutList;
 
+    // One of each per backbuffer, indexed by _backbufferIndex
+
+    List<VkDescriptorSet> _vkDescriptorSetList;
+
+    List<MappedBuffer> _globalsBufferList;
+
+    List<MappedBuffer> _viewBufferList;
+
+    List<MappedBuffer> _instanceBufferList;
+
+    ShaderView _shaderView;
+
+    ShaderView _pendingShaderView;
+
+    // Read by Render()
+    std::unique_ptr<RenderQueue> _renderQueue;
+
+    // Filled for the next frame
+    std::unique_ptr<RenderQueue> _pendingRenderQueue;
+
+    List<GPUScene *> _gpuSceneList;
+
     VkPipelineLayout _vkPipelineLayout = VK_NULL_HANDLE;
 
+    Map<uint64_t, VkPipeline> _vkMeshPipelineMap;
+
+    std::unique_ptr<Buffer> _defaultVertexBuffer;
+
+    std::mutex _samplerMutex;
+
+    // By SamplerDesc::GetKey()
+    Map<uint64_t, VkSampler> _vkSamplerMap;
+
     List<VkFramebuffer> _vkFramebufferList;
 
     VkCommandPool _vkCommandPool = VK_NULL_HANDLE;
@@ -224,8 +575,6 @@ protected:
 
     List<VkFence> _vkImageInFlightList;
 
-    List<VkBuffer> _vkUniformBufferList;
-
 }; // class GraphicsDriver
 
 String VkResultToString(VkResult vkResult);
@@ -0,0 +1,38 @@
+#ifndef NOON_HASH_HPP
+#define NOON_HASH_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/String.hpp>
+
+#include <cstdint>
+
+namespace noon {
+
+// 64-bit FNV-1a, stable across platforms and builds so it can be stored in files
+// https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
+
+constexpr uint64_t FNV1A_OFFSET_BASIS = 0xCBF29CE484222325ull;
+
+constexpr uint64_t FNV1A_PRIME = 0x100000001B3ull;
+
+constexpr uint64_t HashFNV1a(const uint8_t * data, size_t size, uint64_t hash = FNV1A_OFFSET_BASIS)
+{
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= FNV1A_PRIME;
+    }
+    return hash;
+}
+
+constexpr uint64_t HashFNV1a(StringView str, uint64_t hash = FNV1A_OFFSET_BASIS)
+{
+    for (char c : str) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= FNV1A_PRIME;
+    }
+    return hash;
+}
+
+} // namespace noon
+
+#endif // NOON_HASH_HPP
\ No newline at end of file
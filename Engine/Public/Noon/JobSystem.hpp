@@ -0,0 +1,265 @@
+#ifndef NOON_JOB_SYSTEM_HPP
+#define NOON_JOB_SYSTEM_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/Fiber.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace noon {
+
+class JobCounter;
+
+struct JobFiber;
+
+// Runs Function(Data, First, Last), jobs are small enough to be copied around by value. Jobs
+// must not throw.
+using JobFunction = void (*)(void * data, size_t first, size_t last);
+
+struct Job
+{
+    JobFunction Function;
+
+    void * Data;
+
+    size_t First;
+
+    size_t Last;
+
+    // Decremented once the job has finished, if set
+    JobCounter * Counter;
+
+    // Only run by the main thread, for APIs such as SDL which require it
+    bool MainThread;
+
+}; // struct Job
+
+// Counts the jobs that haven't finished yet. Jobs scheduled with a counter as their dependency
+// are held back until it reaches zero, and jobs waiting on it are suspended until then.
+class NOON_API JobCounter
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(JobCounter)
+
+    JobCounter() = default;
+
+    inline bool IsDone() const {
+        return (_value.load(std::memory_order_acquire) == 0);
+    }
+
+private:
+
+    friend class JobSystem;
+
+    std::atomic<uint32_t> _value = 0;
+
+    std::mutex _mutex;
+
+    List<Job> _waitingList;
+
+    List<JobFiber *> _waitingFiberList;
+
+}; // class JobCounter
+
+// A fixed set of worker threads, one per core, each with its own deque of jobs. Workers pop
+// their own jobs newest first, and steal the oldest jobs of the others once theirs run out.
+// Workers run each job on a fiber, so a job that waits is suspended and the worker moves on to
+// other jobs. The thread that created the job system is the main thread, and runs jobs while
+// it waits.
+class NOON_API JobSystem
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(JobSystem)
+
+    static JobSystem * GetInstance() {
+        return _Instance;
+    }
+
+    // Creates one worker per core besides the main thread when workerCount is 0
+    JobSystem(size_t workerCount = 0);
+
+    ~JobSystem();
+
+    // The number of threads that run jobs, including the main thread
+    inline size_t GetThreadCount() const {
+        return _workerList.size();
+    }
+
+    bool IsMainThread() const;
+
+    // The job is added to counter before it is queued, and is only queued once dependency is
+    // done, if set
+    void Schedule(Job job, JobCounter * dependency = nullptr);
+
+    // Copies func, and runs it as a job
+    template <class Func>
+    void Schedule(Func&& func, JobCounter * counter, JobCounter * dependency = nullptr, bool mainThread = false) {
+        using Callable = std::decay_t<Func>;
+
+        Schedule(
+            Job{
+                .Function = [](void * data, size_t, size_t) {
+                    std::unique_ptr<Callable> callable(static_cast<Callable *>(data));
+                    (*callable)();
+                },
+                .Data = new Callable(std::forward<Func>(func)),
+                .First = 0,
+                .Last = 0,
+                .Counter = counter,
+                .MainThread = mainThread,
+            },
+            dependency);
+    }
+
+    // On a worker, suspends the job until counter is done, which may resume it on another
+    // worker. Elsewhere, runs other jobs until counter is done. A counter must be waited on
+    // before it is destroyed.
+    void Wait(JobCounter& counter);
+
+    // Count work that isn't a job, such as a file read or a GPU timepoint, which must call
+    // Signal() once for each time it was counted
+    void Increment(JobCounter& counter, uint32_t count = 1);
+
+    void Signal(JobCounter& counter);
+
+    // Run the jobs that require the main thread, must be called from the main thread
+    void ProcessMainThreadJobs();
+
+private:
+
+    static JobSystem * _Instance;
+
+    struct Worker
+    {
+        std::mutex Mutex;
+
+        Queue<Job> JobQueue;
+
+        std::thread Thread;
+
+    }; // struct Worker
+
+    void WorkerMain(size_t index);
+
+    void Push(const Job& job);
+
+    bool TryPop(size_t index, Job& job);
+
+    bool TrySteal(size_t index, Job& job);
+
+    // Try to run one job, as the thread with the given index
+    bool TryRunJob(size_t index);
+
+    void Run(const Job& job);
+
+    // Runs jobs on the fiber, until the job it runs finishes or waits
+    static void FiberMain(void * data);
+
+    JobFiber * AcquireFiber();
+
+    bool TryPopReadyFiber(JobFiber *& fiber);
+
+    // Switch from a worker's own fiber to the job fiber, until it finishes or waits
+    void SwitchToFiber(JobFiber * fiber);
+
+    // Index 0 is the main thread, which only uses the deque
+    List<std::unique_ptr<Worker>> _workerList;
+
+    std::mutex _mainThreadMutex;
+
+    Queue<Job> _mainThreadQueue;
+
+    std::thread::id _mainThreadID;
+
+    std::mutex _fiberMutex;
+
+    List<std::unique_ptr<JobFiber>> _fiberList;
+
+    List<JobFiber *> _freeFiberList;
+
+    // Fibers whose counter is done, waiting for a worker to resume them
+    std::mutex _readyFiberMutex;
+
+    Queue<JobFiber *> _readyFiberQueue;
+
+    // Jobs queued in any deque, and ready fibers, so idle workers know when to wake up
+    std::atomic<size_t> _queuedJobCount = 0;
+
+    std::atomic<size_t> _nextDeque = 0;
+
+    std::atomic<size_t> _sleepingCount = 0;
+
+    std::mutex _idleMutex;
+
+    std::condition_variable _idleCondition;
+
+    std::atomic<bool> _running = true;
+
+}; // class JobSystem
+
+// Calls func(first, last) for consecutive ranges covering [0, count), in parallel when a
+// JobSystem exists, and returns once every range has finished. Ranges have at least
+// minBatchSize elements, except the last, and are a multiple of batchAlignment.
+template <class Func>
+void ParallelFor(size_t count, size_t minBatchSize, Func&& func, size_t batchAlignment = 1)
+{
+    // Both are divided by below, 0 means no minimum and no alignment
+    minBatchSize = std::max<size_t>(minBatchSize, 1);
+    batchAlignment = std::max<size_t>(batchAlignment, 1);
+
+    JobSystem * jobSystem = JobSystem::GetInstance();
+    if (!jobSystem || count <= minBatchSize || jobSystem->GetThreadCount() == 1) {
+        if (count > 0) {
+            func(size_t(0), count);
+        }
+        return;
+    }
+
+    // A few batches per thread, so threads that finish early can steal the rest
+    size_t batchCount = std::min(count / minBatchSize, jobSystem->GetThreadCount() * 4);
+    size_t batchSize = (count + batchCount - 1) / batchCount;
+    batchSize = ((batchSize + batchAlignment - 1) / batchAlignment) * batchAlignment;
+
+    using Callable = std::remove_reference_t<Func>;
+
+    JobCounter counter;
+    for (size_t first = batchSize; first < count; first += batchSize) {
+        jobSystem->Schedule(Job{
+            .Function = [](void * data, size_t first, size_t last) {
+                (*static_cast<Callable *>(data))(first, last);
+            },
+            .Data = const_cast<void *>(static_cast<const void *>(std::addressof(func))),
+            .First = first,
+            .Last = std::min(first + batchSize, count),
+            .Counter = &counter,
+            .MainThread = false,
+        });
+    }
+
+    // The calling thread takes the first batch rather than waiting idle, and can only leave
+    // once the other batches are done with func
+    try {
+        func(size_t(0), std::min(batchSize, count));
+    }
+    catch (...) {
+        jobSystem->Wait(counter);
+        throw;
+    }
+
+    jobSystem->Wait(counter);
+}
+
+} // namespace noon
+
+#endif // NOON_JOB_SYSTEM_HPP
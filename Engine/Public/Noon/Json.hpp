@@ -0,0 +1,241 @@
+#ifndef NOON_JSON_HPP
+#define NOON_JSON_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/String.hpp>
+
+#include <cstdint>
+
+namespace noon {
+
+enum class JsonType : uint8_t
+{
+    Null,
+    Bool,
+    Number,
+    String,
+    Array,
+    Object,
+
+}; // enum class JsonType
+
+class JsonDocument;
+
+// A value inside a JsonDocument, which must outlive it. Missing members and elements are
+// Null, so lookups can be chained, e.g. json["asset"]["version"].GetString().
+class NOON_API JsonValue
+{
+public:
+
+    class Iterator
+    {
+    public:
+
+        inline JsonValue operator*() const {
+            return JsonValue(_document, (_isObject ? _index + 1 : _index));
+        }
+
+        Iterator& operator++();
+
+        inline bool operator!=(const Iterator& rhs) const {
+            return (_index != rhs._index);
+        }
+
+    private:
+
+        friend class JsonValue;
+
+        Iterator(const JsonDocument * document, uint32_t index, bool isObject)
+            : _document(document)
+            , _index(index)
+            , _isObject(isObject)
+        { }
+
+        const JsonDocument * _document;
+
+        // The element, or the key of the member
+        uint32_t _index;
+
+        bool _isObject;
+
+    }; // class Iterator
+
+    JsonValue() = default;
+
+    JsonType GetType() const;
+
+    inline bool IsNull() const {
+        return (GetType() == JsonType::Null);
+    }
+
+    inline bool IsBool() const {
+        return (GetType() == JsonType::Bool);
+    }
+
+    inline bool IsNumber() const {
+        return (GetType() == JsonType::Number);
+    }
+
+    inline bool IsString() const {
+        return (GetType() == JsonType::String);
+    }
+
+    inline bool IsArray() const {
+        return (GetType() == JsonType::Array);
+    }
+
+    inline bool IsObject() const {
+        return (GetType() == JsonType::Object);
+    }
+
+    // The defaults are returned when the value is of another type
+
+    bool GetBool(bool defaultValue = false) const;
+
+    double GetNumber(double defaultValue = 0.0) const;
+
+    inline float GetFloat(float defaultValue = 0.0f) const {
+        return static_cast<float>(GetNumber(defaultValue));
+    }
+
+    inline int64_t GetInt(int64_t defaultValue = 0) const {
+        return static_cast<int64_t>(GetNumber(static_cast<double>(defaultValue)));
+    }
+
+    // Unescaped, strings without escapes are copied straight from the source text
+    String GetString(StringView defaultValue = {}) const;
+
+    // The text between the quotes, escapes included, without any allocation
+    StringView GetRawString() const;
+
+    // The number of elements or members
+    size_t GetSize() const;
+
+    // Steps over the elements before it, iterate instead to visit them all
+    JsonValue operator[](size_t index) const;
+
+    // Keys are compared against the raw text, so keys containing escapes never match
+    JsonValue operator[](StringView key) const;
+
+    inline bool Has(StringView key) const {
+        return !(*this)[key].IsNull();
+    }
+
+    // Iterates the elements of an array, or the values of an object
+    Iterator begin() const;
+
+    Iterator end() const;
+
+    // Calls func(StringView key, JsonValue value) for every member of an object
+    template <class Func>
+    void ForEachMember(Func&& func) const;
+
+private:
+
+    friend class JsonDocument;
+
+    JsonValue(const JsonDocument * document, uint32_t index)
+        : _document(document)
+        , _index(index)
+    { }
+
+    const JsonDocument * _document = nullptr;
+
+    uint32_t _index = 0;
+
+}; // class JsonValue
+
+// Parses JSON text into a flat list of values, with every value followed by its elements or
+// members. Strings and numbers are not copied or converted beyond what's needed to find where
+// they end, so parsing makes a single allocation for most documents.
+class NOON_API JsonDocument
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(JsonDocument)
+
+    JsonDocument() = default;
+
+    // The text is referenced rather than copied, and must outlive the document. Throws if the
+    // text is not valid JSON.
+    void Parse(StringView text);
+
+    inline JsonValue GetRoot() const {
+        return (_nodeList.empty() ? JsonValue() : JsonValue(this, 0));
+    }
+
+private:
+
+    friend class JsonValue;
+
+    struct Node
+    {
+        JsonType Type;
+
+        bool HasEscapes;
+
+        // The number of elements, members, or the bool value
+        uint32_t Size;
+
+        // The index of the node after this value and its children
+        uint32_t End;
+
+        union
+        {
+            double Number;
+
+            struct
+            {
+                uint32_t Offset;
+
+                uint32_t Length;
+
+            } Text;
+        };
+
+    }; // struct Node
+
+    static_assert(sizeof(Node) == 24);
+
+    uint32_t ParseValue(size_t depth);
+
+    void ParseString(Node& node);
+
+    void ParseNumber(Node& node);
+
+    void SkipWhitespace();
+
+    void Expect(char c);
+
+    [[noreturn]] void ThrowError(const char * message) const;
+
+    // The line _position is on, for errors
+    size_t GetLine() const;
+
+    StringView _text;
+
+    size_t _position = 0;
+
+    List<Node> _nodeList;
+
+}; // class JsonDocument
+
+template <class Func>
+void JsonValue::ForEachMember(Func&& func) const
+{
+    if (GetType() != JsonType::Object) {
+        return;
+    }
+
+    const auto& nodeList = _document->_nodeList;
+
+    uint32_t end = nodeList[_index].End;
+    for (uint32_t key = _index + 1; key < end; key = nodeList[key + 1].End) {
+        func(JsonValue(_document, key).GetRawString(), JsonValue(_document, key + 1));
+    }
+}
+
+} // namespace noon
+
+#endif // NOON_JSON_HPP
@@ -0,0 +1,128 @@
+#ifndef NOON_KTX2_HPP
+#define NOON_KTX2_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+
+#include <glad/vulkan.h>
+
+#include <cstdint>
+
+namespace noon {
+
+// A 2D texture in a KTX2 container, whose payload is already in a Vulkan format so it can be
+// uploaded as-is. Supercompressed payloads (BasisLZ, Zstandard) are not supported.
+// https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+class NOON_API KTX2File
+{
+public:
+
+    static constexpr uint8_t Identifier[12] = {
+        0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n',
+    };
+
+    struct Header
+    {
+        uint8_t Identifier[12];
+        uint32_t VkFormat;
+        uint32_t TypeSize;
+        uint32_t PixelWidth;
+        uint32_t PixelHeight;
+        uint32_t PixelDepth;
+        uint32_t LayerCount;
+        uint32_t FaceCount;
+        uint32_t LevelCount;
+        uint32_t SupercompressionScheme;
+        uint32_t DFDByteOffset;
+        uint32_t DFDByteLength;
+        uint32_t KVDByteOffset;
+        uint32_t KVDByteLength;
+        uint64_t SGDByteOffset;
+        uint64_t SGDByteLength;
+    };
+
+    // One per level, largest first
+    struct LevelIndex
+    {
+        uint64_t ByteOffset;
+        uint64_t ByteLength;
+        uint64_t UncompressedByteLength;
+    };
+
+    static_assert(sizeof(Header) == 80);
+    static_assert(sizeof(LevelIndex) == 24);
+
+    KTX2File() = default;
+
+    // Levels are views into data, which must outlive them
+    bool Parse(Span<const uint8_t> data);
+
+    // Parses only the header and level index, for reading the levels separately. data must
+    // hold at least GetIndexSize(levelCount) bytes from the start of the file.
+    bool ParseIndex(Span<const uint8_t> data, uint64_t fileSize);
+
+    // Builds a file from levelList, largest first, storing the levels smallest first with no
+    // supercompression. Only the BC formats and RGBA8 have a data format descriptor, throws for
+    // any other format or if the levels are the wrong size.
+    static List<uint8_t> Write(
+        VkFormat format,
+        uint32_t width,
+        uint32_t height,
+        Span<const Span<const uint8_t>> levelList);
+
+    // The size of the header and level index, at most levelCount is 16 for 32768x32768
+    static constexpr size_t GetIndexSize(uint32_t levelCount = 16) {
+        return sizeof(Header) + (sizeof(LevelIndex) * levelCount);
+    }
+
+    inline VkFormat GetFormat() const {
+        return _format;
+    }
+
+    inline uint32_t GetWidth() const {
+        return _width;
+    }
+
+    inline uint32_t GetHeight() const {
+        return _height;
+    }
+
+    inline uint32_t GetLevelCount() const {
+        return static_cast<uint32_t>(_levelIndexList.size());
+    }
+
+    // Where each mip level is in the file, largest first. Levels are stored smallest first,
+    // so any run of consecutive levels can be read with one read.
+    inline const List<LevelIndex>& GetLevelIndexList() const {
+        return _levelIndexList;
+    }
+
+    // Tightly packed texels or blocks of each mip level, largest first, empty after ParseIndex()
+    inline const List<Span<const uint8_t>>& GetLevelList() const {
+        return _levelList;
+    }
+
+    // The file has only the base level, and asks for the rest to be generated
+    inline bool NeedsMipmaps() const {
+        return _needsMipmaps;
+    }
+
+private:
+
+    VkFormat _format = VK_FORMAT_UNDEFINED;
+
+    uint32_t _width = 0;
+
+    uint32_t _height = 0;
+
+    bool _needsMipmaps = false;
+
+    List<LevelIndex> _levelIndexList;
+
+    List<Span<const uint8_t>> _levelList;
+
+}; // class KTX2File
+
+} // namespace noon
+
+#endif // NOON_KTX2_HPP
@@ -0,0 +1,62 @@
+#ifndef NOON_MAPPED_FILE_HPP
+#define NOON_MAPPED_FILE_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Path.hpp>
+
+#include <cstdint>
+
+namespace noon {
+
+// Read-only view of an entire file, mapped into the address space
+class NOON_API MappedFile
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(MappedFile)
+
+    MappedFile() = default;
+
+    ~MappedFile();
+
+    bool Open(const Path& path);
+
+    void Close();
+
+    inline bool IsOpen() const {
+        return (_data != nullptr);
+    }
+
+    inline const Path& GetPath() const {
+        return _path;
+    }
+
+    inline const uint8_t * GetData() const {
+        return _data;
+    }
+
+    inline size_t GetSize() const {
+        return _size;
+    }
+
+private:
+
+    Path _path;
+
+    const uint8_t * _data = nullptr;
+
+    size_t _size = 0;
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    void * _fileHandle = nullptr;
+
+    void * _mappingHandle = nullptr;
+
+#endif
+
+}; // class MappedFile
+
+} // namespace noon
+
+#endif // NOON_MAPPED_FILE_HPP
\ No newline at end of file
@@ -0,0 +1,129 @@
+#ifndef NOON_MEMORY_BUDGET_HPP
+#define NOON_MEMORY_BUDGET_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/String.hpp>
+
+#include <glad/vulkan.h>
+
+#include <functional>
+
+namespace noon {
+
+enum class MemoryCategory
+{
+    // Long-lived GPU buffers, such as vertex and index data
+    Buffer,
+
+    // Textures, render targets and depth buffers
+    Image,
+
+    // Host-visible buffers used to upload data to the GPU
+    Staging,
+
+    // Data rewritten every frame, such as uniforms
+    Transient,
+
+}; // enum class MemoryCategory
+
+constexpr size_t MemoryCategoryCount = 4;
+
+NOON_API
+String MemoryCategoryToString(MemoryCategory category);
+
+enum class MemoryPool
+{
+    // VMA's default pools, sized and placed automatically
+    Default,
+
+    // Fixed-size ring buffer for per-frame data, which must be freed in the order it was
+    // allocated. Falls back to the default pools when full.
+    Transient,
+
+    // Fixed-size ring buffer for uploads, with the same rules as Transient
+    Staging,
+
+    // Buddy allocator for render targets, which are recreated often at similar sizes
+    RenderTarget,
+
+    // Device-local content that can be evicted, allocations fail rather than exceed the budget
+    Streaming,
+
+}; // enum class MemoryPool
+
+constexpr size_t MemoryPoolCount = 5;
+
+NOON_API
+String MemoryPoolToString(MemoryPool pool);
+
+struct MemoryHeapBudget
+{
+    // Sum of all VkDeviceMemory blocks allocated from this heap
+    VkDeviceSize BlockBytes;
+
+    // Sum of all allocations made from those blocks, the difference is free or fragmented
+    VkDeviceSize AllocationBytes;
+
+    // Estimated memory usage of the whole process, including memory not allocated by us
+    VkDeviceSize Usage;
+
+    // Estimated memory available to the process, exceeding this may cause paging or failures
+    VkDeviceSize Budget;
+
+    bool IsDeviceLocal;
+
+    bool IsOverBudget;
+
+}; // struct MemoryHeapBudget
+
+struct MemoryCategoryUsage
+{
+    VkDeviceSize Bytes;
+
+    uint32_t AllocationCount;
+
+}; // struct MemoryCategoryUsage
+
+struct MemoryPoolUsage
+{
+    // Memory allocated from Vulkan for this pool
+    VkDeviceSize Bytes;
+
+    VkDeviceSize UnusedBytes;
+
+    // Largest free range, for ring pools this is how much can be allocated before wrapping
+    VkDeviceSize LargestFreeBytes;
+
+    uint32_t AllocationCount;
+
+    uint32_t BlockCount;
+
+}; // struct MemoryPoolUsage
+
+struct MemoryStats
+{
+    List<MemoryHeapBudget> HeapList;
+
+    Array<MemoryCategoryUsage, MemoryCategoryCount> CategoryList;
+
+    // Usage of the Default pool is not tracked, and is always zero
+    Array<MemoryPoolUsage, MemoryPoolCount> PoolList;
+
+    inline const MemoryCategoryUsage& GetCategory(MemoryCategory category) const {
+        return CategoryList[static_cast<size_t>(category)];
+    }
+
+    inline const MemoryPoolUsage& GetPool(MemoryPool pool) const {
+        return PoolList[static_cast<size_t>(pool)];
+    }
+
+}; // struct MemoryStats
+
+// Asked to release memory from a heap that is over budget, or that just failed an allocation.
+// Returns the number of bytes that were actually released.
+using MemoryEvictionCallback = std::function<VkDeviceSize(uint32_t heapIndex, VkDeviceSize bytesRequested)>;
+
+} // namespace noon
+
+#endif // NOON_MEMORY_BUDGET_HPP
\ No newline at end of file
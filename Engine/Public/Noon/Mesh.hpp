@@ -0,0 +1,111 @@
+#ifndef NOON_MESH_HPP
+#define NOON_MESH_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Buffer.hpp>
+#include <Noon/MeshLOD.hpp>
+#include <Noon/ShaderMesh.hpp>
+#include <Noon/VertexFormat.hpp>
+
+#include <glad/vulkan.h>
+
+#include <memory>
+
+namespace noon {
+
+class NOON_API Mesh
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(Mesh)
+
+    // Packs the vertices with the format from VertexFormat::Choose(). Without indices the
+    // vertices are drawn as a triangle list, see OptimizeMesh() for preparing indexed meshes.
+    // With lodList, the indices hold every level of detail, see GenerateMeshLODs().
+    Mesh(const VertexData& vertexData, Span<const uint32_t> indexList = {}, Span<const MeshLOD> lodList = {});
+
+    Mesh(const VertexData& vertexData, const VertexFormat& vertexFormat, Span<const uint32_t> indexList = {}, Span<const MeshLOD> lodList = {});
+
+    // Uploads vertices already encoded with the format, and 16 or 32-bit indices, as they are
+    Mesh(const VertexFormat& vertexFormat, const ShaderMesh& shaderMesh, uint32_t vertexCount, Span<const uint8_t> vertexData, VkIndexType indexType = VK_INDEX_TYPE_UINT16, uint32_t indexCount = 0, Span<const uint8_t> indexData = {}, Span<const MeshLOD> lodList = {});
+
+    ~Mesh() = default;
+
+    inline const VertexFormat& GetVertexFormat() const {
+        return _vertexFormat;
+    }
+
+    inline uint32_t GetVertexCount() const {
+        return _vertexCount;
+    }
+
+    inline Buffer * GetVertexBuffer() const {
+        return _vertexBuffer.get();
+    }
+
+    inline bool IsIndexed() const {
+        return (_indexBuffer != nullptr);
+    }
+
+    inline uint32_t GetIndexCount() const {
+        return _indexCount;
+    }
+
+    // VK_INDEX_TYPE_UINT16 whenever every vertex can be addressed with it
+    inline VkIndexType GetIndexType() const {
+        return _vkIndexType;
+    }
+
+    inline Buffer * GetIndexBuffer() const {
+        return _indexBuffer.get();
+    }
+
+    inline const ShaderMesh& GetShaderMesh() const {
+        return _shaderMesh;
+    }
+
+    // Always holds at least the full detail level, which covers every index, or every vertex
+    // when there are none
+    inline Span<const MeshLOD> GetLODList() const {
+        return _lodList;
+    }
+
+    inline uint32_t GetLODCount() const {
+        return static_cast<uint32_t>(_lodList.size());
+    }
+
+    // Binds the pipeline for the vertex format, the vertex buffers and the push constants, and
+    // draws. Must be recorded inside the driver's render pass, with the driver's descriptor set
+    // bound. Instances are read from the instance buffer starting at firstInstance, and lod is
+    // clamped to the levels the mesh has, see SelectLOD().
+    void Draw(VkCommandBuffer commandBuffer, uint32_t instanceCount = 1, uint32_t firstInstance = 0, uint32_t lod = 0);
+
+private:
+
+    void Init(const VertexData& vertexData, Span<const uint32_t> indexList);
+
+    void InitIndexBuffer(Span<const uint32_t> indexList);
+
+    void InitLODList(Span<const MeshLOD> lodList);
+
+    VertexFormat _vertexFormat;
+
+    uint32_t _vertexCount = 0;
+
+    ShaderMesh _shaderMesh;
+
+    std::unique_ptr<Buffer> _vertexBuffer;
+
+    uint32_t _indexCount = 0;
+
+    VkIndexType _vkIndexType = VK_INDEX_TYPE_UINT16;
+
+    std::unique_ptr<Buffer> _indexBuffer;
+
+    List<MeshLOD> _lodList;
+
+}; // class Mesh
+
+} // namespace noon
+
+#endif // NOON_MESH_HPP
@@ -0,0 +1,85 @@
+#ifndef NOON_MESH_LOD_HPP
+#define NOON_MESH_LOD_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Bounds.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/Culling.hpp>
+#include <Noon/JobSystem.hpp>
+#include <Noon/Math.hpp>
+
+#include <cstdint>
+
+namespace noon {
+
+// The most levels of detail a mesh can have, including the full detail one
+constexpr uint32_t MaxMeshLODCount = 8;
+
+// A range of the index buffer of a mesh drawing it at one level of detail. Levels share the
+// vertices of the mesh, and go from full detail down, see GenerateMeshLODs().
+struct MeshLOD
+{
+    uint32_t FirstIndex;
+
+    uint32_t IndexCount;
+
+    // How far the simplified surface may be from the original, relative to the radius of
+    // BoundingSphere::FromPoints() of the mesh, so it scales along with the object
+    float Error;
+
+}; // struct MeshLOD
+
+struct LODSettings
+{
+    Vec3 CameraPosition = Vec3(0.0f);
+
+    // Pixels covered by one world unit at a distance of 1, see GetLODScale()
+    float Scale = 0.0f;
+
+    // The largest error allowed on screen, in pixels
+    float Threshold = 1.0f;
+
+    // A coarser level is only switched to once its error is this fraction under Threshold,
+    // so objects sitting at a threshold don't switch back and forth every frame
+    float Hysteresis = 0.25f;
+
+}; // struct LODSettings
+
+// For a perspective projection and the height of the viewport it is drawn to
+NOON_API
+float GetLODScale(const Mat4& projection, float viewportHeight);
+
+// Returns the coarsest level whose error, projected from the point of bounds nearest to the
+// camera, is within the threshold. bounds are in world space, currentLOD is the level the
+// object was drawn with last, and the result is always 0 with the camera inside bounds.
+NOON_API
+uint32_t SelectLOD(const LODSettings& settings, Span<const MeshLOD> lodList, const BoundingSphere& bounds, uint32_t currentLOD);
+
+// Run SelectLOD() for the visible objects of ParallelCullSpheres(), split across the threads
+// of the JobSystem. sphereList holds the world bounds of every object, and lodIndexList the
+// level of every object, updated in place for the visible ones. getLODList(objectIndex)
+// returns the MeshLOD list of the mesh an object is drawn with.
+template <class Func>
+void ParallelSelectLODs(
+    const LODSettings& settings,
+    const BoundingSphereList& sphereList,
+    Span<const uint32_t> visibleIndexList,
+    Span<uint8_t> lodIndexList,
+    Func&& getLODList)
+{
+    ParallelFor(visibleIndexList.size(), 1024,
+        [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                uint32_t objectIndex = visibleIndexList[i];
+                lodIndexList[objectIndex] = static_cast<uint8_t>(SelectLOD(
+                    settings,
+                    getLODList(objectIndex),
+                    sphereList.Get(objectIndex),
+                    lodIndexList[objectIndex]));
+            }
+        });
+}
+
+} // namespace noon
+
+#endif // NOON_MESH_LOD_HPP
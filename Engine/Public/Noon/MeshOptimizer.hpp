@@ -0,0 +1,76 @@
+#ifndef NOON_MESH_OPTIMIZER_HPP
+#define NOON_MESH_OPTIMIZER_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/MeshLOD.hpp>
+#include <Noon/VertexFormat.hpp>
+
+#include <cfloat>
+#include <cstdint>
+
+namespace noon {
+
+// Post-transform vertex cache statistics of a triangle list, simulated with a FIFO cache
+struct VertexCacheStats
+{
+    // Average Cache Miss Ratio, vertices transformed per triangle. 0.5 is ideal for large
+    // regular grids, 3.0 is the worst case.
+    float ACMR;
+
+    // Average Transformed to Vertex Ratio, 1.0 is ideal
+    float ATVR;
+
+}; // struct VertexCacheStats
+
+NOON_API
+VertexCacheStats AnalyzeVertexCache(Span<const uint32_t> indexList, size_t vertexCount, uint32_t cacheSize = 16);
+
+// Reorder triangles to reuse recently transformed vertices, using Tom Forsyth's
+// "Linear-Speed Vertex Cache Optimisation"
+NOON_API
+void OptimizeVertexCache(Span<uint32_t> indexList, size_t vertexCount);
+
+// Reorder clusters of triangles so those facing outwards are drawn first, reducing overdraw.
+// Should follow OptimizeVertexCache(), clusters are only split where the cache efficiency
+// would drop by less than threshold.
+NOON_API
+void OptimizeOverdraw(Span<uint32_t> indexList, const List<Vec3>& positionList, float threshold = 1.05f);
+
+// Reorder vertices in the order they are first used, and remove unused vertices, so vertex
+// fetches are sequential
+NOON_API
+void OptimizeVertexFetch(Span<uint32_t> indexList, VertexData& vertexData);
+
+// Run all of the above, and log the cache efficiency before and after
+NOON_API
+void OptimizeMesh(VertexData& vertexData, Span<uint32_t> indexList);
+
+// Reduce a triangle list by collapsing edges in order of the error they add, as measured by
+// Garland and Heckbert's "Surface Simplification Using Quadric Error Metrics". Vertices only
+// move onto other vertices, so the result indexes the same vertices.
+//
+// Vertices sharing a position but not their other attributes, along UV and normal seams, are
+// collapsed in pairs along the seam or not at all, and open borders only collapse along
+// themselves, so neither tears or drifts. Stops once there are at most targetIndexCount
+// indices, or when the next collapse would exceed maxError. Errors are relative to the radius
+// of BoundingSphere::FromPoints() of positionList, and resultError is set to the largest one
+// of the result.
+NOON_API
+List<uint32_t> SimplifyMesh(
+    Span<const uint32_t> indexList,
+    const List<Vec3>& positionList,
+    size_t targetIndexCount,
+    float maxError = FLT_MAX,
+    float * resultError = nullptr);
+
+// Append levels of detail to indexList, each simplified from the previous one down to about
+// half its triangles and reordered with OptimizeVertexCache(), until there are maxLODCount
+// levels or the mesh can't be reduced much further. Returns every level, starting with the
+// full detail one that was indexList, with errors that add up from one level to the next.
+NOON_API
+List<MeshLOD> GenerateMeshLODs(List<uint32_t>& indexList, const List<Vec3>& positionList, uint32_t maxLODCount = MaxMeshLODCount);
+
+} // namespace noon
+
+#endif // NOON_MESH_OPTIMIZER_HPP
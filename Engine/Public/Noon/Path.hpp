@@ -2,6 +2,7 @@
 #define NOON_PATH_HPP
 
 #include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
 #include <Noon/String.hpp>
 
 #include <fmt/format.h>
@@ -171,6 +172,18 @@ private:
 NOON_API
 Path GetCurrentPath();
 
+// Returns false for directories, and for paths that don't exist
+NOON_API
+bool IsFile(const Path& path);
+
+// Directories listed in the ASSET_PATH environment variable, in search order
+NOON_API
+List<Path> GetAssetPathList();
+
+// Search the asset path list for a file, returns an empty path if it cannot be found
+NOON_API
+Path FindAssetFile(const Path& filename);
+
 } // namespace noon
 
 template<>
@@ -48,6 +48,18 @@
 
 #endif
 
+#if defined(_M_X64) || defined(__x86_64__)
+
+    // x86-64, SSE2 is always available
+    #define NOON_ARCH_X64
+
+#elif defined(_M_ARM64) || defined(__aarch64__)
+
+    // ARM64, NEON is always available
+    #define NOON_ARCH_ARM64
+
+#endif
+
 #if defined(NDEBUG)
 
     #define NOON_BUILD_RELEASE
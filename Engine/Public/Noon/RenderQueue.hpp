@@ -0,0 +1,90 @@
+#ifndef NOON_RENDER_QUEUE_HPP
+#define NOON_RENDER_QUEUE_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/Math.hpp>
+#include <Noon/ShaderInstance.hpp>
+
+#include <glad/vulkan.h>
+
+namespace noon {
+
+class Mesh;
+
+template <class T>
+class AssetHandle;
+
+// Collects the objects drawn in a frame, and draws every instance of the same mesh with a
+// single instanced draw call. Per-instance data is read from a storage buffer by
+// gl_InstanceIndex, so nothing has to be bound between instances.
+class NOON_API RenderQueue
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(RenderQueue)
+
+    RenderQueue() = default;
+
+    ~RenderQueue() = default;
+
+    // The mesh must stay alive until the frame has been rendered. lod is the level of detail
+    // to draw, see SelectLOD(), and instances of each level are batched separately.
+    void Submit(Mesh * mesh, const Mat4& model, uint32_t lod = 0);
+
+    // Skipped until the mesh is resident, unless AssetManager has a fallback for meshes
+    void Submit(const AssetHandle<Mesh>& mesh, const Mat4& model, uint32_t lod = 0);
+
+    inline size_t GetInstanceCount() const {
+        return _instanceList.size();
+    }
+
+    // Only valid after Build()
+    inline size_t GetBatchCount() const {
+        return _batchList.size();
+    }
+
+    // Sort the instances into batches
+    void Build();
+
+    // Write the instance data in the order expected by Record(), instanceList must hold
+    // GetInstanceCount() elements
+    void WriteInstances(ShaderInstance * instanceList) const;
+
+    void Record(VkCommandBuffer commandBuffer);
+
+    void Clear();
+
+private:
+
+    struct Instance
+    {
+        Mesh * Owner;
+
+        uint32_t LOD;
+
+        ShaderInstance Data;
+
+    }; // struct Instance
+
+    struct Batch
+    {
+        Mesh * Owner;
+
+        uint32_t LOD;
+
+        uint32_t FirstInstance;
+
+        uint32_t InstanceCount;
+
+    }; // struct Batch
+
+    List<Instance> _instanceList;
+
+    List<Batch> _batchList;
+
+}; // class RenderQueue
+
+} // namespace noon
+
+#endif // NOON_RENDER_QUEUE_HPP
@@ -0,0 +1,46 @@
+#ifndef NOON_SAMPLER_HPP
+#define NOON_SAMPLER_HPP
+
+#include <Noon/Config.hpp>
+
+#include <glad/vulkan.h>
+
+#include <cstdint>
+
+namespace noon {
+
+// Everything that distinguishes one sampler from another, see GraphicsDriver::GetSampler().
+// The defaults are trilinear and anisotropic with wrapping, as for most material textures.
+struct SamplerDesc
+{
+    VkFilter MagFilter = VK_FILTER_LINEAR;
+
+    VkFilter MinFilter = VK_FILTER_LINEAR;
+
+    VkSamplerMipmapMode MipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+
+    VkSamplerAddressMode AddressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+
+    VkSamplerAddressMode AddressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+
+    // Clamped to what the device supports, 1 disables anisotropic filtering
+    uint32_t MaxAnisotropy = 16;
+
+    // Packs every field into 8 bits, which holds any core Vulkan value, so equal keys mean
+    // equal samplers
+    inline uint64_t GetKey() const {
+        return (
+            (uint64_t(MagFilter) << 0) |
+            (uint64_t(MinFilter) << 8) |
+            (uint64_t(MipmapMode) << 16) |
+            (uint64_t(AddressModeU) << 24) |
+            (uint64_t(AddressModeV) << 32) |
+            (uint64_t(MaxAnisotropy & 0xFF) << 40)
+        );
+    }
+
+}; // struct SamplerDesc
+
+} // namespace noon
+
+#endif // NOON_SAMPLER_HPP
@@ -0,0 +1,38 @@
+#ifndef NOON_SHADER_HPP
+#define NOON_SHADER_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+
+#include <glad/vulkan.h>
+
+#include <cstdint>
+
+namespace noon {
+
+// A shader module created from SPIR-V, such as an AssetType::Shader. Modules can be created on
+// any thread, so shaders are ready as soon as they are loaded.
+class NOON_API Shader
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(Shader)
+
+    // Throws if the module can't be created
+    Shader(Span<const uint32_t> code);
+
+    ~Shader();
+
+    inline VkShaderModule GetModule() const {
+        return _vkShaderModule;
+    }
+
+private:
+
+    VkShaderModule _vkShaderModule = VK_NULL_HANDLE;
+
+}; // class Shader
+
+} // namespace noon
+
+#endif // NOON_SHADER_HPP
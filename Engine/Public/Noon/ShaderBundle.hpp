@@ -0,0 +1,81 @@
+#ifndef NOON_SHADER_BUNDLE_HPP
+#define NOON_SHADER_BUNDLE_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/MappedFile.hpp>
+#include <Noon/String.hpp>
+
+#include <cstdint>
+
+namespace noon {
+
+// A memory-mapped pack of every compiled shader for one target, as written by
+// Scripts/pack-shaders.py. Shader code is returned as views into the mapping.
+class NOON_API ShaderBundle
+{
+public:
+
+    static constexpr uint32_t Magic = 0x4248534E; // "NSHB"
+
+    static constexpr uint32_t FormatVersion = 1;
+
+    // The first word of every SPIR-V module
+    static constexpr uint32_t SPIRVMagic = 0x07230203;
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(ShaderBundle)
+
+    ShaderBundle() = default;
+
+    // Validates every entry against the size of the file, so nothing needs to be checked again
+    // when shaders are found
+    bool Open(const Path& path);
+
+    void Close();
+
+    inline bool IsOpen() const {
+        return _file.IsOpen();
+    }
+
+    inline const Path& GetPath() const {
+        return _file.GetPath();
+    }
+
+    size_t GetShaderCount() const;
+
+    // Find the SPIR-V for a shader by name, e.g. "Default.vert"
+    // Returns an empty span if the bundle has no such shader
+    Span<const uint32_t> FindShader(StringView name) const;
+
+private:
+
+    struct Header
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t EntryCount;
+        uint32_t Reserved;
+    };
+
+    // Entries are sorted by NameHash
+    struct Entry
+    {
+        uint64_t NameHash;
+        uint32_t NameOffset;
+        uint32_t NameLength;
+        uint64_t DataOffset;
+        uint64_t DataSize;
+    };
+
+    static_assert(sizeof(Header) == 16);
+    static_assert(sizeof(Entry) == 32);
+
+    MappedFile _file;
+
+    const Entry * _entryList = nullptr;
+
+}; // class ShaderBundle
+
+} // namespace noon
+
+#endif // NOON_SHADER_BUNDLE_HPP
\ No newline at end of file
@@ -0,0 +1,31 @@
+#ifndef NOON_SHADER_INSTANCE_HPP
+#define NOON_SHADER_INSTANCE_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Math.hpp>
+
+namespace noon {
+
+// One element of the instance storage buffer, indexed by gl_InstanceIndex
+struct ShaderInstance
+{
+public:
+
+    static const unsigned Binding = 2;
+
+    // The first three rows of the model matrix, the last is always (0, 0, 0, 1)
+    alignas(16) Vec4 Model[3];
+
+    static inline ShaderInstance FromMatrix(const Mat4& model) {
+        ShaderInstance instance;
+        for (int row = 0; row < 3; ++row) {
+            instance.Model[row] = Vec4(model[0][row], model[1][row], model[2][row], model[3][row]);
+        }
+        return instance;
+    }
+
+}; // struct ShaderInstance
+
+} // namespace noon
+
+#endif // NOON_SHADER_INSTANCE_HPP
@@ -0,0 +1,47 @@
+#ifndef NOON_SHADER_MATERIAL_HPP
+#define NOON_SHADER_MATERIAL_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Math.hpp>
+
+namespace noon {
+
+// Matches the uniform block in Material.inc.glsl, which follows glTF's metallic-roughness
+// material. The defaults are glTF's.
+struct ShaderMaterial
+{
+public:
+
+    // Materials have a descriptor set of their own, after the one for globals, view and
+    // instances, holding this block and then the five texture maps in order
+    static const unsigned Set = 1;
+
+    static const unsigned Binding = 0;
+
+    static const unsigned BaseColorMapBinding = 1;
+
+    static const unsigned NormalMapBinding = 2;
+
+    static const unsigned MetallicRoughnessMapBinding = 3;
+
+    static const unsigned EmissiveMapBinding = 4;
+
+    static const unsigned OcclusionMapBinding = 5;
+
+    alignas(16) Vec4 BaseColorFactor = Vec4(1.0f);
+
+    alignas(16) Vec3 EmissiveFactor = Vec3(0.0f);
+
+    alignas(4) float MetallicFactor = 1.0f;
+
+    alignas(4) float RoughnessFactor = 1.0f;
+
+    alignas(4) float OcclusionStrength = 1.0f;
+
+    alignas(4) float NormalScale = 1.0f;
+
+}; // struct ShaderMaterial
+
+} // namespace noon
+
+#endif // NOON_SHADER_MATERIAL_HPP
@@ -0,0 +1,22 @@
+#ifndef NOON_SHADER_MESH_HPP
+#define NOON_SHADER_MESH_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Math.hpp>
+
+namespace noon {
+
+// Push constants, quantized positions are decoded as a_Position * PositionScale + PositionOffset
+struct ShaderMesh
+{
+public:
+
+    alignas(16) Vec4 PositionScale;
+
+    alignas(16) Vec4 PositionOffset;
+
+}; // struct ShaderMesh
+
+} // namespace noon
+
+#endif // NOON_SHADER_MESH_HPP
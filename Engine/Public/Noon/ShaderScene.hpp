@@ -0,0 +1,145 @@
+#ifndef NOON_SHADER_SCENE_HPP
+#define NOON_SHADER_SCENE_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Math.hpp>
+
+#include <glad/vulkan.h>
+
+#include <cstdint>
+
+namespace noon {
+
+// The storage buffers of a GPUScene, see Scene.inc.glsl and Cull.comp.glsl
+
+enum ShaderSceneObjectFlags : uint32_t
+{
+    // Removed objects stay in the buffer until their slot is reused, and are never drawn
+    SceneObjectActive = 1 << 0,
+
+}; // enum ShaderSceneObjectFlags
+
+struct ShaderSceneObject
+{
+public:
+
+    static const unsigned Binding = 0;
+
+    // The first three rows of the model matrix, the last is always (0, 0, 0, 1)
+    alignas(16) Vec4 Model[3];
+
+    alignas(4) uint32_t MeshIndex;
+
+    alignas(4) uint32_t Flags;
+
+    alignas(4) uint32_t Padding[2];
+
+}; // struct ShaderSceneObject
+
+struct ShaderSceneMesh
+{
+public:
+
+    static const unsigned Binding = 1;
+
+    // Center and radius in object space
+    alignas(16) Vec4 BoundingSphere;
+
+    // See ShaderMesh
+    alignas(16) Vec4 PositionScale;
+
+    alignas(16) Vec4 PositionOffset;
+
+    // Where the mesh is in the scene's shared vertex and index buffers
+
+    alignas(4) uint32_t IndexCount;
+
+    alignas(4) uint32_t FirstIndex;
+
+    alignas(4) int32_t VertexOffset;
+
+    // Levels in the LOD buffer, starting at the index of the mesh times MaxMeshLODCount. The
+    // first is the same range as IndexCount and FirstIndex.
+    alignas(4) uint32_t LODCount;
+
+}; // struct ShaderSceneMesh
+
+// See MeshLOD, FirstIndex is in the scene's shared index buffer
+struct ShaderSceneLOD
+{
+public:
+
+    static const unsigned Binding = 4;
+
+    alignas(4) uint32_t FirstIndex;
+
+    alignas(4) uint32_t IndexCount;
+
+    alignas(4) float Error;
+
+    alignas(4) uint32_t Padding;
+
+}; // struct ShaderSceneLOD
+
+// Matches VkDrawIndexedIndirectCommand, written by the culling pass
+struct ShaderSceneDraw
+{
+public:
+
+    static const unsigned Binding = 2;
+
+    uint32_t IndexCount;
+
+    uint32_t InstanceCount;
+
+    uint32_t FirstIndex;
+
+    int32_t VertexOffset;
+
+    uint32_t FirstInstance;
+
+}; // struct ShaderSceneDraw
+
+// Two uint32_t, the number of draws written by the culling pass and the indices they draw
+static const unsigned ShaderSceneDrawCountBinding = 3;
+
+// A uint32_t per object, the level of detail it was last drawn with, kept across frames
+static const unsigned ShaderSceneObjectLODBinding = 5;
+
+// Push constants of the culling pass
+struct ShaderCull
+{
+public:
+
+    // Normalized, pointing inwards, in the order left, right, bottom, top, near, far
+    alignas(16) Vec4 FrustumPlanes[6];
+
+    // The camera position, and GetLODScale() over the threshold in w, or 0 to draw every
+    // object at full detail. See SelectLOD(), which the culling pass matches.
+    alignas(16) Vec4 LODCamera;
+
+    alignas(4) uint32_t ObjectCount;
+
+    // Cull against FrustumPlanes, otherwise every active object is drawn
+    alignas(4) uint32_t FrustumCulling;
+
+    // Write the visible draws to the front of the buffer, to be drawn with a draw count,
+    // otherwise every object has its own draw with an InstanceCount of 0 or 1
+    alignas(4) uint32_t Compact;
+
+    // See LODSettings::Hysteresis
+    alignas(4) float LODHysteresis;
+
+}; // struct ShaderCull
+
+static_assert(sizeof(ShaderSceneObject) == 64);
+static_assert(sizeof(ShaderSceneMesh) == 64);
+static_assert(sizeof(ShaderSceneLOD) == 16);
+static_assert(sizeof(ShaderSceneDraw) == sizeof(VkDrawIndexedIndirectCommand));
+
+// The minimum maxPushConstantsSize
+static_assert(sizeof(ShaderCull) <= 128);
+
+} // namespace noon
+
+#endif // NOON_SHADER_SCENE_HPP
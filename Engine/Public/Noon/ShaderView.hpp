@@ -1,27 +1,27 @@
-#ifndef NOON_SHADER_TRANSFORM_HPP
-#define NOON_SHADER_TRANSFORM_HPP
+#ifndef NOON_SHADER_VIEW_HPP
+#define NOON_SHADER_VIEW_HPP
 
 #include <Noon/Config.hpp>
 #include <Noon/Math.hpp>
 
 namespace noon {
 
-struct ShaderTransform
+struct ShaderView
 {
 public:
 
     static const unsigned Binding = 1;
 
-    alignas(64) Mat4 Model;
-
     alignas(64) Mat4 View;
 
     alignas(64) Mat4 Projection;
 
-    alignas(64) Mat4 MVP;
+    alignas(64) Mat4 ViewProjection;
+
+    alignas(16) Vec4 CameraPosition;
 
-}; // struct ShaderTransform
+}; // struct ShaderView
 
 } // namespace noon
 
-#endif // NOON_SHADER_TRANSFORM_HPP
\ No newline at end of file
+#endif // NOON_SHADER_VIEW_HPP
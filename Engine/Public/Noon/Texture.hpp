@@ -0,0 +1,123 @@
+#ifndef NOON_TEXTURE_HPP
+#define NOON_TEXTURE_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/GraphicsDriver.hpp>
+#include <Noon/KTX2.hpp>
+#include <Noon/TextureFormat.hpp>
+
+#include <cstdint>
+
+namespace noon {
+
+// A sampled 2D image with its mip chain, uploaded through a staging buffer and ready to read in
+// shaders once constructed
+class NOON_API Texture
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(Texture)
+
+    // levelList holds the tightly packed texels or blocks of each mip level, largest first.
+    // When there is only one level and generateMipmaps is set, the rest of the chain is blitted
+    // on the GPU, which block-compressed formats can't be, so they should come with theirs.
+    Texture(
+        VkFormat format,
+        uint32_t width,
+        uint32_t height,
+        Span<const Span<const uint8_t>> levelList,
+        bool generateMipmaps = true,
+        MemoryPool memoryPool = MemoryPool::Default);
+
+    // Uploads the payload as it is, without transcoding
+    Texture(const KTX2File& file, MemoryPool memoryPool = MemoryPool::Default);
+
+    // Creates the image without contents, in VK_IMAGE_LAYOUT_UNDEFINED, for the caller to fill
+    // and transition to layout. It can be copied to and from, and is shared between the queue
+    // families in GraphicsDriver::GetSharedQueueFamilyIndexList(), see TextureStreamer.
+    Texture(
+        VkFormat format,
+        uint32_t width,
+        uint32_t height,
+        uint32_t levelCount,
+        VkImageLayout layout,
+        MemoryPool memoryPool = MemoryPool::Default);
+
+    ~Texture();
+
+    inline VkFormat GetFormat() const {
+        return _vkFormat;
+    }
+
+    inline uint32_t GetWidth() const {
+        return _width;
+    }
+
+    inline uint32_t GetHeight() const {
+        return _height;
+    }
+
+    inline uint32_t GetLevelCount() const {
+        return _levelCount;
+    }
+
+    // Device memory used, including alignment
+    inline VkDeviceSize GetMemorySize() const {
+        return _memorySize;
+    }
+
+    inline VkImage GetImage() const {
+        return _vkImage;
+    }
+
+    inline VkImageView GetImageView() const {
+        return _vkImageView;
+    }
+
+    // The layout every level is in when sampled
+    inline VkImageLayout GetImageLayout() const {
+        return _vkImageLayout;
+    }
+
+    inline VkDescriptorImageInfo GetDescriptorImageInfo(VkSampler sampler) const {
+        return VkDescriptorImageInfo{
+            .sampler = sampler,
+            .imageView = _vkImageView,
+            .imageLayout = _vkImageLayout,
+        };
+    }
+
+private:
+
+    void CreateImage(VkImageUsageFlags imageUsageFlags, bool shared);
+
+    bool CanGenerateMipmaps() const;
+
+    void Upload(Span<const Span<const uint8_t>> levelList, bool generateMipmaps);
+
+    VkFormat _vkFormat;
+
+    uint32_t _width;
+
+    uint32_t _height;
+
+    uint32_t _levelCount;
+
+    MemoryPool _memoryPool;
+
+    VkImageLayout _vkImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkDeviceSize _memorySize = 0;
+
+    VkImage _vkImage = VK_NULL_HANDLE;
+
+    VmaAllocation _vmaAllocation = VK_NULL_HANDLE;
+
+    VkImageView _vkImageView = VK_NULL_HANDLE;
+
+}; // class Texture
+
+} // namespace noon
+
+#endif // NOON_TEXTURE_HPP
@@ -0,0 +1,30 @@
+#ifndef NOON_TEXTURE_FORMAT_HPP
+#define NOON_TEXTURE_FORMAT_HPP
+
+#include <Noon/Config.hpp>
+
+#include <glad/vulkan.h>
+
+#include <cstdint>
+
+namespace noon {
+
+// Block-compressed formats store 4x4 texels per block, which must be padded out at the edges
+NOON_API
+bool IsBlockCompressedFormat(VkFormat format);
+
+// Bytes per block, or per texel when uncompressed, returns 0 for formats textures can't use
+NOON_API
+uint32_t GetTextureFormatBlockSize(VkFormat format);
+
+// Bytes of one tightly packed mip level
+NOON_API
+uint64_t GetTextureLevelSize(VkFormat format, uint32_t width, uint32_t height);
+
+// A full mip chain, down to 1x1
+NOON_API
+uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+
+} // namespace noon
+
+#endif // NOON_TEXTURE_FORMAT_HPP
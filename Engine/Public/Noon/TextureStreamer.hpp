@@ -0,0 +1,308 @@
+#ifndef NOON_TEXTURE_STREAMER_HPP
+#define NOON_TEXTURE_STREAMER_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/AsyncIO.hpp>
+#include <Noon/KTX2.hpp>
+#include <Noon/Path.hpp>
+#include <Noon/Texture.hpp>
+
+#include <glad/vulkan.h>
+
+NOON_DISABLE_WARNINGS()
+
+    #include <vk_mem_alloc.h>
+
+NOON_ENABLE_WARNINGS()
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <utility>
+
+namespace noon {
+
+using StreamedTextureID = uint32_t;
+
+constexpr StreamedTextureID InvalidStreamedTextureID = 0;
+
+struct TextureStreamingStats
+{
+    // Every image the streamer owns, including ones being replaced or waiting for in-flight
+    // frames to finish with them
+    VkDeviceSize ResidentBytes;
+
+    // Staging memory held by reads and copies in progress
+    VkDeviceSize StagingBytes;
+
+    uint32_t TextureCount;
+
+    // Textures with a read or copy in progress
+    uint32_t PendingCount;
+
+    uint64_t LevelsLoaded;
+
+    uint64_t LevelsEvicted;
+
+}; // struct TextureStreamingStats
+
+// Keeps the mip levels of KTX2 textures resident according to how they are seen on screen,
+// under a memory budget.
+//
+// A texture starts out with only its smallest levels, up to GetMinResidentSize() pixels, which
+// are always kept. Each frame, the level each texture is sampled at is reported, either from
+// a feedback pass or a distance heuristic, and Update() streams finer levels in or evicts the
+// ones no longer needed. Changing levels replaces the texture with a new image holding
+// [level, levelCount); the levels both images hold are copied on the GPU, and only the new
+// ones are read from disk, through AsyncIO straight into a staging buffer. Copies run on the
+// transfer queue, and nothing waits on the GPU except when shutting down.
+//
+// Streamed images stay in VK_IMAGE_LAYOUT_GENERAL, so the transfer queue can copy from an
+// image while frames in flight are still sampling it. Block-compressed images have no
+// compression metadata, so this costs nothing for them.
+class NOON_API TextureStreamer
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(TextureStreamer)
+
+    static TextureStreamer * GetInstance() {
+        return _Instance;
+    }
+
+    // Requires an AsyncIO and a GraphicsDriver
+    TextureStreamer();
+
+    // Waits for every read and copy in progress
+    ~TextureStreamer();
+
+    inline VkDeviceSize GetMemoryBudget() const {
+        return _memoryBudget;
+    }
+
+    // When the resident levels exceed this, the finest levels of the least needed textures
+    // are evicted, and none are streamed in that wouldn't fit
+    inline void SetMemoryBudget(VkDeviceSize budget) {
+        _memoryBudget = budget;
+    }
+
+    inline uint32_t GetMinResidentSize() const {
+        return _minResidentSize;
+    }
+
+    // Levels this size or smaller are loaded when a texture is added and never evicted, only
+    // affects textures added afterwards
+    inline void SetMinResidentSize(uint32_t size) {
+        _minResidentSize = size;
+    }
+
+    inline uint32_t GetMaxPendingCount() const {
+        return _maxPendingCount;
+    }
+
+    inline void SetMaxPendingCount(uint32_t count) {
+        _maxPendingCount = count;
+    }
+
+    inline VkDeviceSize GetMaxStagingBytes() const {
+        return _maxStagingBytes;
+    }
+
+    // Limits the reads in flight, and so how much is copied by the transfer queue per frame
+    inline void SetMaxStagingBytes(VkDeviceSize bytes) {
+        _maxStagingBytes = bytes;
+    }
+
+    inline uint32_t GetHysteresisFrameCount() const {
+        return _hysteresisFrameCount;
+    }
+
+    // How long a texture must be requested at a coarser level before its finer levels are
+    // evicted, so levels don't thrash as the camera moves back and forth
+    inline void SetHysteresisFrameCount(uint32_t count) {
+        _hysteresisFrameCount = count;
+    }
+
+    // Opens a KTX2 file from the asset path, whose index and smallest levels are then read in
+    // the background. Returns InvalidStreamedTextureID if the file can't be opened.
+    StreamedTextureID Add(const Path& filename);
+
+    void Remove(StreamedTextureID id);
+
+    // Ask for level and everything coarser to be resident, the finest level requested since
+    // the last Update() is used. Can be called from any thread, such as jobs reading back a
+    // feedback pass.
+    void RequestLevel(StreamedTextureID id, uint32_t level);
+
+    // Ask for the level that puts about one texel on each pixel, for a texture that covers
+    // up to screenSize pixels along its longest side
+    void RequestScreenSize(StreamedTextureID id, float screenSize);
+
+    // Finish loaded levels, evict and stream in according to what was requested, and free
+    // what in-flight frames have finished with. Should be called once per frame while Render()
+    // isn't running, as it replaces images.
+    void Update();
+
+    // nullptr until the smallest levels are resident. The texture is replaced whenever its
+    // resident levels change, so it's only valid until the next Update().
+    const Texture * GetTexture(StreamedTextureID id) const;
+
+    // The finest level resident, which is the texture's level 0, or the level count if none are
+    uint32_t GetResidentLevel(StreamedTextureID id) const;
+
+    TextureStreamingStats GetStats() const;
+
+private:
+
+    static TextureStreamer * _Instance;
+
+    enum class EntryState
+    {
+        // Reading the header and level index
+        Opening,
+
+        Idle,
+
+        // Reading new levels into the staging buffer
+        Reading,
+
+        // Waiting for the copies into the new image to finish
+        Copying,
+
+        // Unable to be read, the texture keeps what it has
+        Failed,
+
+    }; // enum class EntryState
+
+    struct Entry
+    {
+        StreamedTextureID ID;
+
+        IOFile File;
+
+        EntryState State = EntryState::Opening;
+
+        bool Removed = false;
+
+        List<uint8_t> IndexData;
+
+        std::atomic<IOStatus> ReadStatus = IOStatus::Pending;
+
+        IORequestID ReadID = 0;
+
+        VkFormat Format = VK_FORMAT_UNDEFINED;
+
+        uint32_t Width = 0;
+
+        uint32_t Height = 0;
+
+        uint32_t LevelCount = 0;
+
+        // The coarsest level that is streamed, the ones after it are always resident
+        uint32_t TailLevel = 0;
+
+        List<KTX2File::LevelIndex> LevelIndexList;
+
+        // Holds [ResidentLevel, LevelCount)
+        std::unique_ptr<Texture> ResidentTexture;
+
+        uint32_t ResidentLevel = 0;
+
+        // The finest level requested since the last Update(), or UINT32_MAX
+        std::atomic<uint32_t> RequestedLevel = UINT32_MAX;
+
+        // The finest level wanted, which only gets coarser after the hysteresis
+        uint32_t TargetLevel = 0;
+
+        uint64_t TargetFrameIndex = 0;
+
+        // The new image and what is needed to fill it, while Reading or Copying
+        std::unique_ptr<Texture> PendingTexture;
+
+        uint32_t PendingLevel = 0;
+
+        VkBuffer StagingBuffer = VK_NULL_HANDLE;
+
+        VmaAllocation StagingAllocation = VK_NULL_HANDLE;
+
+        VkDeviceSize StagingSize = 0;
+
+        uint64_t StagingFileOffset = 0;
+
+    }; // struct Entry
+
+    // The copies of every texture that finished reading in the same Update()
+    struct Batch
+    {
+        VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+
+        VkFence Fence = VK_NULL_HANDLE;
+
+        List<Entry *> EntryList;
+
+    }; // struct Batch
+
+    // Batches in flight at once, Update() submits nothing while they all are
+    static constexpr uint32_t BatchCount = 4;
+
+    // Bytes used by [level, LevelCount), without alignment
+    static VkDeviceSize GetLevelRangeSize(const Entry * entry, uint32_t level);
+
+    void FinishOpening(Entry * entry);
+
+    void UpdateTargetLevel(Entry * entry);
+
+    // Create the new image, and start reading the levels the old one doesn't have. Entries
+    // with nothing to read are added to readyList.
+    bool BeginChange(Entry * entry, uint32_t level, List<Entry *>& readyList);
+
+    void SubmitCopies(List<Entry *>& readyList);
+
+    void RecordCopies(VkCommandBuffer commandBuffer, Entry * entry);
+
+    void FinishBatch(Batch& batch);
+
+    void DestroyStaging(Entry * entry);
+
+    // Bytes the eviction callback was asked for since the last Update()
+    std::atomic<VkDeviceSize> _evictionRequestBytes = 0;
+
+    unsigned _memoryEvictionCallbackId = 0;
+
+    VkDeviceSize _memoryBudget = 512 * 1024 * 1024;
+
+    uint32_t _minResidentSize = 64;
+
+    uint32_t _maxPendingCount = 16;
+
+    VkDeviceSize _maxStagingBytes = 64 * 1024 * 1024;
+
+    uint32_t _hysteresisFrameCount = 60;
+
+    uint64_t _frameIndex = 0;
+
+    StreamedTextureID _nextID = 1;
+
+    // Guards the map for RequestLevel(), which can come from other threads
+    mutable std::shared_mutex _mutex;
+
+    Map<StreamedTextureID, std::unique_ptr<Entry>> _entryMap;
+
+    // Replaced textures, with the frame they were replaced on
+    List<std::pair<uint64_t, std::unique_ptr<Texture>>> _retiredList;
+
+    Array<Batch, BatchCount> _batchList;
+
+    uint64_t _levelsLoaded = 0;
+
+    uint64_t _levelsEvicted = 0;
+
+    VkCommandPool _vkCommandPool = VK_NULL_HANDLE;
+
+}; // class TextureStreamer
+
+} // namespace noon
+
+#endif // NOON_TEXTURE_STREAMER_HPP
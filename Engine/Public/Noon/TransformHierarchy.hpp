@@ -0,0 +1,157 @@
+#ifndef NOON_TRANSFORM_HIERARCHY_HPP
+#define NOON_TRANSFORM_HIERARCHY_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/Culling.hpp>
+#include <Noon/Math.hpp>
+
+#include <cstdint>
+#include <limits>
+
+namespace noon {
+
+// Identifies a node for as long as it exists, and indexes per-node data kept elsewhere, such
+// as the bounds passed to TransformBounds()
+using TransformHandle = uint32_t;
+
+constexpr TransformHandle InvalidTransformHandle = std::numeric_limits<uint32_t>::max();
+
+// A scene graph of local transforms, stored as structure-of-arrays sorted by depth, with the
+// children of each node stored next to each other. World matrices are only recomputed for
+// nodes that changed and their descendants, one level at a time, so that each parent is
+// finished before its children read it, and the nodes of a level can be updated in parallel.
+class NOON_API TransformHierarchy
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(TransformHierarchy)
+
+    TransformHierarchy() = default;
+
+    ~TransformHierarchy() = default;
+
+    TransformHandle Add(TransformHandle parent = InvalidTransformHandle);
+
+    // Removes the node and all of its descendants
+    void Remove(TransformHandle handle);
+
+    inline bool IsValid(TransformHandle handle) const {
+        return (handle < _nodeIndexList.size() && _nodeIndexList[handle] != InvalidIndex);
+    }
+
+    inline size_t GetCount() const {
+        return _nodeIndexList.size() - _freeHandleList.size();
+    }
+
+    // One past the highest handle in use, the size needed by lists indexed by handle
+    inline size_t GetHandleCount() const {
+        return _nodeIndexList.size();
+    }
+
+    TransformHandle GetParent(TransformHandle handle) const;
+
+    // The node keeps its local transform, throws if the parent is one of its descendants
+    void SetParent(TransformHandle handle, TransformHandle parent);
+
+    inline const Vec3& GetLocalPosition(TransformHandle handle) const {
+        return _positionList[_nodeIndexList[handle]];
+    }
+
+    void SetLocalPosition(TransformHandle handle, const Vec3& position);
+
+    inline const Quat& GetLocalRotation(TransformHandle handle) const {
+        return _rotationList[_nodeIndexList[handle]];
+    }
+
+    void SetLocalRotation(TransformHandle handle, const Quat& rotation);
+
+    inline const Vec3& GetLocalScale(TransformHandle handle) const {
+        return _scaleList[_nodeIndexList[handle]];
+    }
+
+    void SetLocalScale(TransformHandle handle, const Vec3& scale);
+
+    void SetLocalTransform(TransformHandle handle, const Vec3& position, const Quat& rotation, const Vec3& scale);
+
+    // Only valid after Update()
+    inline const Mat4& GetWorldMatrix(TransformHandle handle) const {
+        return _worldMatrixList[_nodeIndexList[handle]];
+    }
+
+    // Recompute the world matrices of the nodes that changed since the last call, and their
+    // descendants. Structural changes re-sort the whole hierarchy first.
+    void Update();
+
+    // The nodes whose world matrix was recomputed by the last call to Update(), so the stages
+    // that consume them only need to look at what changed
+    inline Span<const TransformHandle> GetChangedList() const {
+        return _changedList;
+    }
+
+    // Transform the local bounds of the nodes changed by the last Update() into worldBounds.
+    // Both lists are indexed by handle, and worldBounds is grown to GetHandleCount().
+    void TransformBounds(const BoundingSphereList& localBounds, BoundingSphereList& worldBounds) const;
+
+private:
+
+    static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+    void MarkDirty(uint32_t index);
+
+    // Order the nodes breadth first, so each level is contiguous, as are the children of each
+    // node, then rebuild everything indexed by position
+    void Sort();
+
+    // Recompute the world matrices of the nodes at the given positions, which must all be in
+    // the same level
+    void UpdateWorldMatrices(const uint32_t * indexList, size_t count);
+
+    // Indexed by handle
+
+    List<uint32_t> _nodeIndexList;
+
+    List<TransformHandle> _parentHandleList;
+
+    List<TransformHandle> _freeHandleList;
+
+    // Indexed by position in the sorted order
+
+    List<TransformHandle> _handleList;
+
+    List<uint32_t> _parentIndexList;
+
+    List<uint32_t> _firstChildList;
+
+    List<uint32_t> _childCountList;
+
+    List<Vec3> _positionList;
+
+    List<Quat> _rotationList;
+
+    List<Vec3> _scaleList;
+
+    List<Mat4> _worldMatrixList;
+
+    // Set while the node is in _dirtyHandleList
+    List<uint8_t> _dirtyList;
+
+    // The value of _updateStamp when the node was last updated
+    List<uint32_t> _updateStampList;
+
+    // The first position of each level, followed by the number of nodes
+    List<uint32_t> _levelStartList;
+
+    List<TransformHandle> _dirtyHandleList;
+
+    List<TransformHandle> _changedList;
+
+    uint32_t _updateStamp = 0;
+
+    bool _needsSort = false;
+
+}; // class TransformHierarchy
+
+} // namespace noon
+
+#endif // NOON_TRANSFORM_HIERARCHY_HPP
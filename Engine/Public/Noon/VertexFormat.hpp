@@ -0,0 +1,184 @@
+#ifndef NOON_VERTEX_FORMAT_HPP
+#define NOON_VERTEX_FORMAT_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/Math.hpp>
+#include <Noon/ShaderMesh.hpp>
+#include <Noon/String.hpp>
+
+#include <glad/vulkan.h>
+
+#include <cstdint>
+
+namespace noon {
+
+// Matches the locations in VertexAttributes.inc.glsl
+enum class VertexAttribute
+{
+    Position,
+    Normal,
+    Tangent,
+    Color,
+    TexCoord1,
+    TexCoord2,
+    Joints,
+    Weights,
+
+}; // enum class VertexAttribute
+
+constexpr size_t VertexAttributeCount = 8;
+
+NOON_API
+String VertexAttributeToString(VertexAttribute attribute);
+
+enum class VertexEncoding
+{
+    // Not stored, the shader reads a default value instead
+    None,
+
+    Float32,
+
+    Float16,
+
+    // Positions are stored relative to the mesh's bounds, and rescaled by the shader
+    Snorm16,
+
+    Unorm16,
+
+    Snorm8,
+
+    Unorm8,
+
+    Uint32,
+
+    Uint16,
+
+    Uint8,
+
+    // Unit vectors folded onto an octahedron and stored in two components, the sign of
+    // an octahedral tangent's bitangent is stored in the position's w
+    Octahedral16,
+
+    Octahedral8,
+
+}; // enum class VertexEncoding
+
+NOON_API
+String VertexEncodingToString(VertexEncoding encoding);
+
+// Full precision vertex data, as loaded from a model
+struct VertexData
+{
+    List<Vec3> Positions;
+
+    List<Vec3> Normals;
+
+    // The w component holds the sign of the bitangent
+    List<Vec4> Tangents;
+
+    List<Vec4> Colors;
+
+    List<Vec2> TexCoords1;
+
+    List<Vec2> TexCoords2;
+
+    List<Vec4u> Joints;
+
+    List<Vec4> Weights;
+
+    inline size_t GetVertexCount() const {
+        return Positions.size();
+    }
+
+}; // struct VertexData
+
+// Values of the specialization constants in VertexAttributes.inc.glsl
+struct VertexSpecialization
+{
+    VkBool32 OctahedralNormal;
+
+    VkBool32 OctahedralTangent;
+
+}; // struct VertexSpecialization
+
+// The interleaved layout of one vertex, attributes are packed in order on 4 byte boundaries
+class NOON_API VertexFormat
+{
+public:
+
+    // The binding interleaved vertices are read from
+    static const uint32_t VertexBinding = 0;
+
+    // The binding absent attributes are read from, with a stride of 0
+    static const uint32_t DefaultBinding = 1;
+
+    // Every attribute at the precision declared by VertexAttributes.inc.glsl
+    static VertexFormat FullPrecision();
+
+    // The smallest encodings that represent the data without visible loss
+    static VertexFormat Choose(const VertexData& vertexData);
+
+    // One vertex of FullPrecision(), holding the value of each attribute when it is absent
+    static List<uint8_t> GetDefaultVertex();
+
+    VertexFormat();
+
+    inline VertexEncoding GetEncoding(VertexAttribute attribute) const {
+        return _encodingList[static_cast<size_t>(attribute)];
+    }
+
+    // Throws if the encoding can't represent the attribute
+    void SetEncoding(VertexAttribute attribute, VertexEncoding encoding);
+
+    inline bool HasAttribute(VertexAttribute attribute) const {
+        return (GetEncoding(attribute) != VertexEncoding::None);
+    }
+
+    inline uint32_t GetOffset(VertexAttribute attribute) const {
+        return _offsetList[static_cast<size_t>(attribute)];
+    }
+
+    VkFormat GetAttributeFormat(VertexAttribute attribute) const;
+
+    inline uint32_t GetStride() const {
+        return _stride;
+    }
+
+    uint64_t GetHash() const;
+
+    VertexSpecialization GetSpecialization() const;
+
+    Array<VkVertexInputBindingDescription, 2> GetBindingDescriptionList() const;
+
+    Array<VkVertexInputAttributeDescription, VertexAttributeCount> GetAttributeDescriptionList() const;
+
+    // Encodes the vertex data, and fills in how the shader should rescale the positions.
+    // Attributes not in the format are dropped.
+    List<uint8_t> Pack(const VertexData& vertexData, ShaderMesh * shaderMesh) const;
+
+    String ToString() const;
+
+    inline bool operator==(const VertexFormat& rhs) const {
+        return (_encodingList == rhs._encodingList);
+    }
+
+    inline bool operator!=(const VertexFormat& rhs) const {
+        return (_encodingList != rhs._encodingList);
+    }
+
+private:
+
+    void UpdateLayout();
+
+    Array<VertexEncoding, VertexAttributeCount> _encodingList;
+
+    Array<uint32_t, VertexAttributeCount> _offsetList;
+
+    uint32_t _stride = 0;
+
+}; // class VertexFormat
+
+} // namespace noon
+
+#endif // NOON_VERTEX_FORMAT_HPP
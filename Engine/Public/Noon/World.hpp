@@ -0,0 +1,412 @@
+#ifndef NOON_WORLD_HPP
+#define NOON_WORLD_HPP
+
+#include <Noon/Config.hpp>
+#include <Noon/Component.hpp>
+#include <Noon/Containers.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/String.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+namespace noon {
+
+struct Entity
+{
+    uint32_t Index = std::numeric_limits<uint32_t>::max();
+
+    // Incremented every time the index is reused, so stale entities can be detected
+    uint32_t Generation = 0;
+
+    inline bool operator==(const Entity& other) const {
+        return (Index == other.Index && Generation == other.Generation);
+    }
+
+}; // struct Entity
+
+constexpr Entity InvalidEntity = Entity{};
+
+// Every chunk is allocated with this size, regardless of its archetype
+constexpr size_t ChunkSize = 16 * 1024;
+
+struct Archetype;
+
+// The header at the start of each chunk. It is followed by the version of each component, the
+// entities, and then an array of each component. The offsets are stored in the Archetype.
+struct Chunk
+{
+    Archetype * Owner;
+
+    uint32_t Count;
+
+    // Position in Owner->ChunkList
+    uint32_t Index;
+
+}; // struct Chunk
+
+// Every entity with exactly the same set of components is stored in the same archetype.
+// Entities are packed so only the last chunk can have free space.
+struct NOON_API Archetype
+{
+    ComponentMask Mask;
+
+    List<ComponentTypeID> TypeList;
+
+    // The column of each component type in TypeList, or -1, indexed by ComponentTypeID
+    Array<int16_t, MaxComponentTypeCount> ColumnList;
+
+    // The offset of each column from the start of the chunk
+    List<uint32_t> OffsetList;
+
+    uint32_t VersionOffset;
+
+    uint32_t EntityOffset;
+
+    // The number of entities that fit in one chunk
+    uint32_t Capacity;
+
+    List<Chunk *> ChunkList;
+
+    // The archetypes with one component added or removed, filled as they are needed
+    Map<ComponentTypeID, Archetype *> AddEdgeMap;
+
+    Map<ComponentTypeID, Archetype *> RemoveEdgeMap;
+
+    inline uint32_t * GetVersionList(Chunk * chunk) const {
+        return reinterpret_cast<uint32_t *>(reinterpret_cast<uint8_t *>(chunk) + VersionOffset);
+    }
+
+    inline Entity * GetEntityList(Chunk * chunk) const {
+        return reinterpret_cast<Entity *>(reinterpret_cast<uint8_t *>(chunk) + EntityOffset);
+    }
+
+    inline uint8_t * GetColumn(Chunk * chunk, size_t column) const {
+        return reinterpret_cast<uint8_t *>(chunk) + OffsetList[column];
+    }
+
+}; // struct Archetype
+
+// Selects the archetypes that have every component in ReadMask and WriteMask, and none of the
+// components in ExcludeMask. Systems also use it to declare which components they access.
+struct NOON_API Query
+{
+    ComponentMask ReadMask;
+
+    ComponentMask WriteMask;
+
+    ComponentMask ExcludeMask;
+
+    template <class... Ts>
+    inline Query& Read() {
+        ReadMask |= MakeComponentMask<Ts...>();
+        return *this;
+    }
+
+    template <class... Ts>
+    inline Query& Write() {
+        WriteMask |= MakeComponentMask<Ts...>();
+        return *this;
+    }
+
+    template <class... Ts>
+    inline Query& Exclude() {
+        ExcludeMask |= MakeComponentMask<Ts...>();
+        return *this;
+    }
+
+    inline bool Matches(const ComponentMask& mask) const {
+        ComponentMask required = (ReadMask | WriteMask);
+        return ((mask & required) == required && (mask & ExcludeMask).none());
+    }
+
+    // Whether two systems with these queries can't run at the same time
+    inline bool ConflictsWith(const Query& other) const {
+        return (WriteMask & (other.ReadMask | other.WriteMask)).any()
+            || (ReadMask & other.WriteMask).any();
+    }
+
+}; // struct Query
+
+// Access to the components of one chunk, given to the callback of World::ForEachChunk()
+class NOON_API ChunkView
+{
+public:
+
+    ChunkView(Chunk * chunk, const Query& query, uint32_t version)
+        : _chunk(chunk)
+        , _archetype(chunk->Owner)
+        , _query(query)
+        , _version(version)
+    { }
+
+    inline size_t GetCount() const {
+        return _chunk->Count;
+    }
+
+    inline Span<const Entity> GetEntityList() const {
+        return { _archetype->GetEntityList(_chunk), _chunk->Count };
+    }
+
+    template <class T>
+    inline bool Has() const {
+        return (_archetype->ColumnList[GetComponentTypeID<T>()] >= 0);
+    }
+
+    template <class T>
+    inline Span<const T> Get() const {
+        int column = GetColumn(GetComponentTypeID<T>());
+        return { reinterpret_cast<const T *>(_archetype->GetColumn(_chunk, column)), _chunk->Count };
+    }
+
+    // Marks the component as changed for the whole chunk, throws if it isn't in the WriteMask
+    // of the query
+    template <class T>
+    inline Span<T> GetMutable() {
+        ComponentTypeID id = GetComponentTypeID<T>();
+        if (!_query.WriteMask.test(id)) {
+            throw Exception("Component '{}' was not declared as written by the query", GetComponentTypeInfo(id).Name);
+        }
+
+        int column = GetColumn(id);
+        _archetype->GetVersionList(_chunk)[column] = _version;
+        return { reinterpret_cast<T *>(_archetype->GetColumn(_chunk, column)), _chunk->Count };
+    }
+
+    // Whether the component could have been written in this chunk after the given version of
+    // the world, such as the one returned by World::AdvanceVersion() when it was last read
+    template <class T>
+    inline bool HasChanged(uint32_t sinceVersion) const {
+        int column = GetColumn(GetComponentTypeID<T>());
+        return (_archetype->GetVersionList(_chunk)[column] > sinceVersion);
+    }
+
+private:
+
+    inline int GetColumn(ComponentTypeID id) const {
+        int column = _archetype->ColumnList[id];
+        if (column < 0) {
+            throw Exception("Chunk has no component '{}'", GetComponentTypeInfo(id).Name);
+        }
+        return column;
+    }
+
+    Chunk * _chunk;
+
+    Archetype * _archetype;
+
+    const Query& _query;
+
+    uint32_t _version;
+
+}; // class ChunkView
+
+class World;
+
+// Called with the world version at the end of the previous run of this system, 0 the first time
+using SystemFunction = std::function<void(World& world, uint32_t lastVersion)>;
+
+// Entities and their components, stored by archetype in chunks of ChunkSize bytes. Systems are
+// run in the order they were added, except that systems whose queries don't conflict run in
+// parallel on the JobSystem.
+class NOON_API World
+{
+public:
+
+    NOON_DISALLOW_COPY_AND_ASSIGN(World)
+
+    // Chunks are allocated from resource, which must outlive the world
+    World(std::pmr::memory_resource * resource = std::pmr::get_default_resource());
+
+    ~World();
+
+    Entity Create();
+
+    template <class... Ts>
+    Entity Create(Ts&&... components) {
+        // Two of the same type would both be constructed in the same column
+        static_assert(AreComponentTypesUnique<std::decay_t<Ts>...>, "An entity can't have two components of the same type");
+
+        ComponentMask mask = MakeComponentMask<std::decay_t<Ts>...>();
+
+        Chunk * chunk;
+        uint32_t row;
+        Entity entity = CreateEntity(mask, chunk, row);
+
+        Archetype * archetype = chunk->Owner;
+        ((new (archetype->GetColumn(chunk, archetype->ColumnList[GetComponentTypeID<std::decay_t<Ts>>()]) + row * sizeof(std::decay_t<Ts>))
+            std::decay_t<Ts>(std::forward<Ts>(components))), ...);
+
+        return entity;
+    }
+
+    void Destroy(Entity entity);
+
+    bool IsAlive(Entity entity) const;
+
+    inline size_t GetEntityCount() const {
+        return _entityList.size() - _freeEntityList.size();
+    }
+
+    inline size_t GetArchetypeCount() const {
+        return _archetypeList.size();
+    }
+
+    size_t GetChunkCount() const;
+
+    // Replaces the component if the entity already has one
+    template <class T>
+    T& Add(Entity entity, T component = T()) {
+        ComponentTypeID id = GetComponentTypeID<T>();
+
+        T * data = static_cast<T *>(GetComponent(entity, id, true));
+        if (data) {
+            *data = std::move(component);
+            return *data;
+        }
+
+        return *new (AddComponent(entity, id)) T(std::move(component));
+    }
+
+    template <class T>
+    void Remove(Entity entity) {
+        RemoveComponent(entity, GetComponentTypeID<T>());
+    }
+
+    template <class T>
+    bool Has(Entity entity) const {
+        return (const_cast<World *>(this)->GetComponent(entity, GetComponentTypeID<T>(), false) != nullptr);
+    }
+
+    // Returns nullptr if the entity doesn't have the component
+    template <class T>
+    const T * Get(Entity entity) const {
+        return static_cast<const T *>(const_cast<World *>(this)->GetComponent(entity, GetComponentTypeID<T>(), false));
+    }
+
+    // Marks the component as changed for the whole chunk
+    template <class T>
+    T * GetMutable(Entity entity) {
+        return static_cast<T *>(GetComponent(entity, GetComponentTypeID<T>(), true));
+    }
+
+    // Calls func with a ChunkView for every chunk matching the query
+    template <class Func>
+    void ForEachChunk(const Query& query, Func&& func) {
+        for (auto& archetype : _archetypeList) {
+            if (!query.Matches(archetype->Mask)) {
+                continue;
+            }
+
+            for (Chunk * chunk : archetype->ChunkList) {
+                ChunkView view(chunk, query, _version);
+                func(view);
+            }
+        }
+    }
+
+    // Stored with each component of a chunk when it is written
+    inline uint32_t GetVersion() const {
+        return _version;
+    }
+
+    // Returns the current version and starts a new one, so that anything written afterwards
+    // compares as changed against it. Used to skip unchanged chunks when reading outside of
+    // systems, such as when rendering.
+    inline uint32_t AdvanceVersion() {
+        return _version++;
+    }
+
+    // The query declares the components the system reads and writes, and must cover every
+    // query the system uses
+    void AddSystem(StringView name, const Query& access, SystemFunction func);
+
+    void RunSystems();
+
+    // Entities can't be created, destroyed or have components added or removed while systems
+    // are running, so they queue those changes to run once every system has finished
+    void Defer(std::function<void(World& world)> func);
+
+private:
+
+    struct EntityRecord
+    {
+        Chunk * Storage;
+
+        uint32_t Row;
+
+        uint32_t Generation;
+
+    }; // struct EntityRecord
+
+    struct System
+    {
+        String Name;
+
+        Query Access;
+
+        SystemFunction Function;
+
+        uint32_t LastVersion;
+
+    }; // struct System
+
+    Entity CreateEntity(const ComponentMask& mask, Chunk *& chunk, uint32_t& row);
+
+    // Moves the entity to the archetype with the component, and returns the uninitialized
+    // storage for it
+    void * AddComponent(Entity entity, ComponentTypeID id);
+
+    void RemoveComponent(Entity entity, ComponentTypeID id);
+
+    void * GetComponent(Entity entity, ComponentTypeID id, bool write);
+
+    void CheckStructuralChange() const;
+
+    const EntityRecord& GetRecord(Entity entity) const;
+
+    Archetype * GetArchetype(const ComponentMask& mask);
+
+    Archetype * GetArchetypeWith(Archetype * archetype, ComponentTypeID id, bool add);
+
+    // Reserve a row at the end of the archetype, its components are uninitialized
+    void AllocateRow(Archetype * archetype, Chunk *& chunk, uint32_t& row);
+
+    // Fill the hole left by a row whose components were already destroyed or moved, with the
+    // last row of the archetype
+    void ReleaseRow(Chunk * chunk, uint32_t row);
+
+    // Move the components the entity shares with the target archetype, and destroy the others
+    void MoveEntity(Entity entity, Archetype * target, Chunk *& chunk, uint32_t& row);
+
+    std::pmr::memory_resource * _resource;
+
+    List<EntityRecord> _entityList;
+
+    List<uint32_t> _freeEntityList;
+
+    List<std::unique_ptr<Archetype>> _archetypeList;
+
+    Map<ComponentMask, Archetype *> _archetypeMap;
+
+    // Chunks of archetypes that emptied, kept for reuse
+    List<Chunk *> _freeChunkList;
+
+    List<System> _systemList;
+
+    List<std::function<void(World&)>> _deferredList;
+
+    std::mutex _deferredMutex;
+
+    uint32_t _version = 1;
+
+    bool _runningSystems = false;
+
+}; // class World
+
+} // namespace noon
+
+#endif // NOON_WORLD_HPP
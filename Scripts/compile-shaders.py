@@ -0,0 +1,286 @@
+#!/usr/bin/env python3
+
+import os
+import re
+import sys
+import json
+import time
+import hashlib
+import argparse
+import subprocess
+import concurrent.futures
+
+# Bump to invalidate every existing cache entry
+CACHE_VERSION = 1
+
+INCLUDE_REGEX = re.compile(rb'^\s*#\s*include\s*[<"]([^>"]+)[>"]', re.MULTILINE)
+
+parser = argparse.ArgumentParser()
+
+parser.add_argument(
+    '--glslc',
+    required=True,
+    help='Path to glslc.'
+)
+
+parser.add_argument(
+    '--glslc-flag',
+    action='append',
+    default=[],
+    help='Additional flag to pass to glslc, may be repeated.'
+)
+
+parser.add_argument(
+    '--spirv-opt',
+    help='Path to spirv-opt, if set the output of glslc will be run through it.'
+)
+
+parser.add_argument(
+    '--spirv-opt-flag',
+    action='append',
+    default=[],
+    help='Additional flag to pass to spirv-opt, may be repeated.'
+)
+
+parser.add_argument(
+    '-I',
+    dest='include_dirs',
+    action='append',
+    default=[],
+    help='Directory to search for #include files, may be repeated.'
+)
+
+parser.add_argument(
+    '--source-dir',
+    required=True,
+    help='Source directory, outputs are stored in the same relative location under binary-dir.'
+)
+
+parser.add_argument(
+    '--binary-dir',
+    required=True,
+    help='Binary directory to store compiled shaders in.'
+)
+
+parser.add_argument(
+    '--cache',
+    required=True,
+    help='File to store content hashes of compiled shaders in.'
+)
+
+parser.add_argument(
+    '--stamp',
+    required=True,
+    help='File to touch once all shaders are up to date.'
+)
+
+parser.add_argument(
+    '--depfile',
+    help='Makefile-style dependency file to write for the stamp.'
+)
+
+parser.add_argument(
+    '--jobs',
+    type=int,
+    default=os.cpu_count(),
+    help='Number of shaders to compile at once, defaults to the number of cores.'
+)
+
+parser.add_argument(
+    'inputs',
+    nargs='*',
+    help='Shaders to compile, named <name>.<stage>.glsl. Files with a stage of "inc" are skipped.'
+)
+
+args = parser.parse_args()
+
+# Skip empty flags produced by generator expressions
+args.glslc_flag = [ flag for flag in args.glslc_flag if flag ]
+args.spirv_opt_flag = [ flag for flag in args.spirv_opt_flag if flag ]
+
+def get_stage(filename):
+    name = os.path.basename(filename)
+    if name.endswith('.glsl'):
+        name = name[:-len('.glsl')]
+    return os.path.splitext(name)[1][1:]
+
+def get_output(filename):
+    relative = os.path.relpath(filename, args.source_dir)
+    if relative.endswith('.glsl'):
+        relative = relative[:-len('.glsl')]
+    return os.path.join(args.binary_dir, relative + '.spv')
+
+def find_include(name, current_dir):
+    for dir in [ current_dir ] + args.include_dirs:
+        path = os.path.join(dir, name)
+        if os.path.isfile(path):
+            return os.path.normpath(path)
+    return None
+
+_file_cache = {}
+
+def read_file(filename):
+    if filename not in _file_cache:
+        with open(filename, 'rb') as file:
+            _file_cache[filename] = file.read()
+    return _file_cache[filename]
+
+def get_include_list(filename):
+    # Every file that could be included, even those inside inactive #if blocks.
+    # Over-approximating only costs an occasional unnecessary recompile.
+    includes = set()
+    pending = [ filename ]
+    while pending:
+        current = pending.pop()
+        for match in INCLUDE_REGEX.finditer(read_file(current)):
+            path = find_include(match.group(1).decode('utf-8'), os.path.dirname(current))
+            if path and path not in includes:
+                includes.add(path)
+                pending.append(path)
+    return sorted(includes)
+
+def get_tool_signature(tool):
+    if not tool:
+        return ''
+    stat = os.stat(tool)
+    return '{}:{}:{}'.format(tool, stat.st_size, stat.st_mtime_ns)
+
+def get_content_hash(filename, includes):
+    hash = hashlib.sha256()
+    hash.update(str(CACHE_VERSION).encode('utf-8'))
+    hash.update(get_tool_signature(args.glslc).encode('utf-8'))
+    hash.update(get_tool_signature(args.spirv_opt).encode('utf-8'))
+    hash.update(' '.join(args.glslc_flag + [ '--' ] + args.spirv_opt_flag).encode('utf-8'))
+    for path in [ filename ] + includes:
+        hash.update(path.encode('utf-8'))
+        hash.update(read_file(path))
+    return hash.hexdigest()
+
+def write_if_changed(filename, data):
+    # Leaving unchanged outputs untouched lets the build tool skip dependent steps
+    try:
+        with open(filename, 'rb') as file:
+            if file.read() == data:
+                return
+    except FileNotFoundError:
+        pass
+
+    with open(filename, 'wb') as file:
+        file.write(data)
+
+def compile(filename, output):
+    start = time.perf_counter()
+
+    os.makedirs(os.path.dirname(output), exist_ok=True)
+
+    command = [ args.glslc, '-fshader-stage=' + get_stage(filename) ]
+    command += [ '-I' + dir for dir in args.include_dirs ]
+    command += args.glslc_flag
+    command += [ '-o', '-', filename ]
+
+    result = subprocess.run(command, capture_output=True)
+    messages = result.stderr.decode('utf-8', 'replace')
+    if result.returncode != 0:
+        return (filename, None, messages)
+
+    code = result.stdout
+
+    if args.spirv_opt:
+        command = [ args.spirv_opt ] + args.spirv_opt_flag + [ '-o', '-', '-' ]
+
+        result = subprocess.run(command, input=code, capture_output=True)
+        messages += result.stderr.decode('utf-8', 'replace')
+        if result.returncode != 0:
+            return (filename, None, messages)
+
+        code = result.stdout
+
+    write_if_changed(output, code)
+
+    return (filename, time.perf_counter() - start, messages)
+
+cache = {}
+try:
+    with open(args.cache, 'r') as file:
+        cache = json.load(file)
+except (FileNotFoundError, ValueError):
+    pass
+
+start = time.perf_counter()
+
+shaders = []
+dependencies = set()
+for filename in args.inputs:
+    filename = os.path.normpath(filename)
+    dependencies.add(filename)
+
+    if get_stage(filename) == 'inc':
+        continue
+
+    includes = get_include_list(filename)
+    dependencies.update(includes)
+
+    output = get_output(filename)
+    hash = get_content_hash(filename, includes)
+
+    shaders.append((filename, output, hash))
+
+pending = [
+    (filename, output, hash) for filename, output, hash in shaders
+    if cache.get(output) != hash or not os.path.isfile(output)
+]
+
+timings = {}
+failed = False
+
+with concurrent.futures.ThreadPoolExecutor(max_workers=max(1, args.jobs)) as executor:
+    futures = {
+        executor.submit(compile, filename, output): (output, hash)
+        for filename, output, hash in pending
+    }
+
+    for future in concurrent.futures.as_completed(futures):
+        output, hash = futures[future]
+        filename, duration, messages = future.result()
+
+        if messages:
+            sys.stderr.write(messages)
+
+        if duration is None:
+            failed = True
+            cache.pop(output, None)
+            continue
+
+        timings[filename] = duration
+        cache[output] = hash
+
+# Keep the cache even if some shaders failed, so the successful ones are not rebuilt
+with open(args.cache, 'w') as file:
+    json.dump(cache, file, indent=4, sort_keys=True)
+
+if failed:
+    sys.exit(1)
+
+for filename, output, hash in shaders:
+    name = os.path.relpath(filename, args.source_dir)
+    if filename in timings:
+        print('{:>10.1f} ms  {}'.format(timings[filename] * 1000.0, name))
+    else:
+        print('{:>13}  {}'.format('cached', name))
+
+elapsed = time.perf_counter() - start
+total = sum(timings.values())
+print('Compiled {} of {} shaders in {:.1f} ms ({:.1f} ms of compile time across {} jobs)'.format(
+    len(timings), len(shaders), elapsed * 1000.0, total * 1000.0, args.jobs))
+
+if args.depfile:
+    def escape(path):
+        return path.replace('\\', '/').replace(' ', '\\ ')
+
+    with open(args.depfile, 'w') as file:
+        file.write('{}: {}\n'.format(
+            escape(args.stamp),
+            ' '.join(escape(path) for path in sorted(dependencies))))
+
+with open(args.stamp, 'w') as file:
+    pass
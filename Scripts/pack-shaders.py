@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+
+import os
+import struct
+import argparse
+
+# Must match noon::ShaderBundle
+MAGIC          = 0x4248534E # "NSHB"
+FORMAT_VERSION = 1
+
+HEADER_FORMAT = '<IIII'
+ENTRY_FORMAT  = '<QIIQQ'
+
+# Shader code is aligned so it can be passed to vkCreateShaderModule directly from the mapping
+DATA_ALIGNMENT = 16
+
+FNV1A_OFFSET_BASIS = 0xCBF29CE484222325
+FNV1A_PRIME        = 0x100000001B3
+
+parser = argparse.ArgumentParser()
+
+parser.add_argument(
+    '--output',
+    required=True,
+    help='Filename of the bundle to write.'
+)
+
+parser.add_argument(
+    '--base-dir',
+    required=True,
+    help='Directory that shader names are relative to.'
+)
+
+parser.add_argument(
+    'inputs',
+    nargs='*',
+    help='Compiled SPIR-V files to pack.'
+)
+
+args = parser.parse_args()
+
+def hash_fnv1a(data):
+    hash = FNV1A_OFFSET_BASIS
+    for byte in data:
+        hash ^= byte
+        hash = (hash * FNV1A_PRIME) & 0xFFFFFFFFFFFFFFFF
+    return hash
+
+def align(offset, alignment):
+    return (offset + alignment - 1) & ~(alignment - 1)
+
+shaders = []
+for input in args.inputs:
+    name = os.path.relpath(input, args.base_dir).replace(os.sep, '/')
+    if name.endswith('.spv'):
+        name = name[:-len('.spv')]
+
+    with open(input, 'rb') as file:
+        code = file.read()
+
+    if len(code) % 4 != 0:
+        raise SystemExit('{}: SPIR-V size is not a multiple of 4'.format(input))
+
+    name = name.encode('utf-8')
+    shaders.append((hash_fnv1a(name), name, code))
+
+# Sorted by hash, so shaders can be found with a binary search
+shaders.sort(key=lambda shader: (shader[0], shader[1]))
+
+header_size = struct.calcsize(HEADER_FORMAT)
+entry_size  = struct.calcsize(ENTRY_FORMAT)
+
+offset = header_size + (entry_size * len(shaders))
+
+name_offsets = []
+for hash, name, code in shaders:
+    name_offsets.append(offset)
+    offset += len(name)
+
+data_offsets = []
+for hash, name, code in shaders:
+    offset = align(offset, DATA_ALIGNMENT)
+    data_offsets.append(offset)
+    offset += len(code)
+
+bundle = bytearray(offset)
+
+struct.pack_into(HEADER_FORMAT, bundle, 0, MAGIC, FORMAT_VERSION, len(shaders), 0)
+
+for i, (hash, name, code) in enumerate(shaders):
+    struct.pack_into(ENTRY_FORMAT, bundle, header_size + (entry_size * i),
+        hash, name_offsets[i], len(name), data_offsets[i], len(code))
+
+    bundle[name_offsets[i]:name_offsets[i] + len(name)] = name
+    bundle[data_offsets[i]:data_offsets[i] + len(code)] = code
+
+with open(args.output, 'wb') as file:
+    file.write(bundle)
+
+print('Packed {} shaders into {} ({} bytes)'.format(len(shaders), args.output, len(bundle)))
@@ -0,0 +1,270 @@
+#include "CookCache.hpp"
+
+#include <Noon/Exception.hpp>
+#include <Noon/Hash.hpp>
+#include <Noon/Json.hpp>
+#include <Noon/Log.hpp>
+#include <Noon/MappedFile.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <iterator>
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    #include <Windows.h>
+
+#else
+
+    #include <sys/stat.h>
+
+#endif
+
+namespace noon {
+
+static bool GetFileInfo(const Path& path, uint64_t& size, int64_t& time)
+{
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(ConvertUTF8ToWideString(path.ToString()).c_str(), GetFileExInfoStandard, &data)) {
+        return false;
+    }
+
+    size = (uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+
+    // In 100ns intervals
+    time = static_cast<int64_t>((uint64_t(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime) * 100;
+
+#else
+
+    struct stat fileStat;
+    if (stat(path.ToCString(), &fileStat) != 0) {
+        return false;
+    }
+
+    size = static_cast<uint64_t>(fileStat.st_size);
+    time = (static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1'000'000'000) + fileStat.st_mtim.tv_nsec;
+
+#endif
+
+    return true;
+}
+
+// MappedFile can't map empty files
+static bool HashContent(const Path& path, uint64_t size, uint64_t& hash)
+{
+    if (size == 0) {
+        hash = FNV1A_OFFSET_BASIS;
+        return true;
+    }
+
+    MappedFile file;
+    if (!file.Open(path)) {
+        return false;
+    }
+
+    hash = HashFNV1a(file.GetData(), file.GetSize());
+    return true;
+}
+
+static String EscapeString(StringView str)
+{
+    String escaped = "\"";
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += fmt::format("\\u{:04X}", static_cast<unsigned>(c));
+        }
+        else {
+            escaped += c;
+        }
+    }
+
+    escaped += '"';
+    return escaped;
+}
+
+// 64-bit values are stored as strings, as JSON numbers are doubles
+template <class T>
+static T ParseInteger(const JsonValue& value, int base)
+{
+    StringView str = value.GetRawString();
+
+    T result = 0;
+    auto [end, error] = std::from_chars(str.data(), str.data() + str.size(), result, base);
+    if (error != std::errc() || end != str.data() + str.size()) {
+        throw Exception("Invalid integer '{}'", str);
+    }
+
+    return result;
+}
+
+void CookCache::Load(const Path& path)
+{
+    _recordMap.clear();
+
+    if (!IsFile(path)) {
+        return;
+    }
+
+    MappedFile file;
+    if (!file.Open(path)) {
+        return;
+    }
+
+    try {
+        JsonDocument json;
+        json.Parse(StringView(reinterpret_cast<const char *>(file.GetData()), file.GetSize()));
+
+        JsonValue root = json.GetRoot();
+        if (root["Version"].GetInt(-1) != Version) {
+            Log(NOON_ANCHOR, "Ignoring cook cache '{}' from another version", path);
+            return;
+        }
+
+        for (JsonValue input : root["Inputs"]) {
+            CookRecord record = {
+                .SettingsHash = ParseInteger<uint64_t>(input["Settings"], 16),
+            };
+
+            for (JsonValue cookFile : input["Files"]) {
+                record.FileList.push_back(CookFile{
+                    .Path = cookFile["Path"].GetString(),
+                    .Size = static_cast<uint64_t>(cookFile["Size"].GetInt()),
+                    .Time = ParseInteger<int64_t>(cookFile["Time"], 10),
+                    .Hash = ParseInteger<uint64_t>(cookFile["Hash"], 16),
+                });
+            }
+
+            for (JsonValue asset : input["Assets"]) {
+                record.AssetList.push_back(asset.GetString());
+            }
+
+            _recordMap[input["Input"].GetString()] = std::move(record);
+        }
+    }
+    catch (std::exception& e) {
+        Log(NOON_ANCHOR, "Ignoring invalid cook cache '{}', {}", path, e.what());
+        _recordMap.clear();
+    }
+}
+
+bool CookCache::Save(const Path& path) const
+{
+    // One input per line, sorted, so the cache can be read and diffed
+    List<const std::pair<const String, CookRecord> *> sortedList;
+    sortedList.reserve(_recordMap.size());
+    for (const auto& pair : _recordMap) {
+        sortedList.push_back(&pair);
+    }
+
+    std::sort(sortedList.begin(), sortedList.end(),
+        [](const auto * a, const auto * b) {
+            return (a->first < b->first);
+        }
+    );
+
+    String text = fmt::format("{{\"Version\": {}, \"Inputs\": [", Version);
+
+    bool first = true;
+    for (const auto * pair : sortedList) {
+        const auto& [input, record] = *pair;
+        text += (first ? "\n" : ",\n");
+        first = false;
+
+        fmt::format_to(std::back_inserter(text), "{{\"Input\": {}, \"Settings\": \"{:016X}\", \"Files\": [",
+            EscapeString(input), record.SettingsHash);
+
+        for (size_t i = 0; i < record.FileList.size(); ++i) {
+            const auto& cookFile = record.FileList[i];
+            fmt::format_to(std::back_inserter(text), "{}{{\"Path\": {}, \"Size\": {}, \"Time\": \"{}\", \"Hash\": \"{:016X}\"}}",
+                (i > 0 ? ", " : ""), EscapeString(cookFile.Path), cookFile.Size, cookFile.Time, cookFile.Hash);
+        }
+
+        text += "], \"Assets\": [";
+
+        for (size_t i = 0; i < record.AssetList.size(); ++i) {
+            text += (i > 0 ? ", " : "");
+            text += EscapeString(record.AssetList[i]);
+        }
+
+        text += "]}";
+    }
+
+    text += "\n]}\n";
+
+    FILE * file = fopen(path.ToCString(), "wb");
+    if (!file) {
+        Log(NOON_ANCHOR, "Failed to open '{}' for writing", path);
+        return false;
+    }
+
+    bool isValid = (fwrite(text.data(), 1, text.size(), file) == text.size());
+    if (fclose(file) != 0 || !isValid) {
+        Log(NOON_ANCHOR, "Failed to write '{}'", path);
+        return false;
+    }
+
+    return true;
+}
+
+const CookRecord * CookCache::FindClean(const String& input, uint64_t settingsHash)
+{
+    auto it = _recordMap.find(input);
+    if (it == _recordMap.end() || it->second.SettingsHash != settingsHash) {
+        return nullptr;
+    }
+
+    for (auto& cookFile : it->second.FileList) {
+        uint64_t size = 0;
+        int64_t time = 0;
+        if (!GetFileInfo(cookFile.Path, size, time) || size != cookFile.Size) {
+            return nullptr;
+        }
+
+        // Touched without necessarily changing, e.g. by switching branches and back
+        if (time != cookFile.Time) {
+            uint64_t hash = 0;
+            if (!HashContent(cookFile.Path, size, hash) || hash != cookFile.Hash) {
+                return nullptr;
+            }
+
+            cookFile.Time = time;
+        }
+    }
+
+    return &it->second;
+}
+
+void CookCache::Set(const String& input, CookRecord record)
+{
+    _recordMap[input] = std::move(record);
+}
+
+void CookCache::Remove(const String& input)
+{
+    _recordMap.erase(input);
+}
+
+CookFile CookCache::HashFile(const Path& path)
+{
+    CookFile cookFile = {
+        .Path = path.ToString(),
+        .Size = 0,
+        .Time = 0,
+        .Hash = 0,
+    };
+
+    if (!GetFileInfo(path, cookFile.Size, cookFile.Time) || !HashContent(path, cookFile.Size, cookFile.Hash)) {
+        throw Exception("Failed to open '{}'", path);
+    }
+
+    return cookFile;
+}
+
+} // namespace noon
@@ -0,0 +1,73 @@
+#ifndef NOON_COOKER_COOK_CACHE_HPP
+#define NOON_COOKER_COOK_CACHE_HPP
+
+#include <Noon/Containers.hpp>
+#include <Noon/Path.hpp>
+#include <Noon/String.hpp>
+
+#include <cstdint>
+
+namespace noon {
+
+// A file an input was cooked from, either the input itself or one it references
+struct CookFile
+{
+    String Path;
+
+    uint64_t Size;
+
+    // Last write time in nanoseconds, only used to skip hashing files that weren't touched
+    int64_t Time;
+
+    // HashFNV1a() of the content
+    uint64_t Hash;
+
+}; // struct CookFile
+
+struct CookRecord
+{
+    // The importer, its version and the settings that affect its output
+    uint64_t SettingsHash;
+
+    List<CookFile> FileList;
+
+    // The assets the input produced, which the previous pack still has
+    List<String> AssetList;
+
+}; // struct CookRecord
+
+// Remembers what each input was cooked from, so that inputs whose files and settings are
+// unchanged can reuse the assets they produced last time. Stored as JSON, like the cache of
+// Scripts/compile-shaders.py.
+class CookCache
+{
+public:
+
+    // Bump to invalidate every existing record
+    static constexpr int64_t Version = 1;
+
+    // A missing or unreadable cache is left empty, which only costs a full cook
+    void Load(const Path& path);
+
+    bool Save(const Path& path) const;
+
+    // Returns the record of an input if its settings and every one of its files are the same
+    // as when it was cooked. Files whose size and time match are trusted, others are hashed.
+    const CookRecord * FindClean(const String& input, uint64_t settingsHash);
+
+    void Set(const String& input, CookRecord record);
+
+    void Remove(const String& input);
+
+    // Stat and hash a file, throws if it can't be read
+    static CookFile HashFile(const Path& path);
+
+private:
+
+    Map<String, CookRecord> _recordMap;
+
+}; // class CookCache
+
+} // namespace noon
+
+#endif // NOON_COOKER_COOK_CACHE_HPP
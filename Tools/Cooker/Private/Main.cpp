@@ -0,0 +1,818 @@
+#include "CookCache.hpp"
+#include "PNG.hpp"
+
+#include <Noon/AssetPackWriter.hpp>
+#include <Noon/BCEncoder.hpp>
+#include <Noon/Exception.hpp>
+#include <Noon/GLTFModel.hpp>
+#include <Noon/GraphicsDriver.hpp>
+#include <Noon/Hash.hpp>
+#include <Noon/JobSystem.hpp>
+#include <Noon/KTX2.hpp>
+#include <Noon/Log.hpp>
+#include <Noon/MappedFile.hpp>
+#include <Noon/MeshOptimizer.hpp>
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+using namespace noon;
+
+enum class Importer
+{
+    Model,
+    Texture,
+    KTX2,
+    Shader,
+    Raw,
+
+}; // enum class Importer
+
+// Bump an importer's version whenever what it produces changes, so that inputs cooked by an
+// older version are cooked again rather than taken from the cache
+static constexpr uint32_t ImporterVersionList[] = {
+    2, // Model
+    1, // Texture
+    1, // KTX2
+    1, // Shader
+    1, // Raw
+};
+
+// What an image is used for decides its format and how its mipmaps are filtered. When an
+// image has several uses, the last in this order wins.
+enum class TextureRole
+{
+    // Only R is kept
+    Occlusion,
+
+    // Linear RGB, often with occlusion in R
+    MetallicRoughness,
+
+    // Only XY is kept, Z is reconstructed when sampling
+    Normal,
+
+    // sRGB with alpha, for base color and emissive
+    Color,
+
+}; // enum class TextureRole
+
+struct TextureStats
+{
+    uint32_t TextureCount = 0;
+
+    // Every level, not just the first
+    uint64_t PixelCount = 0;
+
+    double Seconds = 0.0;
+
+    double PSNRSum = 0.0;
+
+}; // struct TextureStats
+
+struct CookContext
+{
+    BCQuality Quality = BCQuality::Normal;
+
+    // Levels of detail generated for each mesh, including the full detail one. Simplifying
+    // is slow, so meshes only get the full detail level unless asked for more.
+    uint32_t LODCount = 1;
+
+    // Print the PSNR and encoding throughput of each texture, and totals per format
+    bool PrintStats = false;
+
+    // Inputs are cooked in parallel, guards StatsMap and printing
+    std::mutex StatsMutex;
+
+    Map<VkFormat, TextureStats> StatsMap;
+
+}; // struct CookContext
+
+// An input to cook, or to take from the previous pack if the cache says it is unchanged
+struct CookJob
+{
+    Path Input;
+
+    String Name;
+
+    Importer Type;
+
+    uint64_t SettingsHash;
+
+    // Set when the input is unchanged
+    const CookRecord * Cached = nullptr;
+
+    // Set when the input was cooked
+    std::unique_ptr<AssetPackWriter> Writer;
+
+    // Set when the input was cooked, hashed by the job that cooked it
+    CookRecord Record;
+
+    double Seconds = 0.0;
+
+    String Error;
+
+}; // struct CookJob
+
+static void PrintUsage()
+{
+    fmt::print("Usage: NoonCooker [--quality fast|normal|high] [--lods N] [--stats] [--cache FILE]\n");
+    fmt::print("                  [--depfile FILE] --output PACK --base-dir DIR INPUT...\n");
+    fmt::print("\n");
+    fmt::print("Cooks .gltf and .glb models, .png and .ktx2 textures, .spv shaders and any other file\n");
+    fmt::print("into an asset pack. Assets are named by their path relative to DIR.\n");
+    fmt::print("\n");
+    fmt::print("PNG images are block-compressed with mipmaps, as BC7 for color, BC5 for normal maps,\n");
+    fmt::print("BC7 for metallic-roughness and BC4 for occlusion. --quality trades encoding time for\n");
+    fmt::print("quality and defaults to normal, --stats prints the PSNR and throughput of each texture.\n");
+    fmt::print("\n");
+    fmt::print("--lods gives meshes up to N levels of detail, each with about half the triangles of\n");
+    fmt::print("the last, at most {}. It defaults to 1, which keeps only the full detail mesh.\n", MaxMeshLODCount);
+    fmt::print("\n");
+    fmt::print("With --cache, the hashes of every file an input was cooked from are kept in FILE, and\n");
+    fmt::print("inputs whose files and settings are unchanged are copied from the previous PACK rather\n");
+    fmt::print("than cooked again. --depfile writes every file the pack depends on, for the build tool.\n");
+}
+
+static String GetAssetName(const Path& input, const String& baseDir)
+{
+    String name = input.ToString();
+    if (!baseDir.empty() && name.starts_with(baseDir) && name.size() > baseDir.size() && name[baseDir.size()] == Path::Slash) {
+        name = name.substr(baseDir.size() + 1);
+    }
+
+    // Names are the same on every platform
+    std::replace(name.begin(), name.end(), '\\', '/');
+    return name;
+}
+
+static List<uint8_t> ReadFile(const Path& path)
+{
+    MappedFile file;
+    if (!file.Open(path)) {
+        throw Exception("Failed to open '{}'", path);
+    }
+
+    return List<uint8_t>(file.GetData(), file.GetData() + file.GetSize());
+}
+
+static VkFormat GetTextureFormat(TextureRole role)
+{
+    switch (role) {
+    case TextureRole::Occlusion:
+        return VK_FORMAT_BC4_UNORM_BLOCK;
+    case TextureRole::MetallicRoughness:
+        return VK_FORMAT_BC7_UNORM_BLOCK;
+    case TextureRole::Normal:
+        return VK_FORMAT_BC5_UNORM_BLOCK;
+    default:
+        return VK_FORMAT_BC7_SRGB_BLOCK;
+    }
+}
+
+// The channels the format keeps, for measuring PSNR
+static uint32_t GetTextureChannelMask(TextureRole role)
+{
+    switch (role) {
+    case TextureRole::Occlusion:
+        return 0x1;
+    case TextureRole::MetallicRoughness:
+        return 0x7;
+    case TextureRole::Normal:
+        return 0x3;
+    default:
+        return 0xF;
+    }
+}
+
+static bool IsPNG(Span<const uint8_t> data)
+{
+    static const uint8_t Signature[4] = { 0x89, 'P', 'N', 'G' };
+    return (data.size() >= sizeof(Signature) && memcmp(data.data(), Signature, sizeof(Signature)) == 0);
+}
+
+static bool IsKTX2(Span<const uint8_t> data)
+{
+    return (data.size() >= sizeof(KTX2File::Identifier) && memcmp(data.data(), KTX2File::Identifier, sizeof(KTX2File::Identifier)) == 0);
+}
+
+// Each level halves the one before with a box filter, averaging color in linear space and
+// keeping normals unit length
+static List<List<uint8_t>> GenerateMipmaps(List<uint8_t> pixels, uint32_t width, uint32_t height, TextureRole role)
+{
+    static const auto toLinear = []() {
+        Array<float, 256> table;
+        for (uint32_t i = 0; i < 256; ++i) {
+            float value = float(i) / 255.0f;
+            table[i] = (value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f));
+        }
+        return table;
+    }();
+
+    auto toSRGB = [](float value) {
+        value = (value <= 0.0031308f ? value * 12.92f : (1.055f * std::pow(value, 1.0f / 2.4f)) - 0.055f);
+        return static_cast<uint8_t>(std::clamp(std::lround(value * 255.0f), 0L, 255L));
+    };
+
+    List<List<uint8_t>> levelList;
+    levelList.push_back(std::move(pixels));
+
+    while (width > 1 || height > 1) {
+        uint32_t levelWidth = std::max(width / 2, 1u);
+        uint32_t levelHeight = std::max(height / 2, 1u);
+
+        const auto& source = levelList.back();
+        List<uint8_t> level(size_t(levelWidth) * levelHeight * 4);
+
+        ParallelFor(levelHeight, 16, [&](size_t first, size_t last) {
+            for (size_t y = first; y < last; ++y) {
+                for (uint32_t x = 0; x < levelWidth; ++x) {
+                    uint32_t x0 = std::min(x * 2, width - 1);
+                    uint32_t x1 = std::min((x * 2) + 1, width - 1);
+                    uint32_t y0 = std::min(uint32_t(y) * 2, height - 1);
+                    uint32_t y1 = std::min((uint32_t(y) * 2) + 1, height - 1);
+
+                    const uint8_t * quad[4] = {
+                        source.data() + ((size_t(y0) * width + x0) * 4),
+                        source.data() + ((size_t(y0) * width + x1) * 4),
+                        source.data() + ((size_t(y1) * width + x0) * 4),
+                        source.data() + ((size_t(y1) * width + x1) * 4),
+                    };
+
+                    uint8_t * output = level.data() + ((y * levelWidth + x) * 4);
+                    uint32_t alpha = 0;
+                    for (const uint8_t * pixel : quad) {
+                        alpha += pixel[3];
+                    }
+
+                    output[3] = static_cast<uint8_t>((alpha + 2) / 4);
+
+                    if (role == TextureRole::Normal) {
+                        float normal[3] = {};
+                        for (const uint8_t * pixel : quad) {
+                            for (uint32_t c = 0; c < 3; ++c) {
+                                normal[c] += (float(pixel[c]) / 127.5f) - 1.0f;
+                            }
+                        }
+
+                        float length = std::sqrt((normal[0] * normal[0]) + (normal[1] * normal[1]) + (normal[2] * normal[2]));
+                        for (uint32_t c = 0; c < 3; ++c) {
+                            float value = (length > 0.0f ? normal[c] / length : (c == 2 ? 1.0f : 0.0f));
+                            output[c] = static_cast<uint8_t>(std::clamp(std::lround((value + 1.0f) * 127.5f), 0L, 255L));
+                        }
+                    }
+                    else if (role == TextureRole::Color) {
+                        for (uint32_t c = 0; c < 3; ++c) {
+                            float sum = 0.0f;
+                            for (const uint8_t * pixel : quad) {
+                                sum += toLinear[pixel[c]];
+                            }
+                            output[c] = toSRGB(sum / 4.0f);
+                        }
+                    }
+                    else {
+                        for (uint32_t c = 0; c < 3; ++c) {
+                            uint32_t sum = 0;
+                            for (const uint8_t * pixel : quad) {
+                                sum += pixel[c];
+                            }
+                            output[c] = static_cast<uint8_t>((sum + 2) / 4);
+                        }
+                    }
+                }
+            }
+        });
+
+        levelList.push_back(std::move(level));
+        width = levelWidth;
+        height = levelHeight;
+    }
+
+    return levelList;
+}
+
+static void CookTexture(AssetPackWriter& writer, CookContext& context, const String& name, Span<const uint8_t> data, TextureRole role)
+{
+    List<uint8_t> pixels;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    if (!DecodePNG(data, pixels, width, height)) {
+        throw Exception("Failed to decode image '{}'", name);
+    }
+
+    VkFormat format = GetTextureFormat(role);
+    List<List<uint8_t>> levelList = GenerateMipmaps(std::move(pixels), width, height, role);
+
+    List<List<uint8_t>> encodedList;
+    uint64_t pixelCount = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < levelList.size(); ++i) {
+        uint32_t levelWidth = std::max(width >> i, 1u);
+        uint32_t levelHeight = std::max(height >> i, 1u);
+
+        encodedList.push_back(EncodeBC(format, levelList[i].data(), levelWidth, levelHeight, context.Quality));
+        pixelCount += uint64_t(levelWidth) * levelHeight;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    List<Span<const uint8_t>> spanList;
+    for (const auto& encoded : encodedList) {
+        spanList.push_back(encoded);
+    }
+
+    writer.Add(name, AssetType::Texture, KTX2File::Write(format, width, height, spanList));
+
+    if (context.PrintStats) {
+        List<uint8_t> decoded = DecodeBC(format, encodedList[0].data(), width, height);
+        double psnr = ComputePSNR(levelList[0].data(), decoded.data(), width, height, GetTextureChannelMask(role));
+
+        std::lock_guard<std::mutex> lock(context.StatsMutex);
+
+        fmt::print("{}: {}x{} {}, {} levels, {:.2f} dB, {:.2f}s, {:.2f} Mpixel/s\n",
+            name, width, height, VkFormatToString(format), levelList.size(),
+            psnr, seconds, double(pixelCount) / seconds / 1e6);
+
+        auto& stats = context.StatsMap[format];
+        ++stats.TextureCount;
+        stats.PixelCount += pixelCount;
+        stats.Seconds += seconds;
+        stats.PSNRSum += psnr;
+    }
+}
+
+// KTX2 files are stored as they are, if they can be uploaded without transcoding
+static void AddKTX2(AssetPackWriter& writer, const String& name, Span<const uint8_t> data)
+{
+    KTX2File file;
+    if (!file.Parse(data)) {
+        throw Exception("Failed to load texture '{}'", name);
+    }
+
+    writer.Add(name, AssetType::Texture, List<uint8_t>(data.begin(), data.end()));
+}
+
+static void CopyTextureName(char * dst, const String& model, int image)
+{
+    if (image < 0) {
+        return;
+    }
+
+    String name = fmt::format("{}/Image{}", model, image);
+    if (name.size() > PackedMaterial::MaxNameLength) {
+        throw Exception("Texture name '{}' is longer than {} characters", name, PackedMaterial::MaxNameLength);
+    }
+
+    memcpy(dst, name.data(), name.size());
+}
+
+static void CookModel(AssetPackWriter& writer, CookContext& context, const Path& input, const String& name, List<Path>& dependencyList)
+{
+    GLTFModel model;
+    if (!model.Load(input)) {
+        throw Exception("Failed to load '{}'", input);
+    }
+
+    for (const auto& path : model.GetExternalPathList()) {
+        if (std::find(dependencyList.begin(), dependencyList.end(), path) == dependencyList.end()) {
+            dependencyList.push_back(path);
+        }
+    }
+
+    struct MeshJob
+    {
+        String Name;
+
+        const GLTFPrimitive * Primitive;
+
+        // The levels are appended to the indices of the full detail mesh
+        List<uint32_t> IndexList;
+
+        List<MeshLOD> LODList;
+
+    }; // struct MeshJob
+
+    List<MeshJob> meshJobList;
+
+    const auto& meshList = model.GetMeshList();
+    for (size_t m = 0; m < meshList.size(); ++m) {
+        const auto& primitiveList = meshList[m].Primitives;
+        for (size_t p = 0; p < primitiveList.size(); ++p) {
+            meshJobList.push_back({ fmt::format("{}/Mesh{}.{}", name, m, p), &primitiveList[p], {}, {} });
+        }
+    }
+
+    // Each mesh is simplified on its own job, as one large mesh can take longer than every
+    // other input combined
+    if (context.LODCount > 1) {
+        ParallelFor(meshJobList.size(), 1, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                auto& meshJob = meshJobList[i];
+                if (!meshJob.Primitive->Indices.empty()) {
+                    meshJob.IndexList = meshJob.Primitive->Indices;
+                    meshJob.LODList = GenerateMeshLODs(meshJob.IndexList, meshJob.Primitive->Vertices.Positions, context.LODCount);
+                }
+            }
+        });
+    }
+
+    for (const auto& meshJob : meshJobList) {
+        if (meshJob.LODList.empty()) {
+            writer.AddMesh(meshJob.Name, meshJob.Primitive->Vertices, meshJob.Primitive->Indices);
+        }
+        else {
+            writer.AddMesh(meshJob.Name, meshJob.Primitive->Vertices, meshJob.IndexList, meshJob.LODList);
+        }
+    }
+
+    const auto& imageList = model.GetImageList();
+    Map<int, TextureRole> roleMap;
+
+    auto useImage = [&](const GLTFTextureSlot& slot, TextureRole role) {
+        if (slot.Image >= 0) {
+            auto [it, inserted] = roleMap.try_emplace(slot.Image, role);
+            it->second = std::max(it->second, role);
+        }
+    };
+
+    const auto& materialList = model.GetMaterialList();
+    for (size_t i = 0; i < materialList.size(); ++i) {
+        const auto& material = materialList[i];
+
+        useImage(material.BaseColorMap, TextureRole::Color);
+        useImage(material.NormalMap, TextureRole::Normal);
+        useImage(material.MetallicRoughnessMap, TextureRole::MetallicRoughness);
+        useImage(material.EmissiveMap, TextureRole::Color);
+        useImage(material.OcclusionMap, TextureRole::Occlusion);
+
+        PackedMaterial packedMaterial = {};
+        packedMaterial.Parameters = material.Parameters;
+        packedMaterial.DoubleSided = material.DoubleSided;
+        CopyTextureName(packedMaterial.BaseColorMap, name, material.BaseColorMap.Image);
+        CopyTextureName(packedMaterial.NormalMap, name, material.NormalMap.Image);
+        CopyTextureName(packedMaterial.MetallicRoughnessMap, name, material.MetallicRoughnessMap.Image);
+        CopyTextureName(packedMaterial.EmissiveMap, name, material.EmissiveMap.Image);
+        CopyTextureName(packedMaterial.OcclusionMap, name, material.OcclusionMap.Image);
+
+        writer.AddMaterial(fmt::format("{}/Material{}", name, i), packedMaterial);
+    }
+
+    for (size_t i = 0; i < imageList.size(); ++i) {
+        String imageName = fmt::format("{}/Image{}", name, i);
+        const auto& data = imageList[i].Data;
+
+        auto it = roleMap.find(static_cast<int>(i));
+        TextureRole role = (it != roleMap.end() ? it->second : TextureRole::Color);
+
+        if (IsPNG(data)) {
+            CookTexture(writer, context, imageName, data, role);
+        }
+        else if (IsKTX2(data)) {
+            AddKTX2(writer, imageName, data);
+        }
+        else {
+            // There is no JPEG decoder, so these are stored as they are
+            writer.Add(imageName, AssetType::Raw, List<uint8_t>(data.begin(), data.end()));
+        }
+    }
+}
+
+static void PrintStats(const CookContext& context)
+{
+    for (const auto& [format, stats] : context.StatsMap) {
+        fmt::print("{}: {} textures, {:.1f} Mpixels, {:.2f} dB average, {:.2f}s, {:.2f} Mpixel/s\n",
+            VkFormatToString(format), stats.TextureCount, double(stats.PixelCount) / 1e6,
+            stats.PSNRSum / stats.TextureCount, stats.Seconds, double(stats.PixelCount) / stats.Seconds / 1e6);
+    }
+}
+
+static Importer GetImporter(const Path& input)
+{
+    String extension = input.GetExtension().ToString();
+
+    if (StringEqualCaseInsensitive(extension, "gltf") || StringEqualCaseInsensitive(extension, "glb")) {
+        return Importer::Model;
+    }
+    else if (StringEqualCaseInsensitive(extension, "png")) {
+        return Importer::Texture;
+    }
+    else if (StringEqualCaseInsensitive(extension, "ktx2")) {
+        return Importer::KTX2;
+    }
+    else if (StringEqualCaseInsensitive(extension, "spv")) {
+        return Importer::Shader;
+    }
+
+    return Importer::Raw;
+}
+
+// The importer, its version, and the settings that change what it produces
+static uint64_t GetSettingsHash(Importer importer, const CookContext& context)
+{
+    String settings = fmt::format("{} {}", static_cast<int>(importer), ImporterVersionList[static_cast<size_t>(importer)]);
+
+    if (importer == Importer::Model || importer == Importer::Texture) {
+        settings += fmt::format(" {}", BCQualityToString(context.Quality));
+    }
+
+    if (importer == Importer::Model) {
+        settings += fmt::format(" {}", context.LODCount);
+    }
+
+    return HashFNV1a(settings);
+}
+
+static void Cook(CookJob& job, CookContext& context)
+{
+    auto& writer = *job.Writer;
+
+    List<Path> dependencyList = { job.Input };
+
+    switch (job.Type) {
+    case Importer::Model:
+        CookModel(writer, context, job.Input, job.Name, dependencyList);
+        break;
+    case Importer::Texture:
+        CookTexture(writer, context, job.Name, ReadFile(job.Input), TextureRole::Color);
+        break;
+    case Importer::KTX2:
+        AddKTX2(writer, job.Name, ReadFile(job.Input));
+        break;
+    case Importer::Shader:
+        writer.Add(job.Name, AssetType::Shader, ReadFile(job.Input));
+        break;
+    default:
+        writer.Add(job.Name, AssetType::Raw, ReadFile(job.Input));
+        break;
+    }
+
+    job.Record.SettingsHash = job.SettingsHash;
+    job.Record.AssetList = writer.GetNameList();
+
+    for (const auto& path : dependencyList) {
+        job.Record.FileList.push_back(CookCache::HashFile(path));
+    }
+}
+
+// Makefile-style, the pack depends on every file it was cooked from
+static bool WriteDepfile(const Path& path, const Path& output, const Set<String>& dependencySet)
+{
+    auto escape = [](String str) {
+        std::replace(str.begin(), str.end(), '\\', '/');
+
+        String escaped;
+        for (char c : str) {
+            if (c == ' ') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+
+        return escaped;
+    };
+
+    String text = escape(output.ToString()) + ":";
+    for (const auto& dependency : dependencySet) {
+        text += " " + escape(dependency);
+    }
+
+    text += "\n";
+
+    FILE * file = fopen(path.ToCString(), "wb");
+    if (!file) {
+        Log(NOON_ANCHOR, "Failed to open '{}' for writing", path);
+        return false;
+    }
+
+    bool isValid = (fwrite(text.data(), 1, text.size(), file) == text.size());
+    if (fclose(file) != 0 || !isValid) {
+        Log(NOON_ANCHOR, "Failed to write '{}'", path);
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char ** argv)
+{
+    Path output;
+    String baseDir;
+    Path cachePath;
+    Path depfilePath;
+    List<Path> inputList;
+    CookContext context;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        }
+        else if (strcmp(argv[i], "--base-dir") == 0 && i + 1 < argc) {
+            baseDir = Path(argv[++i]).ToString();
+        }
+        else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cachePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--depfile") == 0 && i + 1 < argc) {
+            depfilePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--quality") == 0 && i + 1 < argc) {
+            ++i;
+            if (StringEqualCaseInsensitive(argv[i], "fast")) {
+                context.Quality = BCQuality::Fast;
+            }
+            else if (StringEqualCaseInsensitive(argv[i], "normal")) {
+                context.Quality = BCQuality::Normal;
+            }
+            else if (StringEqualCaseInsensitive(argv[i], "high")) {
+                context.Quality = BCQuality::High;
+            }
+            else {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--lods") == 0 && i + 1 < argc) {
+            int lodCount = atoi(argv[++i]);
+            if (lodCount < 1 || lodCount > static_cast<int>(MaxMeshLODCount)) {
+                PrintUsage();
+                return 1;
+            }
+
+            context.LODCount = static_cast<uint32_t>(lodCount);
+        }
+        else if (strcmp(argv[i], "--stats") == 0) {
+            context.PrintStats = true;
+        }
+        else if (strcmp(argv[i], "--help") == 0) {
+            PrintUsage();
+            return 0;
+        }
+        else {
+            inputList.push_back(argv[i]);
+        }
+    }
+
+    if (output.IsEmpty()) {
+        PrintUsage();
+        return 1;
+    }
+
+    try {
+        // Inputs are cooked in parallel, and so are the primitives of models and the blocks
+        // of textures
+        JobSystem jobSystem;
+
+        auto start = std::chrono::steady_clock::now();
+
+        CookCache cache;
+        AssetPack previousPack;
+
+        if (!cachePath.IsEmpty()) {
+            cache.Load(cachePath);
+
+            // Unchanged inputs are copied from the pack that is about to be replaced
+            if (IsFile(output)) {
+                previousPack.Open(output);
+            }
+        }
+
+        List<CookJob> jobList(inputList.size());
+        List<size_t> pendingList;
+
+        for (size_t i = 0; i < inputList.size(); ++i) {
+            auto& job = jobList[i];
+            job.Input = inputList[i];
+            job.Name = GetAssetName(job.Input, baseDir);
+            job.Type = GetImporter(job.Input);
+            job.SettingsHash = GetSettingsHash(job.Type, context);
+
+            // Textures and shaders are named without their extension
+            if (job.Type == Importer::Texture || job.Type == Importer::KTX2 || job.Type == Importer::Shader) {
+                job.Name = job.Name.substr(0, job.Name.size() - job.Input.GetExtension().ToString().size() - 1);
+            }
+
+            if (previousPack.IsOpen()) {
+                job.Cached = cache.FindClean(job.Input.ToString(), job.SettingsHash);
+
+                // The pack could have been replaced since the cache was saved
+                if (job.Cached) {
+                    for (const auto& name : job.Cached->AssetList) {
+                        Span<const uint8_t> data;
+                        if (!previousPack.Find(name, data)) {
+                            job.Cached = nullptr;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if (!job.Cached) {
+                job.Writer = std::make_unique<AssetPackWriter>();
+                pendingList.push_back(i);
+            }
+        }
+
+        // Each input is cooked into a writer of its own, which are combined in input order so
+        // the pack is the same regardless of which inputs were cached
+        ParallelFor(pendingList.size(), 1, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                auto& job = jobList[pendingList[i]];
+                auto jobStart = std::chrono::steady_clock::now();
+
+                try {
+                    Cook(job, context);
+                }
+                catch (std::exception& e) {
+                    job.Error = e.what();
+                }
+
+                job.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - jobStart).count();
+            }
+        });
+
+        AssetPackWriter writer;
+        Set<String> dependencySet;
+        bool failed = false;
+        double cookSeconds = 0.0;
+
+        for (auto& job : jobList) {
+            String input = job.Input.ToString();
+
+            if (!job.Error.empty()) {
+                fmt::print("Failed to cook '{}': {}\n", input, job.Error);
+                cache.Remove(input);
+                failed = true;
+                continue;
+            }
+
+            if (job.Cached) {
+                for (const auto& name : job.Cached->AssetList) {
+                    Span<const uint8_t> data;
+                    AssetType type = AssetType::Raw;
+                    previousPack.Find(name, data, &type);
+                    writer.Add(name, type, List<uint8_t>(data.begin(), data.end()));
+                }
+
+                for (const auto& cookFile : job.Cached->FileList) {
+                    dependencySet.insert(cookFile.Path);
+                }
+
+                fmt::print("{:>13}  {}\n", "cached", job.Name);
+            }
+            else {
+                for (const auto& cookFile : job.Record.FileList) {
+                    dependencySet.insert(cookFile.Path);
+                }
+
+                writer.Append(std::move(*job.Writer));
+                cache.Set(input, std::move(job.Record));
+
+                fmt::print("{:10.1f} ms  {}\n", job.Seconds * 1000.0, job.Name);
+                cookSeconds += job.Seconds;
+            }
+        }
+
+        // Keep the cache even if some inputs failed, so the others are not cooked again
+        if (!cachePath.IsEmpty()) {
+            cache.Save(cachePath);
+        }
+
+        if (failed) {
+            return 1;
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        fmt::print("Cooked {} of {} inputs in {:.1f} ms ({:.1f} ms of cook time across {} threads)\n",
+            pendingList.size(), jobList.size(), seconds * 1000.0, cookSeconds * 1000.0, jobSystem.GetThreadCount());
+
+        if (context.PrintStats) {
+            PrintStats(context);
+        }
+
+        // The previous pack must be unmapped before it can be replaced
+        previousPack.Close();
+
+        if (!writer.Write(output)) {
+            return 1;
+        }
+
+        if (!depfilePath.IsEmpty() && !WriteDepfile(depfilePath, output, dependencySet)) {
+            return 1;
+        }
+    }
+    catch (std::exception& e) {
+        fmt::print("Exception: {}\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
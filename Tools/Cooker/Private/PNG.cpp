@@ -0,0 +1,596 @@
+#include "PNG.hpp"
+
+#include <Noon/Log.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace noon {
+
+static const uint8_t Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+// Reads the deflate stream from its lowest bit, past the end are zeros, which Inflate()
+// reports as truncated once they are used
+class InflateReader
+{
+public:
+
+    InflateReader(const uint8_t * data, size_t size)
+        : _data(data)
+        , _size(size)
+    { }
+
+    inline uint32_t Peek(uint32_t bitCount) {
+        Refill();
+        return static_cast<uint32_t>(_bits & ((uint64_t(1) << bitCount) - 1));
+    }
+
+    inline void Consume(uint32_t bitCount) {
+        _bits >>= bitCount;
+        _bitCount -= bitCount;
+    }
+
+    inline uint32_t Read(uint32_t bitCount) {
+        uint32_t value = Peek(bitCount);
+        Consume(bitCount);
+        return value;
+    }
+
+    // Drops the bits left in the current byte, for stored blocks
+    inline void AlignToByte() {
+        Consume(_bitCount % 8);
+    }
+
+    // Whether more bits were used than there are
+    inline bool IsOverrun() const {
+        return (_position - (_bitCount / 8) > _size);
+    }
+
+private:
+
+    inline void Refill() {
+        while (_bitCount <= 56) {
+            uint64_t byte = (_position < _size ? _data[_position] : 0);
+            _bits |= byte << _bitCount;
+            _bitCount += 8;
+            ++_position;
+        }
+    }
+
+    const uint8_t * _data;
+
+    size_t _size;
+
+    // Bytes loaded into _bits, including the zeros past the end
+    size_t _position = 0;
+
+    uint64_t _bits = 0;
+
+    uint32_t _bitCount = 0;
+
+}; // class InflateReader
+
+// Canonical Huffman codes, decoded with a table for the short codes and bit by bit for the rest
+class InflateHuffman
+{
+public:
+
+    static constexpr uint32_t MaxBits = 15;
+
+    static constexpr uint32_t FastBits = 10;
+
+    bool Build(const uint8_t * lengthList, uint32_t count) {
+        memset(_count, 0, sizeof(_count));
+        memset(_fast, 0, sizeof(_fast));
+
+        for (uint32_t i = 0; i < count; ++i) {
+            ++_count[lengthList[i]];
+        }
+        _count[0] = 0;
+
+        // Reject codes that use more than the space there is, incomplete codes are allowed
+        int left = 1;
+        for (uint32_t length = 1; length <= MaxBits; ++length) {
+            left = (left * 2) - _count[length];
+            if (left < 0) {
+                return false;
+            }
+        }
+
+        uint16_t offset[MaxBits + 1];
+        offset[1] = 0;
+        for (uint32_t length = 1; length < MaxBits; ++length) {
+            offset[length + 1] = offset[length] + _count[length];
+        }
+
+        for (uint32_t i = 0; i < count; ++i) {
+            if (lengthList[i] != 0) {
+                _symbol[offset[lengthList[i]]++] = static_cast<uint16_t>(i);
+            }
+        }
+
+        // Codes are assigned in order of length then symbol, and stored from their highest bit
+        uint32_t code = 0;
+        uint32_t index = 0;
+        for (uint32_t length = 1; length <= FastBits; ++length) {
+            for (uint32_t i = 0; i < _count[length]; ++i, ++code, ++index) {
+                uint32_t reversed = 0;
+                for (uint32_t bit = 0; bit < length; ++bit) {
+                    reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+                }
+
+                for (uint32_t entry = reversed; entry < (1u << FastBits); entry += (1u << length)) {
+                    _fast[entry] = static_cast<uint16_t>((length << 9) | _symbol[index]);
+                }
+            }
+            code <<= 1;
+        }
+
+        return true;
+    }
+
+    // Returns -1 for a code that isn't in the table
+    inline int Decode(InflateReader& reader) const {
+        uint32_t bits = reader.Peek(MaxBits);
+
+        uint16_t entry = _fast[bits & ((1u << FastBits) - 1)];
+        if (entry != 0) {
+            reader.Consume(entry >> 9);
+            return (entry & 0x1FF);
+        }
+
+        int code = 0;
+        int first = 0;
+        int index = 0;
+        for (uint32_t length = 1; length <= MaxBits; ++length) {
+            code |= (bits >> (length - 1)) & 1;
+
+            int count = _count[length];
+            if (code - first < count) {
+                reader.Consume(length);
+                return _symbol[index + (code - first)];
+            }
+
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+
+        return -1;
+    }
+
+private:
+
+    uint16_t _count[MaxBits + 1];
+
+    uint16_t _symbol[288];
+
+    // The symbol in the low 9 bits and the code length above, or 0 for longer codes
+    uint16_t _fast[1u << FastBits];
+
+}; // class InflateHuffman
+
+static const uint16_t LengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+};
+
+static const uint8_t LengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+};
+
+static const uint16_t DistanceBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+};
+
+static const uint8_t DistanceExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+};
+
+// The order code length code lengths are stored in
+static const uint8_t CodeLengthOrder[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15,
+};
+
+// Decompresses a zlib stream into output, which must be exactly the size expected
+static bool Inflate(Span<const uint8_t> data, List<uint8_t>& output)
+{
+    if (data.size() < 2 || (data[0] & 0x0F) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20)) {
+        Log(NOON_ANCHOR, "PNG has an invalid zlib header");
+        return false;
+    }
+
+    InflateReader reader(data.data() + 2, data.size() - 2);
+    size_t position = 0;
+
+    InflateHuffman literalHuffman;
+    InflateHuffman distanceHuffman;
+
+    bool isFinal = false;
+    while (!isFinal) {
+        isFinal = reader.Read(1);
+        uint32_t type = reader.Read(2);
+
+        if (type == 0) {
+            reader.AlignToByte();
+
+            uint32_t length = reader.Read(16);
+            uint32_t complement = reader.Read(16);
+            if ((length ^ 0xFFFF) != complement || position + length > output.size()) {
+                Log(NOON_ANCHOR, "PNG has an invalid stored block");
+                return false;
+            }
+
+            for (uint32_t i = 0; i < length; ++i) {
+                output[position++] = static_cast<uint8_t>(reader.Read(8));
+            }
+        }
+        else if (type == 1 || type == 2) {
+            uint8_t lengthList[288 + 32];
+
+            uint32_t literalCount = 288;
+            uint32_t distanceCount = 30;
+
+            if (type == 1) {
+                memset(lengthList, 8, 144);
+                memset(lengthList + 144, 9, 112);
+                memset(lengthList + 256, 7, 24);
+                memset(lengthList + 280, 8, 8);
+                memset(lengthList + 288, 5, 30);
+            }
+            else {
+                literalCount = reader.Read(5) + 257;
+                distanceCount = reader.Read(5) + 1;
+                uint32_t codeLengthCount = reader.Read(4) + 4;
+
+                if (literalCount > 286 || distanceCount > 30) {
+                    Log(NOON_ANCHOR, "PNG has an invalid Huffman table");
+                    return false;
+                }
+
+                uint8_t codeLengthList[19] = {};
+                for (uint32_t i = 0; i < codeLengthCount; ++i) {
+                    codeLengthList[CodeLengthOrder[i]] = static_cast<uint8_t>(reader.Read(3));
+                }
+
+                InflateHuffman codeLengthHuffman;
+                if (!codeLengthHuffman.Build(codeLengthList, 19)) {
+                    Log(NOON_ANCHOR, "PNG has an invalid Huffman table");
+                    return false;
+                }
+
+                uint32_t index = 0;
+                while (index < literalCount + distanceCount) {
+                    int symbol = codeLengthHuffman.Decode(reader);
+                    if (symbol < 0) {
+                        Log(NOON_ANCHOR, "PNG has an invalid Huffman table");
+                        return false;
+                    }
+
+                    if (symbol < 16) {
+                        lengthList[index++] = static_cast<uint8_t>(symbol);
+                        continue;
+                    }
+
+                    uint8_t value = 0;
+                    uint32_t repeat = 0;
+                    if (symbol == 16) {
+                        if (index == 0) {
+                            Log(NOON_ANCHOR, "PNG has an invalid Huffman table");
+                            return false;
+                        }
+                        value = lengthList[index - 1];
+                        repeat = 3 + reader.Read(2);
+                    }
+                    else if (symbol == 17) {
+                        repeat = 3 + reader.Read(3);
+                    }
+                    else {
+                        repeat = 11 + reader.Read(7);
+                    }
+
+                    if (index + repeat > literalCount + distanceCount) {
+                        Log(NOON_ANCHOR, "PNG has an invalid Huffman table");
+                        return false;
+                    }
+
+                    memset(lengthList + index, value, repeat);
+                    index += repeat;
+                }
+
+                // Distance lengths follow the literal lengths directly
+                memmove(lengthList + 288, lengthList + literalCount, distanceCount);
+            }
+
+            if (!literalHuffman.Build(lengthList, literalCount) ||
+                !distanceHuffman.Build(lengthList + 288, distanceCount)) {
+                Log(NOON_ANCHOR, "PNG has an invalid Huffman table");
+                return false;
+            }
+
+            for (;;) {
+                int symbol = literalHuffman.Decode(reader);
+
+                if (symbol < 256) {
+                    if (symbol < 0 || position >= output.size()) {
+                        Log(NOON_ANCHOR, "PNG has invalid compressed data");
+                        return false;
+                    }
+
+                    output[position++] = static_cast<uint8_t>(symbol);
+                    continue;
+                }
+
+                if (symbol == 256) {
+                    break;
+                }
+
+                symbol -= 257;
+                if (symbol >= 29) {
+                    Log(NOON_ANCHOR, "PNG has invalid compressed data");
+                    return false;
+                }
+
+                uint32_t length = LengthBase[symbol] + reader.Read(LengthExtra[symbol]);
+
+                int distanceSymbol = distanceHuffman.Decode(reader);
+                if (distanceSymbol < 0 || distanceSymbol >= 30) {
+                    Log(NOON_ANCHOR, "PNG has invalid compressed data");
+                    return false;
+                }
+
+                uint32_t distance = DistanceBase[distanceSymbol] + reader.Read(DistanceExtra[distanceSymbol]);
+                if (distance > position || position + length > output.size()) {
+                    Log(NOON_ANCHOR, "PNG has invalid compressed data");
+                    return false;
+                }
+
+                // Copies can overlap what they write, which repeats the last distance bytes
+                const uint8_t * source = output.data() + position - distance;
+                uint8_t * destination = output.data() + position;
+                for (uint32_t i = 0; i < length; ++i) {
+                    destination[i] = source[i];
+                }
+                position += length;
+            }
+        }
+        else {
+            Log(NOON_ANCHOR, "PNG has an invalid block type");
+            return false;
+        }
+
+        if (reader.IsOverrun()) {
+            Log(NOON_ANCHOR, "PNG compressed data is truncated");
+            return false;
+        }
+    }
+
+    if (position != output.size()) {
+        Log(NOON_ANCHOR, "PNG has {} bytes of image data, expected {}", position, output.size());
+        return false;
+    }
+
+    return true;
+}
+
+static uint32_t ReadBigEndian32(const uint8_t * data)
+{
+    return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | uint32_t(data[3]);
+}
+
+static uint8_t Paeth(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+
+    if (pa <= pb && pa <= pc) {
+        return static_cast<uint8_t>(a);
+    }
+
+    return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+bool DecodePNG(Span<const uint8_t> data, List<uint8_t>& pixels, uint32_t& width, uint32_t& height)
+{
+    if (data.size() < sizeof(Signature) || memcmp(data.data(), Signature, sizeof(Signature)) != 0) {
+        Log(NOON_ANCHOR, "PNG has an invalid signature");
+        return false;
+    }
+
+    uint32_t bitDepth = 0;
+    uint32_t colorType = 0;
+    bool hasHeader = false;
+
+    uint8_t palette[256][4];
+    for (auto& entry : palette) {
+        entry[0] = 0;
+        entry[1] = 0;
+        entry[2] = 0;
+        entry[3] = 255;
+    }
+
+    // The gray or RGB value that is transparent, for color types without alpha
+    int transparent[3] = { -1, -1, -1 };
+
+    List<uint8_t> compressed;
+
+    size_t offset = sizeof(Signature);
+    while (offset + 12 <= data.size()) {
+        uint32_t length = ReadBigEndian32(data.data() + offset);
+        const uint8_t * type = data.data() + offset + 4;
+        const uint8_t * chunk = type + 4;
+
+        if (length > data.size() - offset - 12) {
+            Log(NOON_ANCHOR, "PNG chunk is truncated");
+            return false;
+        }
+
+        if (memcmp(type, "IHDR", 4) == 0 && length >= 13) {
+            width = ReadBigEndian32(chunk);
+            height = ReadBigEndian32(chunk + 4);
+            bitDepth = chunk[8];
+            colorType = chunk[9];
+
+            if (chunk[12] != 0) {
+                Log(NOON_ANCHOR, "Interlaced PNG is not supported");
+                return false;
+            }
+
+            hasHeader = true;
+        }
+        else if (memcmp(type, "PLTE", 4) == 0) {
+            for (uint32_t i = 0; i < std::min(length / 3, 256u); ++i) {
+                memcpy(palette[i], chunk + (i * 3), 3);
+            }
+        }
+        else if (memcmp(type, "tRNS", 4) == 0) {
+            if (colorType == 3) {
+                for (uint32_t i = 0; i < std::min(length, 256u); ++i) {
+                    palette[i][3] = chunk[i];
+                }
+            }
+            else if (colorType == 0 && length >= 2) {
+                transparent[0] = (chunk[0] << 8) | chunk[1];
+            }
+            else if (colorType == 2 && length >= 6) {
+                for (uint32_t c = 0; c < 3; ++c) {
+                    transparent[c] = (chunk[c * 2] << 8) | chunk[(c * 2) + 1];
+                }
+            }
+        }
+        else if (memcmp(type, "IDAT", 4) == 0) {
+            compressed.insert(compressed.end(), chunk, chunk + length);
+        }
+        else if (memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+
+        offset += length + 12;
+    }
+
+    if (!hasHeader || width == 0 || height == 0 || width > 32768 || height > 32768) {
+        Log(NOON_ANCHOR, "PNG has an invalid header");
+        return false;
+    }
+
+    static const uint32_t ChannelCountList[7] = { 1, 0, 3, 1, 2, 0, 4 };
+
+    uint32_t channelCount = (colorType < 7 ? ChannelCountList[colorType] : 0);
+    bool validDepth = (bitDepth == 8 || (bitDepth == 16 && colorType != 3) || (bitDepth < 8 && (colorType == 0 || colorType == 3) && (bitDepth == 1 || bitDepth == 2 || bitDepth == 4)));
+
+    if (channelCount == 0 || !validDepth) {
+        Log(NOON_ANCHOR, "PNG color type {} with bit depth {} is not supported", colorType, bitDepth);
+        return false;
+    }
+
+    uint32_t bitsPerPixel = channelCount * bitDepth;
+    size_t rowSize = ((size_t(width) * bitsPerPixel) + 7) / 8;
+
+    // Filters work on whole bytes, comparing each to the one a pixel before
+    size_t filterStride = std::max<size_t>(bitsPerPixel / 8, 1);
+
+    List<uint8_t> filtered((rowSize + 1) * height);
+    if (!Inflate(compressed, filtered)) {
+        return false;
+    }
+
+    List<uint8_t> previousRow(rowSize, 0);
+    List<uint8_t> row(rowSize);
+
+    pixels.resize(size_t(width) * height * 4);
+
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t * source = filtered.data() + (y * (rowSize + 1));
+        uint32_t filter = source[0];
+        ++source;
+
+        for (size_t i = 0; i < rowSize; ++i) {
+            int a = (i >= filterStride ? row[i - filterStride] : 0);
+            int b = previousRow[i];
+            int c = (i >= filterStride ? previousRow[i - filterStride] : 0);
+
+            switch (filter) {
+            case 0:
+                row[i] = source[i];
+                break;
+            case 1:
+                row[i] = static_cast<uint8_t>(source[i] + a);
+                break;
+            case 2:
+                row[i] = static_cast<uint8_t>(source[i] + b);
+                break;
+            case 3:
+                row[i] = static_cast<uint8_t>(source[i] + ((a + b) / 2));
+                break;
+            case 4:
+                row[i] = static_cast<uint8_t>(source[i] + Paeth(a, b, c));
+                break;
+            default:
+                Log(NOON_ANCHOR, "PNG has an invalid filter type {}", filter);
+                return false;
+            }
+        }
+
+        uint8_t * destination = pixels.data() + (size_t(y) * width * 4);
+
+        for (uint32_t x = 0; x < width; ++x) {
+            // Samples as they are stored, before scaling to 8 bits
+            uint32_t sample[4];
+            for (uint32_t c = 0; c < channelCount; ++c) {
+                size_t bit = ((size_t(x) * channelCount) + c) * bitDepth;
+                if (bitDepth == 16) {
+                    sample[c] = (uint32_t(row[bit / 8]) << 8) | row[(bit / 8) + 1];
+                }
+                else {
+                    sample[c] = (row[bit / 8] >> (8 - bitDepth - (bit % 8))) & ((1u << bitDepth) - 1);
+                }
+            }
+
+            auto toByte = [&](uint32_t value) {
+                if (bitDepth == 16) {
+                    return static_cast<uint8_t>(value >> 8);
+                }
+                return static_cast<uint8_t>((value * 255) / ((1u << bitDepth) - 1));
+            };
+
+            uint8_t * pixel = destination + (x * 4);
+
+            switch (colorType) {
+            case 0:
+                pixel[0] = pixel[1] = pixel[2] = toByte(sample[0]);
+                pixel[3] = (int(sample[0]) == transparent[0] ? 0 : 255);
+                break;
+            case 2:
+                for (uint32_t c = 0; c < 3; ++c) {
+                    pixel[c] = toByte(sample[c]);
+                }
+                pixel[3] = (int(sample[0]) == transparent[0] && int(sample[1]) == transparent[1] && int(sample[2]) == transparent[2] ? 0 : 255);
+                break;
+            case 3:
+                memcpy(pixel, palette[sample[0]], 4);
+                break;
+            case 4:
+                pixel[0] = pixel[1] = pixel[2] = toByte(sample[0]);
+                pixel[3] = toByte(sample[1]);
+                break;
+            default:
+                for (uint32_t c = 0; c < 4; ++c) {
+                    pixel[c] = toByte(sample[c]);
+                }
+                break;
+            }
+        }
+
+        std::swap(row, previousRow);
+    }
+
+    return true;
+}
+
+} // namespace noon
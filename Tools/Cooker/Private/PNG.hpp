@@ -0,0 +1,16 @@
+#ifndef NOON_COOKER_PNG_HPP
+#define NOON_COOKER_PNG_HPP
+
+#include <Noon/Containers.hpp>
+
+#include <cstdint>
+
+namespace noon {
+
+// Decodes a non-interlaced PNG of any color type to tightly packed RGBA8, 16-bit channels keep
+// their high byte. Returns false and logs why if the file is invalid or not supported.
+bool DecodePNG(Span<const uint8_t> data, List<uint8_t>& pixels, uint32_t& width, uint32_t& height);
+
+} // namespace noon
+
+#endif // NOON_COOKER_PNG_HPP
@@ -0,0 +1,208 @@
+#include <Noon/Culling.hpp>
+#include <Noon/JobSystem.hpp>
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <random>
+
+using namespace noon;
+
+static void PrintUsage()
+{
+    fmt::print("Usage: NoonCullBench [--objects N] [--iterations N] [--workers N]\n");
+    fmt::print("\n");
+    fmt::print("Culls N random spheres and boxes with every culling backend the CPU supports, checks\n");
+    fmt::print("that each finds the same visible objects as the scalar backend, and prints the best\n");
+    fmt::print("time of each, on one thread and split across the JobSystem.\n");
+}
+
+// A 90 degree frustum looking down +z, from 0.1 to 400
+static Frustum GetFrustum()
+{
+    const float k = 0.70710678f;
+
+    Frustum frustum;
+    frustum.Planes[Frustum::Left] = Vec4(k, 0.0f, k, 0.0f);
+    frustum.Planes[Frustum::Right] = Vec4(-k, 0.0f, k, 0.0f);
+    frustum.Planes[Frustum::Bottom] = Vec4(0.0f, k, k, 0.0f);
+    frustum.Planes[Frustum::Top] = Vec4(0.0f, -k, k, 0.0f);
+    frustum.Planes[Frustum::Near] = Vec4(0.0f, 0.0f, 1.0f, -0.1f);
+    frustum.Planes[Frustum::Far] = Vec4(0.0f, 0.0f, -1.0f, 400.0f);
+    return frustum;
+}
+
+// The number of objects in one list but not the other, both are sorted
+static size_t CountDifferences(const List<uint32_t>& a, const List<uint32_t>& b)
+{
+    List<uint32_t> difference;
+    std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(),
+        std::back_inserter(difference));
+    return difference.size();
+}
+
+// Returns the best time of the iterations in milliseconds
+template <class Func>
+static double Measure(size_t iterationCount, Func&& func)
+{
+    double best = 0.0;
+    for (size_t i = 0; i < iterationCount; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (i == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    return best;
+}
+
+static void PrintTime(const char * name, double milliseconds, size_t objectCount, double baseline)
+{
+    fmt::print("    {:<24} {:8.3f} ms  {:7.1f} M objects/s  {:5.2f}x\n",
+        name, milliseconds, objectCount / milliseconds / 1e3, baseline / milliseconds);
+}
+
+int main(int argc, char ** argv)
+{
+    size_t objectCount = 1'000'000;
+    size_t iterationCount = 20;
+    size_t workerCount = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--objects") == 0 && i + 1 < argc) {
+            objectCount = static_cast<size_t>(atoll(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterationCount = static_cast<size_t>(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workerCount = static_cast<size_t>(atoi(argv[++i]));
+        }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (objectCount == 0 || iterationCount == 0) {
+        PrintUsage();
+        return 1;
+    }
+
+    try {
+        JobSystem jobSystem(workerCount);
+
+        const Frustum frustum = GetFrustum();
+
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+        std::uniform_real_distribution<float> radius(0.5f, 5.0f);
+
+        List<BoundingSphere> sphereArray(objectCount);
+        List<AABB> aabbArray(objectCount);
+
+        BoundingSphereList sphereList;
+        AABBList aabbList;
+        sphereList.Resize(objectCount);
+        aabbList.Resize(objectCount);
+
+        for (size_t i = 0; i < objectCount; ++i) {
+            Vec3 center(position(rng), position(rng), position(rng));
+            float r = radius(rng);
+
+            sphereArray[i] = BoundingSphere{ center, r };
+            aabbArray[i] = AABB{ center - Vec3(r), center + Vec3(r) };
+
+            sphereList.Set(i, sphereArray[i]);
+            aabbList.Set(i, aabbArray[i]);
+        }
+
+        List<uint32_t> visibleIndexList(objectCount);
+
+        // Frustum::Intersects() one object at a time, as done before the lists existed
+        List<uint32_t> referenceSphereList;
+        List<uint32_t> referenceAABBList;
+        for (size_t i = 0; i < objectCount; ++i) {
+            if (frustum.Intersects(sphereArray[i])) {
+                referenceSphereList.push_back(static_cast<uint32_t>(i));
+            }
+            if (frustum.Intersects(aabbArray[i])) {
+                referenceAABBList.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        fmt::print("{} objects, {} spheres and {} boxes visible, best of {}, {} threads\n\n",
+            objectCount, referenceSphereList.size(), referenceAABBList.size(), iterationCount,
+            jobSystem.GetThreadCount());
+
+        double sphereBaseline = Measure(iterationCount, [&]() {
+            size_t visibleCount = 0;
+            for (size_t i = 0; i < objectCount; ++i) {
+                visibleIndexList[visibleCount] = static_cast<uint32_t>(i);
+                visibleCount += frustum.Intersects(sphereArray[i]);
+            }
+            return visibleCount;
+        });
+
+        double aabbBaseline = Measure(iterationCount, [&]() {
+            size_t visibleCount = 0;
+            for (size_t i = 0; i < objectCount; ++i) {
+                visibleIndexList[visibleCount] = static_cast<uint32_t>(i);
+                visibleCount += frustum.Intersects(aabbArray[i]);
+            }
+            return visibleCount;
+        });
+
+        fmt::print("Frustum::Intersects\n");
+        PrintTime("spheres", sphereBaseline, objectCount, sphereBaseline);
+        PrintTime("boxes", aabbBaseline, objectCount, aabbBaseline);
+
+        for (auto backend : { CullingBackend::Scalar, CullingBackend::SSE, CullingBackend::AVX2, CullingBackend::NEON }) {
+            if (!IsCullingBackendSupported(backend)) {
+                continue;
+            }
+
+            SetCullingBackend(backend);
+
+            List<uint32_t> sphereResult;
+            List<uint32_t> aabbResult;
+            ParallelCullSpheres(frustum, sphereList, sphereResult);
+            ParallelCullAABBs(frustum, aabbList, aabbResult);
+
+            size_t sphereDifferenceCount = CountDifferences(sphereResult, referenceSphereList);
+            size_t aabbDifferenceCount = CountDifferences(aabbResult, referenceAABBList);
+
+            fmt::print("{}, {} spheres and {} boxes differ from Frustum::Intersects\n",
+                CullingBackendToString(backend), sphereDifferenceCount, aabbDifferenceCount);
+
+            PrintTime("spheres", Measure(iterationCount, [&]() {
+                return CullSpheres(frustum, sphereList, 0, objectCount, visibleIndexList.data());
+            }), objectCount, sphereBaseline);
+
+            PrintTime("boxes", Measure(iterationCount, [&]() {
+                return CullAABBs(frustum, aabbList, 0, objectCount, visibleIndexList.data());
+            }), objectCount, aabbBaseline);
+
+            PrintTime("spheres, parallel", Measure(iterationCount, [&]() {
+                ParallelCullSpheres(frustum, sphereList, sphereResult);
+            }), objectCount, sphereBaseline);
+
+            PrintTime("boxes, parallel", Measure(iterationCount, [&]() {
+                ParallelCullAABBs(frustum, aabbList, aabbResult);
+            }), objectCount, aabbBaseline);
+        }
+    }
+    catch (std::exception& e) {
+        fmt::print("Exception: {}\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
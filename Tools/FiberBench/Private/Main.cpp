@@ -0,0 +1,295 @@
+#include <Noon/Fiber.hpp>
+#include <Noon/JobSystem.hpp>
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+using namespace noon;
+
+using Clock = std::chrono::steady_clock;
+
+static void PrintUsage()
+{
+    fmt::print("Usage: NoonFiberBench [--workers N] [--switches N] [--jobs N] [--latency MS]\n");
+    fmt::print("\n");
+    fmt::print("Measures the cost of switching between two fibers, and of a job waiting on a counter\n");
+    fmt::print("and being resumed once it is done.\n");
+    fmt::print("\n");
+    fmt::print("Then runs --jobs jobs which each wait --latency milliseconds for a simulated read,\n");
+    fmt::print("once suspending on a counter signalled by another thread and once blocking their\n");
+    fmt::print("worker, and compares how long each takes.\n");
+}
+
+static double GetElapsedMilliseconds(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct SwitchContext
+{
+    Fiber * MainFiber;
+
+    Fiber * OtherFiber;
+
+    size_t Count;
+
+}; // struct SwitchContext
+
+static void SwitchMain(void * data)
+{
+    auto context = static_cast<SwitchContext *>(data);
+
+    while (true) {
+        ++context->Count;
+        context->OtherFiber->SwitchTo(*context->MainFiber);
+    }
+}
+
+static void BenchmarkSwitch(size_t switchCount)
+{
+    SwitchContext context = { };
+
+    Fiber mainFiber;
+    Fiber otherFiber(&SwitchMain, &context);
+    context.MainFiber = &mainFiber;
+    context.OtherFiber = &otherFiber;
+
+    auto start = Clock::now();
+
+    for (size_t i = 0; i < switchCount; ++i) {
+        mainFiber.SwitchTo(otherFiber);
+    }
+
+    double elapsed = GetElapsedMilliseconds(start);
+
+    fmt::print("Fiber switch: {} round trips, {:.1f} ns per switch\n",
+        context.Count, (elapsed * 1e6) / (2.0 * switchCount));
+}
+
+// A job repeatedly schedules a job and waits for it, so each iteration suspends the fiber and
+// resumes it once the other job has finished
+static void BenchmarkWaitResume(JobSystem& jobSystem, size_t iterationCount)
+{
+    std::atomic<size_t> runCount = 0;
+
+    JobCounter counter;
+
+    auto start = Clock::now();
+
+    jobSystem.Schedule(
+        [&]() {
+            for (size_t i = 0; i < iterationCount; ++i) {
+                JobCounter childCounter;
+                jobSystem.Schedule([&]() { ++runCount; }, &childCounter);
+                jobSystem.Wait(childCounter);
+            }
+        },
+        &counter);
+
+    jobSystem.Wait(counter);
+
+    double elapsed = GetElapsedMilliseconds(start);
+
+    fmt::print("Wait and resume: {} iterations, {:.2f} us each, {}\n",
+        iterationCount, (elapsed * 1e3) / iterationCount,
+        (runCount == iterationCount ? "ok" : "FAILED"));
+}
+
+// Completes each read latency after it was submitted, as if they were all in flight at once
+class SimulatedReader
+{
+public:
+
+    SimulatedReader(JobSystem& jobSystem, std::chrono::microseconds latency)
+        : _jobSystem(jobSystem)
+        , _latency(latency)
+        , _thread(&SimulatedReader::ThreadMain, this)
+    { }
+
+    ~SimulatedReader() {
+        {
+            std::lock_guard lock(_mutex);
+            _running = false;
+        }
+
+        _condition.notify_one();
+        _thread.join();
+    }
+
+    void Read(JobCounter& counter) {
+        _jobSystem.Increment(counter);
+
+        {
+            std::lock_guard lock(_mutex);
+            _requestQueue.push_back({ Clock::now() + _latency, &counter });
+        }
+
+        _condition.notify_one();
+    }
+
+private:
+
+    struct Request
+    {
+        Clock::time_point Deadline;
+
+        JobCounter * Counter;
+
+    }; // struct Request
+
+    void ThreadMain() {
+        std::unique_lock lock(_mutex);
+
+        while (_running) {
+            if (_requestQueue.empty()) {
+                _condition.wait(lock);
+                continue;
+            }
+
+            // Requests are queued in order of submission, so the front is always due first
+            Request request = _requestQueue.front();
+            if (Clock::now() < request.Deadline) {
+                _condition.wait_until(lock, request.Deadline);
+                continue;
+            }
+
+            _requestQueue.pop_front();
+
+            lock.unlock();
+            _jobSystem.Signal(*request.Counter);
+            lock.lock();
+        }
+    }
+
+    JobSystem& _jobSystem;
+
+    std::chrono::microseconds _latency;
+
+    std::mutex _mutex;
+
+    std::condition_variable _condition;
+
+    Queue<Request> _requestQueue;
+
+    bool _running = true;
+
+    std::thread _thread;
+
+}; // class SimulatedReader
+
+static void BenchmarkWaitableJobs(JobSystem& jobSystem, size_t jobCount, std::chrono::microseconds latency)
+{
+    std::atomic<size_t> doneCount = 0;
+
+    double suspendElapsed;
+    {
+        SimulatedReader reader(jobSystem, latency);
+
+        JobCounter counter;
+
+        auto start = Clock::now();
+
+        for (size_t i = 0; i < jobCount; ++i) {
+            jobSystem.Schedule(
+                [&]() {
+                    JobCounter readCounter;
+                    reader.Read(readCounter);
+                    jobSystem.Wait(readCounter);
+                    ++doneCount;
+                },
+                &counter);
+        }
+
+        jobSystem.Wait(counter);
+
+        suspendElapsed = GetElapsedMilliseconds(start);
+    }
+
+    fmt::print("Waitable jobs: {} jobs waiting {:.1f} ms each, {:.2f} ms total, {}\n",
+        jobCount, latency.count() / 1e3, suspendElapsed,
+        (doneCount == jobCount ? "ok" : "FAILED"));
+
+    doneCount = 0;
+
+    double blockElapsed;
+    {
+        JobCounter counter;
+
+        auto start = Clock::now();
+
+        for (size_t i = 0; i < jobCount; ++i) {
+            jobSystem.Schedule(
+                [&]() {
+                    std::this_thread::sleep_for(latency);
+                    ++doneCount;
+                },
+                &counter);
+        }
+
+        jobSystem.Wait(counter);
+
+        blockElapsed = GetElapsedMilliseconds(start);
+    }
+
+    fmt::print("Blocking jobs: {} jobs waiting {:.1f} ms each, {:.2f} ms total, {}\n",
+        jobCount, latency.count() / 1e3, blockElapsed,
+        (doneCount == jobCount ? "ok" : "FAILED"));
+
+    fmt::print("Suspending is {:.1f}x faster than blocking on {} threads\n",
+        blockElapsed / suspendElapsed, jobSystem.GetThreadCount());
+}
+
+int main(int argc, char ** argv)
+{
+    size_t workerCount = 0;
+    size_t switchCount = 10'000'000;
+    size_t jobCount = 256;
+    int latencyMilliseconds = 2;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workerCount = static_cast<size_t>(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--switches") == 0 && i + 1 < argc) {
+            switchCount = static_cast<size_t>(atoll(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobCount = static_cast<size_t>(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc) {
+            latencyMilliseconds = atoi(argv[++i]);
+        }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (switchCount == 0 || jobCount == 0 || latencyMilliseconds < 0) {
+        PrintUsage();
+        return 1;
+    }
+
+    try {
+        BenchmarkSwitch(switchCount);
+
+        JobSystem jobSystem(workerCount);
+
+        BenchmarkWaitResume(jobSystem, std::max<size_t>(switchCount / 100, 1));
+        BenchmarkWaitableJobs(jobSystem, jobCount, std::chrono::milliseconds(latencyMilliseconds));
+    }
+    catch (std::exception& e) {
+        fmt::print("Exception: {}\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,284 @@
+#include <Noon/AsyncIO.hpp>
+#include <Noon/JobSystem.hpp>
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+    #include <Windows.h>
+
+#else
+
+    #include <fcntl.h>
+    #include <unistd.h>
+
+#endif
+
+using namespace noon;
+
+static void PrintUsage()
+{
+    fmt::print("Usage: NoonIOBench [--file FILE] [--file-size MIB] [--reads N] [--chunk KIB] [--warm]\n");
+    fmt::print("\n");
+    fmt::print("Reads N random chunks of a file, as asset streaming would, once with one blocking\n");
+    fmt::print("read at a time, once through AsyncIO's thread pool, and once through io_uring where\n");
+    fmt::print("it is available. The file is created if it doesn't exist, and is dropped from the page\n");
+    fmt::print("cache before each pass unless --warm is given, so the drive itself is measured.\n");
+}
+
+// Each byte depends on its offset, so reads can be checked without keeping a copy of the file
+static inline uint8_t GetExpectedByte(uint64_t offset)
+{
+    return static_cast<uint8_t>((offset * 7) ^ (offset >> 20));
+}
+
+static bool WriteTestFile(const Path& path, uint64_t size)
+{
+    FILE * file = fopen(path.ToCString(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    List<uint8_t> block(1 << 20);
+    for (uint64_t offset = 0; offset < size; offset += block.size()) {
+        for (size_t i = 0; i < block.size(); ++i) {
+            block[i] = GetExpectedByte(offset + i);
+        }
+
+        size_t blockSize = static_cast<size_t>(std::min<uint64_t>(block.size(), size - offset));
+        if (fwrite(block.data(), 1, blockSize, file) != blockSize) {
+            fclose(file);
+            return false;
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+// Best effort, only Linux can drop a single file from the cache without privileges
+static void EvictFromCache(const Path& path)
+{
+#if defined(NOON_PLATFORM_LINUX)
+
+    int fd = open(path.ToCString(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+
+#else
+
+    (void)path;
+
+#endif
+}
+
+struct Pass
+{
+    const char * Name;
+
+    double Milliseconds;
+
+    size_t FailedCount;
+
+}; // struct Pass
+
+static void PrintPass(const Pass& pass, size_t readCount, uint64_t chunkSize, double baseline)
+{
+    double seconds = pass.Milliseconds / 1e3;
+
+    fmt::print("    {:<10} {:9.1f} ms {:8.0f} MB/s {:9.0f} reads/s {:6.2f}x  {}\n",
+        pass.Name,
+        pass.Milliseconds,
+        (readCount * chunkSize) / seconds / 1e6,
+        readCount / seconds,
+        baseline / pass.Milliseconds,
+        (pass.FailedCount == 0 ? "ok" : fmt::format("{} FAILED", pass.FailedCount)));
+}
+
+int main(int argc, char ** argv)
+{
+    Path path = "NoonIOBench.bin";
+    uint64_t fileSize = 512ull << 20;
+    size_t readCount = 8192;
+    uint64_t chunkSize = 64 << 10;
+    bool warm = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--file") == 0 && i + 1 < argc) {
+            path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--file-size") == 0 && i + 1 < argc) {
+            fileSize = static_cast<uint64_t>(atoll(argv[++i])) << 20;
+        }
+        else if (strcmp(argv[i], "--reads") == 0 && i + 1 < argc) {
+            readCount = static_cast<size_t>(atoll(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) {
+            chunkSize = static_cast<uint64_t>(atoll(argv[++i])) << 10;
+        }
+        else if (strcmp(argv[i], "--warm") == 0) {
+            warm = true;
+        }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (readCount == 0 || chunkSize == 0 || fileSize < chunkSize) {
+        PrintUsage();
+        return 1;
+    }
+
+    try {
+        JobSystem jobSystem;
+
+        IOFile file;
+        if (!file.Open(path) || file.GetSize() < fileSize) {
+            file.Close();
+
+            fmt::print("Creating {} MiB '{}'\n", fileSize >> 20, path);
+            if (!WriteTestFile(path, fileSize) || !file.Open(path)) {
+                fmt::print("Failed to create '{}'\n", path);
+                return 1;
+            }
+        }
+
+        // Chunk-aligned offsets, like assets packed at an alignment
+        std::mt19937_64 rng(1);
+        List<uint64_t> offsetList(readCount);
+        for (auto& offset : offsetList) {
+            offset = (rng() % (fileSize / chunkSize)) * chunkSize;
+        }
+
+        List<uint8_t> destination(readCount * chunkSize);
+
+        auto countFailures = [&](const List<std::atomic<IOStatus>>& statusList) {
+            size_t failedCount = 0;
+            for (size_t i = 0; i < readCount; ++i) {
+                // One byte per page is enough to catch a read landing in the wrong place
+                bool isValid = (statusList.empty() || statusList[i] == IOStatus::Complete);
+                for (uint64_t j = 0; j < chunkSize && isValid; j += 4096) {
+                    isValid = (destination[i * chunkSize + j] == GetExpectedByte(offsetList[i] + j));
+                }
+
+                failedCount += !isValid;
+            }
+
+            return failedCount;
+        };
+
+        auto run = [&](const char * name, auto&& func) {
+            std::fill(destination.begin(), destination.end(), uint8_t(0));
+
+            if (!warm) {
+                EvictFromCache(path);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            size_t failedCount = func();
+            double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            return Pass{ name, elapsed, failedCount };
+        };
+
+        List<Pass> passList;
+
+        passList.push_back(run("blocking", [&]() {
+            size_t failedCount = 0;
+
+#if defined(NOON_PLATFORM_WINDOWS)
+
+            HANDLE handle = CreateFileA(path.ToCString(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+            for (size_t i = 0; i < readCount; ++i) {
+                OVERLAPPED overlapped = {};
+                overlapped.Offset = static_cast<DWORD>(offsetList[i]);
+                overlapped.OffsetHigh = static_cast<DWORD>(offsetList[i] >> 32);
+
+                DWORD bytesRead = 0;
+                ReadFile(handle, &destination[i * chunkSize], static_cast<DWORD>(chunkSize), &bytesRead, &overlapped);
+            }
+
+            CloseHandle(handle);
+
+#else
+
+            int fd = open(path.ToCString(), O_RDONLY | O_CLOEXEC);
+            for (size_t i = 0; i < readCount; ++i) {
+                if (pread(fd, &destination[i * chunkSize], chunkSize, static_cast<off_t>(offsetList[i])) != static_cast<ssize_t>(chunkSize)) {
+                    ++failedCount;
+                }
+            }
+
+            close(fd);
+
+#endif
+
+            return failedCount + countFailures({ });
+        }));
+
+        for (bool forceFallback : { true, false }) {
+            AsyncIO asyncIO(forceFallback);
+            if (!forceFallback && !asyncIO.IsUsingIOUring()) {
+                break;
+            }
+
+            List<std::atomic<IOStatus>> statusList(readCount);
+            JobCounter counter;
+
+            List<IORead> readList(readCount);
+            for (size_t i = 0; i < readCount; ++i) {
+                readList[i] = IORead{
+                    .File = &file,
+                    .Offset = offsetList[i],
+                    .Size = chunkSize,
+                    .Destination = &destination[i * chunkSize],
+                    .Priority = IOPriority::Normal,
+                    .Counter = &counter,
+                    .Status = &statusList[i],
+                };
+            }
+
+            passList.push_back(run((forceFallback ? "threads" : "io_uring"), [&]() {
+                asyncIO.Read(Span<const IORead>(readList.data(), readList.size()));
+                jobSystem.Wait(counter);
+                return countFailures(statusList);
+            }));
+        }
+
+        fmt::print("{} random reads of {} KiB from {} MiB, {} cache\n",
+            readCount, chunkSize >> 10, fileSize >> 20, (warm ? "warm" : "cold"));
+
+        for (const auto& pass : passList) {
+            PrintPass(pass, readCount, chunkSize, passList.front().Milliseconds);
+        }
+
+        bool isValid = std::all_of(passList.begin(), passList.end(),
+            [](const Pass& pass) {
+                return (pass.FailedCount == 0);
+            });
+
+        if (!isValid) {
+            return 1;
+        }
+    }
+    catch (std::exception& e) {
+        fmt::print("Exception: {}\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
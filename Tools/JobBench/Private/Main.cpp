@@ -0,0 +1,230 @@
+#include <Noon/JobSystem.hpp>
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+using namespace noon;
+
+static void PrintUsage()
+{
+    fmt::print("Usage: NoonJobBench [--threads N[,N...]] [--elements N] [--iterations N]\n");
+    fmt::print("\n");
+    fmt::print("For each thread count, checks that ParallelFor() calls every index exactly once with\n");
+    fmt::print("ranges that respect the minimum batch size and alignment, then times a compute-bound\n");
+    fmt::print("loop over N elements and an empty ParallelFor(). One thread runs without a JobSystem,\n");
+    fmt::print("and is the baseline the others are compared with. Defaults to 1,2,4,8 threads.\n");
+}
+
+struct Range
+{
+    size_t First;
+
+    size_t Last;
+
+}; // struct Range
+
+// Returns the number of parameter combinations that failed
+static size_t CheckParallelFor()
+{
+    static const size_t CountList[] = { 0, 1, 2, 7, 63, 64, 65, 1000, 4097, 100003, 1 << 20 };
+    static const size_t MinBatchSizeList[] = { 0, 1, 16, 1000, 4096 };
+    static const size_t AlignmentList[] = { 1, 4, 64 };
+
+    size_t failedCount = 0;
+
+    for (size_t count : CountList) {
+        List<std::atomic<uint32_t>> visitList(count);
+
+        for (size_t minBatchSize : MinBatchSizeList) {
+            for (size_t alignment : AlignmentList) {
+                for (auto& visit : visitList) {
+                    visit.store(0, std::memory_order_relaxed);
+                }
+
+                std::mutex mutex;
+                List<Range> rangeList;
+
+                ParallelFor(count, minBatchSize,
+                    [&](size_t first, size_t last) {
+                        for (size_t i = first; i < last; ++i) {
+                            visitList[i].fetch_add(1, std::memory_order_relaxed);
+                        }
+
+                        std::lock_guard lock(mutex);
+                        rangeList.push_back({ first, last });
+                    },
+                    alignment);
+
+                bool isValid = std::all_of(visitList.begin(), visitList.end(),
+                    [](const std::atomic<uint32_t>& visit) {
+                        return (visit.load(std::memory_order_relaxed) == 1);
+                    });
+
+                // Only the last range may be short, and every range must start aligned
+                for (const auto& range : rangeList) {
+                    bool isLast = (range.Last == count);
+                    if (range.First >= range.Last
+                        || range.First % alignment != 0
+                        || (!isLast && range.Last - range.First < std::min(minBatchSize, count))) {
+                        isValid = false;
+                    }
+                }
+
+                if (!isValid) {
+                    fmt::print("    FAILED count={} minBatchSize={} alignment={}, {} ranges\n",
+                        count, minBatchSize, alignment, rangeList.size());
+                    ++failedCount;
+                }
+            }
+        }
+    }
+
+    return failedCount;
+}
+
+// Returns the best time of the iterations in milliseconds
+template <class Func>
+static double Measure(size_t iterationCount, Func&& func)
+{
+    double best = 0.0;
+    for (size_t i = 0; i < iterationCount; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (i == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    return best;
+}
+
+struct Result
+{
+    double ComputeMilliseconds;
+
+    double EmptyMicroseconds;
+
+}; // struct Result
+
+static Result Benchmark(size_t elementCount, size_t iterationCount)
+{
+    List<float> outputList(elementCount);
+
+    Result result;
+
+    result.ComputeMilliseconds = Measure(iterationCount, [&]() {
+        ParallelFor(elementCount, 16 * 1024,
+            [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i) {
+                    float x = static_cast<float>(i);
+                    for (int k = 0; k < 50; ++k) {
+                        x = std::sqrt(x + static_cast<float>(k));
+                    }
+                    outputList[i] = x;
+                }
+            });
+    });
+
+    const size_t EmptyCallCount = 1000;
+
+    result.EmptyMicroseconds = Measure(iterationCount, [&]() {
+        for (size_t i = 0; i < EmptyCallCount; ++i) {
+            ParallelFor(64 * 1024, 1024, [](size_t, size_t) { });
+        }
+    }) * 1e3 / EmptyCallCount;
+
+    return result;
+}
+
+int main(int argc, char ** argv)
+{
+    List<size_t> threadCountList = { 1, 2, 4, 8 };
+    size_t elementCount = 4'000'000;
+    size_t iterationCount = 5;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCountList.clear();
+
+            for (const char * str = argv[++i]; *str; ) {
+                char * end = nullptr;
+                threadCountList.push_back(static_cast<size_t>(strtoul(str, &end, 10)));
+                str = (*end == ',' ? end + 1 : end);
+            }
+        }
+        else if (strcmp(argv[i], "--elements") == 0 && i + 1 < argc) {
+            elementCount = static_cast<size_t>(atoll(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterationCount = static_cast<size_t>(atoi(argv[++i]));
+        }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    bool isValid = !threadCountList.empty() && iterationCount > 0 && std::none_of(
+        threadCountList.begin(), threadCountList.end(),
+        [](size_t threadCount) {
+            return (threadCount == 0);
+        });
+
+    if (!isValid) {
+        PrintUsage();
+        return 1;
+    }
+
+    fmt::print("{} elements, best of {}, {} hardware threads\n\n",
+        elementCount, iterationCount, std::thread::hardware_concurrency());
+
+    try {
+        size_t failedCount = 0;
+        std::optional<Result> baseline;
+
+        for (size_t threadCount : threadCountList) {
+            // The JobSystem always creates one worker per core when asked for none
+            std::optional<JobSystem> jobSystem;
+            if (threadCount > 1) {
+                jobSystem.emplace(threadCount - 1);
+            }
+
+            fmt::print("{} threads\n", threadCount);
+
+            failedCount += CheckParallelFor();
+
+            Result result = Benchmark(elementCount, iterationCount);
+            if (!baseline) {
+                baseline = result;
+            }
+
+            fmt::print("    compute {:8.2f} ms  {:5.2f}x    empty ParallelFor {:7.2f} us\n",
+                result.ComputeMilliseconds,
+                baseline->ComputeMilliseconds / result.ComputeMilliseconds,
+                result.EmptyMicroseconds);
+        }
+
+        fmt::print("\n{}\n", (failedCount == 0 ? "Every ParallelFor was correct" : "ParallelFor FAILED"));
+
+        if (failedCount > 0) {
+            return 1;
+        }
+    }
+    catch (std::exception& e) {
+        fmt::print("Exception: {}\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
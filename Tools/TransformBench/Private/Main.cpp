@@ -0,0 +1,233 @@
+#include <Noon/JobSystem.hpp>
+#include <Noon/TransformHierarchy.hpp>
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+
+using namespace noon;
+
+static void PrintUsage()
+{
+    fmt::print("Usage: NoonTransformBench [--nodes N] [--dirty PERCENT] [--frames N] [--workers N]\n");
+    fmt::print("\n");
+    fmt::print("Builds hierarchies of N nodes, then each frame moves PERCENT of the nodes and times\n");
+    fmt::print("TransformHierarchy::Update(). Once all frames have run, every world matrix is checked\n");
+    fmt::print("against the sum of its ancestors' translations. Defaults to 500000 nodes, 1% dirty.\n");
+}
+
+enum class Shape
+{
+    // Objects of 50 nodes, each node parented to one of the few nodes added before it
+    Objects,
+
+    // 100 roots, and every other node parented to a random earlier node
+    RandomTree,
+
+}; // enum class Shape
+
+struct Scene
+{
+    TransformHierarchy Hierarchy;
+
+    List<TransformHandle> HandleList;
+
+    // Indexed like HandleList, every parent is added before its children
+    List<uint32_t> ParentList;
+
+    List<Vec3> PositionList;
+
+}; // struct Scene
+
+static void BuildScene(Scene& scene, Shape shape, size_t nodeCount, std::mt19937& rng)
+{
+    const uint32_t NoParent = std::numeric_limits<uint32_t>::max();
+
+    for (size_t i = 0; i < nodeCount; ++i) {
+        uint32_t parent = NoParent;
+
+        if (shape == Shape::Objects) {
+            size_t local = i % 50;
+            if (local > 0) {
+                parent = static_cast<uint32_t>(i - 1 - rng() % std::min<size_t>(local, 4));
+            }
+        }
+        else if (i >= 100) {
+            parent = static_cast<uint32_t>(rng() % i);
+        }
+
+        TransformHandle handle = scene.Hierarchy.Add(
+            parent == NoParent ? InvalidTransformHandle : scene.HandleList[parent]);
+
+        scene.HandleList.push_back(handle);
+        scene.ParentList.push_back(parent);
+        scene.PositionList.push_back(Vec3(1.0f, 0.0f, 0.0f));
+
+        scene.Hierarchy.SetLocalPosition(handle, scene.PositionList.back());
+    }
+
+    scene.Hierarchy.Update();
+}
+
+// Returns the number of nodes whose world translation is wrong
+static size_t CheckScene(const Scene& scene)
+{
+    const uint32_t NoParent = std::numeric_limits<uint32_t>::max();
+
+    // Parents come first, so their expected translation is always ready
+    List<Vec3> expectedList(scene.HandleList.size());
+
+    size_t failedCount = 0;
+    for (size_t i = 0; i < scene.HandleList.size(); ++i) {
+        uint32_t parent = scene.ParentList[i];
+
+        expectedList[i] = scene.PositionList[i];
+        if (parent != NoParent) {
+            expectedList[i] += expectedList[parent];
+        }
+
+        // Small whole numbers, so the sums are exact
+        const Mat4& world = scene.Hierarchy.GetWorldMatrix(scene.HandleList[i]);
+        if (Vec3(world[3]) != expectedList[i]) {
+            ++failedCount;
+        }
+    }
+
+    return failedCount;
+}
+
+struct Result
+{
+    double AverageMilliseconds;
+
+    double WorstMilliseconds;
+
+    size_t AverageChangedCount;
+
+}; // struct Result
+
+// Moves dirtyCount nodes picked from candidateList each frame
+static Result Benchmark(Scene& scene, const List<uint32_t>& candidateList, size_t dirtyCount, size_t frameCount, std::mt19937& rng)
+{
+    Result result = { };
+
+    for (size_t frame = 0; frame < frameCount; ++frame) {
+        for (size_t i = 0; i < dirtyCount; ++i) {
+            uint32_t node = candidateList[rng() % candidateList.size()];
+
+            scene.PositionList[node] = Vec3(1.0f, static_cast<float>(frame % 8), 0.0f);
+            scene.Hierarchy.SetLocalPosition(scene.HandleList[node], scene.PositionList[node]);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        scene.Hierarchy.Update();
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        result.AverageMilliseconds += elapsed;
+        result.WorstMilliseconds = std::max(result.WorstMilliseconds, elapsed);
+        result.AverageChangedCount += scene.Hierarchy.GetChangedList().size();
+    }
+
+    result.AverageMilliseconds /= frameCount;
+    result.AverageChangedCount /= frameCount;
+    return result;
+}
+
+int main(int argc, char ** argv)
+{
+    size_t nodeCount = 500'000;
+    double dirtyPercent = 1.0;
+    size_t frameCount = 100;
+    size_t workerCount = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--nodes") == 0 && i + 1 < argc) {
+            nodeCount = static_cast<size_t>(atoll(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--dirty") == 0 && i + 1 < argc) {
+            dirtyPercent = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frameCount = static_cast<size_t>(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workerCount = static_cast<size_t>(atoi(argv[++i]));
+        }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (nodeCount < 100 || frameCount == 0 || dirtyPercent <= 0.0 || dirtyPercent > 100.0) {
+        PrintUsage();
+        return 1;
+    }
+
+    size_t dirtyCount = std::max<size_t>(static_cast<size_t>(nodeCount * dirtyPercent / 100.0), 1);
+
+    try {
+        JobSystem jobSystem(workerCount);
+
+        fmt::print("{} nodes, {} dirty per frame, {} frames, {} threads\n\n",
+            nodeCount, dirtyCount, frameCount, jobSystem.GetThreadCount());
+
+        size_t failedCount = 0;
+
+        for (Shape shape : { Shape::Objects, Shape::RandomTree }) {
+            std::mt19937 rng(1);
+
+            Scene scene;
+            BuildScene(scene, shape, nodeCount, rng);
+
+            // Nodes without children, which is how most moving objects are attached
+            List<uint8_t> hasChildList(nodeCount, 0);
+            for (uint32_t parent : scene.ParentList) {
+                if (parent < nodeCount) {
+                    hasChildList[parent] = 1;
+                }
+            }
+
+            List<uint32_t> leafList;
+            List<uint32_t> nodeList(nodeCount);
+            for (uint32_t i = 0; i < nodeCount; ++i) {
+                nodeList[i] = i;
+                if (!hasChildList[i]) {
+                    leafList.push_back(i);
+                }
+            }
+
+            fmt::print("{}\n", (shape == Shape::Objects ? "Objects of 50 nodes" : "Random tree"));
+
+            for (bool leavesOnly : { true, false }) {
+                Result result = Benchmark(scene, (leavesOnly ? leafList : nodeList), dirtyCount, frameCount, rng);
+
+                size_t sceneFailedCount = CheckScene(scene);
+                failedCount += sceneFailedCount;
+
+                fmt::print("    {:<14} {:7.3f} ms average {:7.3f} ms worst {:8} nodes changed  {:5.1f} ns/node  {}\n",
+                    (leavesOnly ? "leaves dirty" : "any dirty"),
+                    result.AverageMilliseconds,
+                    result.WorstMilliseconds,
+                    result.AverageChangedCount,
+                    result.AverageMilliseconds * 1e6 / std::max<size_t>(result.AverageChangedCount, 1),
+                    (sceneFailedCount == 0 ? "ok" : fmt::format("{} FAILED", sceneFailedCount)));
+            }
+        }
+
+        if (failedCount > 0) {
+            return 1;
+        }
+    }
+    catch (std::exception& e) {
+        fmt::print("Exception: {}\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,434 @@
+#include <Noon/Exception.hpp>
+#include <Noon/GLTFModel.hpp>
+#include <Noon/JobSystem.hpp>
+#include <Noon/VertexFormat.hpp>
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace noon;
+
+static void PrintUsage()
+{
+    fmt::print("Usage: NoonVertexBench [--vertices N] [--model FILE]\n");
+    fmt::print("\n");
+    fmt::print("Packs vertex data at full precision, with the encodings VertexFormat::Choose() picks,\n");
+    fmt::print("and with 8-bit octahedral normals and tangents. Each packing is decoded the way the\n");
+    fmt::print("shaders in VertexAttributes.inc.glsl do, and compared with the original data.\n");
+    fmt::print("\n");
+    fmt::print("The data is N random vertices, or every primitive of a .gltf or .glb model.\n");
+}
+
+// Random positions far from the origin, unit normals and tangents, and texture coordinates
+// both inside and outside of [0, 1]
+static VertexData GenerateVertexData(size_t vertexCount)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+
+    auto randomDirection = [&]() {
+        Vec3 direction;
+        do {
+            direction = Vec3(normal(rng), normal(rng), normal(rng));
+        } while (glm::length(direction) < 1e-4f);
+
+        return glm::normalize(direction);
+    };
+
+    VertexData vertexData;
+    vertexData.Positions.resize(vertexCount);
+    vertexData.Normals.resize(vertexCount);
+    vertexData.Tangents.resize(vertexCount);
+    vertexData.Colors.resize(vertexCount);
+    vertexData.TexCoords1.resize(vertexCount);
+    vertexData.TexCoords2.resize(vertexCount);
+    vertexData.Joints.resize(vertexCount);
+    vertexData.Weights.resize(vertexCount);
+
+    for (size_t v = 0; v < vertexCount; ++v) {
+        vertexData.Positions[v] = Vec3(1000.0f, 0.0f, -250.0f)
+            + Vec3(unit(rng) * 100.0f, unit(rng) * 20.0f, unit(rng) * 50.0f);
+
+        Vec3 n = randomDirection();
+        Vec3 t = glm::normalize(glm::cross(n, randomDirection()));
+        vertexData.Normals[v] = n;
+        vertexData.Tangents[v] = Vec4(t, (unit(rng) < 0.5f ? -1.0f : 1.0f));
+
+        vertexData.Colors[v] = Vec4(unit(rng), unit(rng), unit(rng), unit(rng));
+        vertexData.TexCoords1[v] = Vec2(unit(rng), unit(rng));
+        vertexData.TexCoords2[v] = Vec2(unit(rng) * 4.0f - 2.0f, unit(rng) * 4.0f - 2.0f);
+
+        Vec4 weights(unit(rng), unit(rng), unit(rng), unit(rng));
+        vertexData.Joints[v] = Vec4u(rng() % 200, rng() % 200, rng() % 200, rng() % 200);
+        vertexData.Weights[v] = weights / (weights.x + weights.y + weights.z + weights.w);
+    }
+
+    return vertexData;
+}
+
+template <typename T>
+static void AppendList(List<T>& list, const List<T>& other, size_t vertexCount, size_t otherCount)
+{
+    // Attributes only some primitives have are dropped, rather than padded
+    if (list.size() != vertexCount || other.size() != otherCount) {
+        list.clear();
+        return;
+    }
+
+    list.insert(list.end(), other.begin(), other.end());
+}
+
+// Every primitive of the model in one list
+static bool LoadVertexData(const Path& path, VertexData& vertexData)
+{
+    GLTFModel model;
+    if (!model.Load(path, false)) {
+        return false;
+    }
+
+    bool isFirst = true;
+    for (const auto& mesh : model.GetMeshList()) {
+        for (const auto& primitive : mesh.Primitives) {
+            const VertexData& other = primitive.Vertices;
+            if (isFirst) {
+                vertexData = other;
+                isFirst = false;
+                continue;
+            }
+
+            size_t vertexCount = vertexData.GetVertexCount();
+            size_t otherCount = other.GetVertexCount();
+
+            AppendList(vertexData.Normals, other.Normals, vertexCount, otherCount);
+            AppendList(vertexData.Tangents, other.Tangents, vertexCount, otherCount);
+            AppendList(vertexData.Colors, other.Colors, vertexCount, otherCount);
+            AppendList(vertexData.TexCoords1, other.TexCoords1, vertexCount, otherCount);
+            AppendList(vertexData.TexCoords2, other.TexCoords2, vertexCount, otherCount);
+            AppendList(vertexData.Joints, other.Joints, vertexCount, otherCount);
+            AppendList(vertexData.Weights, other.Weights, vertexCount, otherCount);
+            AppendList(vertexData.Positions, other.Positions, vertexCount, otherCount);
+        }
+    }
+
+    return !isFirst;
+}
+
+template <typename T>
+static inline T Read(const uint8_t * src, size_t index)
+{
+    T value;
+    memcpy(&value, src + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+// The inverse of the encoding, as done by the vertex fetch
+static void DecodeFloats(const uint8_t * src, VertexEncoding encoding, float * values, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        switch (encoding) {
+            case VertexEncoding::Float32:
+                values[i] = Read<float>(src, i);
+                break;
+            case VertexEncoding::Float16:
+                values[i] = glm::unpackHalf1x16(Read<uint16_t>(src, i));
+                break;
+            case VertexEncoding::Snorm16:
+            case VertexEncoding::Octahedral16:
+                values[i] = glm::unpackSnorm1x16(Read<uint16_t>(src, i));
+                break;
+            case VertexEncoding::Unorm16:
+                values[i] = glm::unpackUnorm1x16(Read<uint16_t>(src, i));
+                break;
+            case VertexEncoding::Snorm8:
+            case VertexEncoding::Octahedral8:
+                values[i] = glm::unpackSnorm1x8(Read<uint8_t>(src, i));
+                break;
+            case VertexEncoding::Unorm8:
+                values[i] = glm::unpackUnorm1x8(Read<uint8_t>(src, i));
+                break;
+            default:
+                values[i] = 0.0f;
+                break;
+        }
+    }
+}
+
+static Vec4u DecodeJoints(const uint8_t * src, VertexEncoding encoding)
+{
+    Vec4u joints(0);
+    for (int i = 0; i < 4; ++i) {
+        switch (encoding) {
+            case VertexEncoding::Uint32:
+                joints[i] = Read<uint32_t>(src, i);
+                break;
+            case VertexEncoding::Uint16:
+                joints[i] = Read<uint16_t>(src, i);
+                break;
+            case VertexEncoding::Uint8:
+                joints[i] = Read<uint8_t>(src, i);
+                break;
+            default:
+                break;
+        }
+    }
+
+    return joints;
+}
+
+// Matches OctahedralDecode() in VertexAttributes.inc.glsl
+static Vec3 OctahedralDecode(Vec2 e)
+{
+    Vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+    float t = std::max(-n.z, 0.0f);
+    n.x += (n.x >= 0.0f ? -t : t);
+    n.y += (n.y >= 0.0f ? -t : t);
+    return glm::normalize(n);
+}
+
+// Unlike acos of the dot product, still precise for nearly parallel vectors
+static float GetAngleDegrees(const Vec3& a, const Vec3& b)
+{
+    return glm::degrees(std::atan2(glm::length(glm::cross(a, b)), glm::dot(a, b)));
+}
+
+struct ErrorStats
+{
+    double Sum = 0.0;
+
+    double Maximum = 0.0;
+
+    size_t Count = 0;
+
+    void Add(double error) {
+        Sum += error;
+        Maximum = std::max(Maximum, error);
+        ++Count;
+    }
+
+    double GetMean() const {
+        return (Count > 0 ? Sum / Count : 0.0);
+    }
+
+}; // struct ErrorStats
+
+static void PrintError(const char * name, const ErrorStats& stats, const char * unit)
+{
+    if (stats.Count == 0) {
+        return;
+    }
+
+    fmt::print("    {:<12} max {:<12.6g} mean {:<12.6g} {}\n", name, stats.Maximum, stats.GetMean(), unit);
+}
+
+static void Benchmark(const char * name, const VertexFormat& format, const VertexData& vertexData,
+    size_t fullStride)
+{
+    size_t vertexCount = vertexData.GetVertexCount();
+
+    ShaderMesh shaderMesh;
+
+    auto start = std::chrono::steady_clock::now();
+    List<uint8_t> packed = format.Pack(vertexData, &shaderMesh);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint32_t stride = format.GetStride();
+
+    fmt::print("{}: {}\n", name, format.ToString());
+    fmt::print("    {} bytes per vertex, {:.1f}% of full precision, {:.1f} MiB, packed at {:.1f} M vertices/s\n",
+        stride, 100.0 * stride / fullStride, packed.size() / (1024.0 * 1024.0),
+        vertexCount / elapsed / 1e6);
+
+    Vec3 scale(shaderMesh.PositionScale);
+    Vec3 offset(shaderMesh.PositionOffset);
+
+    Vec3 minimum(0.0f);
+    Vec3 maximum(0.0f);
+    if (vertexCount > 0) {
+        minimum = maximum = vertexData.Positions[0];
+        for (const auto& position : vertexData.Positions) {
+            minimum = glm::min(minimum, position);
+            maximum = glm::max(maximum, position);
+        }
+    }
+
+    float size = std::max(glm::length(maximum - minimum), 1e-8f);
+
+    auto hasData = [&](VertexAttribute attribute, size_t count) {
+        return (format.HasAttribute(attribute) && count > 0);
+    };
+
+    auto src = [&](size_t v, VertexAttribute attribute) {
+        return packed.data() + v * stride + format.GetOffset(attribute);
+    };
+
+    ErrorStats positionError;
+    ErrorStats normalError;
+    ErrorStats tangentError;
+    ErrorStats colorError;
+    ErrorStats texCoord1Error;
+    ErrorStats texCoord2Error;
+    ErrorStats weightError;
+    size_t signMismatchCount = 0;
+    size_t jointMismatchCount = 0;
+
+    for (size_t v = 0; v < vertexCount; ++v) {
+        Vec4 position;
+        DecodeFloats(src(v, VertexAttribute::Position), format.GetEncoding(VertexAttribute::Position), &position.x, 4);
+        positionError.Add(glm::length(Vec3(position) * scale + offset - vertexData.Positions[v]) / size);
+
+        if (hasData(VertexAttribute::Normal, vertexData.Normals.size())) {
+            auto encoding = format.GetEncoding(VertexAttribute::Normal);
+
+            Vec4 normal(0.0f);
+            size_t count = (encoding == VertexEncoding::Float32 ? 3 : 4);
+            DecodeFloats(src(v, VertexAttribute::Normal), encoding, &normal.x, count);
+
+            Vec3 decoded = (format.GetSpecialization().OctahedralNormal
+                ? OctahedralDecode(Vec2(normal))
+                : Vec3(normal));
+            normalError.Add(GetAngleDegrees(decoded, vertexData.Normals[v]));
+        }
+
+        if (hasData(VertexAttribute::Tangent, vertexData.Tangents.size())) {
+            Vec4 tangent(0.0f);
+            DecodeFloats(src(v, VertexAttribute::Tangent), format.GetEncoding(VertexAttribute::Tangent), &tangent.x, 4);
+
+            if (format.GetSpecialization().OctahedralTangent) {
+                tangent = Vec4(OctahedralDecode(Vec2(tangent)), (position.w < 0.0f ? -1.0f : 1.0f));
+            }
+
+            tangentError.Add(GetAngleDegrees(Vec3(tangent), Vec3(vertexData.Tangents[v])));
+            if ((tangent.w < 0.0f) != (vertexData.Tangents[v].w < 0.0f)) {
+                ++signMismatchCount;
+            }
+        }
+
+        if (hasData(VertexAttribute::Color, vertexData.Colors.size())) {
+            Vec4 color;
+            DecodeFloats(src(v, VertexAttribute::Color), format.GetEncoding(VertexAttribute::Color), &color.x, 4);
+
+            Vec4 difference = glm::abs(color - vertexData.Colors[v]);
+            colorError.Add(std::max({ difference.x, difference.y, difference.z, difference.w }));
+        }
+
+        if (hasData(VertexAttribute::TexCoord1, vertexData.TexCoords1.size())) {
+            Vec2 texCoord;
+            DecodeFloats(src(v, VertexAttribute::TexCoord1), format.GetEncoding(VertexAttribute::TexCoord1), &texCoord.x, 2);
+
+            Vec2 difference = glm::abs(texCoord - vertexData.TexCoords1[v]);
+            texCoord1Error.Add(std::max(difference.x, difference.y));
+        }
+
+        if (hasData(VertexAttribute::TexCoord2, vertexData.TexCoords2.size())) {
+            Vec2 texCoord;
+            DecodeFloats(src(v, VertexAttribute::TexCoord2), format.GetEncoding(VertexAttribute::TexCoord2), &texCoord.x, 2);
+
+            Vec2 difference = glm::abs(texCoord - vertexData.TexCoords2[v]);
+            texCoord2Error.Add(std::max(difference.x, difference.y));
+        }
+
+        if (hasData(VertexAttribute::Joints, vertexData.Joints.size())) {
+            Vec4u joints = DecodeJoints(src(v, VertexAttribute::Joints), format.GetEncoding(VertexAttribute::Joints));
+            if (joints != vertexData.Joints[v]) {
+                ++jointMismatchCount;
+            }
+        }
+
+        if (hasData(VertexAttribute::Weights, vertexData.Weights.size())) {
+            Vec4 weights;
+            DecodeFloats(src(v, VertexAttribute::Weights), format.GetEncoding(VertexAttribute::Weights), &weights.x, 4);
+
+            Vec4 difference = glm::abs(weights - vertexData.Weights[v]);
+            weightError.Add(std::max({ difference.x, difference.y, difference.z, difference.w }));
+        }
+    }
+
+    PrintError("Position", positionError, "of the bounds' diagonal");
+    PrintError("Normal", normalError, "degrees");
+    PrintError("Tangent", tangentError, "degrees");
+    PrintError("Color", colorError, "");
+    PrintError("TexCoord1", texCoord1Error, "");
+    PrintError("TexCoord2", texCoord2Error, "");
+    PrintError("Weights", weightError, "");
+
+    if (tangentError.Count > 0) {
+        fmt::print("    {} bitangent signs flipped\n", signMismatchCount);
+    }
+
+    if (format.HasAttribute(VertexAttribute::Joints) && !vertexData.Joints.empty()) {
+        fmt::print("    {} vertices with different joints\n", jointMismatchCount);
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    size_t vertexCount = 1'000'000;
+    Path modelPath;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--vertices") == 0 && i + 1 < argc) {
+            vertexCount = static_cast<size_t>(atoll(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--model") == 0 && i + 1 < argc) {
+            modelPath = argv[++i];
+        }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    try {
+        // Models are decoded with jobs
+        JobSystem jobSystem;
+
+        VertexData vertexData;
+        if (modelPath.IsEmpty()) {
+            vertexData = GenerateVertexData(vertexCount);
+        }
+        else if (!LoadVertexData(modelPath, vertexData)) {
+            fmt::print("Failed to load '{}'\n", modelPath);
+            return 1;
+        }
+
+        fmt::print("{} vertices\n\n", vertexData.GetVertexCount());
+
+        VertexFormat chosenFormat = VertexFormat::Choose(vertexData);
+
+        // Only the attributes the data has, so sizes are compared with what would be stored
+        VertexFormat fullFormat = VertexFormat::FullPrecision();
+        for (size_t i = 0; i < VertexAttributeCount; ++i) {
+            auto attribute = static_cast<VertexAttribute>(i);
+            if (!chosenFormat.HasAttribute(attribute)) {
+                fullFormat.SetEncoding(attribute, VertexEncoding::None);
+            }
+        }
+
+        VertexFormat compactFormat = chosenFormat;
+        if (compactFormat.HasAttribute(VertexAttribute::Normal)) {
+            compactFormat.SetEncoding(VertexAttribute::Normal, VertexEncoding::Octahedral8);
+        }
+        if (compactFormat.HasAttribute(VertexAttribute::Tangent)) {
+            compactFormat.SetEncoding(VertexAttribute::Tangent, VertexEncoding::Octahedral8);
+        }
+
+        size_t fullStride = fullFormat.GetStride();
+
+        Benchmark("Full precision", fullFormat, vertexData, fullStride);
+        Benchmark("Chosen", chosenFormat, vertexData, fullStride);
+        Benchmark("Octahedral8", compactFormat, vertexData, fullStride);
+    }
+    catch (std::exception& e) {
+        fmt::print("Exception: {}\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}